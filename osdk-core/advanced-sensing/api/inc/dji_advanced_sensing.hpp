@@ -288,6 +288,48 @@ public:
    */
   void setStereoCamParamsObserver(Perception::PerceptionCamParamCB cb, void *userData);
 
+  /*! @brief
+   *
+   *  Decode the FPV and main camera streams on threads they share instead
+   *  of each on its own, so a keyframe of one keeps no core idle. Takes
+   *  effect at their next start (Only for M210 V2 series)
+   *
+   *  @param enable true to share, false for the default
+   *  @param workers threads shared, 0 for one per core; only used the
+   *         first time sharing is enabled
+   */
+  void setSharedCameraDecoding(bool enable, int workers = 0);
+  /*! @brief
+   *
+   *  Let the FPV camera decoder skip work on frames it delivers later than
+   *  maxLatencyMs after their packet, see DJICameraDecodePolicy. Takes
+   *  effect at the next start of the stream (Only for M210 V2 series)
+   *
+   *  @param maxLatencyMs 0 to decode every frame fully, the default
+   */
+  void setFPVCameraDecodeLatency(int maxLatencyMs);
+  /*! @brief
+   *
+   *  Let the main camera decoder skip work on frames it delivers later
+   *  than maxLatencyMs after their packet, see DJICameraDecodePolicy.
+   *  Takes effect at the next start of the stream (Only for M210 V2 series)
+   *
+   *  @param maxLatencyMs 0 to decode every frame fully, the default
+   */
+  void setMainCameraDecodeLatency(int maxLatencyMs);
+  /*! @brief Get the frame counts and latencies of the FPV camera decoder
+   *
+   *  @param stats filled with the counters since the stream started
+   *  @return false if the drone has no such stream
+   */
+  bool getFPVCameraDecoderStats(DJICameraDecoderStats& stats);
+  /*! @brief Get the frame counts and latencies of the main camera decoder
+   *
+   *  @param stats filled with the counters since the stream started
+   *  @return false if the drone has no such stream
+   */
+  bool getMainCameraDecoderStats(DJICameraDecoderStats& stats);
+
 private:
   /*! @brief
    *
@@ -326,6 +368,7 @@ AdvancedSensingProtocol* advancedSensingProtocol;
 Vehicle* vehicle_ptr;
 DJICameraStream* mainCam_ptr;
 DJICameraStream* fpvCam_ptr;
+DJICameraDecodePool* cameraDecodePool;
 LiveView *liveview;
 Perception *perception;
 const char* acm_dev;
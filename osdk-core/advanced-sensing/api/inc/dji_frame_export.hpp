@@ -0,0 +1,284 @@
+/** @file dji_frame_export.hpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief Shared memory ring exporting camera and stereo images to other
+ *  processes
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef ONBOARDSDK_DJI_FRAME_EXPORT_H
+#define ONBOARDSDK_DJI_FRAME_EXPORT_H
+
+#include <string>
+#include "dji_ack.hpp"
+#include "dji_camera_image.hpp"
+#include "dji_perception.hpp"
+#include "osdk_platform.h"
+
+namespace DJI {
+namespace OSDK {
+
+/*! @brief Publishes decoded camera images and raw stereo images into a POSIX
+ *  shared memory ring that other processes on the machine map and read in
+ *  place.
+ *
+ *  The ring holds slotCount frames; frame n goes to slot n % slotCount and
+ *  overwrites the frame slotCount before it whether or not someone still
+ *  reads that one. Publishing never waits for a reader: a reader that falls
+ *  behind loses frames, and one reading a frame while it is overwritten
+ *  learns so from FrameExportReader::isValid(). Readers wait on a futex in
+ *  the ring, which the exporter only wakes while someone waits.
+ *
+ *  Frames may be published from several threads, e.g. the camera and the
+ *  perception callbacks. The callbacks of DJICameraStream and Perception
+ *  can be pointed at the static functions below, with the exporter as user
+ *  data.
+ */
+class FrameExporter {
+ public:
+  typedef enum SourceType : uint8_t {
+    SOURCE_FPV_CAMERA = 0,
+    SOURCE_MAIN_CAMERA = 1,
+    SOURCE_PERCEPTION = 2,
+  } SourceType;
+
+  typedef enum FormatType : uint8_t {
+    FORMAT_RGB24 = 0,
+    FORMAT_GRAY8 = 1,
+    /*! Perception images of 2 bytes per pixel, little endian */
+    FORMAT_GRAY16 = 2,
+  } FormatType;
+
+  static const uint32_t MAGIC = 0x58454453;  // "SDEX"
+  static const uint16_t FORMAT_VERSION = 1;
+
+  static const uint32_t DEFAULT_SLOT_COUNT = 8;
+  /*! A 1080p RGB image */
+  static const uint32_t DEFAULT_MAX_FRAME_LEN = 1920 * 1080 * 3;
+
+  /*! What the ring tells about a frame, next to its pixels */
+  typedef struct FrameInfoType {
+    /*! Frames published before and this one, counting from 1 */
+    uint64_t number;
+    /*! When it was copied into the ring, CLOCK_MONOTONIC, the same in every
+     *  process */
+    uint64_t timeUs;
+    /*! Perception::ImageInfoType::timeStamp, 0 for camera images */
+    uint64_t sourceTimeStamp;
+    /*! Perception frame index, or camera images published before */
+    uint32_t sourceIndex;
+    /*! Perception::PerceptionCamType, 0 for camera images */
+    uint32_t dataType;
+    uint32_t width;
+    uint32_t height;
+    /*! Bytes from one row to the next */
+    uint32_t stride;
+    uint32_t length;
+    uint8_t source;
+    uint8_t format;
+    /*! Perception::DirectionType, 0 for camera images */
+    uint8_t direction;
+    uint8_t reserved[5];
+  } FrameInfoType;
+
+  typedef struct StatsType {
+    uint64_t frames;
+    uint64_t bytes;
+    /*! Larger than maxFrameLen, not published */
+    uint64_t oversizeFrames;
+    /*! Frames published while a reader waited, so with a futex wake */
+    uint64_t wakeups;
+  } StatsType;
+
+ public:
+  FrameExporter();
+  /*! Calls close() */
+  ~FrameExporter();
+
+  FrameExporter(const FrameExporter &other) = delete;
+  FrameExporter &operator=(const FrameExporter &other) = delete;
+
+  /*! Creates the ring, replacing one of the same name a previous exporter
+   *  left behind; the stats start over
+   *  @param name shared memory object, e.g. "/osdk-frames"
+   *  @param slotCount frames kept, at least 2
+   *  @param maxFrameLen bytes of the largest frame */
+  bool create(const std::string &name,
+              uint32_t slotCount = DEFAULT_SLOT_COUNT,
+              uint32_t maxFrameLen = DEFAULT_MAX_FRAME_LEN);
+
+  /*! Tells the readers, removes the name and unmaps the ring. Readers keep
+   *  what they mapped until they close it. */
+  void close();
+
+  bool isOpen();
+
+  /*! Copies the frame into the next slot, info.number and info.timeUs are
+   *  filled in
+   *  @return false if not open or info.length is larger than maxFrameLen */
+  bool publish(const FrameInfoType &info, const uint8_t *data);
+
+  bool publishCameraImage(const CameraRGBImage &image, CameraType camera);
+
+  /*! @param image bpp bytes per pixel, rows of width pixels */
+  bool publishImage(const Perception::ImageInfoType &info,
+                    const uint8_t *image, uint32_t len);
+
+  /*! Publishes both images of the pair, the left one first
+   *  @return false if one of them was not published */
+  bool publishStereoVGA(const ACK::StereoVGAImgData &imgs);
+
+  void getStats(StatsType &stats);
+
+  /*! CameraImageCallback publishing into the exporter passed as userData */
+  static void fpvCameraImageCallback(CameraRGBImage image, void *userData);
+  static void mainCameraImageCallback(CameraRGBImage image, void *userData);
+
+  /*! Perception::PerceptionImageCB publishing into the exporter passed as
+   *  userData */
+  static void perceptionImageCallback(Perception::ImageInfoType info,
+                                      uint8_t *imageRawBuffer, int bufferLen,
+                                      void *userData);
+
+ private:
+  friend class FrameExportReader;
+
+  /*! The first page of the ring. The counters are only accessed with
+   *  atomic operations; futexWord is what the readers wait on. Readers map
+   *  it writable for waiters, so the exporter and each reader keep the
+   *  geometry to themselves and never take it back from here. */
+  typedef struct RingHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t headerSize;
+    uint32_t slotCount;
+    /*! Bytes from one slot to the next, a multiple of the page size */
+    uint32_t slotSize;
+    uint32_t maxFrameLen;
+    uint32_t producerPid;
+    uint32_t closed;
+    uint64_t published;
+    uint32_t futexWord;
+    uint32_t waiters;
+  } RingHeader;
+
+  /*! A frame is in its slot while sequence is 2 * info.number, it is being
+   *  written while sequence is odd */
+  typedef struct SlotHeader {
+    uint64_t sequence;
+    FrameInfoType info;
+  } SlotHeader;
+
+  /*! The pixels start here in a slot */
+  static const uint32_t SLOT_DATA_OFFSET = 64;
+
+  static std::string shmName(const std::string &name);
+
+  T_OsdkMutexHandle mutex;
+  std::string name;
+  uint8_t *ring;
+  size_t ringSize;
+  RingHeader *header;
+  size_t headerSize;
+  size_t slotSize;
+  uint32_t slotCount;
+  uint32_t maxFrameLen;
+  uint64_t published;
+  uint32_t cameraImages[2];
+  StatsType stats;
+};
+
+/*! @brief Maps the ring of a FrameExporter, possibly in another process,
+ *  and reads its frames without copying them.
+ *
+ *  A frame handed out points into the ring and stays there until the
+ *  exporter comes round to its slot again, slotCount - 1 frames later at the
+ *  earliest. isValid() after using the pixels tells whether that happened
+ *  meanwhile.
+ */
+class FrameExportReader {
+ public:
+  typedef struct FrameType {
+    FrameExporter::FrameInfoType info;
+    /*! info.length bytes in the ring, read-only */
+    const uint8_t *data;
+  } FrameType;
+
+ public:
+  FrameExportReader();
+  /*! Calls close() */
+  ~FrameExportReader();
+
+  FrameExportReader(const FrameExportReader &other) = delete;
+  FrameExportReader &operator=(const FrameExportReader &other) = delete;
+
+  /*! @return false if no exporter created the ring yet */
+  bool open(const std::string &name);
+
+  void close();
+
+  bool isOpen();
+
+  /*! Waits for a frame published after frameNumber, 0 at first, and sets
+   *  frameNumber to it.
+   *  @param timeoutMs 0 returns at once, negative waits without limit
+   *  @param latest true takes the newest frame, false the one after
+   *  frameNumber or, once that is overwritten, the oldest left to read
+   *  @return false if timeout or the exporter closed the ring */
+  bool waitForFrame(uint64_t &frameNumber, FrameType &frame, int timeoutMs,
+                    bool latest = false);
+
+  /*! @return false if the frame was overwritten since waitForFrame()
+   *  handed it out, so its pixels may be mixed with a newer frame's */
+  bool isValid(const FrameType &frame);
+
+  bool isExporterClosed();
+
+  /*! Frames overwritten before waitForFrame() got to them */
+  uint64_t getLostFrames();
+
+  uint32_t getSlotCount();
+  uint32_t getMaxFrameLen();
+
+ private:
+  const FrameExporter::SlotHeader *slotOf(uint64_t number);
+
+  /*! The header page, writable for waiters */
+  FrameExporter::RingHeader *header;
+  /*! The slots, read-only */
+  const uint8_t *slots;
+  size_t slotsSize;
+  /*! As the header told at open() */
+  size_t headerSize;
+  size_t slotSize;
+  uint32_t slotCount;
+  uint32_t maxFrameLen;
+  uint64_t lostFrames;
+};
+
+}  // namespace OSDK
+}  // namespace DJI
+
+#endif  // ONBOARDSDK_DJI_FRAME_EXPORT_H
@@ -32,6 +32,8 @@
 #include <cstring>
 #include "dji_camera_image.hpp"
 
+class DJICameraStreamSource;
+
 namespace DJI {
 namespace OSDK {
 
@@ -65,6 +67,13 @@ class LiveView {
 
   LiveViewErrCode startH264Stream(LiveViewCameraPosition pos, H264Callback cb, void *userData);
 
+  /*! Delivers the H.264 of source to cb as if it came from the camera at
+   *  pos, e.g. a recording replayed by DJICameraStreamFileSource, so no
+   *  aircraft is needed. The source is started here and stopped by
+   *  stopH264Stream(pos), it stays owned by the caller. */
+  LiveViewErrCode startH264Stream(LiveViewCameraPosition pos, DJICameraStreamSource *source,
+                                  H264Callback cb, void *userData);
+
   LiveViewErrCode stopH264Stream(LiveViewCameraPosition pos);
 
  private:
@@ -33,6 +33,7 @@
 #include "dji_vehicle.hpp"
 #include "dji_liveview.hpp"
 #include "dji_linker.hpp"
+#include "dji_camera_stream_source.hpp"
 
 namespace DJI {
 namespace OSDK {
@@ -48,13 +49,22 @@ class LiveViewImpl {
 
   LiveView::LiveViewErrCode startH264Stream(LiveView::LiveViewCameraPosition pos, H264Callback cb, void *userData);
 
+  LiveView::LiveViewErrCode startH264Stream(LiveView::LiveViewCameraPosition pos, DJICameraStreamSource *source,
+                                            H264Callback cb, void *userData);
+
   LiveView::LiveViewErrCode stopH264Stream(LiveView::LiveViewCameraPosition pos);
 
+  /*! The stream of pos comes from a source given to startH264Stream() */
+  bool hasStreamSource(LiveView::LiveViewCameraPosition pos);
+
   typedef struct H264CallbackHandler {
     H264Callback cb;
     void *userData;
   } H264CallbackHandler;
 
+  /*! Drives RecordStreamHandler() in the benchmarks, defined there */
+  friend struct LiveViewBenchmarkHook;
+
  private:
 
   typedef enum E_OSDKCameraType {
@@ -198,6 +208,10 @@ class LiveViewImpl {
                                         const T_CmdInfo *cmdInfo,
                                         const uint8_t *cmdData,
                                         void *userData);
+  /*! CAMCALLBACK of the sources, handler is their entry in h264CbHandlerMap */
+  static void SourceStreamHandler(void *handler, uint8_t *buf, int bufLen);
+  std::map<LiveView::LiveViewCameraPosition, DJICameraStreamSource *> streamSources;
+
   static E_OsdkStat getCameraPushing(struct _CommandHandle *cmdHandle,
                                      const T_CmdInfo *cmdInfo,
                                      const uint8_t *cmdData, void *userData);
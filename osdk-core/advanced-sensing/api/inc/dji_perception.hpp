@@ -118,15 +118,76 @@ class Perception {
   typedef void(*PerceptionCamParamCB)
       (Perception::CamParamPacketType paramPacket, void *userData);
 
+  /*! @brief what a full image queue of a subscriber does with a new image */
+  typedef enum PerceptionQueuePolicy : uint8_t {
+    /*! drop the oldest queued image, the subscriber keeps up with the
+     *  latest images */
+    QUEUE_DROP_OLDEST = 0,
+    /*! drop the new image */
+    QUEUE_DROP_NEWEST = 1,
+    /*! wait until the subscriber took an image. This holds up receiving
+     *  every other image and command meanwhile. */
+    QUEUE_BLOCK = 2,
+  } PerceptionQueuePolicy;
+
+  typedef struct ImageQueueConfigType {
+    /*! images queued for the subscriber at most, besides the one it is
+     *  handling */
+    uint32_t depth;
+    PerceptionQueuePolicy policy;
+  } ImageQueueConfigType;
+
+  typedef struct ImageQueueStatsType {
+    uint32_t depth;
+    uint32_t maxDepth;
+    uint32_t capacity;
+    uint64_t delivered;
+    uint64_t dropped;
+  } ImageQueueStatsType;
+
+  typedef uint32_t ImageSubscriberID;
+
   /*! @bref callback type to receive stereo camera image */
   typedef void(*PerceptionImageCB)
       (Perception::ImageInfoType, uint8_t *imageRawBuffer, int bufferLen, void *userData);
 
+  /*! @brief left and right image of one stereo camera frame. The images are
+   *  only valid during the callback they are passed to.
+   */
+  typedef struct StereoPairType {
+    ImageInfoType leftInfo;
+    ImageInfoType rightInfo;
+    const uint8_t *leftImage;
+    const uint8_t *rightImage;
+    uint32_t leftLen;
+    uint32_t rightLen;
+  } StereoPairType;
+
+  /*! @bref callback type to receive stereo image pairs */
+  typedef void(*PerceptionStereoPairCB)
+      (const Perception::StereoPairType &pair, void *userData);
+
+  typedef struct StereoPairStatsType {
+    /*! pairs passed to the callback */
+    uint64_t pairs;
+    /*! images dropped because the other image of their frame did not come
+     *  in time */
+    uint64_t unmatched;
+    /*! time from the first image of a pair coming in to the pair being
+     *  delivered, in microseconds */
+    uint32_t lastLatencyUs;
+    uint32_t maxLatencyUs;
+    uint64_t totalLatencyUs;
+  } StereoPairStatsType;
+
  public:
 
   /*! @brief subscribe the raw images of both stereo cameras in the same
    * direction. Default frequency at 20 Hz.
    *
+   *  @note cb runs on a task of its own with a queue of 2 images, the
+   * oldest is dropped when cb falls behind. Subscribing the direction again
+   * replaces cb.
    *  @param direction to specifly the direction of the subscription. Ref to
    * DJI::OSDK::Perception::DirectionType
    *  @param cb callback to observer the stereo camera image and info.
@@ -136,7 +197,7 @@ class Perception {
   PerceptionErrCode subscribePerceptionImage(DirectionType direction, PerceptionImageCB cb, void* userData);
 
   /*! @brief unsubscribe the raw image of both stereo cameras in the same
-   * direction.
+   * direction, for every subscriber and the stereo pairs of it.
    *
    *  @param direction to specifly the direction of the subscription. Ref to
    * DJI::OSDK::Perception::DirectionType
@@ -144,6 +205,84 @@ class Perception {
    */
   PerceptionErrCode unsubscribePerceptionImage(DirectionType direction);
 
+  /*! @brief add a subscriber to the raw images of both stereo cameras in a
+   * direction. Every subscriber gets the images through a queue of its own
+   * on a task of its own, a slow one neither holds up receiving nor the
+   * other subscribers. The images of a direction are subscribed with its
+   * first subscriber and unsubscribed with its last.
+   *
+   *  @param direction to specifly the direction of the subscription. Ref to
+   * DJI::OSDK::Perception::DirectionType
+   *  @param cb callback to observer the stereo camera image and info, the
+   * image is valid during the callback.
+   *  @param userData when cb is called, used in cb.
+   *  @param config depth and policy of the queue of the subscriber
+   *  @param id set to the id of the subscriber
+   *  @return error code. Ref to DJI::OSDK::Perception::PerceptionErrCode
+   */
+  PerceptionErrCode addImageSubscriber(DirectionType direction,
+                                       PerceptionImageCB cb, void *userData,
+                                       ImageQueueConfigType config,
+                                       ImageSubscriberID &id);
+
+  /*! @brief remove a subscriber. Its queued images are dropped and once it
+   * returned cb is not called anymore, so it must not be called from cb.
+   *
+   *  @param id of the subscriber
+   *  @return error code. Ref to DJI::OSDK::Perception::PerceptionErrCode
+   */
+  PerceptionErrCode removeImageSubscriber(ImageSubscriberID id);
+
+  /*! @brief get the depth and drop counters of the queue of a subscriber.
+   *
+   *  @param id of the subscriber
+   *  @param stats filled with the counters
+   *  @return error code. Ref to DJI::OSDK::Perception::PerceptionErrCode
+   */
+  PerceptionErrCode getImageQueueStats(ImageSubscriberID id,
+                                       ImageQueueStatsType &stats);
+
+  /*! @brief subscribe the images of both stereo cameras in the same
+   * direction as pairs: the left and right image of a frame are matched by
+   * frame index and timestamp and come in one callback. Images arriving out
+   * of order are matched as well, an image whose partner never comes is
+   * dropped and counted. Default frequency at 20 Hz.
+   *
+   *  @note The pairs are matched and delivered on the task of a subscriber
+   *  with a queue of 4 images, the oldest is dropped when cb falls behind.
+   *  The image arriving first is kept until its pair is complete, the one
+   *  completing the pair is passed from the queue without a copy.
+   *  @param direction to specifly the direction of the subscription. Ref to
+   * DJI::OSDK::Perception::DirectionType
+   *  @param cb callback to observer the stereo image pairs.
+   *  @param userData when cb is called, used in cb.
+   *  @return error code. Ref to DJI::OSDK::Perception::PerceptionErrCode
+   */
+  PerceptionErrCode subscribeStereoPairs(DirectionType direction,
+                                         PerceptionStereoPairCB cb,
+                                         void *userData);
+
+  /*! @brief unsubscribe the stereo image pairs of a direction. Once it
+   * returned the callback is not called anymore.
+   *
+   *  @param direction to specifly the direction of the subscription. Ref to
+   * DJI::OSDK::Perception::DirectionType
+   *  @return error code. Ref to DJI::OSDK::Perception::PerceptionErrCode
+   */
+  PerceptionErrCode unsubscribeStereoPairs(DirectionType direction);
+
+  /*! @brief get the pairing counters of a direction, counted since the
+   * pairs of it were subscribed.
+   *
+   *  @note Waits for a pair callback running, so it is not to be called
+   *  from one.
+   *  @param direction Ref to DJI::OSDK::Perception::DirectionType
+   *  @param stats filled with the counters
+   *  @return error code. Ref to DJI::OSDK::Perception::PerceptionErrCode
+   */
+  PerceptionErrCode getStereoPairStats(DirectionType direction,
+                                       StereoPairStatsType &stats);
+
   /*! @brief trigger stereo cameras parameters pushing once.
    *
    *  @param direction to specifly the direction of the subscription. Ref to
@@ -166,6 +305,8 @@ class Perception {
   void cancelAllSubsciptions();
 
  private:
+  PerceptionErrCode subscribeDirection(DirectionType direction);
+
   Vehicle *vehicle;
   PerceptionImpl *impl;
 };
@@ -0,0 +1,111 @@
+/** @file dji_perception_image_queue.hpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief Bounded queue handing perception images to a subscriber task
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef ONBOARDSDK_DJI_PERCEPTION_IMAGE_QUEUE_H
+#define ONBOARDSDK_DJI_PERCEPTION_IMAGE_QUEUE_H
+
+#include <vector>
+#include "dji_perception.hpp"
+#include "osdk_platform.h"
+
+namespace DJI {
+namespace OSDK {
+
+/*! @brief Images of one perception subscriber, delivered on a task of its
+ *  own so the subscriber never runs on the thread receiving them.
+ *
+ *  push() copies the image into one of depth + 1 buffers, the extra one is
+ *  the image being delivered. When depth images are queued the policy
+ *  decides: drop the oldest queued image, drop the new one, or block the
+ *  caller until the subscriber took one.
+ */
+class PerceptionImageQueue {
+ public:
+  /*! Buffers are allocated for VGA images, larger ones grow them */
+  static const uint32_t DEFAULT_IMAGE_LEN = 640 * 480;
+
+  PerceptionImageQueue(Perception::DirectionType direction,
+                       Perception::PerceptionImageCB cb, void *userData,
+                       const Perception::ImageQueueConfigType &config);
+  /*! Calls stop() */
+  ~PerceptionImageQueue();
+
+  PerceptionImageQueue(const PerceptionImageQueue &other) = delete;
+  PerceptionImageQueue &operator=(const PerceptionImageQueue &other) = delete;
+
+  bool isRunning() const { return worker != NULL; }
+  Perception::DirectionType getDirection() const { return direction; }
+
+  void push(const Perception::ImageInfoType &info, const uint8_t *image,
+            uint32_t len);
+
+  /*! Drops the queued images and returns once a callback still running
+   *  returned; push() does nothing afterwards. Must not be called from the
+   *  callback. */
+  void stop();
+
+  void getStats(Perception::ImageQueueStatsType &stats);
+
+ private:
+  typedef struct Entry {
+    Perception::ImageInfoType info;
+    std::vector<uint8_t> image;
+  } Entry;
+
+  static void *deliverTask(void *arg);
+  /*! Takes the oldest queued entry, with the lock held */
+  Entry *popQueued();
+
+  Perception::DirectionType direction;
+  Perception::PerceptionImageCB cb;
+  void *userData;
+  Perception::ImageQueueConfigType config;
+
+  T_OsdkMutexHandle mutex;
+  T_OsdkSemHandle queuedSem;
+  T_OsdkSemHandle freedSem;
+  T_OsdkSemHandle stoppedSem;
+  T_OsdkTaskHandle worker;
+  bool stopping;
+
+  std::vector<Entry> entries;
+  /*! Ring of the queued entries, oldest at queuedHead */
+  std::vector<Entry *> queued;
+  uint32_t queuedHead;
+  uint32_t queuedCount;
+  std::vector<Entry *> freeEntries;
+
+  uint32_t maxDepth;
+  uint64_t delivered;
+  uint64_t dropped;
+};
+
+}  // namespace OSDK
+}  // namespace DJI
+
+#endif  // ONBOARDSDK_DJI_PERCEPTION_IMAGE_QUEUE_H
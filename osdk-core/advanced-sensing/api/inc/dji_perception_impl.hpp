@@ -30,7 +30,10 @@
 #define ONBOARDSDK_DJI_PERCEPTION_IMPL_H
 
 #include <cstring>
+#include <memory>
 #include "dji_perception.hpp"
+#include "dji_perception_image_queue.hpp"
+#include "dji_stereo_pair_sync.hpp"
 #include "dji_vehicle.hpp"
 #include "dji_linker.hpp"
 
@@ -57,6 +60,15 @@ class PerceptionImpl {
     void* userData;
   } PerceptionCamParamHandler;
 
+  typedef std::shared_ptr<PerceptionImageQueue> ImageQueuePtr;
+
+  typedef struct ImageSubscriber {
+    Perception::ImageSubscriberID id;
+    ImageQueuePtr queue;
+  } ImageSubscriber;
+
+  static const int MAX_SUBSCRIBERS_PER_DIRECTION = 8;
+
   static E_OsdkStat cameraImageHandler(struct _CommandHandle *cmdHandle,
                                        const T_CmdInfo *cmdInfo, const uint8_t *cmdData, void *userData);
 
@@ -80,9 +92,34 @@ class PerceptionImpl {
   void cancelAllSubsciptions();
 
   vector<Perception::DirectionType> getUpdatingDiretcion();
+
+  /*! Adds queue to the subscribers of its direction.
+   *  @param count set to the subscribers of the direction, queue included */
+  E_OsdkStat addImageSubscriber(const ImageQueuePtr &queue,
+                                Perception::ImageSubscriberID &id,
+                                int &count);
+  /*! Takes a subscriber out, the queue is returned still running.
+   *  @param count set to the subscribers left in the direction of it */
+  ImageQueuePtr removeImageSubscriber(Perception::ImageSubscriberID id,
+                                      int &count);
+  /*! Takes all subscribers of a direction out, the queues still running */
+  vector<ImageQueuePtr> removeImageSubscribers(
+      Perception::DirectionType direction);
+  ImageQueuePtr getImageSubscriber(Perception::ImageSubscriberID id);
+
+  /*! Feeds the images of a subscriber into a StereoPairSync */
+  static void stereoPairFeeder(Perception::ImageInfoType info,
+                               uint8_t *imageRawBuffer, int bufferLen,
+                               void *userData);
  public:
   static PerceptionImageHandler imageHandler;
   static PerceptionCamParamHandler camParamHandler;
+  /*! Pairing of the images of every direction, fed by a subscriber */
+  static StereoPairSync *pairSyncs[IMAGE_MAX_DIRECTION_NUM];
+  /*! Subscribers added by subscribePerceptionImage and subscribeStereoPairs,
+   *  0 for none */
+  Perception::ImageSubscriberID directionSubscriber[IMAGE_MAX_DIRECTION_NUM];
+  Perception::ImageSubscriberID pairSubscriber[IMAGE_MAX_DIRECTION_NUM];
 
   static const char rectifyDownLeft[11];
   static const char rectifyDownRight[11];
@@ -101,6 +138,12 @@ class PerceptionImpl {
   Vehicle *vehicle;
   static uint32_t imageUpdateSysMs[IMAGE_MAX_DIRECTION_NUM];
   static uint32_t updateJudgingInMs;
+  /*! Taken on the receive thread only long enough to copy the queues out,
+   *  images are pushed without it */
+  static T_OsdkMutexHandle subscriberMutex;
+  static ImageSubscriber subscribers[IMAGE_MAX_DIRECTION_NUM]
+                                    [MAX_SUBSCRIBERS_PER_DIRECTION];
+  static Perception::ImageSubscriberID lastSubscriberID;
   string getSubscribeString(Perception::CamPositionType camChoice);
 };
 } // OSDK
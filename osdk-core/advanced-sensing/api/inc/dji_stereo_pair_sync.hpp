@@ -0,0 +1,114 @@
+/** @file dji_stereo_pair_sync.hpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief Pairing of the left and right perception camera images
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef ONBOARDSDK_DJI_STEREO_PAIR_SYNC_H
+#define ONBOARDSDK_DJI_STEREO_PAIR_SYNC_H
+
+#include <atomic>
+#include <vector>
+#include "dji_perception.hpp"
+#include "osdk_platform.h"
+
+namespace DJI {
+namespace OSDK {
+
+/*! @brief Matches the left and right images of one stereo direction.
+ *
+ *  An image waits in a small ring until the image of the other camera with
+ *  the same frame index and timestamp comes, then both are delivered
+ *  together. The ring buffers are allocated when pairing is enabled, an
+ *  image is copied into one only while it waits. Delivering a pair drops the
+ *  images still waiting for older frames, so pairs come in frame order;
+ *  when the ring is full the image waiting longest is dropped.
+ *
+ *  push() is called from one thread at a time, the task of the subscriber
+ *  feeding it.
+ */
+class StereoPairSync {
+ public:
+  static const uint32_t RING_SLOTS = 4;
+  /*! Ring buffers are allocated for VGA images, larger ones grow them */
+  static const uint32_t DEFAULT_IMAGE_LEN = 640 * 480;
+
+  StereoPairSync();
+  ~StereoPairSync();
+
+  StereoPairSync(const StereoPairSync &other) = delete;
+  StereoPairSync &operator=(const StereoPairSync &other) = delete;
+
+  /*! Starts pairing with fresh counters, or stops it if cb is NULL. Waits
+   *  for a callback running on the receiving thread to return. */
+  void setCallback(Perception::PerceptionStereoPairCB cb, void *userData);
+  bool isEnabled() const;
+
+  void push(const Perception::ImageInfoType &info, const uint8_t *image,
+            uint32_t len);
+
+  /*! A consistent snapshot of the counters, taken under the lock push()
+   *  holds while it delivers, so not to be called from the callback */
+  void getStats(Perception::StereoPairStatsType &stats) const;
+
+ private:
+  typedef struct Slot {
+    bool used;
+    bool isLeft;
+    Perception::ImageInfoType info;
+    uint64_t arrivalUs;
+    std::vector<uint8_t> image;
+  } Slot;
+
+  static bool isLeft(const Perception::ImageInfoType &info);
+  static bool isSameFrame(const Perception::ImageInfoType &a,
+                          const Perception::ImageInfoType &b);
+  static bool isOlderFrame(const Perception::ImageInfoType &a,
+                           const Perception::ImageInfoType &b);
+
+  void deliver(Slot &waiting, const Perception::ImageInfoType &info,
+               const uint8_t *image, uint32_t len, uint64_t nowUs);
+  void dropOlderThan(const Perception::ImageInfoType &info);
+  void store(const Perception::ImageInfoType &info, const uint8_t *image,
+             uint32_t len, uint64_t nowUs);
+
+  T_OsdkMutexHandle mutex;
+  Perception::PerceptionStereoPairCB cb;
+  void *userData;
+  std::atomic<bool> enabled;
+  Slot slots[RING_SLOTS];
+
+  /*! Counters, under mutex */
+  uint64_t pairs;
+  uint64_t unmatched;
+  uint32_t lastLatencyUs;
+  uint32_t maxLatencyUs;
+  uint64_t totalLatencyUs;
+};
+
+}  // namespace OSDK
+}  // namespace DJI
+
+#endif  // ONBOARDSDK_DJI_STEREO_PAIR_SYNC_H
@@ -0,0 +1,252 @@
+/** @file dji_stream_recorder.hpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief Recorder of LiveView H.264 and perception image streams
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef ONBOARDSDK_DJI_STREAM_RECORDER_H
+#define ONBOARDSDK_DJI_STREAM_RECORDER_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "dji_ack.hpp"
+#include "dji_perception.hpp"
+#include "osdk_platform.h"
+
+namespace DJI {
+namespace OSDK {
+
+/*! @brief Records LiveView H.264 and grayscale perception images to disk
+ *  without the receiving threads waiting for it.
+ *
+ *  The record functions only copy into a ring buffer; a task of the
+ *  recorder compresses and writes from there. When the ring is full, because
+ *  the disk does not keep up, the new packet or image is dropped and counted.
+ *  open(basePath) creates three files:
+ *  - basePath.h264: the H.264 packets as they came, a playable elementary
+ *    stream
+ *  - basePath.frames: every image as a FrameHeaderType and its pixels,
+ *    losslessly compressed unless that does not make them smaller
+ *  - basePath.index: an IndexHeaderType and an IndexRecordType per packet
+ *    or image, in the order they were recorded, so sorted by timeUs
+ *
+ *  The callbacks of LiveView and Perception can be pointed at h264Callback()
+ *  and perceptionImageCallback() directly, with the recorder as user data.
+ */
+class StreamRecorder {
+ public:
+  typedef enum StreamType : uint8_t {
+    STREAM_H264 = 0,
+    STREAM_GRAY_FRAME = 1,
+  } StreamType;
+
+  typedef enum FrameCodecType : uint8_t {
+    FRAME_CODEC_RAW = 0,
+    /*! Median prediction from the pixels left, above and above left, the
+     *  residuals Rice coded with an adaptive parameter */
+    FRAME_CODEC_MED_RICE = 1,
+  } FrameCodecType;
+
+  /*! IndexRecordType::flags */
+  static const uint8_t INDEX_FLAG_KEYFRAME = 0x01;
+
+  static const uint32_t INDEX_MAGIC = 0x58494453;  // "SDIX"
+  static const uint32_t FRAME_MAGIC = 0x46524453;  // "SDRF"
+  static const uint16_t FORMAT_VERSION = 1;
+
+  static const uint32_t DEFAULT_BUFFER_SIZE = 16 * 1024 * 1024;
+
+#pragma pack(1)
+  typedef struct IndexHeaderType {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordSize;
+  } IndexHeaderType;
+
+  typedef struct IndexRecordType {
+    /*! When the packet or image was recorded, steady clock */
+    uint64_t timeUs;
+    /*! Where it starts in basePath.h264 or basePath.frames */
+    uint64_t offset;
+    /*! Bytes it takes there, frame header included */
+    uint32_t length;
+    /*! Packets or images of the stream recorded before */
+    uint32_t sequence;
+    uint8_t stream;
+    uint8_t flags;
+    uint8_t direction;
+    uint8_t reserved[5];
+  } IndexRecordType;
+
+  typedef struct FrameHeaderType {
+    uint32_t magic;
+    uint8_t codec;
+    uint8_t direction;
+    uint16_t dataId;
+    uint32_t dataType;
+    uint32_t index;
+    uint16_t sequence;
+    uint16_t reserved;
+    uint64_t timeStamp;
+    uint32_t width;
+    uint32_t height;
+    /*! Bytes of the image and of the payload after this header */
+    uint32_t rawLen;
+    uint32_t payloadLen;
+  } FrameHeaderType;
+#pragma pack()
+
+  typedef struct StatsType {
+    uint64_t h264Packets;
+    uint64_t h264Bytes;
+    uint64_t frames;
+    uint64_t frameRawBytes;
+    /*! Bytes the frames take in basePath.frames, headers included */
+    uint64_t frameFileBytes;
+    uint64_t droppedPackets;
+    uint64_t droppedFrames;
+    uint64_t writeErrors;
+    /*! Bytes of the ring in use, now and at most */
+    uint32_t buffered;
+    uint32_t maxBuffered;
+    uint32_t bufferSize;
+  } StatsType;
+
+ public:
+  /*! @param bufferSize bytes of the ring, the largest burst the disk may
+   *  fall behind by */
+  StreamRecorder(uint32_t bufferSize = DEFAULT_BUFFER_SIZE);
+  /*! Calls close() */
+  ~StreamRecorder();
+
+  StreamRecorder(const StreamRecorder &other) = delete;
+  StreamRecorder &operator=(const StreamRecorder &other) = delete;
+
+  /*! Creates the files and starts the writing task, the stats start over */
+  bool open(const std::string &basePath);
+
+  /*! Writes what is buffered, stops the task and closes the files */
+  void close();
+
+  bool isOpen();
+
+  /*! @return false if the packet was dropped */
+  bool recordH264(const uint8_t *buf, uint32_t len);
+
+  /*! @param image bpp bytes per pixel, rows of width pixels
+   *  @return false if the image was dropped */
+  bool recordImage(const Perception::ImageInfoType &info, const uint8_t *image,
+                   uint32_t len);
+
+  /*! Records both images of the pair
+   *  @return false if one of them was dropped */
+  bool recordStereoVGA(const ACK::StereoVGAImgData &imgs);
+
+  void getStats(StatsType &stats);
+
+  /*! H264Callback recording into the recorder passed as userData */
+  static void h264Callback(uint8_t *buf, int bufLen, void *userData);
+
+  /*! Perception::PerceptionImageCB recording into the recorder passed as
+   *  userData */
+  static void perceptionImageCallback(Perception::ImageInfoType info,
+                                      uint8_t *imageRawBuffer, int bufferLen,
+                                      void *userData);
+
+  /*! Reads basePath.index */
+  static bool readIndex(const std::string &basePath,
+                        std::vector<IndexRecordType> &records);
+
+  /*! @return the first record of stream recorded at timeUs or later, or
+   *  records.size() */
+  static size_t seekIndex(const std::vector<IndexRecordType> &records,
+                          uint64_t timeUs, StreamType stream);
+
+  /*! @param payload header.payloadLen bytes following the header
+   *  @param image header.rawLen bytes the pixels are decoded into */
+  static bool decodeFrame(const FrameHeaderType &header, const uint8_t *payload,
+                          uint8_t *image);
+
+ private:
+  typedef struct RecordHeader {
+    /*! Bytes the record takes in the ring, this header included */
+    uint32_t size;
+    uint8_t type;
+    uint8_t ready;
+    uint16_t reserved;
+    uint32_t payloadLen;
+    uint64_t timeUs;
+    Perception::ImageInfoType info;
+  } RecordHeader;
+
+  static void *writeTask(void *arg);
+
+  /*! Room for a record of payloadLen bytes, NULL when the ring is full */
+  RecordHeader *reserve(uint32_t payloadLen);
+  void commit(RecordHeader *record);
+  /*! The oldest record if it was committed, with the lock held */
+  RecordHeader *oldestRecord();
+  void release(RecordHeader *record);
+
+  void writeH264(const RecordHeader *record);
+  void writeFrame(const RecordHeader *record);
+  void writeIndex(const RecordHeader *record, uint64_t offset, uint32_t length,
+                  uint32_t sequence, uint8_t flags, uint8_t direction);
+
+  static bool hasKeyframe(const uint8_t *buf, uint32_t len);
+  static uint32_t compressFrame(const uint8_t *image, uint32_t width,
+                                uint32_t height, uint8_t *out);
+
+  T_OsdkMutexHandle mutex;
+  T_OsdkSemHandle recordedSem;
+  T_OsdkSemHandle stoppedSem;
+  T_OsdkTaskHandle writer;
+  bool stopping;
+  /*! Records reserved but not filled yet */
+  uint32_t uncommitted;
+
+  std::vector<uint8_t> ring;
+  uint32_t head;
+  uint32_t tail;
+  uint32_t used;
+  uint32_t maxUsed;
+
+  FILE *h264File;
+  FILE *framesFile;
+  FILE *indexFile;
+  uint64_t h264Offset;
+  uint64_t framesOffset;
+  uint32_t h264Sequence;
+  uint32_t frameSequence;
+  std::vector<uint8_t> compressed;
+
+  StatsType stats;
+};
+
+}  // namespace OSDK
+}  // namespace DJI
+
+#endif  // ONBOARDSDK_DJI_STREAM_RECORDER_H
@@ -80,7 +80,8 @@ AdvancedSensing::AdvancedSensing(Vehicle* vehiclePtr) :
   liveview(NULL),
   perception(NULL),
   fpvCam_ptr(NULL),
-  mainCam_ptr(NULL)
+  mainCam_ptr(NULL),
+  cameraDecodePool(NULL)
 {
   stereoHandler.callback  = 0;
   stereoHandler.userData  = 0;
@@ -128,6 +129,11 @@ AdvancedSensing::~AdvancedSensing()
     delete mainCam_ptr;
   }
 
+  if(cameraDecodePool)
+  {
+    delete cameraDecodePool;
+  }
+
   if(liveview)
   {
     delete liveview;
@@ -191,17 +197,11 @@ typedef struct M300VGAHandlerData {
   Vehicle* vehicle;
 } M300VGAHandlerData;
 
-void M300VGAHandleCB(Perception::ImageInfoType info, uint8_t *imageRawBuffer,
-                       int bufferLen, void *userData) {
+void M300VGAHandleCB(const Perception::StereoPairType &pair, void *userData) {
   static DJI::OSDK::ACK::StereoVGAImgData stereoVGAImg = {0};
-  DSTATUS("image info : dataId(%d) seq(%d) timestamp(%d) datatype(%d)",
-          info.dataId, info.sequence,
-          info.timeStamp, info.dataType);
-  DSTATUS("image info : index(%d) h(%d) w(%d) dir(%d) bpp(%d) bufferlen(%d)",
-          info.rawInfo.index, info.rawInfo.height, info.rawInfo.width,
-          info.rawInfo.direction, info.rawInfo.bpp, bufferLen);
-  if (bufferLen != 480 * 640) {
-    DERROR("Error image raw data len : %d, should be 480 * 640.", bufferLen);
+  if ((pair.leftLen != 480 * 640) || (pair.rightLen != 480 * 640)) {
+    DERROR("Error image raw data len : %d/%d, should be 480 * 640.",
+           pair.leftLen, pair.rightLen);
     return;
   }
   auto m300Handler = (M300VGAHandlerData *) userData;
@@ -214,42 +214,16 @@ void M300VGAHandleCB(Perception::ImageInfoType info, uint8_t *imageRawBuffer,
     return;
   }
 
-  switch (stereoVGAImg.num_imgs) {
-    case 0 :
-      /*! get the first VGA image */
-      DSTATUS("#### ( 1 ) get the first VGA image");
-      stereoVGAImg.direction = info.rawInfo.direction;
-      stereoVGAImg.frame_index = info.rawInfo.index;
-      stereoVGAImg.time_stamp = info.timeStamp;
-      memcpy(stereoVGAImg.img_vec[0], imageRawBuffer, 480 * 640);
-      stereoVGAImg.num_imgs = 1;
-      break;
-    case 1 :
-      /*! get the second VGA image and do handling */
-      if ((stereoVGAImg.direction == info.rawInfo.direction) &&
-          (stereoVGAImg.frame_index == info.rawInfo.index) &&
-          (stereoVGAImg.time_stamp == info.timeStamp)) {
-        DSTATUS("#### ( 2 ) get the second VGA image");
-        memcpy(stereoVGAImg.img_vec[1], imageRawBuffer, 480 * 640);
-        RecvContainer recvFrame = {0};
-        recvFrame.recvData.stereoVGAImgData = &stereoVGAImg;
-        m300Handler->handler.callback(m300Handler->vehicle, recvFrame,
-                                      m300Handler->handler.userData);
-        stereoVGAImg.num_imgs = 0;
-      } else {
-        /*! replace the first VGA image */
-        DSTATUS("#### (1.5) replace the first VGA image");
-        stereoVGAImg.direction = info.rawInfo.direction;
-        stereoVGAImg.frame_index = info.rawInfo.index;
-        stereoVGAImg.time_stamp = info.timeStamp;
-        memcpy(stereoVGAImg.img_vec[0], imageRawBuffer, 480 * 640);
-        stereoVGAImg.num_imgs = 1;
-      }
-      break;
-    default:
-      return;
-  }
-
+  stereoVGAImg.direction = pair.leftInfo.rawInfo.direction;
+  stereoVGAImg.frame_index = pair.leftInfo.rawInfo.index;
+  stereoVGAImg.time_stamp = pair.leftInfo.timeStamp;
+  memcpy(stereoVGAImg.img_vec[0], pair.leftImage, 480 * 640);
+  memcpy(stereoVGAImg.img_vec[1], pair.rightImage, 480 * 640);
+  stereoVGAImg.num_imgs = 2;
+  RecvContainer recvFrame = {0};
+  recvFrame.recvData.stereoVGAImgData = &stereoVGAImg;
+  m300Handler->handler.callback(m300Handler->vehicle, recvFrame,
+                                m300Handler->handler.userData);
 }
 
 
@@ -298,7 +272,7 @@ AdvancedSensing::subscribeFrontStereoVGA(const uint8_t freq,
     static M300VGAHandlerData m300handler;
     m300handler.vehicle = vehicle_ptr;
     m300handler.handler = {callback, userData};
-    perception->subscribePerceptionImage(Perception::RECTIFY_FRONT, M300VGAHandleCB, &m300handler);
+    perception->subscribeStereoPairs(Perception::RECTIFY_FRONT, M300VGAHandleCB, &m300handler);
   }
 }
 
@@ -375,7 +349,7 @@ AdvancedSensing::unsubscribeVGAImages()
 
     sendCommonCmd(NULL, 0, AdvancedSensingProtocol::START_CMD_ID);
   } else if (vehicle_ptr->isM300()) {
-    perception->unsubscribePerceptionImage(Perception::RECTIFY_FRONT);
+    perception->unsubscribeStereoPairs(Perception::RECTIFY_FRONT);
   }
 }
 
@@ -470,6 +444,76 @@ bool AdvancedSensing::getFPVCameraImage(CameraRGBImage& copyOfImage)
 {
   return fpvCam_ptr->getCurrentImage(copyOfImage);
 }
+
+void AdvancedSensing::setSharedCameraDecoding(bool enable, int workers)
+{
+  if (!fpvCam_ptr || !mainCam_ptr)
+  {
+    DERROR("Camera streams are not available on this drone\n");
+    return;
+  }
+
+  /* Kept until destruction, a stream may still be decoding on it */
+  if (enable && !cameraDecodePool)
+  {
+    cameraDecodePool = new DJICameraDecodePool(workers);
+  }
+
+  /* Only the pool changes, the rest of what each stream was set to stays */
+  DJICameraStream* streams[] = {fpvCam_ptr, mainCam_ptr};
+  for (int i = 0; i < 2; i++)
+  {
+    DJICameraDecoderConfig config;
+    streams[i]->getDecoderConfig(config);
+    config.pool = enable ? cameraDecodePool : NULL;
+    streams[i]->setDecoderConfig(config);
+  }
+}
+
+static void setCameraDecodeLatency(DJICameraStream* stream, int maxLatencyMs)
+{
+  if (!stream)
+  {
+    DERROR("Camera streams are not available on this drone\n");
+    return;
+  }
+
+  DJICameraDecoderConfig config;
+  stream->getDecoderConfig(config);
+  config.maxLatencyMs = maxLatencyMs;
+  stream->setDecoderConfig(config);
+}
+
+void AdvancedSensing::setFPVCameraDecodeLatency(int maxLatencyMs)
+{
+  setCameraDecodeLatency(fpvCam_ptr, maxLatencyMs);
+}
+
+void AdvancedSensing::setMainCameraDecodeLatency(int maxLatencyMs)
+{
+  setCameraDecodeLatency(mainCam_ptr, maxLatencyMs);
+}
+
+bool AdvancedSensing::getFPVCameraDecoderStats(DJICameraDecoderStats& stats)
+{
+  if (!fpvCam_ptr)
+  {
+    return false;
+  }
+  fpvCam_ptr->getDecoderStats(stats);
+  return true;
+}
+
+bool AdvancedSensing::getMainCameraDecoderStats(DJICameraDecoderStats& stats)
+{
+  if (!mainCam_ptr)
+  {
+    return false;
+  }
+  mainCam_ptr->getDecoderStats(stats);
+  return true;
+}
+
 void AdvancedSensing::setAcmDevicePath(const char *acm_path)
 {
     this->acm_dev=acm_path;
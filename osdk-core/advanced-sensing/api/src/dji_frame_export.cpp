@@ -0,0 +1,467 @@
+/** @file dji_frame_export.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief Shared memory ring exporting camera and stereo images to other
+ *  processes
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "dji_frame_export.hpp"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include "dji_log.hpp"
+#include "osdk_osal.h"
+
+using namespace DJI;
+using namespace DJI::OSDK;
+
+namespace {
+
+uint64_t monotonicUs() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+size_t pageAlign(size_t len) {
+  size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  return (len + page - 1) / page * page;
+}
+
+/*! Not FUTEX_PRIVATE_FLAG, the waiters are in other processes */
+void futexWait(uint32_t *word, uint32_t value, const struct timespec *timeout) {
+  syscall(SYS_futex, word, FUTEX_WAIT, value, timeout, NULL, 0);
+}
+
+void futexWakeAll(uint32_t *word) {
+  syscall(SYS_futex, word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+}  // namespace
+
+FrameExporter::FrameExporter()
+    : mutex(NULL),
+      ring(NULL),
+      ringSize(0),
+      header(NULL),
+      headerSize(0),
+      slotSize(0),
+      slotCount(0),
+      maxFrameLen(0),
+      published(0) {
+  memset(cameraImages, 0, sizeof(cameraImages));
+  memset(&stats, 0, sizeof(stats));
+  if (OsdkOsal_MutexCreate(&mutex) != OSDK_STAT_OK) {
+    DERROR("Create frame exporter lock failed");
+    mutex = NULL;
+  }
+}
+
+FrameExporter::~FrameExporter() {
+  close();
+  if (mutex) OsdkOsal_MutexDestroy(mutex);
+}
+
+std::string FrameExporter::shmName(const std::string &name) {
+  return (name.empty() || name[0] != '/') ? "/" + name : name;
+}
+
+bool FrameExporter::create(const std::string &ringName, uint32_t slotCount,
+                           uint32_t maxFrameLen) {
+  static_assert(sizeof(SlotHeader) <= SLOT_DATA_OFFSET,
+                "frame info overlaps the pixels");
+  if (!mutex || isOpen() || slotCount < 2 || maxFrameLen == 0) return false;
+
+  std::string path = shmName(ringName);
+  size_t ringHeaderSize = pageAlign(sizeof(RingHeader));
+  size_t ringSlotSize = pageAlign(SLOT_DATA_OFFSET + (size_t)maxFrameLen);
+  size_t size = ringHeaderSize + ringSlotSize * slotCount;
+  if (ringSlotSize > UINT32_MAX) return false;
+
+  /*! Readers still mapping a ring left behind keep it, they see it closed
+   *  or stop getting frames; new readers find the new one */
+  shm_unlink(path.c_str());
+  int fd = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0660);
+  if (fd < 0) {
+    DERROR("Create frame export ring %s failed, errno %d", path.c_str(),
+           errno);
+    return false;
+  }
+  void *mapped = MAP_FAILED;
+  if (ftruncate(fd, (off_t)size) == 0)
+    mapped = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mapped == MAP_FAILED) {
+    DERROR("Map frame export ring %s of %lu bytes failed, errno %d",
+           path.c_str(), (unsigned long)size, errno);
+    shm_unlink(path.c_str());
+    return false;
+  }
+
+  /*! The object comes zeroed, so every slot is empty. Readers only take
+   *  the ring once the magic is there. */
+  RingHeader *ringHeader = (RingHeader *)mapped;
+  ringHeader->version = FORMAT_VERSION;
+  ringHeader->headerSize = (uint32_t)ringHeaderSize;
+  ringHeader->slotCount = slotCount;
+  ringHeader->slotSize = (uint32_t)ringSlotSize;
+  ringHeader->maxFrameLen = maxFrameLen;
+  ringHeader->producerPid = (uint32_t)getpid();
+  __atomic_store_n(&ringHeader->magic, MAGIC, __ATOMIC_RELEASE);
+
+  OsdkOsal_MutexLock(mutex);
+  name = path;
+  ring = (uint8_t *)mapped;
+  ringSize = size;
+  header = ringHeader;
+  headerSize = ringHeaderSize;
+  slotSize = ringSlotSize;
+  this->slotCount = slotCount;
+  this->maxFrameLen = maxFrameLen;
+  published = 0;
+  memset(cameraImages, 0, sizeof(cameraImages));
+  memset(&stats, 0, sizeof(stats));
+  OsdkOsal_MutexUnlock(mutex);
+  return true;
+}
+
+void FrameExporter::close() {
+  if (!mutex) return;
+  OsdkOsal_MutexLock(mutex);
+  if (header) {
+    __atomic_store_n(&header->closed, 1, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&header->futexWord, 1, __ATOMIC_SEQ_CST);
+    futexWakeAll(&header->futexWord);
+    munmap(ring, ringSize);
+    shm_unlink(name.c_str());
+  }
+  ring = NULL;
+  ringSize = 0;
+  header = NULL;
+  OsdkOsal_MutexUnlock(mutex);
+}
+
+bool FrameExporter::isOpen() {
+  if (!mutex) return false;
+  OsdkOsal_MutexLock(mutex);
+  bool open = header != NULL;
+  OsdkOsal_MutexUnlock(mutex);
+  return open;
+}
+
+bool FrameExporter::publish(const FrameInfoType &info, const uint8_t *data) {
+  if (!mutex) return false;
+  OsdkOsal_MutexLock(mutex);
+  if (!header) {
+    OsdkOsal_MutexUnlock(mutex);
+    return false;
+  }
+  if (info.length > maxFrameLen) {
+    stats.oversizeFrames++;
+    OsdkOsal_MutexUnlock(mutex);
+    return false;
+  }
+
+  /*! Only the exporters of this process write, and they take turns on the
+   *  lock; the readers never hold anything up here */
+  uint64_t number = ++published;
+  SlotHeader *slot =
+      (SlotHeader *)(ring + headerSize + slotSize * (number % slotCount));
+
+  /*! A reader seeing the odd sequence, or a newer one after reading,
+   *  drops what it read */
+  __atomic_store_n(&slot->sequence, 2 * number - 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  memcpy((uint8_t *)slot + SLOT_DATA_OFFSET, data, info.length);
+  slot->info = info;
+  slot->info.number = number;
+  slot->info.timeUs = monotonicUs();
+  __atomic_store_n(&slot->sequence, 2 * number, __ATOMIC_RELEASE);
+  __atomic_store_n(&header->published, number, __ATOMIC_RELEASE);
+
+  /*! Pairs with the waiters count a reader raises before it checks for a
+   *  frame: either it sees this frame, or this sees it waiting */
+  __atomic_fetch_add(&header->futexWord, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&header->waiters, __ATOMIC_SEQ_CST)) {
+    futexWakeAll(&header->futexWord);
+    stats.wakeups++;
+  }
+
+  stats.frames++;
+  stats.bytes += info.length;
+  OsdkOsal_MutexUnlock(mutex);
+  return true;
+}
+
+bool FrameExporter::publishCameraImage(const CameraRGBImage &image,
+                                       CameraType camera) {
+  if (!mutex) return false;
+  FrameInfoType info;
+  memset(&info, 0, sizeof(info));
+  info.source = camera == MAIN_CAMERA ? SOURCE_MAIN_CAMERA : SOURCE_FPV_CAMERA;
+  info.format = FORMAT_RGB24;
+  info.width = (uint32_t)image.width;
+  info.height = (uint32_t)image.height;
+  info.stride = (uint32_t)image.width * 3;
+  info.length = (uint32_t)image.rawData.size();
+
+  OsdkOsal_MutexLock(mutex);
+  info.sourceIndex = cameraImages[info.source]++;
+  OsdkOsal_MutexUnlock(mutex);
+  return publish(info, image.rawData.data());
+}
+
+bool FrameExporter::publishImage(const Perception::ImageInfoType &imageInfo,
+                                 const uint8_t *image, uint32_t len) {
+  FrameInfoType info;
+  memset(&info, 0, sizeof(info));
+  info.source = SOURCE_PERCEPTION;
+  info.format = imageInfo.rawInfo.bpp == 2 ? FORMAT_GRAY16 : FORMAT_GRAY8;
+  info.sourceTimeStamp = imageInfo.timeStamp;
+  info.sourceIndex = imageInfo.rawInfo.index;
+  info.dataType = (uint32_t)imageInfo.dataType;
+  info.direction = (uint8_t)imageInfo.rawInfo.direction;
+  info.width = imageInfo.rawInfo.width;
+  info.height = imageInfo.rawInfo.height;
+  info.stride = imageInfo.rawInfo.width * imageInfo.rawInfo.bpp;
+  info.length = len;
+  return publish(info, image);
+}
+
+bool FrameExporter::publishStereoVGA(const ACK::StereoVGAImgData &imgs) {
+  Perception::ImageInfoType info;
+  memset(&info, 0, sizeof(info));
+  info.rawInfo.index = imgs.frame_index;
+  info.rawInfo.direction = (Perception::DirectionType)imgs.direction;
+  info.rawInfo.bpp = 1;
+  info.rawInfo.width = 640;
+  info.rawInfo.height = 480;
+  info.timeStamp = imgs.time_stamp;
+
+  /*! dataId tells the left image, 0, from the right one, 1 */
+  bool published = true;
+  for (uint16_t i = 0; i < 2; i++) {
+    info.dataId = i;
+    published =
+        publishImage(info, imgs.img_vec[i], ACK::IMG_VGA_SIZE) && published;
+  }
+  return published;
+}
+
+void FrameExporter::getStats(StatsType &result) {
+  if (!mutex) {
+    memset(&result, 0, sizeof(result));
+    return;
+  }
+  OsdkOsal_MutexLock(mutex);
+  result = stats;
+  OsdkOsal_MutexUnlock(mutex);
+}
+
+void FrameExporter::fpvCameraImageCallback(CameraRGBImage image,
+                                           void *userData) {
+  if (userData)
+    ((FrameExporter *)userData)->publishCameraImage(image, FPV_CAMERA);
+}
+
+void FrameExporter::mainCameraImageCallback(CameraRGBImage image,
+                                            void *userData) {
+  if (userData)
+    ((FrameExporter *)userData)->publishCameraImage(image, MAIN_CAMERA);
+}
+
+void FrameExporter::perceptionImageCallback(Perception::ImageInfoType info,
+                                            uint8_t *imageRawBuffer,
+                                            int bufferLen, void *userData) {
+  if (userData && imageRawBuffer && bufferLen > 0)
+    ((FrameExporter *)userData)
+        ->publishImage(info, imageRawBuffer, (uint32_t)bufferLen);
+}
+
+FrameExportReader::FrameExportReader()
+    : header(NULL),
+      slots(NULL),
+      slotsSize(0),
+      headerSize(0),
+      slotSize(0),
+      slotCount(0),
+      maxFrameLen(0),
+      lostFrames(0) {}
+
+FrameExportReader::~FrameExportReader() { close(); }
+
+bool FrameExportReader::open(const std::string &ringName) {
+  if (header) return false;
+
+  std::string path = FrameExporter::shmName(ringName);
+  int fd = shm_open(path.c_str(), O_RDWR, 0);
+  if (fd < 0) return false;
+
+  /*! The exporter may still be sizing the object or filling in the header */
+  size_t ringHeaderSize = pageAlign(sizeof(FrameExporter::RingHeader));
+  struct stat st;
+  void *mapped = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && (size_t)st.st_size >= ringHeaderSize)
+    mapped = mmap(NULL, ringHeaderSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                  0);
+  if (mapped == MAP_FAILED) {
+    ::close(fd);
+    return false;
+  }
+
+  /*! Read once: every access later goes by these, whatever the header
+   *  says by then */
+  FrameExporter::RingHeader *ringHeader =
+      (FrameExporter::RingHeader *)mapped;
+  bool ready = __atomic_load_n(&ringHeader->magic, __ATOMIC_ACQUIRE) ==
+               FrameExporter::MAGIC;
+  uint16_t ringVersion = ringHeader->version;
+  size_t ringHeaderSizeTold = ringHeader->headerSize;
+  size_t ringSlotSize = ringHeader->slotSize;
+  uint32_t ringSlotCount = ringHeader->slotCount;
+  uint32_t ringMaxFrameLen = ringHeader->maxFrameLen;
+  size_t size = ringHeaderSize + ringSlotSize * ringSlotCount;
+  if (!ready || ringVersion != FrameExporter::FORMAT_VERSION ||
+      ringHeaderSizeTold != ringHeaderSize || ringSlotCount < 2 ||
+      ringSlotSize < FrameExporter::SLOT_DATA_OFFSET + (size_t)ringMaxFrameLen ||
+      (size_t)st.st_size < size) {
+    munmap(mapped, ringHeaderSize);
+    ::close(fd);
+    return false;
+  }
+
+  /*! Readers cannot touch the frames, only the waiters count */
+  void *mappedSlots = mmap(NULL, size - ringHeaderSize, PROT_READ, MAP_SHARED,
+                           fd, (off_t)ringHeaderSize);
+  ::close(fd);
+  if (mappedSlots == MAP_FAILED) {
+    munmap(mapped, ringHeaderSize);
+    return false;
+  }
+
+  header = ringHeader;
+  slots = (const uint8_t *)mappedSlots;
+  slotsSize = size - ringHeaderSize;
+  headerSize = ringHeaderSize;
+  slotSize = ringSlotSize;
+  slotCount = ringSlotCount;
+  maxFrameLen = ringMaxFrameLen;
+  lostFrames = 0;
+  return true;
+}
+
+void FrameExportReader::close() {
+  if (!header) return;
+  munmap((void *)slots, slotsSize);
+  munmap(header, headerSize);
+  header = NULL;
+  slots = NULL;
+  slotsSize = 0;
+  headerSize = 0;
+  slotSize = 0;
+  slotCount = 0;
+  maxFrameLen = 0;
+}
+
+bool FrameExportReader::isOpen() { return header != NULL; }
+
+const FrameExporter::SlotHeader *FrameExportReader::slotOf(uint64_t number) {
+  return (const FrameExporter::SlotHeader *)(slots +
+                                             slotSize * (number % slotCount));
+}
+
+bool FrameExportReader::waitForFrame(uint64_t &frameNumber, FrameType &frame,
+                                     int timeoutMs, bool latest) {
+  if (!header) return false;
+  uint64_t deadline =
+      monotonicUs() + (uint64_t)(timeoutMs > 0 ? timeoutMs : 0) * 1000;
+
+  while (true) {
+    uint64_t published = __atomic_load_n(&header->published, __ATOMIC_ACQUIRE);
+    if (published > frameNumber) {
+      /*! The oldest frame is the next to go, one after it lasts at least a
+       *  frame longer */
+      uint64_t next = latest ? published : frameNumber + 1;
+      if (published >= slotCount && next < published - slotCount + 2)
+        next = published - slotCount + 2;
+
+      const FrameExporter::SlotHeader *slot = slotOf(next);
+      if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != 2 * next)
+        continue;
+      frame.info = slot->info;
+      frame.data = (const uint8_t *)slot + FrameExporter::SLOT_DATA_OFFSET;
+      if (frame.info.number != next || !isValid(frame)) continue;
+      /*! No exporter writes that, the frame is not handed out */
+      if (frame.info.length > maxFrameLen) {
+        lostFrames += next - frameNumber;
+        frameNumber = next;
+        continue;
+      }
+
+      lostFrames += next - frameNumber - 1;
+      frameNumber = next;
+      return true;
+    }
+
+    if (isExporterClosed()) return false;
+    uint64_t now = monotonicUs();
+    if (timeoutMs >= 0 && now >= deadline) return false;
+
+    __atomic_fetch_add(&header->waiters, 1, __ATOMIC_SEQ_CST);
+    uint32_t word = __atomic_load_n(&header->futexWord, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&header->published, __ATOMIC_ACQUIRE) == published &&
+        !isExporterClosed()) {
+      struct timespec timeout;
+      timeout.tv_sec = (deadline - now) / 1000000;
+      timeout.tv_nsec = (deadline - now) % 1000000 * 1000;
+      futexWait(&header->futexWord, word, timeoutMs >= 0 ? &timeout : NULL);
+    }
+    __atomic_fetch_sub(&header->waiters, 1, __ATOMIC_SEQ_CST);
+  }
+}
+
+bool FrameExportReader::isValid(const FrameType &frame) {
+  if (!header) return false;
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  return __atomic_load_n(&slotOf(frame.info.number)->sequence,
+                         __ATOMIC_RELAXED) == 2 * frame.info.number;
+}
+
+bool FrameExportReader::isExporterClosed() {
+  return !header || __atomic_load_n(&header->closed, __ATOMIC_ACQUIRE);
+}
+
+uint64_t FrameExportReader::getLostFrames() { return lostFrames; }
+
+uint32_t FrameExportReader::getSlotCount() { return slotCount; }
+
+uint32_t FrameExportReader::getMaxFrameLen() { return maxFrameLen; }
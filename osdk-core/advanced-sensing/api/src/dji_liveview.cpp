@@ -54,8 +54,13 @@ LiveView::LiveViewErrCode LiveView::startH264Stream(LiveViewCameraPosition pos,
   }
 }
 
+LiveView::LiveViewErrCode LiveView::startH264Stream(LiveViewCameraPosition pos, DJICameraStreamSource *source,
+                                                    H264Callback cb, void *userData) {
+  return impl->startH264Stream(pos, source, cb, userData);
+}
+
 LiveView::LiveViewErrCode LiveView::stopH264Stream(LiveViewCameraPosition pos) {
-  if (vehicle->isM300()) {
+  if (impl->hasStreamSource(pos) || vehicle->isM300()) {
     return impl->stopH264Stream(pos);
   } else {
     return OSDK_LIVEVIEW_UNSUPPORT_AIRCRAFT;
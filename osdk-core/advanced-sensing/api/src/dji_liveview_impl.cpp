@@ -84,6 +84,9 @@ LiveViewImpl::LiveViewImpl(Vehicle* vehiclePtr) :
 
 LiveViewImpl::~LiveViewImpl()
 {
+  while (!streamSources.empty()) {
+    stopH264Stream(streamSources.begin()->first);
+  }
 }
 
 E_OsdkStat LiveViewImpl::RecordStreamHandler(struct _CommandHandle *cmdHandle,
@@ -125,6 +128,13 @@ E_OsdkStat LiveViewImpl::RecordStreamHandler(struct _CommandHandle *cmdHandle,
   return OSDK_STAT_OK;
 }
 
+void LiveViewImpl::SourceStreamHandler(void *handler, uint8_t *buf, int bufLen) {
+  H264CallbackHandler *h264Handler = (H264CallbackHandler *)handler;
+  if (h264Handler->cb != NULL) {
+    h264Handler->cb(buf, bufLen, h264Handler->userData);
+  }
+}
+
 E_OsdkStat LiveViewImpl::getCameraPushing(struct _CommandHandle *cmdHandle,
                                           const T_CmdInfo *cmdInfo,
                                           const uint8_t *cmdData,
@@ -470,7 +480,44 @@ LiveView::LiveViewErrCode LiveViewImpl::startH264Stream(LiveView::LiveViewCamera
   return LiveView::OSDK_LIVEVIEW_PASS;
 }
 
+LiveView::LiveViewErrCode LiveViewImpl::startH264Stream(LiveView::LiveViewCameraPosition pos, DJICameraStreamSource *source,
+                                                        H264Callback cb, void *userData) {
+  if ((source == NULL) || (h264CbHandlerMap.find(pos) == h264CbHandlerMap.end())) {
+    DERROR("no stream source for camera[%d]\n", pos);
+    return LiveView::OSDK_LIVEVIEW_INDEX_ILLEGAL;
+  }
+  if (hasStreamSource(pos)) {
+    stopH264Stream(pos);
+  }
+
+  h264CbHandlerMap[pos].cb = cb;
+  h264CbHandlerMap[pos].userData = userData;
+  source->registerCallback(SourceStreamHandler, &h264CbHandlerMap[pos]);
+
+  if (!source->init() || !source->start()) {
+    DERROR("stream source of camera[%d] failed to start\n", pos);
+    source->registerCallback(NULL, NULL);
+    return LiveView::OSDK_LIVEVIEW_SUBSCRIBE_FAIL;
+  }
+  streamSources[pos] = source;
+
+  return LiveView::OSDK_LIVEVIEW_PASS;
+}
+
+bool LiveViewImpl::hasStreamSource(LiveView::LiveViewCameraPosition pos) {
+  return streamSources.find(pos) != streamSources.end();
+}
+
 LiveView::LiveViewErrCode LiveViewImpl::stopH264Stream(LiveView::LiveViewCameraPosition pos) {
+  std::map<LiveView::LiveViewCameraPosition, DJICameraStreamSource *>::iterator source =
+      streamSources.find(pos);
+  if (source != streamSources.end()) {
+    source->second->cleanup();
+    source->second->registerCallback(NULL, NULL);
+    streamSources.erase(source);
+    return LiveView::OSDK_LIVEVIEW_PASS;
+  }
+
   unsubscribeLiveViewData(pos);
   stopHeartBeatTask();
   return LiveView::OSDK_LIVEVIEW_PASS;
@@ -45,9 +45,79 @@ Perception::~Perception() {
   if (impl) delete impl;
 }
 
+static Perception::PerceptionErrCode toPerceptionErrCode(E_OsdkStat result) {
+  if (result == OSDK_STAT_OK) return Perception::OSDK_PERCEPTION_PASS;
+  else if (result == OSDK_STAT_ERR_PARAM) return Perception::OSDK_PERCEPTION_PARAM_ERR;
+  else if (result == OSDK_STAT_ERR_TIMEOUT) return Perception::OSDK_PERCEPTION_REQ_REFUSED;
+  else return Perception::OSDK_PERCEPTION_SUBSCRIBE_FAIL;
+}
+
 Perception::PerceptionErrCode Perception::subscribePerceptionImage(DirectionType direction,
                                           PerceptionImageCB cb,
                                           void *userData) {
+  if (direction >= IMAGE_MAX_DIRECTION_NUM) return OSDK_PERCEPTION_PARAM_ERR;
+  ImageQueueConfigType config = {2, QUEUE_DROP_OLDEST};
+  ImageSubscriberID id = 0;
+  PerceptionErrCode ret = addImageSubscriber(direction, cb, userData, config, id);
+  if (ret != OSDK_PERCEPTION_PASS) return ret;
+
+  ImageSubscriberID replaced = impl->directionSubscriber[direction];
+  impl->directionSubscriber[direction] = id;
+  if (replaced) removeImageSubscriber(replaced);
+  return ret;
+}
+
+Perception::PerceptionErrCode Perception::addImageSubscriber(DirectionType direction,
+                                                            PerceptionImageCB cb,
+                                                            void *userData,
+                                                            ImageQueueConfigType config,
+                                                            ImageSubscriberID &id) {
+  if ((direction >= IMAGE_MAX_DIRECTION_NUM) || !cb)
+    return OSDK_PERCEPTION_PARAM_ERR;
+
+  PerceptionImpl::ImageQueuePtr queue = std::make_shared<PerceptionImageQueue>(
+      direction, cb, userData, config);
+  if (!queue->isRunning()) return OSDK_PERCEPTION_SUBSCRIBE_FAIL;
+
+  int count = 0;
+  if (impl->addImageSubscriber(queue, id, count) != OSDK_STAT_OK) {
+    DERROR("Too many subscribers of perception images (DirectionType : %d)",
+           direction);
+    return OSDK_PERCEPTION_PARAM_ERR;
+  }
+  if (count > 1) return OSDK_PERCEPTION_PASS;
+
+  /*! The first subscriber of the direction subscribes its images */
+  PerceptionErrCode ret = subscribeDirection(direction);
+  if (ret != OSDK_PERCEPTION_PASS) {
+    impl->removeImageSubscriber(id, count);
+    queue->stop();
+    id = 0;
+  }
+  return ret;
+}
+
+Perception::PerceptionErrCode Perception::removeImageSubscriber(ImageSubscriberID id) {
+  int count = 0;
+  PerceptionImpl::ImageQueuePtr queue = impl->removeImageSubscriber(id, count);
+  if (!queue) return OSDK_PERCEPTION_PARAM_ERR;
+  queue->stop();
+  if (count > 0) return OSDK_PERCEPTION_PASS;
+
+  /*! The last subscriber of the direction unsubscribes its images */
+  return toPerceptionErrCode(
+      impl->unsubscribePerceptionImage(queue->getDirection()));
+}
+
+Perception::PerceptionErrCode Perception::getImageQueueStats(ImageSubscriberID id,
+                                                            ImageQueueStatsType &stats) {
+  PerceptionImpl::ImageQueuePtr queue = impl->getImageSubscriber(id);
+  if (!queue) return OSDK_PERCEPTION_PARAM_ERR;
+  queue->getStats(stats);
+  return OSDK_PERCEPTION_PASS;
+}
+
+Perception::PerceptionErrCode Perception::subscribeDirection(DirectionType direction) {
   const char *camChoice1;
   const char *camChoice2;
 
@@ -82,7 +152,6 @@ Perception::PerceptionErrCode Perception::subscribePerceptionImage(DirectionType
     DSTATUS("Subscribe perception image %s successfully", camChoice1);
     if (impl->subscribePerceptionImage(camChoice2) == OSDK_STAT_OK) {
       DSTATUS("Subscribe perception image %s successfully", camChoice2);
-      impl->imageHandler = {cb, userData};
       return OSDK_PERCEPTION_PASS;
     } else {
       DERROR("Subscribe perception image %s failed", camChoice2);
@@ -96,14 +165,50 @@ Perception::PerceptionErrCode Perception::subscribePerceptionImage(DirectionType
 }
 
 Perception::PerceptionErrCode Perception::unsubscribePerceptionImage(DirectionType direction) {
-  Perception::PerceptionErrCode ret = OSDK_PERCEPTION_PASS;
-  auto result = impl->unsubscribePerceptionImage(direction);
+  if (direction < IMAGE_MAX_DIRECTION_NUM) {
+    std::vector<PerceptionImpl::ImageQueuePtr> queues =
+        impl->removeImageSubscribers(direction);
+    for (size_t i = 0; i < queues.size(); i++) queues[i]->stop();
+    impl->pairSyncs[direction]->setCallback(NULL, NULL);
+  }
+  return toPerceptionErrCode(impl->unsubscribePerceptionImage(direction));
+}
+
+Perception::PerceptionErrCode Perception::subscribeStereoPairs(DirectionType direction,
+                                                              PerceptionStereoPairCB cb,
+                                                              void *userData) {
+  if ((direction >= IMAGE_MAX_DIRECTION_NUM) || !cb)
+    return OSDK_PERCEPTION_PARAM_ERR;
+  if (impl->pairSubscriber[direction]) unsubscribeStereoPairs(direction);
+
+  /*! Pairing starts before the images do, so the first pair is not lost */
+  StereoPairSync *pairSync = impl->pairSyncs[direction];
+  pairSync->setCallback(cb, userData);
+  ImageQueueConfigType config = {StereoPairSync::RING_SLOTS, QUEUE_DROP_OLDEST};
+  ImageSubscriberID id = 0;
+  PerceptionErrCode ret = addImageSubscriber(
+      direction, PerceptionImpl::stereoPairFeeder, pairSync, config, id);
+  if (ret != OSDK_PERCEPTION_PASS)
+    pairSync->setCallback(NULL, NULL);
+  else
+    impl->pairSubscriber[direction] = id;
+  return ret;
+}
 
-  if (result == OSDK_STAT_OK) return OSDK_PERCEPTION_PASS;
-  else if (result == OSDK_STAT_ERR_PARAM) return OSDK_PERCEPTION_PARAM_ERR;
-  else if (result == OSDK_STAT_ERR_TIMEOUT) return OSDK_PERCEPTION_REQ_REFUSED;
-  else return OSDK_PERCEPTION_SUBSCRIBE_FAIL;
+Perception::PerceptionErrCode Perception::unsubscribeStereoPairs(DirectionType direction) {
+  if (direction >= IMAGE_MAX_DIRECTION_NUM) return OSDK_PERCEPTION_PARAM_ERR;
+  ImageSubscriberID id = impl->pairSubscriber[direction];
+  impl->pairSubscriber[direction] = 0;
+  PerceptionErrCode ret = id ? removeImageSubscriber(id) : OSDK_PERCEPTION_PASS;
+  impl->pairSyncs[direction]->setCallback(NULL, NULL);
+  return ret;
+}
 
+Perception::PerceptionErrCode Perception::getStereoPairStats(DirectionType direction,
+                                                            StereoPairStatsType &stats) {
+  if (direction >= IMAGE_MAX_DIRECTION_NUM) return OSDK_PERCEPTION_PARAM_ERR;
+  impl->pairSyncs[direction]->getStats(stats);
+  return OSDK_PERCEPTION_PASS;
 }
 
 Perception::PerceptionErrCode Perception::triggerStereoCamParamsPushing() {
@@ -122,5 +227,11 @@ void Perception::setStereoCamParamsObserver(PerceptionCamParamCB cb, void *userD
 }
 
 void Perception::cancelAllSubsciptions() {
+  for (int i = 0; i < IMAGE_MAX_DIRECTION_NUM; i++) {
+    std::vector<PerceptionImpl::ImageQueuePtr> queues =
+        impl->removeImageSubscribers((DirectionType) i);
+    for (size_t j = 0; j < queues.size(); j++) queues[j]->stop();
+    impl->pairSyncs[i]->setCallback(NULL, NULL);
+  }
   impl->cancelAllSubsciptions();
 }
@@ -0,0 +1,189 @@
+/** @file dji_perception_image_queue.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief Bounded queue handing perception images to a subscriber task
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "dji_perception_image_queue.hpp"
+#include "dji_log.hpp"
+#include "osdk_osal.h"
+
+using namespace DJI;
+using namespace DJI::OSDK;
+
+PerceptionImageQueue::PerceptionImageQueue(
+    Perception::DirectionType direction, Perception::PerceptionImageCB cb,
+    void *userData, const Perception::ImageQueueConfigType &config)
+    : direction(direction), cb(cb), userData(userData), config(config),
+      mutex(NULL), queuedSem(NULL), freedSem(NULL), stoppedSem(NULL),
+      worker(NULL), stopping(false), queuedHead(0), queuedCount(0),
+      maxDepth(0), delivered(0), dropped(0) {
+  if (this->config.depth == 0) this->config.depth = 1;
+  entries.resize(this->config.depth + 1);
+  queued.resize(this->config.depth);
+  for (size_t i = 0; i < entries.size(); i++) {
+    entries[i].image.reserve(DEFAULT_IMAGE_LEN);
+    freeEntries.push_back(&entries[i]);
+  }
+
+  if (OsdkOsal_MutexCreate(&mutex) != OSDK_STAT_OK ||
+      OsdkOsal_SemaphoreCreate(&queuedSem, 0) != OSDK_STAT_OK ||
+      OsdkOsal_SemaphoreCreate(&freedSem, 0) != OSDK_STAT_OK ||
+      OsdkOsal_SemaphoreCreate(&stoppedSem, 0) != OSDK_STAT_OK) {
+    DERROR("Create perception image queue lock failed");
+    return;
+  }
+  if (OsdkOsal_TaskCreate(&worker, deliverTask, OSDK_TASK_STACK_SIZE_DEFAULT,
+                          this) != OSDK_STAT_OK) {
+    DERROR("Create perception image queue task failed");
+    worker = NULL;
+  }
+}
+
+PerceptionImageQueue::~PerceptionImageQueue() {
+  stop();
+  if (stoppedSem) OsdkOsal_SemaphoreDestroy(stoppedSem);
+  if (freedSem) OsdkOsal_SemaphoreDestroy(freedSem);
+  if (queuedSem) OsdkOsal_SemaphoreDestroy(queuedSem);
+  if (mutex) OsdkOsal_MutexDestroy(mutex);
+}
+
+void PerceptionImageQueue::push(const Perception::ImageInfoType &info,
+                                const uint8_t *image, uint32_t len) {
+  if (!mutex) return;
+  OsdkOsal_MutexLock(mutex);
+  Entry *target = NULL;
+  while (!target) {
+    if (stopping || !worker) {
+      OsdkOsal_MutexUnlock(mutex);
+      return;
+    }
+    if (queuedCount < config.depth && !freeEntries.empty()) {
+      target = freeEntries.back();
+      freeEntries.pop_back();
+    } else if (config.policy == Perception::QUEUE_DROP_NEWEST) {
+      dropped++;
+      OsdkOsal_MutexUnlock(mutex);
+      return;
+    } else if (config.policy == Perception::QUEUE_DROP_OLDEST &&
+               queuedCount > 0) {
+      target = popQueued();
+      dropped++;
+    } else {
+      OsdkOsal_MutexUnlock(mutex);
+      OsdkOsal_SemaphoreWait(freedSem);
+      OsdkOsal_MutexLock(mutex);
+    }
+  }
+  OsdkOsal_MutexUnlock(mutex);
+
+  /*! The entry is ours until queued, copy without holding the lock */
+  target->info = info;
+  target->image.assign(image, image + len);
+
+  OsdkOsal_MutexLock(mutex);
+  if (stopping) {
+    freeEntries.push_back(target);
+    OsdkOsal_MutexUnlock(mutex);
+    return;
+  }
+  queued[(queuedHead + queuedCount) % queued.size()] = target;
+  queuedCount++;
+  if (queuedCount > maxDepth) maxDepth = queuedCount;
+  OsdkOsal_MutexUnlock(mutex);
+  OsdkOsal_SemaphorePost(queuedSem);
+}
+
+void PerceptionImageQueue::stop() {
+  if (!mutex) return;
+  OsdkOsal_MutexLock(mutex);
+  if (stopping || !worker) {
+    OsdkOsal_MutexUnlock(mutex);
+    return;
+  }
+  stopping = true;
+  while (queuedCount > 0) freeEntries.push_back(popQueued());
+  OsdkOsal_MutexUnlock(mutex);
+
+  /*! Wakes a blocked push() and the task, which exits between callbacks */
+  OsdkOsal_SemaphorePost(freedSem);
+  OsdkOsal_SemaphorePost(queuedSem);
+  OsdkOsal_SemaphoreWait(stoppedSem);
+  OsdkOsal_TaskDestroy(worker);
+
+  OsdkOsal_MutexLock(mutex);
+  worker = NULL;
+  OsdkOsal_MutexUnlock(mutex);
+}
+
+PerceptionImageQueue::Entry *PerceptionImageQueue::popQueued() {
+  Entry *entry = queued[queuedHead];
+  queuedHead = (queuedHead + 1) % queued.size();
+  queuedCount--;
+  return entry;
+}
+
+void PerceptionImageQueue::getStats(Perception::ImageQueueStatsType &stats) {
+  if (!mutex) {
+    memset(&stats, 0, sizeof(stats));
+    return;
+  }
+  OsdkOsal_MutexLock(mutex);
+  stats.depth = queuedCount;
+  stats.maxDepth = maxDepth;
+  stats.capacity = config.depth;
+  stats.delivered = delivered;
+  stats.dropped = dropped;
+  OsdkOsal_MutexUnlock(mutex);
+}
+
+void *PerceptionImageQueue::deliverTask(void *arg) {
+  PerceptionImageQueue *self = (PerceptionImageQueue *)arg;
+  for (;;) {
+    OsdkOsal_SemaphoreWait(self->queuedSem);
+    OsdkOsal_MutexLock(self->mutex);
+    if (self->stopping) {
+      OsdkOsal_MutexUnlock(self->mutex);
+      OsdkOsal_SemaphorePost(self->stoppedSem);
+      return NULL;
+    }
+    if (self->queuedCount == 0) {
+      OsdkOsal_MutexUnlock(self->mutex);
+      continue;
+    }
+    Entry *entry = self->popQueued();
+    OsdkOsal_MutexUnlock(self->mutex);
+
+    self->cb(entry->info, entry->image.data(), (int)entry->image.size(),
+             self->userData);
+
+    OsdkOsal_MutexLock(self->mutex);
+    self->freeEntries.push_back(entry);
+    self->delivered++;
+    OsdkOsal_MutexUnlock(self->mutex);
+    if (self->config.policy == Perception::QUEUE_BLOCK)
+      OsdkOsal_SemaphorePost(self->freedSem);
+  }
+}
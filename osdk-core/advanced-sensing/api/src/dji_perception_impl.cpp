@@ -52,6 +52,11 @@ uint32_t PerceptionImpl::imageUpdateSysMs[] = {0};
 
 PerceptionImpl::PerceptionImageHandler PerceptionImpl::imageHandler = {NULL, NULL};
 PerceptionImpl::PerceptionCamParamHandler PerceptionImpl::camParamHandler = {NULL, NULL};
+StereoPairSync *PerceptionImpl::pairSyncs[] = {NULL};
+T_OsdkMutexHandle PerceptionImpl::subscriberMutex = NULL;
+PerceptionImpl::ImageSubscriber PerceptionImpl::subscribers
+    [IMAGE_MAX_DIRECTION_NUM][MAX_SUBSCRIBERS_PER_DIRECTION];
+Perception::ImageSubscriberID PerceptionImpl::lastSubscriberID = 0;
 
 T_RecvCmdItem s_bulkCmdList[] = {
     PROT_CMD_ITEM(0, 0, 0x24, 0x13, MASK_HOST_DEVICE_SET_ID, &PerceptionImpl::imageHandler,
@@ -64,6 +69,16 @@ T_RecvCmdItem s_v1CmdList[] = {
 };
 
 PerceptionImpl::PerceptionImpl(Vehicle* vehiclePtr) : vehicle(vehiclePtr) {
+  if (!subscriberMutex && OsdkOsal_MutexCreate(&subscriberMutex) != OSDK_STAT_OK) {
+    DERROR("Create perception subscriber lock failed!");
+    subscriberMutex = NULL;
+  }
+  for (int i = 0; i < IMAGE_MAX_DIRECTION_NUM; i++) {
+    if (!pairSyncs[i]) pairSyncs[i] = new StereoPairSync();
+    directionSubscriber[i] = 0;
+    pairSubscriber[i] = 0;
+  }
+
   T_RecvCmdHandle recvCmdHandle1;
   T_RecvCmdHandle recvCmdHandle2;
 
@@ -85,6 +100,103 @@ PerceptionImpl::PerceptionImpl(Vehicle* vehiclePtr) : vehicle(vehiclePtr) {
 
 PerceptionImpl::~PerceptionImpl()
 {
+  for (int i = 0; i < IMAGE_MAX_DIRECTION_NUM; i++) {
+    vector<ImageQueuePtr> queues =
+        removeImageSubscribers((Perception::DirectionType) i);
+    for (size_t j = 0; j < queues.size(); j++) queues[j]->stop();
+    if (pairSyncs[i]) pairSyncs[i]->setCallback(NULL, NULL);
+  }
+}
+
+E_OsdkStat PerceptionImpl::addImageSubscriber(const ImageQueuePtr &queue,
+                                              Perception::ImageSubscriberID &id,
+                                              int &count) {
+  Perception::DirectionType direction = queue->getDirection();
+  if (!subscriberMutex || direction >= IMAGE_MAX_DIRECTION_NUM)
+    return OSDK_STAT_ERR_PARAM;
+
+  E_OsdkStat ret = OSDK_STAT_ERR_OUT_OF_RANGE;
+  count = 0;
+  OsdkOsal_MutexLock(subscriberMutex);
+  for (int i = 0; i < MAX_SUBSCRIBERS_PER_DIRECTION; i++) {
+    ImageSubscriber &subscriber = subscribers[direction][i];
+    if (!subscriber.queue && ret != OSDK_STAT_OK) {
+      if (++lastSubscriberID == 0) ++lastSubscriberID;
+      subscriber.id = lastSubscriberID;
+      subscriber.queue = queue;
+      id = subscriber.id;
+      ret = OSDK_STAT_OK;
+    }
+    if (subscriber.queue) count++;
+  }
+  OsdkOsal_MutexUnlock(subscriberMutex);
+  return ret;
+}
+
+PerceptionImpl::ImageQueuePtr PerceptionImpl::removeImageSubscriber(
+    Perception::ImageSubscriberID id, int &count) {
+  ImageQueuePtr queue;
+  count = 0;
+  if (!subscriberMutex || id == 0) return queue;
+
+  OsdkOsal_MutexLock(subscriberMutex);
+  for (int dir = 0; dir < IMAGE_MAX_DIRECTION_NUM && !queue; dir++) {
+    for (int i = 0; i < MAX_SUBSCRIBERS_PER_DIRECTION; i++) {
+      if (subscribers[dir][i].queue && subscribers[dir][i].id == id) {
+        queue.swap(subscribers[dir][i].queue);
+        subscribers[dir][i].id = 0;
+      }
+    }
+    if (queue) {
+      for (int i = 0; i < MAX_SUBSCRIBERS_PER_DIRECTION; i++)
+        if (subscribers[dir][i].queue) count++;
+    }
+  }
+  OsdkOsal_MutexUnlock(subscriberMutex);
+  return queue;
+}
+
+vector<PerceptionImpl::ImageQueuePtr> PerceptionImpl::removeImageSubscribers(
+    Perception::DirectionType direction) {
+  vector<ImageQueuePtr> queues;
+  if (!subscriberMutex || direction >= IMAGE_MAX_DIRECTION_NUM) return queues;
+
+  OsdkOsal_MutexLock(subscriberMutex);
+  for (int i = 0; i < MAX_SUBSCRIBERS_PER_DIRECTION; i++) {
+    if (subscribers[direction][i].queue) {
+      queues.push_back(subscribers[direction][i].queue);
+      subscribers[direction][i].queue.reset();
+      subscribers[direction][i].id = 0;
+    }
+  }
+  OsdkOsal_MutexUnlock(subscriberMutex);
+  directionSubscriber[direction] = 0;
+  pairSubscriber[direction] = 0;
+  return queues;
+}
+
+PerceptionImpl::ImageQueuePtr PerceptionImpl::getImageSubscriber(
+    Perception::ImageSubscriberID id) {
+  ImageQueuePtr queue;
+  if (!subscriberMutex || id == 0) return queue;
+
+  OsdkOsal_MutexLock(subscriberMutex);
+  for (int dir = 0; dir < IMAGE_MAX_DIRECTION_NUM && !queue; dir++) {
+    for (int i = 0; i < MAX_SUBSCRIBERS_PER_DIRECTION; i++) {
+      if (subscribers[dir][i].queue && subscribers[dir][i].id == id)
+        queue = subscribers[dir][i].queue;
+    }
+  }
+  OsdkOsal_MutexUnlock(subscriberMutex);
+  return queue;
+}
+
+void PerceptionImpl::stereoPairFeeder(Perception::ImageInfoType info,
+                                      uint8_t *imageRawBuffer, int bufferLen,
+                                      void *userData) {
+  StereoPairSync *pairSync = (StereoPairSync *) userData;
+  if (pairSync && pairSync->isEnabled())
+    pairSync->push(info, imageRawBuffer, bufferLen);
 }
 
 vector<Perception::DirectionType> PerceptionImpl::getUpdatingDiretcion() {
@@ -121,18 +233,25 @@ E_OsdkStat PerceptionImpl::cameraImageHandler(struct _CommandHandle *cmdHandle,
     return OSDK_STAT_SYS_ERR;
   }
 
-  PerceptionImageHandler *handler = (PerceptionImageHandler *) userData;
-  if (header->rawInfo.direction < IMAGE_MAX_DIRECTION_NUM)
-    OsdkOsal_GetTimeMs(&imageUpdateSysMs[header->rawInfo.direction]);
-
-  if (handler->cb)
-    handler->cb(*header,
-                (uint8_t *) (cmdData + sizeof(Perception::ImageInfoType)),
-                cmdInfo->dataLen - sizeof(Perception::ImageInfoType),
-                handler->userData);
-  else {
-//    DERROR("Callback is a null value");
+  uint8_t direction = header->rawInfo.direction;
+  if (direction >= IMAGE_MAX_DIRECTION_NUM || !subscriberMutex)
+    return OSDK_STAT_OK;
+  OsdkOsal_GetTimeMs(&imageUpdateSysMs[direction]);
+
+  /*! The subscribers copy the image into their queues, none of them runs on
+   *  this thread */
+  ImageQueuePtr queues[MAX_SUBSCRIBERS_PER_DIRECTION];
+  int count = 0;
+  OsdkOsal_MutexLock(subscriberMutex);
+  for (int i = 0; i < MAX_SUBSCRIBERS_PER_DIRECTION; i++) {
+    if (subscribers[direction][i].queue)
+      queues[count++] = subscribers[direction][i].queue;
   }
+  OsdkOsal_MutexUnlock(subscriberMutex);
+
+  for (int i = 0; i < count; i++)
+    queues[i]->push(*header, cmdData + sizeof(Perception::ImageInfoType),
+                    cmdInfo->dataLen - sizeof(Perception::ImageInfoType));
 #if 0
   if(writePictureData(cmdData + IMAGE_INFO_LEN, cmdInfo->dataLen - IMAGE_INFO_LEN) != 0) {
      printf("write image failed!\n");
@@ -168,13 +287,6 @@ E_OsdkStat PerceptionImpl::cameraParamHandler(struct _CommandHandle *cmdHandle,
 }
 
 E_OsdkStat PerceptionImpl::subscribePerceptionImage(const char camChoice[11]) {
-  vector<Perception::DirectionType> updatingDirection = getUpdatingDiretcion();
-  if (updatingDirection.size()) {
-    DERROR("Now the direction [(DirectionType)%d] images are updating.", updatingDirection[0]);
-    DERROR("Only the SINGLE direction subscription is allowed in current OSDK version. ");
-    DERROR("Please do unsubscription firstly before do new subscribing");
-    return OSDK_STAT_NOT_READY;
-  }
   T_CmdInfo info;
   T_CmdInfo ackInfo;
   uint8_t ackData[1024];
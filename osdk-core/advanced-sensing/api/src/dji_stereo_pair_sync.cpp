@@ -0,0 +1,201 @@
+/** @file dji_stereo_pair_sync.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief Pairing of the left and right perception camera images
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "dji_stereo_pair_sync.hpp"
+#include <string.h>
+#include <chrono>
+#include "dji_log.hpp"
+#include "osdk_osal.h"
+
+using namespace DJI;
+using namespace DJI::OSDK;
+
+StereoPairSync::StereoPairSync()
+    : mutex(NULL), cb(NULL), userData(NULL), enabled(false), pairs(0),
+      unmatched(0), lastLatencyUs(0), maxLatencyUs(0), totalLatencyUs(0) {
+  if (OsdkOsal_MutexCreate(&mutex) != OSDK_STAT_OK) {
+    DERROR("Stereo pair mutex create failed");
+  }
+  for (uint32_t i = 0; i < RING_SLOTS; i++) slots[i].used = false;
+}
+
+StereoPairSync::~StereoPairSync() {
+  if (mutex) OsdkOsal_MutexDestroy(mutex);
+}
+
+void StereoPairSync::setCallback(Perception::PerceptionStereoPairCB cb,
+                                 void *userData) {
+  OsdkOsal_MutexLock(mutex);
+  for (uint32_t i = 0; i < RING_SLOTS; i++) {
+    slots[i].used = false;
+    if (cb) {
+      slots[i].image.reserve(DEFAULT_IMAGE_LEN);
+    } else {
+      std::vector<uint8_t>().swap(slots[i].image);
+    }
+  }
+  if (cb) {
+    pairs = 0;
+    unmatched = 0;
+    lastLatencyUs = 0;
+    maxLatencyUs = 0;
+    totalLatencyUs = 0;
+  }
+  this->cb = cb;
+  this->userData = userData;
+  enabled = (cb != NULL);
+  OsdkOsal_MutexUnlock(mutex);
+}
+
+bool StereoPairSync::isEnabled() const { return enabled; }
+
+void StereoPairSync::push(const Perception::ImageInfoType &info,
+                          const uint8_t *image, uint32_t len) {
+  if (!enabled) return;
+
+  OsdkOsal_MutexLock(mutex);
+  if (!cb) {
+    OsdkOsal_MutexUnlock(mutex);
+    return;
+  }
+  uint64_t nowUs = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+
+  bool left = isLeft(info);
+  for (uint32_t i = 0; i < RING_SLOTS; i++) {
+    if (slots[i].used && slots[i].isLeft != left &&
+        isSameFrame(slots[i].info, info)) {
+      deliver(slots[i], info, image, len, nowUs);
+      OsdkOsal_MutexUnlock(mutex);
+      return;
+    }
+  }
+  store(info, image, len, nowUs);
+  OsdkOsal_MutexUnlock(mutex);
+}
+
+void StereoPairSync::getStats(Perception::StereoPairStatsType &stats) const {
+  if (!mutex) {
+    memset(&stats, 0, sizeof(stats));
+    return;
+  }
+  OsdkOsal_MutexLock(mutex);
+  stats.pairs = pairs;
+  stats.unmatched = unmatched;
+  stats.lastLatencyUs = lastLatencyUs;
+  stats.maxLatencyUs = maxLatencyUs;
+  stats.totalLatencyUs = totalLatencyUs;
+  OsdkOsal_MutexUnlock(mutex);
+}
+
+bool StereoPairSync::isLeft(const Perception::ImageInfoType &info) {
+  /*! RECTIFY_xx_LEFT are odd, RECTIFY_xx_RIGHT even */
+  return (info.dataType & 1) != 0;
+}
+
+bool StereoPairSync::isSameFrame(const Perception::ImageInfoType &a,
+                                 const Perception::ImageInfoType &b) {
+  return a.rawInfo.index == b.rawInfo.index && a.timeStamp == b.timeStamp;
+}
+
+bool StereoPairSync::isOlderFrame(const Perception::ImageInfoType &a,
+                                  const Perception::ImageInfoType &b) {
+  if (a.rawInfo.index != b.rawInfo.index)
+    return (int32_t)(a.rawInfo.index - b.rawInfo.index) < 0;
+  return a.timeStamp < b.timeStamp;
+}
+
+void StereoPairSync::deliver(Slot &waiting,
+                             const Perception::ImageInfoType &info,
+                             const uint8_t *image, uint32_t len,
+                             uint64_t nowUs) {
+  Perception::StereoPairType pair;
+  if (waiting.isLeft) {
+    pair.leftInfo = waiting.info;
+    pair.leftImage = waiting.image.data();
+    pair.leftLen = waiting.image.size();
+    pair.rightInfo = info;
+    pair.rightImage = image;
+    pair.rightLen = len;
+  } else {
+    pair.leftInfo = info;
+    pair.leftImage = image;
+    pair.leftLen = len;
+    pair.rightInfo = waiting.info;
+    pair.rightImage = waiting.image.data();
+    pair.rightLen = waiting.image.size();
+  }
+
+  uint32_t latencyUs = (uint32_t)(nowUs - waiting.arrivalUs);
+  lastLatencyUs = latencyUs;
+  if (latencyUs > maxLatencyUs) maxLatencyUs = latencyUs;
+  totalLatencyUs += latencyUs;
+  pairs++;
+
+  cb(pair, userData);
+  waiting.used = false;
+  dropOlderThan(info);
+}
+
+void StereoPairSync::dropOlderThan(const Perception::ImageInfoType &info) {
+  for (uint32_t i = 0; i < RING_SLOTS; i++) {
+    if (slots[i].used && isOlderFrame(slots[i].info, info)) {
+      slots[i].used = false;
+      unmatched++;
+    }
+  }
+}
+
+void StereoPairSync::store(const Perception::ImageInfoType &info,
+                           const uint8_t *image, uint32_t len,
+                           uint64_t nowUs) {
+  bool left = isLeft(info);
+  Slot *target = NULL;
+  for (uint32_t i = 0; i < RING_SLOTS && !target; i++) {
+    /*! The same image again replaces the one waiting */
+    if (slots[i].used && slots[i].isLeft == left &&
+        isSameFrame(slots[i].info, info))
+      target = &slots[i];
+  }
+  for (uint32_t i = 0; i < RING_SLOTS && !target; i++) {
+    if (!slots[i].used) target = &slots[i];
+  }
+  if (!target) {
+    target = &slots[0];
+    for (uint32_t i = 1; i < RING_SLOTS; i++) {
+      if (slots[i].arrivalUs < target->arrivalUs) target = &slots[i];
+    }
+    unmatched++;
+  }
+
+  target->used = true;
+  target->isLeft = left;
+  target->info = info;
+  target->arrivalUs = nowUs;
+  target->image.assign(image, image + len);
+}
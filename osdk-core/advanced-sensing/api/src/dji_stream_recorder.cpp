@@ -0,0 +1,641 @@
+/** @file dji_stream_recorder.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief Recorder of LiveView H.264 and perception image streams
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "dji_stream_recorder.hpp"
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "dji_log.hpp"
+#include "osdk_osal.h"
+
+using namespace DJI;
+using namespace DJI::OSDK;
+
+namespace {
+
+/*! RecordHeader::type of the space left at the end of the ring when a
+ *  record did not fit there */
+const uint8_t RECORD_SKIP = 0xFF;
+
+/*! Rice codes with a quotient this large are written as the quotient and
+ *  the residual in 8 bits, so no pixel takes more than 32 bits */
+const uint32_t RICE_ESCAPE = 24;
+const uint32_t RICE_MAX_K = 7;
+const uint32_t RICE_CONTEXTS = 8;
+const uint32_t RICE_RESCALE = 64;
+
+uint32_t align8(uint32_t len) { return (len + 7) & ~7u; }
+
+uint64_t nowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/*! Median edge detector of LOCO-I: a left, b above, c above left */
+inline int predictMED(int a, int b, int c) {
+  int lo = a < b ? a : b;
+  int hi = a < b ? b : a;
+  if (c >= hi) return lo;
+  if (c <= lo) return hi;
+  return a + b - c;
+}
+
+/*! Contexts split the pixels by how busy their neighbourhood is, flat
+ *  areas get small Rice parameters without edges inflating them */
+inline uint32_t riceContext(int a, int b, int c) {
+  uint32_t activity = (uint32_t)(abs(a - c) + abs(b - c));
+  uint32_t ctx = activity ? 32 - __builtin_clz(activity) : 0;
+  return ctx < RICE_CONTEXTS ? ctx : RICE_CONTEXTS - 1;
+}
+
+typedef struct RiceContext {
+  uint32_t sum;
+  uint32_t count;
+} RiceContext;
+
+inline uint32_t riceParameter(const RiceContext &ctx) {
+  uint32_t k = 0;
+  while (k < RICE_MAX_K && (ctx.count << k) < ctx.sum) k++;
+  return k;
+}
+
+inline void riceUpdate(RiceContext &ctx, uint32_t mapped) {
+  ctx.sum += mapped;
+  if (++ctx.count == RICE_RESCALE) {
+    ctx.sum >>= 1;
+    ctx.count >>= 1;
+  }
+}
+
+typedef struct BitWriter {
+  uint8_t *out;
+  uint32_t pos;
+  uint64_t acc;
+  uint32_t bits;
+
+  /*! n up to 32 */
+  inline void put(uint32_t value, uint32_t n) {
+    acc = (acc << n) | value;
+    bits += n;
+    while (bits >= 8) {
+      bits -= 8;
+      out[pos++] = (uint8_t)(acc >> bits);
+    }
+  }
+
+  inline void flush() {
+    if (bits) out[pos++] = (uint8_t)(acc << (8 - bits));
+    bits = 0;
+  }
+} BitWriter;
+
+typedef struct BitReader {
+  const uint8_t *in;
+  uint32_t len;
+  uint32_t pos;
+  uint64_t acc;
+  uint32_t bits;
+  /*! Bits handed out beyond the input, as zeros */
+  uint32_t overrun;
+
+  inline void refill() {
+    while (bits <= 56) {
+      uint8_t byte = 0;
+      if (pos < len)
+        byte = in[pos++];
+      else
+        overrun += 8;
+      acc = (acc << 8) | byte;
+      bits += 8;
+    }
+  }
+
+  /*! The next 32 bits, refill() first */
+  inline uint32_t peek32() const { return (uint32_t)(acc >> (bits - 32)); }
+
+  inline void skip(uint32_t n) { bits -= n; }
+
+  inline uint32_t get(uint32_t n) {
+    if (n == 0) return 0;
+    bits -= n;
+    return (uint32_t)(acc >> bits) & ((1u << n) - 1);
+  }
+} BitReader;
+
+}  // namespace
+
+StreamRecorder::StreamRecorder(uint32_t bufferSize)
+    : mutex(NULL), recordedSem(NULL), stoppedSem(NULL), writer(NULL),
+      stopping(true), uncommitted(0), head(0), tail(0), used(0), maxUsed(0),
+      h264File(NULL), framesFile(NULL), indexFile(NULL), h264Offset(0),
+      framesOffset(0), h264Sequence(0), frameSequence(0) {
+  memset(&stats, 0, sizeof(stats));
+  ring.resize(align8(bufferSize));
+  if (OsdkOsal_MutexCreate(&mutex) != OSDK_STAT_OK) {
+    DERROR("Create stream recorder lock failed");
+    mutex = NULL;
+  }
+}
+
+StreamRecorder::~StreamRecorder() {
+  close();
+  if (mutex) OsdkOsal_MutexDestroy(mutex);
+}
+
+bool StreamRecorder::open(const std::string &basePath) {
+  if (!mutex || isOpen()) return false;
+
+  h264File = fopen((basePath + ".h264").c_str(), "wb");
+  framesFile = fopen((basePath + ".frames").c_str(), "wb");
+  indexFile = fopen((basePath + ".index").c_str(), "wb");
+  IndexHeaderType indexHeader = {INDEX_MAGIC, FORMAT_VERSION,
+                                 (uint16_t)sizeof(IndexRecordType)};
+  if (!h264File || !framesFile || !indexFile ||
+      fwrite(&indexHeader, sizeof(indexHeader), 1, indexFile) != 1) {
+    DERROR("Create stream record files %s failed", basePath.c_str());
+    if (h264File) fclose(h264File);
+    if (framesFile) fclose(framesFile);
+    if (indexFile) fclose(indexFile);
+    h264File = framesFile = indexFile = NULL;
+    return false;
+  }
+
+  head = tail = used = maxUsed = 0;
+  h264Offset = framesOffset = 0;
+  h264Sequence = frameSequence = 0;
+  memset(&stats, 0, sizeof(stats));
+
+  T_OsdkTaskHandle task = NULL;
+  if (OsdkOsal_SemaphoreCreate(&recordedSem, 0) != OSDK_STAT_OK ||
+      OsdkOsal_SemaphoreCreate(&stoppedSem, 0) != OSDK_STAT_OK ||
+      OsdkOsal_TaskCreate(&task, writeTask, OSDK_TASK_STACK_SIZE_DEFAULT,
+                          this) != OSDK_STAT_OK) {
+    DERROR("Create stream recorder task failed");
+    close();
+    return false;
+  }
+
+  /*! Recording starts here, the task only exits once stopping is set */
+  OsdkOsal_MutexLock(mutex);
+  writer = task;
+  stopping = false;
+  OsdkOsal_MutexUnlock(mutex);
+  return true;
+}
+
+void StreamRecorder::close() {
+  if (!mutex) return;
+  OsdkOsal_MutexLock(mutex);
+  bool running = writer && !stopping;
+  stopping = true;
+  OsdkOsal_MutexUnlock(mutex);
+
+  if (running) {
+    /*! The task exits once it wrote everything recorded before */
+    OsdkOsal_SemaphorePost(recordedSem);
+    OsdkOsal_SemaphoreWait(stoppedSem);
+    OsdkOsal_TaskDestroy(writer);
+    OsdkOsal_MutexLock(mutex);
+    writer = NULL;
+    OsdkOsal_MutexUnlock(mutex);
+  }
+
+  if (h264File) fclose(h264File);
+  if (framesFile) fclose(framesFile);
+  if (indexFile) fclose(indexFile);
+  h264File = framesFile = indexFile = NULL;
+  if (stoppedSem) OsdkOsal_SemaphoreDestroy(stoppedSem);
+  if (recordedSem) OsdkOsal_SemaphoreDestroy(recordedSem);
+  stoppedSem = recordedSem = NULL;
+}
+
+bool StreamRecorder::isOpen() {
+  if (!mutex) return false;
+  OsdkOsal_MutexLock(mutex);
+  bool open = writer && !stopping;
+  OsdkOsal_MutexUnlock(mutex);
+  return open;
+}
+
+bool StreamRecorder::recordH264(const uint8_t *buf, uint32_t len) {
+  RecordHeader *record = reserve(len);
+  if (!record) {
+    OsdkOsal_MutexLock(mutex);
+    stats.droppedPackets++;
+    OsdkOsal_MutexUnlock(mutex);
+    return false;
+  }
+  record->type = STREAM_H264;
+  memcpy(record + 1, buf, len);
+  commit(record);
+  return true;
+}
+
+bool StreamRecorder::recordImage(const Perception::ImageInfoType &info,
+                                 const uint8_t *image, uint32_t len) {
+  RecordHeader *record = reserve(len);
+  if (!record) {
+    OsdkOsal_MutexLock(mutex);
+    stats.droppedFrames++;
+    OsdkOsal_MutexUnlock(mutex);
+    return false;
+  }
+  record->type = STREAM_GRAY_FRAME;
+  record->info = info;
+  memcpy(record + 1, image, len);
+  commit(record);
+  return true;
+}
+
+bool StreamRecorder::recordStereoVGA(const ACK::StereoVGAImgData &imgs) {
+  Perception::ImageInfoType info;
+  memset(&info, 0, sizeof(info));
+  info.rawInfo.index = imgs.frame_index;
+  info.rawInfo.direction = (Perception::DirectionType)imgs.direction;
+  info.rawInfo.bpp = 1;
+  info.rawInfo.width = 640;
+  info.rawInfo.height = 480;
+  info.timeStamp = imgs.time_stamp;
+
+  /*! dataId tells the left image, 0, from the right one, 1 */
+  bool recorded = true;
+  for (uint16_t i = 0; i < 2; i++) {
+    info.dataId = i;
+    recorded = recordImage(info, imgs.img_vec[i], ACK::IMG_VGA_SIZE) && recorded;
+  }
+  return recorded;
+}
+
+void StreamRecorder::getStats(StatsType &result) {
+  if (!mutex) {
+    memset(&result, 0, sizeof(result));
+    return;
+  }
+  OsdkOsal_MutexLock(mutex);
+  result = stats;
+  result.buffered = used;
+  result.maxBuffered = maxUsed;
+  result.bufferSize = (uint32_t)ring.size();
+  OsdkOsal_MutexUnlock(mutex);
+}
+
+void StreamRecorder::h264Callback(uint8_t *buf, int bufLen, void *userData) {
+  if (userData && buf && bufLen > 0)
+    ((StreamRecorder *)userData)->recordH264(buf, (uint32_t)bufLen);
+}
+
+void StreamRecorder::perceptionImageCallback(Perception::ImageInfoType info,
+                                             uint8_t *imageRawBuffer,
+                                             int bufferLen, void *userData) {
+  if (userData && imageRawBuffer && bufferLen > 0)
+    ((StreamRecorder *)userData)
+        ->recordImage(info, imageRawBuffer, (uint32_t)bufferLen);
+}
+
+StreamRecorder::RecordHeader *StreamRecorder::reserve(uint32_t payloadLen) {
+  if (!mutex) return NULL;
+  uint32_t capacity = (uint32_t)ring.size();
+  if (capacity < sizeof(RecordHeader) ||
+      payloadLen > capacity - sizeof(RecordHeader))
+    return NULL;
+  uint32_t size = align8(sizeof(RecordHeader) + payloadLen);
+
+  OsdkOsal_MutexLock(mutex);
+  if (stopping || !writer || size > capacity) {
+    OsdkOsal_MutexUnlock(mutex);
+    return NULL;
+  }
+
+  /*! Records are kept whole, one that does not fit before the end of the
+   *  ring goes to its start and the end is skipped */
+  if (used == 0) head = tail = 0;
+  uint32_t at = capacity;
+  uint32_t skipped = 0;
+  if (used > 0 && head == tail) {
+    /*! full */
+  } else if (head < tail) {
+    if (tail - head >= size) at = head;
+  } else if (capacity - head >= size) {
+    at = head;
+  } else if (tail >= size) {
+    skipped = capacity - head;
+    at = 0;
+  }
+  if (at == capacity) {
+    OsdkOsal_MutexUnlock(mutex);
+    return NULL;
+  }
+
+  if (skipped >= sizeof(RecordHeader)) {
+    RecordHeader *skip = (RecordHeader *)&ring[head];
+    skip->size = skipped;
+    skip->type = RECORD_SKIP;
+    skip->ready = 1;
+  }
+  RecordHeader *record = (RecordHeader *)&ring[at];
+  record->size = size;
+  record->ready = 0;
+  record->payloadLen = payloadLen;
+  head = (at + size) % capacity;
+  used += skipped + size;
+  if (used > maxUsed) maxUsed = used;
+  record->timeUs = nowUs();
+  uncommitted++;
+  OsdkOsal_MutexUnlock(mutex);
+  return record;
+}
+
+void StreamRecorder::commit(RecordHeader *record) {
+  OsdkOsal_MutexLock(mutex);
+  record->ready = 1;
+  uncommitted--;
+  /*! Under the lock: the writer stops, and close() destroys the semaphore,
+   *  only once it saw uncommitted drop to 0 */
+  OsdkOsal_SemaphorePost(recordedSem);
+  OsdkOsal_MutexUnlock(mutex);
+}
+
+StreamRecorder::RecordHeader *StreamRecorder::oldestRecord() {
+  uint32_t capacity = (uint32_t)ring.size();
+  if (used == 0) return NULL;
+  /*! Too little room for a skip record, the producer went to the start */
+  if (capacity - tail < sizeof(RecordHeader)) {
+    used -= capacity - tail;
+    tail = 0;
+    if (used == 0) return NULL;
+  }
+  RecordHeader *record = (RecordHeader *)&ring[tail];
+  return record->ready ? record : NULL;
+}
+
+void StreamRecorder::release(RecordHeader *record) {
+  OsdkOsal_MutexLock(mutex);
+  tail = (tail + record->size) % (uint32_t)ring.size();
+  used -= record->size;
+  OsdkOsal_MutexUnlock(mutex);
+}
+
+void *StreamRecorder::writeTask(void *arg) {
+  StreamRecorder *self = (StreamRecorder *)arg;
+  for (;;) {
+    OsdkOsal_SemaphoreWait(self->recordedSem);
+    for (;;) {
+      OsdkOsal_MutexLock(self->mutex);
+      RecordHeader *record = self->oldestRecord();
+      bool done = !record && self->stopping && self->uncommitted == 0;
+      OsdkOsal_MutexUnlock(self->mutex);
+      if (done) {
+        fflush(self->h264File);
+        fflush(self->framesFile);
+        fflush(self->indexFile);
+        OsdkOsal_SemaphorePost(self->stoppedSem);
+        return NULL;
+      }
+      if (!record) break;
+
+      /*! The record stays ours until released, write without the lock */
+      if (record->type == STREAM_H264)
+        self->writeH264(record);
+      else if (record->type == STREAM_GRAY_FRAME)
+        self->writeFrame(record);
+      self->release(record);
+    }
+  }
+}
+
+void StreamRecorder::writeH264(const RecordHeader *record) {
+  const uint8_t *payload = (const uint8_t *)(record + 1);
+  bool written =
+      fwrite(payload, 1, record->payloadLen, h264File) == record->payloadLen;
+  writeIndex(record, h264Offset, record->payloadLen, h264Sequence++,
+             hasKeyframe(payload, record->payloadLen) ? INDEX_FLAG_KEYFRAME : 0,
+             0);
+  h264Offset += record->payloadLen;
+
+  OsdkOsal_MutexLock(mutex);
+  stats.h264Packets++;
+  stats.h264Bytes += record->payloadLen;
+  if (!written) stats.writeErrors++;
+  OsdkOsal_MutexUnlock(mutex);
+}
+
+void StreamRecorder::writeFrame(const RecordHeader *record) {
+  const uint8_t *image = (const uint8_t *)(record + 1);
+  const Perception::RawImageInfoType &raw = record->info.rawInfo;
+
+  FrameHeaderType header;
+  memset(&header, 0, sizeof(header));
+  header.magic = FRAME_MAGIC;
+  header.codec = FRAME_CODEC_RAW;
+  header.direction = raw.direction;
+  header.dataId = record->info.dataId;
+  header.dataType = record->info.dataType;
+  header.index = raw.index;
+  header.sequence = record->info.sequence;
+  header.timeStamp = record->info.timeStamp;
+  header.width = raw.width;
+  header.height = raw.height;
+  header.rawLen = record->payloadLen;
+  header.payloadLen = record->payloadLen;
+
+  /*! Only 8 bit images are compressed, a larger result is stored raw */
+  const uint8_t *payload = image;
+  if (raw.bpp == 1 && raw.width && raw.height &&
+      (uint64_t)raw.width * raw.height == record->payloadLen) {
+    uint32_t bound = 4 * record->payloadLen + 8;
+    if (compressed.size() < bound) compressed.resize(bound);
+    uint32_t len = compressFrame(image, raw.width, raw.height, &compressed[0]);
+    if (len < record->payloadLen) {
+      header.codec = FRAME_CODEC_MED_RICE;
+      header.payloadLen = len;
+      payload = &compressed[0];
+    }
+  }
+
+  bool written =
+      fwrite(&header, sizeof(header), 1, framesFile) == 1 &&
+      fwrite(payload, 1, header.payloadLen, framesFile) == header.payloadLen;
+  uint32_t length = sizeof(header) + header.payloadLen;
+  writeIndex(record, framesOffset, length, frameSequence++, 0, raw.direction);
+  framesOffset += length;
+
+  OsdkOsal_MutexLock(mutex);
+  stats.frames++;
+  stats.frameRawBytes += record->payloadLen;
+  stats.frameFileBytes += length;
+  if (!written) stats.writeErrors++;
+  OsdkOsal_MutexUnlock(mutex);
+}
+
+void StreamRecorder::writeIndex(const RecordHeader *record, uint64_t offset,
+                                uint32_t length, uint32_t sequence,
+                                uint8_t flags, uint8_t direction) {
+  IndexRecordType entry;
+  memset(&entry, 0, sizeof(entry));
+  entry.timeUs = record->timeUs;
+  entry.offset = offset;
+  entry.length = length;
+  entry.sequence = sequence;
+  entry.stream = record->type;
+  entry.flags = flags;
+  entry.direction = direction;
+  if (fwrite(&entry, sizeof(entry), 1, indexFile) != 1) {
+    OsdkOsal_MutexLock(mutex);
+    stats.writeErrors++;
+    OsdkOsal_MutexUnlock(mutex);
+  }
+}
+
+bool StreamRecorder::hasKeyframe(const uint8_t *buf, uint32_t len) {
+  /*! Annex B start codes followed by an IDR slice or a sequence parameter
+   *  set, playback can start there */
+  for (uint32_t i = 0; i + 3 < len; i++) {
+    if (buf[i + 2] > 1) {
+      i += 2;
+      continue;
+    }
+    if (buf[i] == 0 && buf[i + 1] == 0 && buf[i + 2] == 1) {
+      uint8_t type = buf[i + 3] & 0x1F;
+      if (type == 5 || type == 7) return true;
+    }
+  }
+  return false;
+}
+
+uint32_t StreamRecorder::compressFrame(const uint8_t *image, uint32_t width,
+                                       uint32_t height, uint8_t *out) {
+  RiceContext contexts[RICE_CONTEXTS];
+  for (uint32_t i = 0; i < RICE_CONTEXTS; i++) contexts[i] = {4, 1};
+  BitWriter writer = {out, 0, 0, 0};
+
+  for (uint32_t v = 0; v < height; v++) {
+    const uint8_t *row = image + v * width;
+    const uint8_t *above = v ? row - width : NULL;
+    for (uint32_t u = 0; u < width; u++) {
+      int b = above ? above[u] : (u ? row[u - 1] : 0);
+      int a = u ? row[u - 1] : b;
+      int c = above && u ? above[u - 1] : b;
+
+      RiceContext &ctx = contexts[riceContext(a, b, c)];
+      int8_t residual = (int8_t)(uint8_t)(row[u] - predictMED(a, b, c));
+      uint32_t mapped = residual >= 0 ? 2 * residual : -2 * residual - 1;
+      uint32_t k = riceParameter(ctx);
+      uint32_t q = mapped >> k;
+      if (q < RICE_ESCAPE) {
+        writer.put(((1u << q) - 1) << 1, q + 1);
+        writer.put(mapped & ((1u << k) - 1), k);
+      } else {
+        writer.put((1u << RICE_ESCAPE) - 1, RICE_ESCAPE);
+        writer.put(mapped, 8);
+      }
+      riceUpdate(ctx, mapped);
+    }
+  }
+  writer.flush();
+  return writer.pos;
+}
+
+bool StreamRecorder::decodeFrame(const FrameHeaderType &header,
+                                 const uint8_t *payload, uint8_t *image) {
+  if (header.magic != FRAME_MAGIC) return false;
+  if (header.codec == FRAME_CODEC_RAW) {
+    if (header.payloadLen != header.rawLen) return false;
+    memcpy(image, payload, header.rawLen);
+    return true;
+  }
+  if (header.codec != FRAME_CODEC_MED_RICE ||
+      (uint64_t)header.width * header.height != header.rawLen)
+    return false;
+
+  RiceContext contexts[RICE_CONTEXTS];
+  for (uint32_t i = 0; i < RICE_CONTEXTS; i++) contexts[i] = {4, 1};
+  BitReader reader = {payload, header.payloadLen, 0, 0, 0, 0};
+
+  const uint32_t width = header.width;
+  for (uint32_t v = 0; v < header.height; v++) {
+    uint8_t *row = image + v * width;
+    const uint8_t *above = v ? row - width : NULL;
+    for (uint32_t u = 0; u < width; u++) {
+      int b = above ? above[u] : (u ? row[u - 1] : 0);
+      int a = u ? row[u - 1] : b;
+      int c = above && u ? above[u - 1] : b;
+
+      RiceContext &ctx = contexts[riceContext(a, b, c)];
+      uint32_t k = riceParameter(ctx);
+      reader.refill();
+      uint32_t ones = __builtin_clz(~reader.peek32() | 1);
+      uint32_t mapped;
+      if (ones < RICE_ESCAPE) {
+        reader.skip(ones + 1);
+        mapped = (ones << k) | reader.get(k);
+      } else {
+        reader.skip(RICE_ESCAPE);
+        mapped = reader.get(8);
+      }
+      if (mapped > 255) return false;
+      riceUpdate(ctx, mapped);
+
+      int residual = (mapped & 1) ? -(int)((mapped + 1) >> 1) : (int)(mapped >> 1);
+      row[u] = (uint8_t)(predictMED(a, b, c) + residual);
+    }
+  }
+  return reader.overrun <= reader.bits;
+}
+
+bool StreamRecorder::readIndex(const std::string &basePath,
+                               std::vector<IndexRecordType> &records) {
+  records.clear();
+  FILE *file = fopen((basePath + ".index").c_str(), "rb");
+  if (!file) return false;
+
+  IndexHeaderType header;
+  bool ok = fread(&header, sizeof(header), 1, file) == 1 &&
+            header.magic == INDEX_MAGIC &&
+            header.recordSize == sizeof(IndexRecordType);
+  IndexRecordType record;
+  while (ok && fread(&record, sizeof(record), 1, file) == 1)
+    records.push_back(record);
+  fclose(file);
+  return ok;
+}
+
+size_t StreamRecorder::seekIndex(const std::vector<IndexRecordType> &records,
+                                 uint64_t timeUs, StreamType stream) {
+  size_t lo = 0;
+  size_t hi = records.size();
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (records[mid].timeUs < timeUs)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  while (lo < records.size() && records[lo].stream != stream) lo++;
+  return lo;
+}
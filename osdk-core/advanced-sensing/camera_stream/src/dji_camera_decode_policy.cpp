@@ -0,0 +1,119 @@
+/*
+ * DJI Onboard SDK Advanced Sensing APIs
+ *
+ * Copyright (c) 2017-2026 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ * @file dji_camera_decode_policy.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ */
+
+#include "dji_camera_decode_policy.hpp"
+
+/* Late frames in a row before stepping down */
+static const uint32_t LATE_FRAMES_TO_STEP_DOWN = 3;
+/* No frame over half the limit for this long before stepping up */
+static const int64_t  ON_TIME_US_TO_STEP_UP    = 3000000;
+
+DJICameraDecodePolicy::DJICameraDecodePolicy(int maxLatencyMs)
+  : level(LEVEL_FULL),
+    levelChanges(0)
+{
+  reset(maxLatencyMs);
+}
+
+void DJICameraDecodePolicy::reset(int maxLatencyMs)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  maxLatencyUs = (int64_t)maxLatencyMs * 1000;
+  level        = LEVEL_FULL;
+  levelChanges = 0;
+  levelSinceUs = 0;
+  lateFrames   = 0;
+  slowSinceUs  = 0;
+}
+
+DJICameraDecodePolicy::Level DJICameraDecodePolicy::update(int64_t packetTimeUs,
+                                                           int64_t deliveredTimeUs)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  if (maxLatencyUs <= 0)
+  {
+    return LEVEL_FULL;
+  }
+
+  int64_t latencyUs = deliveredTimeUs - packetTimeUs;
+  if (latencyUs > maxLatencyUs)
+  {
+    slowSinceUs = deliveredTimeUs;
+    /* Queued before the last step, it says nothing of the level now */
+    if (packetTimeUs >= levelSinceUs &&
+        ++lateFrames >= LATE_FRAMES_TO_STEP_DOWN &&
+        level < LEVEL_KEYFRAMES_ONLY)
+    {
+      setLevel(level + 1, deliveredTimeUs);
+    }
+  }
+  else
+  {
+    lateFrames = 0;
+    if (latencyUs * 2 > maxLatencyUs)
+    {
+      slowSinceUs = deliveredTimeUs;
+    }
+    stepUpIfOnTime(deliveredTimeUs);
+  }
+  return (Level)level.load();
+}
+
+DJICameraDecodePolicy::Level DJICameraDecodePolicy::poll(int64_t nowUs)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  if (maxLatencyUs > 0)
+  {
+    stepUpIfOnTime(nowUs);
+  }
+  return (Level)level.load();
+}
+
+DJICameraDecodePolicy::Level DJICameraDecodePolicy::getLevel() const
+{
+  return (Level)level.load();
+}
+
+uint64_t DJICameraDecodePolicy::getLevelChanges() const
+{
+  return levelChanges;
+}
+
+void DJICameraDecodePolicy::stepUpIfOnTime(int64_t nowUs)
+{
+  if (level > LEVEL_FULL && nowUs - slowSinceUs >= ON_TIME_US_TO_STEP_UP)
+  {
+    setLevel(level - 1, nowUs);
+  }
+}
+
+void DJICameraDecodePolicy::setLevel(int newLevel, int64_t timeUs)
+{
+  level        = newLevel;
+  levelChanges++;
+  levelSinceUs = timeUs;
+  lateFrames   = 0;
+  slowSinceUs  = timeUs;
+}
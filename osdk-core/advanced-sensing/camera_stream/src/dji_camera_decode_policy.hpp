@@ -0,0 +1,77 @@
+/** @file dji_camera_decode_policy.hpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief How much of a camera stream to decode, from how late its frames
+ *  come out
+
+ *  @copyright 2026 DJI. All rights reserved.
+ *
+ */
+
+#ifndef DJICAMERADECODEPOLICY_HH
+#define DJICAMERADECODEPOLICY_HH
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+
+/*! @brief Steps decoding down while frames are delivered later than
+ *  maxLatencyMs after their packet arrived, and back up once they have
+ *  been on time for a while.
+ *
+ *  A step down only follows frames whose packets arrived after the last
+ *  step, so the backlog from before it does not count twice. A step up
+ *  only needs time without a slow frame, so a level that delivers few
+ *  frames or none, like LEVEL_KEYFRAMES_ONLY on a stream without them,
+ *  is left too.
+ */
+class DJICameraDecodePolicy
+{
+public:
+  enum Level
+  {
+    LEVEL_FULL = 0,
+    /* Frames no other frame refers to are not decoded */
+    LEVEL_SKIP_NON_REFERENCE,
+    /* Besides, images at half width and height, without deblocking */
+    LEVEL_HALF_SIZE,
+    /* Only frames decodable on their own */
+    LEVEL_KEYFRAMES_ONLY
+  };
+
+  /* maxLatencyMs: 0 stays at LEVEL_FULL */
+  DJICameraDecodePolicy(int maxLatencyMs = 0);
+
+  void reset(int maxLatencyMs);
+
+  /* From the conversion stage, after each frame delivered; times in
+   * microseconds of one clock. Returns the level from now on. */
+  Level update(int64_t packetTimeUs, int64_t deliveredTimeUs);
+
+  /* From the decoding stage, before each packet, whether frames come out
+   * or not. Returns the level from now on. */
+  Level poll(int64_t nowUs);
+
+  /* From any thread */
+  Level getLevel() const;
+
+  uint64_t getLevelChanges() const;
+
+private:
+  /* Called locked */
+  void stepUpIfOnTime(int64_t nowUs);
+  void setLevel(int newLevel, int64_t timeUs);
+
+  std::mutex       mutex;
+  int64_t          maxLatencyUs;
+  std::atomic<int> level;
+  std::atomic<uint64_t> levelChanges;
+
+  int64_t  levelSinceUs;
+  uint32_t lateFrames;
+  /* Last frame over half the limit, or the last step if later */
+  int64_t  slowSinceUs;
+};
+
+#endif // DJICAMERADECODEPOLICY_HH
@@ -0,0 +1,187 @@
+/*
+ * DJI Onboard SDK Advanced Sensing APIs
+ *
+ * Copyright (c) 2017-2026 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ * @file dji_camera_decode_pool.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ */
+
+#include "dji_camera_decode_pool.hpp"
+#include "dji_log.hpp"
+
+#include <unistd.h>
+#include <algorithm>
+
+struct DJICameraDecodePool::Strand
+{
+  std::deque<Job> jobs;
+  /* In runnable or running */
+  bool scheduled;
+  bool running;
+};
+
+DJICameraDecodePool::DJICameraDecodePool(int workerCount)
+  : stopping(false),
+    pendingJobs(0)
+{
+  pthread_mutex_init(&mutex, NULL);
+  pthread_cond_init(&jobCond, NULL);
+  pthread_cond_init(&idleCond, NULL);
+
+  if (workerCount <= 0)
+  {
+    workerCount = std::max(1L, sysconf(_SC_NPROCESSORS_ONLN));
+  }
+  for (int i = 0; i < workerCount; ++i)
+  {
+    pthread_t worker;
+    if (0 != pthread_create(&worker, NULL, workerEntry, this))
+    {
+      DERROR_PRIVATE("Decode pool: creating worker %d failed\n", i);
+      break;
+    }
+    workers.push_back(worker);
+  }
+}
+
+DJICameraDecodePool::~DJICameraDecodePool()
+{
+  pthread_mutex_lock(&mutex);
+  stopping = true;
+  pthread_cond_broadcast(&jobCond);
+  pthread_mutex_unlock(&mutex);
+
+  for (size_t i = 0; i < workers.size(); ++i)
+  {
+    pthread_join(workers[i], NULL);
+  }
+
+  pthread_cond_destroy(&idleCond);
+  pthread_cond_destroy(&jobCond);
+  pthread_mutex_destroy(&mutex);
+}
+
+int DJICameraDecodePool::getWorkerCount()
+{
+  return (int)workers.size();
+}
+
+DJICameraDecodePool::Strand* DJICameraDecodePool::createStrand()
+{
+  Strand* strand    = new Strand;
+  strand->scheduled = false;
+  strand->running   = false;
+  return strand;
+}
+
+void DJICameraDecodePool::destroyStrand(Strand* strand)
+{
+  if (!strand)
+  {
+    return;
+  }
+
+  pthread_mutex_lock(&mutex);
+  pendingJobs -= strand->jobs.size();
+  strand->jobs.clear();
+  while (strand->running)
+  {
+    pthread_cond_wait(&idleCond, &mutex);
+  }
+  std::deque<Strand*>::iterator queued =
+    std::find(runnable.begin(), runnable.end(), strand);
+  if (queued != runnable.end())
+  {
+    runnable.erase(queued);
+  }
+  pthread_mutex_unlock(&mutex);
+
+  delete strand;
+}
+
+void DJICameraDecodePool::post(Strand* strand, Job job)
+{
+  pthread_mutex_lock(&mutex);
+  strand->jobs.push_back(job);
+  pendingJobs++;
+  if (!strand->scheduled)
+  {
+    strand->scheduled = true;
+    runnable.push_back(strand);
+    pthread_cond_signal(&jobCond);
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+size_t DJICameraDecodePool::getPendingJobs()
+{
+  pthread_mutex_lock(&mutex);
+  size_t jobs = pendingJobs;
+  pthread_mutex_unlock(&mutex);
+  return jobs;
+}
+
+void* DJICameraDecodePool::workerEntry(void* p)
+{
+  static_cast<DJICameraDecodePool*>(p)->workerFunc();
+  return NULL;
+}
+
+void DJICameraDecodePool::workerFunc()
+{
+  pthread_mutex_lock(&mutex);
+  while (true)
+  {
+    while (!stopping && runnable.empty())
+    {
+      pthread_cond_wait(&jobCond, &mutex);
+    }
+    if (stopping)
+    {
+      break;
+    }
+
+    Strand* strand = runnable.front();
+    runnable.pop_front();
+    Job job = strand->jobs.front();
+    strand->jobs.pop_front();
+    strand->running = true;
+    pthread_mutex_unlock(&mutex);
+
+    job();
+    job = Job();
+
+    pthread_mutex_lock(&mutex);
+    strand->running = false;
+    pendingJobs--;
+    if (strand->jobs.empty())
+    {
+      strand->scheduled = false;
+    }
+    else
+    {
+      /* Behind the strands waiting, one job a turn */
+      runnable.push_back(strand);
+      pthread_cond_signal(&jobCond);
+    }
+    pthread_cond_broadcast(&idleCond);
+  }
+  pthread_mutex_unlock(&mutex);
+}
@@ -0,0 +1,131 @@
+/** @file dji_camera_decode_pool.hpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief Worker threads shared by the decoders of several camera streams
+
+ *  @copyright 2026 DJI. All rights reserved.
+ *
+ */
+
+#ifndef DJICAMERADECODEPOOL_HH
+#define DJICAMERADECODEPOOL_HH
+
+#include <stdint.h>
+#include <deque>
+#include <functional>
+#include <vector>
+#include "pthread.h"
+
+class DJICameraDecodePool;
+
+/*! @brief How DJICameraStreamDecoder decodes and converts */
+struct DJICameraDecoderConfig
+{
+  enum
+  {
+    /* Consecutive frames decoded on different threads: the most
+     * throughput, but a frame comes out threadCount - 1 frames later, so
+     * only for streams not watched live */
+    THREAD_FRAME = 1,
+    /* The slices of a frame decoded on different threads, no delay; only
+     * helps streams coded with several slices per frame */
+    THREAD_SLICE = 2
+  };
+
+  /* Threads of the codec, 0 for one per core; one by default, so a
+   * picture comes out of the packet it came in */
+  int threadCount;
+  /* THREAD_FRAME and/or THREAD_SLICE, THREAD_SLICE by default */
+  int threadType;
+  /* Frames decoded but not converted yet the decoder keeps, the oldest is
+   * dropped for a new one beyond; 0 keeps every frame */
+  int maxPendingFrames;
+  /* Frames delivered later than this after their packet make the decoder
+   * step down, see DJICameraDecodePolicy; 0 decodes everything always */
+  int maxLatencyMs;
+  /* NULL: decoding runs on the thread calling decodeBuffer() and the
+   * colour conversion on a thread of the decoder. Otherwise both run as
+   * jobs of the pool, so decoders share its threads and decodeBuffer()
+   * returns at once. */
+  DJICameraDecodePool* pool;
+
+  DJICameraDecoderConfig()
+    : threadCount(1),
+      threadType(THREAD_SLICE),
+      maxPendingFrames(4),
+      maxLatencyMs(0),
+      pool(NULL)
+  {
+  }
+};
+
+/*! @brief Counters of a DJICameraStreamDecoder since init() */
+struct DJICameraDecoderStats
+{
+  uint64_t packets;
+  uint64_t decodedFrames;
+  /* Not decoded, as the decode policy asked */
+  uint64_t skippedFrames;
+  uint64_t convertedFrames;
+  /* Decoded but dropped for a newer frame before conversion */
+  uint64_t droppedFrames;
+  /* Delivered but replaced before the user callback thread took them */
+  uint64_t overwrittenImages;
+  uint64_t decodeErrors;
+  /* DJICameraDecodePolicy::Level now, and how often it changed */
+  int      policyLevel;
+  uint64_t policyChanges;
+  /* From decodeBuffer() given a frame to its RGB image being delivered */
+  double   meanLatencyMs;
+  double   maxLatencyMs;
+};
+
+/*! @brief Runs jobs on a fixed set of threads.
+ *
+ *  Jobs are posted to a strand: those of one strand run one at a time and
+ *  in order, those of different strands in parallel. Strands with jobs
+ *  take turns, one job each, so a decoder busy with a keyframe does not
+ *  hold up the others while a thread is free.
+ */
+class DJICameraDecodePool
+{
+public:
+  typedef std::function<void()> Job;
+
+  struct Strand;
+
+  /* workers: threads, 0 for one per core */
+  DJICameraDecodePool(int workers = 0);
+  /* Waits for the running jobs, the pending ones are dropped */
+  ~DJICameraDecodePool();
+
+  int getWorkerCount();
+
+  Strand* createStrand();
+
+  /* Waits for the job of the strand running, if any, and drops the pending
+   * ones. Not from a job of the strand itself. */
+  void destroyStrand(Strand* strand);
+
+  void post(Strand* strand, Job job);
+
+  /* Jobs posted and not finished, of every strand */
+  size_t getPendingJobs();
+
+private:
+  static void* workerEntry(void* p);
+  void workerFunc();
+
+  pthread_mutex_t mutex;
+  pthread_cond_t  jobCond;
+  pthread_cond_t  idleCond;
+  bool            stopping;
+
+  std::vector<pthread_t> workers;
+  /* Strands with jobs and none running, in turn */
+  std::deque<Strand*>    runnable;
+  size_t                 pendingJobs;
+};
+
+#endif // DJICAMERADECODEPOOL_HH
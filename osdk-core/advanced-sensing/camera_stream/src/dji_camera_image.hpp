@@ -9,6 +9,7 @@
 #ifndef ADVANCED_SENSING_DJI_CAMERA_IMAGE_HPP
 #define ADVANCED_SENSING_DJI_CAMERA_IMAGE_HPP
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 /*! @brief Data structure for the image frames from the
@@ -22,6 +23,11 @@ struct CameraRGBImage
   int width;
 };
 
+/*! @brief A decoded image shared by its readers: read-only, and never
+ *  written again while someone holds it
+ */
+typedef std::shared_ptr<const CameraRGBImage> CameraRGBImagePtr;
+
 /*! @brief User callback function called by OSDK (in a dedicated thread)
  *  when a new image frame from camera is received.
  */
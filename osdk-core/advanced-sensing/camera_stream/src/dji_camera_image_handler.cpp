@@ -25,68 +25,201 @@
 
 #include "dji_camera_image_handler.hpp"
 
-DJICameraImageHandler::DJICameraImageHandler():m_newImageFlag(false)
+#include <errno.h>
+#include <time.h>
+#include <vector>
+
+/* Readers rarely hold more than a couple of images at once */
+static const size_t MAX_SPARE_IMAGES = 4;
+
+struct DJICameraImageHandler::Slot : public CameraRGBImage
+{
+  uint64_t sequence;
+};
+
+struct DJICameraImageHandler::Recycler
+{
+  pthread_mutex_t    mutex;
+  std::vector<Slot*> spare;
+  bool               closed;
+
+  Recycler() : closed(false)
+  {
+    pthread_mutex_init(&mutex, NULL);
+  }
+
+  ~Recycler()
+  {
+    for (size_t i = 0; i < spare.size(); ++i)
+    {
+      delete spare[i];
+    }
+    pthread_mutex_destroy(&mutex);
+  }
+};
+
+/* Deleter giving the slot back once the last reader lets go; it outlives
+ * the handler if a reader does */
+struct DJICameraImageHandler::ReturnSlot
+{
+  std::shared_ptr<Recycler> recycler;
+
+  void operator()(Slot* slot) const
+  {
+    pthread_mutex_lock(&recycler->mutex);
+    if (!recycler->closed && recycler->spare.size() < MAX_SPARE_IMAGES)
+    {
+      recycler->spare.push_back(slot);
+      slot = NULL;
+    }
+    pthread_mutex_unlock(&recycler->mutex);
+    delete slot;
+  }
+};
+
+DJICameraImageHandler::DJICameraImageHandler()
+  : m_recycler(new Recycler),
+    m_sequence(0),
+    m_waiters(0),
+    m_readSequence(0)
 {
   pthread_mutex_init(&m_mutex, NULL);
-  pthread_cond_init(&m_condv, NULL);
+
+  /* Timeouts against the monotonic clock, a clock step cannot cut them */
+  pthread_condattr_t attr;
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&m_condv, &attr);
+  pthread_condattr_destroy(&attr);
 }
 
 DJICameraImageHandler::~DJICameraImageHandler()
 {
+  std::atomic_store(&m_latest, CameraRGBImagePtr());
+  pthread_mutex_lock(&m_recycler->mutex);
+  m_recycler->closed = true;
+  pthread_mutex_unlock(&m_recycler->mutex);
+
   pthread_mutex_destroy(&m_mutex);
   pthread_cond_destroy(&m_condv);
 }
 
-bool DJICameraImageHandler::getNewImageWithLock(CameraRGBImage & copyOfImage, int timeoutMilliSec)
+uint64_t DJICameraImageHandler::sequenceOf(const CameraRGBImagePtr& image)
 {
-  int result = -1;
+  return image ? static_cast<const Slot*>(image.get())->sequence : 0;
+}
 
-  /*! @note
-   * Here result == 0 means successful.
-   * Because this is the behavior of pthread_cond_timedwait.
-   */
-  pthread_mutex_lock(&m_mutex);
-  if(m_newImageFlag)
+std::shared_ptr<CameraRGBImage> DJICameraImageHandler::acquireImage(int width, int height)
+{
+  Slot* slot = NULL;
+  pthread_mutex_lock(&m_recycler->mutex);
+  if (!m_recycler->spare.empty())
   {
-    /* At this point, a copy of m_img is made, so it is safe to 
-     * do any modifications to copyOfImage in user code.
-     */
-    copyOfImage = m_img;
-    m_newImageFlag = false;
-    result = 0;
+    slot = m_recycler->spare.back();
+    m_recycler->spare.pop_back();
   }
-  else
+  pthread_mutex_unlock(&m_recycler->mutex);
+  if (!slot)
   {
-    struct timespec absTimeout;
-    clock_gettime(CLOCK_REALTIME, &absTimeout);
-    absTimeout.tv_nsec += timeoutMilliSec * 1e6;
-    result = pthread_cond_timedwait(&m_condv, &m_mutex, &absTimeout);
-
-    if(result == 0)
-    {
-      copyOfImage = m_img;
-      m_newImageFlag = false;
-    }
+    slot = new Slot;
   }
-  pthread_mutex_unlock(&m_mutex);
-  return (result == 0) ? true : false;
+
+  slot->rawData.resize((size_t)width * height * 3);
+  slot->width    = width;
+  slot->height   = height;
+  slot->sequence = 0;
+
+  ReturnSlot deleter = { m_recycler };
+  return std::shared_ptr<CameraRGBImage>(slot, deleter);
 }
 
-bool DJICameraImageHandler::newImageIsReady()
+void DJICameraImageHandler::publishImage(const std::shared_ptr<CameraRGBImage>& image)
 {
-  return m_newImageFlag;
+  /* One writer, so the sequence needs no read-modify-write */
+  uint64_t sequence = m_sequence.load() + 1;
+  static_cast<Slot*>(image.get())->sequence = sequence;
+  std::atomic_store(&m_latest, CameraRGBImagePtr(image));
+  m_sequence.store(sequence);
+
+  /* A reader counts itself in before it checks m_sequence, so either it
+   * sees the new image or it is waiting here */
+  if (m_waiters.load() > 0)
+  {
+    pthread_mutex_lock(&m_mutex);
+    pthread_cond_broadcast(&m_condv);
+    pthread_mutex_unlock(&m_mutex);
+  }
 }
 
 void DJICameraImageHandler::writeNewImageWithLock(uint8_t* buf, int bufSize, int width, int height)
 {
-  pthread_mutex_lock(&m_mutex);
+  std::shared_ptr<CameraRGBImage> image = acquireImage(width, height);
+  image->rawData.assign(buf, buf + bufSize);
+  publishImage(image);
+}
+
+uint64_t DJICameraImageHandler::getLatestImage(CameraRGBImagePtr& image)
+{
+  image = std::atomic_load(&m_latest);
+  return sequenceOf(image);
+}
+
+bool DJICameraImageHandler::waitForNewerImage(uint64_t& sequence, CameraRGBImagePtr& image,
+                                              int timeoutMilliSec)
+{
+  CameraRGBImagePtr latest = std::atomic_load(&m_latest);
+  if (sequenceOf(latest) <= sequence && timeoutMilliSec > 0)
+  {
+    struct timespec absTimeout;
+    clock_gettime(CLOCK_MONOTONIC, &absTimeout);
+    absTimeout.tv_sec  += timeoutMilliSec / 1000;
+    absTimeout.tv_nsec += (long)(timeoutMilliSec % 1000) * 1000000;
+    if (absTimeout.tv_nsec >= 1000000000)
+    {
+      absTimeout.tv_sec  += 1;
+      absTimeout.tv_nsec -= 1000000000;
+    }
+
+    pthread_mutex_lock(&m_mutex);
+    m_waiters++;
+    int result = 0;
+    while (m_sequence.load() <= sequence && result != ETIMEDOUT)
+    {
+      result = pthread_cond_timedwait(&m_condv, &m_mutex, &absTimeout);
+    }
+    m_waiters--;
+    pthread_mutex_unlock(&m_mutex);
+
+    latest = std::atomic_load(&m_latest);
+  }
+
+  if (sequenceOf(latest) <= sequence)
+  {
+    return false;
+  }
+  sequence = sequenceOf(latest);
+  image    = latest;
+  return true;
+}
 
-  m_img.rawData.assign(buf, buf+bufSize);
-  m_img.height = height;
-  m_img.width  = width;
-  m_newImageFlag = true;
+bool DJICameraImageHandler::getNewImageWithLock(CameraRGBImage & copyOfImage, int timeoutMilliSec)
+{
+  uint64_t          sequence = m_readSequence.load();
+  CameraRGBImagePtr image;
+  if (!waitForNewerImage(sequence, image, timeoutMilliSec))
+  {
+    return false;
+  }
 
-  pthread_cond_signal(&m_condv);
-  pthread_mutex_unlock(&m_mutex);
+  /* At this point, a copy of the image is made, so it is safe to
+   * do any modifications to copyOfImage in user code.
+   */
+  copyOfImage = *image;
+  m_readSequence.store(sequence);
+  return true;
 }
 
+bool DJICameraImageHandler::newImageIsReady()
+{
+  return m_sequence.load() > m_readSequence.load();
+}
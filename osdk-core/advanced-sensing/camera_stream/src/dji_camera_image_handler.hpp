@@ -12,25 +12,60 @@
 #ifndef DJICAMERAIMAGEHANDLER_HH
 #define DJICAMERAIMAGEHANDLER_HH
 
+#include <atomic>
+#include <memory>
 #include "pthread.h"
 #include "dji_camera_image.hpp"
 
+/*! @brief The latest decoded image, for one writer and any number of readers.
+ *
+ *  Readers share the published image instead of copying it, each keeping
+ *  its own sequence to wait for a newer one; neither side holds a lock
+ *  while the other copies or converts.
+ */
 class DJICameraImageHandler
 {
 public:
   DJICameraImageHandler();
   ~DJICameraImageHandler();
 
+  /* Of the reader of getNewImageWithLock() */
   bool newImageIsReady();
 
   void writeNewImageWithLock(uint8_t* buf, int bufSize, int width, int height);
+  /* A copy of an image newer than the last one it returned;
+   * timeoutMilliSec: 0 returns at once */
   bool getNewImageWithLock(CameraRGBImage & copyOfImage, int timeoutMilliSec);
 
+  /* The writer without a copy: fills the image acquired, then publishes it */
+  std::shared_ptr<CameraRGBImage> acquireImage(int width, int height);
+  void publishImage(const std::shared_ptr<CameraRGBImage>& image);
+
+  /* The latest image and its sequence, 0 before the first */
+  uint64_t getLatestImage(CameraRGBImagePtr& image);
+  /* Waits up to timeoutMilliSec for an image newer than sequence, then sets
+   * both; 0 returns at once. false on timeout. */
+  bool waitForNewerImage(uint64_t& sequence, CameraRGBImagePtr& image,
+                         int timeoutMilliSec);
+
 private:
+  struct Slot;
+  struct Recycler;
+  struct ReturnSlot;
+
+  static uint64_t sequenceOf(const CameraRGBImagePtr& image);
+
+  /* Buffers published before and let go by every reader */
+  std::shared_ptr<Recycler> m_recycler;
+
+  /* Only through std::atomic_load/atomic_store */
+  CameraRGBImagePtr     m_latest;
+  std::atomic<uint64_t> m_sequence;
+  std::atomic<int>      m_waiters;
+  std::atomic<uint64_t> m_readSequence;
+
   pthread_mutex_t m_mutex;
   pthread_cond_t  m_condv;
-  CameraRGBImage  m_img;
-  bool            m_newImageFlag;
 };
 
 #endif
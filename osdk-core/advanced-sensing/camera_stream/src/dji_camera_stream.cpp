@@ -41,11 +41,21 @@ DJICameraStream::DJICameraStream(CameraType camType) :
   cameraNameStr = (camType == FPV_CAMERA) ? std::string("FPV_CAMERA") : std::string("MAIN_CAMERA");
   rawDataStream = new DJICameraStreamLink(camType);
   decoder       = new DJICameraStreamDecoder;
+  ownsRawDataStream = true;
+}
+
+DJICameraStream::DJICameraStream(DJICameraStreamSource* source, CameraType camType) :
+        cameraType(camType)
+{
+  cameraNameStr = (camType == FPV_CAMERA) ? std::string("FPV_CAMERA") : std::string("MAIN_CAMERA");
+  rawDataStream = source;
+  decoder       = new DJICameraStreamDecoder;
+  ownsRawDataStream = false;
 }
 
 DJICameraStream::~DJICameraStream()
 {
-  if(rawDataStream)
+  if(rawDataStream && ownsRawDataStream)
   {
     delete rawDataStream;
   }
@@ -107,6 +117,12 @@ bool DJICameraStream::getCurrentImage(CameraRGBImage& copyOfImage)
   return decoder->decodedImageHandler.getNewImageWithLock(copyOfImage, 20);
 }
 
+bool DJICameraStream::waitForNewerImage(uint64_t& sequence, CameraRGBImagePtr& image,
+                                        int timeoutMilliSec)
+{
+  return decoder->decodedImageHandler.waitForNewerImage(sequence, image, timeoutMilliSec);
+}
+
 bool DJICameraStream::newImageIsReady()
 {
   return decoder->decodedImageHandler.newImageIsReady();
@@ -159,3 +175,18 @@ void DJICameraStream::stopCameraH264()
   decoder->cleanup();
 }
 
+
+void DJICameraStream::setDecoderConfig(const DJICameraDecoderConfig& config)
+{
+  decoder->setConfig(config);
+}
+
+void DJICameraStream::getDecoderConfig(DJICameraDecoderConfig& config)
+{
+  decoder->getConfig(config);
+}
+
+void DJICameraStream::getDecoderStats(DJICameraDecoderStats& stats)
+{
+  decoder->getStats(stats);
+}
@@ -12,13 +12,20 @@
 
 #include <string>
 #include "dji_camera_image.hpp"
-class DJICameraStreamLink;
+#include "dji_camera_decode_pool.hpp"
+class DJICameraStreamSource;
 class DJICameraStreamDecoder;
 
 class DJICameraStream
 {
 public:
   DJICameraStream(CameraType camType = FPV_CAMERA);
+
+  /*!
+   * @param source: where the H.264 comes from instead of the camera,
+   * e.g. a DJICameraStreamFileSource; it stays owned by the caller
+   */
+  DJICameraStream(DJICameraStreamSource* source, CameraType camType = FPV_CAMERA);
   ~DJICameraStream();
 
   bool newImageIsReady();
@@ -30,6 +37,15 @@ public:
 
   bool getCurrentImage(CameraRGBImage& copyOfImage);
 
+  /*!
+   * For any number of readers, each keeping its own sequence (0 at first):
+   * waits for an image newer than sequence and shares it without a copy
+   * @param timeoutMilliSec: 0 returns at once
+   * @return false if timeout, true if a newer image obtained
+   */
+  bool waitForNewerImage(uint64_t& sequence, CameraRGBImagePtr& image,
+                         int timeoutMilliSec);
+
   bool startCameraStream(CameraImageCallback cb = NULL, void * cbParam = NULL);
 
   void stopCameraStream();
@@ -38,9 +54,20 @@ public:
 
   void stopCameraH264();
 
+  /*!
+   * Takes effect at the next startCameraStream(); a DJICameraDecodePool in
+   * config lets the streams of several cameras share its threads
+   */
+  void setDecoderConfig(const DJICameraDecoderConfig& config);
+
+  void getDecoderConfig(DJICameraDecoderConfig& config);
+
+  void getDecoderStats(DJICameraDecoderStats& stats);
+
 private:
-  DJICameraStreamLink     *rawDataStream;
+  DJICameraStreamSource   *rawDataStream;
   DJICameraStreamDecoder  *decoder;
+  bool                    ownsRawDataStream;
 
   CameraType cameraType;
   std::string cameraNameStr;
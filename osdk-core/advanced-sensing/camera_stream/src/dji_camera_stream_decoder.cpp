@@ -28,21 +28,162 @@
 #include "unistd.h"
 #include "pthread.h"
 
+#include <chrono>
+#include <memory>
+
+static int64_t steadyTimeUs()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+           std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/* Longest the decoding stage skips frames waiting for a keyframe */
+static const int64_t MAX_KEYFRAME_WAIT_US = 2000000;
+
+/* Exp-Golomb codes at the start of a NAL unit payload */
+class SliceHeaderReader
+{
+public:
+  SliceHeaderReader(const uint8_t* data, int size)
+    : data(data), size(size), pos(0), zeros(0), bit(8), byte(0)
+  {
+  }
+
+  bool ue(uint32_t& value)
+  {
+    int leadingZeros = 0;
+    int b;
+    while ((b = readBit()) == 0)
+    {
+      if (++leadingZeros > 31)
+      {
+        return false;
+      }
+    }
+    if (b < 0)
+    {
+      return false;
+    }
+    value = 0;
+    for (int i = 0; i < leadingZeros; ++i)
+    {
+      if ((b = readBit()) < 0)
+      {
+        return false;
+      }
+      value = (value << 1) | b;
+    }
+    value += (1u << leadingZeros) - 1;
+    return true;
+  }
+
+private:
+  int readBit()
+  {
+    if (bit == 8)
+    {
+      /* Emulation prevention byte */
+      if (pos < size && zeros >= 2 && data[pos] == 3)
+      {
+        pos++;
+        zeros = 0;
+      }
+      if (pos >= size)
+      {
+        return -1;
+      }
+      byte  = data[pos++];
+      zeros = byte ? 0 : zeros + 1;
+      bit   = 0;
+    }
+    return (byte >> (7 - bit++)) & 1;
+  }
+
+  const uint8_t* data;
+  int            size;
+  int            pos;
+  int            zeros;
+  int            bit;
+  uint8_t        byte;
+};
+
+/* From the first slice of an access unit: whether other frames refer to it
+ * and whether it decodes on its own. false without a slice. */
+static bool classifyAccessUnit(const uint8_t* data, int size, bool& reference, bool& key)
+{
+  for (int i = 0; i + 3 < size; ++i)
+  {
+    if (data[i] != 0 || data[i + 1] != 0 || data[i + 2] != 1)
+    {
+      continue;
+    }
+    uint8_t header = data[i + 3];
+    int     type   = header & 0x1F;
+    if (type == 5)
+    {
+      reference = true;
+      key       = true;
+      return true;
+    }
+    if (type != 1)
+    {
+      continue;
+    }
+
+    reference = (header & 0x60) != 0;
+    SliceHeaderReader reader(data + i + 4, size - i - 4);
+    uint32_t firstMb, sliceType;
+    if (!reader.ue(firstMb) || !reader.ue(sliceType))
+    {
+      return false;
+    }
+    /* I or SI */
+    key = (sliceType % 5 == 2 || sliceType % 5 == 4);
+    return true;
+  }
+  return false;
+}
+
 DJICameraStreamDecoder::DJICameraStreamDecoder()
+  : DJICameraStreamDecoder(DJICameraDecoderConfig())
+{
+}
+
+DJICameraStreamDecoder::DJICameraStreamDecoder(const DJICameraDecoderConfig& config)
   : initSuccess(false),
     cbThreadIsRunning(false),
     cbThreadStatus(-1),
     cb(NULL),
     cbUserParam(NULL),
+    config(config),
     pCodecCtx(NULL),
     pCodec(NULL),
     pCodecParserCtx(NULL),
+    pParserCodecCtx(NULL),
+    pPacket(NULL),
     pSwsCtx(NULL),
-    pFrameYUV(NULL),
-    pFrameRGB(NULL),
-    rgbBuf(NULL),
-    bufSize(0)
+    ownPool(NULL),
+    pool(NULL),
+    decodeStrand(NULL),
+    convertStrand(NULL),
+    decodeLevel(DJICameraDecodePolicy::LEVEL_FULL),
+    waitForKeyframe(false),
+    keyframeWaitSinceUs(0),
+    swsWidth(0),
+    swsHeight(0),
+    swsFormat(-1),
+    swsDstWidth(0),
+    frameCb(NULL),
+    frameCbUserParam(NULL),
+    flushRequested(0),
+    flushCompleted(0),
+    totalLatencyMs(0)
 {
+  pthread_mutex_init(&frameMutex, NULL);
+  pthread_mutex_init(&flushMutex, NULL);
+  pthread_cond_init(&flushCond, NULL);
+  pthread_mutex_init(&statsMutex, NULL);
+  stats = DJICameraDecoderStats();
 }
 
 DJICameraStreamDecoder::~DJICameraStreamDecoder()
@@ -53,6 +194,21 @@ DJICameraStreamDecoder::~DJICameraStreamDecoder()
   }
 
   cleanup();
+
+  pthread_mutex_destroy(&statsMutex);
+  pthread_cond_destroy(&flushCond);
+  pthread_mutex_destroy(&flushMutex);
+  pthread_mutex_destroy(&frameMutex);
+}
+
+void DJICameraStreamDecoder::setConfig(const DJICameraDecoderConfig& newConfig)
+{
+  config = newConfig;
+}
+
+void DJICameraStreamDecoder::getConfig(DJICameraDecoderConfig& currentConfig)
+{
+  currentConfig = config;
 }
 
 bool DJICameraStreamDecoder::init()
@@ -63,45 +219,69 @@ bool DJICameraStreamDecoder::init()
     return true;
   }
 
+#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(58, 9, 100)
   avcodec_register_all();
-  pCodecCtx = avcodec_alloc_context3(NULL);
+#endif
+  pCodec = avcodec_find_decoder(AV_CODEC_ID_H264);
+  if (!pCodec)
+  {
+    return false;
+  }
+
+  pCodecCtx = avcodec_alloc_context3(pCodec);
   if (!pCodecCtx)
   {
     return false;
   }
 
-  pCodecCtx->thread_count = 4;
-  pCodec = avcodec_find_decoder(AV_CODEC_ID_H264);
-  if (!pCodec || avcodec_open2(pCodecCtx, pCodec, NULL) < 0)
+  pCodecCtx->thread_count = config.threadCount;
+  pCodecCtx->thread_type  =
+    ((config.threadType & DJICameraDecoderConfig::THREAD_FRAME) ? FF_THREAD_FRAME : 0) |
+    ((config.threadType & DJICameraDecoderConfig::THREAD_SLICE) ? FF_THREAD_SLICE : 0);
+  pCodecCtx->flags2 |= AV_CODEC_FLAG2_SHOW_ALL;
+  if (avcodec_open2(pCodecCtx, pCodec, NULL) < 0)
   {
     return false;
   }
 
   pCodecParserCtx = av_parser_init(AV_CODEC_ID_H264);
-  if (!pCodecParserCtx)
+  pParserCodecCtx = avcodec_alloc_context3(pCodec);
+  if (!pCodecParserCtx || !pParserCodecCtx)
   {
     return false;
   }
 
-  pFrameYUV = av_frame_alloc();
-  if (!pFrameYUV)
+  pPacket = av_packet_alloc();
+  if (!pPacket)
   {
     return false;
   }
 
-  pFrameRGB = av_frame_alloc();
-  if (!pFrameRGB)
+  if (config.pool)
   {
-    return false;
+    pool         = config.pool;
+    decodeStrand = pool->createStrand();
+  }
+  else
+  {
+    ownPool = new DJICameraDecodePool(1);
+    pool    = ownPool;
   }
+  convertStrand = pool->createStrand();
 
-  pSwsCtx = NULL;
+  pthread_mutex_lock(&statsMutex);
+  stats          = DJICameraDecoderStats();
+  totalLatencyMs = 0;
+  pthread_mutex_unlock(&statsMutex);
+
+  policy.reset(config.maxLatencyMs);
+  decodeLevel         = DJICameraDecodePolicy::LEVEL_FULL;
+  waitForKeyframe     = false;
+  keyframeWaitSinceUs = 0;
 
   DSTATUS_PRIVATE("All components for decoding initialized ...\n");
   DDEBUG_PRIVATE("Decoder Version = %d\n", avcodec_version());
 
-  pCodecCtx->flags2 |= AV_CODEC_FLAG2_SHOW_ALL;
-
   initSuccess = true;
   return true;
 }
@@ -114,47 +294,67 @@ bool DJICameraStreamDecoder::getNewImage(CameraRGBImage & copyOfImage, int timeo
 void DJICameraStreamDecoder::cleanup()
 {
   initSuccess = false;
-  if (NULL != pSwsCtx)
+
+  /* The decoding stage posts conversions, so it goes first */
+  if (NULL != pool)
   {
-    sws_freeContext(pSwsCtx);
-    pSwsCtx = NULL;
+    pool->destroyStrand(decodeStrand);
+    pool->destroyStrand(convertStrand);
+    decodeStrand  = NULL;
+    convertStrand = NULL;
+    pool          = NULL;
   }
 
-  if (NULL != pFrameYUV)
+  if (NULL != ownPool)
   {
-    av_free(pFrameYUV);
-    pFrameYUV = NULL;
+    delete ownPool;
+    ownPool = NULL;
   }
 
-  if (NULL != pCodecParserCtx)
+  pthread_mutex_lock(&frameMutex);
+  for (size_t i = 0; i < pendingFrames.size(); ++i)
   {
-    av_parser_close(pCodecParserCtx);
-    pCodecParserCtx = NULL;
+    av_frame_free(&pendingFrames[i]);
   }
+  pendingFrames.clear();
+  for (size_t i = 0; i < spareFrames.size(); ++i)
+  {
+    av_frame_free(&spareFrames[i]);
+  }
+  spareFrames.clear();
+  pthread_mutex_unlock(&frameMutex);
 
-  if (NULL != pCodec)
+  if (NULL != pSwsCtx)
   {
-    avcodec_close(pCodecCtx);
-    pCodec = NULL;
+    sws_freeContext(pSwsCtx);
+    pSwsCtx   = NULL;
+    swsWidth    = 0;
+    swsHeight   = 0;
+    swsFormat   = -1;
+    swsDstWidth = 0;
   }
 
-  if (NULL != pCodecCtx)
+  if (NULL != pCodecParserCtx)
+  {
+    av_parser_close(pCodecParserCtx);
+    pCodecParserCtx = NULL;
+  }
+
+  if (NULL != pParserCodecCtx)
   {
-    av_free(pCodecCtx);
-    pCodecCtx = NULL;
+    avcodec_free_context(&pParserCodecCtx);
   }
 
-  if (NULL != rgbBuf )
+  if (NULL != pPacket)
   {
-    av_free(rgbBuf);
-    rgbBuf = NULL;
+    av_packet_free(&pPacket);
   }
 
-  if (NULL != pFrameRGB)
+  if (NULL != pCodecCtx)
   {
-    av_free(pFrameRGB);
-    pFrameRGB = NULL;
+    avcodec_free_context(&pCodecCtx);
   }
+  pCodec = NULL;
 }
 
 void* DJICameraStreamDecoder::callbackThreadEntry(void* p)
@@ -166,18 +366,29 @@ void* DJICameraStreamDecoder::callbackThreadEntry(void* p)
 
 void DJICameraStreamDecoder::callbackThreadFunc()
 {
+  /* A reader of its own, getNewImage() callers do not take its images */
+  uint64_t sequence = 0;
   while(cbThreadIsRunning)
   {
-    CameraRGBImage copyOfImage;
-    if(!decodedImageHandler.getNewImageWithLock(copyOfImage, 1000))
+    CameraRGBImagePtr image;
+    uint64_t          previous = sequence;
+    if(!decodedImageHandler.waitForNewerImage(sequence, image, 1000))
     {
       DDEBUG_PRIVATE("Decoder Callback Thread: Get image time out\n");
       continue;
     }
 
+    /* Images from before the callback was registered are not counted */
+    if(previous != 0 && sequence > previous + 1)
+    {
+      pthread_mutex_lock(&statsMutex);
+      stats.overwrittenImages += sequence - previous - 1;
+      pthread_mutex_unlock(&statsMutex);
+    }
+
     if(cb)
     {
-      (*cb)(copyOfImage, cbUserParam);
+      (*cb)(*image, cbUserParam);
     }
   }
   DSTATUS_PRIVATE("Decoder Callback Thread Stopped...\n");
@@ -185,66 +396,342 @@ void DJICameraStreamDecoder::callbackThreadFunc()
 
 void DJICameraStreamDecoder::decodeBuffer(uint8_t* buf, int bufLen)
 {
+  if (!initSuccess)
+  {
+    return;
+  }
+
   uint8_t* pData   = buf;
   int remainingLen = bufLen;
-  int processedLen = 0;
+  int64_t  timeUs  = steadyTimeUs();
 
-  AVPacket pkt;
-  av_init_packet(&pkt);
   while (remainingLen > 0)
   {
-    processedLen = av_parser_parse2(pCodecParserCtx, pCodecCtx,
-                                    &pkt.data, &pkt.size,
-                                    pData, remainingLen,
-                                    AV_NOPTS_VALUE, AV_NOPTS_VALUE, AV_NOPTS_VALUE);
+    uint8_t* packetData = NULL;
+    int      packetSize = 0;
+    int processedLen = av_parser_parse2(pCodecParserCtx, pParserCodecCtx,
+                                        &packetData, &packetSize,
+                                        pData, remainingLen,
+                                        AV_NOPTS_VALUE, AV_NOPTS_VALUE, 0);
+    if (processedLen < 0)
+    {
+      break;
+    }
     remainingLen -= processedLen;
     pData        += processedLen;
 
-    if (pkt.size > 0)
+    if (packetSize > 0)
     {
-      int gotPicture = 0;
-      avcodec_decode_video2(pCodecCtx, pFrameYUV, &gotPicture, &pkt);
+      submitPacket(packetData, packetSize, timeUs);
+    }
+  }
+}
 
-      if (!gotPicture)
+void DJICameraStreamDecoder::flush()
+{
+  if (!initSuccess)
+  {
+    return;
+  }
+
+  /* The access unit the parser still holds */
+  uint8_t* packetData = NULL;
+  int      packetSize = 0;
+  av_parser_parse2(pCodecParserCtx, pParserCodecCtx, &packetData, &packetSize,
+                   NULL, 0, AV_NOPTS_VALUE, AV_NOPTS_VALUE, 0);
+  if (packetSize > 0)
+  {
+    submitPacket(packetData, packetSize, steadyTimeUs());
+  }
+
+  pthread_mutex_lock(&flushMutex);
+  uint64_t ticket = ++flushRequested;
+  pthread_mutex_unlock(&flushMutex);
+
+  /* Conversions run in order, so the mark comes after every frame drained */
+  runDecodeJob([this, ticket]() {
+    drain();
+    pool->post(convertStrand, [this, ticket]() {
+      pthread_mutex_lock(&flushMutex);
+      if (ticket > flushCompleted)
       {
-        //DSTATUS_PRIVATE("Got Frame, but no picture\n");
-        continue;
+        flushCompleted = ticket;
       }
-      else
+      pthread_cond_broadcast(&flushCond);
+      pthread_mutex_unlock(&flushMutex);
+    });
+  });
+
+  pthread_mutex_lock(&flushMutex);
+  while (flushCompleted < ticket)
+  {
+    pthread_cond_wait(&flushCond, &flushMutex);
+  }
+  pthread_mutex_unlock(&flushMutex);
+}
+
+void DJICameraStreamDecoder::registerFrameCallback(DecodedFrameCallback f, void* param)
+{
+  frameCb          = f;
+  frameCbUserParam = param;
+}
+
+void DJICameraStreamDecoder::getStats(DJICameraDecoderStats& out)
+{
+  pthread_mutex_lock(&statsMutex);
+  out = stats;
+  out.meanLatencyMs =
+    stats.convertedFrames ? totalLatencyMs / stats.convertedFrames : 0;
+  pthread_mutex_unlock(&statsMutex);
+  out.policyLevel   = policy.getLevel();
+  out.policyChanges = policy.getLevelChanges();
+}
+
+void DJICameraStreamDecoder::runDecodeJob(DJICameraDecodePool::Job job)
+{
+  if (decodeStrand)
+  {
+    pool->post(decodeStrand, job);
+  }
+  else
+  {
+    job();
+  }
+}
+
+void DJICameraStreamDecoder::submitPacket(uint8_t* data, int size, int64_t timeUs)
+{
+  pthread_mutex_lock(&statsMutex);
+  stats.packets++;
+  pthread_mutex_unlock(&statsMutex);
+
+  if (!decodeStrand)
+  {
+    decodePacket(data, size, timeUs);
+    return;
+  }
+
+  /* The parser reuses its buffer at the next call */
+  std::shared_ptr<std::vector<uint8_t> > packet(
+    new std::vector<uint8_t>(data, data + size));
+  pool->post(decodeStrand, [this, packet, timeUs]() {
+    decodePacket(packet->data(), (int)packet->size(), timeUs);
+  });
+}
+
+void DJICameraStreamDecoder::decodePacket(uint8_t* data, int size, int64_t timeUs)
+{
+  int64_t nowUs = steadyTimeUs();
+  int     level = policy.poll(nowUs);
+  if (level != decodeLevel)
+  {
+    pCodecCtx->skip_loop_filter = (level >= DJICameraDecodePolicy::LEVEL_HALF_SIZE)
+                                    ? AVDISCARD_ALL : AVDISCARD_DEFAULT;
+    decodeLevel = level;
+  }
+
+  /* A reference frame left out breaks the frames after it up to the next
+   * keyframe, whatever the level by then. A stream refreshing intra blocks
+   * instead may not send one for long, decoding goes on after
+   * MAX_KEYFRAME_WAIT_US with what the codec conceals. */
+  bool reference = true;
+  bool key       = false;
+  if (classifyAccessUnit(data, size, reference, key))
+  {
+    bool skip = false;
+    if (key || (waitForKeyframe &&
+                level < DJICameraDecodePolicy::LEVEL_KEYFRAMES_ONLY &&
+                nowUs - keyframeWaitSinceUs >= MAX_KEYFRAME_WAIT_US))
+    {
+      waitForKeyframe = false;
+    }
+    else if (waitForKeyframe || level >= DJICameraDecodePolicy::LEVEL_KEYFRAMES_ONLY)
+    {
+      skip = true;
+      if (!waitForKeyframe && reference)
+      {
+        waitForKeyframe     = true;
+        keyframeWaitSinceUs = nowUs;
+      }
+    }
+    else if (level >= DJICameraDecodePolicy::LEVEL_SKIP_NON_REFERENCE && !reference)
+    {
+      skip = true;
+    }
+
+    if (skip)
+    {
+      pthread_mutex_lock(&statsMutex);
+      stats.skippedFrames++;
+      pthread_mutex_unlock(&statsMutex);
+      return;
+    }
+  }
+
+  pPacket->data = data;
+  pPacket->size = size;
+  pPacket->pts  = timeUs;
+
+  /* Every frame is received after each packet, so no EAGAIN here */
+  if (avcodec_send_packet(pCodecCtx, pPacket) < 0)
+  {
+    pthread_mutex_lock(&statsMutex);
+    stats.decodeErrors++;
+    pthread_mutex_unlock(&statsMutex);
+  }
+  pPacket->data = NULL;
+  pPacket->size = 0;
+
+  receiveFrames();
+}
+
+void DJICameraStreamDecoder::receiveFrames()
+{
+  while (true)
+  {
+    AVFrame* frame = NULL;
+    pthread_mutex_lock(&frameMutex);
+    if (!spareFrames.empty())
+    {
+      frame = spareFrames.back();
+      spareFrames.pop_back();
+    }
+    pthread_mutex_unlock(&frameMutex);
+    if (!frame && !(frame = av_frame_alloc()))
+    {
+      return;
+    }
+
+    int ret = avcodec_receive_frame(pCodecCtx, frame);
+    if (ret < 0)
+    {
+      pthread_mutex_lock(&frameMutex);
+      spareFrames.push_back(frame);
+      pthread_mutex_unlock(&frameMutex);
+
+      if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF)
       {
-        int w = pFrameYUV->width;
-        int h = pFrameYUV->height;
-        //DSTATUS_PRIVATE("Got picture! size=%dx%d\n", w, h);
-
-        if(NULL == pSwsCtx)
-        {
-          pSwsCtx = sws_getContext(w, h, pCodecCtx->pix_fmt,
-                                   w, h, AV_PIX_FMT_RGB24,
-                                   4, NULL, NULL, NULL);
-        }
-
-        if(NULL == rgbBuf)
-        {
-          bufSize = avpicture_get_size(AV_PIX_FMT_RGB24, w, h);
-          rgbBuf = (uint8_t*) av_malloc(bufSize);
-          avpicture_fill((AVPicture*)pFrameRGB, rgbBuf, AV_PIX_FMT_RGB24, w, h);
-        }
-
-        if(NULL != pSwsCtx && NULL != rgbBuf)
-        {
-          sws_scale(pSwsCtx,
-                    (uint8_t const *const *) pFrameYUV->data, pFrameYUV->linesize, 0, pFrameYUV->height,
-                             pFrameRGB->data, pFrameRGB->linesize);
-
-          pFrameRGB->height = h;
-          pFrameRGB->width = w;
-
-          decodedImageHandler.writeNewImageWithLock(pFrameRGB->data[0], bufSize, w, h);
-        }
+        pthread_mutex_lock(&statsMutex);
+        stats.decodeErrors++;
+        pthread_mutex_unlock(&statsMutex);
       }
+      return;
+    }
+
+    pthread_mutex_lock(&statsMutex);
+    stats.decodedFrames++;
+    pthread_mutex_unlock(&statsMutex);
+
+    queueFrame(frame);
+  }
+}
+
+void DJICameraStreamDecoder::drain()
+{
+  avcodec_send_packet(pCodecCtx, NULL);
+  receiveFrames();
+  avcodec_flush_buffers(pCodecCtx);
+}
+
+void DJICameraStreamDecoder::queueFrame(AVFrame* frame)
+{
+  /* One conversion job per pending frame: a frame replacing a dropped one
+   * takes over its job */
+  bool dropped = false;
+  pthread_mutex_lock(&frameMutex);
+  if (config.maxPendingFrames > 0 &&
+      pendingFrames.size() >= (size_t)config.maxPendingFrames)
+  {
+    AVFrame* oldest = pendingFrames.front();
+    pendingFrames.pop_front();
+    av_frame_unref(oldest);
+    spareFrames.push_back(oldest);
+    dropped = true;
+  }
+  pendingFrames.push_back(frame);
+  pthread_mutex_unlock(&frameMutex);
+
+  if (dropped)
+  {
+    pthread_mutex_lock(&statsMutex);
+    stats.droppedFrames++;
+    pthread_mutex_unlock(&statsMutex);
+    return;
+  }
+
+  pool->post(convertStrand, [this]() { convertFrame(); });
+}
+
+void DJICameraStreamDecoder::convertFrame()
+{
+  pthread_mutex_lock(&frameMutex);
+  if (pendingFrames.empty())
+  {
+    pthread_mutex_unlock(&frameMutex);
+    return;
+  }
+  AVFrame* frame = pendingFrames.front();
+  pendingFrames.pop_front();
+  pthread_mutex_unlock(&frameMutex);
+
+  int w = frame->width;
+  int h = frame->height;
+  int dstW = w;
+  int dstH = h;
+  if (policy.getLevel() >= DJICameraDecodePolicy::LEVEL_HALF_SIZE)
+  {
+    dstW = w / 4 * 2;
+    dstH = h / 4 * 2;
+  }
+  if (NULL == pSwsCtx || w != swsWidth || h != swsHeight ||
+      frame->format != swsFormat || dstW != swsDstWidth)
+  {
+    sws_freeContext(pSwsCtx);
+    pSwsCtx     = sws_getContext(w, h, (AVPixelFormat)frame->format,
+                                 dstW, dstH, AV_PIX_FMT_RGB24,
+                                 SWS_BICUBIC, NULL, NULL, NULL);
+    swsWidth    = w;
+    swsHeight   = h;
+    swsFormat   = frame->format;
+    swsDstWidth = dstW;
+  }
+
+  if (NULL != pSwsCtx)
+  {
+    /* Converted straight into the image readers will share */
+    std::shared_ptr<CameraRGBImage> image = decodedImageHandler.acquireImage(dstW, dstH);
+    uint8_t* dstData[1]     = { image->rawData.data() };
+    int      dstLinesize[1] = { dstW * 3 };
+    sws_scale(pSwsCtx, (uint8_t const *const *) frame->data, frame->linesize,
+              0, h, dstData, dstLinesize);
+
+    if (frameCb)
+    {
+      (*frameCb)(*image, frameCbUserParam);
     }
+    decodedImageHandler.publishImage(image);
+
+    int64_t deliveredUs = steadyTimeUs();
+    double  latencyMs   = 0;
+    if (frame->pts != AV_NOPTS_VALUE)
+    {
+      latencyMs = (deliveredUs - frame->pts) / 1000.0;
+      policy.update(frame->pts, deliveredUs);
+    }
+    pthread_mutex_lock(&statsMutex);
+    stats.convertedFrames++;
+    totalLatencyMs += latencyMs;
+    if (latencyMs > stats.maxLatencyMs)
+    {
+      stats.maxLatencyMs = latencyMs;
+    }
+    pthread_mutex_unlock(&statsMutex);
   }
-  av_free_packet(&pkt);
+
+  av_frame_unref(frame);
+  pthread_mutex_lock(&frameMutex);
+  spareFrames.push_back(frame);
+  pthread_mutex_unlock(&frameMutex);
 }
 
 bool DJICameraStreamDecoder::registerCallback(CameraImageCallback f, void *param)
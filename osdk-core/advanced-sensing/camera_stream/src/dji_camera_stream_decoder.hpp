@@ -16,15 +16,29 @@ extern "C"{
 #include <libswscale/swscale.h>
 }
 
+#include <deque>
+#include <vector>
 #include "pthread.h"
 #include "dji_camera_image.hpp"
 #include "dji_camera_image_handler.hpp"
+#include "dji_camera_decode_pool.hpp"
+#include "dji_camera_decode_policy.hpp"
+
+/*! @brief Called on the conversion thread with every decoded frame, before
+ *  it becomes the current image of decodedImageHandler
+ */
+typedef void (*DecodedFrameCallback)(const CameraRGBImage& image, void* userData);
 
 class DJICameraStreamDecoder
 {
 public:
   DJICameraStreamDecoder();
+  DJICameraStreamDecoder(const DJICameraDecoderConfig& config);
   ~DJICameraStreamDecoder();
+
+  /* Takes effect at the next init() */
+  void setConfig(const DJICameraDecoderConfig& config);
+  void getConfig(DJICameraDecoderConfig& config);
   bool init();
   void cleanup();
 
@@ -32,8 +46,19 @@ public:
 
   void callbackThreadFunc();
 
+  /* Parses on the calling thread; decoding and colour conversion then run
+   * as set by DJICameraDecoderConfig::pool */
   void decodeBuffer(uint8_t* pBuf, int len);
 
+  /* Waits until every frame given to decodeBuffer() so far, including the
+   * ones the codec holds back, has been delivered. Not from a callback. */
+  void flush();
+
+  /* Before init() */
+  void registerFrameCallback(DecodedFrameCallback f, void* param);
+
+  void getStats(DJICameraDecoderStats& stats);
+
   static void* callbackThreadEntry(void *p); 
 
   bool registerCallback(CameraImageCallback f, void* param);
@@ -50,15 +75,61 @@ private:
   CameraImageCallback cb;
   void*               cbUserParam;
 
+  DJICameraDecoderConfig config;
+
+  /* Decoding stage: the thread of decodeBuffer() or a strand of the pool */
+  void runDecodeJob(DJICameraDecodePool::Job job);
+  void submitPacket(uint8_t* data, int size, int64_t timeUs);
+  void decodePacket(uint8_t* data, int size, int64_t timeUs);
+  void receiveFrames();
+  void drain();
+
+  /* Conversion stage: a strand of the pool or of ownPool */
+  void queueFrame(AVFrame* frame);
+  void convertFrame();
+
   AVCodecContext*       pCodecCtx;
-  AVCodec*              pCodec;
+  const AVCodec*        pCodec;
   AVCodecParserContext* pCodecParserCtx;
+  /* The parser's own, pCodecCtx may be decoding on a worker meanwhile */
+  AVCodecContext*       pParserCodecCtx;
+  AVPacket*             pPacket;
   SwsContext*           pSwsCtx;
 
-  AVFrame* pFrameYUV;
-  AVFrame* pFrameRGB;
-  uint8_t* rgbBuf;
-  size_t   bufSize;
+  DJICameraDecodePool*         ownPool;
+  DJICameraDecodePool*         pool;
+  DJICameraDecodePool::Strand* decodeStrand;
+  DJICameraDecodePool::Strand* convertStrand;
+
+  /* Frames decoded and not converted yet, oldest first, and free ones */
+  pthread_mutex_t       frameMutex;
+  std::deque<AVFrame*>  pendingFrames;
+  std::vector<AVFrame*> spareFrames;
+
+  DJICameraDecodePolicy policy;
+
+  /* Touched by the decoding stage only */
+  int            decodeLevel;
+  bool           waitForKeyframe;
+  int64_t        keyframeWaitSinceUs;
+
+  /* Touched by the conversion stage only */
+  int            swsWidth;
+  int            swsHeight;
+  int            swsFormat;
+  int            swsDstWidth;
+
+  DecodedFrameCallback frameCb;
+  void*                frameCbUserParam;
+
+  pthread_mutex_t       flushMutex;
+  pthread_cond_t        flushCond;
+  uint64_t              flushRequested;
+  uint64_t              flushCompleted;
+
+  pthread_mutex_t       statsMutex;
+  DJICameraDecoderStats stats;
+  double                totalLatencyMs;
 };
 
 #endif // DJICAMERASTREAMDECODER_HH
@@ -0,0 +1,389 @@
+/*
+ * DJI Onboard SDK Advanced Sensing APIs
+ *
+ * Copyright (c) 2017-2026 DJI. All rights reserved.
+ *
+ * All information contained herein is, and remains, the property of DJI.
+ * The intellectual and technical concepts contained herein are proprietary
+ * to DJI and may be covered by U.S. and foreign patents, patents in process,
+ * and protected by trade secret or copyright law.  Dissemination of this
+ * information, including but not limited to data and other proprietary
+ * material(s) incorporated within the information, in any form, is strictly
+ * prohibited without the express written consent of DJI.
+ *
+ * If you receive this source code without DJI’s authorization, you may not
+ * further disseminate the information, and you must immediately remove the
+ * source code and notify DJI of its removal. DJI reserves the right to pursue
+ * legal actions against you for any loss(es) or damage(s) caused by your
+ * failure to do so.
+ *
+ * @file dji_camera_stream_file_source.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ */
+
+#include "dji_camera_stream_file_source.hpp"
+#include "dji_stream_recorder.hpp"
+#include "dji_log.hpp"
+
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+
+using namespace DJI::OSDK;
+
+#define SCAN_BLOCK_SIZE    (64 * 1024)
+/* Waits are cut into slices of this, so stop() does not wait for a long
+ * pause in a recording */
+#define MAX_SLEEP_US       (100000)
+/* Scheduling jitter below this does not count as late */
+#define LATE_TOLERANCE_US  (1000)
+
+typedef std::chrono::steady_clock ReplayClock;
+
+DJICameraStreamFileSource::DJICameraStreamFileSource(const std::string& path,
+                                                     ReplayMode mode,
+                                                     double fps)
+  : path(path),
+    mode(mode),
+    fps(fps > 0 ? fps : 30.0),
+    loop(false),
+    file(NULL),
+    threadStatus(-1),
+    isRunning(false),
+    cb(NULL),
+    cbParam(NULL)
+{
+  pthread_mutex_init(&statsMutex, NULL);
+  memset(&stats, 0, sizeof(stats));
+}
+
+DJICameraStreamFileSource::~DJICameraStreamFileSource()
+{
+  cleanup();
+  pthread_mutex_destroy(&statsMutex);
+}
+
+bool DJICameraStreamFileSource::init()
+{
+  if (file)
+  {
+    return true;
+  }
+
+  packets.clear();
+  if (!readRecording() && !scanElementaryStream())
+  {
+    DERROR_PRIVATE("Cannot replay %s\n", path.c_str());
+    return false;
+  }
+  if (packets.empty())
+  {
+    DERROR_PRIVATE("No H.264 in %s\n", path.c_str());
+    cleanup();
+    return false;
+  }
+
+  uint32_t maxLength = 0;
+  for (size_t i = 0; i < packets.size(); ++i)
+  {
+    maxLength = std::max(maxLength, packets[i].length);
+  }
+  packetBuffer.resize(maxLength);
+
+  DSTATUS_PRIVATE("Replaying %u packets from %s\n", (unsigned)packets.size(),
+                  path.c_str());
+  return true;
+}
+
+bool DJICameraStreamFileSource::readRecording()
+{
+  std::vector<StreamRecorder::IndexRecordType> records;
+  if (!StreamRecorder::readIndex(path, records))
+  {
+    return false;
+  }
+
+  file = fopen((path + ".h264").c_str(), "rb");
+  if (!file)
+  {
+    return false;
+  }
+
+  uint64_t firstUs = 0;
+  for (size_t i = 0; i < records.size(); ++i)
+  {
+    if (records[i].stream != StreamRecorder::STREAM_H264)
+    {
+      continue;
+    }
+    if (packets.empty())
+    {
+      firstUs = records[i].timeUs;
+    }
+    Packet packet;
+    packet.offset = records[i].offset;
+    packet.length = records[i].length;
+    packet.timeUs = records[i].timeUs - firstUs;
+    packets.push_back(packet);
+  }
+  return true;
+}
+
+bool DJICameraStreamFileSource::scanElementaryStream()
+{
+  file = fopen(path.c_str(), "rb");
+  if (!file)
+  {
+    return false;
+  }
+
+  /* An access unit ends where the next one starts (H.264 7.4.1.2.3): at an
+   * access unit delimiter, SPS, PPS, SEI or NAL unit of type 14 to 18 after
+   * a slice, or at the slice with first_mb_in_slice 0 of the next picture.
+   * first_mb_in_slice is the first field of the slice header and 0 when the
+   * first bit after the NAL header is set. */
+  std::vector<uint8_t> block(SCAN_BLOCK_SIZE);
+  uint64_t blockOffset = 0;
+  int      zeros       = 0;
+  int      pending     = 0;
+  uint64_t nalStart    = 0;
+  uint8_t  nalType     = 0;
+  bool     auOpen      = false;
+  bool     auHasSlice  = false;
+  uint64_t auStart     = 0;
+
+  size_t len;
+  while ((len = fread(&block[0], 1, block.size(), file)) > 0)
+  {
+    for (size_t i = 0; i < len; ++i)
+    {
+      uint8_t b = block[i];
+      bool    nalComplete = false;
+      bool    firstMbZero = false;
+
+      if (pending == 2)
+      {
+        nalType = b & 0x1F;
+        pending = (nalType == 1 || nalType == 5) ? 1 : 0;
+        nalComplete = (pending == 0);
+      }
+      else if (pending == 1)
+      {
+        pending     = 0;
+        nalComplete = true;
+        firstMbZero = (b & 0x80) != 0;
+      }
+      else if (b == 1 && zeros >= 2)
+      {
+        nalStart = blockOffset + i - std::min(zeros, 3);
+        pending  = 2;
+      }
+      zeros = (b == 0) ? zeros + 1 : 0;
+
+      if (!nalComplete)
+      {
+        continue;
+      }
+
+      bool isSlice = (nalType == 1 || nalType == 5);
+      bool beginsAu =
+        auHasSlice &&
+        (isSlice ? firstMbZero
+                 : (nalType >= 6 && nalType <= 9) ||
+                     (nalType >= 14 && nalType <= 18));
+      if (!auOpen)
+      {
+        auOpen  = true;
+        auStart = nalStart;
+      }
+      else if (beginsAu)
+      {
+        Packet packet;
+        packet.offset = auStart;
+        packet.length = (uint32_t)(nalStart - auStart);
+        packet.timeUs = (uint64_t)(packets.size() * 1e6 / fps);
+        packets.push_back(packet);
+        auStart    = nalStart;
+        auHasSlice = false;
+      }
+      auHasSlice = auHasSlice || isSlice;
+    }
+    blockOffset += len;
+  }
+
+  if (auOpen && blockOffset > auStart)
+  {
+    Packet packet;
+    packet.offset = auStart;
+    packet.length = (uint32_t)(blockOffset - auStart);
+    packet.timeUs = (uint64_t)(packets.size() * 1e6 / fps);
+    packets.push_back(packet);
+  }
+  return true;
+}
+
+bool DJICameraStreamFileSource::start()
+{
+  if (isRunning)
+  {
+    DSTATUS_PRIVATE("Already replaying %s\n", path.c_str());
+    return false;
+  }
+  if (!file)
+  {
+    DERROR_PRIVATE("%s is not open, call init() first\n", path.c_str());
+    return false;
+  }
+
+  /* The thread of the previous replay may have ended by itself */
+  stop();
+
+  pthread_mutex_lock(&statsMutex);
+  memset(&stats, 0, sizeof(stats));
+  pthread_mutex_unlock(&statsMutex);
+
+  isRunning    = true;
+  threadStatus = pthread_create(&replayThread, NULL,
+                                DJICameraStreamFileSource::replayThreadEntry, this);
+  if (threadStatus != 0)
+  {
+    DERROR_PRIVATE("Error creating replay thread for %s\n", path.c_str());
+    DERROR_PRIVATE("pthread_create returns %d\n", threadStatus);
+    isRunning = false;
+    return false;
+  }
+  return true;
+}
+
+void DJICameraStreamFileSource::stop()
+{
+  isRunning = false;
+  if (0 == threadStatus)
+  {
+    pthread_join(replayThread, NULL);
+    threadStatus = -1;
+  }
+}
+
+void DJICameraStreamFileSource::cleanup()
+{
+  stop();
+  if (file)
+  {
+    fclose(file);
+    file = NULL;
+  }
+}
+
+bool DJICameraStreamFileSource::isThreadRunning()
+{
+  return isRunning;
+}
+
+void DJICameraStreamFileSource::registerCallback(CAMCALLBACK f, void* param)
+{
+  cb      = f;
+  cbParam = param;
+}
+
+void DJICameraStreamFileSource::setLoop(bool loop)
+{
+  this->loop = loop;
+}
+
+size_t DJICameraStreamFileSource::getPacketCount()
+{
+  return packets.size();
+}
+
+void DJICameraStreamFileSource::getStats(ReplayStats& stats)
+{
+  pthread_mutex_lock(&statsMutex);
+  stats = this->stats;
+  pthread_mutex_unlock(&statsMutex);
+}
+
+void* DJICameraStreamFileSource::replayThreadEntry(void* c)
+{
+  (reinterpret_cast<DJICameraStreamFileSource*>(c))->replayThreadFunc();
+  return NULL;
+}
+
+void DJICameraStreamFileSource::replayThreadFunc()
+{
+  DSTATUS_PRIVATE("**** %s replay thread start! ****\n", path.c_str());
+
+  /* A pass lasts until the last packet is due, plus the mean time between
+   * packets, so a loop keeps the pace */
+  uint64_t passUs = packets.back().timeUs;
+  if (packets.size() > 1)
+  {
+    passUs += passUs / (packets.size() - 1);
+  }
+
+  ReplayClock::time_point begin = ReplayClock::now();
+  for (uint64_t pass = 0; isRunning; ++pass)
+  {
+    pthread_mutex_lock(&statsMutex);
+    stats.passes++;
+    pthread_mutex_unlock(&statsMutex);
+
+    for (size_t i = 0; i < packets.size() && isRunning; ++i)
+    {
+      const Packet& packet = packets[i];
+      if (fseeko(file, (off_t)packet.offset, SEEK_SET) != 0 ||
+          fread(&packetBuffer[0], 1, packet.length, file) != packet.length)
+      {
+        DERROR_PRIVATE("Reading %s failed, quit replay thread\n", path.c_str());
+        isRunning = false;
+        return;
+      }
+
+      uint64_t lateUs = 0;
+      if (mode == REPLAY_RECORDED_TIMING)
+      {
+        ReplayClock::time_point due =
+          begin + std::chrono::microseconds(pass * passUs + packet.timeUs);
+        ReplayClock::time_point now = ReplayClock::now();
+        while (isRunning && now < due)
+        {
+          int64_t waitUs =
+            std::chrono::duration_cast<std::chrono::microseconds>(due - now).count();
+          usleep((useconds_t)std::min<int64_t>(waitUs, MAX_SLEEP_US));
+          now = ReplayClock::now();
+        }
+        if (now > due)
+        {
+          lateUs =
+            std::chrono::duration_cast<std::chrono::microseconds>(now - due).count();
+        }
+      }
+
+      if (cb)
+      {
+        (*cb)(cbParam, &packetBuffer[0], (int)packet.length);
+      }
+
+      pthread_mutex_lock(&statsMutex);
+      stats.packets++;
+      stats.bytes += packet.length;
+      if (lateUs > LATE_TOLERANCE_US)
+      {
+        stats.latePackets++;
+      }
+      stats.maxLateUs = std::max(stats.maxLateUs, lateUs);
+      pthread_mutex_unlock(&statsMutex);
+    }
+
+    if (!loop)
+    {
+      break;
+    }
+  }
+
+  isRunning = false;
+  DSTATUS_PRIVATE("%s replay thread stopped...\n", path.c_str());
+}
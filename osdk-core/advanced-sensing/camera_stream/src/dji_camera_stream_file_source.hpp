@@ -0,0 +1,126 @@
+/** @file dji_camera_stream_file_source.hpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief The class to replay recorded H.264 as if it came from the camera
+
+ *  @copyright 2026 DJI. All rights reserved.
+ *
+ */
+
+#ifndef DJICAMERASTREAMFILESOURCE_HH
+#define DJICAMERASTREAMFILESOURCE_HH
+
+#include <stdio.h>
+#include <atomic>
+#include <string>
+#include <vector>
+#include "pthread.h"
+
+#include "dji_camera_stream_source.hpp"
+
+/*! @brief Replays H.264 from a file, packet by packet, on its own thread.
+ *
+ *  The file is either
+ *  - a recording of StreamRecorder: path is the basePath given to
+ *    StreamRecorder::open(), the packets are those recorded in
+ *    basePath.h264 and delivered with the time between them they were
+ *    recorded with;
+ *  - an H.264 elementary stream (Annex B): a packet is an access unit, the
+ *    NAL units of one picture, and the pictures follow each other at fps.
+ *
+ *  The thread stops by itself after the last packet, unless loop is set.
+ */
+class DJICameraStreamFileSource : public DJICameraStreamSource
+{
+public:
+  typedef enum
+  {
+    /* Wait between packets as long as when they arrived */
+    REPLAY_RECORDED_TIMING = 0,
+    /* Deliver the next packet as soon as the callback returned */
+    REPLAY_AS_FAST_AS_POSSIBLE = 1
+  } ReplayMode;
+
+  typedef struct ReplayStats
+  {
+    uint64_t packets;
+    uint64_t bytes;
+    /* Times through the file begun */
+    uint32_t passes;
+    /* Packets delivered later than their time, because the callback took
+     * longer than the time between packets, and by how much at most */
+    uint64_t latePackets;
+    uint64_t maxLateUs;
+  } ReplayStats;
+
+  /*! @param fps pace of an elementary stream, which has no timestamps */
+  DJICameraStreamFileSource(const std::string& path,
+                            ReplayMode mode = REPLAY_RECORDED_TIMING,
+                            double fps = 30.0);
+  ~DJICameraStreamFileSource();
+
+  /* Open the file and find the packets in it */
+  bool init() override;
+
+  /* Start the replaying thread from the first packet */
+  bool start() override;
+
+  /* Stop the replaying thread */
+  void stop() override;
+
+  /* do both stop and close the file */
+  void cleanup() override;
+
+  /* false as well once every packet was delivered */
+  bool isThreadRunning() override;
+
+  void registerCallback(CAMCALLBACK f, void* param) override;
+
+  /* Start over at the first packet after the last, must be set before
+   * start() */
+  void setLoop(bool loop);
+
+  /* Packets found by init() */
+  size_t getPacketCount();
+
+  void getStats(ReplayStats& stats);
+
+private:
+  typedef struct Packet
+  {
+    uint64_t offset;
+    uint32_t length;
+    /* When it is due, from the first packet */
+    uint64_t timeUs;
+  } Packet;
+
+  /* Packets of a StreamRecorder recording, false if path is not one */
+  bool readRecording();
+  /* Packets of an elementary stream */
+  bool scanElementaryStream();
+
+  static void* replayThreadEntry(void*);
+  void replayThreadFunc();
+
+  std::string path;
+  ReplayMode  mode;
+  double      fps;
+  bool        loop;
+
+  FILE*               file;
+  std::vector<Packet> packets;
+  std::vector<uint8_t> packetBuffer;
+
+  pthread_t         replayThread;
+  int               threadStatus;
+  std::atomic<bool> isRunning;
+
+  CAMCALLBACK cb;
+  void*       cbParam;
+
+  pthread_mutex_t statsMutex;
+  ReplayStats     stats;
+};
+
+#endif // DJICAMERASTREAMFILESOURCE_HH
@@ -15,33 +15,32 @@
 #include "pthread.h"
 
 #include "dji_camera_image.hpp"
+#include "dji_camera_stream_source.hpp"
 
-typedef void (*CAMCALLBACK)(void*, uint8_t*, int);
-
-class DJICameraStreamLink
+class DJICameraStreamLink : public DJICameraStreamSource
 {
 public:
   DJICameraStreamLink(CameraType c);
   ~DJICameraStreamLink();
   /* Establish link to camera */
-  bool init();
+  bool init() override;
 
   /* Start the data receiving thread */
-  bool start();
+  bool start() override;
 
   /* Stop the data receiving thread */
-  void stop();
+  void stop() override;
 
   /* do both stop and unInit */
-  void cleanup();
+  void cleanup() override;
 
   /* start routine for the data receiving thread*/
   static void* readThreadEntry(void *);
 
-  bool isThreadRunning();
+  bool isThreadRunning() override;
 
   /* register a callback function */
-  void registerCallback(CAMCALLBACK f, void* param);
+  void registerCallback(CAMCALLBACK f, void* param) override;
 
 private:
   CameraType  camType;
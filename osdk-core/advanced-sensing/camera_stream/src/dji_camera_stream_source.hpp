@@ -0,0 +1,48 @@
+/** @file dji_camera_stream_source.hpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief Where the raw H.264 of the camera stream comes from
+
+ *  @copyright 2026 DJI. All rights reserved.
+ *
+ */
+
+#ifndef DJICAMERASTREAMSOURCE_HH
+#define DJICAMERASTREAMSOURCE_HH
+
+#include <cstdint>
+
+typedef void (*CAMCALLBACK)(void*, uint8_t*, int);
+
+/*! @brief A thread handing H.264 to a callback as it arrives.
+ *
+ *  DJICameraStreamLink reads it from the camera over UDT,
+ *  DJICameraStreamFileSource from a file, so DJICameraStream and LiveView
+ *  can be run without an aircraft.
+ */
+class DJICameraStreamSource
+{
+public:
+  virtual ~DJICameraStreamSource() {}
+
+  /* Get ready to deliver, e.g. connect or open */
+  virtual bool init() = 0;
+
+  /* Start the delivering thread */
+  virtual bool start() = 0;
+
+  /* Stop the delivering thread */
+  virtual void stop() = 0;
+
+  /* do both stop and unInit */
+  virtual void cleanup() = 0;
+
+  virtual bool isThreadRunning() = 0;
+
+  /* register the function the data is delivered to, on the delivering
+   * thread; the buffer is only valid during the call */
+  virtual void registerCallback(CAMCALLBACK f, void* param) = 0;
+};
+
+#endif // DJICAMERASTREAMSOURCE_HH
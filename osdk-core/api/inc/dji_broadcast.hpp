@@ -30,6 +30,10 @@
 #ifndef DJIBROADCAST_H
 #define DJIBROADCAST_H
 
+#include <string.h>
+#if defined(__linux__)
+#include <atomic>
+#endif
 #include "dji_telemetry.hpp"
 #include "dji_vehicle_callback.hpp"
 
@@ -384,6 +388,76 @@ private:
   } FLAG;
   // clang-format on
 
+private:
+  /*! A3/N3/M600 fields are kept in wire order so that runs of enabled
+   *  fields decode with a single copy */
+  // clang-format off
+  typedef struct BroadcastCache
+  {
+    uint16_t                       passFlag    ;
+    Telemetry::TimeStamp           timeStamp   ;
+    Telemetry::SyncStamp           syncStamp   ;
+    Telemetry::Quaternion          q           ;
+    Telemetry::Vector3f            a           ;
+    Telemetry::Vector3f            v           ;
+    Telemetry::VelocityInfo        vi          ;
+    Telemetry::Vector3f            w           ;
+    Telemetry::GlobalPosition      gp          ;
+    Telemetry::RelativePosition    rp          ;
+    Telemetry::GPSInfo             gps         ;
+    Telemetry::RTK                 rtk         ;
+    Telemetry::Mag                 mag         ;
+    Telemetry::RC                  rc          ;
+    Telemetry::Gimbal              gimbal      ;
+    Telemetry::Status              status      ;
+    Telemetry::Battery             battery     ;
+    Telemetry::SDKInfo             info        ;
+    Telemetry::Compass             compass     ;
+    /*
+     * @note Broadcast data for Matrice 100/600 older firmware that is fundamentally
+     * different from the A3/N3/M600 newer firmware
+     */
+    Telemetry::LegacyTimeStamp     legacyTimeStamp;
+    Telemetry::LegacyVelocity      legacyVelocity;
+    Telemetry::LegacyStatus        legacyStatus;
+    Telemetry::LegacyBattery       legacyBattery;
+    Telemetry::LegacyGPSInfo       legacyGPSInfo;
+  } BroadcastCache;
+  // clang-format on
+
+  /*! One field of a broadcast payload, in wire order */
+  typedef struct FieldLayout
+  {
+    uint16_t flag;
+    uint16_t offset; /*!< offsetof(BroadcastCache, field) */
+    uint16_t size;
+  } FieldLayout;
+
+  static const int MAX_BROADCAST_FIELDS = 18;
+
+  static const int DECODE_TABLE_CACHE    = 4;
+
+  /*! Copies needed for one passFlag, adjacent fields merged */
+  typedef struct DecodeTable
+  {
+    const FieldLayout* layout;
+    uint16_t           passFlag;
+    uint16_t           count;
+    struct
+    {
+      uint16_t dst;
+      uint16_t src;
+      uint16_t size;
+    } steps[MAX_BROADCAST_FIELDS];
+  } DecodeTable;
+
+  static const FieldLayout fieldsA3[];
+  static const FieldLayout fieldsM100[];
+  static const FieldLayout fieldsOldM600[];
+  static const int         fieldsA3Count;
+  static const int         fieldsM100Count;
+  static const int         fieldsOldM600Count;
+
 private:
   /*!
    * @brief Extract broadcast data for A3/N3/M600
@@ -403,47 +477,55 @@ private:
    */
   void unpackOldM600Data(RecvContainer* recvFrame);
 
-  inline void unpackOne(FLAG flag, void* data, uint8_t*& buf, size_t size);
+  void decode(RecvContainer* recvFrame, const FieldLayout* layout, int count);
+  const DecodeTable* getDecodeTable(const FieldLayout* layout, int count,
+                                    uint16_t passFlag);
+
+  /*!
+   * @brief Copy one cached field without blocking the decoder
+   * @details The cache is guarded by a sequence counter: the decoder makes it
+   * odd while writing, readers retry until they copied under the same even
+   * value. Without <atomic> (STM32) readers take the decoder's lock instead.
+   */
+  template <typename T>
+  T readCache(const T& field) const
+  {
+    T data;
+#if defined(__linux__)
+    uint32_t seq;
+    do
+    {
+      seq = cacheSeq.load(std::memory_order_acquire);
+      memcpy(&data, &field, sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((seq & 1) || seq != cacheSeq.load(std::memory_order_relaxed));
+#else
+    DataBroadcast* self = const_cast<DataBroadcast*>(this);
+    self->lockMSG();
+    memcpy(&data, &field, sizeof(T));
+    self->freeMSG();
+#endif
+    return data;
+  }
 
 public:
   void setBroadcastLength(uint16_t length);
   uint16_t getBroadcastLength();
 
 private:
-  // clang-format off
-  Telemetry::TimeStamp           timeStamp   ;
-  Telemetry::SyncStamp           syncStamp   ;
-  Telemetry::Quaternion          q           ;
-  Telemetry::Vector3f            a           ;
-  Telemetry::Vector3f            v           ;
-  Telemetry::Vector3f            w           ;
-  Telemetry::VelocityInfo        vi          ;
-  Telemetry::GlobalPosition      gp          ;
-  Telemetry::RelativePosition    rp          ;
-  Telemetry::GPSInfo             gps         ;
-  Telemetry::RTK                 rtk         ;
-  Telemetry::Mag                 mag         ;
-  Telemetry::RC                  rc          ;
-  Telemetry::Gimbal              gimbal      ;
-  Telemetry::Status              status      ;
-  Telemetry::Battery             battery     ;
-  Telemetry::SDKInfo             info        ;
-  Telemetry::Compass             compass     ;
-  /*
-   * @note Broadcast data for Matrice 100/600 older firmware that is fundamentally
-   * different from the A3/N3/M600 newer firmware
-   */
-  Telemetry::LegacyTimeStamp	    legacyTimeStamp;
-  Telemetry::LegacyVelocity       legacyVelocity;
-  Telemetry::LegacyStatus         legacyStatus;
-  Telemetry::LegacyBattery        legacyBattery;
-  Telemetry::LegacyGPSInfo        legacyGPSInfo;
-  // clang-format on
+  BroadcastCache        cache;
+#if defined(__linux__)
+  std::atomic<uint32_t> cacheSeq;
+#endif
+  /*! passFlag differs between frames when topics run at different rates */
+  DecodeTable           decodeTables[DECODE_TABLE_CACHE];
+  int                   nextDecodeTable;
+
 private:
   Vehicle* vehicle;
-  uint16_t passFlag;
   uint16_t broadcastLength;
 
+  /*! serializes decoders, readers go through readCache() */
   T_OsdkMutexHandle m_msgLock;
   void lockMSG();
   void freeMSG();
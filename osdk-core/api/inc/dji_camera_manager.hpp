@@ -1633,6 +1633,7 @@ class CameraManager {
                                                    bool enable, int timeout);
 #if defined(__linux__)
   ErrorCode::ErrorCodeType startReqFileList(FileMgr::FileListReqCBType cb, void *userData);
+  void clearFileListCache();
   ErrorCode::ErrorCodeType startReqFileData(int fileIndex, std::string localPath, FileMgr::FileDataReqCBType cb, void *userData);
 #endif
  private:
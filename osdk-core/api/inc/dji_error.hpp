@@ -146,8 +146,8 @@ class ErrorCode {
   /*! @brief Releated messages about error codes
    */
   typedef struct ErrorCodeMsg {
-    ErrorCodeMsg(const char* moduleMsg, const char* errorMsg,
-                 const char* solutionMsg)
+    constexpr ErrorCodeMsg(const char* moduleMsg, const char* errorMsg,
+                           const char* solutionMsg)
         : moduleMsg(moduleMsg), errorMsg(errorMsg), solutionMsg(solutionMsg){};
     const char* moduleMsg;
     const char* errorMsg;
@@ -158,10 +158,22 @@ class ErrorCode {
    */
   typedef std::map<const RawRetCodeType, ErrorCodeMsg> ErrorCodeMapType;
 
+  /*! @brief Messages of one raw return code, the module name is taken from
+   *  the module table
+   */
+  typedef struct ErrorCodeEntry
+  {
+    RawRetCodeType rawRetCode;
+    const char* errorMsg;
+    const char* solutionMsg;
+  } ErrorCodeEntry;
+
   typedef struct FunctionDataType
   {
     const char* FunctionName;
-    const ErrorCodeMapType (*getMap)();
+    /*! sorted by rawRetCode, looked up by binary search */
+    const ErrorCodeEntry *entries;
+    uint16_t entryCount;
   } FunctionDataType;
 
   typedef struct ModuleDataType
@@ -194,7 +206,9 @@ class ErrorCode {
    *  @param errCode Unified error type
    *  @return Module ID ref to DJI::OSDK::ErrorCode::ModuleID
    */
-  static ErrorCode::ModuleIDType getModuleID(ErrorCodeType errCode);
+  static constexpr ErrorCode::ModuleIDType getModuleID(ErrorCodeType errCode) {
+    return (ModuleIDType)((errCode >> moduleIDLeftMove) & 0xFF);
+  }
 
   /*! @brief Get the module name from errCode
    *  @param errCode Unified error type
@@ -206,13 +220,19 @@ class ErrorCode {
    *  @param errCode Unified error type
    *  @return Function name
    */
-  static ErrorCode::FunctionIDType getFunctionID(ErrorCodeType errCode);
+  static constexpr ErrorCode::FunctionIDType getFunctionID(
+      ErrorCodeType errCode) {
+    return (FunctionIDType)((errCode >> functionIDLeftMove) & 0xFF);
+  }
 
   /*! @brief Get the raw reture code from errCode
    *  @param errCode Unified error type
    *  @return Function name
    */
-  static ErrorCode::RawRetCodeType getRawRetCode(ErrorCodeType errCode);
+  static constexpr ErrorCode::RawRetCodeType getRawRetCode(
+      ErrorCodeType errCode) {
+    return (RawRetCodeType)(errCode & 0xFFFFFFFF);
+  }
 
   static ErrorCode::ErrorCodeType getLinkerErrorCode(E_OsdkStat cb_type);
 
@@ -1296,42 +1316,29 @@ class ErrorCode {
 
   /*! @brief The err code message data of the PSDKCommonErr error code messages.
    */
-  static const std::pair<const ErrorCode::ErrorCodeType, ErrorCode::ErrorCodeMsg> PSDKCommonErrData[];
-
-  /*! @brief Get the map container of the PSDKCommonErr error code messages.
-   */
-  static const ErrorCodeMapType getPSDKCommonErrorMap();
+  static const ErrorCodeEntry PSDKCommonErrData[];
 
   /*! @brief The err code message data of the CameraCommonErr error code messages.
    */
-  static const std::pair<const ErrorCode::ErrorCodeType, ErrorCode::ErrorCodeMsg> CameraCommonErrData[];
-
-  /*! @brief Get the map container of the CameraCommonErr error code messages.
-   */
-  static const ErrorCodeMapType getCameraCommonErrorMap();
+  static const ErrorCodeEntry CameraCommonErrData[];
 
   /*! @brief The err code message data of the GimbalCommonErr error code messages.
    */
-  static const std::pair<const ErrorCode::ErrorCodeType, ErrorCode::ErrorCodeMsg> GimbalCommonErrData[];
-
-  /*! @brief Get the map container of the GimbalCommonErr error code messages.
-   */
-  static const ErrorCodeMapType getGimbalCommonErrorMap();
+  static const ErrorCodeEntry GimbalCommonErrData[];
 
   /*! @brief The err code message data of the SystemCommonErr error code messages.
    */
-  static const std::pair<const ErrorCode::ErrorCodeType, ErrorCode::ErrorCodeMsg> SystemCommonErrData[];
+  static const ErrorCodeEntry SystemCommonErrData[];
 
   /*! @brief The err code message data of the WaypointV2 error code messages.
- */
-  static const ErrorCodeMapType getWaypointV2CommonErrorMap();
-
-  static const std::pair<const ErrorCode::ErrorCodeType, ErrorCode::ErrorCodeMsg> WaypointV2CommonErrData[];
-
+   */
+  static const ErrorCodeEntry WaypointV2CommonErrData[];
 
-  /*! @brief Get the map container of the SystemCommonErr error code messages.
+  /*! @brief Look up the messages of a raw return code in a function table
+   *  @return NULL if the code is not in the table
    */
-  static const ErrorCodeMapType getSystemCommonErrorMap();
+  static const ErrorCodeEntry* findErrorCodeEntry(
+      const FunctionDataType& function, RawRetCodeType rawRetCode);
 
   /*! @brief The array to contain all the function maps of gimbal.
    */
@@ -32,6 +32,7 @@
 
 #include "dji_type.hpp"
 #include "dji_vehicle_callback.hpp"
+#include <string.h>
 #include <string>
 
 #if defined(__linux__)
@@ -106,6 +107,41 @@ public:
   {
     NMEAData Satellite[MAX_INDEX_CNT];
   }GNGSAPackage;
+
+  /*! Sentences kept by getLatestNMEA(), one slot each */
+  typedef enum NMEAKind
+  {
+    NMEA_GPGSA,
+    NMEA_GPRMC,
+    NMEA_GNGSA_GPS,
+    NMEA_GNGSA_GLONASS = NMEA_GNGSA_GPS + GLONASS,
+    NMEA_GNGSA_GALILEO = NMEA_GNGSA_GPS + GALILEO,
+    NMEA_GNGSA_BEIDOU  = NMEA_GNGSA_GPS + BEIDOU,
+    NMEA_GNRMC,
+    NMEA_UTC,
+    NMEA_KIND_NUM
+  }NMEAKind;
+
+  /*! Fixed size counterpart of NMEAData */
+  typedef struct NMEASentence
+  {
+    char sentence[MAX_INCOMING_DATA_SIZE + 1]; // not NUL terminated on the wire, here it is
+    uint16_t length;
+    uint32_t seq;
+    RecvTimeMsg timestamp;    // this is OSDK recv time
+    uint64_t recvMonotonicNs; // OSDK recv time on the host monotonic clock
+  }NMEASentence;
+
+  /*! Relation between the flight controller clock and the host monotonic
+   *  clock, measured at the last PPS edge */
+  typedef struct PPSOffset
+  {
+    ACK::FCTimeInUTC fcTimeInUTC; // FC time and UTC of the PPS edge
+    uint64_t hostEdgeNs;  // host monotonic time of the same edge
+    int64_t  offsetNs;    // hostEdgeNs - fc_timestamp_us * 1000
+    bool     edgeFromHost; // edge timed by notifyPPSEdge(), else by the FC push arrival
+    uint32_t seq;
+  }PPSOffset;
 public:
   HardwareSync(Vehicle* vehiclePtr = 0);
 
@@ -192,6 +228,34 @@ public:
    *  @param data struct to fill
    */
   bool getPPSSource(PPSSource &source);
+  /*! @brief Read the latest sentence of a kind without consuming it
+   *
+   *  @details Lock-free and allocation-free, may be called from any thread
+   *  while sentences keep arriving.
+   *
+   *  @param kind which sentence
+   *  @param nmea struct to fill
+   *  @return false if no sentence of this kind has been received yet
+   */
+  bool getLatestNMEA(NMEAKind kind, NMEASentence &nmea) const;
+  /*! @brief Time a PPS edge on the host
+   *  @details Call this from a GPIO or /dev/pps handler if the PPS line is
+   *  wired to the host as well. The next FC time push is then paired with
+   *  this edge instead of with its own arrival time, which removes the link
+   *  latency from the offset.
+   *
+   *  @param hostMonotonicNs CLOCK_MONOTONIC time of the edge in ns
+   */
+  void notifyPPSEdge(uint64_t hostMonotonicNs);
+  /*! @brief Poll the offset between FC clock and host monotonic clock
+   *  @details Updated on every FC time push (once per PPS pulse). Lock-free.
+   *  @note fc_timestamp_us wraps after about 71 minutes, so only use the
+   *  offset with FC timestamps close to fcTimeInUTC.fc_timestamp_us.
+   *
+   *  @param offset struct to fill
+   *  @return false if no FC time push has been received yet
+   */
+  bool getPPSOffset(PPSOffset &offset) const;
   /*! @brief Write data when received from UART
    *
    *  @param cmd id
@@ -200,20 +264,103 @@ public:
   void writeData(const uint8_t cmdID, const RecvContainer *recvContainer);
 
 private:
-  void writeNMEA(const std::string &nmea);
+  void writeNMEA(const char *nmea, uint16_t length);
+  void storeNMEA(NMEAKind kind, const char *nmea, uint16_t length);
+  void storePPSOffset(const ACK::FCTimeInUTC &fcTime);
+  bool readNMEA(NMEAKind kind, NMEAData &nmea) const;
 
   Vehicle* vehicle;
 
   //pthread_mutex_t mutexHardSync;
   //pthread_cond_t  condVarHardSync;
 
-  NMEAData GPGSAData;
-  NMEAData GPRMCData;
-  GNGSAPackage GNGSAData;
-  NMEAData GNRMCData;
+#if STM32
+  /*! No <atomic> with ARMCC 5; one core, so volatile plus a compiler
+   *  barrier keeps the same protocol */
+  typedef volatile uint32_t SeqCounter;
+  typedef volatile uint64_t EdgeTime;
+#elif defined(__linux__)
+  typedef std::atomic<uint32_t> SeqCounter;
+  typedef std::atomic<uint64_t> EdgeTime;
+#endif
+
+  /*! Written by the receive thread only, readers retry while seq is odd
+   *  or changed under them */
+  typedef struct NMEASlot
+  {
+    SeqCounter   seq;
+    NMEASentence data;
+  } NMEASlot;
+
+  NMEASlot nmeaSlots[NMEA_KIND_NUM];
+
+  SeqCounter ppsOffsetSeq;
+  PPSOffset  ppsOffset;
+  EdgeTime   ppsEdgeNs;
+
+#if STM32
+  static void seqlockBarrier()
+  {
+#if defined(__CC_ARM)
+    __dmb(0xF);
+#else
+    __asm__ __volatile__("" ::: "memory");
+#endif
+  }
+
+  static void seqlockBeginWrite(SeqCounter &seq)
+  {
+    seq = seq + 1;
+    seqlockBarrier();
+  }
+
+  static void seqlockEndWrite(SeqCounter &seq)
+  {
+    seqlockBarrier();
+    seq = seq + 1;
+  }
+
+  /*! @return false if nothing has been written yet */
+  template <typename T>
+  static bool seqlockRead(const SeqCounter &seq, const T &src, T &dst)
+  {
+    uint32_t s;
+    do
+    {
+      s = seq;
+      seqlockBarrier();
+      memcpy(&dst, &src, sizeof(T));
+      seqlockBarrier();
+    } while ((s & 1) || s != seq);
+    return s != 0;
+  }
+#elif defined(__linux__)
+  static void seqlockBeginWrite(SeqCounter &seq)
+  {
+    seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  static void seqlockEndWrite(SeqCounter &seq)
+  {
+    seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  /*! @return false if nothing has been written yet */
+  template <typename T>
+  static bool seqlockRead(const SeqCounter &seq, const T &src, T &dst)
+  {
+    uint32_t s;
+    do
+    {
+      s = seq.load(std::memory_order_acquire);
+      memcpy(&dst, &src, sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((s & 1) || s != seq.load(std::memory_order_relaxed));
+    return s != 0;
+  }
+#endif
 
-  NMEAData UTCData;
-  ACK::FCTimeInUTC fcTimeInUTC;
   PPSSource  ppsSourceType;
 
 #if STM32
@@ -245,6 +392,9 @@ private:
   */
   void recordRecvTimeMsg(RecvTimeMsg &recvTime);
 
+ /*! @return host monotonic time in ns; ms resolution on STM32 */
+  static uint64_t getMonotonicNs();
+
   HWSyncDataFlag GPGSAFlag;
   HWSyncDataFlag GPRMCFlag;
   HWSyncDataFlag GNGSAFlag;
@@ -30,6 +30,7 @@
 #define ONBOARDSDK_DJI_HMS_INTERNAL_HPP
 #include "dji_type.hpp"
 #include <iostream>
+#include <string>
 using namespace std;
 
 namespace DJI{
@@ -38,15 +39,43 @@ namespace OSDK{
 /*! the type of HMS's error code information*/
 typedef struct HMSErrCodeInfo {
     uint32_t alarmId;            /*! error code*/
-    std::string groundAlarmInfo; /*! alarm information when the flight is on the ground*/
-    std::string flyAlarmInfo;    /*! alarm information when the flight is in the air*/
+    const char* groundAlarmInfo; /*! alarm information when the flight is on the ground*/
+    const char* flyAlarmInfo;    /*! alarm information when the flight is in the air*/
 } HMSErrCodeInfo;
 
 /*! the length of HMS's error code table*/
-const uint32_t dbHMSErrNum = 600;
+extern const uint32_t dbHMSErrNum;
+
+/*! length of msgVersion, globalIndex and msgEnd/msgIndex ahead of the error
+ *  code list in HMS's raw pushing data*/
+const uint16_t hmsPushHeaderLen = 3;
+
+/*! HMS's error code table, read-only and in no particular order*/
+extern const HMSErrCodeInfo hmsErrCodeInfoTbl[];
 
 extern void encodeSender(const uint8_t sender,uint8_t & deviceType, uint8_t & deviceIndex);
 extern bool replaceStr(string &str, const string oldReplaceStr, const string newReplaceStr);
+
+/*! @brief Look up an alarm id in HMS's error code table
+ *
+ *  @note The lookup goes through an index sorted by alarm id that is built
+ *  once on first use and never modified afterwards, so it may be called from
+ *  any thread.
+ *
+ *  @return the table entry, or NULL if the alarm id is unknown
+ */
+extern const HMSErrCodeInfo* findHMSErrCodeInfo(uint32_t alarmId);
+
+/*! @brief Fill in the placeholders of an alarm information template
+ *
+ *  %alarmid becomes the alarm id as 0x%08X, %index the sensor index and
+ *  %component_index the camera or gimbal index. Every occurrence is
+ *  replaced; the template itself is left untouched.
+ *
+ *  @return the formatted alarm information
+ */
+extern std::string formatHMSAlarmInfo(const char* alarmInfo, uint32_t alarmId,
+                                      uint8_t sensorIndex, uint8_t componentIndex);
  }
   }
 #endif //ONBOARDSDK_DJI_HMS_INTERNAL_HPP
\ No newline at end of file
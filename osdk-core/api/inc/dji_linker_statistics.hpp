@@ -0,0 +1,280 @@
+/** @file dji_linker_statistics.hpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief
+ *  Counters and latency histograms for the linker send/receive paths
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef DJI_LINKER_STATISTICS_H_
+#define DJI_LINKER_STATISTICS_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "dji_singleton.hpp"
+#include "osdk_platform.h"
+#include "osdk_protocol.h"
+
+namespace DJI
+{
+namespace OSDK
+{
+
+/*! @brief Built-in instrumentation of the command link.
+ *
+ *  The linker itself is closed, so data is collected at the two places we
+ *  own: the HAL read/write functions registered through Platform (bytes and
+ *  frames per channel, wire round trip per command, retransmits, pushes) and
+ *  the LegacyLinker send/receive adapters (enqueue to ACK latency, timeouts,
+ *  push receive to callback latency).
+ *
+ *  Counters are relaxed atomics in tables allocated on first use, so the
+ *  hot paths take no locks apart from the per-channel frame parser.
+ *  Query it at any time with LinkerStatistics::instance().getSnapshot().
+ *
+ *  Off until setEnabled(true): on UART the tap runs the SDK and V1 parsers
+ *  over every byte in both directions under the channel lock and unpacks
+ *  encrypted SDK requests to learn their command. USB bulk transfers hold
+ *  one frame each, so there only the header is decoded. The benchmarks
+ *  linker/get_version_stats_off and _on measure the difference.
+ */
+class LinkerStatistics : public Singleton<LinkerStatistics>
+{
+public:
+  /*! log2 buckets in microseconds: bucket i holds [2^i, 2^(i+1)) us,
+   *  bucket 0 also holds 0 us, the last one everything above ~8.4 s */
+  static const int HISTOGRAM_BUCKETS = 24;
+  static const int MAX_CHANNELS      = 4;
+
+  typedef enum ChannelType
+  {
+    CHANNEL_UART     = 0,
+    CHANNEL_USB_BULK = 1,
+  } ChannelType;
+
+  typedef struct Histogram
+  {
+    uint64_t count;
+    uint64_t sumUs;
+    uint64_t maxUs;
+    uint32_t buckets[HISTOGRAM_BUCKETS];
+
+    /*! @return upper bound of the bucket holding the given percentile */
+    uint64_t percentileUs(double percentile) const;
+  } Histogram;
+
+  typedef struct CommandStats
+  {
+    uint8_t  cmdSet;
+    uint8_t  cmdId;
+    /*! requests put on the wire, first transmission only */
+    uint64_t sent;
+    uint64_t retransmits;
+    uint64_t acked;
+    uint64_t timeouts;
+    /*! frames of this command received without being requested */
+    uint64_t pushes;
+    /*! first transmission to ACK frame received */
+    Histogram wireRtt;
+    /*! LegacyLinker send call to ACK handed back to the caller */
+    Histogram ackLatency;
+    /*! push frame received to its callback starting */
+    Histogram pushLatency;
+  } CommandStats;
+
+  typedef struct ChannelStats
+  {
+    uint8_t     index;
+    ChannelType type;
+    uint64_t    txBytes;
+    uint64_t    rxBytes;
+    uint64_t    txFrames;
+    uint64_t    rxFrames;
+  } ChannelStats;
+
+  typedef struct Snapshot
+  {
+    uint64_t                  timestampUs;
+    std::vector<ChannelStats> channels;
+    /*! only commands that saw any traffic, ordered by cmdSet/cmdId */
+    std::vector<CommandStats> commands;
+  } Snapshot;
+
+public:
+  LinkerStatistics();
+  ~LinkerStatistics();
+
+  /*! Disabled by default, when every hook is a single load */
+  void setEnabled(bool enable);
+  bool isEnabled() const;
+
+  /*! Clears all counters, keeps registered channels */
+  void reset();
+
+  Snapshot getSnapshot() const;
+  bool getCommandStats(uint8_t cmdSet, uint8_t cmdId,
+                       CommandStats& stats) const;
+  std::vector<ChannelStats> getChannelStats() const;
+
+  /*! @return the snapshot as one JSON object */
+  static std::string toJson(const Snapshot& snapshot);
+
+  static uint64_t nowUs();
+
+  /*! Hooks for Platform: wrap the HAL handlers registered by the user so
+   *  every read/write on a channel is accounted for. */
+  const T_OsdkHalUartHandler* wrapUartHandler(
+    const T_OsdkHalUartHandler* handler);
+#ifdef __linux__
+  const T_OsdkHalUSBBulkHandler* wrapUSBBulkHandler(
+    const T_OsdkHalUSBBulkHandler* handler);
+#endif
+
+  /*! Hooks for LegacyLinker */
+  void onAckDelivered(uint8_t cmdSet, uint8_t cmdId, uint64_t queuedUs);
+  void onTimeout(uint8_t cmdSet, uint8_t cmdId);
+  void onPushDelivered(uint8_t cmdSet, uint8_t cmdId);
+
+private:
+  typedef struct AtomicHistogram
+  {
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> sumUs;
+    std::atomic<uint64_t> maxUs;
+    std::atomic<uint32_t> buckets[HISTOGRAM_BUCKETS];
+  } AtomicHistogram;
+
+  typedef struct CommandSlot
+  {
+    std::atomic<uint64_t> sent;
+    std::atomic<uint64_t> retransmits;
+    std::atomic<uint64_t> acked;
+    std::atomic<uint64_t> timeouts;
+    std::atomic<uint64_t> pushes;
+    std::atomic<uint64_t> lastPushUs;
+    AtomicHistogram       wireRtt;
+    AtomicHistogram       ackLatency;
+    AtomicHistogram       pushLatency;
+  } CommandSlot;
+
+  /*! Request on the wire waiting for its ACK, indexed by seq */
+  typedef struct PendingRequest
+  {
+    bool     valid;
+    uint16_t seqNum;
+    uint8_t  cmdSet;
+    uint8_t  cmdId;
+    uint64_t sentUs;
+  } PendingRequest;
+
+  static const int PENDING_SLOTS = 256;
+
+  typedef struct FrameHeader
+  {
+    bool     isAck;
+    bool     needAck;
+    uint16_t seqNum;
+    /*! unknown (0) on SDK ACK frames */
+    uint8_t  cmdSet;
+    uint8_t  cmdId;
+  } FrameHeader;
+
+  /*! Frame reassembly for one direction of a channel */
+  typedef struct FrameTap
+  {
+    std::mutex           mutex;
+    T_CmdParse           parse[2];
+    std::vector<uint8_t> parseBuf[2];
+    std::vector<uint8_t> unpackBuf;
+    /*! Header of the bulk frame being decoded */
+    std::vector<uint8_t> bulkBuf;
+  } FrameTap;
+
+  typedef struct Channel
+  {
+    std::atomic<bool>     used;
+    const T_HalObj*       obj;
+    ChannelType           type;
+    std::atomic<uint64_t> txBytes;
+    std::atomic<uint64_t> rxBytes;
+    std::atomic<uint64_t> txFrames;
+    std::atomic<uint64_t> rxFrames;
+    FrameTap              tx;
+    FrameTap              rx;
+    std::mutex            pendingMutex;
+    PendingRequest        pending[PENDING_SLOTS];
+  } Channel;
+
+  CommandSlot* slot(uint8_t cmdSet, uint8_t cmdId);
+  const CommandSlot* findSlot(uint8_t cmdSet, uint8_t cmdId) const;
+  Channel* channel(const T_HalObj* obj, ChannelType type);
+
+  void tap(Channel* ch, bool isTx, const uint8_t* buf, uint32_t len);
+  void tapBulkFrame(Channel* ch, bool isTx, const uint8_t* buf, uint32_t len);
+  bool decodeHeader(FrameTap& frameTap, uint8_t* frame, uint32_t len,
+                    int protocol, FrameHeader& header);
+  void onFrame(Channel* ch, bool isTx, uint8_t* frame, uint32_t len,
+               int protocol);
+
+  static void record(AtomicHistogram& histogram, uint64_t us);
+  static void load(const AtomicHistogram& histogram, Histogram& out);
+  static void clear(AtomicHistogram& histogram);
+
+  static E_OsdkStat uartWriteData(const T_HalObj* obj, const uint8_t* pBuf,
+                                  uint32_t bufLen);
+  static E_OsdkStat uartReadData(const T_HalObj* obj, uint8_t* pBuf,
+                                 uint32_t* bufLen);
+#ifdef __linux__
+  static E_OsdkStat usbBulkWriteData(const T_HalObj* obj, const uint8_t* pBuf,
+                                     uint32_t bufLen);
+  static E_OsdkStat usbBulkReadData(const T_HalObj* obj, uint8_t* pBuf,
+                                    uint32_t* bufLen);
+#endif
+
+private:
+  std::atomic<bool>         enabled;
+  std::atomic<CommandSlot*> table[256];
+  Channel                   channels[MAX_CHANNELS];
+  std::mutex                channelMutex;
+
+  /*! SDK and V1 protocol ops used to split the byte streams into frames */
+  T_ProtocolOps protocolOps[2];
+  void*         protocolExt[2];
+  bool          protocolReady[2];
+
+  T_OsdkHalUartHandler    userUart;
+  T_OsdkHalUartHandler    wrappedUart;
+#ifdef __linux__
+  T_OsdkHalUSBBulkHandler userUSBBulk;
+  T_OsdkHalUSBBulkHandler wrappedUSBBulk;
+#endif
+};
+
+} // namespace OSDK
+} // namespace DJI
+
+#endif // DJI_LINKER_STATISTICS_H_
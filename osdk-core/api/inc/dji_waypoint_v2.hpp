@@ -45,6 +45,31 @@ namespace OSDK
   public:
     const uint16_t MAX_WAYPOINT_NUM_SIGNAL_PUSH = 260;
 
+    /*! Most upload chunks that may wait for their ACK at once, half of the
+     *  linker's wait-ACK list */
+    static const uint8_t MAX_UPLOAD_WINDOW = 16;
+
+    /*! Progress of uploadMission() or uploadAction() */
+    typedef struct UploadProgress
+    {
+      /*! waypoints or actions to upload */
+      uint32_t itemsTotal;
+      /*! waypoints or actions the flight controller acknowledged */
+      uint32_t itemsAcked;
+      /*! chunk payload bytes the flight controller acknowledged */
+      uint32_t bytesAcked;
+      /*! chunks sent and still waiting for their ACK */
+      uint8_t  chunksInFlight;
+      /*! time since the upload started */
+      uint32_t elapsedMs;
+      /*! bytesAcked over elapsedMs */
+      uint32_t bytesPerSecond;
+    } UploadProgress;
+
+    /*! Called on the uploading thread each time more chunks were acknowledged */
+    typedef void (*UploadProgressCallback)(const UploadProgress &progress,
+                                           void *userData);
+
     WaypointV2MissionOperator(Vehicle* vehiclePtr);
 
     ~WaypointV2MissionOperator();
@@ -139,6 +164,31 @@ namespace OSDK
     */
     ErrorCode::ErrorCodeType uploadAction(std::vector<DJIWaypointV2Action> &actions, int timeout);
 
+   /*! @brief Set how many upload chunks may wait for their ACK at once
+    *
+    *  uploadMission() and uploadAction() split their data into chunks of
+    *  around 200 and 100 bytes. With a window of 1, the default, each chunk
+    *  waits for the previous one to be acknowledged; larger windows keep the
+    *  link busy while ACKs are on their way.
+    *  @param window chunks in flight, clamped to [1, MAX_UPLOAD_WINDOW]
+    */
+    void setUploadWindow(uint8_t window);
+
+    uint8_t getUploadWindow() const { return uploadWindow; }
+
+   /*! @brief Set the callback reporting progress and throughput of uploads
+    *
+    *  @param callback called from uploadMission()/uploadAction(), NULL for none
+    *  @param userData passed back to the callback
+    */
+    void setUploadProgressCallback(UploadProgressCallback callback, void *userData);
+
+   /*! @brief Get the final progress of the last uploadMission()/uploadAction()
+    *
+    *  @return UploadProgress, itemsAcked < itemsTotal if the upload failed
+    */
+    const UploadProgress &getLastUploadProgress() const { return lastUploadProgress; }
+
    /*! @brief Get action's remain memory
     *
     *  @param remainRamAck contains total memory and remain memory
@@ -185,6 +235,12 @@ namespace OSDK
     Vehicle *vehiclePtr;
 
     float32_t takeoffAltitude;
+
+    uint8_t uploadWindow;
+    UploadProgressCallback uploadProgressCallback;
+    void *uploadProgressUserData;
+    UploadProgress lastUploadProgress;
+
     void RegisterOSDInfoCallback(Vehicle *vehiclePtr);
 
   };
@@ -29,10 +29,79 @@
 
 #include "dji_broadcast.hpp"
 #include "dji_vehicle.hpp"
+#include <stddef.h>
 
 using namespace DJI;
 using namespace DJI::OSDK;
 
+#define BROADCAST_FIELD(flag, field)                                           \
+  {                                                                            \
+    flag, offsetof(BroadcastCache, field),                                     \
+      sizeof(((BroadcastCache*)0)->field)                                      \
+  }
+
+// clang-format off
+const DataBroadcast::FieldLayout DataBroadcast::fieldsA3[] = {
+  BROADCAST_FIELD(FLAG_TIME        , timeStamp ),
+  BROADCAST_FIELD(FLAG_TIME        , syncStamp ),
+  BROADCAST_FIELD(FLAG_QUATERNION  , q         ),
+  BROADCAST_FIELD(FLAG_ACCELERATION, a         ),
+  BROADCAST_FIELD(FLAG_VELOCITY    , v         ),
+  BROADCAST_FIELD(FLAG_VELOCITY    , vi        ),
+  BROADCAST_FIELD(FLAG_ANGULAR_RATE, w         ),
+  BROADCAST_FIELD(FLAG_POSITION    , gp        ),
+  BROADCAST_FIELD(FLAG_POSITION    , rp        ),
+  BROADCAST_FIELD(FLAG_GPSINFO     , gps       ),
+  BROADCAST_FIELD(FLAG_RTKINFO     , rtk       ),
+  BROADCAST_FIELD(FLAG_MAG         , mag       ),
+  BROADCAST_FIELD(FLAG_RC          , rc        ),
+  BROADCAST_FIELD(FLAG_GIMBAL      , gimbal    ),
+  BROADCAST_FIELD(FLAG_STATUS      , status    ),
+  BROADCAST_FIELD(FLAG_BATTERY     , battery   ),
+  BROADCAST_FIELD(FLAG_DEVICE      , info      ),
+  BROADCAST_FIELD(FLAG_COMPASS     , compass   ),
+};
+
+const DataBroadcast::FieldLayout DataBroadcast::fieldsM100[] = {
+  BROADCAST_FIELD(FLAG_TIME        , legacyTimeStamp),
+  BROADCAST_FIELD(FLAG_QUATERNION  , q              ),
+  BROADCAST_FIELD(FLAG_ACCELERATION, a              ),
+  BROADCAST_FIELD(FLAG_VELOCITY    , legacyVelocity ),
+  BROADCAST_FIELD(FLAG_ANGULAR_RATE, w              ),
+  BROADCAST_FIELD(FLAG_POSITION    , gp             ),
+  BROADCAST_FIELD(FLAG_M100_MAG    , mag            ),
+  BROADCAST_FIELD(FLAG_M100_RC     , rc             ),
+  BROADCAST_FIELD(FLAG_M100_GIMBAL , gimbal         ),
+  BROADCAST_FIELD(FLAG_M100_STATUS , legacyStatus   ),
+  BROADCAST_FIELD(FLAG_M100_BATTERY, legacyBattery  ),
+  BROADCAST_FIELD(FLAG_M100_DEVICE , info           ),
+};
+
+const DataBroadcast::FieldLayout DataBroadcast::fieldsOldM600[] = {
+  BROADCAST_FIELD(FLAG_TIME        , legacyTimeStamp),
+  BROADCAST_FIELD(FLAG_QUATERNION  , q              ),
+  BROADCAST_FIELD(FLAG_ACCELERATION, a              ),
+  BROADCAST_FIELD(FLAG_VELOCITY    , legacyVelocity ),
+  BROADCAST_FIELD(FLAG_ANGULAR_RATE, w              ),
+  BROADCAST_FIELD(FLAG_POSITION    , gp             ),
+  BROADCAST_FIELD(FLAG_GPSINFO     , legacyGPSInfo  ),
+  BROADCAST_FIELD(FLAG_RTKINFO     , rtk            ),
+  BROADCAST_FIELD(FLAG_MAG         , mag            ),
+  BROADCAST_FIELD(FLAG_RC          , rc             ),
+  BROADCAST_FIELD(FLAG_GIMBAL      , gimbal         ),
+  BROADCAST_FIELD(FLAG_STATUS      , legacyStatus   ),
+  BROADCAST_FIELD(FLAG_BATTERY     , legacyBattery  ),
+  BROADCAST_FIELD(FLAG_DEVICE      , info           ),
+};
+// clang-format on
+
+const int DataBroadcast::fieldsA3Count =
+  sizeof(fieldsA3) / sizeof(fieldsA3[0]);
+const int DataBroadcast::fieldsM100Count =
+  sizeof(fieldsM100) / sizeof(fieldsM100[0]);
+const int DataBroadcast::fieldsOldM600Count =
+  sizeof(fieldsOldM600) / sizeof(fieldsOldM600[0]);
+
 void
 DataBroadcast::unpackCallback(Vehicle* vehicle, RecvContainer recvFrame,
                               UserData data)
@@ -67,6 +136,13 @@ DataBroadcast::DataBroadcast(Vehicle* vehiclePtr)
   userCbHandler.callback = 0;
   userCbHandler.userData = 0;
 
+  memset(&cache, 0, sizeof(cache));
+#if defined(__linux__)
+  cacheSeq.store(0);
+#endif
+  memset(decodeTables, 0, sizeof(decodeTables));
+  nextDecodeTable = 0;
+
   Platform::instance().mutexCreate(&m_msgLock);
   if (vehiclePtr)
   {
@@ -86,24 +162,24 @@ Telemetry::TimeStamp
 DataBroadcast::getTimeStamp()
 {
   Telemetry::TimeStamp  data;
-  lockMSG();
   if (vehicle->isLegacyM600())
   {
     // Supported Broadcast data in Matrice 600 old firmware
-    data.time_ms = legacyTimeStamp.time;
-    data.time_ns = legacyTimeStamp.nanoTime;
+    Telemetry::LegacyTimeStamp legacy = readCache(cache.legacyTimeStamp);
+    data.time_ms = legacy.time;
+    data.time_ns = legacy.nanoTime;
   }
   else if(vehicle->isM100())
   {
     // Supported Broadcast data in Matrice 100
-    data.time_ms = legacyTimeStamp.time;
-    data.time_ns = legacyTimeStamp.nanoTime;
+    Telemetry::LegacyTimeStamp legacy = readCache(cache.legacyTimeStamp);
+    data.time_ms = legacy.time;
+    data.time_ns = legacy.nanoTime;
   }
   else
   {
-    data = timeStamp;
+    data = readCache(cache.timeStamp);
   }
-  freeMSG();
   return data;
 }
 
@@ -111,69 +187,59 @@ Telemetry::SyncStamp
 DataBroadcast::getSyncStamp()
 {
   Telemetry::SyncStamp data = {0};
-  lockMSG();
   if (vehicle->isLegacyM600())
   {
     // Supported Broadcast data in Matrice 600 old firmware
-    data.flag = legacyTimeStamp.syncFlag;
+    data.flag = readCache(cache.legacyTimeStamp).syncFlag;
   }
   else if(vehicle->isM100())
   {
     // Supported Broadcast data in Matrice 100
-    data.flag = legacyTimeStamp.syncFlag;
+    data.flag = readCache(cache.legacyTimeStamp).syncFlag;
   }
   else
   {
-    data = syncStamp;
+    data = readCache(cache.syncStamp);
   }
-  freeMSG();
   return data;
 }
 
 Telemetry::Quaternion
 DataBroadcast::getQuaternion()
 {
-  Telemetry::Quaternion data;
-  lockMSG();
-  data = q;
-  freeMSG();
-  return data;
+  return readCache(cache.q);
 }
 
 Telemetry::Vector3f
 DataBroadcast::getAcceleration()
 {
-  Telemetry::Vector3f data;
-  lockMSG();
-  data = a;
-  freeMSG();
-  return data;
+  return readCache(cache.a);
 }
 
 Telemetry::Vector3f
 DataBroadcast::getVelocity()
 {
   Telemetry::Vector3f data;
-  lockMSG();
   if (vehicle->isLegacyM600())
   {
     // Supported Broadcast data in Matrice 600 old firmware
-    data.x = legacyVelocity.x;
-    data.y = legacyVelocity.y;
-    data.z = legacyVelocity.z;
+    Telemetry::LegacyVelocity legacy = readCache(cache.legacyVelocity);
+    data.x = legacy.x;
+    data.y = legacy.y;
+    data.z = legacy.z;
   }
   else if(vehicle->isM100())
   {
     // Supported Broadcast data in Matrice 100
-    data.x = legacyVelocity.x;
-    data.y = legacyVelocity.y;
-    data.z = legacyVelocity.z;
+    Telemetry::LegacyVelocity legacy = readCache(cache.legacyVelocity);
+    data.x = legacy.x;
+    data.y = legacy.y;
+    data.z = legacy.z;
   }
   else
   {
-    data = v;
+    data = readCache(cache.v);
   }
-  freeMSG();
   return data;
 }
 
@@ -181,57 +247,45 @@ Telemetry::VelocityInfo
 DataBroadcast::getVelocityInfo()
 {
   Telemetry::VelocityInfo data;
-  lockMSG();
   if (vehicle->isLegacyM600())
   {
     // Supported Broadcast data in Matrice 600 old firmware
-    data.health = legacyVelocity.health;
-    data.reserve = legacyVelocity.reserve;
+    Telemetry::LegacyVelocity legacy = readCache(cache.legacyVelocity);
+    data.health = legacy.health;
+    data.reserve = legacy.reserve;
   }
   else if(vehicle->isM100())
   {
     // Supported Broadcast data in Matrice 100
-    data.health = legacyVelocity.health;
-    data.reserve = legacyVelocity.reserve;
+    Telemetry::LegacyVelocity legacy = readCache(cache.legacyVelocity);
+    data.health = legacy.health;
+    data.reserve = legacy.reserve;
     // TODO add sensorID (only M100)
   }
   else
   {
-    data = vi;
+    data = readCache(cache.vi);
   }
-  freeMSG();
   return data;
 }
 
 Telemetry::Vector3f
 DataBroadcast::getAngularRate()
 {
-  Telemetry::Vector3f data;
-  lockMSG();
-  data = w;
-  freeMSG();
-  return data;
+  return readCache(cache.w);
 }
 
 Telemetry::GlobalPosition
 DataBroadcast::getGlobalPosition()
 {
-  Telemetry::GlobalPosition data;
-  lockMSG();
-  data = gp;
-  freeMSG();
-  return data;
+  return readCache(cache.gp);
 }
 
 // Not supported on Matrice 100
 Telemetry::RelativePosition
 DataBroadcast::getRelativePosition()
 {
-  Telemetry::RelativePosition data;
-  lockMSG();
-  data = rp;
-  freeMSG();
-  return data;
+  return readCache(cache.rp);
 }
 
 // Not supported on Matrice 100
@@ -239,22 +293,21 @@ Telemetry::GPSInfo
 DataBroadcast::getGPSInfo()
 {
   Telemetry::GPSInfo data;
-  lockMSG();
   if (vehicle->isLegacyM600())
   {
     // Supported Broadcast data in Matrice 600 old firmware
-    data.latitude = legacyGPSInfo.latitude;
-    data.longitude = legacyGPSInfo.longitude;
-    data.HFSL = legacyGPSInfo.HFSL;
-    data.velocityNED = legacyGPSInfo.velocityNED;
-    data.time = legacyGPSInfo.time;
+    Telemetry::LegacyGPSInfo legacy = readCache(cache.legacyGPSInfo);
+    data.latitude = legacy.latitude;
+    data.longitude = legacy.longitude;
+    data.HFSL = legacy.HFSL;
+    data.velocityNED = legacy.velocityNED;
+    data.time = legacy.time;
     //GPS details not supported.
   }
   else
   {
-    data = gps;
+    data = readCache(cache.gps);
   }
-  freeMSG();
   return data;
 }
 
@@ -262,63 +315,45 @@ DataBroadcast::getGPSInfo()
 Telemetry::RTK
 DataBroadcast::getRTKInfo()
 {
-  Telemetry::RTK data;
-  lockMSG();
-  data = rtk;
-  freeMSG();
-  return data;
+  return readCache(cache.rtk);
 }
 
 Telemetry::Mag
 DataBroadcast::getMag()
 {
-  Telemetry::Mag data;
-  lockMSG();
-  data = mag;
-  freeMSG();
-  return data;
+  return readCache(cache.mag);
 }
 
 Telemetry::RC
 DataBroadcast::getRC()
 {
-  Telemetry::RC data;
-  lockMSG();
-  data = rc;
-  freeMSG();
-  return data;
+  return readCache(cache.rc);
 }
 
 Telemetry::Gimbal
 DataBroadcast::getGimbal()
 {
-  Telemetry::Gimbal data;
-  lockMSG();
-  data = gimbal;
-  freeMSG();
-  return data;
+  return readCache(cache.gimbal);
 }
 
 Telemetry::Status
 DataBroadcast::getStatus()
 {
   Telemetry::Status data = {0};
-  lockMSG();
   if (vehicle->isLegacyM600())
   {
     // Broadcast data on M600 old firmware. Only flight status is available.
-    data.flight = legacyStatus;
+    data.flight = readCache(cache.legacyStatus);
   }
   else if(vehicle->isM100())
   {
     // Supported Broadcast data in Matrice 100
-    data.flight = legacyStatus;
+    data.flight = readCache(cache.legacyStatus);
   }
   else
   {
-    data = status;
+    data = readCache(cache.status);
   }
-  freeMSG();
   return data;
 }
 
@@ -326,43 +361,33 @@ Telemetry::Battery
 DataBroadcast::getBatteryInfo()
 {
   Telemetry::Battery data = {0};
-  lockMSG();
   if (vehicle->isLegacyM600())
   {
     // Only capacity is supported on old M600 FW
-    data.percentage = legacyBattery;
+    data.percentage = readCache(cache.legacyBattery);
   }
   else if (vehicle->isM100())
   {
     // Supported Broadcast data in Matrice 100
-    data.percentage = legacyBattery;
+    data.percentage = readCache(cache.legacyBattery);
   }
   else
   {
-    data = battery;
+    data = readCache(cache.battery);
   }
-  freeMSG();
   return data;
 }
 
 Telemetry::SDKInfo
 DataBroadcast::getSDKInfo()
 {
-  Telemetry::SDKInfo data;
-  lockMSG();
-  data = info;
-  freeMSG();
-  return data;
+  return readCache(cache.info);
 }
 
 Telemetry::Compass
 DataBroadcast::getCompassData()
 {
-    Telemetry::Compass data;
-    lockMSG();
-    data = compass;
-    freeMSG();
-    return data;
+  return readCache(cache.compass);
 }
 // clang-format on
 
@@ -424,92 +449,100 @@ DataBroadcast::setBroadcastFreq(uint8_t* dataLenIs16, int timeout)
 void
 DataBroadcast::unpackData(RecvContainer* pRecvFrame)
 {
-  uint8_t* pdata = pRecvFrame->recvData.raw_ack_array;
-  lockMSG();
-  passFlag = *(uint16_t*)pdata;
-  pdata += sizeof(uint16_t);
-  // clang-format off
-  unpackOne(FLAG_TIME        ,&timeStamp ,pdata,sizeof(timeStamp ));
-  unpackOne(FLAG_TIME        ,&syncStamp ,pdata,sizeof(syncStamp ));
-  unpackOne(FLAG_QUATERNION  ,&q         ,pdata,sizeof(q         ));
-  unpackOne(FLAG_ACCELERATION,&a         ,pdata,sizeof(a         ));
-  unpackOne(FLAG_VELOCITY    ,&v         ,pdata,sizeof(v         ));
-  unpackOne(FLAG_VELOCITY    ,&vi        ,pdata,sizeof(vi        ));
-  unpackOne(FLAG_ANGULAR_RATE,&w         ,pdata,sizeof(w         ));
-  unpackOne(FLAG_POSITION    ,&gp        ,pdata,sizeof(gp        ));
-  unpackOne(FLAG_POSITION    ,&rp        ,pdata,sizeof(rp        ));
-  unpackOne(FLAG_GPSINFO     ,&gps       ,pdata,sizeof(gps       ));
-  unpackOne(FLAG_RTKINFO     ,&rtk       ,pdata,sizeof(rtk       ));
-  unpackOne(FLAG_MAG         ,&mag       ,pdata,sizeof(mag       ));
-  unpackOne(FLAG_RC          ,&rc        ,pdata,sizeof(rc        ));
-  unpackOne(FLAG_GIMBAL      ,&gimbal    ,pdata,sizeof(gimbal    ));
-  unpackOne(FLAG_STATUS      ,&status    ,pdata,sizeof(status    ));
-  unpackOne(FLAG_BATTERY     ,&battery   ,pdata,sizeof(battery   ));
-  unpackOne(FLAG_DEVICE      ,&info      ,pdata,sizeof(info      ));
-  unpackOne(FLAG_COMPASS     ,&compass   ,pdata,sizeof(compass   ));
-  // clang-format on
-  freeMSG();
+  decode(pRecvFrame, fieldsA3, fieldsA3Count);
 }
 
 void
 DataBroadcast::unpackM100Data(RecvContainer* pRecvFrame)
 {
-  uint8_t* pdata = pRecvFrame->recvData.raw_ack_array;
-  lockMSG();
-  passFlag = *(uint16_t*)pdata;
-  pdata += sizeof(uint16_t);
-  // clang-format off
-  unpackOne(FLAG_TIME        ,&legacyTimeStamp   ,pdata,sizeof(legacyTimeStamp ));
-  unpackOne(FLAG_QUATERNION  ,&q                 ,pdata,sizeof(q               ));
-  unpackOne(FLAG_ACCELERATION,&a                 ,pdata,sizeof(a               ));
-  unpackOne(FLAG_VELOCITY    ,&legacyVelocity    ,pdata,sizeof(legacyVelocity  ));
-  unpackOne(FLAG_ANGULAR_RATE,&w                 ,pdata,sizeof(w               ));
-  unpackOne(FLAG_POSITION    ,&gp                ,pdata,sizeof(gp              ));
-  unpackOne(FLAG_M100_MAG    ,&mag               ,pdata,sizeof(mag             ));
-  unpackOne(FLAG_M100_RC     ,&rc                ,pdata,sizeof(rc              ));
-  unpackOne(FLAG_M100_GIMBAL ,&gimbal            ,pdata,sizeof(gimbal          ));
-  unpackOne(FLAG_M100_STATUS ,&legacyStatus      ,pdata,sizeof(legacyStatus    ));
-  unpackOne(FLAG_M100_BATTERY,&legacyBattery     ,pdata,sizeof(legacyBattery   ));
-  unpackOne(FLAG_M100_DEVICE ,&info              ,pdata,sizeof(info            ));
-  // clang-format on
-  freeMSG();
+  decode(pRecvFrame, fieldsM100, fieldsM100Count);
 }
 
 void
 DataBroadcast::unpackOldM600Data(RecvContainer* pRecvFrame)
 {
-  uint8_t* pdata = pRecvFrame->recvData.raw_ack_array;
-  lockMSG();
-  passFlag = *(uint16_t*)pdata;
-  pdata += sizeof(uint16_t);
-  // clang-format off
-  unpackOne(FLAG_TIME        ,&legacyTimeStamp   ,pdata,sizeof(legacyTimeStamp ));
-  unpackOne(FLAG_QUATERNION  ,&q                 ,pdata,sizeof(q               ));
-  unpackOne(FLAG_ACCELERATION,&a                 ,pdata,sizeof(a               ));
-  unpackOne(FLAG_VELOCITY    ,&legacyVelocity    ,pdata,sizeof(legacyVelocity  ));
-  unpackOne(FLAG_ANGULAR_RATE,&w                 ,pdata,sizeof(w               ));
-  unpackOne(FLAG_POSITION    ,&gp                ,pdata,sizeof(gp              ));
-  unpackOne(FLAG_GPSINFO     ,&legacyGPSInfo     ,pdata,sizeof(legacyGPSInfo   ));
-  unpackOne(FLAG_RTKINFO     ,&rtk               ,pdata,sizeof(rtk             ));
-  unpackOne(FLAG_MAG         ,&mag               ,pdata,sizeof(mag             ));
-  unpackOne(FLAG_RC          ,&rc                ,pdata,sizeof(rc              ));
-  unpackOne(FLAG_GIMBAL      ,&gimbal            ,pdata,sizeof(gimbal          ));
-  unpackOne(FLAG_STATUS      ,&legacyStatus      ,pdata,sizeof(legacyStatus    ));
-  unpackOne(FLAG_BATTERY     ,&legacyBattery     ,pdata,sizeof(legacyBattery   ));
-  unpackOne(FLAG_DEVICE      ,&info              ,pdata,sizeof(info            ));
-  // clang-format on
-  freeMSG();
+  decode(pRecvFrame, fieldsOldM600, fieldsOldM600Count);
 }
 
 void
-DataBroadcast::unpackOne(DataBroadcast::FLAG flag, void* data, uint8_t*& buf,
-                         size_t size)
+DataBroadcast::decode(RecvContainer* pRecvFrame, const FieldLayout* layout,
+                      int count)
 {
-  if (flag & passFlag)
+  const uint8_t* pdata = pRecvFrame->recvData.raw_ack_array;
+  uint16_t       flag;
+  memcpy(&flag, pdata, sizeof(flag));
+
+  lockMSG();
+  const DecodeTable* table = getDecodeTable(layout, count, flag);
+
+#if defined(__linux__)
+  uint32_t seq = cacheSeq.load(std::memory_order_relaxed);
+  cacheSeq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+#endif
+
+  uint8_t* dst   = (uint8_t*)&cache;
+  cache.passFlag = flag;
+  for (int i = 0; i < table->count; i++)
   {
-    memcpy((uint8_t*)data, (uint8_t*)buf, size);
-    buf += size;
+    memcpy(dst + table->steps[i].dst, pdata + table->steps[i].src,
+           table->steps[i].size);
   }
+
+#if defined(__linux__)
+  cacheSeq.store(seq + 2, std::memory_order_release);
+#endif
+  freeMSG();
+}
+
+const DataBroadcast::DecodeTable*
+DataBroadcast::getDecodeTable(const FieldLayout* layout, int count,
+                              uint16_t passFlag)
+{
+  for (int i = 0; i < DECODE_TABLE_CACHE; i++)
+  {
+    if (decodeTables[i].layout == layout &&
+        decodeTables[i].passFlag == passFlag)
+    {
+      return &decodeTables[i];
+    }
+  }
+
+  DecodeTable* table = &decodeTables[nextDecodeTable];
+  nextDecodeTable    = (nextDecodeTable + 1) % DECODE_TABLE_CACHE;
+
+  uint16_t src    = sizeof(uint16_t);
+  table->layout   = layout;
+  table->passFlag = passFlag;
+  table->count    = 0;
+  for (int i = 0; i < count; i++)
+  {
+    if (!(layout[i].flag & passFlag))
+    {
+      continue;
+    }
+    if (src + layout[i].size > MAX_INCOMING_DATA_SIZE)
+    {
+      /* the rest of the payload did not fit the receive buffer */
+      break;
+    }
+    if (table->count &&
+        table->steps[table->count - 1].dst +
+            table->steps[table->count - 1].size ==
+          layout[i].offset)
+    {
+      table->steps[table->count - 1].size += layout[i].size;
+    }
+    else
+    {
+      table->steps[table->count].dst  = layout[i].offset;
+      table->steps[table->count].src  = src;
+      table->steps[table->count].size = layout[i].size;
+      table->count++;
+    }
+    src += layout[i].size;
+  }
+  return table;
 }
 
 void
@@ -664,7 +697,7 @@ DataBroadcast::setUserBroadcastCallback(VehicleCallBack callback,
 uint16_t
 DataBroadcast::getPassFlag()
 {
-  return passFlag;
+  return readCache(cache.passFlag);
 }
 
 uint16_t
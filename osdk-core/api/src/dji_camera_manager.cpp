@@ -1043,6 +1043,10 @@ ErrorCode::ErrorCodeType CameraManager::startReqFileList(FileMgr::FileListReqCBT
   return ret;
 }
 
+void CameraManager::clearFileListCache() {
+  fileMgr->clearFileListCache();
+}
+
 ErrorCode::ErrorCodeType CameraManager::startReqFileData(int fileIndex, std::string localPath, FileMgr::FileDataReqCBType cb, void *userData) {
   ErrorCode::ErrorCodeType ret;
   ret = fileMgr->startReqFileData(fileIndex, localPath, cb, userData);
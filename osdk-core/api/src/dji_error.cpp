@@ -37,6 +37,8 @@
 
 using namespace DJI::OSDK;
 
+#define ERROR_TABLE_SIZE(table) (sizeof(table) / sizeof(table[0]))
+
 // clang-format off
 const uint16_t DJI::OSDK::ErrorCode::CommonACK::SUCCESS                = 0x0000;
 const uint16_t DJI::OSDK::ErrorCode::CommonACK::KEY_ERROR              = 0xFF00;
@@ -543,129 +545,121 @@ const ErrorCode::ErrorCodeType ErrorCode::WaypointV2MissionErr::ACTUATOR_PAYLOAD
 const ErrorCode::ErrorCodeType ErrorCode::WaypointV2MissionErr::ACTUATOR_PAYLOAD_EXEC_FAILED                 = ErrorCode::getErrorCode(MissionV2Module, MissionV2Common, WaypointV2ACK::WaypointV2ErrorCodeActuatorPayload::GS_ERR_CODE_ACTUATOR_PAYLOAD_EXEC_FAILED);
 
 
-const std::pair<const ErrorCode::ErrorCodeType, ErrorCode::ErrorCodeMsg> ErrorCode::WaypointV2CommonErrData[] = {
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_RESV),                               ErrorCodeMsg(module[MissionV2Module].ModuleName,   "reserved", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_INIT_WP_NUM_TOO_MANY ),              ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"min_initial_waypoint_num is large than permitted_max_waypoint_num ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_INIT_WP_NUM_TOO_FEW   ),             ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"min_initial_waypoint_num is less than permitted_min_waypoint_num ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_INIT_INVALID_END_INDEX  ),           ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"waypoint_end_index is equal or large than total_waypoint_num ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_UPLOAD_START_ID_GT_END_ID ),         ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"the start index is greater than end index of upload wps ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_UPLOAD_END_ID_GT_TOTAL_NUM ),        ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"the end index of uplod wps is greater than inited total numbers ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_DOWNLOAD_WPS_NOT_IN_STORED_RAGNE ),  ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"the index of first and end waypoint expected to download is not in range of stored in FC ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_CUR_POS_IS_FAR_AWAY_FROM_FIRST_WP ), ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"current position is far away from the first waypoint. ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_ADJ_WPS_TOO_CLOSE  ),                ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"it is too close from two adjacent waypoints","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_ADJ_WPS_TOO_FAR   ),                 ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"the distance betwween two adjacent waypoints is not in[0.5m, 5000m]","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_UPLOAD_MAX_VEL_GT_GLOBAL  ),         ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"the max vel of uplod wp is greater than global max vel ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_UPLOAD_LOCAL_CRUISE_VEL_GT_LOCAL_MAX ), ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"the local cruise vel of upload wp is greater than local max vel ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_UPLOAD_LOCAL_CRUISE_VEL_GT_GLOBAL_MAX), ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"the local cruise vel of upload wp is greater than global max vel ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_INIT_INVALID_GLOBAL_MAX_VEL   ),     ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"global_max_vel is greater than permitted_max_vel or less than permitted_min_vel ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_GLOBAL_CRUISE_VEL_GT_MAX_VEL  ),     ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"global_cruise_vel is greater than global_max_vel ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_INIT_INVALID_GOTO_FIRST_FLAG  ),     ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"goto_first_point_mode is out of range of waypoint_goto_first_flag_t_enum ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_INIT_INVALID_FINISHED_ACTION  ),     ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"finished_action is out of range of wp_plan_finish_action_t_enum ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_INIT_INVALID_RC_LOST_ACTION),        ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"rc_lost_action is out of range of wp_plan_rc_lost_action_t_enum ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_UPLOAD_YAW_MODE_INVALID),            ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"the yaw mode of upload wp is invalid. reference to waypoint2_yaw_mode_t defined in math_waypoint_planner.h ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_UPLOAD_YAW_CMD_NOT_IN_RANGE ),       ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"the yaw command of upload wp is not in range. the range for MR:[-180 180]","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_UPLOAD_YAW_TURN_DIRECTION_INVALID),  ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"the yaw turn direction of upload wp is invalid. it should be 0:clockwise or 1:anti-clockwise ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_UPLOAD_WP_TYPE_INVALID ),            ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"the wp type of upload wp is invalid. reference to waypoint_type_t defined in math_waypoint_planner.h ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_GO_STOP_CMD_INVALID ),               ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"go/stop command is invalid. ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_INVALID_PAUSE_RECOVERY_CMD),         ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"the command of pause/recovery is not equal to any of the command enum ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_INVALID_BREAK_RESTORE_CMD ),         ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"the command of break/restore is not equal to any of the command enum ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_INIT_INVALID_REF_POINT ),            ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"initial reference point position coordinate exceed set range ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_UPLOAD_CANNT_SET_WP_LINE_EXIT_TYPE), ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"cann't set wp_line_exit type to wp ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_DAMPING_DIS_GE_DIS_OF_ADJ_POINTS ),  ErrorCodeMsg(module[MissionV2Module].ModuleName, 	 "the damping dis is greater than or equal the distance of adjacent point ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_INIT_INFO_NOT_UPLOADED ),            ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"the init info of Ground Station is not uploaded yet ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_WP_HAS_NOT_UPLOADED ),               ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"the wp has not uploaded yet ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_UPLOADED_WP_NOT_ENOUGH ),            ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"min_initial_waypoint_num is not uploaded. ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_GS_HAS_STARTED ),                    ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"waypoint plan has started when received go command. ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_GS_NOT_RUNNING ),                    ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"waypoint plan not running when received stop command. ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_GS_NOT_RUNNING_FOR_PAUSE_RECOVERY),  ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"ground station(GS) is not started(used by pause/recovery) ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_GS_NOT_RUNNING_FOR_BREAK_RESTORE),   ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"ground station(GS) is not started(used by break/restore) ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_NOT_IN_WP_MIS  ),                    ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"not in the waypoint mission(MIS)(cannot pause/recovery or break/restore) ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_MIS_HAS_BEEN_PAUSED ),               ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"the current status is paused","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_MIS_NOT_PAUSED ),                    ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"not in paused status","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_MIS_HAS_BEEN_BROKEN ),               ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"the current status is broken","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_MIS_NOT_BROKEN ),                    ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"not in break status","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_PAUSE_RECOVERY_NOT_SUPPORTED),       ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"the configuration forbid using pause/recovery API ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_BREAK_RESTORE_NOT_SUPPORTED ),       ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"the configuration forbid using break/restore API ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_NO_BREAK_POINT  ),                   ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"no break point is recorded for restore ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_NO_CUR_TRAJ_PROJECT ),               ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"no current trajectory project point is recorded for restore ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_NO_NXT_TRAJ_PROJECT ),               ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"no next trajectory project point is recorded for restore ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_NO_NNT_TRAJ_PROJECT ),               ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"no next the next trajectory project point is recorded for restore ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_UPLOAD_WP_ID_NOT_CONTINUE ),         ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"the index of upload wp is not continue after the store wp ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_WP_LINE_ENTER_NOT_SET_TO_START_WP ), ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"the WP_LINE_ENTER wp_type set to a wp which is not the init start waypoint ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_INIT_WP_WHEN_PLAN_HAS_STARTED  ),    ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"the waypoint plan has started when initializing waypoint ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_DAMPING_DIS_EXCEED_RANGE ),          ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"waypoint damping distance exceed set range ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_WAYPOINT_COOR_EXCEED_RANGE ),        ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"waypoint position coordinate exceed rational range ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_FIRST_WP_TYPE_IS_WP_TURN_NO),        ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"first waypoint type error","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_WP_EXCEED_RADIUS_LIMIT  ),           ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"waypoint position exceed radius limit ","none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_WP_EXCEED_HEIGHT_LIMIT  ),           ErrorCodeMsg(module[MissionV2Module].ModuleName, 	"waypoint position exceed height limit ","none")),
-
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::COMMON_SUCCESS                            ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "				", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::COMMON_INVALID_DATA_LENGTH                ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "the length of the data is illegal based on the protocol ", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::COMMON_INVALD_FLOAT_NUM                   ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "invalid float number (NAN or INF) ", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRAJ_WP_VERSION_NO_MATCH                  ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "waypoint mission version can't match with firmware			", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::COMMON_UNKNOWN                            ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "Fatal error	 Unexpected result	 	", "none")),
-
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::STATUS_RESV                               ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "				", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::STATUS_WP_MIS_CHECK_FAIL                  ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "head_node is null or atti_not_healthy or gyro_not_healthy or horiz_vel_not healthy or horiz_abs_pos_not_healthy. ", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::STATUS_HOME_NOT_RECORDED                  ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "the home point is no recorded yet	 which will be executed at the first time of GPS level > 3(MR	FW). 	", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::STATUS_LOW_LOCATION_ACCURACY              ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "current location accuracy is low for bad GPS signal. ", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::STATUS_RTK_CONDITION_IS_NOT_READY         ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "use rtk_data	 but rtk is not connected or rtk_data is invalid 		", "none")),
-
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::SECURE_RESV                               ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "				", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::SECURE_CROSS_NFZ                          ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "the trajectory cross the NFZ ", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::SECURE_BAT_LOW                            ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "current capacity of smart battery or voltage of non-smart battery is lower than level 1 or level 2 threshold ", "none")),
-
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTION_COMMON_RESV                           ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "				", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTION_COMMON_ACTION_ID_DUPLICATED           ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "the ID of Action is duplicated. ", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTION_COMMON_ACTION_ITEMS_SPACE_NOT_ENOUGH  ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "there is no enough memory space for new Action Item ", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTION_COMMON_ACTION_SIZE_GT_BUF_SIZE        ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "the size of buffer used to get the info of Action is less than the size of Action. Normally users can not get this. ", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTION_COMMON_ACTION_ID_NOT_FOUND            ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "the ID of Action is not found. ", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTION_COMMON_DOWNLOAD_ACTION_ID_RANGE_ERROR ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "the download action start id is bigger than the action end id ", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTION_COMMON_NO_ACTION_ITEMS_STORED         ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "can not download or get min-max action ID for no action items stored in action kernel ", "none")),
-
-
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRIGGER_RESV                                     ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "				", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRIGGER_TYPE_INVALID                             ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "the type ID of Trigger is invalid. It might not defined or the information is empty. ", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRIGGER_REACH_WP_END_INDEX_LT_START_INDEX        ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "wp_end_index is less than wp_start_index in reach_waypoint_trigger. ", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRIGGER_REACH_WP_INVALID_INTERVAL_WP_NUM         ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "interval_wp_num is large than the difference of wp_start_index and wp_end_index in reach_waypoint_trigger. ", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRIGGER_REACH_WP_INVALID_AUTO_TERMINATE_WP_NUM 	), ErrorCodeMsg(module[MissionV2Module].ModuleName, "auto_terminate_wp_num is large than interval_wp_num in reach_waypoint_trigger. ", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRIGGER_ASSOCIATE_INVALID_TYPE                   ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "the associate_type is greater than the maximum value. ", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::TRIGGER_SIMPLE_INTERVAL_INVALID_TYPE             ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "the interval type is greater than the maximum value. ", "none")),
-
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTUATOR_COMMON_RESV                             ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "				", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTUATOR_COMMON_ACTUATOR_EXEC_NON_SUPPORTED      ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "the execution of Actuator is not supported	 e.g.	 try to stop camera shooting. 	", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTUATOR_COMMON_ACTUATOR_TYPE_INVALID            ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "the type ID of Actuator is invalid. It might not defined or the information is empty. ", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTUATOR_COMMON_ACTUATOR_FUNC_INVALID            ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "the Function ID of Actuator is invalid. It might not defined or the information is empty. ", "none")),
-
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTUATOR_CAMERA_RESV                               ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "				", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTUATOR_CAMERA_SEND_SINGLE_SHOT_CMD_TO_CAMERA_FAIL), ErrorCodeMsg(module[MissionV2Module].ModuleName, "fail to send shot cmd to camera for no camera or camera is busy. ", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTUATOR_CAMERA_SEND_VIDEO_START_CMD_TO_CAMERA_FAIL), ErrorCodeMsg(module[MissionV2Module].ModuleName, "fail to send video start cmd to camera for no camera or camera is busy. ", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTUATOR_CAMERA_SEND_VIDEO_STOP_CMD_TO_CAMERA_FAIL  ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "fail to send video stop cmd to camera for no camera or camera is not busy. ", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTUATOR_CAMERA_FOCUS_PARAM_XY_INVALID              ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "camera focus param xy exceed valid range (0	 1). 		", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTUATOR_CAMERA_SEND_FOCUS_CMD_TO_CAMERA_FAIL       ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "fail to send focus cmd to camera for no camera or camera is busy. ", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTUATOR_CAMERA_SEND_FOCALIZE_CMD_TO_CAMERA_FAIL    ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "fail to send focalize cmd to camera for no camera or camera is busy. ", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTUATOR_CAMERA_FOCAL_DISTANCE_INVALID              ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "focal distance of camera focalize function exceed valid range. ", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTUATOR_CAMERA_EXEC_FAIL                           ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "this err code indicate camera fail to exec coressponding cmd	 and the low 8 bit", "none")),
-
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTUATOR_GIMBAL_RESV                           ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "				", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTUATOR_GIMBAL_INVALID_RPY_ANGLE_CTRL_CMD     ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "gimbal roll	pitch	yaw angle ctrl cmd param invalid	", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTUATOR_GIMBAL_INVALID_DURATION_CMD           ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "gimbal duration param invalid	 unable to exec. 		", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTUATOR_GIMBAL_FAIL_TO_ARRIVE_TGT_ANGLE       ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "gimbal fail to arrive target angle . ", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTUATOR_GIMBAL_FAIL_TO_SEND_CMD_TO_GIMBAL     ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "fail to send cmd to gimbal for gimbal is busy or no gimbal. ", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTUATOR_GIMBAL_THIS_INDEX_OF_GIMBAL_NOT_DOING_UNIFORM_CTRL 	), ErrorCodeMsg(module[MissionV2Module].ModuleName, "fail to stop gimbal uniform ctrl because index error.			", "none")),
-
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTUATOR_FLIGHT_RESV                           ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "				", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTUATOR_FLIGHT_YAW_INVALID_YAW_ANGLE          ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "yaw angle is lager max yaw angle. ", "none")),
-  std::make_pair(getRawRetCode(WaypointV2MissionErr::ACTUATOR_FLIGHT_YAW_TO_TGT_ANGLE_TIMEOUT       ), ErrorCodeMsg(module[MissionV2Module].ModuleName, "faile to target yaw angle	 because of timeout.		", "none")),
-  };
-
-const ErrorCode::ErrorCodeMapType ErrorCode::getWaypointV2CommonErrorMap() {
-  const ErrorCodeMapType WaypointV2CommonErrorMap(WaypointV2CommonErrData,
-                                              WaypointV2CommonErrData
-                                              + sizeof WaypointV2CommonErrData
-                                                / sizeof WaypointV2CommonErrData[0]);
-  return WaypointV2CommonErrorMap;
-}
+const ErrorCode::ErrorCodeEntry ErrorCode::WaypointV2CommonErrData[] = {
+  {getRawRetCode(WaypointV2MissionErr::COMMON_SUCCESS),                                              "				", "none"},
+  {getRawRetCode(WaypointV2MissionErr::COMMON_INVALID_DATA_LENGTH),                                  "the length of the data is illegal based on the protocol ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::COMMON_INVALD_FLOAT_NUM),                                     "invalid float number (NAN or INF) ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_WP_VERSION_NO_MATCH),                                    "waypoint mission version can't match with firmware			", "none"},
+  {getRawRetCode(WaypointV2MissionErr::COMMON_UNKNOWN),                                              "Fatal error	 Unexpected result	 	", "none"},
+
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_RESV),                                                   "reserved", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_INIT_WP_NUM_TOO_MANY),                                   "min_initial_waypoint_num is large than permitted_max_waypoint_num ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_INIT_WP_NUM_TOO_FEW),                                    "min_initial_waypoint_num is less than permitted_min_waypoint_num ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_INIT_INVALID_END_INDEX),                                 "waypoint_end_index is equal or large than total_waypoint_num ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_UPLOAD_START_ID_GT_END_ID),                              "the start index is greater than end index of upload wps ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_UPLOAD_END_ID_GT_TOTAL_NUM),                             "the end index of uplod wps is greater than inited total numbers ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_DOWNLOAD_WPS_NOT_IN_STORED_RAGNE),                       "the index of first and end waypoint expected to download is not in range of stored in FC ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_CUR_POS_IS_FAR_AWAY_FROM_FIRST_WP),                      "current position is far away from the first waypoint. ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_ADJ_WPS_TOO_CLOSE),                                      "it is too close from two adjacent waypoints", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_ADJ_WPS_TOO_FAR),                                        "the distance betwween two adjacent waypoints is not in[0.5m, 5000m]", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_UPLOAD_MAX_VEL_GT_GLOBAL),                               "the max vel of uplod wp is greater than global max vel ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_UPLOAD_LOCAL_CRUISE_VEL_GT_LOCAL_MAX),                   "the local cruise vel of upload wp is greater than local max vel ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_UPLOAD_LOCAL_CRUISE_VEL_GT_GLOBAL_MAX),                  "the local cruise vel of upload wp is greater than global max vel ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_INIT_INVALID_GLOBAL_MAX_VEL),                            "global_max_vel is greater than permitted_max_vel or less than permitted_min_vel ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_GLOBAL_CRUISE_VEL_GT_MAX_VEL),                           "global_cruise_vel is greater than global_max_vel ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_INIT_INVALID_GOTO_FIRST_FLAG),                           "goto_first_point_mode is out of range of waypoint_goto_first_flag_t_enum ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_INIT_INVALID_FINISHED_ACTION),                           "finished_action is out of range of wp_plan_finish_action_t_enum ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_INIT_INVALID_RC_LOST_ACTION),                            "rc_lost_action is out of range of wp_plan_rc_lost_action_t_enum ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_UPLOAD_YAW_MODE_INVALID),                                "the yaw mode of upload wp is invalid. reference to waypoint2_yaw_mode_t defined in math_waypoint_planner.h ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_UPLOAD_YAW_CMD_NOT_IN_RANGE),                            "the yaw command of upload wp is not in range. the range for MR:[-180 180]", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_UPLOAD_YAW_TURN_DIRECTION_INVALID),                      "the yaw turn direction of upload wp is invalid. it should be 0:clockwise or 1:anti-clockwise ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_UPLOAD_WP_TYPE_INVALID),                                 "the wp type of upload wp is invalid. reference to waypoint_type_t defined in math_waypoint_planner.h ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_GO_STOP_CMD_INVALID),                                    "go/stop command is invalid. ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_INVALID_PAUSE_RECOVERY_CMD),                             "the command of pause/recovery is not equal to any of the command enum ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_INVALID_BREAK_RESTORE_CMD),                              "the command of break/restore is not equal to any of the command enum ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_INIT_INVALID_REF_POINT),                                 "initial reference point position coordinate exceed set range ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_DAMPING_DIS_GE_DIS_OF_ADJ_POINTS),                       "the damping dis is greater than or equal the distance of adjacent point ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_UPLOAD_CANNT_SET_WP_LINE_EXIT_TYPE),                     "cann't set wp_line_exit type to wp ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_INIT_INFO_NOT_UPLOADED),                                 "the init info of Ground Station is not uploaded yet ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_WP_HAS_NOT_UPLOADED),                                    "the wp has not uploaded yet ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_UPLOADED_WP_NOT_ENOUGH),                                 "min_initial_waypoint_num is not uploaded. ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_GS_HAS_STARTED),                                         "waypoint plan has started when received go command. ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_GS_NOT_RUNNING),                                         "waypoint plan not running when received stop command. ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_GS_NOT_RUNNING_FOR_PAUSE_RECOVERY),                      "ground station(GS) is not started(used by pause/recovery) ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_GS_NOT_RUNNING_FOR_BREAK_RESTORE),                       "ground station(GS) is not started(used by break/restore) ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_NOT_IN_WP_MIS),                                          "not in the waypoint mission(MIS)(cannot pause/recovery or break/restore) ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_MIS_HAS_BEEN_PAUSED),                                    "the current status is paused", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_MIS_NOT_PAUSED),                                         "not in paused status", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_MIS_HAS_BEEN_BROKEN),                                    "the current status is broken", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_MIS_NOT_BROKEN),                                         "not in break status", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_PAUSE_RECOVERY_NOT_SUPPORTED),                           "the configuration forbid using pause/recovery API ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_BREAK_RESTORE_NOT_SUPPORTED),                            "the configuration forbid using break/restore API ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_NO_BREAK_POINT),                                         "no break point is recorded for restore ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_NO_CUR_TRAJ_PROJECT),                                    "no current trajectory project point is recorded for restore ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_NO_NXT_TRAJ_PROJECT),                                    "no next trajectory project point is recorded for restore ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_NO_NNT_TRAJ_PROJECT),                                    "no next the next trajectory project point is recorded for restore ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_UPLOAD_WP_ID_NOT_CONTINUE),                              "the index of upload wp is not continue after the store wp ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_WP_LINE_ENTER_NOT_SET_TO_START_WP),                      "the WP_LINE_ENTER wp_type set to a wp which is not the init start waypoint ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_INIT_WP_WHEN_PLAN_HAS_STARTED),                          "the waypoint plan has started when initializing waypoint ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_DAMPING_DIS_EXCEED_RANGE),                               "waypoint damping distance exceed set range ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_WAYPOINT_COOR_EXCEED_RANGE),                             "waypoint position coordinate exceed rational range ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_FIRST_WP_TYPE_IS_WP_TURN_NO),                            "first waypoint type error", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_WP_EXCEED_RADIUS_LIMIT),                                 "waypoint position exceed radius limit ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRAJ_WP_EXCEED_HEIGHT_LIMIT),                                 "waypoint position exceed height limit ", "none"},
+
+  {getRawRetCode(WaypointV2MissionErr::STATUS_RESV),                                                 "				", "none"},
+  {getRawRetCode(WaypointV2MissionErr::STATUS_WP_MIS_CHECK_FAIL),                                    "head_node is null or atti_not_healthy or gyro_not_healthy or horiz_vel_not healthy or horiz_abs_pos_not_healthy. ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::STATUS_HOME_NOT_RECORDED),                                    "the home point is no recorded yet	 which will be executed at the first time of GPS level > 3(MR	FW). 	", "none"},
+  {getRawRetCode(WaypointV2MissionErr::STATUS_LOW_LOCATION_ACCURACY),                                "current location accuracy is low for bad GPS signal. ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::STATUS_RTK_CONDITION_IS_NOT_READY),                           "use rtk_data	 but rtk is not connected or rtk_data is invalid 		", "none"},
+
+  {getRawRetCode(WaypointV2MissionErr::SECURE_RESV),                                                 "				", "none"},
+  {getRawRetCode(WaypointV2MissionErr::SECURE_CROSS_NFZ),                                            "the trajectory cross the NFZ ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::SECURE_BAT_LOW),                                              "current capacity of smart battery or voltage of non-smart battery is lower than level 1 or level 2 threshold ", "none"},
+
+  {getRawRetCode(WaypointV2MissionErr::ACTION_COMMON_RESV),                                          "				", "none"},
+  {getRawRetCode(WaypointV2MissionErr::ACTION_COMMON_ACTION_ID_DUPLICATED),                          "the ID of Action is duplicated. ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::ACTION_COMMON_ACTION_ITEMS_SPACE_NOT_ENOUGH),                 "there is no enough memory space for new Action Item ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::ACTION_COMMON_ACTION_SIZE_GT_BUF_SIZE),                       "the size of buffer used to get the info of Action is less than the size of Action. Normally users can not get this. ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::ACTION_COMMON_ACTION_ID_NOT_FOUND),                           "the ID of Action is not found. ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::ACTION_COMMON_DOWNLOAD_ACTION_ID_RANGE_ERROR),                "the download action start id is bigger than the action end id ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::ACTION_COMMON_NO_ACTION_ITEMS_STORED),                        "can not download or get min-max action ID for no action items stored in action kernel ", "none"},
+
+  {getRawRetCode(WaypointV2MissionErr::TRIGGER_RESV),                                                "				", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRIGGER_TYPE_INVALID),                                        "the type ID of Trigger is invalid. It might not defined or the information is empty. ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRIGGER_REACH_WP_END_INDEX_LT_START_INDEX),                   "wp_end_index is less than wp_start_index in reach_waypoint_trigger. ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRIGGER_REACH_WP_INVALID_INTERVAL_WP_NUM),                    "interval_wp_num is large than the difference of wp_start_index and wp_end_index in reach_waypoint_trigger. ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRIGGER_REACH_WP_INVALID_AUTO_TERMINATE_WP_NUM),              "auto_terminate_wp_num is large than interval_wp_num in reach_waypoint_trigger. ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRIGGER_ASSOCIATE_INVALID_TYPE),                              "the associate_type is greater than the maximum value. ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::TRIGGER_SIMPLE_INTERVAL_INVALID_TYPE),                        "the interval type is greater than the maximum value. ", "none"},
+
+  {getRawRetCode(WaypointV2MissionErr::ACTUATOR_COMMON_RESV),                                        "				", "none"},
+  {getRawRetCode(WaypointV2MissionErr::ACTUATOR_COMMON_ACTUATOR_EXEC_NON_SUPPORTED),                 "the execution of Actuator is not supported	 e.g.	 try to stop camera shooting. 	", "none"},
+  {getRawRetCode(WaypointV2MissionErr::ACTUATOR_COMMON_ACTUATOR_TYPE_INVALID),                       "the type ID of Actuator is invalid. It might not defined or the information is empty. ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::ACTUATOR_COMMON_ACTUATOR_FUNC_INVALID),                       "the Function ID of Actuator is invalid. It might not defined or the information is empty. ", "none"},
+
+  {getRawRetCode(WaypointV2MissionErr::ACTUATOR_CAMERA_RESV),                                        "				", "none"},
+  {getRawRetCode(WaypointV2MissionErr::ACTUATOR_CAMERA_SEND_SINGLE_SHOT_CMD_TO_CAMERA_FAIL),         "fail to send shot cmd to camera for no camera or camera is busy. ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::ACTUATOR_CAMERA_SEND_VIDEO_START_CMD_TO_CAMERA_FAIL),         "fail to send video start cmd to camera for no camera or camera is busy. ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::ACTUATOR_CAMERA_SEND_VIDEO_STOP_CMD_TO_CAMERA_FAIL),          "fail to send video stop cmd to camera for no camera or camera is not busy. ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::ACTUATOR_CAMERA_FOCUS_PARAM_XY_INVALID),                      "camera focus param xy exceed valid range (0	 1). 		", "none"},
+  {getRawRetCode(WaypointV2MissionErr::ACTUATOR_CAMERA_SEND_FOCUS_CMD_TO_CAMERA_FAIL),               "fail to send focus cmd to camera for no camera or camera is busy. ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::ACTUATOR_CAMERA_SEND_FOCALIZE_CMD_TO_CAMERA_FAIL),            "fail to send focalize cmd to camera for no camera or camera is busy. ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::ACTUATOR_CAMERA_FOCAL_DISTANCE_INVALID),                      "focal distance of camera focalize function exceed valid range. ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::ACTUATOR_CAMERA_EXEC_FAIL),                                   "this err code indicate camera fail to exec coressponding cmd	 and the low 8 bit", "none"},
+
+  {getRawRetCode(WaypointV2MissionErr::ACTUATOR_GIMBAL_RESV),                                        "				", "none"},
+  {getRawRetCode(WaypointV2MissionErr::ACTUATOR_GIMBAL_INVALID_RPY_ANGLE_CTRL_CMD),                  "gimbal roll	pitch	yaw angle ctrl cmd param invalid	", "none"},
+  {getRawRetCode(WaypointV2MissionErr::ACTUATOR_GIMBAL_INVALID_DURATION_CMD),                        "gimbal duration param invalid	 unable to exec. 		", "none"},
+  {getRawRetCode(WaypointV2MissionErr::ACTUATOR_GIMBAL_FAIL_TO_ARRIVE_TGT_ANGLE),                    "gimbal fail to arrive target angle . ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::ACTUATOR_GIMBAL_FAIL_TO_SEND_CMD_TO_GIMBAL),                  "fail to send cmd to gimbal for gimbal is busy or no gimbal. ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::ACTUATOR_GIMBAL_THIS_INDEX_OF_GIMBAL_NOT_DOING_UNIFORM_CTRL), "fail to stop gimbal uniform ctrl because index error.			", "none"},
+
+  {getRawRetCode(WaypointV2MissionErr::ACTUATOR_FLIGHT_RESV),                                        "				", "none"},
+  {getRawRetCode(WaypointV2MissionErr::ACTUATOR_FLIGHT_YAW_INVALID_YAW_ANGLE),                       "yaw angle is lager max yaw angle. ", "none"},
+  {getRawRetCode(WaypointV2MissionErr::ACTUATOR_FLIGHT_YAW_TO_TGT_ANGLE_TIMEOUT),                    "faile to target yaw angle	 because of timeout.		", "none"},
+};
+
 /*! system releated error code */
 const ErrorCode::ErrorCodeType ErrorCode::SysCommonErr::Success              = ErrorCode::getErrorCode(SysModule, SystemCommon, SYSTEM_ERROR_RAW_CODE::Success);
 const ErrorCode::ErrorCodeType ErrorCode::SysCommonErr::AllocMemoryFailed    = ErrorCode::getErrorCode(SysModule, SystemCommon, SYSTEM_ERROR_RAW_CODE::AllocMemoryFailed);
@@ -676,251 +670,240 @@ const ErrorCode::ErrorCodeType ErrorCode::SysCommonErr::InstInitParamInvalid = E
 const ErrorCode::ErrorCodeType ErrorCode::SysCommonErr::UserCallbackInvalid  = ErrorCode::getErrorCode(SysModule, SystemCommon, SYSTEM_ERROR_RAW_CODE::UserCallbackInvalid);
 const ErrorCode::ErrorCodeType ErrorCode::SysCommonErr::UndefinedError       = ErrorCode::getErrorCode(SysModule, SystemCommon, SYSTEM_ERROR_RAW_CODE::UndefinedError);
 
-const std::pair<const ErrorCode::ErrorCodeType, ErrorCode::ErrorCodeMsg> ErrorCode::CameraCommonErrData[] = {
-    std::make_pair(getRawRetCode(CameraCommonErr::InvalidCMD),
-                   ErrorCodeMsg(module[CameraModule].ModuleName, "Command not supported", "Check the firmware or command validity")),
-    std::make_pair(getRawRetCode(CameraCommonErr::Timeout),
-                   ErrorCodeMsg(module[CameraModule].ModuleName, "Camera's execution of this action has timed out", "Try again or check the firmware or command")),
-    std::make_pair(getRawRetCode(CameraCommonErr::OutOfMemory),
-                   ErrorCodeMsg(module[CameraModule].ModuleName, "Camera's execution of this action is out of memory", "Please contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(CameraCommonErr::InvalidParam),
-                   ErrorCodeMsg(module[CameraModule].ModuleName, "Camera received invalid parameters", "Check the validity of the parameter")),
-    std::make_pair(getRawRetCode(CameraCommonErr::InvalidState),
-                   ErrorCodeMsg(module[CameraModule].ModuleName, "Camera is busy or the command is not supported in the Camera's current state", "Check current camera state is if appropriate fot the CMD")),
-    std::make_pair(getRawRetCode(CameraCommonErr::TimeNotSync),
-                   ErrorCodeMsg(module[CameraModule].ModuleName, "The time stamp of the camera is not sync", "Please contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(CameraCommonErr::ParamSetFailed),
-                   ErrorCodeMsg(module[CameraModule].ModuleName, "Camera failed to set the parameters it received", "Please check the parameter to set is if supported in your devices.")),
-    std::make_pair(getRawRetCode(CameraCommonErr::ParamGetFailed),
-                   ErrorCodeMsg(module[CameraModule].ModuleName, "Camera param get failed", "Please check the parameter to get is if supported in your devices.")),
-    std::make_pair(getRawRetCode(CameraCommonErr::SDCardMISSING),
-                   ErrorCodeMsg(module[CameraModule].ModuleName, "Camera has no SD Card", "Please install SD card.")),
-    std::make_pair(getRawRetCode(CameraCommonErr::SDCardFull),
-                   ErrorCodeMsg(module[CameraModule].ModuleName, "The Camera's SD Card is full", "Please make sure the SD card has enough space.")),
-    std::make_pair(getRawRetCode(CameraCommonErr::SDCardError),
-                   ErrorCodeMsg(module[CameraModule].ModuleName, "Error accessing the SD Card", "Please check the validity of the SD card.")),
-    std::make_pair(getRawRetCode(CameraCommonErr::SensorError),
-                   ErrorCodeMsg(module[CameraModule].ModuleName, "Camera sensor error", "Please contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(CameraCommonErr::SystemError),
-                   ErrorCodeMsg(module[CameraModule].ModuleName, "Camera system error", "Please recheck all the running conditions or contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(CameraCommonErr::ParamLenTooLong),
-                   ErrorCodeMsg(module[CameraModule].ModuleName, "Camera param get failed", "Please check the validity of the parameter length")),
-    std::make_pair(getRawRetCode(CameraCommonErr::ModuleInactivated),
-                   ErrorCodeMsg(module[CameraModule].ModuleName, "Camera module is not activated", "Please activate the module first.")),
-    std::make_pair(getRawRetCode(CameraCommonErr::FWSeqNumNotInOrder),
-                   ErrorCodeMsg(module[CameraModule].ModuleName, "The seq number of Firmware data is invalid", "Please contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(CameraCommonErr::FWCheckErr),
-                   ErrorCodeMsg(module[CameraModule].ModuleName, "Firmware check error", "Please contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(CameraCommonErr::FlashWriteError),
-                   ErrorCodeMsg(module[CameraModule].ModuleName, "Camera flash write error", "Please contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(CameraCommonErr::FWInvalidType),
-                   ErrorCodeMsg(module[CameraModule].ModuleName, "Firmware type is invalid", "Please contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(CameraCommonErr::RCDisconnect),
-                   ErrorCodeMsg(module[CameraModule].ModuleName, "Remote Control is disconnected now", "Please check the connection with remote control is if OK.")),
-    std::make_pair(getRawRetCode(CameraCommonErr::HardwareErr),
-                   ErrorCodeMsg(module[CameraModule].ModuleName, "Camera hardware error", "Please contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(CameraCommonErr::UAVDisconnect),
-                   ErrorCodeMsg(module[CameraModule].ModuleName, "Disconnect with aircraft", "Please check the connection with aircraft is if OK.")),
-    std::make_pair(getRawRetCode(CameraCommonErr::UpgradeErrorNow),
-                   ErrorCodeMsg(module[CameraModule].ModuleName, "Camera cannot not upgrade in current status", "Please contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(CameraCommonErr::UndefineError),
-                   ErrorCodeMsg(module[CameraModule].ModuleName, "Undefined error", "Please contact <dev@dji.com> for help.")),
+const ErrorCode::ErrorCodeEntry ErrorCode::CameraCommonErrData[] = {
+    {getRawRetCode(CameraCommonErr::InvalidCMD),
+     "Command not supported", "Check the firmware or command validity"},
+    {getRawRetCode(CameraCommonErr::Timeout),
+     "Camera's execution of this action has timed out", "Try again or check the firmware or command"},
+    {getRawRetCode(CameraCommonErr::OutOfMemory),
+     "Camera's execution of this action is out of memory", "Please contact <dev@dji.com> for help."},
+    {getRawRetCode(CameraCommonErr::InvalidParam),
+     "Camera received invalid parameters", "Check the validity of the parameter"},
+    {getRawRetCode(CameraCommonErr::InvalidState),
+     "Camera is busy or the command is not supported in the Camera's current state", "Check current camera state is if appropriate fot the CMD"},
+    {getRawRetCode(CameraCommonErr::TimeNotSync),
+     "The time stamp of the camera is not sync", "Please contact <dev@dji.com> for help."},
+    {getRawRetCode(CameraCommonErr::ParamSetFailed),
+     "Camera failed to set the parameters it received", "Please check the parameter to set is if supported in your devices."},
+    {getRawRetCode(CameraCommonErr::ParamGetFailed),
+     "Camera param get failed", "Please check the parameter to get is if supported in your devices."},
+    {getRawRetCode(CameraCommonErr::SDCardMISSING),
+     "Camera has no SD Card", "Please install SD card."},
+    {getRawRetCode(CameraCommonErr::SDCardFull),
+     "The Camera's SD Card is full", "Please make sure the SD card has enough space."},
+    {getRawRetCode(CameraCommonErr::SDCardError),
+     "Error accessing the SD Card", "Please check the validity of the SD card."},
+    {getRawRetCode(CameraCommonErr::SensorError),
+     "Camera sensor error", "Please contact <dev@dji.com> for help."},
+    {getRawRetCode(CameraCommonErr::SystemError),
+     "Camera system error", "Please recheck all the running conditions or contact <dev@dji.com> for help."},
+    {getRawRetCode(CameraCommonErr::ParamLenTooLong),
+     "Camera param get failed", "Please check the validity of the parameter length"},
+    {getRawRetCode(CameraCommonErr::ModuleInactivated),
+     "Camera module is not activated", "Please activate the module first."},
+    {getRawRetCode(CameraCommonErr::FWSeqNumNotInOrder),
+     "The seq number of Firmware data is invalid", "Please contact <dev@dji.com> for help."},
+    {getRawRetCode(CameraCommonErr::FWCheckErr),
+     "Firmware check error", "Please contact <dev@dji.com> for help."},
+    {getRawRetCode(CameraCommonErr::FlashWriteError),
+     "Camera flash write error", "Please contact <dev@dji.com> for help."},
+    {getRawRetCode(CameraCommonErr::FWInvalidType),
+     "Firmware type is invalid", "Please contact <dev@dji.com> for help."},
+    {getRawRetCode(CameraCommonErr::RCDisconnect),
+     "Remote Control is disconnected now", "Please check the connection with remote control is if OK."},
+    {getRawRetCode(CameraCommonErr::HardwareErr),
+     "Camera hardware error", "Please contact <dev@dji.com> for help."},
+    {getRawRetCode(CameraCommonErr::UAVDisconnect),
+     "Disconnect with aircraft", "Please check the connection with aircraft is if OK."},
+    {getRawRetCode(CameraCommonErr::UpgradeErrorNow),
+     "Camera cannot not upgrade in current status", "Please contact <dev@dji.com> for help."},
+    {getRawRetCode(CameraCommonErr::UndefineError),
+     "Undefined error", "Please contact <dev@dji.com> for help."},
 };
 
-const ErrorCode::ErrorCodeMapType ErrorCode::getCameraCommonErrorMap() {
-  const ErrorCodeMapType CameraCommonErrorMap(CameraCommonErrData,
-                                              CameraCommonErrData
-                                                + sizeof CameraCommonErrData
-                                                  / sizeof CameraCommonErrData[0]);
-  return CameraCommonErrorMap;
-}
 
 
-const std::pair<const ErrorCode::ErrorCodeType, ErrorCode::ErrorCodeMsg> ErrorCode::GimbalCommonErrData[] = {
-    std::make_pair(getRawRetCode(GimbalCommonErr::InvalidCMD),
-                   ErrorCodeMsg(module[GimbalModule].ModuleName, "Command not supported", "Check the firmware or command validity")),
-    std::make_pair(getRawRetCode(GimbalCommonErr::Timeout),
-                   ErrorCodeMsg(module[GimbalModule].ModuleName, "Gimbal's execution of this action has timed out", "Try again or check the firmware or command")),
-    std::make_pair(getRawRetCode(GimbalCommonErr::OutOfMemory),
-                   ErrorCodeMsg(module[GimbalModule].ModuleName, "Gimbal's execution of this action is out of memory", "Please contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(GimbalCommonErr::InvalidParam),
-                   ErrorCodeMsg(module[GimbalModule].ModuleName, "Gimbal received invalid parameters", "Check the validity of the parameter")),
-    std::make_pair(getRawRetCode(GimbalCommonErr::InvalidState),
-                   ErrorCodeMsg(module[GimbalModule].ModuleName, "Gimbal is busy or the command is not supported in the Gimbal's current state", "Check current Gimbal state is if appropriate fot the CMD")),
-    std::make_pair(getRawRetCode(GimbalCommonErr::TimeNotSync),
-                   ErrorCodeMsg(module[GimbalModule].ModuleName, "The time stamp of the Gimbal is not sync", "Please contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(GimbalCommonErr::ParamSetFailed),
-                   ErrorCodeMsg(module[GimbalModule].ModuleName, "Gimbal failed to set the parameters it received", "Please check the parameter to set is if supported in your devices.")),
-    std::make_pair(getRawRetCode(GimbalCommonErr::ParamGetFailed),
-                   ErrorCodeMsg(module[GimbalModule].ModuleName, "Gimbal param get failed", "Please check the parameter to get is if supported in your devices.")),
-    std::make_pair(getRawRetCode(GimbalCommonErr::SDCardMISSING),
-                   ErrorCodeMsg(module[GimbalModule].ModuleName, "Gimbal has no SD Card", "Please install SD card.")),
-    std::make_pair(getRawRetCode(GimbalCommonErr::SDCardFull),
-                   ErrorCodeMsg(module[GimbalModule].ModuleName, "The Gimbal's SD Card is full", "Please make sure the SD card has enough space.")),
-    std::make_pair(getRawRetCode(GimbalCommonErr::SDCardError),
-                   ErrorCodeMsg(module[GimbalModule].ModuleName, "Error accessing the SD Card", "Please check the validity of the SD card.")),
-    std::make_pair(getRawRetCode(GimbalCommonErr::SensorError),
-                   ErrorCodeMsg(module[GimbalModule].ModuleName, "Gimbal sensor error", "Please contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(GimbalCommonErr::SystemError),
-                   ErrorCodeMsg(module[GimbalModule].ModuleName, "Gimbal system error", "Please recheck all the running conditions or contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(GimbalCommonErr::ParamLenTooLong),
-                   ErrorCodeMsg(module[GimbalModule].ModuleName, "Gimbal param get failed", "Please check the validity of the parameter length")),
-    std::make_pair(getRawRetCode(GimbalCommonErr::ModuleInactivated),
-                   ErrorCodeMsg(module[GimbalModule].ModuleName, "Gimbal module is not activated", "Please activate the module first.")),
-    std::make_pair(getRawRetCode(GimbalCommonErr::FWSeqNumNotInOrder),
-                   ErrorCodeMsg(module[GimbalModule].ModuleName, "The seq number of Firmware data is invalid", "Please contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(GimbalCommonErr::FWCheckErr),
-                   ErrorCodeMsg(module[GimbalModule].ModuleName, "Firmware check error", "Please contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(GimbalCommonErr::FlashWriteError),
-                   ErrorCodeMsg(module[GimbalModule].ModuleName, "Gimbal flash write error", "Please contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(GimbalCommonErr::FWInvalidType),
-                   ErrorCodeMsg(module[GimbalModule].ModuleName, "Firmware type is invalid", "Please contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(GimbalCommonErr::RCDisconnect),
-                   ErrorCodeMsg(module[GimbalModule].ModuleName, "Remote Control is disconnected now", "Please check the connection with remote control is if OK.")),
-    std::make_pair(getRawRetCode(GimbalCommonErr::HardwareErr),
-                   ErrorCodeMsg(module[GimbalModule].ModuleName, "Gimbal hardware error", "Please contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(GimbalCommonErr::UAVDisconnect),
-                   ErrorCodeMsg(module[GimbalModule].ModuleName, "Disconnect with aircraft", "Please check the connection with aircraft is if OK.")),
-    std::make_pair(getRawRetCode(GimbalCommonErr::UpgradeErrorNow),
-                   ErrorCodeMsg(module[GimbalModule].ModuleName, "Gimbal cannot not upgrade in current status", "Please contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(GimbalCommonErr::UndefineError),
-                   ErrorCodeMsg(module[GimbalModule].ModuleName, "Undefined error", "Please contact <dev@dji.com> for help.")),
+const ErrorCode::ErrorCodeEntry ErrorCode::GimbalCommonErrData[] = {
+    {getRawRetCode(GimbalCommonErr::InvalidCMD),
+     "Command not supported", "Check the firmware or command validity"},
+    {getRawRetCode(GimbalCommonErr::Timeout),
+     "Gimbal's execution of this action has timed out", "Try again or check the firmware or command"},
+    {getRawRetCode(GimbalCommonErr::OutOfMemory),
+     "Gimbal's execution of this action is out of memory", "Please contact <dev@dji.com> for help."},
+    {getRawRetCode(GimbalCommonErr::InvalidParam),
+     "Gimbal received invalid parameters", "Check the validity of the parameter"},
+    {getRawRetCode(GimbalCommonErr::InvalidState),
+     "Gimbal is busy or the command is not supported in the Gimbal's current state", "Check current Gimbal state is if appropriate fot the CMD"},
+    {getRawRetCode(GimbalCommonErr::TimeNotSync),
+     "The time stamp of the Gimbal is not sync", "Please contact <dev@dji.com> for help."},
+    {getRawRetCode(GimbalCommonErr::ParamSetFailed),
+     "Gimbal failed to set the parameters it received", "Please check the parameter to set is if supported in your devices."},
+    {getRawRetCode(GimbalCommonErr::ParamGetFailed),
+     "Gimbal param get failed", "Please check the parameter to get is if supported in your devices."},
+    {getRawRetCode(GimbalCommonErr::SDCardMISSING),
+     "Gimbal has no SD Card", "Please install SD card."},
+    {getRawRetCode(GimbalCommonErr::SDCardFull),
+     "The Gimbal's SD Card is full", "Please make sure the SD card has enough space."},
+    {getRawRetCode(GimbalCommonErr::SDCardError),
+     "Error accessing the SD Card", "Please check the validity of the SD card."},
+    {getRawRetCode(GimbalCommonErr::SensorError),
+     "Gimbal sensor error", "Please contact <dev@dji.com> for help."},
+    {getRawRetCode(GimbalCommonErr::SystemError),
+     "Gimbal system error", "Please recheck all the running conditions or contact <dev@dji.com> for help."},
+    {getRawRetCode(GimbalCommonErr::ParamLenTooLong),
+     "Gimbal param get failed", "Please check the validity of the parameter length"},
+    {getRawRetCode(GimbalCommonErr::ModuleInactivated),
+     "Gimbal module is not activated", "Please activate the module first."},
+    {getRawRetCode(GimbalCommonErr::FWSeqNumNotInOrder),
+     "The seq number of Firmware data is invalid", "Please contact <dev@dji.com> for help."},
+    {getRawRetCode(GimbalCommonErr::FWCheckErr),
+     "Firmware check error", "Please contact <dev@dji.com> for help."},
+    {getRawRetCode(GimbalCommonErr::FlashWriteError),
+     "Gimbal flash write error", "Please contact <dev@dji.com> for help."},
+    {getRawRetCode(GimbalCommonErr::FWInvalidType),
+     "Firmware type is invalid", "Please contact <dev@dji.com> for help."},
+    {getRawRetCode(GimbalCommonErr::RCDisconnect),
+     "Remote Control is disconnected now", "Please check the connection with remote control is if OK."},
+    {getRawRetCode(GimbalCommonErr::HardwareErr),
+     "Gimbal hardware error", "Please contact <dev@dji.com> for help."},
+    {getRawRetCode(GimbalCommonErr::UAVDisconnect),
+     "Disconnect with aircraft", "Please check the connection with aircraft is if OK."},
+    {getRawRetCode(GimbalCommonErr::UpgradeErrorNow),
+     "Gimbal cannot not upgrade in current status", "Please contact <dev@dji.com> for help."},
+    {getRawRetCode(GimbalCommonErr::UndefineError),
+     "Undefined error", "Please contact <dev@dji.com> for help."},
 };
 
-const ErrorCode::ErrorCodeMapType ErrorCode::getGimbalCommonErrorMap() {
-  const ErrorCodeMapType GimbalCommonErrorMap(GimbalCommonErrData,
-                                              GimbalCommonErrData
-                                                  + sizeof GimbalCommonErrData
-                                                      / sizeof GimbalCommonErrData[0]);
-  return GimbalCommonErrorMap;
-}
 
-const std::pair<const ErrorCode::ErrorCodeType, ErrorCode::ErrorCodeMsg> ErrorCode::PSDKCommonErrData[] = {
-    std::make_pair(getRawRetCode(PSDKCommonErr::InvalidCMD),
-                   ErrorCodeMsg(module[PSDKModule].ModuleName, "Command not supported", "Check the firmware or command validity")),
-    std::make_pair(getRawRetCode(PSDKCommonErr::Timeout),
-                   ErrorCodeMsg(module[PSDKModule].ModuleName, "PSDK device's execution of this action has timed out", "Try again or check the firmware or command")),
-    std::make_pair(getRawRetCode(PSDKCommonErr::OutOfMemory),
-                   ErrorCodeMsg(module[PSDKModule].ModuleName, "PSDK device's execution of this action is out of memory", "Please contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(PSDKCommonErr::InvalidParam),
-                   ErrorCodeMsg(module[PSDKModule].ModuleName, "PSDK device received invalid parameters", "Check the validity of the parameter")),
-    std::make_pair(getRawRetCode(PSDKCommonErr::InvalidState),
-                   ErrorCodeMsg(module[PSDKModule].ModuleName, "PSDK device is busy or the command is not supported in the PSDK device's current state", "Check current camera state is if appropriate fot the CMD")),
-    std::make_pair(getRawRetCode(PSDKCommonErr::TimeNotSync),
-                   ErrorCodeMsg(module[PSDKModule].ModuleName, "The time stamp of the camera is not sync", "Please contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(PSDKCommonErr::ParamSetFailed),
-                   ErrorCodeMsg(module[PSDKModule].ModuleName, "PSDK device failed to set the parameters it received", "Please check the parameter to set is if supported in your devices.")),
-    std::make_pair(getRawRetCode(PSDKCommonErr::ParamGetFailed),
-                   ErrorCodeMsg(module[PSDKModule].ModuleName, "PSDK device param get failed", "Please check the parameter to get is if supported in your devices.")),
-    std::make_pair(getRawRetCode(PSDKCommonErr::SDCardMISSING),
-                   ErrorCodeMsg(module[PSDKModule].ModuleName, "PSDK device has no SD Card", "Please install SD card.")),
-    std::make_pair(getRawRetCode(PSDKCommonErr::SDCardFull),
-                   ErrorCodeMsg(module[PSDKModule].ModuleName, "The PSDK device's SD Card is full", "Please make sure the SD card has enough space.")),
-    std::make_pair(getRawRetCode(PSDKCommonErr::SDCardError),
-                   ErrorCodeMsg(module[PSDKModule].ModuleName, "Error accessing the SD Card", "Please check the validity of the SD card.")),
-    std::make_pair(getRawRetCode(PSDKCommonErr::SensorError),
-                   ErrorCodeMsg(module[PSDKModule].ModuleName, "PSDK device sensor error", "Please contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(PSDKCommonErr::SystemError),
-                   ErrorCodeMsg(module[PSDKModule].ModuleName, "PSDK device system error", "Please recheck all the running conditions or contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(PSDKCommonErr::ParamLenTooLong),
-                   ErrorCodeMsg(module[PSDKModule].ModuleName, "PSDK device param get failed", "Please check the validity of the parameter length")),
-    std::make_pair(getRawRetCode(PSDKCommonErr::ModuleInactivated),
-                   ErrorCodeMsg(module[PSDKModule].ModuleName, "PSDK device module is not activated", "Please activate the module first.")),
-    std::make_pair(getRawRetCode(PSDKCommonErr::FWSeqNumNotInOrder),
-                   ErrorCodeMsg(module[PSDKModule].ModuleName, "The seq number of Firmware data is invalid", "Please contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(PSDKCommonErr::FWCheckErr),
-                   ErrorCodeMsg(module[PSDKModule].ModuleName, "Firmware check error", "Please contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(PSDKCommonErr::FlashWriteError),
-                   ErrorCodeMsg(module[PSDKModule].ModuleName, "PSDK device flash write error", "Please contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(PSDKCommonErr::FWInvalidType),
-                   ErrorCodeMsg(module[PSDKModule].ModuleName, "Firmware type is invalid", "Please contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(PSDKCommonErr::RCDisconnect),
-                   ErrorCodeMsg(module[PSDKModule].ModuleName, "Remote Control is disconnected now", "Please check the connection with remote control is if OK.")),
-    std::make_pair(getRawRetCode(PSDKCommonErr::HardwareErr),
-                   ErrorCodeMsg(module[PSDKModule].ModuleName, "PSDK device hardware error", "Please contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(PSDKCommonErr::UAVDisconnect),
-                   ErrorCodeMsg(module[PSDKModule].ModuleName, "Disconnect with aircraft", "Please check the connection with aircraft is if OK.")),
-    std::make_pair(getRawRetCode(PSDKCommonErr::UpgradeErrorNow),
-                   ErrorCodeMsg(module[PSDKModule].ModuleName, "PSDK device cannot not upgrade in current status", "Please contact <dev@dji.com> for help.")),
-    std::make_pair(getRawRetCode(PSDKCommonErr::UndefineError),
-                   ErrorCodeMsg(module[PSDKModule].ModuleName, "Undefined error", "Please contact <dev@dji.com> for help.")),
+const ErrorCode::ErrorCodeEntry ErrorCode::PSDKCommonErrData[] = {
+    {getRawRetCode(PSDKCommonErr::InvalidCMD),
+     "Command not supported", "Check the firmware or command validity"},
+    {getRawRetCode(PSDKCommonErr::Timeout),
+     "PSDK device's execution of this action has timed out", "Try again or check the firmware or command"},
+    {getRawRetCode(PSDKCommonErr::OutOfMemory),
+     "PSDK device's execution of this action is out of memory", "Please contact <dev@dji.com> for help."},
+    {getRawRetCode(PSDKCommonErr::InvalidParam),
+     "PSDK device received invalid parameters", "Check the validity of the parameter"},
+    {getRawRetCode(PSDKCommonErr::InvalidState),
+     "PSDK device is busy or the command is not supported in the PSDK device's current state", "Check current camera state is if appropriate fot the CMD"},
+    {getRawRetCode(PSDKCommonErr::TimeNotSync),
+     "The time stamp of the camera is not sync", "Please contact <dev@dji.com> for help."},
+    {getRawRetCode(PSDKCommonErr::ParamSetFailed),
+     "PSDK device failed to set the parameters it received", "Please check the parameter to set is if supported in your devices."},
+    {getRawRetCode(PSDKCommonErr::ParamGetFailed),
+     "PSDK device param get failed", "Please check the parameter to get is if supported in your devices."},
+    {getRawRetCode(PSDKCommonErr::SDCardMISSING),
+     "PSDK device has no SD Card", "Please install SD card."},
+    {getRawRetCode(PSDKCommonErr::SDCardFull),
+     "The PSDK device's SD Card is full", "Please make sure the SD card has enough space."},
+    {getRawRetCode(PSDKCommonErr::SDCardError),
+     "Error accessing the SD Card", "Please check the validity of the SD card."},
+    {getRawRetCode(PSDKCommonErr::SensorError),
+     "PSDK device sensor error", "Please contact <dev@dji.com> for help."},
+    {getRawRetCode(PSDKCommonErr::SystemError),
+     "PSDK device system error", "Please recheck all the running conditions or contact <dev@dji.com> for help."},
+    {getRawRetCode(PSDKCommonErr::ParamLenTooLong),
+     "PSDK device param get failed", "Please check the validity of the parameter length"},
+    {getRawRetCode(PSDKCommonErr::ModuleInactivated),
+     "PSDK device module is not activated", "Please activate the module first."},
+    {getRawRetCode(PSDKCommonErr::FWSeqNumNotInOrder),
+     "The seq number of Firmware data is invalid", "Please contact <dev@dji.com> for help."},
+    {getRawRetCode(PSDKCommonErr::FWCheckErr),
+     "Firmware check error", "Please contact <dev@dji.com> for help."},
+    {getRawRetCode(PSDKCommonErr::FlashWriteError),
+     "PSDK device flash write error", "Please contact <dev@dji.com> for help."},
+    {getRawRetCode(PSDKCommonErr::FWInvalidType),
+     "Firmware type is invalid", "Please contact <dev@dji.com> for help."},
+    {getRawRetCode(PSDKCommonErr::RCDisconnect),
+     "Remote Control is disconnected now", "Please check the connection with remote control is if OK."},
+    {getRawRetCode(PSDKCommonErr::HardwareErr),
+     "PSDK device hardware error", "Please contact <dev@dji.com> for help."},
+    {getRawRetCode(PSDKCommonErr::UAVDisconnect),
+     "Disconnect with aircraft", "Please check the connection with aircraft is if OK."},
+    {getRawRetCode(PSDKCommonErr::UpgradeErrorNow),
+     "PSDK device cannot not upgrade in current status", "Please contact <dev@dji.com> for help."},
+    {getRawRetCode(PSDKCommonErr::UndefineError),
+     "Undefined error", "Please contact <dev@dji.com> for help."},
 };
 
-const ErrorCode::ErrorCodeMapType ErrorCode::getPSDKCommonErrorMap() {
-  const ErrorCodeMapType PSDKCommonErrorMap(PSDKCommonErrData,
-                                            PSDKCommonErrData
-                                              + sizeof PSDKCommonErrData
-                                                / sizeof PSDKCommonErrData[0]);
-  return PSDKCommonErrorMap;
-}
 
-const std::pair<const ErrorCode::ErrorCodeType, ErrorCode::ErrorCodeMsg> ErrorCode::SystemCommonErrData[] = {
-    std::make_pair(getRawRetCode(SysCommonErr::Success),
-                   ErrorCodeMsg(module[SysModule].ModuleName, "Execute successfully", "None")),
-    std::make_pair(getRawRetCode(SysCommonErr::AllocMemoryFailed),
-                   ErrorCodeMsg(module[SysModule].ModuleName, "Alloc memory failed", "Please make sure there is enough memory space to support the code running.")),
-    std::make_pair(getRawRetCode(SysCommonErr::ReqNotSupported),
-                   ErrorCodeMsg(module[SysModule].ModuleName, "This request is not supported to the handler", "Please make sure this request is already supported to the handler.")),
-    std::make_pair(getRawRetCode(SysCommonErr::ReqTimeout),
-                   ErrorCodeMsg(module[SysModule].ModuleName, "Request time out", "Try again or check the status of the target object.")),
-    std::make_pair(getRawRetCode(SysCommonErr::UnpackDataMismatch),
-                   ErrorCodeMsg(module[SysModule].ModuleName, "The respond unpacking mismatch", "Please make sure the firmware is matching this OSDK version.")),
-    std::make_pair(getRawRetCode(SysCommonErr::InstInitParamInvalid),
-                   ErrorCodeMsg(module[SysModule].ModuleName, "Instance init parameter invalid", "Please make sure the parameter used in instance initializing is valid.")),
-    std::make_pair(getRawRetCode(SysCommonErr::UserCallbackInvalid),
-                   ErrorCodeMsg(module[SysModule].ModuleName, "The callback set by user is a invalid", "Please make sure the validity of the callback you requesting.")),
-    std::make_pair(getRawRetCode(SysCommonErr::UndefinedError),
-                   ErrorCodeMsg(module[SysModule].ModuleName, "Undefined error", "Unknown error code : 0X%lX, please contact <dev@dji.com> for help.")),
+const ErrorCode::ErrorCodeEntry ErrorCode::SystemCommonErrData[] = {
+    {getRawRetCode(SysCommonErr::Success),
+     "Execute successfully", "None"},
+    {getRawRetCode(SysCommonErr::AllocMemoryFailed),
+     "Alloc memory failed", "Please make sure there is enough memory space to support the code running."},
+    {getRawRetCode(SysCommonErr::ReqNotSupported),
+     "This request is not supported to the handler", "Please make sure this request is already supported to the handler."},
+    {getRawRetCode(SysCommonErr::ReqTimeout),
+     "Request time out", "Try again or check the status of the target object."},
+    {getRawRetCode(SysCommonErr::UnpackDataMismatch),
+     "The respond unpacking mismatch", "Please make sure the firmware is matching this OSDK version."},
+    {getRawRetCode(SysCommonErr::InstInitParamInvalid),
+     "Instance init parameter invalid", "Please make sure the parameter used in instance initializing is valid."},
+    {getRawRetCode(SysCommonErr::UserCallbackInvalid),
+     "The callback set by user is a invalid", "Please make sure the validity of the callback you requesting."},
+    {getRawRetCode(SysCommonErr::UndefinedError),
+     "Undefined error", "Unknown error code, please contact <dev@dji.com> for help."},
 };
 
-const ErrorCode::ErrorCodeMapType ErrorCode::getSystemCommonErrorMap() {
-  const ErrorCodeMapType SystemCommonErrorMap(SystemCommonErrData,
-                                              SystemCommonErrData
-                                                + sizeof SystemCommonErrData
-                                                  / sizeof SystemCommonErrData[0]);
-  return SystemCommonErrorMap;
-}
 
 const ErrorCode::FunctionDataType ErrorCode::SystemFunction[functionMaxCnt] = {
-    {"SystemCommon", getSystemCommonErrorMap},   /*!< SystemCommon */
+    {"SystemCommon", SystemCommonErrData, ERROR_TABLE_SIZE(SystemCommonErrData)},   /*!< SystemCommon */
 };
 
 const ErrorCode::FunctionDataType ErrorCode::GimbalFunction[functionMaxCnt] = {
-    {"GimbalCommon", getGimbalCommonErrorMap},   /*!< GimbalCommon */
+    {"GimbalCommon", GimbalCommonErrData, ERROR_TABLE_SIZE(GimbalCommonErrData)},   /*!< GimbalCommon */
 };
 
 
 const ErrorCode::FunctionDataType ErrorCode::CameraFunction[functionMaxCnt] = {
-    {"CameraCommon", getCameraCommonErrorMap},   /*!< CameraCommon */
+    {"CameraCommon", CameraCommonErrData, ERROR_TABLE_SIZE(CameraCommonErrData)},   /*!< CameraCommon */
 };
 
 const ErrorCode::FunctionDataType ErrorCode::PSDKFunction[functionMaxCnt] = {
-    {"PSDKCommon", getPSDKCommonErrorMap},   /*!< PSDKCommon */
+    {"PSDKCommon", PSDKCommonErrData, ERROR_TABLE_SIZE(PSDKCommonErrData)},   /*!< PSDKCommon */
 };
 
 const ErrorCode::FunctionDataType ErrorCode::WaypointV2Function[functionMaxCnt] = {
-  {"WaypointV2Common", getWaypointV2CommonErrorMap},   /*!< WaypointV2Common */
+  {"WaypointV2Common", WaypointV2CommonErrData, ERROR_TABLE_SIZE(WaypointV2CommonErrData)},   /*!< WaypointV2Common */
 };
 // clang-format on
 
+const ErrorCode::ErrorCodeEntry* ErrorCode::findErrorCodeEntry(
+    const FunctionDataType& function, RawRetCodeType rawRetCode) {
+  uint16_t low = 0;
+  uint16_t high = function.entryCount;
+  while (low < high) {
+    uint16_t mid = low + (high - low) / 2;
+    if (function.entries[mid].rawRetCode < rawRetCode) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  if (low < function.entryCount &&
+      function.entries[low].rawRetCode == rawRetCode) {
+    return &function.entries[low];
+  }
+  return NULL;
+}
+
 ErrorCode::ErrorCodeMsg ErrorCode::getErrorCodeMsg(int64_t errCode) {
   ModuleIDType moduleID = getModuleID(errCode);
   FunctionIDType functionID = getFunctionID(errCode);
-  RawRetCodeType rawRetCode = getRawRetCode(errCode);
-  char defaultResolutionMsg[100] = {0};
-  snprintf(defaultResolutionMsg, sizeof(defaultResolutionMsg),
-           "Unknown error code : 0X%lX, please contact <dev@dji.com> for help.",
-           errCode);
-  ErrorCodeMsg retMsg(getModuleName(errCode), "Unknown", defaultResolutionMsg);
 
   if ((moduleID < ModuleMaxCnt) && (functionID < functionMaxCnt) &&
-      (module[moduleID].data)) {
-    auto msg = module[moduleID].data[functionID].getMap();
-    if (msg.find(rawRetCode) != msg.end()) {
-      retMsg = msg.find(rawRetCode)->second;
+      (module[moduleID].data) && (module[moduleID].data[functionID].entries)) {
+    const ErrorCodeEntry* entry = findErrorCodeEntry(
+        module[moduleID].data[functionID], getRawRetCode(errCode));
+    if (entry) {
+      return ErrorCodeMsg(module[moduleID].ModuleName, entry->errorMsg,
+                          entry->solutionMsg);
     }
   }
-  return retMsg;
+  return ErrorCodeMsg(getModuleName(errCode), "Unknown",
+                      "Unknown error code, please contact <dev@dji.com> for "
+                      "help.");
 }
 
 void ErrorCode::printErrorCodeMsg(int64_t errCode) {
@@ -928,16 +911,13 @@ void ErrorCode::printErrorCodeMsg(int64_t errCode) {
   if (errCode == ErrorCode::SysCommonErr::Success) {
     DSTATUS("Execute successfully.");
   } else {
+    DERROR(">>>>Error code     : 0X%llX", (unsigned long long)errCode);
     DERROR(">>>>Error module   : %s", errMsg.moduleMsg);
     DERROR(">>>>Error message  : %s", errMsg.errorMsg);
     DERROR(">>>>Error solution : %s", errMsg.solutionMsg);
   }
 }
 
-ErrorCode::ModuleIDType ErrorCode::getModuleID(ErrorCodeType errCode) {
-  return (ModuleIDType)((errCode >> moduleIDLeftMove) & 0xFF);
-}
-
 const char* ErrorCode::getModuleName(ErrorCodeType errCode) {
   ModuleIDType moduleID = getModuleID(errCode);
   if (moduleID < ModuleMaxCnt) {
@@ -947,14 +927,6 @@ const char* ErrorCode::getModuleName(ErrorCodeType errCode) {
   }
 }
 
-ErrorCode::FunctionIDType ErrorCode::getFunctionID(ErrorCodeType errCode) {
-  return (FunctionIDType)((errCode >> functionIDLeftMove) & 0xFF);
-}
-
-ErrorCode::RawRetCodeType ErrorCode::getRawRetCode(ErrorCodeType errCode) {
-  return (RawRetCodeType)(errCode & 0xFFFFFFFF);
-}
-
 ErrorCode::ErrorCodeType ErrorCode::getLinkerErrorCode(E_OsdkStat cb_type) {
   switch (cb_type)
   {
@@ -27,6 +27,7 @@
  */
 
 #include "dji_hardware_sync.hpp"
+#include <time.h>
 #include "dji_vehicle.hpp"
 
 using namespace DJI;
@@ -43,6 +44,23 @@ HardwareSync::HardwareSync(Vehicle* vehiclePtr)
   ppsUTCFCTimeHandler.userData = 0;
   ppsUTCTimeHandler.callback = 0;
   ppsUTCTimeHandler.userData = 0;
+
+  for (int i = 0; i < NMEA_KIND_NUM; i++)
+  {
+    nmeaSlots[i].seq = 0;
+    memset(&nmeaSlots[i].data, 0, sizeof(nmeaSlots[i].data));
+  }
+  ppsOffsetSeq = 0;
+  memset(&ppsOffset, 0, sizeof(ppsOffset));
+  ppsEdgeNs = 0;
+
+  setDataFlag(GPGSAFlag, false);
+  setDataFlag(GPRMCFlag, false);
+  setDataFlag(GNGSAFlag, false);
+  setDataFlag(GNRMCFlag, false);
+  setDataFlag(UTCFlag, false);
+  setDataFlag(fcTimeFlag, false);
+  setDataFlag(ppsSourceFlag, false);
   subscribeNMEAMsgs(pollNemaDatacallback, nullptr);
 }
 
@@ -186,52 +204,41 @@ HardwareSync::unsubscribePPSSource()
 }
 
 void
-HardwareSync::writeNMEA(const std::string &nmea)
+HardwareSync::writeNMEA(const char *nmea, uint16_t length)
 {
-  std::string head = nmea.substr(0,6);
-  if(head == "$GPGSA")
+  if(length >= 6 && memcmp(nmea, "$GPGSA", 6) == 0)
   {
-      GPGSAData.sentence = nmea;
-      ++GPGSAData.seq;
-      recordRecvTimeMsg(GPGSAData.timestamp);
-      setDataFlag(GPGSAFlag, true);
-
+    storeNMEA(NMEA_GPGSA, nmea, length);
+    setDataFlag(GPGSAFlag, true);
   }
 
-  else if(head == "$GPRMC")
+  else if(length >= 6 && memcmp(nmea, "$GPRMC", 6) == 0)
   {
-    GPRMCData.sentence = nmea;
-    ++GPRMCData.seq;
-    recordRecvTimeMsg(GPRMCData.timestamp);
+    storeNMEA(NMEA_GPRMC, nmea, length);
     setDataFlag(GPRMCFlag, true);
   }
 
-  else if(head == "$GNGSA") {
-    /*! Transform alphanumeric to num*/
-    SatelliteIndex satellite_index = (SatelliteIndex)((nmea[nmea.size() - 4] - '0') - 1);
-    if (satellite_index  < MAX_INDEX_CNT) {
-      GNGSAData.Satellite[satellite_index].sentence = nmea;
-      ++GNGSAData.Satellite[satellite_index].seq;
-      recordRecvTimeMsg(GNGSAData.Satellite[satellite_index].timestamp);
+  else if(length >= 6 && memcmp(nmea, "$GNGSA", 6) == 0) {
+    /*! Transform alphanumeric to num, it is the GNSS system ID ahead of the
+     *  checksum */
+    int satelliteIndex = (nmea[length - 4] - '0') - 1;
+    if (0 <= satelliteIndex && satelliteIndex < MAX_INDEX_CNT) {
+      storeNMEA((NMEAKind)(NMEA_GNGSA_GPS + satelliteIndex), nmea, length);
     }
-    if (satellite_index == MAX_INDEX_CNT-1)
+    if (satelliteIndex == MAX_INDEX_CNT-1)
     {
       setDataFlag(GNGSAFlag, true);
     }
   }
-  else if(head == "$GNRMC")
+  else if(length >= 6 && memcmp(nmea, "$GNRMC", 6) == 0)
   {
-    GNRMCData.sentence = nmea;
-    ++GNRMCData.seq;
-    recordRecvTimeMsg(GNRMCData.timestamp);
+    storeNMEA(NMEA_GNRMC, nmea, length);
     setDataFlag(GNRMCFlag, true);
   }
 
-  else if(head.substr(0,3) == "UTC")
+  else if(length >= 3 && memcmp(nmea, "UTC", 3) == 0)
   {
-    UTCData.sentence = nmea;
-    ++UTCData.seq;
-    recordRecvTimeMsg(UTCData.timestamp);
+    storeNMEA(NMEA_UTC, nmea, length);
     setDataFlag(UTCFlag, true);
   }
   else
@@ -240,6 +247,48 @@ HardwareSync::writeNMEA(const std::string &nmea)
   }
 }
 
+void
+HardwareSync::storeNMEA(NMEAKind kind, const char *nmea, uint16_t length)
+{
+  RecvTimeMsg timestamp;
+  recordRecvTimeMsg(timestamp);
+  uint64_t monotonicNs = getMonotonicNs();
+
+  NMEASlot &slot = nmeaSlots[kind];
+  seqlockBeginWrite(slot.seq);
+  memcpy(slot.data.sentence, nmea, length);
+  slot.data.sentence[length] = '\0';
+  slot.data.length = length;
+  ++slot.data.seq;
+  slot.data.timestamp = timestamp;
+  slot.data.recvMonotonicNs = monotonicNs;
+  seqlockEndWrite(slot.seq);
+}
+
+void
+HardwareSync::storePPSOffset(const ACK::FCTimeInUTC &fcTime)
+{
+  uint64_t now  = getMonotonicNs();
+#if STM32
+  uint64_t edge = ppsEdgeNs;
+  ppsEdgeNs = 0;
+#elif defined(__linux__)
+  uint64_t edge = ppsEdgeNs.exchange(0, std::memory_order_relaxed);
+#endif
+  /*! A host timed edge precedes the push by the link latency; anything
+   *  older than a PPS period belongs to an earlier pulse */
+  bool fromHost = edge != 0 && edge <= now && now - edge < 1000000000ULL;
+
+  seqlockBeginWrite(ppsOffsetSeq);
+  ppsOffset.fcTimeInUTC  = fcTime;
+  ppsOffset.hostEdgeNs   = fromHost ? edge : now;
+  ppsOffset.offsetNs     = (int64_t)ppsOffset.hostEdgeNs -
+                           (int64_t)fcTime.fc_timestamp_us * 1000;
+  ppsOffset.edgeFromHost = fromHost;
+  ++ppsOffset.seq;
+  seqlockEndWrite(ppsOffsetSeq);
+}
+
 void
 HardwareSync::writeData(const uint8_t cmdID, const RecvContainer *recvContainer)
 {
@@ -247,15 +296,17 @@ HardwareSync::writeData(const uint8_t cmdID, const RecvContainer *recvContainer)
     cmdID <= OpenProtocolCMD::CMDSet::HardwareSync::ppsUTCTime[1] )
   {
     int length = recvContainer->recvInfo.len-OpenProtocol::PackageMin-4;
-    char* rawBuf = (char*)malloc(length);
-    memcpy(rawBuf, recvContainer->recvData.raw_ack_array, length);
-    writeNMEA(std::string((char*)rawBuf, length));
-    free(rawBuf);
-
+    if (length <= 0 || length > (int)MAX_INCOMING_DATA_SIZE)
+    {
+      DERROR("Invalid NMEA length %d\n", length);
+      return;
+    }
+    /*! Parsed in place, nothing is allocated on this path */
+    writeNMEA((const char*)recvContainer->recvData.raw_ack_array, (uint16_t)length);
   }
   else if (cmdID == OpenProtocolCMD::CMDSet::HardwareSync::ppsUTCFCTimeRef[1])
   {
-    fcTimeInUTC = recvContainer->recvData.fcTimeInUTC;
+    storePPSOffset(recvContainer->recvData.fcTimeInUTC);
     setDataFlag(fcTimeFlag, true);
   }
   else if (cmdID == OpenProtocolCMD::CMDSet::HardwareSync::ppsSource[1])
@@ -269,16 +320,68 @@ HardwareSync::writeData(const uint8_t cmdID, const RecvContainer *recvContainer)
   }
 }
 
+bool
+HardwareSync::getLatestNMEA(NMEAKind kind, NMEASentence &nmea) const
+{
+  if (kind < 0 || kind >= NMEA_KIND_NUM)
+  {
+    return false;
+  }
+  return seqlockRead(nmeaSlots[kind].seq, nmeaSlots[kind].data, nmea);
+}
+
+bool
+HardwareSync::readNMEA(NMEAKind kind, NMEAData &nmea) const
+{
+  NMEASentence latest;
+  if (!getLatestNMEA(kind, latest))
+  {
+    return false;
+  }
+  nmea.sentence.assign(latest.sentence, latest.length);
+  nmea.seq       = latest.seq;
+  nmea.timestamp = latest.timestamp;
+  return true;
+}
+
+void
+HardwareSync::notifyPPSEdge(uint64_t hostMonotonicNs)
+{
+#if STM32
+  ppsEdgeNs = hostMonotonicNs;
+#elif defined(__linux__)
+  ppsEdgeNs.store(hostMonotonicNs, std::memory_order_relaxed);
+#endif
+}
+
+bool
+HardwareSync::getPPSOffset(PPSOffset &offset) const
+{
+  return seqlockRead(ppsOffsetSeq, ppsOffset, offset);
+}
+
 bool
 HardwareSync::getUTCTime(NMEAData &utc)
 {
-  return writeDataHelper<NMEAData>(UTCFlag, UTCData, utc);
+  if (getDataFlag(UTCFlag) == true)
+  {
+    setDataFlag(UTCFlag, false);
+    return readNMEA(NMEA_UTC, utc);
+  }
+  return false;
 }
 
 bool
 HardwareSync::getFCTimeInUTCRef(DJI::OSDK::ACK::FCTimeInUTC &_fcTimeInUTC)
 {
-  return writeDataHelper<ACK::FCTimeInUTC>(fcTimeFlag, fcTimeInUTC, _fcTimeInUTC);
+  PPSOffset offset;
+  if (getDataFlag(fcTimeFlag) == true && getPPSOffset(offset))
+  {
+    _fcTimeInUTC = offset.fcTimeInUTC;
+    setDataFlag(fcTimeFlag, false);
+    return true;
+  }
+  return false;
 }
 
 bool
@@ -290,15 +393,23 @@ HardwareSync::getPPSSource(PPSSource &source)
 bool
 HardwareSync::getGNRMCMsg(NMEAData &nmea)
 {
-  return writeDataHelper<NMEAData>(GNRMCFlag, GNRMCData, nmea);
+  if (getDataFlag(GNRMCFlag) == true)
+  {
+    setDataFlag(GNRMCFlag, false);
+    return readNMEA(NMEA_GNRMC, nmea);
+  }
+  return false;
 }
 
 bool
 HardwareSync::getGNGSAMsg(GNGSAPackage &GNGSA)
 {
-  if (GNGSAFlag == true)
+  if (getDataFlag(GNGSAFlag) == true)
   {
-    GNGSA = GNGSAData;
+    for (int i = 0; i < MAX_INDEX_CNT; i++)
+    {
+      readNMEA((NMEAKind)(NMEA_GNGSA_GPS + i), GNGSA.Satellite[i]);
+    }
     setDataFlag(GNGSAFlag, false);
     return true;
   }
@@ -333,6 +444,14 @@ HardwareSync::recordRecvTimeMsg(RecvTimeMsg &recvTime)
   }
   recvTime = msTimeStamp;
 }
+
+uint64_t
+HardwareSync::getMonotonicNs()
+{
+  uint32_t msTimeStamp = 0;
+  OsdkOsal_GetTimeMs(&msTimeStamp);
+  return (uint64_t)msTimeStamp * 1000000ULL;
+}
 #elif defined(__linux__)
 void
 HardwareSync::setDataFlag(HWSyncDataFlag &flag, bool val)
@@ -351,4 +470,12 @@ HardwareSync::recordRecvTimeMsg(RecvTimeMsg &recvTime)
 {
   timespec_get(&recvTime, TIME_UTC);
 }
+
+uint64_t
+HardwareSync::getMonotonicNs()
+{
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
 #endif
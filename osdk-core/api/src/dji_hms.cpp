@@ -43,30 +43,22 @@ using namespace DJI;
 using namespace DJI::OSDK;
 using namespace DJI::OSDK::Telemetry;
 
-namespace DJI{
-    namespace OSDK{
-        extern HMSErrCodeInfo hmsErrCodeInfoTbl[dbHMSErrNum];
-        extern bool replaceStr(string &str, const string oldReplaceStr, const string newReplaceStr);
-    }
-}
-
 /*! @brief Compare HMS's pushing error code with the error code in the error code table,
 * and print the prompt message.
 *
 *  @param djiHMSImpl pointer to djiHMSImpl
-*  @param hmsPushData HMS's raw pushing data without a time stamp
+*  @param errData error code list of one push, straight from the frame
+*  @param errDataLen length of errData in bytes
+*  @param timeStamp timestamp of the push
+*  @param componentIndex camera's or gimbal's index of the push
 *
 *  @return bool pointer and status of subcribing flight check
 *
 *  @note Each error code will print different prompt information according to different states of the aircraft
-*  (ground or air)
+*  (ground or air). Only the arguments are read, the shared HMS data is not touched.
 */
-static bool MarchErrCodeInfoTbl(DJIHMSImpl * djiHMSImpl, HMSPushData *hmsPushData);
-
-/*! In hmsErrCodeInfoTbl's alarmInfo,we need to replace some identified str with real data.
- *  for example, %alarmid <-> 0x1a010040 , %index <-> 1, %component_index <-> 1*/
-static void replaceHMSIdentifyStr(string &alarmInfo, uint32_t alarmId, uint8_t sensorIndex,
-                                  uint8_t componentIndex);
+static bool MarchErrCodeInfoTbl(DJIHMSImpl * djiHMSImpl, const uint8_t *errData, uint16_t errDataLen,
+                                uint32_t timeStamp, uint8_t componentIndex);
 
 static E_OsdkStat HMSRecvDataCallBack(struct _CommandHandle *cmdHandle,
                                       const T_CmdInfo *cmdInfo,
@@ -181,84 +173,64 @@ static E_OsdkStat HMSRecvDataCallBack(struct _CommandHandle *cmdHandle,
         DERROR("null Data!");
         return OSDK_STAT_ERR;
     }
+    if(cmdInfo->dataLen < hmsPushHeaderLen)
+    {
+        DERROR("HMS push too short: %d bytes", cmdInfo->dataLen);
+        return OSDK_STAT_ERR;
+    }
     DJIHMSImpl *djiHMSImpl = (DJIHMSImpl *)userData;
 
     djiHMSImpl->lockHMSInfo();
     djiHMSImpl->setDeviceIndex(cmdInfo->sender);
     djiHMSImpl->setHMSPushData(cmdData, cmdInfo->dataLen);
     djiHMSImpl->setHMSTimeStamp();
+    uint32_t timeStamp = djiHMSImpl->getHMSPushPacket().timeStamp;
+    uint8_t componentIndex = djiHMSImpl->getDeviceIndex();
     djiHMSImpl->freeHMSInfo();
-    MarchErrCodeInfoTbl(djiHMSImpl, &(djiHMSImpl->getHMSPushPacket().hmsPushData));
+
+    /*! Match on the frame itself, getHMSPushPacket() may be called meanwhile */
+    MarchErrCodeInfoTbl(djiHMSImpl, cmdData + hmsPushHeaderLen,
+                        cmdInfo->dataLen - hmsPushHeaderLen, timeStamp, componentIndex);
 
     return OSDK_STAT_OK;
 }
 
-static bool MarchErrCodeInfoTbl(DJIHMSImpl *djiHMSImpl, HMSPushData *hmsPushData) {
-    if (!hmsPushData)
+static bool MarchErrCodeInfoTbl(DJIHMSImpl *djiHMSImpl, const uint8_t *errData, uint16_t errDataLen,
+                                uint32_t timeStamp, uint8_t componentIndex) {
+    if (!errData)
     {
         DSTATUS("HMS Push Data is nullptr!");
         return false;
     }
-    OsdkOsal_TaskSleepMs(200);
 
-    for (int i = 0; i < hmsPushData->errList.size(); i++)
+    /*! Without a flight status subscription the aircraft counts as on the ground */
+    bool inAir = false;
+    if (djiHMSImpl->vehicle && djiHMSImpl->vehicle->subscribe &&
+        TopicDataBase[TOPIC_STATUS_FLIGHT].latest)
+    {
+        inAir = djiHMSImpl->vehicle->subscribe->getValue<TOPIC_STATUS_FLIGHT>() ==
+                VehicleStatus::FlightStatus::IN_AIR;
+    }
+
+    for (uint16_t offset = 0; offset + sizeof(ErrList) <= errDataLen; offset += sizeof(ErrList))
     {
-        for (int j = 0; j < sizeof(DJI::OSDK::hmsErrCodeInfoTbl) / sizeof(HMSErrCodeInfo); j++)
+        ErrList err;
+        memcpy(&err, errData + offset, sizeof(ErrList));
+
+        const HMSErrCodeInfo *info = DJI::OSDK::findHMSErrCodeInfo(err.alarmID);
+        if (!info)
+        {
+            continue;
+        }
+
+        const char *alarmInfo = inAir ? info->flyAlarmInfo : info->groundAlarmInfo;
+        if (alarmInfo && alarmInfo[0] != '\0')
         {
-            if (hmsPushData->errList[i].alarmID == DJI::OSDK::hmsErrCodeInfoTbl[j].alarmId)
-            {
-                switch (djiHMSImpl->vehicle->subscribe->getValue<TOPIC_STATUS_FLIGHT>())
-                {
-                    case VehicleStatus::FlightStatus::IN_AIR:
-                    {
-                        if (DJI::OSDK::hmsErrCodeInfoTbl[j].flyAlarmInfo != "")
-                        {
-                            replaceHMSIdentifyStr(DJI::OSDK::hmsErrCodeInfoTbl[j].flyAlarmInfo,
-                                                  hmsPushData->errList[i].alarmID,
-                                                  hmsPushData->errList[i].sensorIndex,
-                                                  djiHMSImpl->getDeviceIndex());
-                            DSTATUS("TimeStamp: %ld.Info: %s\n", djiHMSImpl->getHMSPushPacket().timeStamp,
-                                    DJI::OSDK::hmsErrCodeInfoTbl[j].flyAlarmInfo.c_str());
-                        }
-                        break;
-                    }
-                    default:
-                    {
-                        if (DJI::OSDK::hmsErrCodeInfoTbl[j].groundAlarmInfo != "")
-                        {
-                            replaceHMSIdentifyStr(DJI::OSDK::hmsErrCodeInfoTbl[j].groundAlarmInfo,
-                                                  hmsPushData->errList[i].alarmID,
-                                                  hmsPushData->errList[i].sensorIndex,
-                                                  djiHMSImpl->getDeviceIndex());
-                            DSTATUS("TimeStamp: %ld.Info:%s\n",djiHMSImpl->getHMSPushPacket().timeStamp,
-                                    DJI::OSDK::hmsErrCodeInfoTbl[j].groundAlarmInfo.c_str());
-                        }
-                        break;
-                    }
-                }
-            }
+            std::string text = DJI::OSDK::formatHMSAlarmInfo(alarmInfo, err.alarmID,
+                                                             err.sensorIndex, componentIndex);
+            DSTATUS("TimeStamp: %ld.Info: %s\n", (long)timeStamp, text.c_str());
         }
     }
 
     return true;
 }
-
-static void replaceHMSIdentifyStr(string & alarmInfo, uint32_t alarmId, uint8_t sensorIndex,
-                                  uint8_t componentIndex)
-{
-    const string oldReplaceAlarmIdStr        = "%alarmid";
-    const string oldReplaceIndexStr          = "%index";
-    const string oldReplaceComponentIndexStr = "%component_index";
-
-    string newReplaceAlarmIdStr;
-    string newReplaceIndexStr ;
-    string newReplaceComponentIndexStr;
-
-    sprintf((char *)newReplaceAlarmIdStr.data(), "0x%08X" , alarmId);
-    sprintf((char *)newReplaceIndexStr.data(), "%d" , sensorIndex);
-    sprintf((char *)newReplaceComponentIndexStr.data(), "%d" ,componentIndex);
-
-    DJI::OSDK::replaceStr(alarmInfo, oldReplaceAlarmIdStr,newReplaceAlarmIdStr.data());
-    DJI::OSDK::replaceStr(alarmInfo, oldReplaceIndexStr,newReplaceIndexStr.data());
-    DJI::OSDK::replaceStr(alarmInfo, oldReplaceComponentIndexStr, newReplaceComponentIndexStr.data());
-}
\ No newline at end of file
@@ -30,6 +30,7 @@
 #include <unistd.h>
 #include "dji_vehicle.hpp"
 #include "dji_hms_impl.hpp"
+#include "dji_hms_internal.hpp"
 #include "osdk_device_id.h"
 
 using namespace std;
@@ -65,11 +66,11 @@ DJIHMSImpl::~DJIHMSImpl()
 
 string DJIHMSImpl::getHMSVersion()
 {
-    string hmsVersion;
-    sprintf((char *)hmsVersion.data(),"HMS%d.%d.%d",DJIOSDK_HMS_MAJOR_VERSION,
-            DJIOSDK_HMS_MINOR_VERSION, DJIOSDK_HMS_PATCH_VERSION);
+    char hmsVersion[32];
+    snprintf(hmsVersion, sizeof(hmsVersion), "HMS%d.%d.%d", DJIOSDK_HMS_MAJOR_VERSION,
+             DJIOSDK_HMS_MINOR_VERSION, DJIOSDK_HMS_PATCH_VERSION);
 
-    return hmsVersion.data();
+    return hmsVersion;
 }
 
 HMSPushPacket& DJIHMSImpl::getHMSPushPacket()
@@ -85,10 +86,15 @@ uint8_t DJIHMSImpl::getDeviceIndex()
 
 void DJIHMSImpl::setHMSPushData(const uint8_t *hmsPushData, uint16_t dataLen)
 {
-    memcpy(&(this->hmsPushPacket.hmsPushData), hmsPushData, 3 * sizeof(uint8_t));
-    this->hmsPushPacket.hmsPushData.errList.clear();
-    this->hmsPushPacket.hmsPushData.errList.resize((dataLen - 3 * sizeof(uint8_t)) / sizeof(ErrList));
-    memcpy(&(this->hmsPushPacket.hmsPushData.errList[0]), hmsPushData + 3 * sizeof(uint8_t), dataLen - 3 * sizeof(uint8_t));
+    if (dataLen < hmsPushHeaderLen)
+    {
+        return;
+    }
+    memcpy(&(this->hmsPushPacket.hmsPushData), hmsPushData, hmsPushHeaderLen);
+    /*! assign() keeps the capacity, so steady pushes do not reallocate */
+    const ErrList *errList = (const ErrList *)(hmsPushData + hmsPushHeaderLen);
+    this->hmsPushPacket.hmsPushData.errList.assign(
+        errList, errList + (dataLen - hmsPushHeaderLen) / sizeof(ErrList));
 }
 
 void DJIHMSImpl::setHMSTimeStamp()
@@ -26,6 +26,10 @@
  *
  */
 
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
 #include "dji_hms_internal.hpp"
 
 namespace DJI{
@@ -53,7 +57,7 @@ bool replaceStr(string &str, const string oldReplaceStr, const string newReplace
 }
 
 /*! HMS's error code table*/
-HMSErrCodeInfo hmsErrCodeInfoTbl[dbHMSErrNum] = {
+const HMSErrCodeInfo hmsErrCodeInfoTbl[] = {
         { 0x16070035 , "Aircraft D-RTK antenna error" , "" },
         { 0x16070034 , "RTK flight heading inconsistent with other sources" , "" },
         { 0x16070033 , "D-RTK mobile station moved" , "" },
@@ -603,5 +607,95 @@ HMSErrCodeInfo hmsErrCodeInfoTbl[dbHMSErrNum] = {
         { 0x1f0b001a , "LTE Transmission error. Switched to OcuSync. Restart aircraft and remote controller to re-establish LTE Transmission (%alarmid)" , "" },
         { 0x1f0b001b , "LTE Transmission error. Switched to OcuSync. Restart aircraft and remote controller to re-establish LTE Transmission (%alarmid)" , "" },
 };
+
+const uint32_t dbHMSErrNum =
+    sizeof(hmsErrCodeInfoTbl) / sizeof(hmsErrCodeInfoTbl[0]);
+
+static bool compareAlarmId(uint16_t lhs, uint16_t rhs)
+{
+    return hmsErrCodeInfoTbl[lhs].alarmId < hmsErrCodeInfoTbl[rhs].alarmId;
+}
+
+static bool compareIndexToAlarmId(uint16_t index, uint32_t alarmId)
+{
+    return hmsErrCodeInfoTbl[index].alarmId < alarmId;
+}
+
+/*! Positions in hmsErrCodeInfoTbl sorted by alarm id. Stable, so the first
+ *  of several entries with the same id wins, as with the old linear scan.*/
+static std::vector<uint16_t> buildHMSErrCodeIndex()
+{
+    std::vector<uint16_t> index(dbHMSErrNum);
+    for (uint32_t i = 0; i < dbHMSErrNum; i++)
+    {
+        index[i] = (uint16_t)i;
+    }
+    std::stable_sort(index.begin(), index.end(), compareAlarmId);
+    return index;
+}
+
+const HMSErrCodeInfo* findHMSErrCodeInfo(uint32_t alarmId)
+{
+    /*! initialized exactly once, even with concurrent callers */
+    static const std::vector<uint16_t> index = buildHMSErrCodeIndex();
+
+    std::vector<uint16_t>::const_iterator it =
+        std::lower_bound(index.begin(), index.end(), alarmId, compareIndexToAlarmId);
+    if (it == index.end() || hmsErrCodeInfoTbl[*it].alarmId != alarmId)
+    {
+        return NULL;
+    }
+    return &hmsErrCodeInfoTbl[*it];
+}
+
+std::string formatHMSAlarmInfo(const char* alarmInfo, uint32_t alarmId,
+                               uint8_t sensorIndex, uint8_t componentIndex)
+{
+    static const char alarmIdTag[]        = "%alarmid";
+    static const char indexTag[]          = "%index";
+    static const char componentIndexTag[] = "%component_index";
+
+    std::string info;
+    if (!alarmInfo)
+    {
+        return info;
+    }
+
+    char value[16];
+    info.reserve(strlen(alarmInfo) + 16);
+    for (const char* p = alarmInfo; *p;)
+    {
+        const char* tag = NULL;
+        if (*p == '%')
+        {
+            if (strncmp(p, alarmIdTag, sizeof(alarmIdTag) - 1) == 0)
+            {
+                tag = alarmIdTag;
+                snprintf(value, sizeof(value), "0x%08X", alarmId);
+            }
+            else if (strncmp(p, componentIndexTag, sizeof(componentIndexTag) - 1) == 0)
+            {
+                tag = componentIndexTag;
+                snprintf(value, sizeof(value), "%d", componentIndex);
+            }
+            else if (strncmp(p, indexTag, sizeof(indexTag) - 1) == 0)
+            {
+                tag = indexTag;
+                snprintf(value, sizeof(value), "%d", sensorIndex);
+            }
+        }
+
+        if (tag)
+        {
+            info.append(value);
+            p += strlen(tag);
+        }
+        else
+        {
+            info.push_back(*p++);
+        }
+    }
+    return info;
+}
   }
 }
\ No newline at end of file
@@ -31,6 +31,9 @@
 #include "dji_linker.hpp"
 #include "osdk_device_id.h"
 #include "dji_internal_command.hpp"
+#if defined(__linux__)
+#include "dji_linker_statistics.hpp"
+#endif
 
 #define MAX_PARAMETER_VALUE_LENGTH 8
 
@@ -45,6 +48,10 @@ typedef struct legacyAdaptingData {
   VehicleCallBack cb;
   UserData udata;
   Vehicle *vehicle;
+  /*! request sent through sendAsync, for the link statistics */
+  uint8_t cmdSet;
+  uint8_t cmdId;
+  uint64_t queuedUs;
 } legacyAdaptingData;
 
 typedef struct CmdListData {
@@ -133,6 +140,10 @@ E_OsdkStat legacyAdaptingRegisterCB(
     const uint8_t *cmdData, void *userData) {
   legacyAdaptingData *legacyData = (legacyAdaptingData *)userData;
   if (cmdInfo && legacyData && legacyData->vehicle) {
+#if defined(__linux__)
+    LinkerStatistics::instance().onPushDelivered(cmdInfo->cmdSet,
+                                                 cmdInfo->cmdId);
+#endif
     if (legacyData->cb) {
       RecvContainer recvFrame = recvFrameAdapting(*cmdInfo, cmdData);
       legacyData->cb(legacyData->vehicle, recvFrame, legacyData->udata);
@@ -345,6 +356,18 @@ void LegacyLinker::send(const uint8_t cmd[], void *pdata, size_t len) {
 void legacyAdaptingAsyncCB(const T_CmdInfo *cmdInfo,
                                          const uint8_t *cmdData,
                                          void *userData, E_OsdkStat cb_type) {
+#if defined(__linux__)
+  if (userData) {
+    legacyAdaptingData *request = (legacyAdaptingData *) userData;
+    if (cb_type == OSDK_STAT_OK) {
+      LinkerStatistics::instance().onAckDelivered(
+          request->cmdSet, request->cmdId, request->queuedUs);
+    } else if (cb_type == OSDK_STAT_ERR_TIMEOUT) {
+      LinkerStatistics::instance().onTimeout(request->cmdSet, request->cmdId);
+    }
+  }
+#endif
+
   if (cb_type == OSDK_STAT_OK) {
     if ((!cmdInfo) && (!userData) && (!((legacyAdaptingData *) (userData))->cb)
         && (!((legacyAdaptingData *) (userData))->vehicle)) {
@@ -379,7 +402,10 @@ void LegacyLinker::sendAsync(const uint8_t cmd[], void *pdata, size_t len,
   cmdInfo.channelId = 0;
   legacyAdaptingData
       *udata = (legacyAdaptingData *) malloc(sizeof(legacyAdaptingData));
-  *udata = {callback, userData, vehicle};
+  *udata = {callback, userData, vehicle, cmd[0], cmd[1], 0};
+#if defined(__linux__)
+  udata->queuedUs = LinkerStatistics::nowUs();
+#endif
 
   vehicle->linker->sendAsync(&cmdInfo, (uint8_t *) pdata, legacyAdaptingAsyncCB,
                              udata, timeout, retry_time);
@@ -405,9 +431,19 @@ void* LegacyLinker::sendSync(const uint8_t cmd[], void *pdata,
   ackInfo.cmdSet = 0xFF;
   ackInfo.cmdId = 0xFF;
 
+#if defined(__linux__)
+  uint64_t queuedUs = LinkerStatistics::nowUs();
+#endif
   E_OsdkStat ret =
       vehicle->linker->sendSync(&cmdInfo, (uint8_t *) pdata, &ackInfo, ackData,
                                 timeout, retry_time);
+#if defined(__linux__)
+  if (ret == OSDK_STAT_OK) {
+    LinkerStatistics::instance().onAckDelivered(cmd[0], cmd[1], queuedUs);
+  } else if (ret == OSDK_STAT_ERR_TIMEOUT) {
+    LinkerStatistics::instance().onTimeout(cmd[0], cmd[1]);
+  }
+#endif
   RecvContainer recvFrame = recvFrameAdapting(ackInfo, ackData);
 
   return decodeAck(ret, ackInfo.cmdSet, ackInfo.cmdId, recvFrame);
@@ -0,0 +1,744 @@
+/** @file dji_linker_statistics.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief
+ *  Counters and latency histograms for the linker send/receive paths
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "dji_linker_statistics.hpp"
+#include <string.h>
+#include <chrono>
+#include <sstream>
+
+using namespace DJI;
+using namespace DJI::OSDK;
+
+#define PROTOCOL_INDEX_SDK 0
+#define PROTOCOL_INDEX_V1  1
+#define PROTOCOL_UNKNOWN   (-1)
+#define SOF_SDK            0xAA
+#define SOF_V1             0x55
+/* Enough of a bulk frame for decodeHeader() when it needs no unpacking */
+#define BULK_HEADER_LEN    16
+
+uint64_t
+LinkerStatistics::Histogram::percentileUs(double percentile) const
+{
+  if (count == 0)
+  {
+    return 0;
+  }
+  uint64_t target = (uint64_t)(percentile * count);
+  uint64_t seen   = 0;
+  for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+  {
+    seen += buckets[i];
+    if (seen > target)
+    {
+      return (i == HISTOGRAM_BUCKETS - 1) ? maxUs : (2ull << i);
+    }
+  }
+  return maxUs;
+}
+
+LinkerStatistics::LinkerStatistics()
+  : enabled(false)
+{
+  for (int i = 0; i < 256; i++)
+  {
+    table[i].store(NULL);
+  }
+  for (int i = 0; i < MAX_CHANNELS; i++)
+  {
+    channels[i].used.store(false);
+    channels[i].obj = NULL;
+  }
+  memset(protocolOps, 0, sizeof(protocolOps));
+  memset(protocolExt, 0, sizeof(protocolExt));
+  memset(protocolReady, 0, sizeof(protocolReady));
+  memset(&userUart, 0, sizeof(userUart));
+  memset(&wrappedUart, 0, sizeof(wrappedUart));
+#ifdef __linux__
+  memset(&userUSBBulk, 0, sizeof(userUSBBulk));
+  memset(&wrappedUSBBulk, 0, sizeof(wrappedUSBBulk));
+#endif
+}
+
+LinkerStatistics::~LinkerStatistics()
+{
+  for (int i = 0; i < 256; i++)
+  {
+    delete[] table[i].load();
+  }
+  for (int i = 0; i < 2; i++)
+  {
+    if (protocolReady[i])
+    {
+      protocolOps[i].Deinit(protocolExt[i]);
+    }
+  }
+}
+
+void
+LinkerStatistics::setEnabled(bool enable)
+{
+  enabled.store(enable, std::memory_order_relaxed);
+}
+
+bool
+LinkerStatistics::isEnabled() const
+{
+  return enabled.load(std::memory_order_relaxed);
+}
+
+uint64_t
+LinkerStatistics::nowUs()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+           std::chrono::steady_clock::now().time_since_epoch())
+    .count();
+}
+
+void
+LinkerStatistics::record(AtomicHistogram& histogram, uint64_t us)
+{
+  int bucket = 0;
+  for (uint64_t v = us >> 1; v && bucket < HISTOGRAM_BUCKETS - 1; v >>= 1)
+  {
+    bucket++;
+  }
+  histogram.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+  histogram.count.fetch_add(1, std::memory_order_relaxed);
+  histogram.sumUs.fetch_add(us, std::memory_order_relaxed);
+
+  uint64_t max = histogram.maxUs.load(std::memory_order_relaxed);
+  while (us > max &&
+         !histogram.maxUs.compare_exchange_weak(max, us,
+                                                std::memory_order_relaxed))
+  {
+  }
+}
+
+void
+LinkerStatistics::load(const AtomicHistogram& histogram, Histogram& out)
+{
+  out.count = histogram.count.load(std::memory_order_relaxed);
+  out.sumUs = histogram.sumUs.load(std::memory_order_relaxed);
+  out.maxUs = histogram.maxUs.load(std::memory_order_relaxed);
+  for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+  {
+    out.buckets[i] = histogram.buckets[i].load(std::memory_order_relaxed);
+  }
+}
+
+void
+LinkerStatistics::clear(AtomicHistogram& histogram)
+{
+  histogram.count.store(0, std::memory_order_relaxed);
+  histogram.sumUs.store(0, std::memory_order_relaxed);
+  histogram.maxUs.store(0, std::memory_order_relaxed);
+  for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+  {
+    histogram.buckets[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+LinkerStatistics::CommandSlot*
+LinkerStatistics::slot(uint8_t cmdSet, uint8_t cmdId)
+{
+  CommandSlot* slots = table[cmdSet].load(std::memory_order_acquire);
+  if (!slots)
+  {
+    CommandSlot* created = new CommandSlot[256];
+    for (int i = 0; i < 256; i++)
+    {
+      created[i].sent.store(0);
+      created[i].retransmits.store(0);
+      created[i].acked.store(0);
+      created[i].timeouts.store(0);
+      created[i].pushes.store(0);
+      created[i].lastPushUs.store(0);
+      clear(created[i].wireRtt);
+      clear(created[i].ackLatency);
+      clear(created[i].pushLatency);
+    }
+    if (table[cmdSet].compare_exchange_strong(slots, created,
+                                              std::memory_order_acq_rel))
+    {
+      slots = created;
+    }
+    else
+    {
+      delete[] created;
+    }
+  }
+  return &slots[cmdId];
+}
+
+const LinkerStatistics::CommandSlot*
+LinkerStatistics::findSlot(uint8_t cmdSet, uint8_t cmdId) const
+{
+  CommandSlot* slots = table[cmdSet].load(std::memory_order_acquire);
+  return slots ? &slots[cmdId] : NULL;
+}
+
+void
+LinkerStatistics::reset()
+{
+  for (int set = 0; set < 256; set++)
+  {
+    CommandSlot* slots = table[set].load(std::memory_order_acquire);
+    if (!slots)
+    {
+      continue;
+    }
+    for (int id = 0; id < 256; id++)
+    {
+      slots[id].sent.store(0, std::memory_order_relaxed);
+      slots[id].retransmits.store(0, std::memory_order_relaxed);
+      slots[id].acked.store(0, std::memory_order_relaxed);
+      slots[id].timeouts.store(0, std::memory_order_relaxed);
+      slots[id].pushes.store(0, std::memory_order_relaxed);
+      clear(slots[id].wireRtt);
+      clear(slots[id].ackLatency);
+      clear(slots[id].pushLatency);
+    }
+  }
+  for (int i = 0; i < MAX_CHANNELS; i++)
+  {
+    channels[i].txBytes.store(0, std::memory_order_relaxed);
+    channels[i].rxBytes.store(0, std::memory_order_relaxed);
+    channels[i].txFrames.store(0, std::memory_order_relaxed);
+    channels[i].rxFrames.store(0, std::memory_order_relaxed);
+  }
+}
+
+bool
+LinkerStatistics::getCommandStats(uint8_t cmdSet, uint8_t cmdId,
+                                  CommandStats& stats) const
+{
+  const CommandSlot* s = findSlot(cmdSet, cmdId);
+  if (!s)
+  {
+    return false;
+  }
+  stats.cmdSet      = cmdSet;
+  stats.cmdId       = cmdId;
+  stats.sent        = s->sent.load(std::memory_order_relaxed);
+  stats.retransmits = s->retransmits.load(std::memory_order_relaxed);
+  stats.acked       = s->acked.load(std::memory_order_relaxed);
+  stats.timeouts    = s->timeouts.load(std::memory_order_relaxed);
+  stats.pushes      = s->pushes.load(std::memory_order_relaxed);
+  load(s->wireRtt, stats.wireRtt);
+  load(s->ackLatency, stats.ackLatency);
+  load(s->pushLatency, stats.pushLatency);
+  return stats.sent || stats.acked || stats.timeouts || stats.pushes ||
+         stats.ackLatency.count || stats.pushLatency.count;
+}
+
+std::vector<LinkerStatistics::ChannelStats>
+LinkerStatistics::getChannelStats() const
+{
+  std::vector<ChannelStats> result;
+  for (int i = 0; i < MAX_CHANNELS; i++)
+  {
+    const Channel& ch = channels[i];
+    if (!ch.used.load(std::memory_order_acquire))
+    {
+      continue;
+    }
+    ChannelStats stats;
+    stats.index    = i;
+    stats.type     = ch.type;
+    stats.txBytes  = ch.txBytes.load(std::memory_order_relaxed);
+    stats.rxBytes  = ch.rxBytes.load(std::memory_order_relaxed);
+    stats.txFrames = ch.txFrames.load(std::memory_order_relaxed);
+    stats.rxFrames = ch.rxFrames.load(std::memory_order_relaxed);
+    result.push_back(stats);
+  }
+  return result;
+}
+
+LinkerStatistics::Snapshot
+LinkerStatistics::getSnapshot() const
+{
+  Snapshot snapshot;
+  snapshot.timestampUs = nowUs();
+  snapshot.channels    = getChannelStats();
+
+  CommandStats stats;
+  for (int set = 0; set < 256; set++)
+  {
+    if (!table[set].load(std::memory_order_acquire))
+    {
+      continue;
+    }
+    for (int id = 0; id < 256; id++)
+    {
+      if (getCommandStats(set, id, stats))
+      {
+        snapshot.commands.push_back(stats);
+      }
+    }
+  }
+  return snapshot;
+}
+
+static void
+histogramToJson(std::ostringstream& out, const char* name,
+                const LinkerStatistics::Histogram& h)
+{
+  out << "\"" << name << "\": {\"count\": " << h.count
+      << ", \"mean_us\": " << (h.count ? h.sumUs / h.count : 0)
+      << ", \"p50_us\": " << h.percentileUs(0.5)
+      << ", \"p99_us\": " << h.percentileUs(0.99)
+      << ", \"max_us\": " << h.maxUs << ", \"buckets\": [";
+  for (int i = 0; i < LinkerStatistics::HISTOGRAM_BUCKETS; i++)
+  {
+    out << (i ? ", " : "") << h.buckets[i];
+  }
+  out << "]}";
+}
+
+std::string
+LinkerStatistics::toJson(const Snapshot& snapshot)
+{
+  std::ostringstream out;
+  out << "{\"timestamp_us\": " << snapshot.timestampUs << ", \"channels\": [";
+  for (size_t i = 0; i < snapshot.channels.size(); i++)
+  {
+    const ChannelStats& c = snapshot.channels[i];
+    out << (i ? ", " : "") << "{\"index\": " << (int)c.index
+        << ", \"type\": \"" << (c.type == CHANNEL_UART ? "uart" : "usb_bulk")
+        << "\", \"tx_bytes\": " << c.txBytes << ", \"rx_bytes\": " << c.rxBytes
+        << ", \"tx_frames\": " << c.txFrames
+        << ", \"rx_frames\": " << c.rxFrames << "}";
+  }
+  out << "], \"commands\": [";
+  for (size_t i = 0; i < snapshot.commands.size(); i++)
+  {
+    const CommandStats& c = snapshot.commands[i];
+    out << (i ? ", " : "") << "{\"cmd_set\": " << (int)c.cmdSet
+        << ", \"cmd_id\": " << (int)c.cmdId << ", \"sent\": " << c.sent
+        << ", \"retransmits\": " << c.retransmits
+        << ", \"acked\": " << c.acked << ", \"timeouts\": " << c.timeouts
+        << ", \"pushes\": " << c.pushes << ", ";
+    histogramToJson(out, "wire_rtt", c.wireRtt);
+    out << ", ";
+    histogramToJson(out, "ack_latency", c.ackLatency);
+    out << ", ";
+    histogramToJson(out, "push_latency", c.pushLatency);
+    out << "}";
+  }
+  out << "]}";
+  return out.str();
+}
+
+/*********************** LegacyLinker hooks ******************************/
+
+void
+LinkerStatistics::onAckDelivered(uint8_t cmdSet, uint8_t cmdId,
+                                 uint64_t queuedUs)
+{
+  if (isEnabled())
+  {
+    record(slot(cmdSet, cmdId)->ackLatency, nowUs() - queuedUs);
+  }
+}
+
+void
+LinkerStatistics::onTimeout(uint8_t cmdSet, uint8_t cmdId)
+{
+  if (isEnabled())
+  {
+    slot(cmdSet, cmdId)->timeouts.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void
+LinkerStatistics::onPushDelivered(uint8_t cmdSet, uint8_t cmdId)
+{
+  if (!isEnabled())
+  {
+    return;
+  }
+  CommandSlot* s        = slot(cmdSet, cmdId);
+  uint64_t     received = s->lastPushUs.load(std::memory_order_relaxed);
+  if (received)
+  {
+    record(s->pushLatency, nowUs() - received);
+  }
+}
+
+/*************************** HAL wire tap ********************************/
+
+LinkerStatistics::Channel*
+LinkerStatistics::channel(const T_HalObj* obj, ChannelType type)
+{
+  for (int i = 0; i < MAX_CHANNELS; i++)
+  {
+    if (channels[i].used.load(std::memory_order_acquire) &&
+        channels[i].obj == obj)
+    {
+      return &channels[i];
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(channelMutex);
+  for (int i = 0; i < MAX_CHANNELS; i++)
+  {
+    Channel& ch = channels[i];
+    if (ch.used.load(std::memory_order_acquire))
+    {
+      if (ch.obj == obj)
+      {
+        return &ch;
+      }
+      continue;
+    }
+
+    if (!protocolReady[PROTOCOL_INDEX_SDK] &&
+        OsdkProtocol_getProtocolOps(PROTOCOL_SDK,
+                                    &protocolOps[PROTOCOL_INDEX_SDK]) ==
+          OSDK_STAT_OK)
+    {
+      protocolReady[PROTOCOL_INDEX_SDK] =
+        protocolOps[PROTOCOL_INDEX_SDK].Init(
+          &protocolExt[PROTOCOL_INDEX_SDK]) == OSDK_STAT_OK;
+    }
+    if (!protocolReady[PROTOCOL_INDEX_V1] &&
+        OsdkProtocol_getProtocolOps(PROTOCOL_V1,
+                                    &protocolOps[PROTOCOL_INDEX_V1]) ==
+          OSDK_STAT_OK)
+    {
+      protocolReady[PROTOCOL_INDEX_V1] =
+        protocolOps[PROTOCOL_INDEX_V1].Init(
+          &protocolExt[PROTOCOL_INDEX_V1]) == OSDK_STAT_OK;
+    }
+
+    ch.obj  = obj;
+    ch.type = type;
+    ch.txBytes.store(0);
+    ch.rxBytes.store(0);
+    ch.txFrames.store(0);
+    ch.rxFrames.store(0);
+    FrameTap* taps[] = { &ch.tx, &ch.rx };
+    for (int t = 0; t < 2; t++)
+    {
+      for (int p = 0; p < 2; p++)
+      {
+        taps[t]->parseBuf[p].resize(OSDK_PACKAGE_MAX_LEN * 2);
+        taps[t]->parse[p].parseBuff  = &taps[t]->parseBuf[p][0];
+        taps[t]->parse[p].parseIndex = 0;
+      }
+      taps[t]->unpackBuf.resize(OSDK_PACKAGE_MAX_LEN * 2);
+    }
+    memset(ch.pending, 0, sizeof(ch.pending));
+    ch.used.store(true, std::memory_order_release);
+    return &ch;
+  }
+  return NULL;
+}
+
+void
+LinkerStatistics::tap(Channel* ch, bool isTx, const uint8_t* buf,
+                      uint32_t len)
+{
+  (isTx ? ch->txBytes : ch->rxBytes)
+    .fetch_add(len, std::memory_order_relaxed);
+
+  if (ch->type != CHANNEL_UART)
+  {
+    /* bulk transfers are frame aligned, one frame each starting with its
+     * SOF, so no parsing is needed to find the header */
+    (isTx ? ch->txFrames : ch->rxFrames)
+      .fetch_add(1, std::memory_order_relaxed);
+    tapBulkFrame(ch, isTx, buf, len);
+    return;
+  }
+
+  FrameTap&                   frameTap = isTx ? ch->tx : ch->rx;
+  std::lock_guard<std::mutex> lock(frameTap.mutex);
+  for (uint32_t i = 0; i < len; i++)
+  {
+    for (int p = 0; p < 2; p++)
+    {
+      uint8_t* frame    = NULL;
+      uint32_t frameLen = 0;
+      if (protocolReady[p] &&
+          protocolOps[p].Parse(&frameTap.parse[p], buf[i], &frame,
+                               &frameLen) == OSDK_STAT_OK)
+      {
+        (isTx ? ch->txFrames : ch->rxFrames)
+          .fetch_add(1, std::memory_order_relaxed);
+        onFrame(ch, isTx, frame, frameLen, p);
+      }
+    }
+  }
+}
+
+void
+LinkerStatistics::tapBulkFrame(Channel* ch, bool isTx, const uint8_t* buf,
+                               uint32_t len)
+{
+  int protocol = PROTOCOL_UNKNOWN;
+  if (len > 0 && buf[0] == SOF_V1)
+  {
+    protocol = PROTOCOL_INDEX_V1;
+  }
+  else if (len > 0 && buf[0] == SOF_SDK)
+  {
+    protocol = PROTOCOL_INDEX_SDK;
+  }
+  if (protocol == PROTOCOL_UNKNOWN || !protocolReady[protocol])
+  {
+    return;
+  }
+
+  /* Bulk frames carry liveview and file data too, so only the header is
+   * copied; an encrypted SDK frame needs all of it to be unpacked. */
+  FrameTap&                   frameTap = isTx ? ch->tx : ch->rx;
+  std::lock_guard<std::mutex> lock(frameTap.mutex);
+  uint32_t                    copyLen  = len;
+  if (protocol == PROTOCOL_INDEX_V1 ||
+      (len >= 14 && (buf[4] & 0x07) == 0))
+  {
+    copyLen = len < BULK_HEADER_LEN ? len : BULK_HEADER_LEN;
+  }
+  frameTap.bulkBuf.assign(buf, buf + copyLen);
+  onFrame(ch, isTx, &frameTap.bulkBuf[0], len, protocol);
+}
+
+bool
+LinkerStatistics::decodeHeader(FrameTap& frameTap, uint8_t* frame,
+                               uint32_t len, int protocol, FrameHeader& header)
+{
+  /* Read straight from the header; only encrypted SDK frames, whose cmdSet
+   * and cmdId are part of the cipher text, need a full unpack. */
+  if (protocol == PROTOCOL_INDEX_V1)
+  {
+    if (len < 11)
+    {
+      return false;
+    }
+    header.isAck   = (frame[8] & 0x80) != 0;
+    header.needAck = (frame[8] & 0x60) != 0;
+    header.seqNum  = frame[6] | (frame[7] << 8);
+    header.cmdSet  = frame[9];
+    header.cmdId   = frame[10];
+    return true;
+  }
+
+  if (len < 12)
+  {
+    return false;
+  }
+  header.isAck   = (frame[3] & 0x20) != 0;
+  header.needAck = (frame[3] & 0x1F) != 0;
+  header.seqNum  = frame[8] | (frame[9] << 8);
+  header.cmdSet  = 0;
+  header.cmdId   = 0;
+  if (header.isAck)
+  {
+    return true;
+  }
+  if ((frame[4] & 0x07) == 0 && len >= 14)
+  {
+    header.cmdSet = frame[12];
+    header.cmdId  = frame[13];
+    return true;
+  }
+
+  T_CmdInfo info;
+  memset(&info, 0, sizeof(info));
+  if (protocolOps[protocol].Unpack(protocolExt[protocol], frame, &info,
+                                   &frameTap.unpackBuf[0]) != OSDK_STAT_OK)
+  {
+    return false;
+  }
+  header.cmdSet = info.cmdSet;
+  header.cmdId  = info.cmdId;
+  return true;
+}
+
+void
+LinkerStatistics::onFrame(Channel* ch, bool isTx, uint8_t* frame,
+                          uint32_t len, int protocol)
+{
+  FrameHeader header;
+  if (!decodeHeader(isTx ? ch->tx : ch->rx, frame, len, protocol, header))
+  {
+    return;
+  }
+
+  PendingRequest& pending = ch->pending[header.seqNum % PENDING_SLOTS];
+
+  if (!header.isAck && isTx)
+  {
+    CommandSlot* s = slot(header.cmdSet, header.cmdId);
+    if (!header.needAck)
+    {
+      s->sent.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(ch->pendingMutex);
+    if (pending.valid && pending.seqNum == header.seqNum &&
+        pending.cmdSet == header.cmdSet && pending.cmdId == header.cmdId)
+    {
+      s->retransmits.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    s->sent.fetch_add(1, std::memory_order_relaxed);
+    pending.valid  = true;
+    pending.seqNum = header.seqNum;
+    pending.cmdSet = header.cmdSet;
+    pending.cmdId  = header.cmdId;
+    pending.sentUs = nowUs();
+  }
+  else if (header.isAck && !isTx)
+  {
+    uint8_t  cmdSet, cmdId;
+    uint64_t sentUs;
+    {
+      std::lock_guard<std::mutex> lock(ch->pendingMutex);
+      if (!pending.valid || pending.seqNum != header.seqNum)
+      {
+        return;
+      }
+      pending.valid = false;
+      cmdSet        = pending.cmdSet;
+      cmdId         = pending.cmdId;
+      sentUs        = pending.sentUs;
+    }
+    CommandSlot* s = slot(cmdSet, cmdId);
+    s->acked.fetch_add(1, std::memory_order_relaxed);
+    record(s->wireRtt, nowUs() - sentUs);
+  }
+  else if (!header.isAck)
+  {
+    CommandSlot* s = slot(header.cmdSet, header.cmdId);
+    s->pushes.fetch_add(1, std::memory_order_relaxed);
+    s->lastPushUs.store(nowUs(), std::memory_order_relaxed);
+  }
+}
+
+E_OsdkStat
+LinkerStatistics::uartWriteData(const T_HalObj* obj, const uint8_t* pBuf,
+                                uint32_t bufLen)
+{
+  /* Tap before writing: on a fast link the ACK can be read back before the
+   * write call returns. */
+  LinkerStatistics& self = instance();
+  if (self.isEnabled())
+  {
+    Channel* ch = self.channel(obj, CHANNEL_UART);
+    if (ch)
+    {
+      self.tap(ch, true, pBuf, bufLen);
+    }
+  }
+  return self.userUart.UartWriteData(obj, pBuf, bufLen);
+}
+
+E_OsdkStat
+LinkerStatistics::uartReadData(const T_HalObj* obj, uint8_t* pBuf,
+                               uint32_t* bufLen)
+{
+  LinkerStatistics& self = instance();
+  E_OsdkStat        ret  = self.userUart.UartReadData(obj, pBuf, bufLen);
+  if (ret == OSDK_STAT_OK && *bufLen && self.isEnabled())
+  {
+    Channel* ch = self.channel(obj, CHANNEL_UART);
+    if (ch)
+    {
+      self.tap(ch, false, pBuf, *bufLen);
+    }
+  }
+  return ret;
+}
+
+const T_OsdkHalUartHandler*
+LinkerStatistics::wrapUartHandler(const T_OsdkHalUartHandler* handler)
+{
+  if (!handler || !handler->UartWriteData || !handler->UartReadData)
+  {
+    return handler;
+  }
+  userUart                  = *handler;
+  wrappedUart               = *handler;
+  wrappedUart.UartWriteData = uartWriteData;
+  wrappedUart.UartReadData  = uartReadData;
+  return &wrappedUart;
+}
+
+#ifdef __linux__
+E_OsdkStat
+LinkerStatistics::usbBulkWriteData(const T_HalObj* obj, const uint8_t* pBuf,
+                                   uint32_t bufLen)
+{
+  LinkerStatistics& self = instance();
+  if (self.isEnabled())
+  {
+    Channel* ch = self.channel(obj, CHANNEL_USB_BULK);
+    if (ch)
+    {
+      self.tap(ch, true, pBuf, bufLen);
+    }
+  }
+  return self.userUSBBulk.USBBulkWriteData(obj, pBuf, bufLen);
+}
+
+E_OsdkStat
+LinkerStatistics::usbBulkReadData(const T_HalObj* obj, uint8_t* pBuf,
+                                  uint32_t* bufLen)
+{
+  LinkerStatistics& self = instance();
+  E_OsdkStat        ret  = self.userUSBBulk.USBBulkReadData(obj, pBuf, bufLen);
+  if (ret == OSDK_STAT_OK && *bufLen && self.isEnabled())
+  {
+    Channel* ch = self.channel(obj, CHANNEL_USB_BULK);
+    if (ch)
+    {
+      self.tap(ch, false, pBuf, *bufLen);
+    }
+  }
+  return ret;
+}
+
+const T_OsdkHalUSBBulkHandler*
+LinkerStatistics::wrapUSBBulkHandler(const T_OsdkHalUSBBulkHandler* handler)
+{
+  if (!handler || !handler->USBBulkWriteData || !handler->USBBulkReadData)
+  {
+    return handler;
+  }
+  userUSBBulk                     = *handler;
+  wrappedUSBBulk                  = *handler;
+  wrappedUSBBulk.USBBulkWriteData = usbBulkWriteData;
+  wrappedUSBBulk.USBBulkReadData  = usbBulkReadData;
+  return &wrappedUSBBulk;
+}
+#endif
@@ -73,29 +73,53 @@ void elementDecode(Type &data, uint8_t *&tempPtr) {
   tempPtr += sizeof(Type);
 }
 
-bool missionEncode(const std::vector<WaypointV2Internal> &mission, uint8_t *pushPtr,
-                   uint16_t &len) {
-  if (mission.empty()) {
-    pushPtr = nullptr;
-    len = 0;
-    return true;
-  }
+/*! Waypoint in the units of the FC, positioned relative to the mission's
+ *  first waypoint */
+WaypointV2Internal transformWaypoint2WaypointInternal(const WaypointV2 &waypointV2,
+                                                      const WaypointV2 &reference,
+                                                      float64_t cosRefLatitude)
+{
+  WaypointV2Internal waypointV2Internal;
+  waypointV2Internal.positionX = (waypointV2.longitude - reference.longitude) * EARTH_RADIUS * cosRefLatitude;
+  waypointV2Internal.positionY = (waypointV2.latitude - reference.latitude) * EARTH_RADIUS;
+  waypointV2Internal.positionZ = waypointV2.relativeHeight;
+  waypointV2Internal.waypointType    = waypointV2.waypointType;
+  waypointV2Internal.headingMode     = waypointV2.headingMode;
+  waypointV2Internal.config          = waypointV2.config;
+  waypointV2Internal.dampingDistance = waypointV2.dampingDistance;
+  waypointV2Internal.heading         = waypointV2.heading;
+  waypointV2Internal.turnMode        = waypointV2.turnMode;
+  waypointV2Internal.pointOfInterest = waypointV2.pointOfInterest;
+  waypointV2Internal.maxFlightSpeed  = uint16_t (waypointV2.maxFlightSpeed *100);
+  waypointV2Internal.autoFlightSpeed = uint16_t (waypointV2.autoFlightSpeed *100);
+  return waypointV2Internal;
+}
 
-  bool finished = false;
+/*! Payload the FC takes per upload chunk; the last waypoint or action may
+ *  run past it, so chunks are encoded into buffers of uploadChunkBufferLen */
+const uint16_t missionChunkLen      = 200;
+const uint16_t actionChunkLen       = 100;
+const uint16_t uploadChunkBufferLen = 400;
+
+/*! Encodes the waypoints from startIndex on into one upload chunk, converting
+ *  them on the way.
+ *  @return index of the first waypoint left for the next chunk */
+size_t missionChunkEncode(const std::vector<WaypointV2> &mission, size_t startIndex,
+                          float64_t cosRefLatitude, uint8_t *pushPtr, uint16_t &len) {
   uint16_t tempTotalLen = 0;
-  static uint16_t startIndex = 0;
-  uint16_t endIndex = 0;
   uint8_t *tempPtr = pushPtr;
+  uint16_t chunkStartIndex = (uint16_t)startIndex;
 
   /*! {{startIndex, endIndex, waypoint1, waypoint2,...},{startIndex, endIndex,
    * waypoint1, waypoint2,...}, ....*/
-  elementEncode<uint16_t>(startIndex, tempTotalLen, tempPtr);
-  uint8_t *tempTempPtr = tempPtr;
-
-  elementEncode<uint16_t>(endIndex, tempTotalLen, tempPtr);
-  uint16_t i = 0;
-  for (i = startIndex; (tempTotalLen < 200) && i < mission.size(); ++i) {
-    WaypointV2Internal wp = mission[i];
+  elementEncode<uint16_t>(chunkStartIndex, tempTotalLen, tempPtr);
+  uint8_t *endIndexPtr = tempPtr;
+
+  elementEncode<uint16_t>(chunkStartIndex, tempTotalLen, tempPtr);
+  size_t i = 0;
+  for (i = startIndex; (tempTotalLen < missionChunkLen) && i < mission.size(); ++i) {
+    WaypointV2Internal wp =
+      transformWaypoint2WaypointInternal(mission[i], mission[0], cosRefLatitude);
     elementEncode<float32_t>(wp.positionX, tempTotalLen, tempPtr);
     elementEncode<float32_t>(wp.positionY, tempTotalLen, tempPtr);
     elementEncode<float32_t>(wp.positionZ, tempTotalLen, tempPtr);
@@ -127,13 +151,9 @@ bool missionEncode(const std::vector<WaypointV2Internal> &mission, uint8_t *push
     }
   }
   len = tempTotalLen;
-  endIndex = i - 1;
-  startIndex = endIndex + 1;
-  memcpy(tempTempPtr, &endIndex, sizeof(endIndex));
-  if (endIndex >= mission.size() - 1) {
-    finished = true;
-  }
-  return finished;
+  uint16_t endIndex = (uint16_t)(i - 1);
+  memcpy(endIndexPtr, &endIndex, sizeof(endIndex));
+  return i;
 }
 
 bool missionDecode(std::vector<WaypointV2Internal> &mission, uint8_t *const pullPtr,
@@ -208,30 +228,6 @@ std::vector<WaypointV2> transformMisssionInternal2Mission(std::vector<WaypointV2
   return mission;
 }
 
-std::vector<WaypointV2Internal> transformMission2MisssionInternal(std::vector<WaypointV2> &mission)
-{
-  std::vector<WaypointV2Internal> missionInternal;
-  for (auto waypointV2:mission)
-  {
-    WaypointV2Internal waypointV2Internal;
-    waypointV2Internal.positionX = (waypointV2.longitude - mission[0].longitude) * EARTH_RADIUS *cos(mission[0].latitude);
-    waypointV2Internal.positionY = (waypointV2.latitude - mission[0].latitude) * EARTH_RADIUS;
-    waypointV2Internal.positionZ = waypointV2.relativeHeight;
-    waypointV2Internal.waypointType    = waypointV2.waypointType ;
-    waypointV2Internal.headingMode     = waypointV2.headingMode;
-    waypointV2Internal.config          = waypointV2.config;
-    waypointV2Internal.dampingDistance = waypointV2.dampingDistance;
-    waypointV2Internal.heading         = waypointV2.heading;
-    waypointV2Internal.turnMode        = waypointV2.turnMode;
-    waypointV2Internal.pointOfInterest = waypointV2.pointOfInterest;
-    waypointV2Internal.maxFlightSpeed  = uint16_t (waypointV2.maxFlightSpeed *100);
-    waypointV2Internal.autoFlightSpeed = uint16_t (waypointV2.autoFlightSpeed *100);
-    missionInternal.push_back(waypointV2Internal);
-  }
-  return missionInternal;
-
-}
-
 void actuatorTypeCameraEncode(const DJIWaypointV2CameraActuatorParam &actuatorCameraPtr, uint16_t &tempTotalLen, uint8_t *&tempPtr)
 {
   /*! function id*/
@@ -350,16 +346,16 @@ void triggerEncode(const DJIWaypointV2Trigger &trigger, uint16_t &tempTotalLen,
   }
 }
 
-bool ActionsEncode(std::vector<DJIWaypointV2Action> &actions,
-                   uint8_t *pushPtr, uint16_t &len) {
-  uint16_t i;
-  bool finished = false;
+/*! Encodes the actions from startIndex on into one upload chunk.
+ *  @return index of the first action left for the next chunk */
+size_t actionsChunkEncode(const std::vector<DJIWaypointV2Action> &actions,
+                          size_t startIndex, uint8_t *pushPtr, uint16_t &len) {
+  size_t i;
   uint16_t tempTotalLen = 0;
   uint8_t *tempPtr = pushPtr;
 
-  static uint16_t startIndex = 0;
-  for (i = startIndex; (i < actions.size()) && (tempTotalLen < 100); ++i) {
-    DJIWaypointV2Action action = actions[i];
+  for (i = startIndex; (i < actions.size()) && (tempTotalLen < actionChunkLen); ++i) {
+    const DJIWaypointV2Action &action = actions[i];
 
     /*! actionId*/
     elementEncode<uint16_t>(action.actionId, tempTotalLen, tempPtr);
@@ -369,15 +365,9 @@ bool ActionsEncode(std::vector<DJIWaypointV2Action> &actions,
 
     /*! actuator*/
     actuatorEncode(action.actuator, tempTotalLen, tempPtr);
-
-    len = tempTotalLen;
-  }
-  startIndex = i;
-  if (startIndex >= actions.size() - 1) {
-    finished = true;
-    startIndex = 0;
   }
-  return finished;
+  len = tempTotalLen;
+  return i;
 }
 
 T_CmdInfo setCmdInfoDefault(Vehicle *vehicle, const uint8_t cmd[],
@@ -396,6 +386,241 @@ T_CmdInfo setCmdInfoDefault(Vehicle *vehicle, const uint8_t cmd[],
   return cmdInfo;
 }
 
+namespace
+{
+
+/*! Keeps up to `size` upload chunks waiting for their ACK. Each chunk takes
+ *  one of the window's slots, its ACK callback gives the slot back. */
+class UploadWindow
+{
+public:
+  UploadWindow(Vehicle *vehicle, uint8_t size, uint32_t itemsTotal,
+               WaypointV2MissionOperator::UploadProgressCallback callback,
+               void *userData)
+    : vehicle(vehicle), size(size), ready(false),
+      error(ErrorCode::SysCommonErr::Success), startMs(0),
+      itemsTotal(itemsTotal), itemsAcked(0), bytesAcked(0), inFlight(0),
+      itemsReported(0), callback(callback), userData(userData)
+  {
+    memset(slots, 0, sizeof(slots));
+    for (uint8_t i = 0; i < WaypointV2MissionOperator::MAX_UPLOAD_WINDOW; i++)
+    {
+      slots[i].window = this;
+    }
+    if (OsdkOsal_MutexCreate(&mutex) != OSDK_STAT_OK)
+    {
+      return;
+    }
+    if (OsdkOsal_SemaphoreCreate(&freeSlots, size) != OSDK_STAT_OK)
+    {
+      OsdkOsal_MutexDestroy(mutex);
+      return;
+    }
+    OsdkOsal_GetTimeMs(&startMs);
+    ready = true;
+  }
+
+  ~UploadWindow()
+  {
+    if (ready)
+    {
+      OsdkOsal_SemaphoreDestroy(freeSlots);
+      OsdkOsal_MutexDestroy(mutex);
+    }
+  }
+
+  /*! Sends one chunk as soon as a slot is free.
+   *  @return false once a chunk failed or no slot came free in time, nothing
+   *  is sent after that */
+  bool send(const uint8_t cmd[], const uint8_t *data, uint16_t len,
+            uint16_t items, int timeout)
+  {
+    if (!ready)
+    {
+      return false;
+    }
+    if (!waitSlot(timeout))
+    {
+      return false;
+    }
+    report();
+
+    OsdkOsal_MutexLock(mutex);
+    if (error != ErrorCode::SysCommonErr::Success)
+    {
+      OsdkOsal_MutexUnlock(mutex);
+      OsdkOsal_SemaphorePost(freeSlots);
+      return false;
+    }
+    Slot *slot = slots;
+    while (slot->busy)
+    {
+      slot++;
+    }
+    slot->busy  = true;
+    slot->len   = len;
+    slot->items = items;
+    inFlight++;
+    OsdkOsal_MutexUnlock(mutex);
+
+    /*! The linker copies the chunk, the caller's buffer is free again */
+    T_CmdInfo cmdInfo = setCmdInfoDefault(vehicle, cmd, len);
+    vehicle->linker->sendAsync(&cmdInfo, data, ackCallback, slot,
+                               timeout * 1000 / SEND_RETRIES, SEND_RETRIES);
+    return true;
+  }
+
+  /*! Waits for the chunks still in flight.
+   *  @return the first error any chunk ran into */
+  ErrorCode::ErrorCodeType finish(
+    WaypointV2MissionOperator::UploadProgress &progress, int timeout)
+  {
+    if (!ready)
+    {
+      return ErrorCode::SysCommonErr::AllocMemoryFailed;
+    }
+    for (uint8_t i = 0; i < size; i++)
+    {
+      if (!waitSlot(timeout))
+      {
+        break;
+      }
+      report();
+    }
+    progress = snapshot();
+    return error;
+  }
+
+private:
+  static const int SEND_RETRIES = 4;
+
+  /*! A slot comes back at the latest when the linker gave up all tries of
+   *  its chunk; longer means the ACKs stopped, fails the upload */
+  bool waitSlot(int timeout)
+  {
+    uint32_t waitMs = (uint32_t)(timeout * 1000 / SEND_RETRIES) * SEND_RETRIES;
+    if (OsdkOsal_SemaphoreTimedWait(freeSlots, waitMs) == OSDK_STAT_OK)
+    {
+      return true;
+    }
+    OsdkOsal_MutexLock(mutex);
+    if (error == ErrorCode::SysCommonErr::Success)
+    {
+      error = ErrorCode::SysCommonErr::ReqTimeout;
+    }
+    OsdkOsal_MutexUnlock(mutex);
+    return false;
+  }
+
+  typedef struct Slot
+  {
+    UploadWindow *window;
+    bool          busy;
+    uint16_t      len;
+    uint16_t      items;
+  } Slot;
+
+  static void ackCallback(const T_CmdInfo *cmdInfo, const uint8_t *cmdData,
+                          void *userData, E_OsdkStat cb_type)
+  {
+    Slot         *slot   = (Slot *)userData;
+    UploadWindow *window = slot->window;
+
+    ErrorCode::ErrorCodeType ret = getWP2LinkerErrorCode(cb_type);
+    if (ret == ErrorCode::SysCommonErr::Success)
+    {
+      /*! Mission and action ACKs both start with the uint32_t result */
+      WaypointV2CommonAck result = 0;
+      if (cmdInfo && cmdData && cmdInfo->dataLen >= sizeof(RetCodeType))
+      {
+        memcpy(&result, cmdData,
+               cmdInfo->dataLen < sizeof(result) ? cmdInfo->dataLen
+                                                 : sizeof(result));
+        if (result != 0)
+        {
+          ret = ErrorCode::getErrorCode(ErrorCode::MissionV2Module,
+                                        ErrorCode::MissionV2Common, result);
+        }
+      }
+      else
+      {
+        ret = ErrorCode::SysCommonErr::UnpackDataMismatch;
+      }
+    }
+
+    OsdkOsal_MutexLock(window->mutex);
+    if (ret == ErrorCode::SysCommonErr::Success)
+    {
+      window->itemsAcked += slot->items;
+      window->bytesAcked += slot->len;
+    }
+    else if (window->error == ErrorCode::SysCommonErr::Success)
+    {
+      window->error = ret;
+    }
+    slot->busy = false;
+    window->inFlight--;
+    OsdkOsal_MutexUnlock(window->mutex);
+
+    OsdkOsal_SemaphorePost(window->freeSlots);
+  }
+
+  WaypointV2MissionOperator::UploadProgress snapshot()
+  {
+    WaypointV2MissionOperator::UploadProgress progress;
+    uint32_t nowMs = startMs;
+    OsdkOsal_GetTimeMs(&nowMs);
+
+    OsdkOsal_MutexLock(mutex);
+    progress.itemsTotal     = itemsTotal;
+    progress.itemsAcked     = itemsAcked;
+    progress.bytesAcked     = bytesAcked;
+    progress.chunksInFlight = inFlight;
+    OsdkOsal_MutexUnlock(mutex);
+
+    progress.elapsedMs      = nowMs - startMs;
+    progress.bytesPerSecond =
+      progress.elapsedMs ? (uint32_t)((uint64_t)progress.bytesAcked * 1000 /
+                                      progress.elapsedMs)
+                         : 0;
+    return progress;
+  }
+
+  /*! Runs the progress callback on the uploading thread, never on the
+   *  linker's */
+  void report()
+  {
+    if (!callback)
+    {
+      return;
+    }
+    WaypointV2MissionOperator::UploadProgress progress = snapshot();
+    if (progress.itemsAcked != itemsReported)
+    {
+      itemsReported = progress.itemsAcked;
+      callback(progress, userData);
+    }
+  }
+
+  Vehicle                  *vehicle;
+  uint8_t                   size;
+  bool                      ready;
+  T_OsdkMutexHandle         mutex;
+  T_OsdkSemHandle           freeSlots;
+  Slot                      slots[WaypointV2MissionOperator::MAX_UPLOAD_WINDOW];
+  ErrorCode::ErrorCodeType  error;
+  uint32_t                  startMs;
+  uint32_t                  itemsTotal;
+  uint32_t                  itemsAcked;
+  uint32_t                  bytesAcked;
+  uint8_t                   inFlight;
+  uint32_t                  itemsReported;
+  WaypointV2MissionOperator::UploadProgressCallback callback;
+  void                     *userData;
+};
+
+} // namespace
+
 E_OsdkStat updateMissionState(T_CmdHandle *cmdHandle, const T_CmdInfo *cmdInfo,
                               const uint8_t *cmdData, void *userData) {
 
@@ -540,6 +765,10 @@ WaypointV2MissionOperator::WaypointV2MissionOperator(Vehicle *vehiclePtr) {
   this->vehiclePtr = vehiclePtr;
   currentState = DJIWaypointV2MissionStateUnWaypointActionActuatorknown;
   prevState = DJIWaypointV2MissionStateUnWaypointActionActuatorknown;
+  uploadWindow = 1;
+  uploadProgressCallback = NULL;
+  uploadProgressUserData = NULL;
+  memset(&lastUploadProgress, 0, sizeof(lastUploadProgress));
 //  RegisterMissionStateCallback(vehiclePtr, this);
 //  RegisterMissionEventCallback();
   RegisterOSDInfoCallback(vehiclePtr);
@@ -626,41 +855,34 @@ ErrorCode::ErrorCodeType WaypointV2MissionOperator::downloadInitSetting(WayPoint
 
 ErrorCode::ErrorCodeType WaypointV2MissionOperator::uploadMission(
   int timeout) {
-  std::vector<WaypointV2Internal> mission = transformMission2MisssionInternal(this->missionV2);
-
-  uint16_t dataLengthSinglePush = 0;
-  bool finished = false;
-  while (!finished) {
-    void *waypointPushPtr = malloc(400);
-    finished = missionEncode(mission, (uint8_t *) waypointPushPtr,
-                             dataLengthSinglePush);
-    T_CmdInfo ackInfo = {0};
-    RetCodeType ackData[1024] = {0};
-
-    T_CmdInfo cmdInfo =
-      setCmdInfoDefault(vehiclePtr, V1ProtocolCMD::waypointV2::waypointUploadV2,
-                        dataLengthSinglePush);
-
-    E_OsdkStat linkAck =
-      vehiclePtr->linker->sendSync(&cmdInfo, (uint8_t *)waypointPushPtr, &ackInfo,
-                                   ackData, timeout * 1000 / 4, 4);
-    ErrorCode::ErrorCodeType ret = getWP2LinkerErrorCode(linkAck);
-    free(waypointPushPtr);
+  /*! Chunks address waypoints with uint16_t indexes */
+  if (missionV2.empty()) {
+    DERROR("No mission to upload, call init() with 2 or more waypoints first");
+    return ErrorCode::SysCommonErr::ReqNotSupported;
+  }
+  if (missionV2.size() > 0xFFFF) {
+    DERROR("Mission has %d waypoints, at most 65535 can be uploaded",
+           (int)missionV2.size());
+    return ErrorCode::SysCommonErr::ReqNotSupported;
+  }
 
-    if (ret != ErrorCode::SysCommonErr::Success) {
-      return ret;
-    }
-    if (ackInfo.dataLen >= sizeof(RetCodeType)) {
-      auto *ackCode = (UploadMissionRawAck *)ackData;
-      if (ackCode->result != 0)
-        return ErrorCode::getErrorCode(ErrorCode::MissionV2Module,
-                                       ErrorCode::MissionV2Common,
-                                       ackCode->result);
-    } else {
-      return ErrorCode::SysCommonErr::UnpackDataMismatch;
+  UploadWindow window(vehiclePtr, uploadWindow, missionV2.size(),
+                      uploadProgressCallback, uploadProgressUserData);
+  float64_t cosRefLatitude = cos(missionV2[0].latitude);
+  uint8_t waypointPushBuf[uploadChunkBufferLen];
+  size_t nextIndex = 0;
+  while (nextIndex < missionV2.size()) {
+    uint16_t dataLengthSinglePush = 0;
+    size_t startIndex = nextIndex;
+    nextIndex = missionChunkEncode(missionV2, startIndex, cosRefLatitude,
+                                   waypointPushBuf, dataLengthSinglePush);
+    if (!window.send(V1ProtocolCMD::waypointV2::waypointUploadV2,
+                     waypointPushBuf, dataLengthSinglePush,
+                     nextIndex - startIndex, timeout)) {
+      break;
     }
   }
-  return ErrorCode::SysCommonErr::Success;
+  return window.finish(lastUploadProgress, timeout);
 }
 
 ErrorCode::ErrorCodeType WaypointV2MissionOperator::downloadMission(
@@ -746,39 +968,38 @@ ErrorCode::ErrorCodeType WaypointV2MissionOperator::uploadAction(
   std::vector<DJIWaypointV2Action> &actions, int timeout) {
   if (actions.size() == 0) {
     DERROR("Action number is zero, please reset actions vector");
-  } else {
-    bool finished = false;
-    E_OsdkStat linkAck;
-    while (!finished) {
-      uint16_t dataLen = 0;
-      void *actionsPushPtr = malloc(400);
-      T_CmdInfo ackInfo = {0};
-      RetCodeType ackData[1024];
-
-      finished = ActionsEncode(actions, (uint8_t *) actionsPushPtr, dataLen);
-      T_CmdInfo cmdInfo = setCmdInfoDefault(
-          vehiclePtr, V1ProtocolCMD::waypointV2::waypointUploadActionV2, dataLen);
-
-      linkAck = vehiclePtr->linker->sendSync(&cmdInfo, (uint8_t *)actionsPushPtr, &ackInfo,
-                                 ackData, timeout * 1000 / 4, 4);
-      free(actionsPushPtr);
-      ErrorCode::ErrorCodeType ret = getWP2LinkerErrorCode(linkAck);
-
-      if (ret != ErrorCode::SysCommonErr::Success) {
-        return ret;
-      }
-      if (ackInfo.dataLen >= sizeof(RetCodeType)) {
-        auto *ackCode = (UploadActionsRawAck *)ackData;
-        if (ackCode->result != 0)
-          return ErrorCode::getErrorCode(ErrorCode::MissionV2Module,
-                                         ErrorCode::MissionV2Common,
-                                         ackCode->result);
-      } else {
-        return ErrorCode::SysCommonErr::UnpackDataMismatch;
-      }
+    return ErrorCode::SysCommonErr::Success;
+  }
+
+  UploadWindow window(vehiclePtr, uploadWindow, actions.size(),
+                      uploadProgressCallback, uploadProgressUserData);
+  uint8_t actionsPushBuf[uploadChunkBufferLen];
+  size_t nextIndex = 0;
+  while (nextIndex < actions.size()) {
+    uint16_t dataLen = 0;
+    size_t startIndex = nextIndex;
+    nextIndex = actionsChunkEncode(actions, startIndex, actionsPushBuf, dataLen);
+    if (!window.send(V1ProtocolCMD::waypointV2::waypointUploadActionV2,
+                     actionsPushBuf, dataLen, nextIndex - startIndex, timeout)) {
+      break;
     }
   }
-  return ErrorCode::SysCommonErr::Success;
+  return window.finish(lastUploadProgress, timeout);
+}
+
+void WaypointV2MissionOperator::setUploadWindow(uint8_t window) {
+  if (window < 1) {
+    window = 1;
+  } else if (window > MAX_UPLOAD_WINDOW) {
+    window = MAX_UPLOAD_WINDOW;
+  }
+  uploadWindow = window;
+}
+
+void WaypointV2MissionOperator::setUploadProgressCallback(
+  UploadProgressCallback callback, void *userData) {
+  uploadProgressCallback = callback;
+  uploadProgressUserData = userData;
 }
 
 ErrorCode::ErrorCodeType WaypointV2MissionOperator::getActionRemainMemory(
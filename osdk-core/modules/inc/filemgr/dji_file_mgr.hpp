@@ -45,10 +45,15 @@ class FileMgr {
   FileMgr(Linker *linker, uint8_t type, uint8_t index);
   ~FileMgr();
 
-  typedef void (*FileListReqCBType)(E_OsdkStat ret_code, const FilePackage file_list, void* userData);
+  /*! file_list is shared with the file list cache and later listings */
+  typedef void (*FileListReqCBType)(E_OsdkStat ret_code, FilePackagePtr file_list, void* userData);
   typedef void (*FileDataReqCBType)(E_OsdkStat ret_code, void* userData);
 
+  /*! Lists the media files, only the ones added since the last listing are
+   *  fetched from the camera */
   ErrorCode::ErrorCodeType startReqFileList(FileListReqCBType cb, void* userData);
+  /*! The next listing fetches the whole list again */
+  void clearFileListCache();
   ErrorCode::ErrorCodeType startReqFileData(int fileIndex, std::string localPath, FileDataReqCBType cb, void* userData);
 
  private:
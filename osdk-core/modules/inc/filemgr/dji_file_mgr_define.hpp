@@ -5,6 +5,8 @@
 #ifndef DJI_FILE_MGR_DEFINE_HPP
 #define DJI_FILE_MGR_DEFINE_HPP
 
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace DJI {
@@ -300,6 +302,9 @@ struct FilePackage {
   //std::vector<CommonFile> common; //普通文件
 };
 
+/*! A listed package is never changed, every holder shares the same one */
+typedef std::shared_ptr<const FilePackage> FilePackagePtr;
+
 
 }
 }
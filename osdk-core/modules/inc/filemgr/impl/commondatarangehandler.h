@@ -8,8 +8,11 @@
 
 #ifndef commondatarangehandler_h
 #define commondatarangehandler_h
+#include <map>
 #include <vector>
+#include <cstddef>
 #include <cstdint>
+#include <new>
 
 namespace DJI {
 namespace OSDK {
@@ -18,22 +21,96 @@ struct Range {
     uint32_t length;
 };
 
+// Nodes given back by a map, handed out again for the next one. Only
+// single nodes of one size are kept.
+struct RangeNodePool {
+    size_t nodeSize = 0;
+    std::vector<void *> nodes;
+
+    ~RangeNodePool() {
+        for (size_t i = 0; i < nodes.size(); i++) {
+            ::operator delete(nodes[i]);
+        }
+    }
+};
+
+template <typename T>
+class RangeNodeAllocator {
+public:
+    typedef T value_type;
+
+    explicit RangeNodeAllocator(RangeNodePool *pool) : m_pool(pool) {}
+
+    template <typename U>
+    RangeNodeAllocator(const RangeNodeAllocator<U> &other) : m_pool(other.m_pool) {}
+
+    T *allocate(size_t n) {
+        if (n == 1 && m_pool->nodeSize == sizeof(T) && !m_pool->nodes.empty()) {
+            void *node = m_pool->nodes.back();
+            m_pool->nodes.pop_back();
+            return static_cast<T *>(node);
+        }
+        return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T *p, size_t n) {
+        if (n == 1 && (m_pool->nodeSize == 0 || m_pool->nodeSize == sizeof(T))) {
+            m_pool->nodeSize = sizeof(T);
+            m_pool->nodes.push_back(p);
+            return;
+        }
+        ::operator delete(p);
+    }
+
+    template <typename U>
+    bool operator==(const RangeNodeAllocator<U> &other) const { return m_pool == other.m_pool; }
+    template <typename U>
+    bool operator!=(const RangeNodeAllocator<U> &other) const { return m_pool != other.m_pool; }
+
+    RangeNodePool *m_pool;
+};
+
 class CommonDataRangeHandler final {
 public:
+    CommonDataRangeHandler();
+    CommonDataRangeHandler(const CommonDataRangeHandler &) = delete;
+    CommonDataRangeHandler &operator=(const CommonDataRangeHandler &) = delete;
+
     void DeInit();
     // seqNum: 收到包seq
     // confirmSeq: 确认收到最大连续包seq
     // bufSize: 缓存buf的大小
-    void AddSeqIndex(uint32_t seqNum, uint32_t confirmSeq, uint32_t bufSize);
+    // O(log n) in the number of missing ranges
+    // 返回false：超出缓存范围或已经收到过
+    bool AddSeqIndex(uint32_t seqNum, uint32_t confirmSeq, uint32_t bufSize);
 
     bool IsResentAllNeeded();
 
-    std::vector<Range>& GetNoAckRanges();
+    // Every seq below GetLastNotReceiveSeq() has been received
+    bool IsAllReceived() const;
+
+    size_t GetNoAckRangeCount() const;
+
+    uint32_t GetNoAckSeqCount() const;
+
+    // Copies up to maxCount missing ranges, lowest seq first.
+    // Returns the number of ranges copied.
+    size_t GetNoAckRanges(Range *ranges, size_t maxCount) const;
 
     uint32_t GetLastNotReceiveSeq();
 
 private:
-    std::vector<Range> m_noAckRanges;
+    typedef std::map<uint32_t, uint32_t, std::less<uint32_t>,
+                     RangeNodeAllocator<std::pair<const uint32_t, uint32_t> > > RangeMap;
+
+    // Every reordered pack splits or fills a range, reuse the nodes instead
+    // of going to the heap each time. Declared before the map it serves.
+    RangeNodePool m_nodePool;
+    // Missing ranges keyed by their last seq, the value is their first seq.
+    // Retransmissions mostly fill a range from its front, which then only
+    // updates the value.
+    RangeMap m_noAckRanges;
+    uint32_t m_noAckSeqCount = 0;
     uint32_t m_lastNotReceivedSeq = 0;
     bool m_is_resent_all = false;
 };
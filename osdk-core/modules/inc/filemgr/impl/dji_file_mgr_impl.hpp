@@ -36,6 +36,9 @@
 #include <unistd.h>
 #include <memory>
 #include <atomic>
+#include <deque>
+#include <mutex>
+#include <set>
 #include "dji_error.hpp"
 #include "osdk_command.h"
 #include "dji_file_mgr_internal_define.hpp"
@@ -43,7 +46,10 @@
 #include "downloadbufferqueue.h"
 #include "dji_file_mgr_define.hpp"
 #include "dji_file_mgr.hpp"
-#include "mmap_file_buffer.hpp"
+#include "pwrite_file_buffer.hpp"
+#include "download_progress.hpp"
+#include "file_list_cache.hpp"
+#include "file_transfer_monitor.hpp"
 
 #if 0
 #include "commondatarangehandler.h"
@@ -73,19 +79,72 @@ class DownloadListHandler {
   FileMgr::FileListReqCBType reqCB;
   void* reqCBUserData;
   std::atomic<int> downloadState;
-  std::atomic<uint32_t> updateTimeMs;
+  FileTransferMonitor monitor;
+  uint32_t monitorSession;
+  std::atomic<bool> lastPackReceived;
+  FileListCache cache;
+  /*! file index the request starts at */
+  uint32_t startIndex;
+  /*! set by the receive path when the files listed do not continue the
+   *  cached list, until the monitor task asked for the whole storage */
+  std::atomic<bool> relist;
 };
 
 class DownloadDataHandler {
  public:
+  /*! Data received between two saves of the progress, what a crash costs */
+  static const uint64_t CHECKPOINT_BYTES = 8 * 1024 * 1024;
+
   DownloadDataHandler();
   ~DownloadDataHandler();
  public:
   CommonDataRangeHandler *range_handler_;
-  MmapFileBuffer *mmap_file_buffer_;
+  PwriteFileBuffer *file_buffer_;
   FileMgr::FileDataReqCBType reqCB;
   void* reqCBUserData;
-  std::atomic<uint32_t> updateTimeMs;
+  FileTransferMonitor monitor;
+  uint32_t monitorSession;
+  std::atomic<bool> lastPackReceived;
+  /*! set by whichever of the receive path and the monitor task ends the
+   *  download first; finishDue until the monitor task completed it with
+   *  finishStatus */
+  std::atomic<bool> finishing;
+  std::atomic<bool> finishDue;
+  E_OsdkStat finishStatus;
+  /*! file data bytes of every pack but the last, 0 until one arrived; the
+   *  last pack waits in pendingLastPack if it came before */
+  uint32_t packDataLen;
+  uint32_t pendingLastSeq;
+  std::vector<uint8_t> pendingLastPack;
+  DownloadProgress progress;
+  /*! received bytes when the last checkpoint was asked for; checkpointDue
+   *  is set by the receive path until the monitor task saved it */
+  uint64_t checkpointBytes;
+  std::atomic<bool> checkpointDue;
+  /*! byte range the current request asked for, length 0 for the whole file
+   *  while its size is unknown; segments holds the ranges still to ask for */
+  uint64_t segmentOffset;
+  uint64_t segmentLength;
+  /*! lengths of the ranges asked for before in this download, which
+   *  startReqFileData() keeps apart */
+  std::set<uint64_t> previousLengths;
+  std::deque<DownloadProgress::Segment> segments;
+  /*! set by the receive path when the current range is complete, until the
+   *  monitor task got the camera to send the next one */
+  std::atomic<bool> segmentDone;
+  /*! packs are dropped until the seq 0 pack answering the current request,
+   *  those of the ranges before may still be on the way */
+  std::atomic<bool> waitFirstPack;
+  /*! set by the receive path when the camera did not send the range asked
+   *  for, until the monitor task started over with the whole file */
+  std::atomic<bool> wholeFile;
+  /*! set by the receive path when the seq 0 pack of a range before came
+   *  after the current one started, so a late copy of its request reached
+   *  the camera; until the monitor task asked for the current range again */
+  std::atomic<bool> rangeLost;
+  /*! held by the receive path while it takes in a pack and by the monitor
+   *  task while it moves to the next range */
+  std::mutex packMutex;
   std::string downloadPath;
   std::atomic<int> downloadState;
   std::atomic<int> curTargetFileIndex;
@@ -97,6 +156,7 @@ class FileMgrImpl {
   ~FileMgrImpl();
 
   ErrorCode::ErrorCodeType startReqFileList(FileMgr::FileListReqCBType cb, void* userData);
+  void clearFileListCache();
   ErrorCode::ErrorCodeType startReqFileData(int fileIndex, std::string localPath, FileMgr::FileDataReqCBType cb, void* userData);
 
   void HandlePushPack(dji_general_transfer_msg_ack *rsp);
@@ -119,13 +179,23 @@ class FileMgrImpl {
  private:
   //typedef void (*FileDataReqCBType)(E_OsdkStat ret_code, dji_general_transfer_msg_ack* ackData);
   //static void internalFileDataReqCB(E_OsdkStat ret_code, void *userData);
+  /*! View of the next consumSize bytes of a pooled block, index is the
+   *  number of bytes actually available */
   typedef struct ConsumeDataBuffer {
-    uint8_t data[1024];
+    const uint8_t *data;
     uint16_t index;
   } ConsumeDataBuffer;
-  ConsumeDataBuffer ConsumeChunk(DataPointer data_pointer, size_t &chunk_index, size_t consumSize);
-  FilePackage parseFileList(std::list<DataPointer> fullDataList);
-  bool parseFileData(dji_general_transfer_msg_ack *rsp);
+  ConsumeDataBuffer ConsumeChunk(const DataPointer &data_pointer, size_t &chunk_index, size_t consumSize);
+  void parseFileList(const std::vector<DataPointer> &fullDataList, FilePackage &pack);
+  E_OsdkStat parseFileData(dji_general_transfer_msg_ack *rsp);
+  E_OsdkStat takeFileDataPack(dji_general_transfer_msg_ack *rsp, bool &finished);
+  E_OsdkStat writeFileData(uint32_t seq, const uint8_t *data, uint32_t length);
+  void finishFileData(E_OsdkStat ret);
+  void completeFileData();
+  void beginFileDataSegment(bool waitFirstPack);
+  bool restartFileData();
+  E_OsdkStat checkpointFileData();
+  void beginFileList(uint32_t startIndex);
 
  private:
   void OnReceiveAbortPack(dji_general_transfer_msg_ack *rsp);
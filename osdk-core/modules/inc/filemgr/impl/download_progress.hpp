@@ -0,0 +1,131 @@
+/** @file download_progress.hpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief Persisted progress of a file download, to resume it
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+#ifndef DJI_DOWNLOAD_PROGRESS_HPP
+#define DJI_DOWNLOAD_PROGRESS_HPP
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "osdk_platform.h"
+
+namespace DJI {
+namespace OSDK {
+
+/*! @brief What part of a file made it to disk, kept in a file next to it.
+ *
+ *  The byte ranges received are recorded together with a checksum of every
+ *  CHUNK_SIZE bytes of the file. The checksum weighs each 8 byte word by its
+ *  position and adds them up, so it does not matter in which order or in
+ *  which pieces the data arrived; bytes not received yet read as 0 and add
+ *  nothing. That makes every chunk checkable against the file on disk: when
+ *  a download is resumed, a chunk that does not match (the process died
+ *  before the data recorded was written, or after data not recorded yet
+ *  was) is dropped and fetched again; when it completes, the whole file is
+ *  read back and checked.
+ *
+ *  save() is only valid after the data added is on disk, see
+ *  PwriteFileBuffer::flush(). While data keeps arriving, take a snapshot()
+ *  before the flush and save that.
+ */
+class DownloadProgress {
+ public:
+  static const uint32_t CHUNK_SIZE = 1024 * 1024;
+  /*! Gaps between missing ranges smaller than this are fetched again rather
+   *  than paid for with a request each */
+  static const uint32_t MERGE_GAP = 64 * 1024;
+
+  typedef struct Segment {
+    uint64_t offset;
+    uint64_t length;
+  } Segment;
+
+  /*! The progress file as of snapshot(), empty before the size is known */
+  typedef struct Snapshot {
+    uint32_t generation;
+    std::vector<uint8_t> data;
+  } Snapshot;
+
+  DownloadProgress();
+  ~DownloadProgress();
+
+  DownloadProgress(const DownloadProgress &other) = delete;
+  DownloadProgress &operator=(const DownloadProgress &other) = delete;
+
+  /*! Starts over for fileIndex downloaded to path; an earlier progress file
+   *  is removed */
+  void reset(const std::string &path, int fileIndex);
+  /*! Loads the progress of fileIndex saved for path and checks the partial
+   *  file against it.
+   *  @return false if there is nothing to resume */
+  bool load(const std::string &path, int fileIndex);
+  bool save();
+  Snapshot snapshot();
+  /*! Not saved if reset(), load() or remove() came after the snapshot */
+  bool save(const Snapshot &saved);
+  void remove();
+
+  void setFileSize(uint64_t fileSize);
+  uint64_t getFileSize();
+  uint64_t getReceivedBytes();
+  /*! Records length bytes of data written at offset */
+  void add(uint64_t offset, const uint8_t *data, uint32_t length);
+  /*! Byte ranges still to fetch, lowest first */
+  std::vector<Segment> getMissing();
+  /*! Reads the whole file back; chunks that do not match are dropped.
+   *  @return true if the file is complete and every chunk matched */
+  bool verify();
+
+ private:
+  static uint64_t checksum(uint64_t offset, const uint8_t *data,
+                           uint32_t length);
+  bool checkChunks();
+  void addRange(uint64_t start, uint64_t end);
+  void removeRange(uint64_t start, uint64_t end);
+  std::string getProgressPath() const;
+
+  T_OsdkMutexHandle mutex;
+  /*! one save at a time, they share the temporary file */
+  T_OsdkMutexHandle saveMutex;
+  /*! counts reset(), load() and remove() */
+  uint32_t generation;
+  std::string path;
+  int fileIndex;
+  uint64_t fileSize;
+  uint64_t receivedBytes;
+  /*! start -> end of every byte range received, disjoint and not adjacent */
+  std::map<uint64_t, uint64_t> received;
+  std::vector<uint64_t> chunkSums;
+};
+
+}  // namespace OSDK
+}  // namespace DJI
+
+#endif  // DJI_DOWNLOAD_PROGRESS_HPP
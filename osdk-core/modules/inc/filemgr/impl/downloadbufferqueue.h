@@ -14,6 +14,7 @@
 #include <list>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 namespace DJI {
 namespace OSDK {
@@ -33,43 +34,64 @@ public:
     INSERT_FAIL_UNKOWN,
   } InsertRetType;
 
+    // 单包最大长度，即一帧V1数据的最大负载
+    static const uint32_t DEFAULT_BLOCK_LENGTH = 1024;
+    // 缓存池每次扩容的块数
+    static const int BLOCKS_PER_SLAB = 64;
+
     DownloadBufferQueue() = default;
-    virtual ~DownloadBufferQueue() = default;
+    virtual ~DownloadBufferQueue() { Dealloc(); }
 
     DownloadBufferQueue(const DownloadBufferQueue& other) = delete;
     DownloadBufferQueue(DownloadBufferQueue&& other) = delete;
     DownloadBufferQueue& operator=(const DownloadBufferQueue& other) = delete;
     DownloadBufferQueue& operator=(DownloadBufferQueue&& other) = delete;
 
-    bool InitBufferQueue(int size, int start_index);
+    // 重新初始化后，之前取出的块全部失效
+    bool InitBufferQueue(int size, int start_index,
+                         uint32_t block_length = DEFAULT_BLOCK_LENGTH);
 
     bool FindBlockByIndex(int index);
+    // 数据只拷贝一次，拷进缓存池里的块，不再单独malloc
     InsertRetType InsertBlock(const uint8_t *data, uint32_t data_length, int index, bool flag);
 
+    // 取出的是缓存池里块的视图，用完需 ReleaseBuffer 归还
     DataPointer DequeueBuffer();
-    std::list<DataPointer> DequeueAllBuffer();
+    // 把连续收到的块依次追加到 views，返回追加的个数
+    size_t DequeueAllBuffer(std::vector<DataPointer>& views);
+    void ReleaseBuffer(const DataPointer& view);
+    void ReleaseBuffer(const std::vector<DataPointer>& views);
     int GetConfirmSeq();
     int GetBufMaxSeq();
     int GetSize() {
         return m_size;
     };
+    // 缓存池目前占用的块数（含空闲块）
+    size_t GetPoolBlockCount();
 
     void Clear();
     void Dealloc();
 
 private:
+    uint8_t* AllocBlock();
+
     mutable std::mutex m_mutex;
     std::condition_variable m_data_condition;
     DataPointer* m_queue_ptr = nullptr;
 
     // 确认收到并缓存最大index
-    int m_buf_max_index;
+    int m_buf_max_index = -1;
     // 期待接受的index， 即确认收到连续序列index + 1
-    int m_expect_index;
+    int m_expect_index = 0;
     // 期待接受的index对应的Buf数组下标
-    int m_head;
+    int m_head = 0;
     // Buffer 的大小
-    int m_size;
+    int m_size = 0;
+
+    // 缓存池：按 BLOCKS_PER_SLAB 块一次分配，归还的块放入空闲表复用
+    uint32_t m_block_length = DEFAULT_BLOCK_LENGTH;
+    std::vector<std::unique_ptr<uint8_t[]> > m_slabs;
+    std::vector<uint8_t*> m_free_blocks;
 };
 }  // namespace OSDK
 
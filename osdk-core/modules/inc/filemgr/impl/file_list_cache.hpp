@@ -0,0 +1,82 @@
+/** @file file_list_cache.hpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief Media file lists of a camera kept between listings
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+#ifndef DJI_FILE_LIST_CACHE_HPP
+#define DJI_FILE_LIST_CACHE_HPP
+
+#include <stdint.h>
+#include "dji_file_mgr_define.hpp"
+#include "osdk_platform.h"
+
+namespace DJI {
+namespace OSDK {
+
+/*! @brief The last media list of a camera, of the storage it lists by
+ *  default (drive 0); FileMgr has no way to ask for another one.
+ *
+ *  The camera lists files in index order and a new file always gets an
+ *  index above the ones before it, so a list is brought up to date by
+ *  asking for the files from the last one listed on. That file has to come
+ *  back first and unchanged, which is how the card is recognised: after a
+ *  card was swapped or formatted it is gone or differs, and the storage is
+ *  listed again from the first file.
+ *
+ *  Files deleted other than through a swap or a format are not noticed,
+ *  clear() drops the lists for that.
+ */
+class FileListCache {
+ public:
+  /*! Index the camera starts a list of the whole storage at */
+  static const uint32_t FIRST_FILE_INDEX = 1;
+
+  FileListCache();
+  ~FileListCache();
+
+  FileListCache(const FileListCache &other) = delete;
+  FileListCache &operator=(const FileListCache &other) = delete;
+
+  /*! Index to list from, FIRST_FILE_INDEX if nothing is cached */
+  uint32_t getStartIndex();
+  /*! Takes the files listed from startIndex on into the list.
+   *  @return the list now cached, NULL if listed does not continue it */
+  FilePackagePtr update(uint32_t startIndex, FilePackage &listed);
+  void clear();
+
+ private:
+  static bool isSameFile(const MediaFile &a, const MediaFile &b);
+
+  T_OsdkMutexHandle mutex;
+  /*! NULL while nothing is cached */
+  FilePackagePtr list;
+};
+
+}  // namespace OSDK
+}  // namespace DJI
+
+#endif  // DJI_FILE_LIST_CACHE_HPP
@@ -0,0 +1,154 @@
+/** @file file_transfer_monitor.hpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief Retransmission timing of one file list or file data transfer
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef DJI_FILE_TRANSFER_MONITOR_HPP
+#define DJI_FILE_TRANSFER_MONITOR_HPP
+
+#include <stdint.h>
+#include "commondatarangehandler.h"
+#include "osdk_platform.h"
+
+namespace DJI {
+namespace OSDK {
+
+/*! @brief Decides when a transfer asks for missing packs again, resends its
+ *  request or gives up.
+ *
+ *  The receive path reports every pack with onPack(), which wakes the
+ *  monitor task when a new gap opens so it is asked for right away. Packs
+ *  that were asked for and are still missing are asked for again after the
+ *  retransmission timeout, derived like TCP's from the round trips measured
+ *  between a request and the pack it brings (RFC 6298, Karn's rule). Once
+ *  the link has shown loss, a quiet link is probed after two round trips
+ *  instead, as the missing packs are then more likely the lost tail of the
+ *  transfer than a slow peer. The range handler is only touched under the
+ *  monitor's lock.
+ */
+class FileTransferMonitor {
+ public:
+  typedef enum Action {
+    ACTION_NONE,
+    /*! nothing arrived yet, the request itself may have been lost, or the
+     *  NACKs stopped bringing anything */
+    ACTION_RESEND_REQUEST,
+    /*! ask for the missing ranges, see getMissingRanges() */
+    ACTION_SEND_NACK,
+    /*! the peer stopped answering */
+    ACTION_ABORT,
+  } Action;
+
+  typedef struct Stats {
+    uint32_t srttMs;
+    uint32_t rttVarMs;
+    uint32_t rtoMs;
+    uint32_t packs;
+    uint32_t duplicatePacks;
+    /*! seqs found missing when their successors arrived */
+    uint32_t gapSeqs;
+    uint32_t nacks;
+    uint32_t requests;
+    /*! payload bytes of distinct packs */
+    uint64_t bytes;
+    /*! 0 until the peer told the size */
+    uint64_t totalBytes;
+  } Stats;
+
+  /*! Used until the first round trip is measured */
+  static const uint32_t INITIAL_RTO_MS = 1000;
+  static const uint32_t MIN_RTO_MS = 20;
+  static const uint32_t MAX_RTO_MS = 2000;
+  /*! Time without any pack before the transfer is aborted */
+  static const uint32_t SILENT_ABORT_MS = 6000;
+  /*! NACKs in a row answered by no pack before the request goes out again;
+   *  the peer may be serving another range, e.g. after a late copy of an
+   *  earlier request reached it */
+  static const uint32_t RESEND_AFTER_NACKS = 4;
+  /*! Ranges one NACK may carry */
+  static const size_t MAX_NACK_RANGES = 32;
+
+  FileTransferMonitor();
+  ~FileTransferMonitor();
+
+  FileTransferMonitor(const FileTransferMonitor &other) = delete;
+  FileTransferMonitor &operator=(const FileTransferMonitor &other) = delete;
+
+  /*! Starts a transfer tracked by ranges, whose request went out at nowMs.
+   *  @return the session, which the monitor task passes to isSession() */
+  uint32_t start(CommonDataRangeHandler *ranges, uint32_t nowMs);
+  bool isSession(uint32_t session);
+  void setTotalBytes(uint64_t totalBytes);
+
+  /*! Adds seq to the range handler, see CommonDataRangeHandler::AddSeqIndex
+   *  for confirmSeq and bufSize.
+   *  @return false if the pack was received before */
+  bool onPack(uint32_t seq, uint32_t confirmSeq, uint32_t bufSize,
+              uint32_t bytes, uint32_t nowMs);
+  /*! Wakes the monitor task, e.g. when the transfer ended */
+  void notify();
+
+  /*! Blocks the monitor task until there is something to do */
+  void wait(uint32_t nowMs);
+  /*! @return what to do now; ACTION_RESEND_REQUEST and ACTION_SEND_NACK
+   *  count as sent at nowMs */
+  Action poll(uint32_t nowMs);
+
+  /*! Missing ranges to put in a NACK, lowest first.
+   *  @param expectSeq first seq not received yet */
+  size_t getMissingRanges(Range *ranges, size_t maxCount, uint32_t &expectSeq);
+
+  Stats getStats();
+
+ private:
+  uint32_t quietTimeoutMs() const;
+  uint32_t nextTimeoutMs(uint32_t nowMs) const;
+  void sampleRtt(uint32_t rttMs);
+
+  T_OsdkMutexHandle mutex;
+  T_OsdkSemHandle wakeup;
+  CommonDataRangeHandler *ranges;
+  uint32_t session;
+  Stats stats;
+
+  bool rttMeasured;
+  /*! when the last request or NACK went out, and the lowest seq it asked
+   *  for; a NACK asked for every gap below nackedBelowSeq */
+  uint32_t requestMs;
+  uint32_t sampleSeq;
+  bool sampleValid;
+  uint32_t nackedBelowSeq;
+  bool nackDue;
+  bool anyPack;
+  uint32_t lastPackMs;
+  /*! requests and NACKs in a row no pack came after */
+  uint32_t silentTimeouts;
+};
+
+}  // namespace OSDK
+}  // namespace DJI
+
+#endif  // DJI_FILE_TRANSFER_MONITOR_HPP
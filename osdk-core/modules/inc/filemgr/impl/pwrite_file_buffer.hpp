@@ -0,0 +1,119 @@
+/** @file pwrite_file_buffer.hpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief Positional write-behind sink for downloaded file data
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef DJI_PWRITE_FILE_BUFFER_HPP
+#define DJI_PWRITE_FILE_BUFFER_HPP
+
+#include <stdint.h>
+#include <deque>
+#include <string>
+#include <vector>
+#include "osdk_platform.h"
+
+namespace DJI {
+namespace OSDK {
+
+/*! @brief Writes file data at its byte offset with pwrite(2).
+ *
+ *  Contiguous data is gathered into one of BUFFER_COUNT buffers and written
+ *  by the writer task once the buffer is full or the data jumps elsewhere, so
+ *  the receive thread only copies. When the disk is slower than the link,
+ *  write() waits for a buffer to come back, which keeps memory at
+ *  BUFFER_COUNT * BUFFER_SIZE whatever the size of the file.
+ *
+ *  The first error is kept: every later call fails, and getError() returns
+ *  its errno until the next open().
+ */
+class PwriteFileBuffer {
+ public:
+  static const uint32_t BUFFER_SIZE = 256 * 1024;
+  static const uint32_t BUFFER_COUNT = 4;
+
+  PwriteFileBuffer();
+  ~PwriteFileBuffer();
+
+  PwriteFileBuffer(const PwriteFileBuffer &other) = delete;
+  PwriteFileBuffer &operator=(const PwriteFileBuffer &other) = delete;
+
+  /*! Creates path; an existing file is truncated, or kept as it is to
+   *  resume a download into it */
+  bool open(const std::string &path, bool truncate = true);
+  /*! Reserves the blocks of the whole file, so that a full disk fails the
+   *  download here instead of part way */
+  bool setFileSize(uint64_t fileSize);
+  bool write(uint64_t offset, const uint8_t *data, uint32_t length);
+  /*! Returns once everything written so far is in the file, and on the
+   *  disk after fdatasync(2) if sync. write() only waits for the buffers
+   *  in flight, not for the disk. */
+  bool flush(bool sync);
+  /*! Writes out what is still buffered and closes the file, after fsync(2)
+   *  if sync. Also fails if an earlier write did. */
+  bool close(bool sync);
+
+  bool isOpen();
+  /*! errno of the first failure, 0 if none */
+  int getError();
+
+ private:
+  typedef struct Buffer {
+    uint64_t offset;
+    uint32_t length;
+    uint8_t *data;
+  } Buffer;
+
+  Buffer *acquire();
+  void submit();
+  void drain();
+  void setError(int error);
+  static void *writerTask(void *arg);
+
+  /*! mutex guards the buffer lists, fd and error; callMutex keeps the
+   *  receive thread and the monitor task from closing under each other;
+   *  syncMutex keeps the fd open while flush() syncs it, taken first */
+  T_OsdkMutexHandle mutex;
+  T_OsdkMutexHandle callMutex;
+  T_OsdkMutexHandle syncMutex;
+  /*! counts full buffers for the writer task, and free ones for write() */
+  T_OsdkSemHandle fullSem;
+  T_OsdkSemHandle freeSem;
+  T_OsdkTaskHandle writer;
+  bool stopping;
+
+  int fd;
+  int error;
+  Buffer buffers[BUFFER_COUNT];
+  std::vector<Buffer *> freeBuffers;
+  std::deque<Buffer *> fullBuffers;
+  /*! the buffer write() gathers into, only touched by its caller */
+  Buffer *filling;
+};
+
+}  // namespace OSDK
+}  // namespace DJI
+
+#endif  // DJI_PWRITE_FILE_BUFFER_HPP
@@ -51,11 +51,12 @@ class MopClient : MopPipelineManagerBase {
    * DJI::OSDK::MOP::PipelineID
    *  @param type The pipeline type. It can be set to be RELIABLE or UBRELIABLE
    *  ref to the enum DJI::OSDK::MOP::PipelineType
-   *  @param p The pointer of pipeline. If success, it will be pointed to be the
-   *  target pipeline object.
+   *  @param p The pipeline. If success, it will be pointed to be the target
+   *  pipeline object, which stays valid while p is held; once closed its
+   *  calls fail.
    *  @return ref to the enum DJI::OSDK::MOP::MopErrCode
    */
-  MopErrCode connect(PipelineID id, PipelineType type, MopPipeline *&p);
+  MopErrCode connect(PipelineID id, PipelineType type, MopPipelinePtr &p);
 
   /*! @brief Connect the target device by a pipelineid with properties of
    * pipeline type. If success, a pipeline object will be created.
@@ -29,6 +29,7 @@
 #ifndef DJI_MOP_DEFINE_HPP
 #define DJI_MOP_DEFINE_HPP
 
+#include "mop.h"
 #include "mop_entry_osdk.h"
 #include "dji_log.hpp"
 
@@ -79,6 +80,27 @@ typedef uint16_t PipelineID;
 
 MopErrCode getMopErrCode(int ret);
 
+/*! The MOP channel calls pipelines are made of, return values as of mop.h */
+typedef struct MopChannelOps {
+  int32_t (*create)(mop_channel_handle_t *handle, mop_trans_t trans);
+  int32_t (*destroy)(mop_channel_handle_t handle);
+  int32_t (*bind)(mop_channel_handle_t handle, uint16_t id);
+  int32_t (*connect)(mop_channel_handle_t handle, mop_device_t device,
+                     uint8_t slot, uint16_t id);
+  int32_t (*accept)(mop_channel_handle_t handle,
+                    mop_channel_handle_t *outHandle);
+  int32_t (*read)(mop_channel_handle_t handle, void *buf, uint32_t length);
+  int32_t (*write)(mop_channel_handle_t handle, void *buf, uint32_t length);
+  int32_t (*close)(mop_channel_handle_t handle);
+} MopChannelOps;
+
+/*! @brief Replaces the MOP channel calls of the linker, e.g. with a loopback
+ *  to run pipelines without a device. Only while no pipeline exists.
+ *  @param ops the calls to use, NULL for the linker's again
+ */
+void setMopChannelOps(const MopChannelOps *ops);
+const MopChannelOps &getMopChannelOps();
+
 }
 }
 }
@@ -30,6 +30,8 @@
 #define DJI_MOP_PIPELINE_HPP
 
 #include <stdint.h>
+#include <memory>
+#include <mutex>
 #include "dji_mop_define.hpp"
 
 using namespace DJI::OSDK;
@@ -39,6 +41,10 @@ namespace DJI {
 namespace OSDK {
 
 /*! @brief Class providing APIs & data structures MOP pipeline operations
+ *
+ *  Closing a pipeline wakes the calls blocking on it; its channels are
+ *  destroyed once the last of them returned, and the object lives as long
+ *  as someone holds it.
  */
 class MopPipeline {
  public:
@@ -57,16 +63,44 @@ class MopPipeline {
 
   MopErrCode recvData(DataPackType dataPacket, uint32_t *len);
 
-  void *channelHandle;
-
   PipelineID getId();
 
   PipelineType getType();
  private:
+  friend class MopPipelineManagerBase;
+  friend class MopClient;
+  friend class MopServer;
+
+  /*! Hands a channel created for the pipeline over to it.
+   *  @param bind true for the channel a server accepts on
+   *  @return false if the pipeline was closed meanwhile, the caller still
+   *  owns the channel then */
+  bool attach(void *handle, bool bind);
+  /*! The channel, or the bind one, for a call on it; endCall() when it
+   *  returned. NULL once closed. */
+  void *beginCall(bool bind);
+  void endCall();
+  /*! Closes the channels, waking calls blocking on them; the last of them
+   *  to return destroys the channels. Does nothing the second time.
+   *  @return what closing the channel gave */
+  int32_t closeChannels();
+  /*! Called locked */
+  void destroyChannels();
+
   PipelineID id;
   PipelineType type;
+  std::mutex mutex;
+  void *channelHandle;
+  /*! channel a server accepted this pipeline on, NULL for a client's */
+  void *bindHandle;
+  uint32_t calls;
+  bool closed;
 
 };
+
+/*! Shared by whoever uses the pipeline and its client or server */
+typedef std::shared_ptr<MopPipeline> MopPipelinePtr;
+
 }  // namespace OSDK
 }  // namespace DJI
 
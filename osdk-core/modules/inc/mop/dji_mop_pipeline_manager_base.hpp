@@ -32,30 +32,88 @@
 #include "dji_mop_define.hpp"
 #include "dji_mop_pipeline.hpp"
 #include "dji_log.hpp"
+#include "dji_singleton.hpp"
 #include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 using namespace DJI::OSDK;
 using namespace DJI::OSDK::MOP;
 
 using namespace std;
 
-/*! TODO:ugly code, will be fixed in the future */
-extern map<PipelineID, MopPipeline*> pipelineMap;
-
 namespace DJI {
 namespace OSDK {
+
+class MopPipelineManagerBase;
+
+/*! @brief The pipelines of all MOP clients and servers of the process, an
+ *  id is taken by one pipeline at a time.
+ *
+ *  A pipeline is registered as soon as its connect or accept starts and is
+ *  open once that succeeded. Only the manager that made it closes it, which
+ *  it does after unregistering it, outside the registry lock. A connect or
+ *  accept still running then finds its calls failing and the pipeline gone.
+ */
+class MopPipelineRegistry : public Singleton<MopPipelineRegistry> {
+ public:
+  MopPipelineRegistry();
+  ~MopPipelineRegistry();
+
+  /*! @return MOP_RESOCCUPIED if id is taken */
+  MopErrCode add(PipelineID id, PipelineType type,
+                 const MopPipelineManagerBase *owner,
+                 MopPipelinePtr &pipeline);
+  /*! Marks pipeline open.
+   *  @return false if it was removed in the meantime */
+  bool open(PipelineID id, const MopPipeline *pipeline);
+  bool contains(PipelineID id, const MopPipeline *pipeline);
+  /*! Unregisters the pipeline of id if owner made it, the caller closes it.
+   *  @param opened set if it was open, otherwise its connect or accept is
+   *  still running
+   *  @return the pipeline, NULL if there is none of owner */
+  MopPipelinePtr remove(PipelineID id, const MopPipelineManagerBase *owner,
+                        bool &opened);
+  /*! Unregisters pipeline if it still is the one of id.
+   *  @return false if it was removed already */
+  bool remove(PipelineID id, const MopPipeline *pipeline);
+  /*! Unregisters every pipeline of owner and returns them to be closed */
+  std::vector<MopPipelinePtr> removeAll(const MopPipelineManagerBase *owner);
+  size_t size();
+
+  /*! The MOP background task runs while any client or server exists */
+  void retainMopTask();
+  void releaseMopTask();
+
+ private:
+  typedef struct Entry {
+    MopPipelinePtr pipeline;
+    const MopPipelineManagerBase *owner;
+    bool opened;
+  } Entry;
+
+  std::mutex mutex;
+  std::map<PipelineID, Entry> pipelines;
+  uint32_t mopTaskUsers;
+};
+
 class MopPipelineManagerBase {
  public:
   MopPipelineManagerBase();
 
+  /*! Closes the pipelines this manager made */
   ~MopPipelineManagerBase();
 
+ protected:
   /*! TODO:MSDK 单单create的这种写法指代不明,在这个接口加上了"Pipeline"后缀 */
-  MopErrCode create(PipelineID id, MopPipeline *&p);
+  MopErrCode create(PipelineID id, PipelineType type,
+                    MopPipelinePtr &p);
 
   /*! TODO:MSDK 单单create的这种写法指代不明,在这个接口加上了"Pipeline"后缀 */
   MopErrCode destroy(PipelineID id);
 
+  static mop_trans_t getTransType(PipelineType type);
 };
 }  // namespace OSDK
 }  // namespace DJI
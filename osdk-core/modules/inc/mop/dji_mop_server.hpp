@@ -53,11 +53,12 @@ class MopServer : MopPipelineManagerBase {
    * DJI::OSDK::MOP::PipelineID
    *  @param type The pipeline type. It can be set to be RELIABLE or UBRELIABLE
    *  ref to the enum DJI::OSDK::MOP::PipelineType
-   *  @param p The pointer of pipeline. If success, it will be pointed to be the
-   *  target pipeline object.
+   *  @param p The pipeline. If success, it will be pointed to be the target
+   *  pipeline object, which stays valid while p is held; once closed its
+   *  calls fail.
    *  @return ref to the enum DJI::OSDK::MOP::MopErrCode
    */
-  MopErrCode accept(PipelineID id, PipelineType type, MopPipeline *&p);
+  MopErrCode accept(PipelineID id, PipelineType type, MopPipelinePtr &p);
 
   /*! @brief Close the target pipeline by a pipelineid.
    *  @note This is a blocking api
@@ -52,6 +52,10 @@ ErrorCode::ErrorCodeType FileMgr::startReqFileList(FileListReqCBType cb, void* u
   return impl->startReqFileList(cb, userData);
 }
 
+void FileMgr::clearFileListCache() {
+  impl->clearFileListCache();
+}
+
 ErrorCode::ErrorCodeType FileMgr::startReqFileData(int fileIndex, std::string localPath, FileDataReqCBType cb, void* userData) {
   return impl->startReqFileData(fileIndex, localPath, cb, userData);
 }
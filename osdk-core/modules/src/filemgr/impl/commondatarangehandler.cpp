@@ -10,8 +10,30 @@
 
 namespace DJI {
 namespace OSDK {
-std::vector<Range>& CommonDataRangeHandler::GetNoAckRanges() {
-    return m_noAckRanges;
+CommonDataRangeHandler::CommonDataRangeHandler()
+    : m_noAckRanges(std::less<uint32_t>(), RangeMap::allocator_type(&m_nodePool)) {
+}
+
+bool CommonDataRangeHandler::IsAllReceived() const {
+    return m_noAckRanges.empty();
+}
+
+size_t CommonDataRangeHandler::GetNoAckRangeCount() const {
+    return m_noAckRanges.size();
+}
+
+uint32_t CommonDataRangeHandler::GetNoAckSeqCount() const {
+    return m_noAckSeqCount;
+}
+
+size_t CommonDataRangeHandler::GetNoAckRanges(Range *ranges, size_t maxCount) const {
+    size_t count = 0;
+    for (auto range = m_noAckRanges.begin(); range != m_noAckRanges.end() && count < maxCount; ++range) {
+        ranges[count].seq_num = range->second;
+        ranges[count].length = range->first - range->second + 1;
+        count++;
+    }
+    return count;
 }
 
 uint32_t CommonDataRangeHandler::GetLastNotReceiveSeq() {
@@ -24,62 +46,53 @@ bool CommonDataRangeHandler::IsResentAllNeeded() {
 
 void CommonDataRangeHandler::DeInit() {
   m_noAckRanges.clear();
+  m_noAckSeqCount = 0;
   m_lastNotReceivedSeq = 0;
   m_is_resent_all = false;
 }
 
-void CommonDataRangeHandler::AddSeqIndex(uint32_t seqNum, uint32_t confirmSeq, uint32_t bufSize) {
-    do {
-        if (seqNum > confirmSeq + bufSize) {
-            // Logic should not go to here, because buffering seq will return false if (seqNum > confirmSeq + bufSize)
-            break;
-        } else {
-            if (seqNum == m_lastNotReceivedSeq) {
-                m_lastNotReceivedSeq++;
-                break;
-            } else if (seqNum > m_lastNotReceivedSeq) {
-                Range range = {m_lastNotReceivedSeq, seqNum - m_lastNotReceivedSeq};
-                m_noAckRanges.push_back(range);
-                m_lastNotReceivedSeq = seqNum + 1;
-                break;
-            } else {
-                // 小于当前期待收包seq，看是否在需要重传range之中
-                for (auto&& range = m_noAckRanges.begin(); range < m_noAckRanges.end(); ++range) {
-                    if (seqNum < range->seq_num) {
-                        // 小于当前Range最小值，直接忽略
-                        continue;
-                    } else if (range->seq_num == seqNum) {
-                        // 等于当前Range最小值
-                        if (range->length <= 1) {
-                            m_noAckRanges.erase(range);
-                            break;
-                        }
-                        range->seq_num = seqNum + 1;
-                        range->length = range->length - 1;
-                        break;
-                    } else if (seqNum > range->seq_num && seqNum < range->seq_num + range->length - 1) {
-                        // 在当前Range中间位置，拆分为两个Range
-                        Range rangeLeft = {range->seq_num, seqNum - range->seq_num};
-                        Range rangeRight = {seqNum + 1, range->seq_num + range->length - seqNum - 1};
-                        *range = rangeLeft;
-                        m_noAckRanges.insert(range, rangeRight);
-                        break;
-                    } else if (range->seq_num + range->length - 1 == seqNum) {
-                        // 等于当前Range最大值
-                        if (range->length <= 1) {
-                            m_noAckRanges.erase(range);
-                            break;
-                        }
-                        range->length = range->length - 1;
-                        break;
-                    } else {
-                        // 大于当前Range
-                        continue;
-                    }
-                }
-            }
-        }
-    } while (false);
+bool CommonDataRangeHandler::AddSeqIndex(uint32_t seqNum, uint32_t confirmSeq, uint32_t bufSize) {
+    if (seqNum > confirmSeq + bufSize) {
+        // Logic should not go to here, because buffering seq will return false if (seqNum > confirmSeq + bufSize)
+        return false;
+    }
+
+    if (seqNum == m_lastNotReceivedSeq) {
+        m_lastNotReceivedSeq++;
+        return true;
+    } else if (seqNum > m_lastNotReceivedSeq) {
+        // 新的缺口总在最后
+        m_noAckRanges.emplace_hint(m_noAckRanges.end(), seqNum - 1, m_lastNotReceivedSeq);
+        m_noAckSeqCount += seqNum - m_lastNotReceivedSeq;
+        m_lastNotReceivedSeq = seqNum + 1;
+        return true;
+    }
+
+    // 小于当前期待收包seq，看是否在需要重传range之中
+    auto range = m_noAckRanges.lower_bound(seqNum);
+    if (range == m_noAckRanges.end() || seqNum < range->second) {
+        // 已经收到过
+        return false;
+    }
+
+    uint32_t first = range->second;
+    uint32_t last = range->first;
+    m_noAckSeqCount--;
+    if (first == last) {
+        m_noAckRanges.erase(range);
+    } else if (seqNum == first) {
+        // 等于当前Range最小值
+        range->second = seqNum + 1;
+    } else if (seqNum == last) {
+        // 等于当前Range最大值
+        auto next = m_noAckRanges.erase(range);
+        m_noAckRanges.emplace_hint(next, seqNum - 1, first);
+    } else {
+        // 在当前Range中间位置，拆分为两个Range
+        range->second = seqNum + 1;
+        m_noAckRanges.emplace_hint(range, seqNum - 1, first);
+    }
+    return true;
 }
 }  // namespace OSDK
 
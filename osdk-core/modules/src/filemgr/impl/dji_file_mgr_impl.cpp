@@ -26,6 +26,7 @@
  *
  */
 
+#include <algorithm>
 #include "dji_file_mgr_impl.hpp"
 #include "dji_linker.hpp"
 #include "dji_linker.hpp"
@@ -98,53 +99,66 @@ E_OsdkStat downloadFileAckCB(struct _CommandHandle *cmdHandle,
 }
 
 void FileMgrImpl::printFileDownloadStatus() {
-    uint32_t lossPackCnt = 0;
-    uint32_t recvPackCnt = 0;
-    for (auto &msg : fileDataHandler->range_handler_->GetNoAckRanges()) {
-      lossPackCnt += msg.length;
-    }
-    recvPackCnt = fileDataHandler->range_handler_->GetLastNotReceiveSeq() - lossPackCnt;
-    DSTATUS("\033[0;32m[Complete rate : %0.1f%%] (recv:%dpacks loss:%dpacks) \033[0m",
-            (recvPackCnt * 800 * 100.0f / fileDataHandler->mmap_file_buffer_->fdAddrSize),
-            recvPackCnt, lossPackCnt);
+  FileTransferMonitor::Stats stats = fileDataHandler->monitor.getStats();
+  uint64_t fileSize = fileDataHandler->progress.getFileSize();
+  float rate = fileSize ? fileDataHandler->progress.getReceivedBytes() * 100.0f / fileSize : 0.0f;
+  DSTATUS("\033[0;32m[Complete rate : %0.1f%%] (recv:%dpacks gap:%dpacks dup:%dpacks nack:%d rtt:%dms) \033[0m",
+          rate, stats.packs - stats.duplicatePacks, stats.gapSeqs,
+          stats.duplicatePacks, stats.nacks, stats.srttMs);
 }
 
 void FileMgrImpl::fileListMonitorTask(void *arg) {
   DSTATUS("OSDK download monitor task created.");
   if(arg) {
     uint32_t curTimeMs = 0;
-    uint32_t preTimeMs = 0;
-    uint32_t pollTimeMsInterval = 500;
-    uint32_t taskTimeOutMs = 6000;
     FileMgrImpl *impl = (FileMgrImpl *)arg;
-    OsdkOsal_GetTimeMs(&curTimeMs);
-    impl->fileListHandler->updateTimeMs = curTimeMs;
+    DownloadListHandler *handler = impl->fileListHandler;
+    uint32_t session = handler->monitorSession;
     for (;;)
     {
-      uint32_t refreshTimeMs = impl->fileListHandler->updateTimeMs;
+      /*! Sleeps until a gap opens, a timeout is due or the transfer ended */
       OsdkOsal_GetTimeMs(&curTimeMs);
+      handler->monitor.wait(curTimeMs);
+      if (handler->downloadState != RECVING_FILE_LIST
+          || !handler->monitor.isSession(session)) return;
+
+      /*! Asked for here, the receive path cannot wait for the camera's ack.
+       *  The list before was complete or aborted, nothing of it is to come */
+      if (handler->relist) {
+        impl->beginFileList(FileListCache::FIRST_FILE_INDEX);
+        session = handler->monitorSession;
+        handler->relist = false;
+        impl->SendReqFileListPack();
+        continue;
+      }
 
-      /*! Task timeout */
-      if (curTimeMs - refreshTimeMs >= taskTimeOutMs) {
-        DSTATUS("curTimeMs:%d refreshTimeMs:%d", curTimeMs, refreshTimeMs);
-        DERROR("downloadMonitorTask timeout!! device type : %d index: %d", impl->type, impl->index);
-
-          if (impl->fileListHandler->downloadState == RECVING_FILE_LIST) {
+      OsdkOsal_GetTimeMs(&curTimeMs);
+      switch (handler->monitor.poll(curTimeMs)) {
+        case FileTransferMonitor::ACTION_SEND_NACK:
+          impl->SendMissedAckPack(DJI_GENERAL_DOWNLOAD_FILE_TASK_TYPE_LIST);
+          break;
+        case FileTransferMonitor::ACTION_RESEND_REQUEST:
+          DSTATUS("No file list pack came, request it again");
+          impl->SendReqFileListPack();
+          break;
+        case FileTransferMonitor::ACTION_ABORT:
+          DERROR("downloadMonitorTask timeout!! device type : %d index: %d", impl->type, impl->index);
+          if (handler->downloadState == RECVING_FILE_LIST) {
             impl->SendAbortPack(DJI_GENERAL_DOWNLOAD_FILE_TASK_TYPE_LIST);
-            auto cb = impl->fileListHandler->reqCB;
-            void *udata = impl->fileListHandler->reqCBUserData;
-              FilePackage defaultPack;
-              defaultPack.type = FileType::UNKNOWN;
-              defaultPack.media.clear();
-              if(cb) cb(OSDK_STAT_ERR, defaultPack, udata);
+            /*! Idle before the callback, which may list again right away */
+            auto cb = handler->reqCB;
+            void *udata = handler->reqCBUserData;
+            handler->reqCB = NULL;
             DSTATUS("Finish req filelist task cause of timeout, reset downloadState to be DOWNLOAD_IDLE");
-            impl->fileListHandler->downloadState = DOWNLOAD_IDLE;
+            handler->downloadState = DOWNLOAD_IDLE;
+            std::shared_ptr<FilePackage> defaultPack = std::make_shared<FilePackage>();
+            defaultPack->type = FileType::UNKNOWN;
+            if(cb) cb(OSDK_STAT_ERR, defaultPack, udata);
           }
+          return;
+        default:
+          break;
       }
-
-      if (impl->fileListHandler->downloadState == DOWNLOAD_IDLE) return;
-
-      OsdkOsal_TaskSleepMs(10);
     }
   } else {
     DERROR("task run failed because of the invalid"
@@ -157,53 +171,89 @@ void FileMgrImpl::fileDataMonitorTask(void *arg) {
   DSTATUS("OSDK download filedata monitor task created.");
   if(arg) {
     uint32_t curTimeMs = 0;
-    uint32_t preTimeMs = 0;
-    uint32_t pollTimeMsInterval = 500;
-    uint32_t taskTimeOutMs = 6000;
+    uint32_t statusTimeMs = 0;
+    uint32_t statusTimeMsInterval = 500;
     FileMgrImpl *impl = (FileMgrImpl *)arg;
-    OsdkOsal_GetTimeMs(&curTimeMs);
-    impl->fileDataHandler->updateTimeMs = curTimeMs;
+    DownloadDataHandler *handler = impl->fileDataHandler;
+    uint32_t session = handler->monitorSession;
+    OsdkOsal_GetTimeMs(&statusTimeMs);
     for (;;)
     {
-
-      uint32_t refreshTimeMs = impl->fileDataHandler->updateTimeMs;
+      /*! Sleeps until a gap opens, a timeout is due or the transfer ended */
       OsdkOsal_GetTimeMs(&curTimeMs);
+      handler->monitor.wait(curTimeMs);
+      if (handler->downloadState != RECVING_FILE_DATA
+          || !handler->monitor.isSession(session)) return;
+
+      /*! Ended by the receive path or below; closed here, syncing and
+       *  reading back the file would hold up the receive thread */
+      if (handler->finishDue.exchange(false)) {
+        impl->completeFileData();
+        return;
+      }
 
-      /*! Task timeout */
-      if (curTimeMs - refreshTimeMs >= taskTimeOutMs) {
-        DSTATUS("curTimeMs:%d refreshTimeMs:%d", curTimeMs, refreshTimeMs);
-        DERROR("downloadMonitorTask timeout!! device type : %d index: %d", impl->type, impl->index);
-
-        if (impl->fileDataHandler->downloadState == RECVING_FILE_DATA) {
-          impl->SendAbortPack(DJI_GENERAL_DOWNLOAD_FILE_TASK_TYPE_FILE);
-          auto cb = impl->fileDataHandler->reqCB;
-          void *udata = impl->fileDataHandler->reqCBUserData;
-          if (cb) cb(OSDK_STAT_ERR, udata);
-          DSTATUS("Finish req filedata task cause of timeout, reset downloadState to be DOWNLOAD_IDLE");
-          impl->fileDataHandler->downloadState = DOWNLOAD_IDLE;
+      /*! Synced here, the receive path does not wait for the disk */
+      if (handler->checkpointDue.exchange(false)) {
+        E_OsdkStat ret = impl->checkpointFileData();
+        if (ret != OSDK_STAT_OK) {
+          impl->finishFileData(ret);
+          continue;
         }
-      } else if (curTimeMs - refreshTimeMs >= (taskTimeOutMs * 2 / 3)) {
-        DSTATUS("The second time to wake up the pushing");
-        impl->SendReqFileDataPack(impl->fileDataHandler->curTargetFileIndex);
-      } else if (curTimeMs - refreshTimeMs >= (taskTimeOutMs * 1 / 3)) {
-        DSTATUS("The first time to wake up the pushing");
-        impl->SendReqFileDataPack(impl->fileDataHandler->curTargetFileIndex);
       }
 
-      if (impl->fileDataHandler->downloadState == DOWNLOAD_IDLE) return;
+      /*! Asked for here, the receive path cannot wait for the camera's ack.
+       *  Packs of the last range may still be on the way until it comes. */
+      if (handler->wholeFile) {
+        impl->SendAbortPack(DJI_GENERAL_DOWNLOAD_FILE_TASK_TYPE_FILE);
+        std::unique_lock<std::mutex> lock(handler->packMutex);
+        if (!impl->restartFileData()) {
+          lock.unlock();
+          impl->finishFileData(OSDK_STAT_SYS_ERR);
+          continue;
+        }
+        session = handler->monitorSession;
+        handler->wholeFile = false;
+        lock.unlock();
+        impl->SendReqFileDataPack(handler->curTargetFileIndex);
+        continue;
+      }
+      if (handler->segmentDone) {
+        impl->SendAbortPack(DJI_GENERAL_DOWNLOAD_FILE_TASK_TYPE_FILE);
+        std::unique_lock<std::mutex> lock(handler->packMutex);
+        impl->beginFileDataSegment(true);
+        session = handler->monitorSession;
+        handler->segmentDone = false;
+        lock.unlock();
+        impl->SendReqFileDataPack(handler->curTargetFileIndex);
+        continue;
+      }
+      /*! Packs received of the range are kept, the camera starts it over */
+      if (handler->rangeLost.exchange(false)) {
+        impl->SendReqFileDataPack(handler->curTargetFileIndex);
+        continue;
+      }
 
-      if (curTimeMs - preTimeMs >=  pollTimeMsInterval)
-      {
-        /*! Here to send the miss ack packs*/
-        if (impl->fileDataHandler->downloadState == RECVING_FILE_DATA) {
-          impl->printFileDownloadStatus();
+      OsdkOsal_GetTimeMs(&curTimeMs);
+      switch (handler->monitor.poll(curTimeMs)) {
+        case FileTransferMonitor::ACTION_SEND_NACK:
           impl->SendMissedAckPack(DJI_GENERAL_DOWNLOAD_FILE_TASK_TYPE_FILE);
-        }
-        preTimeMs = curTimeMs;
+          break;
+        case FileTransferMonitor::ACTION_RESEND_REQUEST:
+          DSTATUS("No file data pack came, wake up the pushing");
+          impl->SendReqFileDataPack(handler->curTargetFileIndex);
+          break;
+        case FileTransferMonitor::ACTION_ABORT:
+          DERROR("downloadMonitorTask timeout!! device type : %d index: %d", impl->type, impl->index);
+          impl->finishFileData(OSDK_STAT_ERR_TIMEOUT);
+          continue;
+        default:
+          break;
       }
 
-      /*! TODO: with out sleep 100ms, the time will get the same as last time. */
-      OsdkOsal_TaskSleepMs(10);
+      if (curTimeMs - statusTimeMs >= statusTimeMsInterval) {
+        impl->printFileDownloadStatus();
+        statusTimeMs = curTimeMs;
+      }
     }
   } else {
     DERROR("task run failed because of the invalid"
@@ -260,7 +310,7 @@ ErrorCode::ErrorCodeType FileMgrImpl::SendReqFileListPack() {
 
   dji_file_list_download_req reqData = {0};
   reqData.index.drive = 0;
-  reqData.index.index = 1;
+  reqData.index.index = fileListHandler->startIndex;
   reqData.count = 0xffff;
   reqData.type = DJI_MEDIA;
   uint32_t reqDataLen =
@@ -319,8 +369,13 @@ ErrorCode::ErrorCodeType FileMgrImpl::SendReqFileDataPack(int fileIndex) {
   reqData.count = 1;
   reqData.type = DJI_MEDIA;
   reqData.sub_index = 0;
-  reqData.offset = 0;
-  reqData.size = (uint32_t) (-1);
+  /*! startReqFileData() only resumes ranges that fit; the receive path sets
+   *  the length of the whole file once it learns it */
+  std::unique_lock<std::mutex> lock(fileDataHandler->packMutex);
+  reqData.offset = (uint32_t) fileDataHandler->segmentOffset;
+  reqData.size = fileDataHandler->segmentLength
+                 ? (uint32_t) fileDataHandler->segmentLength : (uint32_t) (-1);
+  lock.unlock();
   uint32_t reqDataLen = sizeof(reqData) - sizeof(reqData.ext_sub_index)
       - sizeof(reqData.seg_sub_index);
   memcpy(setting->data, &reqData, reqDataLen);
@@ -361,14 +416,12 @@ ErrorCode::ErrorCodeType FileMgrImpl::SendReqFileDataPack(int fileIndex) {
 ErrorCode::ErrorCodeType FileMgrImpl::startReqFileList(FileMgr::FileListReqCBType cb, void* userData) {
   //SendAbortPack(DJI_GENERAL_DOWNLOAD_FILE_TASK_TYPE_LIST);
   if (fileListHandler->downloadState == DOWNLOAD_IDLE) {
+    if (!fileListHandler->download_buffer_ || !fileListHandler->range_handler_)
+      return ErrorCode::SysCommonErr::AllocMemoryFailed;
     fileListHandler->downloadState = RECVING_FILE_LIST;
-    if (fileListHandler->download_buffer_) {
-      fileListHandler->download_buffer_->Clear();
-      fileListHandler->download_buffer_->InitBufferQueue(5000, 0); //CSDK 5000
-    } else return ErrorCode::SysCommonErr::AllocMemoryFailed;
-
-    if (fileListHandler->range_handler_) fileListHandler->range_handler_->DeInit();
-    else return ErrorCode::SysCommonErr::AllocMemoryFailed;
+    fileListHandler->relist = false;
+    /*! 已有列表时只拉新增的文件 */
+    beginFileList(fileListHandler->cache.getStartIndex());
 
     /*! Create file list req task*/
     OsdkOsal_TaskCreate(&reqFileListHandle,
@@ -385,27 +438,120 @@ ErrorCode::ErrorCodeType FileMgrImpl::startReqFileList(FileMgr::FileListReqCBTyp
   }
 }
 
+void FileMgrImpl::clearFileListCache() {
+  fileListHandler->cache.clear();
+}
+
+/*! Starts a list request from startIndex, the caller asks for it */
+void FileMgrImpl::beginFileList(uint32_t startIndex) {
+  fileListHandler->startIndex = startIndex;
+  fileListHandler->download_buffer_->Clear();
+  fileListHandler->download_buffer_->InitBufferQueue(5000, 0); //CSDK 5000
+  fileListHandler->range_handler_->DeInit();
+  fileListHandler->lastPackReceived = false;
+
+  uint32_t curMs = 0;
+  OsdkOsal_GetTimeMs(&curMs);
+  fileListHandler->monitorSession =
+      fileListHandler->monitor.start(fileListHandler->range_handler_, curMs);
+}
+
 ErrorCode::ErrorCodeType FileMgrImpl::startReqFileData(int fileIndex, std::string localPath, FileMgr::FileDataReqCBType cb, void* userData) {
   if (fileDataHandler->downloadState == DOWNLOAD_IDLE) {
-    fileDataHandler->downloadState = RECVING_FILE_DATA;
-
     fileDataHandler->downloadPath = localPath;
-    fileDataHandler->mmap_file_buffer_->currentLogFilePath = localPath;
     DSTATUS("currentLogFilePath = %s", localPath.c_str());
+    /*! 断点续传: 只要回上次没收到的部分 */
+    bool resume = fileDataHandler->progress.load(localPath, fileIndex);
+    std::vector<DownloadProgress::Segment> missing;
+    if (resume) missing = fileDataHandler->progress.getMissing();
+    /*! 相机只回请求的长度, 每段请求的长度都不一样, 上一段迟到的首包才认得出来;
+     *  段前面已收到的几个字节再要一次 */
+    std::set<uint64_t> lengths;
+    for (size_t i = 0; resume && i < missing.size(); i++) {
+      uint64_t start = i ? missing[i - 1].offset + missing[i - 1].length : 0;
+      uint64_t end = (i + 1 < missing.size()) ? missing[i + 1].offset
+                                              : fileDataHandler->progress.getFileSize();
+      while (lengths.count(missing[i].length) && missing[i].offset > start) {
+        missing[i].offset--;
+        missing[i].length++;
+      }
+      /*! 前面没有字节可借就往后借 */
+      while (lengths.count(missing[i].length) && missing[i].offset + missing[i].length < end)
+        missing[i].length++;
+      if (lengths.count(missing[i].length)) {
+        DSTATUS("Cannot ask for the ranges missing with distinct lengths, download the whole file");
+        resume = false;
+      }
+      lengths.insert(missing[i].length);
+    }
+    /*! The request has 32 bit offset and size */
+    for (size_t i = 0; resume && i < missing.size(); i++) {
+      if (missing[i].offset > 0xFFFFFFFFULL || missing[i].length > 0xFFFFFFFFULL) {
+        DSTATUS("Cannot ask for %llu bytes at %llu, download the whole file",
+                (unsigned long long)missing[i].length, (unsigned long long)missing[i].offset);
+        resume = false;
+      }
+    }
+    if (!resume) fileDataHandler->progress.reset(localPath, fileIndex);
+    if (!fileDataHandler->file_buffer_->open(localPath, !resume))
+      return ErrorCode::SysCommonErr::InstInitParamInvalid;
+    fileDataHandler->segments.clear();
+    if (resume) {
+      if (!fileDataHandler->file_buffer_->setFileSize(fileDataHandler->progress.getFileSize())) {
+        fileDataHandler->file_buffer_->close(false);
+        return ErrorCode::SysCommonErr::InstInitParamInvalid;
+      }
+      fileDataHandler->segments.assign(missing.begin(), missing.end());
+    } else {
+      DownloadProgress::Segment whole = {0, 0};
+      fileDataHandler->segments.push_back(whole);
+    }
+    /*! Packs already on the way wait until the first range is set up */
+    std::unique_lock<std::mutex> lock(fileDataHandler->packMutex);
+    fileDataHandler->downloadState = RECVING_FILE_DATA;
+    fileDataHandler->segmentDone = false;
+    fileDataHandler->wholeFile = false;
+    fileDataHandler->rangeLost = false;
+    fileDataHandler->finishDue = false;
+    fileDataHandler->checkpointDue = false;
+    fileDataHandler->checkpointBytes = fileDataHandler->progress.getReceivedBytes();
+    fileDataHandler->segmentLength = 0;
+    fileDataHandler->previousLengths.clear();
 
     fileDataHandler->reqCB = cb;
     fileDataHandler->reqCBUserData = userData;
     fileDataHandler->curTargetFileIndex = fileIndex;
 
-    if (fileDataHandler->range_handler_)delete (fileDataHandler->range_handler_);
-    fileDataHandler->range_handler_ = new CommonDataRangeHandler();
-    if (!fileDataHandler->range_handler_) return ErrorCode::SysCommonErr::AllocMemoryFailed;
+    CommonDataRangeHandler *range_handler_ = new CommonDataRangeHandler();
+    if (!range_handler_) return ErrorCode::SysCommonErr::AllocMemoryFailed;
+
+    /*! The monitor lets go of the old ranges before they are deleted */
+    uint32_t curMs = 0;
+    OsdkOsal_GetTimeMs(&curMs);
+    fileDataHandler->lastPackReceived = false;
+    fileDataHandler->monitorSession =
+        fileDataHandler->monitor.start(range_handler_, curMs);
+    if (fileDataHandler->range_handler_) delete (fileDataHandler->range_handler_);
+    fileDataHandler->range_handler_ = range_handler_;
+
+    /*! Packs of the download before are dropped up to here */
+    fileDataHandler->finishing = false;
+
+    /*! A range must be answered as asked before anything is written */
+    bool nothingMissing = fileDataHandler->segments.empty();
+    if (!nothingMissing) beginFileDataSegment(resume);
+    lock.unlock();
+
+    /*! Everything was on disk already, only the check was missing; the
+     *  monitor task does it, not the caller */
+    if (nothingMissing) finishFileData(OSDK_STAT_OK);
 
     /*! Create file data req task*/
     OsdkOsal_TaskCreate(&reqFileDataHandle,
                         (void *(*)(void *)) (&fileDataMonitorTask),
                         OSDK_TASK_STACK_SIZE_DEFAULT, this);
 
+    if (nothingMissing) return ErrorCode::SysCommonErr::Success;
     return SendReqFileDataPack(fileIndex);
   } else {
     DERROR("Current state cannot support to do downloading ...");
@@ -428,10 +574,10 @@ void FileMgrImpl::OnReceiveUrgePack(dji_general_transfer_msg_ack *rsp) {
       range_handler_ = fileDataHandler->range_handler_;
     else return;
 
-    if (range_handler_->GetNoAckRanges().size() == 0)
+    if (range_handler_->IsAllReceived())
       SendAbortPack((DJI_GENERAL_DOWNLOAD_FILE_TASK_TYPE) rsp->task_id);
     else
-      DSTATUS("range_handler_->GetNoAckRanges().size() = %d", range_handler_->GetNoAckRanges().size());
+      DSTATUS("range_handler_->GetNoAckRangeCount() = %d", (int)range_handler_->GetNoAckRangeCount());
       SendMissedAckPack((DJI_GENERAL_DOWNLOAD_FILE_TASK_TYPE) rsp->task_id);
   }
 }
@@ -441,6 +587,15 @@ void FileMgrImpl::OnReceiveAbortPack(dji_general_transfer_msg_ack *rsp) {
   OsdkOsal_GetTimeMs(&curMs);
   DSTATUS("[%d][FileMgr] The request is aborted by the camera: session_id = %d",curMs,
           (int) rsp->session_id);
+  /*! A listing from the last file cached has nothing to start from when the
+   *  storage changed */
+  if (rsp->task_id == DJI_GENERAL_DOWNLOAD_FILE_TASK_TYPE_LIST
+      && fileListHandler->downloadState == RECVING_FILE_LIST
+      && fileListHandler->startIndex != FileListCache::FIRST_FILE_INDEX
+      && !fileListHandler->relist) {
+    fileListHandler->relist = true;
+    fileListHandler->monitor.notify();
+  }
 }
 
 typedef enum ParsingStateEnum {
@@ -452,36 +607,35 @@ typedef enum ParsingStateEnum {
 } ParsingFileListStateEnum, ParsingFileDataStateEnum;
 
 #include "dji_file_mgr_internal_define.hpp"
-FileMgrImpl::ConsumeDataBuffer FileMgrImpl::ConsumeChunk(DataPointer data_pointer, size_t &chunk_index, size_t consumSize) {
-  ConsumeDataBuffer ret = {{0}, 0};
-  if (consumSize > sizeof(ret.data))
-    consumSize = sizeof(ret.data);
-  if (consumSize > data_pointer.length - chunk_index)
+FileMgrImpl::ConsumeDataBuffer FileMgrImpl::ConsumeChunk(const DataPointer &data_pointer, size_t &chunk_index, size_t consumSize) {
+  ConsumeDataBuffer ret = {(const uint8_t *)data_pointer.data + chunk_index, 0};
+  if (chunk_index >= (size_t)data_pointer.length)
+    consumSize = 0;
+  else if (consumSize > data_pointer.length - chunk_index)
     consumSize = data_pointer.length - chunk_index;
-  memcpy(ret.data, (uint8_t *)data_pointer.data + chunk_index, consumSize);
   ret.index = consumSize;
   chunk_index += consumSize;
   return ret;
 }
 
-FilePackage FileMgrImpl::parseFileList(std::list<DataPointer> fullDataList) {
-  static size_t chunk_index = 0;
-  FilePackage pack;
+void FileMgrImpl::parseFileList(const std::vector<DataPointer> &fullDataList, FilePackage &pack) {
+  size_t chunk_index = 0;
   pack.type = FileType::UNKNOWN;
   //pack.common.clear();
   pack.media.clear();
-  if (fullDataList.size() == 0) return pack;
+  if (fullDataList.size() == 0) return;
 
   ParsingFileListStateEnum parsingState = PARSING_TOTAL_HEADER;
-  while (fullDataList.size() != 0) {
-    auto dataPtr = fullDataList.front();
+  size_t dataIndex = 0;
+  while (dataIndex < fullDataList.size()) {
+    const DataPointer &dataPtr = fullDataList[dataIndex];
     switch (parsingState) {
       case PARSING_TOTAL_HEADER: {
         chunk_index = 0;
         uint32_t consumeBytes = sizeof(dji_general_transfer_msg_ack) - sizeof(uint8_t);
         auto buffer = ConsumeChunk(dataPtr, chunk_index, consumeBytes);
         if (buffer.index == consumeBytes) {
-          auto data = (dji_general_transfer_msg_ack *)(buffer.data);
+          auto data = (const dji_general_transfer_msg_ack *)(buffer.data);
           DSTATUS("Unpack datapack seq(%d)", data->seq);
           parsingState = (data->seq == 0) ? PARSING_DATA_HEADER : PARSING_FILEINFO;
         } else {
@@ -493,8 +647,10 @@ FilePackage FileMgrImpl::parseFileList(std::list<DataPointer> fullDataList) {
         uint32_t consumeBytes = sizeof(dji_file_list_download_resp) - sizeof(dji_list_info_descriptor);
         auto buffer = ConsumeChunk(dataPtr, chunk_index, consumeBytes);
         if (buffer.index == consumeBytes) {
-          auto data = (dji_file_list_download_resp *)(buffer.data);
+          auto data = (const dji_file_list_download_resp *)(buffer.data);
           DSTATUS("###data->amount = %d, data->len = %d", data->amount, data->len);
+          /*! no more than a request asks for, whatever the header says */
+          pack.media.reserve(std::min<uint32_t>(data->amount, 0xFFFF));
           parsingState = PARSING_FILEINFO;
         } else {
           parsingState = PARSE_FINISH;
@@ -506,7 +662,7 @@ FilePackage FileMgrImpl::parseFileList(std::list<DataPointer> fullDataList) {
         auto buffer = ConsumeChunk(dataPtr, chunk_index, consumeBytes);
         if (buffer.index == consumeBytes) {
           if (pack.type == FileType::UNKNOWN)pack.type = FileType::MEDIA;
-          auto data = (dji_list_info_descriptor *)(buffer.data);
+          auto data = (const dji_list_info_descriptor *)(buffer.data);
           //DSTATUS("data->index = %d, data->size = %d", data->index, data->size);
           /*! 构建file信息,装入容器 */
           MediaFile file;
@@ -536,8 +692,11 @@ FilePackage FileMgrImpl::parseFileList(std::list<DataPointer> fullDataList) {
           /*! 这部分消耗了就算了,目前不解析 */
           if (data->ext_size) {
             auto extBuffer = ConsumeChunk(dataPtr, chunk_index, data->ext_size);
-            auto extData = (dji_ext_info_descriptor *) (extBuffer.data);
-            DSTATUS("extData->id = %d, %s", extData->id, extData->data);
+            auto extData = (const dji_ext_info_descriptor *) (extBuffer.data);
+            /*! The block is not NUL terminated where the descriptor ends */
+            int extLen = (int) extBuffer.index - (int) sizeof(extData->id);
+            if (extLen > 0)
+              DSTATUS("extData->id = %d, %.*s", extData->id, extLen, extData->data);
           }
           parsingState = PARSING_FILEINFO;
         } else {
@@ -546,35 +705,62 @@ FilePackage FileMgrImpl::parseFileList(std::list<DataPointer> fullDataList) {
         break;
       }
       case PARSE_FINISH:
-        fullDataList.pop_front();
+        dataIndex++;
         parsingState = PARSING_TOTAL_HEADER;
         break;
       default:break;
     }
   }
-  return pack;
 }
 
 #define SIZE_LIMIT 0
-bool FileMgrImpl::parseFileData(dji_general_transfer_msg_ack *rsp) {
+E_OsdkStat FileMgrImpl::parseFileData(dji_general_transfer_msg_ack *rsp) {
+  const uint8_t *data = rsp->data;
+  /*! 1. 本包数据总大小计算 */
+  uint32_t data_size = rsp->msg_length;
+  data_size -= sizeof(dji_general_transfer_msg_ack) - sizeof(uint8_t);
   if (rsp->seq == 0) {
-    /*! 1. 是第一包,parse文件大小 */
+    /*! 2. 是第一包,parse文件大小; 续传时是请求的那一段的大小 */
     auto resp = (dji_file_data_download_resp *) (rsp->data);
-    /*! 2. 文件总大小计算 */
     uint32_t file_size = resp->size - (sizeof(dji_file_data_download_resp) - sizeof(uint8_t));
-    fileDataHandler->mmap_file_buffer_->init(fileDataHandler->downloadPath, file_size);
-    /*! 3. 本包数据总大小计算 */
-    uint32_t data_size = rsp->msg_length;
-    data_size -= sizeof(dji_general_transfer_msg_ack) - sizeof(uint8_t);
+    if (fileDataHandler->segmentLength == 0) {
+      if (!fileDataHandler->file_buffer_->setFileSize(file_size)) return OSDK_STAT_SYS_ERR;
+      fileDataHandler->segmentLength = file_size;
+      fileDataHandler->progress.setFileSize(file_size);
+      fileDataHandler->monitor.setTotalBytes(file_size);
+    } else if (file_size != fileDataHandler->segmentLength) {
+      DERROR("Asked for %llu bytes at %llu, the camera sends %d",
+             (unsigned long long)fileDataHandler->segmentLength,
+             (unsigned long long)fileDataHandler->segmentOffset, file_size);
+      return OSDK_STAT_ERR_OUT_OF_RANGE;
+    }
+    data = resp->file_data;
     data_size -= sizeof(dji_file_data_download_resp) - sizeof(uint8_t);
-    fileDataHandler->mmap_file_buffer_->InsertBlock(resp->file_data, data_size, rsp->seq);
-  } else {
-    /*! 1. 本包数据总大小计算 */
-    uint32_t data_size = rsp->msg_length;
-    data_size -= sizeof(dji_general_transfer_msg_ack) - sizeof(uint8_t);
-    fileDataHandler->mmap_file_buffer_->InsertBlock(rsp->data, data_size, rsp->seq);
   }
 
+  /*! 3. 除最后一包外每包数据一样长，按seq写到文件中的位置 */
+  if (!(rsp->msg_flag & 0x01)) {
+    if (fileDataHandler->packDataLen == 0) {
+      fileDataHandler->packDataLen = data_size;
+      if (!fileDataHandler->pendingLastPack.empty()) {
+        E_OsdkStat ret = writeFileData(fileDataHandler->pendingLastSeq,
+                                       &fileDataHandler->pendingLastPack[0],
+                                       fileDataHandler->pendingLastPack.size());
+        fileDataHandler->pendingLastPack.clear();
+        if (ret != OSDK_STAT_OK) return ret;
+      }
+    } else if (data_size != fileDataHandler->packDataLen) {
+      DERROR("File data pack %d carries %d bytes, expected %d", rsp->seq,
+             data_size, fileDataHandler->packDataLen);
+      return OSDK_STAT_ERR_OUT_OF_RANGE;
+    }
+  } else if (rsp->seq != 0 && fileDataHandler->packDataLen == 0) {
+    fileDataHandler->pendingLastSeq = rsp->seq;
+    fileDataHandler->pendingLastPack.assign(data, data + data_size);
+    return OSDK_STAT_OK;
+  }
+  return writeFileData(rsp->seq, data, data_size);
+
 #if 0
     size_t chunk_index = 0;
   ParsingFileListStateEnum parsingState = PARSING_TOTAL_HEADER;
@@ -651,72 +837,237 @@ bool FileMgrImpl::parseFileData(dji_general_transfer_msg_ack *rsp) {
     }
   }
 #endif
+}
+
+E_OsdkStat FileMgrImpl::writeFileData(uint32_t seq, const uint8_t *data, uint32_t length) {
+  uint64_t offset = (uint64_t)seq * fileDataHandler->packDataLen;
+  if (fileDataHandler->segmentLength && offset + length > fileDataHandler->segmentLength) {
+    DERROR("File data pack %d ends beyond the %llu bytes asked for", seq,
+           (unsigned long long)fileDataHandler->segmentLength);
+    return OSDK_STAT_ERR_OUT_OF_RANGE;
+  }
+  offset += fileDataHandler->segmentOffset;
+  if (!fileDataHandler->file_buffer_->write(offset, data, length)) return OSDK_STAT_SYS_ERR;
+  fileDataHandler->progress.add(offset, data, length);
+  return OSDK_STAT_OK;
+}
+
+/*! Starts the range at the front of segments, the caller asks for it */
+void FileMgrImpl::beginFileDataSegment(bool waitFirstPack) {
+  DownloadProgress::Segment segment = fileDataHandler->segments.front();
+  fileDataHandler->segments.pop_front();
+  if (fileDataHandler->segmentLength)
+    fileDataHandler->previousLengths.insert(fileDataHandler->segmentLength);
+  fileDataHandler->segmentOffset = segment.offset;
+  fileDataHandler->segmentLength = segment.length;
+  fileDataHandler->packDataLen = 0;
+  fileDataHandler->pendingLastPack.clear();
+  fileDataHandler->lastPackReceived = false;
+  fileDataHandler->waitFirstPack = waitFirstPack;
+  fileDataHandler->rangeLost = false;
+  if (segment.length)
+    DSTATUS("Request %llu bytes at %llu of file %d", (unsigned long long)segment.length,
+            (unsigned long long)segment.offset, (int)fileDataHandler->curTargetFileIndex);
+
+  uint32_t curMs = 0;
+  OsdkOsal_GetTimeMs(&curMs);
+  fileDataHandler->range_handler_->DeInit();
+  fileDataHandler->monitorSession =
+      fileDataHandler->monitor.start(fileDataHandler->range_handler_, curMs);
+  fileDataHandler->monitor.setTotalBytes(segment.length);
+}
+
+/*! The camera did not answer a range as asked, so nothing on disk can be
+ *  resumed from: the progress goes and the whole file is fetched again. The
+ *  caller asks for it. */
+bool FileMgrImpl::restartFileData() {
+  DSTATUS("Download file %d again from the start", (int)fileDataHandler->curTargetFileIndex);
+  fileDataHandler->progress.reset(fileDataHandler->downloadPath,
+                                  fileDataHandler->curTargetFileIndex);
+  fileDataHandler->file_buffer_->close(false);
+  if (!fileDataHandler->file_buffer_->open(fileDataHandler->downloadPath, true))
+    return false;
+  fileDataHandler->checkpointDue = false;
+  fileDataHandler->checkpointBytes = 0;
+  fileDataHandler->segments.clear();
+  DownloadProgress::Segment whole = {0, 0};
+  fileDataHandler->segments.push_back(whole);
+  beginFileDataSegment(true);
+  return true;
+}
+
+/*! Data first, so the progress saved never claims more than the file has.
+ *  Packs received meanwhile are in the next checkpoint. */
+E_OsdkStat FileMgrImpl::checkpointFileData() {
+  DownloadProgress::Snapshot saved = fileDataHandler->progress.snapshot();
+  if (!fileDataHandler->file_buffer_->flush(true)) return OSDK_STAT_SYS_ERR;
+  fileDataHandler->progress.save(saved);
+  return OSDK_STAT_OK;
+}
 
-  return false;
+/*! Ends the download once, from the receive path or the monitor task; the
+ *  packs after are dropped and the monitor task completes it */
+void FileMgrImpl::finishFileData(E_OsdkStat ret) {
+  if (fileDataHandler->finishing.exchange(true)) return;
+  fileDataHandler->finishStatus = ret;
+  fileDataHandler->finishDue = true;
+  fileDataHandler->monitor.notify();
+}
+
+/*! The monitor task only. The state goes idle before the callback, which
+ *  may start the next download. */
+void FileMgrImpl::completeFileData() {
+  E_OsdkStat ret = fileDataHandler->finishStatus;
+  SendAbortPack(DJI_GENERAL_DOWNLOAD_FILE_TASK_TYPE_FILE);
+  if (ret == OSDK_STAT_OK) {
+    /*! 收完了才落盘, 再读回来校验; 对不上的部分下次重新下载 */
+    if (!fileDataHandler->file_buffer_->close(true)) {
+      ret = OSDK_STAT_SYS_ERR;
+    } else if (!fileDataHandler->progress.verify()) {
+      DERROR("Downloaded file %s differs from the data received",
+             fileDataHandler->downloadPath.c_str());
+      ret = OSDK_STAT_SYS_ERR;
+    }
+    if (ret == OSDK_STAT_OK) fileDataHandler->progress.remove();
+    else fileDataHandler->progress.save();
+  } else {
+    /*! What is on disk is kept for the next try */
+    if (checkpointFileData() != OSDK_STAT_OK)
+      DERROR("Save download progress of %s failed", fileDataHandler->downloadPath.c_str());
+    fileDataHandler->file_buffer_->close(false);
+  }
+  if (ret != OSDK_STAT_OK)
+    DERROR("Download file %d failed: %d, errno %d", (int)fileDataHandler->curTargetFileIndex,
+           ret, fileDataHandler->file_buffer_->getError());
+
+  auto cb = fileDataHandler->reqCB;
+  fileDataHandler->reqCB = NULL;
+  DSTATUS("Finish req filedata task, reset downloadState to be DOWNLOAD_IDLE");
+  fileDataHandler->downloadState = DOWNLOAD_IDLE;
+  fileDataHandler->monitor.notify();
+  if (cb) cb(ret, fileDataHandler->reqCBUserData);
 }
 
 void FileMgrImpl::fileListRawDataCB(dji_general_transfer_msg_ack *rsp) {
   if (fileListHandler->downloadState == DOWNLOAD_IDLE) return;
+  if (fileListHandler->relist) return;
     auto download_buffer_ = fileListHandler->download_buffer_;
     auto range_handler_ = fileListHandler->range_handler_;
     if (download_buffer_ && range_handler_) {
+      uint32_t curMs = 0;
+      OsdkOsal_GetTimeMs(&curMs);
       download_buffer_->InsertBlock((const uint8_t *) rsp, rsp->msg_length, rsp->seq, true);
-      range_handler_->AddSeqIndex(rsp->seq, download_buffer_->GetConfirmSeq(), download_buffer_->GetSize());
+      fileListHandler->monitor.onPack(rsp->seq, download_buffer_->GetConfirmSeq(),
+                                      download_buffer_->GetSize(),
+                                      rsp->msg_length - (sizeof(dji_general_transfer_msg_ack) - sizeof(uint8_t)),
+                                      curMs);
     }
+    if (rsp->msg_flag & 0x01) fileListHandler->lastPackReceived = true;
 
-    /*! refresh the time stamp */
-    uint32_t curMs = 0;
-    OsdkOsal_GetTimeMs(&curMs);
-    fileListHandler->updateTimeMs = curMs;
-
-    /*! 看看是否拿到了最后一个包 */
+    /*! 最后一个包收到后，缺的包可能由重传补齐 */
     /*! 收完了再解包*/
-    if ((rsp->msg_flag & 0x01)
-    && (range_handler_->GetLastNotReceiveSeq() == rsp->seq + 1)
-    && (range_handler_->GetNoAckRanges().size() == 0)) {
-      std::list<DataPointer> dataList = download_buffer_->DequeueAllBuffer();
-      FilePackage file_package = parseFileList(dataList);
+    if (fileListHandler->lastPackReceived && range_handler_->IsAllReceived()) {
+      /*! Parsed in place, the blocks go back to the pool afterwards */
+      std::vector<DataPointer> dataList;
+      dataList.reserve(range_handler_->GetLastNotReceiveSeq());
+      download_buffer_->DequeueAllBuffer(dataList);
+      FilePackage listed;
+      parseFileList(dataList, listed);
+      download_buffer_->ReleaseBuffer(dataList);
 
       SendAbortPack(DJI_GENERAL_DOWNLOAD_FILE_TASK_TYPE_LIST);
-      if (fileListHandler->reqCB) {
-        fileListHandler->reqCB(OSDK_STAT_OK, file_package, fileListHandler->reqCBUserData);
-        fileListHandler->reqCB = NULL;
+      FilePackagePtr file_package = fileListHandler->cache.update(fileListHandler->startIndex, listed);
+      if (!file_package) {
+        fileListHandler->relist = true;
+        fileListHandler->monitor.notify();
+        return;
       }
-
+      /*! Idle before the callback, which may list again right away */
+      auto cb = fileListHandler->reqCB;
+      fileListHandler->reqCB = NULL;
       DSTATUS("Finish req filelist task, reset downloadState to be DOWNLOAD_IDLE");
       fileListHandler->downloadState = DOWNLOAD_IDLE;
+      fileListHandler->monitor.notify();
+      if (cb) cb(OSDK_STAT_OK, file_package, fileListHandler->reqCBUserData);
     }
 }
 
 void FileMgrImpl::fileDataRawDataCB(dji_general_transfer_msg_ack *rsp) {
   if (fileDataHandler->downloadState == DOWNLOAD_IDLE) return;
+  /*! 收包和换段互斥, 包只写进请求它的那一段; 结束时的回调可能开始下一次下载, 不能持锁 */
+  bool finished = false;
+  std::unique_lock<std::mutex> lock(fileDataHandler->packMutex);
+  E_OsdkStat ret = takeFileDataPack(rsp, finished);
+  lock.unlock();
+  if (ret != OSDK_STAT_OK) finishFileData(ret);
+  else if (finished) finishFileData(OSDK_STAT_OK);
+}
+
+/*! Called with packMutex held */
+E_OsdkStat FileMgrImpl::takeFileDataPack(dji_general_transfer_msg_ack *rsp, bool &finished) {
+  if (fileDataHandler->finishing) return OSDK_STAT_OK;
+  if (fileDataHandler->segmentDone || fileDataHandler->wholeFile) return OSDK_STAT_OK;
   auto range_handler_ = fileDataHandler->range_handler_;
-  auto mmap_file_buffer_ = fileDataHandler->mmap_file_buffer_;
-  if (range_handler_) {
-    range_handler_->AddSeqIndex(rsp->seq, 0, (uint32_t)(-1));
-  }
+  if (!range_handler_) return OSDK_STAT_OK;
 
-  /*! refresh the time stamp */
   uint32_t curMs = 0;
   OsdkOsal_GetTimeMs(&curMs);
-  fileDataHandler->updateTimeMs = curMs;
+  uint32_t data_size = rsp->msg_length;
+  data_size -= sizeof(dji_general_transfer_msg_ack) - sizeof(uint8_t);
+  if (rsp->seq == 0) data_size -= sizeof(dji_file_data_download_resp) - sizeof(uint8_t);
+
+  /*! 新的一段从seq 0开始, 之前的包是上一段的; 没按要求回这一段就整个重新下.
+   *  这一段开始后又来了前面一段的seq 0: 相机收到了迟到的旧请求, 之后的包都不是这一段的 */
+  uint32_t file_size = 0;
+  if (rsp->seq == 0) {
+    auto resp = (dji_file_data_download_resp *) (rsp->data);
+    file_size = resp->size - (sizeof(dji_file_data_download_resp) - sizeof(uint8_t));
+    if (file_size != fileDataHandler->segmentLength
+        && fileDataHandler->previousLengths.count(file_size)) {
+      if (!fileDataHandler->waitFirstPack) {
+        fileDataHandler->waitFirstPack = true;
+        fileDataHandler->rangeLost = true;
+        fileDataHandler->monitor.notify();
+      }
+      return OSDK_STAT_OK;
+    }
+  }
+  if (fileDataHandler->waitFirstPack) {
+    if (rsp->seq != 0) return OSDK_STAT_OK;
+    uint64_t segmentLength = fileDataHandler->segmentLength;
+    if (segmentLength && file_size != segmentLength) {
+      DERROR("Asked for %llu bytes at %llu, the camera sends %d",
+             (unsigned long long)segmentLength,
+             (unsigned long long)fileDataHandler->segmentOffset, file_size);
+      fileDataHandler->wholeFile = true;
+      fileDataHandler->monitor.notify();
+      return OSDK_STAT_OK;
+    }
+    fileDataHandler->waitFirstPack = false;
+  }
+  /*! 重复的包不再写文件 */
+  if (!fileDataHandler->monitor.onPack(rsp->seq, 0, (uint32_t)(-1), data_size, curMs)) return OSDK_STAT_OK;
 
   /*! do data parsing, 边收边解包 */
-  parseFileData(rsp);
-
-  /*! 看看是否拿到了最后一个包 */
-  if ((rsp->msg_flag & 0x01)
-      && (range_handler_->GetLastNotReceiveSeq() == rsp->seq + 1)
-      && (range_handler_->GetNoAckRanges().size() == 0)){
-    mmap_file_buffer_->deInit();
-    SendAbortPack(DJI_GENERAL_DOWNLOAD_FILE_TASK_TYPE_FILE);
-    if (fileDataHandler->reqCB) {
-      fileDataHandler->reqCB(OSDK_STAT_OK, fileDataHandler->reqCBUserData);
-      fileDataHandler->reqCB = NULL;
+  E_OsdkStat ret = parseFileData(rsp);
+  if (ret != OSDK_STAT_OK) return ret;
+  if (rsp->msg_flag & 0x01) fileDataHandler->lastPackReceived = true;
+
+  /*! 最后一个包收到后，缺的包可能由重传补齐 */
+  if (fileDataHandler->lastPackReceived && range_handler_->IsAllReceived()) {
+    if (fileDataHandler->segments.empty()) {
+      finished = true;
+    } else {
+      fileDataHandler->segmentDone = true;
+      fileDataHandler->monitor.notify();
     }
-    DSTATUS("Finish req filedata task, reset downloadState to be DOWNLOAD_IDLE");
-    fileDataHandler->downloadState = DOWNLOAD_IDLE;
+  } else if (fileDataHandler->progress.getReceivedBytes() - fileDataHandler->checkpointBytes
+             >= DownloadDataHandler::CHECKPOINT_BYTES) {
+    fileDataHandler->checkpointBytes = fileDataHandler->progress.getReceivedBytes();
+    fileDataHandler->checkpointDue = true;
+    fileDataHandler->monitor.notify();
   }
+  return OSDK_STAT_OK;
 }
 
 #define LOG_EVERY_PACK 0
@@ -861,25 +1212,27 @@ ErrorCode::ErrorCodeType FileMgrImpl::SendACKPack(DJI_GENERAL_DOWNLOAD_FILE_TASK
 }
 
 ErrorCode::ErrorCodeType FileMgrImpl::SendMissedAckPack(DJI_GENERAL_DOWNLOAD_FILE_TASK_TYPE taskId) {
-  CommonDataRangeHandler *range_handler_;
+  FileTransferMonitor *monitor;
   if (taskId == DJI_GENERAL_DOWNLOAD_FILE_TASK_TYPE_LIST)
-    range_handler_ = fileListHandler->range_handler_;
+    monitor = &fileListHandler->monitor;
   else if (taskId == DJI_GENERAL_DOWNLOAD_FILE_TASK_TYPE_FILE)
-    range_handler_ = fileDataHandler->range_handler_;
+    monitor = &fileDataHandler->monitor;
   else return ErrorCode::SysCommonErr::ReqNotSupported;
 
-  std::vector<Range> ranges = range_handler_->GetNoAckRanges();
-  if(ranges.empty()) {
+  /*! 一次把所有缺失的区间都要回来 */
+  Range ranges[FileTransferMonitor::MAX_NACK_RANGES];
+  uint32_t expectSeq = 0;
+  size_t rangeCnt = monitor->getMissingRanges(ranges, sizeof(ranges) / sizeof(ranges[0]), expectSeq);
+  if(rangeCnt == 0) {
     uint8_t buf[1024] = {0};
     dji_download_ack *ack = (dji_download_ack *)buf;
-    ack->expect_seq = range_handler_->GetLastNotReceiveSeq();
+    ack->expect_seq = expectSeq;
     ack->loss_nr = 0;
     DSTATUS("[Confirming ...]---------------ack->expect_seq = %d ack->loss_nr = %d", ack->expect_seq, ack->loss_nr);
     SendACKPack(taskId, ack);
     return OSDK_STAT_OK;
   }
 
-  auto rangeCnt = ranges.size() > 1 ? 1 : ranges.size();
   uint8_t buf[1024] = {0};
   dji_download_ack *ack = (dji_download_ack *)buf;
   ack->expect_seq = ranges[0].seq_num;
@@ -889,12 +1242,14 @@ ErrorCode::ErrorCodeType FileMgrImpl::SendMissedAckPack(DJI_GENERAL_DOWNLOAD_FIL
     auto range = ranges[i];
     ack->loss_desc[i].seq = range.seq_num;
     ack->loss_desc[i].cnt = range.length;
-    DSTATUS("[MissPack]---------------loss[%d] range.seq_num = %d, range.length = %d", i, range.seq_num, range.length);
   }
   return SendACKPack(taskId, ack);
 }
 
-DownloadListHandler::DownloadListHandler() : reqCB(nullptr), reqCBUserData(nullptr) {
+DownloadListHandler::DownloadListHandler()
+    : reqCB(nullptr), reqCBUserData(nullptr), monitorSession(0),
+      lastPackReceived(false),
+      startIndex(FileListCache::FIRST_FILE_INDEX), relist(false) {
   range_handler_ = new CommonDataRangeHandler();
   download_buffer_ = new DownloadBufferQueue();
   downloadState = DOWNLOAD_IDLE;
@@ -905,13 +1260,20 @@ DownloadListHandler::~DownloadListHandler() {
   if (download_buffer_) delete download_buffer_;
 }
 
-DownloadDataHandler::DownloadDataHandler() : reqCB(nullptr), reqCBUserData(nullptr) {
+DownloadDataHandler::DownloadDataHandler()
+    : reqCB(nullptr), reqCBUserData(nullptr), monitorSession(0),
+      lastPackReceived(false), finishing(false), finishDue(false),
+      finishStatus(OSDK_STAT_OK), packDataLen(0),
+      pendingLastSeq(0), checkpointBytes(0), checkpointDue(false),
+      segmentOffset(0), segmentLength(0),
+      segmentDone(false), waitFirstPack(false), wholeFile(false),
+      rangeLost(false) {
   range_handler_ = new CommonDataRangeHandler();
-  mmap_file_buffer_ = new MmapFileBuffer();
+  file_buffer_ = new PwriteFileBuffer();
   downloadState = DOWNLOAD_IDLE;
 }
 
 DownloadDataHandler::~DownloadDataHandler() {
   if (range_handler_) delete range_handler_;
-  if (mmap_file_buffer_) delete mmap_file_buffer_;
+  if (file_buffer_) delete file_buffer_;
 }
\ No newline at end of file
@@ -0,0 +1,471 @@
+/** @file download_progress.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief Persisted progress of a file download, to resume it
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+#include "download_progress.hpp"
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "dji_log.hpp"
+
+using namespace DJI::OSDK;
+
+namespace {
+
+const char progressMagic[8] = {'O', 'S', 'D', 'K', 'P', 'R', 'O', 'G'};
+const uint32_t progressVersion = 1;
+
+/*! Layout of a progress file: this header, rangeCount start and end pairs,
+ *  chunkCount chunk checksums, then the checksum of all that */
+typedef struct ProgressHeader {
+  char magic[8];
+  uint32_t version;
+  int32_t fileIndex;
+  uint64_t fileSize;
+  uint32_t rangeCount;
+  uint32_t chunkCount;
+} ProgressHeader;
+
+const uint64_t weightStep = 0x9E3779B97F4A7C15ULL;
+
+/*! Odd, so that no change to a single word cancels out */
+inline uint64_t wordWeight(uint64_t word) {
+  return ((word + 1) * weightStep) | 1;
+}
+
+bool readAll(int fd, uint8_t *data, uint32_t length, uint64_t offset) {
+  while (length > 0) {
+    ssize_t size = pread(fd, data, length, (off_t)offset);
+    if (size < 0 && errno == EINTR) continue;
+    if (size <= 0) return false;
+    data += size;
+    length -= (uint32_t)size;
+    offset += (uint64_t)size;
+  }
+  return true;
+}
+
+bool writeAll(int fd, const uint8_t *data, size_t length) {
+  while (length > 0) {
+    ssize_t size = ::write(fd, data, length);
+    if (size < 0 && errno == EINTR) continue;
+    if (size <= 0) return false;
+    data += size;
+    length -= (size_t)size;
+  }
+  return true;
+}
+
+template <typename T>
+void append(std::vector<uint8_t> &buffer, const T &value) {
+  const uint8_t *bytes = (const uint8_t *)&value;
+  buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+}  // namespace
+
+DownloadProgress::DownloadProgress()
+    : mutex(NULL), saveMutex(NULL), generation(0), fileIndex(0), fileSize(0),
+      receivedBytes(0) {
+  if (OsdkOsal_MutexCreate(&mutex) != OSDK_STAT_OK ||
+      OsdkOsal_MutexCreate(&saveMutex) != OSDK_STAT_OK) {
+    DERROR("Create download progress mutex failed");
+  }
+}
+
+DownloadProgress::~DownloadProgress() {
+  if (saveMutex) OsdkOsal_MutexDestroy(saveMutex);
+  if (mutex) OsdkOsal_MutexDestroy(mutex);
+}
+
+void DownloadProgress::reset(const std::string &path, int fileIndex) {
+  OsdkOsal_MutexLock(mutex);
+  generation++;
+  this->path = path;
+  this->fileIndex = fileIndex;
+  fileSize = 0;
+  receivedBytes = 0;
+  received.clear();
+  chunkSums.clear();
+  unlink(getProgressPath().c_str());
+  OsdkOsal_MutexUnlock(mutex);
+}
+
+bool DownloadProgress::load(const std::string &path, int fileIndex) {
+  OsdkOsal_MutexLock(mutex);
+  generation++;
+  this->path = path;
+  this->fileIndex = fileIndex;
+  fileSize = 0;
+  receivedBytes = 0;
+  received.clear();
+  chunkSums.clear();
+
+  std::vector<uint8_t> buffer;
+  struct stat status;
+  int fd = ::open(getProgressPath().c_str(), O_RDONLY);
+  bool ok = fd >= 0 && fstat(fd, &status) == 0 &&
+            (uint64_t)status.st_size >= sizeof(ProgressHeader) + 8;
+  if (ok) {
+    buffer.resize((size_t)status.st_size);
+    ok = readAll(fd, &buffer[0], (uint32_t)buffer.size(), 0);
+  }
+  if (fd >= 0) ::close(fd);
+
+  ProgressHeader header;
+  if (ok) {
+    memcpy(&header, &buffer[0], sizeof(header));
+    uint64_t stored = 0;
+    memcpy(&stored, &buffer[buffer.size() - 8], 8);
+    uint64_t length = sizeof(header) + (uint64_t)header.rangeCount * 16 +
+                      (uint64_t)header.chunkCount * 8 + 8;
+    ok = memcmp(header.magic, progressMagic, sizeof(header.magic)) == 0 &&
+         header.version == progressVersion && header.fileIndex == fileIndex &&
+         header.fileSize != 0 && length == buffer.size() &&
+         header.chunkCount == (header.fileSize + CHUNK_SIZE - 1) / CHUNK_SIZE &&
+         stored == checksum(0, &buffer[0], (uint32_t)buffer.size() - 8);
+  }
+  if (ok) {
+    fileSize = header.fileSize;
+    const uint8_t *cursor = &buffer[sizeof(header)];
+    uint64_t lastEnd = 0;
+    for (uint32_t i = 0; ok && i < header.rangeCount; i++, cursor += 16) {
+      uint64_t start, end;
+      memcpy(&start, cursor, 8);
+      memcpy(&end, cursor + 8, 8);
+      ok = (i == 0 || start > lastEnd) && start < end && end <= fileSize;
+      if (ok) addRange(start, end);
+      lastEnd = end;
+    }
+    chunkSums.resize(header.chunkCount);
+    if (header.chunkCount) memcpy(&chunkSums[0], cursor, header.chunkCount * 8);
+  }
+  /*! The partial file was reserved at its full size */
+  ok = ok && stat(path.c_str(), &status) == 0 &&
+       (uint64_t)status.st_size == fileSize;
+
+  if (ok) {
+    checkChunks();
+    DSTATUS("Resume download to %s, %llu of %llu bytes kept", path.c_str(),
+            (unsigned long long)receivedBytes, (unsigned long long)fileSize);
+  } else {
+    fileSize = 0;
+    receivedBytes = 0;
+    received.clear();
+    chunkSums.clear();
+  }
+  OsdkOsal_MutexUnlock(mutex);
+  return ok;
+}
+
+bool DownloadProgress::save() {
+  return save(snapshot());
+}
+
+DownloadProgress::Snapshot DownloadProgress::snapshot() {
+  Snapshot saved;
+  OsdkOsal_MutexLock(mutex);
+  saved.generation = generation;
+  /*! Nothing to resume from before the size is known */
+  if (fileSize == 0) {
+    OsdkOsal_MutexUnlock(mutex);
+    return saved;
+  }
+
+  ProgressHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, progressMagic, sizeof(header.magic));
+  header.version = progressVersion;
+  header.fileIndex = fileIndex;
+  header.fileSize = fileSize;
+  header.rangeCount = (uint32_t)received.size();
+  header.chunkCount = (uint32_t)chunkSums.size();
+
+  std::vector<uint8_t> &buffer = saved.data;
+  buffer.reserve(sizeof(header) + received.size() * 16 + chunkSums.size() * 8 + 8);
+  append(buffer, header);
+  for (std::map<uint64_t, uint64_t>::const_iterator it = received.begin();
+       it != received.end(); ++it) {
+    append(buffer, it->first);
+    append(buffer, it->second);
+  }
+  for (size_t i = 0; i < chunkSums.size(); i++) append(buffer, chunkSums[i]);
+  append(buffer, checksum(0, &buffer[0], (uint32_t)buffer.size()));
+  OsdkOsal_MutexUnlock(mutex);
+  return saved;
+}
+
+bool DownloadProgress::save(const Snapshot &saved) {
+  if (saved.data.empty()) return true;
+
+  OsdkOsal_MutexLock(saveMutex);
+  OsdkOsal_MutexLock(mutex);
+  /*! Written aside and renamed over, so a crash leaves the old or the new */
+  std::string progressPath = getProgressPath();
+  std::string tempPath = progressPath + ".tmp";
+  OsdkOsal_MutexUnlock(mutex);
+
+  bool ok = false;
+  int fd = ::open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd >= 0) {
+    ok = writeAll(fd, &saved.data[0], saved.data.size()) && fsync(fd) == 0;
+    ok = (::close(fd) == 0) && ok;
+  }
+  /*! Renamed under the lock, a download finished meanwhile keeps no file */
+  bool stale = false;
+  if (ok) {
+    OsdkOsal_MutexLock(mutex);
+    stale = (saved.generation != generation);
+    ok = stale || rename(tempPath.c_str(), progressPath.c_str()) == 0;
+    OsdkOsal_MutexUnlock(mutex);
+  }
+  if (!ok) {
+    DERROR("Save download progress to %s failed: %s", progressPath.c_str(),
+           strerror(errno));
+  }
+  if (!ok || stale) unlink(tempPath.c_str());
+  OsdkOsal_MutexUnlock(saveMutex);
+  return ok;
+}
+
+void DownloadProgress::remove() {
+  OsdkOsal_MutexLock(mutex);
+  generation++;
+  unlink(getProgressPath().c_str());
+  OsdkOsal_MutexUnlock(mutex);
+}
+
+void DownloadProgress::setFileSize(uint64_t fileSize) {
+  OsdkOsal_MutexLock(mutex);
+  this->fileSize = fileSize;
+  size_t chunkCount = (size_t)((fileSize + CHUNK_SIZE - 1) / CHUNK_SIZE);
+  if (chunkSums.size() < chunkCount) chunkSums.resize(chunkCount, 0);
+  OsdkOsal_MutexUnlock(mutex);
+}
+
+uint64_t DownloadProgress::getFileSize() {
+  OsdkOsal_MutexLock(mutex);
+  uint64_t size = fileSize;
+  OsdkOsal_MutexUnlock(mutex);
+  return size;
+}
+
+uint64_t DownloadProgress::getReceivedBytes() {
+  OsdkOsal_MutexLock(mutex);
+  uint64_t bytes = receivedBytes;
+  OsdkOsal_MutexUnlock(mutex);
+  return bytes;
+}
+
+void DownloadProgress::add(uint64_t offset, const uint8_t *data,
+                           uint32_t length) {
+  uint64_t end = offset + length;
+  OsdkOsal_MutexLock(mutex);
+  /*! Only bytes not received before count, a merged gap brings some again */
+  uint64_t cursor = offset;
+  std::map<uint64_t, uint64_t>::iterator next = received.upper_bound(cursor);
+  if (next != received.begin()) {
+    std::map<uint64_t, uint64_t>::iterator prev = next;
+    --prev;
+    if (prev->second > cursor) cursor = prev->second;
+  }
+  while (cursor < end) {
+    uint64_t pieceEnd = end;
+    if (next != received.end() && next->first < pieceEnd) pieceEnd = next->first;
+    while (cursor < pieceEnd) {
+      uint64_t chunk = cursor / CHUNK_SIZE;
+      uint64_t chunkEnd = (chunk + 1) * CHUNK_SIZE;
+      uint64_t size = ((chunkEnd < pieceEnd) ? chunkEnd : pieceEnd) - cursor;
+      if (chunkSums.size() <= chunk) chunkSums.resize((size_t)chunk + 1, 0);
+      chunkSums[chunk] += checksum(cursor, data + (cursor - offset), (uint32_t)size);
+      cursor += size;
+    }
+    if (next == received.end()) break;
+    if (next->second > cursor) cursor = next->second;
+    ++next;
+  }
+  addRange(offset, end);
+  OsdkOsal_MutexUnlock(mutex);
+}
+
+std::vector<DownloadProgress::Segment> DownloadProgress::getMissing() {
+  std::vector<Segment> missing;
+  OsdkOsal_MutexLock(mutex);
+  uint64_t cursor = 0;
+  std::map<uint64_t, uint64_t>::const_iterator it = received.begin();
+  while (cursor < fileSize) {
+    uint64_t end = (it != received.end()) ? it->first : fileSize;
+    if (end > fileSize) end = fileSize;
+    if (end > cursor) {
+      Segment segment = {cursor, end - cursor};
+      if (!missing.empty() &&
+          cursor - (missing.back().offset + missing.back().length) < MERGE_GAP) {
+        missing.back().length = end - missing.back().offset;
+      } else {
+        missing.push_back(segment);
+      }
+    }
+    if (it == received.end()) break;
+    cursor = it->second;
+    ++it;
+  }
+  OsdkOsal_MutexUnlock(mutex);
+  return missing;
+}
+
+bool DownloadProgress::verify() {
+  OsdkOsal_MutexLock(mutex);
+  bool ok = checkChunks() && fileSize != 0 && receivedBytes == fileSize;
+  OsdkOsal_MutexUnlock(mutex);
+  return ok;
+}
+
+/*! Sum of every word of data, weighed by its position in the file; a word
+ *  only partly in data counts the bytes that are */
+uint64_t DownloadProgress::checksum(uint64_t offset, const uint8_t *data,
+                                    uint32_t length) {
+  uint64_t sum = 0;
+  uint32_t shift = (uint32_t)(offset % 8);
+  if (shift != 0 && length > 0) {
+    uint32_t size = (8 - shift < length) ? 8 - shift : length;
+    uint64_t word = 0;
+    memcpy((uint8_t *)&word + shift, data, size);
+    sum += word * wordWeight(offset / 8);
+    offset += size;
+    data += size;
+    length -= size;
+  }
+
+  /*! wordWeight() of consecutive words, one addition apart */
+  uint64_t weight = (offset / 8 + 1) * weightStep;
+  for (; length >= 8; data += 8, length -= 8, offset += 8) {
+    uint64_t word;
+    memcpy(&word, data, 8);
+    sum += word * (weight | 1);
+    weight += weightStep;
+  }
+
+  if (length > 0) {
+    uint64_t word = 0;
+    memcpy(&word, data, length);
+    sum += word * wordWeight(offset / 8);
+  }
+  return sum;
+}
+
+/*! Called locked; reads back every chunk holding data received, and drops
+ *  those that differ from what was received
+ *  @return true if all of them matched */
+bool DownloadProgress::checkChunks() {
+  std::vector<uint64_t> chunks;
+  for (std::map<uint64_t, uint64_t>::const_iterator it = received.begin();
+       it != received.end(); ++it) {
+    uint64_t chunk = it->first / CHUNK_SIZE;
+    if (!chunks.empty() && chunks.back() >= chunk) chunk = chunks.back() + 1;
+    for (; chunk * CHUNK_SIZE < it->second; chunk++) chunks.push_back(chunk);
+  }
+
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) DERROR("Open %s to check failed: %s", path.c_str(), strerror(errno));
+  std::vector<uint8_t> buffer(chunks.empty() ? 0 : CHUNK_SIZE);
+  size_t dropped = 0;
+  for (size_t i = 0; i < chunks.size(); i++) {
+    uint64_t start = chunks[i] * CHUNK_SIZE;
+    uint64_t end = start + CHUNK_SIZE;
+    if (end > fileSize) end = fileSize;
+    bool match = end > start && chunks[i] < chunkSums.size() && fd >= 0 &&
+                 readAll(fd, &buffer[0], (uint32_t)(end - start), start) &&
+                 checksum(start, &buffer[0], (uint32_t)(end - start)) ==
+                     chunkSums[chunks[i]];
+    if (!match) {
+      removeRange(start, start + CHUNK_SIZE);
+      if (chunks[i] < chunkSums.size()) chunkSums[chunks[i]] = 0;
+      dropped++;
+    }
+  }
+  if (fd >= 0) ::close(fd);
+  if (dropped) DERROR("%d of %d chunks of %s differ from the data received",
+                      (int)dropped, (int)chunks.size(), path.c_str());
+  return dropped == 0;
+}
+
+/*! Called locked; in order data extends the range before it in place */
+void DownloadProgress::addRange(uint64_t start, uint64_t end) {
+  std::map<uint64_t, uint64_t>::iterator next = received.upper_bound(start);
+  std::map<uint64_t, uint64_t>::iterator range = received.end();
+  if (next != received.begin()) {
+    std::map<uint64_t, uint64_t>::iterator prev = next;
+    --prev;
+    if (prev->second >= start) {
+      if (prev->second >= end) return;
+      receivedBytes += end - prev->second;
+      prev->second = end;
+      range = prev;
+    }
+  }
+  if (range == received.end()) {
+    range = received.insert(next, std::make_pair(start, end));
+    receivedBytes += end - start;
+  }
+  while (next != received.end() && next->first <= range->second) {
+    receivedBytes -= (range->second < next->second ? range->second : next->second) -
+                     next->first;
+    if (next->second > range->second) range->second = next->second;
+    received.erase(next++);
+  }
+}
+
+/*! Called locked */
+void DownloadProgress::removeRange(uint64_t start, uint64_t end) {
+  std::map<uint64_t, uint64_t>::iterator it = received.upper_bound(start);
+  if (it != received.begin()) --it;
+  while (it != received.end() && it->first < end) {
+    uint64_t rangeStart = it->first;
+    uint64_t rangeEnd = it->second;
+    if (rangeEnd <= start) {
+      ++it;
+      continue;
+    }
+    receivedBytes -= rangeEnd - rangeStart;
+    received.erase(it++);
+    if (rangeStart < start) {
+      received[rangeStart] = start;
+      receivedBytes += start - rangeStart;
+    }
+    if (rangeEnd > end) {
+      received[end] = rangeEnd;
+      receivedBytes += rangeEnd - end;
+    }
+  }
+}
+
+std::string DownloadProgress::getProgressPath() const {
+  return path + ".progress";
+}
@@ -11,6 +11,7 @@
 #include <stdio.h>
 #include <chrono>
 #include <cstring>
+#include <new>
 
 #ifdef ANDROID
 #include <malloc.h>
@@ -20,12 +21,21 @@ using namespace std::chrono;
 
 namespace DJI {
 namespace OSDK {
-bool DownloadBufferQueue::InitBufferQueue(int size, int start_index) {
+bool DownloadBufferQueue::InitBufferQueue(int size, int start_index, uint32_t block_length) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (size <= 0 || block_length == 0) {
+        return false;
+    }
+
     if (m_queue_ptr != nullptr) {
         free(m_queue_ptr);
         m_queue_ptr = nullptr;
     }
     m_queue_ptr = (DataPointer *)malloc(sizeof(DataPointer) * size);
+    if (m_queue_ptr == nullptr) {
+        m_size = 0;
+        return false;
+    }
 
     memset(m_queue_ptr, 0x00, sizeof(DataPointer) * size);
 
@@ -34,15 +44,44 @@ bool DownloadBufferQueue::InitBufferQueue(int size, int start_index) {
     m_head = m_expect_index % m_size;
     m_buf_max_index = m_expect_index - 1;
 
+    // 池子跨会话保留，块长变了才重建
+    if (block_length != m_block_length) {
+        m_slabs.clear();
+        m_block_length = block_length;
+    }
+    m_free_blocks.clear();
+    for (size_t i = 0; i < m_slabs.size(); i++) {
+        for (int j = 0; j < BLOCKS_PER_SLAB; j++) {
+            m_free_blocks.push_back(m_slabs[i].get() + j * m_block_length);
+        }
+    }
+
     return true;
 }
 
+uint8_t *DownloadBufferQueue::AllocBlock() {
+    if (m_free_blocks.empty()) {
+        uint8_t *slab = new (std::nothrow) uint8_t[m_block_length * BLOCKS_PER_SLAB];
+        if (slab == nullptr) {
+            return nullptr;
+        }
+        m_slabs.push_back(std::unique_ptr<uint8_t[]>(slab));
+        for (int j = BLOCKS_PER_SLAB - 1; j >= 0; j--) {
+            m_free_blocks.push_back(slab + j * m_block_length);
+        }
+    }
+
+    uint8_t *block = m_free_blocks.back();
+    m_free_blocks.pop_back();
+    return block;
+}
+
 // flag 代表是否覆盖已有队列缓存
 DownloadBufferQueue::InsertRetType DownloadBufferQueue::InsertBlock(const uint8_t *pack, uint32_t data_length, int index, bool flag) {
   std::lock_guard<std::mutex> lock(m_mutex);
   InsertRetType ret = INSERT_FAIL_UNKOWN;
 
-  if (data_length <= 0) {
+  if (data_length <= 0 || data_length > m_block_length || m_queue_ptr == nullptr) {
     return INSERT_FAIL_INVALID_PARAM;
   }
 
@@ -55,11 +94,13 @@ DownloadBufferQueue::InsertRetType DownloadBufferQueue::InsertBlock(const uint8_
       if (false == flag) {
         return INSERT_FAIL_MEMORY_USED;
       }
-
-      free(data_ptr.data);
+    } else {
+      data_ptr.data = AllocBlock();
+      if (data_ptr.data == nullptr) {
+        return INSERT_FAIL_UNKOWN;
+      }
     }
 
-    data_ptr.data = (uint8_t *) malloc(data_length);
     data_ptr.length = data_length;
     memcpy(data_ptr.data, pack, data_length);
 
@@ -70,9 +111,7 @@ DownloadBufferQueue::InsertRetType DownloadBufferQueue::InsertBlock(const uint8_
     }
 
     ret = INSERT_SUCCESS;
-   // printf("log .................................index = %d; m_expect_index + m_size = %d\n", index, m_expect_index + m_size);
     if (index == (m_expect_index + m_size - 1)) {
-     // printf("满了 .................................index = %d; m_expect_index + m_size = %d\n", index, m_expect_index + m_size);
       return INSERT_SUCCESS_FULL;
     }
   } else {
@@ -83,6 +122,7 @@ DownloadBufferQueue::InsertRetType DownloadBufferQueue::InsertBlock(const uint8_
 }
 
 bool DownloadBufferQueue::FindBlockByIndex(int index) {
+    std::lock_guard<std::mutex> lock(m_mutex);
     bool ret = false;
 
     if (m_expect_index + m_size > index && index >= m_expect_index) {
@@ -106,12 +146,21 @@ int DownloadBufferQueue::GetBufMaxSeq() {
     return m_buf_max_index;
 }
 
+size_t DownloadBufferQueue::GetPoolBlockCount() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_slabs.size() * BLOCKS_PER_SLAB;
+}
+
 DataPointer DownloadBufferQueue::DequeueBuffer() {
     std::lock_guard<std::mutex> lock(m_mutex);
+    DataPointer nil_ptr = {nullptr, 0};
+    if (m_queue_ptr == nullptr) {
+        return nil_ptr;
+    }
+
     DataPointer data_ptr = m_queue_ptr[m_head % m_size];
 
     if (!data_ptr.data || data_ptr.length == 0) {
-        DataPointer nil_ptr = {nullptr};
         return nil_ptr;
     }
 
@@ -125,21 +174,39 @@ DataPointer DownloadBufferQueue::DequeueBuffer() {
     return data_ptr;
 }
 
-std::list<DataPointer> DownloadBufferQueue::DequeueAllBuffer() {
-    DataPointer data_pointer = {nullptr};
-    std::list<DataPointer> data_pointer_list;
-    data_pointer_list.clear();
+size_t DownloadBufferQueue::DequeueAllBuffer(std::vector<DataPointer> &views) {
+    size_t count = 0;
+    DataPointer data_pointer = {nullptr, 0};
 
     while ((data_pointer = DequeueBuffer()).data != nullptr) {
-        data_pointer_list.push_back(data_pointer);
+        views.push_back(data_pointer);
+        count++;
+    }
+    return count;
+}
+
+void DownloadBufferQueue::ReleaseBuffer(const DataPointer &view) {
+    if (view.data == nullptr) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_free_blocks.push_back((uint8_t *)view.data);
+}
+
+void DownloadBufferQueue::ReleaseBuffer(const std::vector<DataPointer> &views) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (size_t i = 0; i < views.size(); i++) {
+        if (views[i].data) {
+            m_free_blocks.push_back((uint8_t *)views[i].data);
+        }
     }
-    return data_pointer_list;
 }
 
 void DownloadBufferQueue::Clear() {
-    for (int i = 0; i < m_size; i++) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (int i = 0; i < m_size && m_queue_ptr; i++) {
         if (m_queue_ptr[i].data) {
-            free(m_queue_ptr[i].data);
+            m_free_blocks.push_back((uint8_t *)m_queue_ptr[i].data);
             m_queue_ptr[i].data = nullptr;
             m_queue_ptr[i].length = 0;
         }
@@ -149,12 +216,15 @@ void DownloadBufferQueue::Clear() {
 void DownloadBufferQueue::Dealloc() {
     Clear();
 
+    std::lock_guard<std::mutex> lock(m_mutex);
     if (m_queue_ptr) {
         free(m_queue_ptr);
         m_queue_ptr = nullptr;
     }
 
     m_size = 0;
+    m_free_blocks.clear();
+    m_slabs.clear();
 }
 }  // namespace OSDK
 
@@ -0,0 +1,97 @@
+/** @file file_list_cache.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief Media file lists of a camera kept between listings
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+#include "file_list_cache.hpp"
+#include "dji_log.hpp"
+
+using namespace DJI::OSDK;
+
+FileListCache::FileListCache() : mutex(NULL) {
+  if (OsdkOsal_MutexCreate(&mutex) != OSDK_STAT_OK) {
+    DERROR("Create file list cache mutex failed");
+  }
+}
+
+FileListCache::~FileListCache() {
+  if (mutex) OsdkOsal_MutexDestroy(mutex);
+}
+
+uint32_t FileListCache::getStartIndex() {
+  uint32_t startIndex = FIRST_FILE_INDEX;
+  OsdkOsal_MutexLock(mutex);
+  if (list && !list->media.empty()) startIndex = list->media.back().fileIndex;
+  OsdkOsal_MutexUnlock(mutex);
+  return startIndex;
+}
+
+FilePackagePtr FileListCache::update(uint32_t startIndex, FilePackage &listed) {
+  FilePackagePtr updated;
+  OsdkOsal_MutexLock(mutex);
+  if (startIndex == FIRST_FILE_INDEX) {
+    std::shared_ptr<FilePackage> whole = std::make_shared<FilePackage>();
+    whole->type = listed.type;
+    whole->media.swap(listed.media);
+    updated = whole;
+    list = updated;
+  } else if (list && !list->media.empty() && !listed.media.empty()
+             && isSameFile(listed.media.front(), list->media.back())) {
+    if (listed.media.size() == 1) {
+      /*! Nothing new, everyone keeps sharing the same list */
+      updated = list;
+    } else {
+      std::shared_ptr<FilePackage> grown = std::make_shared<FilePackage>();
+      grown->type = list->type;
+      grown->media.reserve(list->media.size() + listed.media.size() - 1);
+      grown->media = list->media;
+      grown->media.insert(grown->media.end(), listed.media.begin() + 1,
+                          listed.media.end());
+      updated = grown;
+      list = updated;
+    }
+  } else if (list) {
+    DSTATUS("Storage changed since it was listed, list it again");
+    list.reset();
+  }
+  OsdkOsal_MutexUnlock(mutex);
+  return updated;
+}
+
+void FileListCache::clear() {
+  OsdkOsal_MutexLock(mutex);
+  list.reset();
+  OsdkOsal_MutexUnlock(mutex);
+}
+
+bool FileListCache::isSameFile(const MediaFile &a, const MediaFile &b) {
+  return a.fileIndex == b.fileIndex && a.fileSize == b.fileSize
+      && a.fileType == b.fileType && a.date.year == b.date.year
+      && a.date.month == b.date.month && a.date.day == b.date.day
+      && a.date.hour == b.date.hour && a.date.minute == b.date.minute
+      && a.date.second == b.date.second;
+}
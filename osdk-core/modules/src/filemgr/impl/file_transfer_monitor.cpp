@@ -0,0 +1,277 @@
+/** @file file_transfer_monitor.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief Retransmission timing of one file list or file data transfer
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "file_transfer_monitor.hpp"
+#include <string.h>
+#include "dji_log.hpp"
+
+using namespace DJI::OSDK;
+
+namespace {
+
+/*! Later of two OsdkOsal_GetTimeMs() stamps, wrap safe */
+uint32_t laterMs(uint32_t a, uint32_t b) {
+  return ((int32_t)(a - b) > 0) ? a : b;
+}
+
+}  // namespace
+
+FileTransferMonitor::FileTransferMonitor()
+    : mutex(NULL), wakeup(NULL), ranges(NULL), session(0),
+      rttMeasured(false), requestMs(0), sampleSeq(0), sampleValid(false),
+      nackedBelowSeq(0), nackDue(false), anyPack(false), lastPackMs(0),
+      silentTimeouts(0) {
+  memset(&stats, 0, sizeof(stats));
+  stats.rtoMs = INITIAL_RTO_MS;
+  if (OsdkOsal_MutexCreate(&mutex) != OSDK_STAT_OK) {
+    DERROR("Create file transfer monitor mutex failed");
+  }
+  if (OsdkOsal_SemaphoreCreate(&wakeup, 0) != OSDK_STAT_OK) {
+    DERROR("Create file transfer monitor semaphore failed");
+  }
+}
+
+FileTransferMonitor::~FileTransferMonitor() {
+  if (wakeup) OsdkOsal_SemaphoreDestroy(wakeup);
+  if (mutex) OsdkOsal_MutexDestroy(mutex);
+}
+
+uint32_t FileTransferMonitor::start(CommonDataRangeHandler *ranges,
+                                    uint32_t nowMs) {
+  OsdkOsal_MutexLock(mutex);
+  this->ranges = ranges;
+  uint32_t current = ++session;
+
+  /*! The round trip belongs to the link, it is kept across transfers */
+  uint32_t srttMs = stats.srttMs;
+  uint32_t rttVarMs = stats.rttVarMs;
+  uint32_t rtoMs = stats.rtoMs;
+  memset(&stats, 0, sizeof(stats));
+  stats.srttMs = srttMs;
+  stats.rttVarMs = rttVarMs;
+  stats.rtoMs = rtoMs;
+  stats.requests = 1;
+
+  requestMs = nowMs;
+  sampleSeq = ranges ? ranges->GetLastNotReceiveSeq() : 0;
+  sampleValid = true;
+  nackedBelowSeq = sampleSeq;
+  nackDue = false;
+  anyPack = false;
+  lastPackMs = nowMs;
+  silentTimeouts = 0;
+  OsdkOsal_MutexUnlock(mutex);
+  return current;
+}
+
+bool FileTransferMonitor::isSession(uint32_t session) {
+  OsdkOsal_MutexLock(mutex);
+  bool current = (this->session == session);
+  OsdkOsal_MutexUnlock(mutex);
+  return current;
+}
+
+void FileTransferMonitor::setTotalBytes(uint64_t totalBytes) {
+  OsdkOsal_MutexLock(mutex);
+  stats.totalBytes = totalBytes;
+  OsdkOsal_MutexUnlock(mutex);
+}
+
+bool FileTransferMonitor::onPack(uint32_t seq, uint32_t confirmSeq,
+                                 uint32_t bufSize, uint32_t bytes,
+                                 uint32_t nowMs) {
+  bool wake = false;
+  OsdkOsal_MutexLock(mutex);
+  if (!ranges) {
+    OsdkOsal_MutexUnlock(mutex);
+    return false;
+  }
+
+  uint32_t expectSeq = ranges->GetLastNotReceiveSeq();
+  bool fresh = ranges->AddSeqIndex(seq, confirmSeq, bufSize);
+  stats.packs++;
+  lastPackMs = nowMs;
+  silentTimeouts = 0;
+
+  if (!fresh) {
+    stats.duplicatePacks++;
+  } else {
+    stats.bytes += bytes;
+    /*! First pack after the request, or the lowest one a NACK asked for */
+    if (sampleValid && (!anyPack || seq == sampleSeq)) {
+      sampleRtt(nowMs - requestMs);
+      sampleValid = false;
+    }
+    /*! A gap nobody asked for yet is asked for right away */
+    if (seq > expectSeq) {
+      stats.gapSeqs += seq - expectSeq;
+      if (seq > nackedBelowSeq) {
+        nackDue = true;
+        wake = true;
+      }
+    }
+  }
+  anyPack = true;
+  OsdkOsal_MutexUnlock(mutex);
+
+  if (wake) notify();
+  return fresh;
+}
+
+void FileTransferMonitor::notify() {
+  OsdkOsal_SemaphorePost(wakeup);
+}
+
+void FileTransferMonitor::wait(uint32_t nowMs) {
+  OsdkOsal_MutexLock(mutex);
+  uint32_t timeoutMs = nextTimeoutMs(nowMs);
+  OsdkOsal_MutexUnlock(mutex);
+  if (timeoutMs > 0) OsdkOsal_SemaphoreTimedWait(wakeup, timeoutMs);
+}
+
+/*! Called locked; how long the link may stay quiet before the monitor
+ *  resends the request or probes it with a NACK */
+uint32_t FileTransferMonitor::quietTimeoutMs() const {
+  uint32_t timeoutMs = stats.rtoMs;
+  if (anyPack && stats.gapSeqs && rttMeasured) {
+    timeoutMs = 2 * stats.srttMs;
+    if (timeoutMs < MIN_RTO_MS) timeoutMs = MIN_RTO_MS;
+  }
+  for (uint32_t i = 0; i < silentTimeouts && timeoutMs < MAX_RTO_MS; i++)
+    timeoutMs *= 2;
+  return (timeoutMs > MAX_RTO_MS) ? MAX_RTO_MS : timeoutMs;
+}
+
+/*! Called locked; how long the monitor may sleep from nowMs */
+uint32_t FileTransferMonitor::nextTimeoutMs(uint32_t nowMs) const {
+  if (nackDue) return 0;
+
+  uint32_t quietMs = quietTimeoutMs();
+  uint32_t elapsedMs = nowMs - laterMs(lastPackMs, requestMs);
+  uint32_t timeoutMs = (elapsedMs >= quietMs) ? 0 : quietMs - elapsedMs;
+
+  /*! Packs keep coming but what was asked for did not */
+  if (anyPack && ranges && ranges->GetNoAckRangeCount() != 0) {
+    elapsedMs = nowMs - requestMs;
+    uint32_t resendMs =
+        (elapsedMs >= stats.rtoMs) ? 0 : stats.rtoMs - elapsedMs;
+    if (resendMs < timeoutMs) timeoutMs = resendMs;
+  }
+  return timeoutMs;
+}
+
+FileTransferMonitor::Action FileTransferMonitor::poll(uint32_t nowMs) {
+  Action action = ACTION_NONE;
+  OsdkOsal_MutexLock(mutex);
+  if (!ranges || nextTimeoutMs(nowMs) != 0) {
+    OsdkOsal_MutexUnlock(mutex);
+    return ACTION_NONE;
+  }
+
+  /*! Not even a duplicate came since the last request or NACK; NACKs for
+   *  packs that keep arriving refresh requestMs, so the abort goes by
+   *  lastPackMs alone */
+  bool quiet = !nackDue && (int32_t)(requestMs - lastPackMs) >= 0;
+  if (quiet) silentTimeouts++;
+  if (quiet && nowMs - lastPackMs >= SILENT_ABORT_MS) {
+    action = ACTION_ABORT;
+  } else if (!anyPack ||
+             (quiet && silentTimeouts % RESEND_AFTER_NACKS == 0)) {
+    /*! Karn: a pack answering either request would be ambiguous */
+    action = ACTION_RESEND_REQUEST;
+    stats.requests++;
+    sampleValid = false;
+  } else {
+    action = ACTION_SEND_NACK;
+    stats.nacks++;
+    /*! Karn: only a seq no NACK asked for yet gives a sample, the lowest of
+     *  them; without gaps the NACK asks for the tail from expectSeq */
+    Range missing[MAX_NACK_RANGES];
+    size_t count = ranges->GetNoAckRanges(missing, MAX_NACK_RANGES);
+    uint32_t expectSeq = ranges->GetLastNotReceiveSeq();
+    sampleValid = false;
+    for (size_t i = 0; i < count && !sampleValid; i++) {
+      if (missing[i].seq_num + missing[i].length > nackedBelowSeq) {
+        sampleSeq = (missing[i].seq_num > nackedBelowSeq) ? missing[i].seq_num
+                                                          : nackedBelowSeq;
+        sampleValid = true;
+      }
+    }
+    if (count == 0) {
+      sampleValid = (expectSeq >= nackedBelowSeq);
+      sampleSeq = expectSeq;
+      expectSeq++;
+    }
+    nackedBelowSeq = expectSeq;
+  }
+  nackDue = false;
+  requestMs = nowMs;
+  OsdkOsal_MutexUnlock(mutex);
+  return action;
+}
+
+size_t FileTransferMonitor::getMissingRanges(Range *missing, size_t maxCount,
+                                             uint32_t &expectSeq) {
+  size_t count = 0;
+  OsdkOsal_MutexLock(mutex);
+  expectSeq = 0;
+  if (ranges) {
+    expectSeq = ranges->GetLastNotReceiveSeq();
+    count = ranges->GetNoAckRanges(missing, maxCount);
+  }
+  OsdkOsal_MutexUnlock(mutex);
+  return count;
+}
+
+FileTransferMonitor::Stats FileTransferMonitor::getStats() {
+  OsdkOsal_MutexLock(mutex);
+  Stats current = stats;
+  OsdkOsal_MutexUnlock(mutex);
+  return current;
+}
+
+/*! Called locked, RFC 6298 section 2. On a steady link rttvar drops to
+ *  nearly 0, and the timeout is kept half a round trip above srtt so that a
+ *  pack a little late is not asked for twice. */
+void FileTransferMonitor::sampleRtt(uint32_t rttMs) {
+  if (!rttMeasured) {
+    stats.srttMs = rttMs;
+    stats.rttVarMs = rttMs / 2;
+    rttMeasured = true;
+  } else {
+    uint32_t deltaMs = (stats.srttMs > rttMs) ? stats.srttMs - rttMs
+                                              : rttMs - stats.srttMs;
+    stats.rttVarMs = (3 * stats.rttVarMs + deltaMs) / 4;
+    stats.srttMs = (7 * stats.srttMs + rttMs) / 8;
+  }
+  uint32_t marginMs = 4 * stats.rttVarMs;
+  if (marginMs < stats.srttMs / 2) marginMs = stats.srttMs / 2;
+  stats.rtoMs = stats.srttMs + marginMs;
+  if (stats.rtoMs < MIN_RTO_MS) stats.rtoMs = MIN_RTO_MS;
+  if (stats.rtoMs > MAX_RTO_MS) stats.rtoMs = MAX_RTO_MS;
+}
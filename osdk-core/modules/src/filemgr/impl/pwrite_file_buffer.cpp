@@ -0,0 +1,308 @@
+/** @file pwrite_file_buffer.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief Positional write-behind sink for downloaded file data
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "pwrite_file_buffer.hpp"
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <new>
+#include "dji_log.hpp"
+
+using namespace DJI::OSDK;
+
+namespace {
+
+/*! @return 0 or the errno of the failed pwrite(2) */
+int writeAll(int fd, const uint8_t *data, uint32_t length, uint64_t offset) {
+  while (length > 0) {
+    ssize_t written = pwrite(fd, data, length, (off_t)offset);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return errno;
+    }
+    if (written == 0) return ENOSPC;
+    data += written;
+    length -= (uint32_t)written;
+    offset += (uint64_t)written;
+  }
+  return 0;
+}
+
+}  // namespace
+
+PwriteFileBuffer::PwriteFileBuffer()
+    : mutex(NULL), callMutex(NULL), syncMutex(NULL), fullSem(NULL),
+      freeSem(NULL),
+      writer(NULL), stopping(false), fd(-1), error(0), filling(NULL) {
+  for (uint32_t i = 0; i < BUFFER_COUNT; i++) {
+    buffers[i].offset = 0;
+    buffers[i].length = 0;
+    buffers[i].data = NULL;
+    freeBuffers.push_back(&buffers[i]);
+  }
+  if (OsdkOsal_MutexCreate(&mutex) != OSDK_STAT_OK ||
+      OsdkOsal_MutexCreate(&callMutex) != OSDK_STAT_OK ||
+      OsdkOsal_MutexCreate(&syncMutex) != OSDK_STAT_OK ||
+      OsdkOsal_SemaphoreCreate(&fullSem, 0) != OSDK_STAT_OK ||
+      OsdkOsal_SemaphoreCreate(&freeSem, BUFFER_COUNT) != OSDK_STAT_OK) {
+    DERROR("Create file buffer lock failed");
+    return;
+  }
+  if (OsdkOsal_TaskCreate(&writer, writerTask, OSDK_TASK_STACK_SIZE_DEFAULT,
+                          this) != OSDK_STAT_OK) {
+    DERROR("Create file buffer writer task failed");
+    writer = NULL;
+  }
+}
+
+PwriteFileBuffer::~PwriteFileBuffer() {
+  close(false);
+  if (writer) {
+    OsdkOsal_MutexLock(mutex);
+    stopping = true;
+    OsdkOsal_MutexUnlock(mutex);
+    OsdkOsal_SemaphorePost(fullSem);
+    OsdkOsal_TaskDestroy(writer);
+  }
+  if (freeSem) OsdkOsal_SemaphoreDestroy(freeSem);
+  if (fullSem) OsdkOsal_SemaphoreDestroy(fullSem);
+  if (syncMutex) OsdkOsal_MutexDestroy(syncMutex);
+  if (callMutex) OsdkOsal_MutexDestroy(callMutex);
+  if (mutex) OsdkOsal_MutexDestroy(mutex);
+  for (uint32_t i = 0; i < BUFFER_COUNT; i++) delete[] buffers[i].data;
+}
+
+bool PwriteFileBuffer::open(const std::string &path, bool truncate) {
+  close(false);
+  OsdkOsal_MutexLock(callMutex);
+  OsdkOsal_MutexLock(mutex);
+  error = writer ? 0 : EAGAIN;
+  OsdkOsal_MutexUnlock(mutex);
+
+  int newFd = -1;
+  if (writer) {
+    newFd = ::open(path.c_str(), O_WRONLY | O_CREAT | (truncate ? O_TRUNC : 0),
+                   0644);
+    if (newFd < 0) {
+      setError(errno);
+      DERROR("Open %s failed: %s", path.c_str(), strerror(errno));
+    }
+  }
+  OsdkOsal_MutexLock(mutex);
+  fd = newFd;
+  OsdkOsal_MutexUnlock(mutex);
+  OsdkOsal_MutexUnlock(callMutex);
+  return newFd >= 0;
+}
+
+bool PwriteFileBuffer::setFileSize(uint64_t fileSize) {
+  OsdkOsal_MutexLock(callMutex);
+  int ret = EBADF;
+  if (fd >= 0) {
+    ret = posix_fallocate(fd, 0, (off_t)fileSize);
+    /*! Not every file system can reserve blocks, the size is set anyway */
+    if (ret == EOPNOTSUPP || ret == EINVAL)
+      ret = (ftruncate(fd, (off_t)fileSize) == 0) ? 0 : errno;
+  }
+  if (ret != 0) {
+    setError(ret);
+    DERROR("Reserve %llu bytes failed: %s", (unsigned long long)fileSize,
+           strerror(ret));
+  }
+  OsdkOsal_MutexUnlock(callMutex);
+  return ret == 0;
+}
+
+bool PwriteFileBuffer::write(uint64_t offset, const uint8_t *data,
+                             uint32_t length) {
+  OsdkOsal_MutexLock(callMutex);
+  bool ok = (fd >= 0) && (getError() == 0);
+  while (ok && length > 0) {
+    /*! A buffer only holds one contiguous run */
+    if (filling && (filling->length == BUFFER_SIZE ||
+                    offset != filling->offset + filling->length)) {
+      submit();
+    }
+    if (!filling) {
+      filling = acquire();
+      if (!filling) {
+        ok = false;
+        break;
+      }
+      filling->offset = offset;
+    }
+    uint32_t size = BUFFER_SIZE - filling->length;
+    if (size > length) size = length;
+    memcpy(filling->data + filling->length, data, size);
+    filling->length += size;
+    offset += size;
+    data += size;
+    length -= size;
+  }
+  OsdkOsal_MutexUnlock(callMutex);
+  return ok;
+}
+
+bool PwriteFileBuffer::flush(bool sync) {
+  OsdkOsal_MutexLock(syncMutex);
+  OsdkOsal_MutexLock(callMutex);
+  int syncFd = fd;
+  if (syncFd >= 0) drain();
+  OsdkOsal_MutexUnlock(callMutex);
+
+  /*! The receive thread goes on writing into the buffers meanwhile */
+  bool ok = (syncFd >= 0);
+  if (ok) {
+    if (sync && getError() == 0 && fdatasync(syncFd) != 0) {
+      setError(errno);
+      DERROR("Sync downloaded file failed: %s", strerror(errno));
+    }
+    ok = (getError() == 0);
+  }
+  OsdkOsal_MutexUnlock(syncMutex);
+  return ok;
+}
+
+bool PwriteFileBuffer::close(bool sync) {
+  OsdkOsal_MutexLock(syncMutex);
+  OsdkOsal_MutexLock(callMutex);
+  if (fd < 0) {
+    OsdkOsal_MutexUnlock(callMutex);
+    OsdkOsal_MutexUnlock(syncMutex);
+    return false;
+  }
+
+  drain();
+  if (sync && getError() == 0 && fsync(fd) != 0) {
+    setError(errno);
+    DERROR("Sync downloaded file failed: %s", strerror(errno));
+  }
+  if (::close(fd) != 0 && getError() == 0) {
+    setError(errno);
+    DERROR("Close downloaded file failed: %s", strerror(errno));
+  }
+  OsdkOsal_MutexLock(mutex);
+  fd = -1;
+  OsdkOsal_MutexUnlock(mutex);
+  bool ok = (getError() == 0);
+  OsdkOsal_MutexUnlock(callMutex);
+  OsdkOsal_MutexUnlock(syncMutex);
+  return ok;
+}
+
+bool PwriteFileBuffer::isOpen() {
+  OsdkOsal_MutexLock(mutex);
+  bool open = (fd >= 0);
+  OsdkOsal_MutexUnlock(mutex);
+  return open;
+}
+
+int PwriteFileBuffer::getError() {
+  OsdkOsal_MutexLock(mutex);
+  int current = error;
+  OsdkOsal_MutexUnlock(mutex);
+  return current;
+}
+
+void PwriteFileBuffer::setError(int error) {
+  OsdkOsal_MutexLock(mutex);
+  if (this->error == 0) this->error = error;
+  OsdkOsal_MutexUnlock(mutex);
+}
+
+/*! Called with callMutex held; waits while every buffer is being written */
+PwriteFileBuffer::Buffer *PwriteFileBuffer::acquire() {
+  OsdkOsal_SemaphoreWait(freeSem);
+  OsdkOsal_MutexLock(mutex);
+  Buffer *buffer = freeBuffers.back();
+  freeBuffers.pop_back();
+  OsdkOsal_MutexUnlock(mutex);
+
+  buffer->length = 0;
+  if (!buffer->data) buffer->data = new (std::nothrow) uint8_t[BUFFER_SIZE];
+  if (!buffer->data) {
+    setError(ENOMEM);
+    DERROR("Alloc file buffer failed");
+    OsdkOsal_MutexLock(mutex);
+    freeBuffers.push_back(buffer);
+    OsdkOsal_MutexUnlock(mutex);
+    OsdkOsal_SemaphorePost(freeSem);
+    return NULL;
+  }
+  return buffer;
+}
+
+/*! Called with callMutex held */
+void PwriteFileBuffer::submit() {
+  OsdkOsal_MutexLock(mutex);
+  fullBuffers.push_back(filling);
+  OsdkOsal_MutexUnlock(mutex);
+  filling = NULL;
+  OsdkOsal_SemaphorePost(fullSem);
+}
+
+/*! Called with callMutex held; every buffer back means every write is done */
+void PwriteFileBuffer::drain() {
+  if (filling) submit();
+  for (uint32_t i = 0; i < BUFFER_COUNT; i++) OsdkOsal_SemaphoreWait(freeSem);
+  for (uint32_t i = 0; i < BUFFER_COUNT; i++) OsdkOsal_SemaphorePost(freeSem);
+}
+
+void *PwriteFileBuffer::writerTask(void *arg) {
+  PwriteFileBuffer *self = (PwriteFileBuffer *)arg;
+  for (;;) {
+    OsdkOsal_SemaphoreWait(self->fullSem);
+    OsdkOsal_MutexLock(self->mutex);
+    if (self->fullBuffers.empty()) {
+      bool stopping = self->stopping;
+      OsdkOsal_MutexUnlock(self->mutex);
+      if (stopping) return NULL;
+      continue;
+    }
+    Buffer *buffer = self->fullBuffers.front();
+    self->fullBuffers.pop_front();
+    int fd = self->fd;
+    bool failed = (self->error != 0);
+    OsdkOsal_MutexUnlock(self->mutex);
+
+    /*! After a failure the rest is dropped, the download is lost anyway */
+    if (!failed) {
+      int ret = writeAll(fd, buffer->data, buffer->length, buffer->offset);
+      if (ret != 0) {
+        self->setError(ret);
+        DERROR("Write downloaded file failed: %s", strerror(ret));
+      }
+    }
+
+    OsdkOsal_MutexLock(self->mutex);
+    self->freeBuffers.push_back(buffer);
+    OsdkOsal_MutexUnlock(self->mutex);
+    OsdkOsal_SemaphorePost(self->freeSem);
+  }
+}
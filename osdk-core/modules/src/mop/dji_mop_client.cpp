@@ -39,45 +39,58 @@ MopClient::~MopClient() {
 }
 
 MopErrCode MopClient::connect(PipelineID id, PipelineType type,
-                              MopPipeline *&p) {
+                              MopPipelinePtr &p) {
   int32_t ret;
-
-  /*! 1.Find whether the pipeline object created or not */
-  if (pipelineMap.find(id) == pipelineMap.end()) {
-    MopErrCode createRet;
-    if ((createRet = create(id, p)) != MOP_PASSED) {
-      DERROR("MOP Pipeline create failed");
-      return createRet;
-    } else {
-      pipelineMap[id] = p;
-    }
+  MopPipelinePtr pipeline;
+  MopPipelineRegistry &registry = MopPipelineRegistry::instance();
+  const MopChannelOps &ops = getMopChannelOps();
+
+  /*! 1.Create the pipeline object, unless the id is in use */
+  MopErrCode createRet = create(id, type, pipeline);
+  if (createRet != MOP_PASSED) {
+    DERROR("MOP Pipeline create failed");
+    return createRet;
   }
 
   /*! 2.Do creating */
-  if(type == UNRELIABLE) {
-    ret = mop_create_channel(&p->channelHandle, MOP_TRANS_UNRELIABLE);
-  } else {
-    ret = mop_create_channel(&p->channelHandle, MOP_TRANS_RELIABLE);
-  }
-
+  mop_channel_handle_t channel = NULL;
+  ret = ops.create(&channel, getTransType(type));
   if (MOP_SUCCESS != ret) {
     DERROR("MOP create channel failed");
+    registry.remove(id, pipeline.get());
     return getMopErrCode(ret);
   }
+  if (!pipeline->attach(channel, false)) {
+    /*! Disconnected already */
+    ops.destroy(channel);
+    return getMopErrCode(MOP_ERR_CONNECTIONCLOSE);
+  }
 
-  /*! 3.Do connecting */
-  do {
+  /*! 3.Do connecting, until it works or the pipeline is disconnected */
+  for (;;) {
+    void *handle = pipeline->beginCall(false);
+    if (!handle) {
+      ret = MOP_ERR_CONNECTIONCLOSE;
+      break;
+    }
     DSTATUS("Trying to connect pipeline slot : %d, channel_id : %d", slot, id);
-    ret = mop_connect_channel(p->channelHandle, MOP_DEVICE_PSDK, slot, id);
+    ret = ops.connect(handle, MOP_DEVICE_PSDK, slot, id);
+    pipeline->endCall();
     DSTATUS("Result of connecting pipeline (slot:%d, channel_id:%d) : %d", slot, id, ret);
+    if (ret == MOP_SUCCESS || !registry.contains(id, pipeline.get())) break;
     sleep(1);
-  } while (ret != MOP_SUCCESS);
-
-  if (ret != MOP_SUCCESS) {
-    DERROR("Connect Mop Channel failed, destroy mop channel");
-    mop_destroy_channel(p->channelHandle);
   }
 
+  if (ret == MOP_SUCCESS) {
+    if (registry.open(id, pipeline.get())) {
+      p = pipeline;
+      return MOP_PASSED;
+    }
+    ret = MOP_ERR_CONNECTIONCLOSE;
+  }
+  DERROR("Connect Mop Channel failed, destroy mop channel");
+  registry.remove(id, pipeline.get());
+  pipeline->closeChannels();
   return getMopErrCode(ret);
 }
 
@@ -89,17 +102,10 @@ void MopClient::connect(PipelineID id, PipelineType type,
 }
 
 MopErrCode MopClient::disconnect(PipelineID id) {
-  int32_t ret;
-  if (pipelineMap.find(id) == pipelineMap.end()) {
-    return MOP_PARM;
-  }
-  mop_channel_handle_t handler = pipelineMap[id]->channelHandle;
-
   DSTATUS("Trying to disconnect pipeline slot : %d, channel_id : %d", slot, id);
-  ret = mop_close_channel(handler);
+  MopErrCode ret = destroy(id);
   DSTATUS("Result of disconnecting pipeline (slot:%d, channel_id:%d) : %d", slot, id, ret);
-
-  return getMopErrCode(ret);
+  return ret;
 }
 
 void MopClient::disconnect(PipelineID id,
@@ -52,3 +52,19 @@ MopErrCode MOP::getMopErrCode(int ret) {
     default : return MOP_UNKNOWN_ERR;
   }
 }
+
+namespace {
+const MopChannelOps linkerChannelOps = {
+    mop_create_channel, mop_destroy_channel, mop_bind_channel,
+    mop_connect_channel, mop_accept_channel, mop_read_channel,
+    mop_write_channel, mop_close_channel};
+const MopChannelOps *channelOps = &linkerChannelOps;
+}
+
+void MOP::setMopChannelOps(const MopChannelOps *ops) {
+  channelOps = ops ? ops : &linkerChannelOps;
+}
+
+const MopChannelOps &MOP::getMopChannelOps() {
+  return *channelOps;
+}
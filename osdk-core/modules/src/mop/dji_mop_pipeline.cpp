@@ -29,41 +29,40 @@
 #include "dji_mop_pipeline.hpp"
 #include "mop.h"
 
-MopPipeline::MopPipeline(PipelineID id, PipelineType type) : id(id),
-                                                             type(type) {
+MopPipeline::MopPipeline(PipelineID id, PipelineType type)
+    : id(id), type(type), channelHandle(NULL), bindHandle(NULL), calls(0),
+      closed(false) {
 }
 
 MopPipeline::~MopPipeline() {
+  closeChannels();
 }
 
 MopErrCode MopPipeline::sendData(DataPackType dataPacket, uint32_t *len) {
-  if (this->channelHandle) {
-    int32_t ret =
-        mop_write_channel(this->channelHandle,
-                          dataPacket.data, dataPacket.length);
-    if (ret < 0) {
-      return getMopErrCode(ret);
-    } else {
-      *len = ret;
-      return MOP_PASSED;
-    }
+  void *channel = beginCall(false);
+  if (!channel) return MOP_UNKNOWN_ERR;
+  int32_t ret =
+      getMopChannelOps().write(channel, dataPacket.data, dataPacket.length);
+  endCall();
+  if (ret < 0) {
+    return getMopErrCode(ret);
   } else {
-    return MOP_UNKNOWN_ERR;
+    *len = ret;
+    return MOP_PASSED;
   }
 }
 
 MopErrCode MopPipeline::recvData(DataPackType dataPacket, uint32_t *len) {
-  if (this->channelHandle) {
-    int32_t ret =
-        mop_read_channel(this->channelHandle, dataPacket.data, dataPacket.length);
-    if (ret < 0) {
-      return getMopErrCode(ret);
-    } else {
-      *len = ret;
-      return MOP_PASSED;
-    }
+  void *channel = beginCall(false);
+  if (!channel) return MOP_UNKNOWN_ERR;
+  int32_t ret =
+      getMopChannelOps().read(channel, dataPacket.data, dataPacket.length);
+  endCall();
+  if (ret < 0) {
+    return getMopErrCode(ret);
   } else {
-    return MOP_UNKNOWN_ERR;
+    *len = ret;
+    return MOP_PASSED;
   }
 }
 
@@ -75,6 +74,48 @@ PipelineType MopPipeline::getType() {
   return this->type;
 }
 
+bool MopPipeline::attach(void *handle, bool bind) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (closed) return false;
+  if (bind) bindHandle = handle;
+  else channelHandle = handle;
+  return true;
+}
+
+void *MopPipeline::beginCall(bool bind) {
+  std::lock_guard<std::mutex> lock(mutex);
+  void *handle = bind ? bindHandle : channelHandle;
+  if (closed || !handle) return NULL;
+  calls++;
+  return handle;
+}
+
+void MopPipeline::endCall() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!--calls && closed) destroyChannels();
+}
+
+int32_t MopPipeline::closeChannels() {
+  const MopChannelOps &ops = getMopChannelOps();
+  int32_t ret = MOP_SUCCESS;
+  std::lock_guard<std::mutex> lock(mutex);
+  if (closed) return ret;
+  closed = true;
+  /*! Does not block, it makes the calls on the channel return */
+  if (channelHandle) ret = ops.close(channelHandle);
+  if (bindHandle) ops.close(bindHandle);
+  if (!calls) destroyChannels();
+  return ret;
+}
+
+void MopPipeline::destroyChannels() {
+  const MopChannelOps &ops = getMopChannelOps();
+  if (channelHandle) ops.destroy(channelHandle);
+  if (bindHandle) ops.destroy(bindHandle);
+  channelHandle = NULL;
+  bindHandle = NULL;
+}
+
 #if 0
 /*! 异步接口目前先不实现 @TODO:add和register的概念,add表示可以支持多个CB同时触发? */
 void MopPipeline::addDataListener(
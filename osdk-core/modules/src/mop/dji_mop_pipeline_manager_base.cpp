@@ -31,59 +31,129 @@
 #include "mop.h"
 #include "mop_entry_osdk.h"
 #include "osdk_command.h"
-#include <map>
-#include <atomic>
 
-map<PipelineID, MopPipeline*> pipelineMap;
-static T_OsdkMutexHandle mopObjectCntMutex;
-static std::atomic<uint16_t> mopObjectCnt(0);
+MopPipelineRegistry::MopPipelineRegistry() : mopTaskUsers(0) {
+}
 
-MopPipelineManagerBase::MopPipelineManagerBase() {
-  if (!mopObjectCntMutex) {
-    E_OsdkStat ret = OsdkOsal_MutexCreate(&mopObjectCntMutex);
-    if(ret != OSDK_STAT_OK) DERROR("mutex create failed !");
+MopPipelineRegistry::~MopPipelineRegistry() {
+}
+
+MopErrCode MopPipelineRegistry::add(PipelineID id, PipelineType type,
+                                    const MopPipelineManagerBase *owner,
+                                    MopPipelinePtr &pipeline) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (pipelines.find(id) != pipelines.end()) return MOP_RESOCCUPIED;
+  pipeline = std::make_shared<MopPipeline>(id, type);
+  Entry entry = {pipeline, owner, false};
+  pipelines.insert(std::make_pair(id, entry));
+  return MOP_PASSED;
+}
+
+bool MopPipelineRegistry::open(PipelineID id, const MopPipeline *pipeline) {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::map<PipelineID, Entry>::iterator it = pipelines.find(id);
+  if (it == pipelines.end() || it->second.pipeline.get() != pipeline)
+    return false;
+  it->second.opened = true;
+  return true;
+}
+
+bool MopPipelineRegistry::contains(PipelineID id, const MopPipeline *pipeline) {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::map<PipelineID, Entry>::iterator it = pipelines.find(id);
+  return it != pipelines.end() && it->second.pipeline.get() == pipeline;
+}
+
+MopPipelinePtr MopPipelineRegistry::remove(
+    PipelineID id, const MopPipelineManagerBase *owner, bool &opened) {
+  MopPipelinePtr pipeline;
+  std::lock_guard<std::mutex> lock(mutex);
+  std::map<PipelineID, Entry>::iterator it = pipelines.find(id);
+  if (it != pipelines.end() && it->second.owner == owner) {
+    pipeline = it->second.pipeline;
+    opened = it->second.opened;
+    pipelines.erase(it);
+  }
+  return pipeline;
+}
+
+bool MopPipelineRegistry::remove(PipelineID id, const MopPipeline *pipeline) {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::map<PipelineID, Entry>::iterator it = pipelines.find(id);
+  if (it == pipelines.end() || it->second.pipeline.get() != pipeline)
+    return false;
+  pipelines.erase(it);
+  return true;
+}
+
+std::vector<MopPipelinePtr> MopPipelineRegistry::removeAll(
+    const MopPipelineManagerBase *owner) {
+  std::vector<MopPipelinePtr> removed;
+  std::lock_guard<std::mutex> lock(mutex);
+  for (std::map<PipelineID, Entry>::iterator it = pipelines.begin();
+       it != pipelines.end();) {
+    if (it->second.owner != owner) {
+      ++it;
+      continue;
+    }
+    removed.push_back(it->second.pipeline);
+    pipelines.erase(it++);
   }
-  OsdkOsal_MutexLock(mopObjectCntMutex);
-  if (!mopObjectCnt) {
+  return removed;
+}
+
+size_t MopPipelineRegistry::size() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return pipelines.size();
+}
+
+void MopPipelineRegistry::retainMopTask() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!mopTaskUsers) {
     DSTATUS("MOP background task now is created .");
     OsdkCommand_CreateMopTask();
   } else {
     DSTATUS("MOP background task is already created .");
   }
-  mopObjectCnt++;
-  OsdkOsal_MutexUnlock(mopObjectCntMutex);
-  pipelineMap.clear();
+  mopTaskUsers++;
 }
 
-MopPipelineManagerBase::~MopPipelineManagerBase() {
-  OsdkOsal_MutexLock(mopObjectCntMutex);
-  if (mopObjectCnt)
-    mopObjectCnt--;
-  if (!mopObjectCnt) {
+void MopPipelineRegistry::releaseMopTask() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (mopTaskUsers && !--mopTaskUsers) {
     DSTATUS("MOP background task now is delete .");
     OsdkCommand_DestroyMopTask();
   }
-  OsdkOsal_MutexUnlock(mopObjectCntMutex);
-  if (!mopObjectCnt && mopObjectCntMutex)
-    OsdkOsal_MutexDestroy(mopObjectCntMutex);
-  pipelineMap.clear();
 }
 
-MopErrCode MopPipelineManagerBase::create(PipelineID id, MopPipeline *&p) {
-  p = new MopPipeline(id, UNRELIABLE);
-  if (p) {
-    pipelineMap.insert(map<PipelineID, MopPipeline *>::value_type(id, p));
-    return MOP_PASSED;
-  } else {
-    return MOP_NOMEM;
+MopPipelineManagerBase::MopPipelineManagerBase() {
+  MopPipelineRegistry::instance().retainMopTask();
+}
+
+MopPipelineManagerBase::~MopPipelineManagerBase() {
+  std::vector<MopPipelinePtr> removed =
+      MopPipelineRegistry::instance().removeAll(this);
+  for (size_t i = 0; i < removed.size(); i++) {
+    DSTATUS("Close pipeline %d left open", removed[i]->getId());
+    removed[i]->closeChannels();
   }
+  MopPipelineRegistry::instance().releaseMopTask();
+}
+
+MopErrCode MopPipelineManagerBase::create(PipelineID id, PipelineType type,
+                                          MopPipelinePtr &p) {
+  return MopPipelineRegistry::instance().add(id, type, this, p);
 }
 
 MopErrCode MopPipelineManagerBase::destroy(PipelineID id) {
-  if (pipelineMap.find(id)!=pipelineMap.end()) {
-    delete pipelineMap[id];
-    pipelineMap.erase(id);
-  }
+  bool opened = false;
+  MopPipelinePtr p = MopPipelineRegistry::instance().remove(id, this, opened);
+  if (!p) return MOP_PARM;
+  /*! A connect or accept still running returns once its call fails */
+  int32_t ret = p->closeChannels();
+  return opened ? getMopErrCode(ret) : MOP_PASSED;
+}
 
-  return MOP_PASSED;
-}
\ No newline at end of file
+mop_trans_t MopPipelineManagerBase::getTransType(PipelineType type) {
+  return (type == RELIABLE) ? MOP_TRANS_RELIABLE : MOP_TRANS_UNRELIABLE;
+}
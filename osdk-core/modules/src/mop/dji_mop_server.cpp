@@ -37,63 +37,73 @@ MopServer::MopServer() : MopPipelineManagerBase() {
 MopServer::~MopServer() {
 }
 
-MopErrCode MopServer::accept(PipelineID id, PipelineType type, MopPipeline *&p) {
+MopErrCode MopServer::accept(PipelineID id, PipelineType type,
+                             MopPipelinePtr &p) {
   int32_t ret;
-  mop_channel_handle_t bind_handle;
+  MopPipelinePtr pipeline;
+  MopPipelineRegistry &registry = MopPipelineRegistry::instance();
+  const MopChannelOps &ops = getMopChannelOps();
 
-  /*! 0.Find whether the pipeline object is existed or not */
+  /*! 0.Create the pipeline object, unless the id is in use */
   DSTATUS("/*! 0.Find whether the pipeline object is existed or not */");
-  if (pipelineMap.find(id) != pipelineMap.end()) {
-    return MOP_RESOCCUPIED;
-  }
+  MopErrCode createRet = create(id, type, pipeline);
+  if (createRet != MOP_PASSED) return createRet;
 
   /*! 1.Create handler for binding */
   DSTATUS("/*! 1.Create handler for binding */");
-  ret = mop_create_channel(&bind_handle, (mop_trans_t)type);
+  mop_channel_handle_t bindChannel = NULL;
+  ret = ops.create(&bindChannel, getTransType(type));
   if (MOP_SUCCESS != ret) {
     DERROR("MOP create channel failed");
+    registry.remove(id, pipeline.get());
     return getMopErrCode(ret);
   }
-
-  /*! 2.Do binding */
-  DSTATUS("/*! 2.Do binding */");
-  ret = mop_bind_channel(bind_handle, id);
-  if (ret != MOP_SUCCESS) {
-    DERROR("MOP Pipeline bind failed");
-    return getMopErrCode(ret);
+  if (!pipeline->attach(bindChannel, true)) {
+    /*! Closed already */
+    ops.destroy(bindChannel);
+    return getMopErrCode(MOP_ERR_CONNECTIONCLOSE);
   }
 
-  /*! 3.Do accepting */
-  p = new MopPipeline(id, type);
-  if (!p) {
-    DERROR("Pipeline create failed");
-    return MOP_NOMEM;
+  /*! 2.Do binding and 3.accepting, a close meanwhile makes them fail */
+  mop_channel_handle_t channel = NULL;
+  void *bindHandle = pipeline->beginCall(true);
+  if (!bindHandle) {
+    ret = MOP_ERR_CONNECTIONCLOSE;
+  } else {
+    DSTATUS("/*! 2.Do binding */");
+    ret = ops.bind(bindHandle, id);
+    if (MOP_SUCCESS != ret) {
+      DERROR("MOP Pipeline bind failed");
+    } else {
+      DSTATUS("/*! 3.Do accepting */");
+      DSTATUS("Do accepting blocking for channel [%d] ...", id);
+      ret = ops.accept(bindHandle, &channel);
+    }
+    pipeline->endCall();
   }
-  DSTATUS("/*! 3.Do accepting */");
-  DSTATUS("Do accepting blocking for channel [%d] ...", id);
-  ret = mop_accept_channel(bind_handle, &p->channelHandle);
-  if (MOP_SUCCESS != ret) {
-    DERROR("MOP accept failed");
-    return getMopErrCode(ret);
+  if (MOP_SUCCESS == ret && !pipeline->attach(channel, false)) {
+    ops.close(channel);
+    ops.destroy(channel);
+    ret = MOP_ERR_CONNECTIONCLOSE;
   }
 
-  /*! 4.Accept finished */
+  /*! 4.Accept finished, unless closed while it was blocking */
   DSTATUS("/*! 4.Accept finished */");
-  pipelineMap[id] = p;
-  DSTATUS("MOP channel [%d] accepted success", id);
-  return MOP_PASSED;
+  if (MOP_SUCCESS == ret && registry.open(id, pipeline.get())) {
+    p = pipeline;
+    DSTATUS("MOP channel [%d] accepted success", id);
+    return MOP_PASSED;
+  }
+  if (MOP_SUCCESS == ret) ret = MOP_ERR_CONNECTIONCLOSE;
+  DERROR("MOP accept failed");
+  registry.remove(id, pipeline.get());
+  pipeline->closeChannels();
+  return getMopErrCode(ret);
 }
 
 MopErrCode MopServer::close(PipelineID id) {
-  int32_t ret;
-  if (pipelineMap.find(id) == pipelineMap.end()) {
-    return MOP_PARM;
-  }
-  mop_channel_handle_t handler = pipelineMap[id];
-
   DSTATUS("Trying to close pipeline channel_id : %d", id);
-  ret = mop_close_channel(handler);
+  MopErrCode ret = destroy(id);
   DSTATUS("Result of close pipeline channel_id:%d : %d", id, ret);
-
-  return getMopErrCode(ret);
-}
\ No newline at end of file
+  return ret;
+}
@@ -29,6 +29,9 @@
 
 #include "dji_platform.hpp"
 #include <new>
+#ifdef __linux__
+#include "dji_linker_statistics.hpp"
+#endif
 
 using namespace DJI;
 using namespace DJI::OSDK;
@@ -47,6 +50,11 @@ bool
 Platform::registerHalUartHandler(const T_OsdkHalUartHandler *halUartHandler)
 {
   E_OsdkStat errCode;
+#ifdef __linux__
+  /*! Route the traffic through the link statistics tap */
+  halUartHandler =
+    LinkerStatistics::instance().wrapUartHandler(halUartHandler);
+#endif
   errCode = OsdkPlatform_RegHalUartHandler(halUartHandler);
 
   if (errCode == OSDK_STAT_OK) {
@@ -62,6 +70,8 @@ Platform::registerHalUartHandler(const T_OsdkHalUartHandler *halUartHandler)
 bool Platform::registerHalUSBBulkHandler(const T_OsdkHalUSBBulkHandler *halUSBBulkHandler)
 {
   E_OsdkStat errCode;
+  halUSBBulkHandler =
+    LinkerStatistics::instance().wrapUSBBulkHandler(halUSBBulkHandler);
   errCode = OsdkPlatform_RegHalUSBBulkHandler(halUSBBulkHandler);
 
   if (errCode == OSDK_STAT_OK) {
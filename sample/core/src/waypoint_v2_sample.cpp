@@ -234,7 +234,10 @@ ErrorCode::ErrorCodeType WaypointV2MissionSample::uploadWaypointMission(int time
   }
   else
   {
-    DSTATUS("Upload waypoint v2 mission successfully!\n");
+    const WaypointV2MissionOperator::UploadProgress &progress =
+      vehiclePtr->waypointV2Mission->getLastUploadProgress();
+    DSTATUS("Upload waypoint v2 mission successfully! %u waypoints in %u ms\n",
+            progress.itemsAcked, progress.elapsedMs);
   }
   return ret;
 }
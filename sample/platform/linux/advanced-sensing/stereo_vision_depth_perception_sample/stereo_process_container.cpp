@@ -38,7 +38,7 @@ StereoProcessContainer::StereoProcessContainer(DJI::OSDK::Vehicle *vehicle)
 
 StereoProcessContainer::~StereoProcessContainer()
 {
-
+  stopPtCloudPipeline();
 }
 
 bool
@@ -205,13 +205,122 @@ StereoProcessContainer::displayStereoPtCloudCallback(DJI::OSDK::Vehicle *vehicle
           pt_cloud_diff.count()*1000.0);
 }
 
+bool
+StereoProcessContainer::startPtCloudPipeline(bool latest_frame_wins)
+{
+  if (stereo_pipeline)
+  {
+    return false;
+  }
+
+  std::vector<std::pair<std::string, StereoPipeline::Stage> > stages;
+  stages.push_back(std::make_pair("rectify", [](StereoFrame &frame) {
+    frame.rectifyImgs();
+  }));
+  stages.push_back(std::make_pair("disparity", [](StereoFrame &frame) {
+    frame.computeDisparityMap();
+  }));
+#ifdef USE_OPEN_CV_CONTRIB
+  stages.push_back(std::make_pair("filter", [](StereoFrame &frame) {
+    frame.filterDisparityMap();
+  }));
+  is_disp_filterd = true;
+#endif
+  stages.push_back(std::make_pair("unproject", [](StereoFrame &frame) {
+    frame.unprojectPtCloud();
+  }));
+  stages.push_back(std::make_pair("display", [this](StereoFrame &frame) {
+    cv::viz::WCloud pt_cloud = frame.getPtCloud();
+    PointCloudViewer::showPointCloud(pt_cloud);
+    PointCloudViewer::spinOnce();
+
+    visualizeRectImgHelper(frame);
+    visualizeDisparityMapHelper(frame);
+    cv::waitKey(1);
+
+    displayPipelineStats();
+  }));
+
+  // The stages already run side by side, splitting the unprojection too
+  // would only make them take turns on the cores
+  pipeline_frames.clear();
+  for (size_t i = 0; i < stages.size() + 1; ++i)
+  {
+    pipeline_frames.push_back(
+      StereoFrame::createStereoFrame(camera_left_ptr, camera_right_ptr, 1));
+  }
+
+  stereo_pipeline.reset(new StereoPipeline(
+    pipeline_frames, latest_frame_wins ? StereoPipeline::LATEST_FRAME_WINS
+                                       : StereoPipeline::KEEP_ALL_FRAMES));
+  for (size_t i = 0; i < stages.size(); ++i)
+  {
+    stereo_pipeline->addStage(stages[i].first, stages[i].second);
+  }
+  return stereo_pipeline->start();
+}
+
+void
+StereoProcessContainer::stopPtCloudPipeline()
+{
+  if (stereo_pipeline)
+  {
+    stereo_pipeline->stop();
+  }
+}
+
+bool
+StereoProcessContainer::submitVGAImg(const DJI::OSDK::ACK::StereoVGAImgData *img)
+{
+  if (!stereo_pipeline)
+  {
+    return false;
+  }
+
+  StereoFrame *frame = stereo_pipeline->acquire();
+  if (!frame)
+  {
+    return false;
+  }
+  frame->readStereoImgs(*img);
+  stereo_pipeline->submit(frame);
+  return true;
+}
+
+void
+StereoProcessContainer::displayPipelineStats()
+{
+  StereoPipeline::Stats stats = stereo_pipeline->getStats();
+  if (stats.completed == 0 || stats.completed % 20 != 0)
+  {
+    return;
+  }
+
+  for (size_t i = 0; i < stats.stages.size(); ++i)
+  {
+    DSTATUS("Stage %s: %.2f ms mean, %.2f ms max, %llu frames dropped before it",
+            stats.stages[i].name.c_str(), stats.stages[i].mean_ms,
+            stats.stages[i].max_ms, (unsigned long long)stats.stages[i].dropped);
+  }
+  DSTATUS("%llu of %llu stereo frames shown, %.2f ms mean latency, %.2f ms max",
+          (unsigned long long)stats.completed,
+          (unsigned long long)stats.submitted,
+          stats.mean_latency_ms, stats.max_latency_ms);
+}
+
 void
 StereoProcessContainer::visualizeRectImgHelper()
+{
+  visualizeRectImgHelper(*stereo_frame_ptr);
+}
+
+void
+StereoProcessContainer::visualizeRectImgHelper(StereoFrame &frame)
 {
   cv::Mat img_to_show;
 
-  cv::hconcat(stereo_frame_ptr->getRectLeftImg(),
-              stereo_frame_ptr->getRectRightImg(),
+  cv::hconcat(frame.getRectLeftImg(),
+              frame.getRectRightImg(),
               img_to_show);
 
   cv::resize(img_to_show, img_to_show,
@@ -230,16 +339,22 @@ StereoProcessContainer::visualizeRectImgHelper()
 
 void
 StereoProcessContainer::visualizeDisparityMapHelper()
+{
+  visualizeDisparityMapHelper(*stereo_frame_ptr);
+}
+
+void
+StereoProcessContainer::visualizeDisparityMapHelper(StereoFrame &frame)
 {
   cv::Mat raw_disp_map;
 #ifdef USE_OPEN_CV_CONTRIB
   if(is_disp_filterd) {
-    raw_disp_map = stereo_frame_ptr->getFilteredDispMap().clone();
+    raw_disp_map = frame.getFilteredDispMap().clone();
   } else {
-    raw_disp_map = stereo_frame_ptr->getDisparityMap().clone();
+    raw_disp_map = frame.getDisparityMap().clone();
   }
 #else
-  raw_disp_map = stereo_frame_ptr->getDisparityMap().clone();
+  raw_disp_map = frame.getDisparityMap().clone();
 #endif
 
   double min_val, max_val;
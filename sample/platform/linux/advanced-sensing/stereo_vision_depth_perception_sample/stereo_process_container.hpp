@@ -4,7 +4,10 @@
 #include "image_process_container.hpp"
 #include "stereo_frame.hpp"
 #include "camera_param.hpp"
+#include "frame_pipeline.hpp"
 #include <chrono>
+#include <memory>
+#include <vector>
 
 
 class StereoProcessContainer : public ImageProcessContainer
@@ -28,13 +31,32 @@ public:
   static void displayStereoPtCloudCallback(DJI::OSDK::Vehicle *vehiclePtr,
                                            DJI::OSDK::UserData userData);
 
+  //! Same output as displayStereoPtCloudCallback, but rectify, disparity,
+  //! filter, unproject and display run on a thread each, on consecutive
+  //! frames. Images go in with submitVGAImg() instead of copyVGAImg().
+  //! @param latest_frame_wins drop a frame waiting for a busy stage when a
+  //! newer one comes, instead of making the frames behind it wait
+  bool startPtCloudPipeline(bool latest_frame_wins = true);
+
+  void stopPtCloudPipeline();
+
+  //! Copies the images straight into a pooled frame, false if the frame
+  //! was dropped
+  bool submitVGAImg(const DJI::OSDK::ACK::StereoVGAImgData *img);
+
 protected:
+  typedef M210_STEREO::FramePipeline<M210_STEREO::StereoFrame> StereoPipeline;
+
   void visualizeRectImgHelper();
+  void visualizeRectImgHelper(M210_STEREO::StereoFrame &frame);
 
   // The disparity map return by stereoFrame is the actual pixel diff
   // The image will be very dimmed if visualize directly
   // this function scales it for visualization purpose
   void visualizeDisparityMapHelper();
+  void visualizeDisparityMapHelper(M210_STEREO::StereoFrame &frame);
+
+  void displayPipelineStats();
 
 protected:
   M210_STEREO::CameraParam::Ptr camera_left_ptr;
@@ -44,6 +66,10 @@ protected:
 
   // for visualization purpose
   bool is_disp_filterd;
+
+  //! A frame per stage plus one being filled, each with its own matcher
+  std::vector<M210_STEREO::StereoFrame::Ptr> pipeline_frames;
+  std::unique_ptr<StereoPipeline>           stereo_pipeline;
 };
 
 
@@ -83,6 +83,7 @@ main(int argc, char** argv)
     << "| [c] Display filtered disparity map                             |\n"
     << "| [d] Display point cloud                                        |\n"
     << "| [e] Unsubscribe to VGA front stereo images                     |\n"
+    << "| [f] Display point cloud, stages pipelined across frames        |\n"
     << std::endl;
   char inputChar = ' ';
   std::cin >> inputChar;
@@ -132,6 +133,14 @@ main(int argc, char** argv)
       vehicle->advancedSensing->unsubscribeVGAImages();
     }
       break;
+    case 'f':
+    {
+      // stages run on their own threads, the "image processing" thread
+      // is not used
+      dynamic_cast<StereoProcessContainer*>(image_process_container_ptr)->startPtCloudPipeline();
+      vehicle->advancedSensing->subscribeFrontStereoVGA(AdvancedSensingProtocol::FREQ_20HZ, &submitStereoImgVGACallback, NULL);
+    }
+      break;
     default:
       break;
   }
@@ -145,6 +154,8 @@ main(int argc, char** argv)
   sleep(1);
   DSTATUS("waited 1 second for the image subscription to stop completely\n");
 
+  dynamic_cast<StereoProcessContainer*>(image_process_container_ptr)->stopPtCloudPipeline();
+
   return 0;
 }
 
@@ -163,3 +174,16 @@ void storeStereoImgVGACallback(Vehicle *vehiclePtr, RecvContainer recvFrame, Use
   // mechanism in image process thread
   image_process_container_ptr->copyVGAImg(recvFrame.recvData.stereoVGAImgData);
 }
+
+//! @note This callback is running on reading thread too, but copies
+//! the images straight into a frame of the pipeline, which takes it
+//! from there
+void submitStereoImgVGACallback(Vehicle *vehiclePtr, RecvContainer recvFrame, UserData userData)
+{
+  if (!dynamic_cast<StereoProcessContainer*>(image_process_container_ptr)
+         ->submitVGAImg(recvFrame.recvData.stereoVGAImgData))
+  {
+    DSTATUS("sample VGACallback dropped the image at frame: %d",
+            recvFrame.recvData.stereoVGAImgData->frame_index);
+  }
+}
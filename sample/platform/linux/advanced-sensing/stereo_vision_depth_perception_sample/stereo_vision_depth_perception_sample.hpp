@@ -23,5 +23,7 @@ ImageProcessContainer* image_process_container_ptr;
 
 static void storeStereoImgVGACallback(DJI::OSDK::Vehicle *vehiclePtr, DJI::OSDK::RecvContainer recvFrame, DJI::OSDK::UserData userData);
 
+static void submitStereoImgVGACallback(DJI::OSDK::Vehicle *vehiclePtr, DJI::OSDK::RecvContainer recvFrame, DJI::OSDK::UserData userData);
+
 
 #endif //ONBOARDSDK_ADVANCED_SENSING_DEPTH_PERCEPTION_SAMPLE_HPP
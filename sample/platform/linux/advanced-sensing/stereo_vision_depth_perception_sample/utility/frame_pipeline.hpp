@@ -0,0 +1,375 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef ONBOARDSDK_FRAME_PIPELINE_H
+#define ONBOARDSDK_FRAME_PIPELINE_H
+
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace M210_STEREO
+{
+
+//! Runs the stages of frame processing on a thread each, so consecutive
+//! frames are in different stages at the same time.
+//!
+//! The frames are a fixed pool handed to the pipeline. A frame is filled
+//! after acquire(), submitted, and goes from stage to stage as a pointer;
+//! after the last stage it is free again. Between two stages there is room
+//! for one frame waiting, what happens when a frame finds it taken is the
+//! policy.
+template <typename Frame>
+class FramePipeline
+{
+public:
+  typedef std::shared_ptr<Frame> FramePtr;
+  typedef std::function<void(Frame &)> Stage;
+  typedef std::chrono::steady_clock Clock;
+
+  enum Policy
+  {
+    //! A frame waiting for a stage is dropped for a newer one, and acquire()
+    //! takes the frame waiting for the first stage when none is free
+    LATEST_FRAME_WINS,
+    //! Every submitted frame goes through every stage. acquire(), submit()
+    //! and the stages wait for room instead.
+    KEEP_ALL_FRAMES
+  };
+
+  struct StageStats
+  {
+    std::string name;
+    uint64_t    frames;
+    //! Frames dropped while waiting for this stage
+    uint64_t    dropped;
+    double      mean_ms;
+    double      max_ms;
+  };
+
+  struct Stats
+  {
+    std::vector<StageStats> stages;
+    uint64_t submitted;
+    uint64_t completed;
+    //! acquire() found no frame
+    uint64_t not_acquired;
+    //! From submit() to the end of the last stage
+    double   mean_latency_ms;
+    double   max_latency_ms;
+  };
+
+  FramePipeline(const std::vector<FramePtr> &frames, Policy policy)
+    : policy_(policy)
+    , running_(false)
+    , submitted_(0)
+    , completed_(0)
+    , not_acquired_(0)
+    , latency_total_ns_(0)
+    , latency_max_ns_(0)
+  {
+    slots_.resize(frames.size());
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+      slots_[i].frame = frames[i];
+      free_.push_back(&slots_[i]);
+    }
+  }
+
+  ~FramePipeline()
+  {
+    stop();
+  }
+
+  FramePipeline(const FramePipeline &other) = delete;
+  FramePipeline &operator=(const FramePipeline &other) = delete;
+
+  //! Stages run in the order they are added, all before start()
+  void addStage(const std::string &name, Stage stage)
+  {
+    StageInfo info;
+    info.name     = name;
+    info.stage    = stage;
+    info.frames   = 0;
+    info.dropped  = 0;
+    info.total_ns = 0;
+    info.max_ns   = 0;
+    stages_.push_back(info);
+    waiting_.push_back(NULL);
+  }
+
+  bool start()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_ || stages_.empty())
+    {
+      return false;
+    }
+    running_ = true;
+    for (size_t i = 0; i < stages_.size(); ++i)
+    {
+      threads_.push_back(std::thread(&FramePipeline::stageLoop, this, i));
+    }
+    return true;
+  }
+
+  //! Returns once every stage finished the frame it was working on. The
+  //! frames still waiting are dropped.
+  void stop()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      running_ = false;
+    }
+    cv_.notify_all();
+    for (size_t i = 0; i < threads_.size(); ++i)
+    {
+      threads_[i].join();
+    }
+    threads_.clear();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < waiting_.size(); ++i)
+    {
+      if (waiting_[i])
+      {
+        free_.push_back(waiting_[i]);
+        waiting_[i] = NULL;
+      }
+    }
+  }
+
+  //! A frame to fill and submit, NULL when the pipeline is stopped or, with
+  //! LATEST_FRAME_WINS, every frame is in a stage
+  Frame *acquire()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_)
+    {
+      if (!free_.empty())
+      {
+        Slot *slot = free_.back();
+        free_.pop_back();
+        return slot->frame.get();
+      }
+      if (policy_ == LATEST_FRAME_WINS)
+      {
+        if (waiting_[0])
+        {
+          Slot *slot  = waiting_[0];
+          waiting_[0] = NULL;
+          stages_[0].dropped++;
+          return slot->frame.get();
+        }
+        break;
+      }
+      cv_.wait(lock);
+    }
+    not_acquired_++;
+    return NULL;
+  }
+
+  //! Hands a frame from acquire() to the first stage
+  void submit(Frame *frame)
+  {
+    Slot *slot = findSlot(frame);
+    if (!slot)
+    {
+      return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    slot->submitted = Clock::now();
+    submitted_++;
+    if (!handOver(lock, 0, slot))
+    {
+      free_.push_back(slot);
+    }
+  }
+
+  //! Gives back a frame from acquire() without submitting it
+  void release(Frame *frame)
+  {
+    Slot *slot = findSlot(frame);
+    if (slot)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      free_.push_back(slot);
+    }
+    cv_.notify_all();
+  }
+
+  Stats getStats()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    for (size_t i = 0; i < stages_.size(); ++i)
+    {
+      StageStats stage;
+      stage.name    = stages_[i].name;
+      stage.frames  = stages_[i].frames;
+      stage.dropped = stages_[i].dropped;
+      stage.mean_ms = stages_[i].frames
+                        ? stages_[i].total_ns / 1e6 / stages_[i].frames
+                        : 0;
+      stage.max_ms  = stages_[i].max_ns / 1e6;
+      stats.stages.push_back(stage);
+    }
+    stats.submitted       = submitted_;
+    stats.completed       = completed_;
+    stats.not_acquired    = not_acquired_;
+    stats.mean_latency_ms = completed_ ? latency_total_ns_ / 1e6 / completed_ : 0;
+    stats.max_latency_ms  = latency_max_ns_ / 1e6;
+    return stats;
+  }
+
+protected:
+  struct Slot
+  {
+    FramePtr          frame;
+    Clock::time_point submitted;
+  };
+
+  struct StageInfo
+  {
+    std::string name;
+    Stage       stage;
+    uint64_t    frames;
+    uint64_t    dropped;
+    uint64_t    total_ns;
+    uint64_t    max_ns;
+  };
+
+  Slot *findSlot(Frame *frame)
+  {
+    for (size_t i = 0; i < slots_.size(); ++i)
+    {
+      if (slots_[i].frame.get() == frame)
+      {
+        return &slots_[i];
+      }
+    }
+    return NULL;
+  }
+
+  //! Puts slot in front of stage, false if the pipeline stopped meanwhile
+  bool handOver(std::unique_lock<std::mutex> &lock, size_t stage, Slot *slot)
+  {
+    if (policy_ == KEEP_ALL_FRAMES)
+    {
+      while (running_ && waiting_[stage])
+      {
+        cv_.wait(lock);
+      }
+    }
+    if (!running_)
+    {
+      return false;
+    }
+    if (waiting_[stage])
+    {
+      free_.push_back(waiting_[stage]);
+      stages_[stage].dropped++;
+    }
+    waiting_[stage] = slot;
+    cv_.notify_all();
+    return true;
+  }
+
+  void stageLoop(size_t index)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+      while (running_ && !waiting_[index])
+      {
+        cv_.wait(lock);
+      }
+      if (!running_)
+      {
+        return;
+      }
+      Slot *slot      = waiting_[index];
+      waiting_[index] = NULL;
+      cv_.notify_all();
+      lock.unlock();
+
+      Clock::time_point begin = Clock::now();
+      stages_[index].stage(*slot->frame);
+      Clock::time_point end = Clock::now();
+
+      lock.lock();
+      uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+      StageInfo &info = stages_[index];
+      info.frames++;
+      info.total_ns += ns;
+      info.max_ns = std::max(info.max_ns, ns);
+
+      if (index + 1 < stages_.size())
+      {
+        if (!handOver(lock, index + 1, slot))
+        {
+          free_.push_back(slot);
+        }
+        continue;
+      }
+
+      uint64_t latency_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - slot->submitted).count();
+      completed_++;
+      latency_total_ns_ += latency_ns;
+      latency_max_ns_ = std::max(latency_max_ns_, latency_ns);
+      free_.push_back(slot);
+      cv_.notify_all();
+    }
+  }
+
+protected:
+  Policy policy_;
+
+  std::vector<Slot>      slots_;
+  std::vector<Slot *>    free_;
+  //! Frame waiting in front of every stage, NULL for none
+  std::vector<Slot *>    waiting_;
+  std::vector<StageInfo> stages_;
+
+  std::vector<std::thread> threads_;
+  std::mutex               mutex_;
+  std::condition_variable  cv_;
+  bool                     running_;
+
+  uint64_t submitted_;
+  uint64_t completed_;
+  uint64_t not_acquired_;
+  uint64_t latency_total_ns_;
+  uint64_t latency_max_ns_;
+};
+
+} // namespace M210_STEREO
+
+#endif //ONBOARDSDK_FRAME_PIPELINE_H
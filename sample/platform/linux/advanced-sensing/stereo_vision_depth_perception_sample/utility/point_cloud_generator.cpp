@@ -0,0 +1,178 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "point_cloud_generator.hpp"
+#include <string.h>
+#include <algorithm>
+
+using namespace M210_STEREO;
+
+PointCloudGenerator::PointCloudGenerator(int width, int height, int border,
+                                         int num_threads)
+  : width_(width)
+  , height_(height)
+  , border_(border)
+  , column_factor_(width, 0.0f)
+  , points_(width * height)
+  , disparity_(NULL)
+  , disparity_step_(0)
+  , intensity_(NULL)
+  , intensity_step_(0)
+  , num_bands_(1)
+  , frame_seq_(0)
+  , busy_workers_(0)
+  , quit_(false)
+{
+  memset(&model_, 0, sizeof(model_));
+  memset(&points_[0], 0, points_.size() * sizeof(PointXYZI));
+
+  if (num_threads <= 0)
+  {
+    num_threads = std::min(4, (int)std::thread::hardware_concurrency());
+  }
+  num_bands_ = std::max(1, std::min(num_threads, height_));
+  for (int i = 1; i < num_bands_; ++i)
+  {
+    workers_.push_back(std::thread(&PointCloudGenerator::workerLoop, this, i));
+  }
+}
+
+PointCloudGenerator::~PointCloudGenerator()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    quit_ = true;
+  }
+  frame_cv_.notify_all();
+  for (size_t i = 0; i < workers_.size(); ++i)
+  {
+    workers_[i].join();
+  }
+}
+
+void
+PointCloudGenerator::setCameraModel(const CameraModel &model)
+{
+  model_ = model;
+  for (int u = 0; u < width_; ++u)
+  {
+    column_factor_[u] = (u - model_.principal_x) / model_.fx;
+  }
+}
+
+void
+PointCloudGenerator::unproject(const int16_t *disparity, size_t disparity_step,
+                               const uint8_t *intensity, size_t intensity_step)
+{
+  disparity_      = disparity;
+  disparity_step_ = disparity_step;
+  intensity_      = intensity;
+  intensity_step_ = intensity_step;
+
+  if (num_bands_ > 1)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    busy_workers_ = num_bands_ - 1;
+    ++frame_seq_;
+  }
+  frame_cv_.notify_all();
+
+  unprojectRows(0, height_ / num_bands_);
+
+  if (num_bands_ > 1)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return busy_workers_ == 0; });
+  }
+}
+
+void
+PointCloudGenerator::workerLoop(int index)
+{
+  uint64_t seen_seq = 0;
+
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      frame_cv_.wait(lock, [this, seen_seq] { return quit_ || frame_seq_ != seen_seq; });
+      if (quit_)
+      {
+        return;
+      }
+      seen_seq = frame_seq_;
+    }
+
+    unprojectRows(height_ * index / num_bands_,
+                  height_ * (index + 1) / num_bands_);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      --busy_workers_;
+    }
+    done_cv_.notify_one();
+  }
+}
+
+void
+PointCloudGenerator::unprojectRows(int row_begin, int row_end)
+{
+  // due to rectification, the image boarder are blank
+  // we cut them out
+  const int u_begin = border_;
+  const int u_end   = width_ - border_;
+  const int min_raw = MIN_DISPARITY * 16;
+  const float baseline_x_fx = model_.baseline_x_fx;
+  const float *column_factor = &column_factor_[0];
+
+  for (int v = row_begin; v < row_end; ++v)
+  {
+    PointXYZI *row = &points_[v * width_];
+    if (v < border_ || v >= height_ - border_ || u_begin >= u_end)
+    {
+      memset(row, 0, width_ * sizeof(PointXYZI));
+      continue;
+    }
+
+    const int16_t *disparity = disparity_ + v * disparity_step_;
+    const uint8_t *intensity = intensity_ + v * intensity_step_;
+    const float row_factor = (v - model_.principal_y) / model_.fy;
+
+    memset(row, 0, u_begin * sizeof(PointXYZI));
+    memset(row + u_end, 0, (width_ - u_end) * sizeof(PointXYZI));
+
+    // Branch-free so the compiler turns it into SIMD: every disparity is
+    // divided, clamped so it cannot be 0, and a point too far away gets a
+    // numerator of 0. The check is on the raw disparity, exact in 1/16
+    for (int u = u_begin; u < u_end; ++u)
+    {
+      const int   raw     = disparity[u];
+      const int   clamped = raw < min_raw ? min_raw : raw;
+      const float num     = raw >= min_raw ? baseline_x_fx : 0.0f;
+      const float z       = num / (clamped * 0.0625f);
+
+      row[u].x         = column_factor[u] * z;
+      row[u].y         = row_factor * z;
+      row[u].z         = z;
+      row[u].intensity = intensity[u];
+    }
+  }
+}
@@ -0,0 +1,120 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef ONBOARDSDK_POINT_CLOUD_GENERATOR_H
+#define ONBOARDSDK_POINT_CLOUD_GENERATOR_H
+
+#include <stdint.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace M210_STEREO
+{
+
+//! A point in the left rectified camera frame, in metres. Layout matches a
+//! CV_32FC4 Mat, so the points can be handed to OpenCV without a copy.
+struct PointXYZI
+{
+  float x;
+  float y;
+  float z;
+  float intensity;
+};
+
+//! Unprojects a disparity map into an organised point cloud, one point per
+//! pixel with the points outside the border or too far away left at 0.
+//! The rows are split between the calling thread and a few worker threads
+//! kept for the life of the generator, the output buffer is reused.
+//! Does not depend on OpenCV.
+class PointCloudGenerator
+{
+public:
+  struct CameraModel
+  {
+    float principal_x;
+    float principal_y;
+    float fx;
+    float fy;
+    //! -Tx of the right projection matrix, baseline times fx
+    float baseline_x_fx;
+  };
+
+  //! @param border pixels left out on every side, blank after rectification
+  //! @param num_threads threads sharing the rows, the caller included.
+  //! 0 picks one per core, at most 4
+  PointCloudGenerator(int width, int height, int border, int num_threads = 0);
+  ~PointCloudGenerator();
+
+  PointCloudGenerator(const PointCloudGenerator &other) = delete;
+  PointCloudGenerator &operator=(const PointCloudGenerator &other) = delete;
+
+  void setCameraModel(const CameraModel &model);
+
+  //! @param disparity disparity in 1/16 pixel as StereoBM gives it
+  //! @param intensity rectified left image the points take their intensity from
+  //! @param disparity_step, intensity_step row strides in elements
+  void unproject(const int16_t *disparity, size_t disparity_step,
+                 const uint8_t *intensity, size_t intensity_step);
+
+  //! width x height points, row by row
+  inline const std::vector<PointXYZI> &getPoints() const { return points_; }
+
+  inline int getWidth() const { return width_; }
+  inline int getHeight() const { return height_; }
+
+  //! Points closer than this disparity, about 8.6m, are left at 0
+  static const int MIN_DISPARITY = 6;
+
+protected:
+  void unprojectRows(int row_begin, int row_end);
+  void workerLoop(int index);
+
+protected:
+  int width_;
+  int height_;
+  int border_;
+  CameraModel model_;
+  //! (u - cx) / fx of every column
+  std::vector<float> column_factor_;
+  std::vector<PointXYZI> points_;
+
+  //! Input of the frame being unprojected
+  const int16_t *disparity_;
+  size_t disparity_step_;
+  const uint8_t *intensity_;
+  size_t intensity_step_;
+
+  //! Row bands, one for the caller and one per worker
+  int num_bands_;
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable frame_cv_;
+  std::condition_variable done_cv_;
+  uint64_t frame_seq_;
+  int busy_workers_;
+  bool quit_;
+};
+
+} // namespace M210_STEREO
+
+#endif //ONBOARDSDK_POINT_CLOUD_GENERATOR_H
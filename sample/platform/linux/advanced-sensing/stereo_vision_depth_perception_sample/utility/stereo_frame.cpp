@@ -26,16 +26,14 @@ using namespace cv;
 
 StereoFrame::StereoFrame(CameraParam::Ptr left_cam,
                          CameraParam::Ptr right_cam,
-                         int num_disp, int block_size)
+                         int num_disp, int block_size,
+                         int unproject_threads)
   : camera_left_ptr_(left_cam)
   , camera_right_ptr_(right_cam)
   , num_disp_(num_disp)
   , block_size_(block_size)
-  , color_buffer_(VGA_WIDTH*VGA_HEIGHT)
-  , mat_vec3_pt_(VGA_HEIGHT, VGA_WIDTH, Vec3f(0, 0, 0))
-  , color_mat_(VGA_HEIGHT, VGA_WIDTH, CV_8UC1, &color_buffer_[0])
-  , pt_cloud_(mat_vec3_pt_, color_mat_)
   , raw_disparity_map_(Mat(VGA_HEIGHT, VGA_WIDTH, CV_16SC1))
+  , pt_cloud_generator_(VGA_WIDTH, VGA_HEIGHT, num_disp, unproject_threads)
 {
   if(!this->initStereoParam())
   {
@@ -68,6 +66,14 @@ StereoFrame::initStereoParam()
   fy_ = param_proj_left_.at<double>(1, 1);
   baseline_x_fx_ = -param_proj_right_.at<double>(0, 3);
 
+  PointCloudGenerator::CameraModel camera_model;
+  camera_model.principal_x   = principal_x_;
+  camera_model.principal_y   = principal_y_;
+  camera_model.fx            = fx_;
+  camera_model.fy            = fy_;
+  camera_model.baseline_x_fx = baseline_x_fx_;
+  pt_cloud_generator_.setCameraModel(camera_model);
+
   initUndistortRectifyMap(camera_left_ptr_->getIntrinsic(),
                               camera_left_ptr_->getDistortion(),
                               param_rect_left_,
@@ -87,6 +93,17 @@ StereoFrame::initStereoParam()
       cuda_rectified_mapping_[k][i].upload(rectified_mapping_[k][i]);
     }
   }
+#else
+  // remap() takes float maps apart into these for every block of every
+  // image, doing it once gives the same images
+  for (int k = 0; k < 2; ++k) {
+    convertMaps(rectified_mapping_[k][0], rectified_mapping_[k][1],
+                fixed_rectified_mapping_[k][0], fixed_rectified_mapping_[k][1],
+                CV_16SC2);
+  }
+#endif
+
+#ifdef USE_GPU
 
   block_matcher_ = cuda::createStereoBM(num_disp_, block_size_);
 #else
@@ -105,9 +122,11 @@ StereoFrame::initStereoParam()
 }
 
 StereoFrame::Ptr
-StereoFrame::createStereoFrame(CameraParam::Ptr left_cam, CameraParam::Ptr right_cam)
+StereoFrame::createStereoFrame(CameraParam::Ptr left_cam, CameraParam::Ptr right_cam,
+                               int unproject_threads)
 {
-  return std::make_shared<StereoFrame>(left_cam, right_cam);
+  return std::make_shared<StereoFrame>(left_cam, right_cam, 64, 13,
+                                       unproject_threads);
 }
 
 void
@@ -142,10 +161,13 @@ StereoFrame::rectifyImgs()
                   INTER_LINEAR);
   cuda_rectified_img_right_.download(rectified_img_right_);
 #else
+  // remap() splits the rows between threads and reuses the output images
   remap(frame_left_ptr_->getImg(), rectified_img_left_,
-            rectified_mapping_[0][0], rectified_mapping_[0][1], INTER_LINEAR);
+            fixed_rectified_mapping_[0][0], fixed_rectified_mapping_[0][1],
+            INTER_LINEAR);
   remap(frame_right_ptr_->getImg(), rectified_img_right_,
-            rectified_mapping_[1][0], rectified_mapping_[1][1], INTER_LINEAR);
+            fixed_rectified_mapping_[1][0], fixed_rectified_mapping_[1][1],
+            INTER_LINEAR);
 #endif
 }
 
@@ -196,43 +218,26 @@ StereoFrame::filterDisparityMap()
 void
 StereoFrame::unprojectPtCloud()
 {
-  // due to rectification, the image boarder are blank
-  // we cut them out
-  const int border_size = num_disp_;
-  const int trunc_img_width_end = VGA_WIDTH - border_size;
-  const int trunc_img_height_end = VGA_HEIGHT - border_size;
-
-  mat_vec3_pt_ = Mat_<Vec3f>(VGA_HEIGHT, VGA_WIDTH, Vec3f(0, 0, 0));
-
-  for(int v = border_size; v < trunc_img_height_end; ++v)
-  {
-    for(int u = border_size; u < trunc_img_width_end; ++u)
-    {
-      Vec3f &point = mat_vec3_pt_.at<Vec3f>(v, u);
-
 #ifdef USE_OPEN_CV_CONTRIB
-      float disparity = (float)(filtered_disparity_map_.at<short int>(v, u)*0.0625);
+  const Mat &disparity = filtered_disparity_map_;
 #else
-      float disparity = (float)(raw_disparity_map_.at<short int>(v, u)*0.0625);
+  const Mat &disparity = raw_disparity_map_;
 #endif
 
-      // do not consider pts that are farther than 8.6m, i.e. disparity < 6
-      if(disparity >= 6)
-      {
-        point[2] = baseline_x_fx_/disparity;
-        point[0] = (u-principal_x_)*point[2]/fx_;
-        point[1] = (v-principal_y_)*point[2]/fy_;
-      }
-      color_buffer_[v*VGA_WIDTH+u] = rectified_img_left_.at<uint8_t>(v, u);
-    }
-  }
+  pt_cloud_generator_.unproject(disparity.ptr<int16_t>(),
+                                disparity.step1(),
+                                rectified_img_left_.ptr<uint8_t>(),
+                                rectified_img_left_.step1());
+}
 
-  color_mat_ = cv::Mat(VGA_HEIGHT, VGA_WIDTH, CV_8UC1, &color_buffer_[0]).clone();
+viz::WCloud
+StereoFrame::getPtCloud()
+{
+  // PointXYZI lays out like CV_32FC4, viz ignores the 4th channel. Colours
+  // come from the rectified image, the points in the border are at 0
+  // whatever their colour.
+  const std::vector<PointXYZI> &points = pt_cloud_generator_.getPoints();
+  Mat cloud(VGA_HEIGHT, VGA_WIDTH, CV_32FC4, (void *)&points[0]);
 
-  // @note Unfortunately, calling this WCloud constructor costs about the same amount
-  // of time as we go through each pixel and unproject the pt cloud. Because there's
-  // another nested for-loop inside WCloud implementation
-  // Ideally these can be done in one shot but it involves changing openCV implementation
-  // TODO maybe opencv projectPoints() is a good alternative
-  pt_cloud_ = viz::WCloud(mat_vec3_pt_, color_mat_);
-}
\ No newline at end of file
+  return viz::WCloud(cloud, rectified_img_left_);
+}
@@ -8,6 +8,7 @@
 #include "dji_ack.hpp"
 #include "dji_log.hpp"
 #include "point_cloud_viewer.hpp"
+#include "point_cloud_generator.hpp"
 
 #ifdef USE_GPU
   #include <opencv2/cudastereo.hpp>
@@ -26,13 +27,17 @@ class StereoFrame
 public:
   typedef std::shared_ptr<StereoFrame> Ptr;
 
+  //! @param unproject_threads threads unprojecting the point cloud, 0 for
+  //! one per core
   StereoFrame(CameraParam::Ptr left_cam, CameraParam::Ptr right_cam,
-              int num_disp = 64, int block_size = 13);
+              int num_disp = 64, int block_size = 13,
+              int unproject_threads = 0);
   ~StereoFrame();
 
 public:
   static StereoFrame::Ptr createStereoFrame(CameraParam::Ptr left_cam,
-                                            CameraParam::Ptr right_cam);
+                                            CameraParam::Ptr right_cam,
+                                            int unproject_threads = 0);
 
   void readStereoImgs(const DJI::OSDK::ACK::StereoVGAImgData &imgs);
 
@@ -50,7 +55,15 @@ public:
 
   inline cv::Mat getDisparityMap() { return this->disparity_map_8u_; }
 
-  inline cv::viz::WCloud getPtCloud() { return this->pt_cloud_; }
+  //! Builds a viz widget of the last point cloud, as costly as unprojecting
+  //! it, so only worth it for showing the cloud
+  cv::viz::WCloud getPtCloud();
+
+  //! The last point cloud, VGA_WIDTH x VGA_HEIGHT points row by row
+  inline const std::vector<PointXYZI> &getPtCloudPoints()
+  {
+    return this->pt_cloud_generator_.getPoints();
+  }
 
 #ifdef USE_OPEN_CV_CONTRIB
   inline cv::Mat getFilteredDispMap() { return this->filtered_disparity_map_8u_; }
@@ -74,7 +87,10 @@ protected:
   cv::Mat param_proj_left_;
   cv::Mat param_proj_right_;
 
+  //! Float maps, and the fixed-point maps remap() would otherwise convert
+  //! them to on every call
   cv::Mat rectified_mapping_[2][2];
+  cv::Mat fixed_rectified_mapping_[2][2];
 
   //! Rectified images
   cv::Mat rectified_img_left_;
@@ -93,10 +109,7 @@ protected:
   double fx_;
   double fy_;
   double baseline_x_fx_;
-  std::vector<uint8_t>  color_buffer_;
-  cv::Mat               color_mat_;
-  cv::Mat_<cv::Vec3f>   mat_vec3_pt_;
-  cv::viz::WCloud       pt_cloud_;
+  PointCloudGenerator   pt_cloud_generator_;
 
 #ifdef USE_GPU
   cv::cuda::GpuMat  cuda_rectified_mapping_[2][2];
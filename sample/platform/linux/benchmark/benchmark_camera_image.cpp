@@ -0,0 +1,228 @@
+/*! @file benchmark_camera_image.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief
+ *  The latest decoded camera image shared with many readers: a writer
+ *  publishing 720p images as fast as it can while eight readers wait for
+ *  each newer one. Readers check every image is the one its sequence says
+ *  and is not rewritten while they hold it; the writer's time per image is
+ *  what the decoder pays.
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "osdk_benchmark.hpp"
+
+#ifdef ADVANCED_SENSING
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "dji_camera_image_handler.hpp"
+
+namespace
+{
+
+const int      IMAGE_WIDTH   = 1280;
+const int      IMAGE_HEIGHT  = 720;
+const size_t   IMAGE_LEN     = IMAGE_WIDTH * IMAGE_HEIGHT * 3;
+const int      IMAGE_READERS = 8;
+/* What a reader looks at of each image, as a detector would */
+const size_t   IMAGE_READ_LEN = 64 * 1024;
+
+typedef std::chrono::steady_clock Clock;
+
+int64_t
+nowNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+           Clock::now().time_since_epoch())
+    .count();
+}
+
+/*! Every image carries its sequence at both ends and when it was published
+ *  after the first one */
+void
+stamp(uint8_t* image, uint64_t sequence)
+{
+  int64_t published = nowNs();
+  memcpy(image, &sequence, sizeof(sequence));
+  memcpy(image + sizeof(sequence), &published, sizeof(published));
+  memcpy(image + IMAGE_LEN - sizeof(sequence), &sequence, sizeof(sequence));
+}
+
+struct ImageReaders
+{
+  DJICameraImageHandler handler;
+  /* Published so far, the sequence of the next is one more */
+  uint64_t              published;
+  std::vector<uint8_t>  source;
+
+  std::atomic<uint64_t> images;
+  /* Not the image of its sequence, or a sequence not newer */
+  std::atomic<uint64_t> wrong;
+  /* Rewritten while a reader held it */
+  std::atomic<uint64_t> torn;
+  std::atomic<int64_t>  totalDelayNs;
+  std::atomic<int64_t>  maxDelayNs;
+  std::atomic<uint64_t> checksum;
+
+  ImageReaders()
+    : published(0)
+    , source(IMAGE_LEN, 0x5A)
+    , images(0)
+    , wrong(0)
+    , torn(0)
+    , totalDelayNs(0)
+    , maxDelayNs(0)
+    , checksum(0)
+  {
+  }
+
+  void read(const std::atomic<bool>& running)
+  {
+    uint64_t sequence = 0;
+    uint64_t sum      = 0;
+    while (running)
+    {
+      uint64_t          previous = sequence;
+      CameraRGBImagePtr image;
+      if (!handler.waitForNewerImage(sequence, image, 100))
+      {
+        continue;
+      }
+      int64_t delay = nowNs();
+
+      const uint8_t* data = image->rawData.data();
+      uint64_t       head, tail;
+      int64_t        publishedNs;
+      memcpy(&head, data, sizeof(head));
+      memcpy(&publishedNs, data + sizeof(head), sizeof(publishedNs));
+      memcpy(&tail, data + IMAGE_LEN - sizeof(tail), sizeof(tail));
+      if (sequence <= previous || head != sequence || tail != sequence ||
+          image->rawData.size() != IMAGE_LEN)
+      {
+        wrong++;
+      }
+      delay -= publishedNs;
+
+      for (size_t i = 0; i < IMAGE_READ_LEN; i += 64)
+      {
+        sum += data[i];
+      }
+      memcpy(&head, data, sizeof(head));
+      memcpy(&tail, data + IMAGE_LEN - sizeof(tail), sizeof(tail));
+      if (head != sequence || tail != sequence)
+      {
+        torn++;
+      }
+
+      images++;
+      totalDelayNs += delay;
+      int64_t max = maxDelayNs;
+      while (delay > max && !maxDelayNs.compare_exchange_weak(max, delay))
+      {
+      }
+    }
+    checksum += sum;
+  }
+
+  /*! Readers on their own threads while the operation runs */
+  void readAll(const std::atomic<bool>& running, const std::string& name)
+  {
+    images = wrong = torn = 0;
+    totalDelayNs = maxDelayNs = 0;
+    std::vector<std::thread> readers;
+    for (int i = 0; i < IMAGE_READERS; i++)
+    {
+      readers.push_back(std::thread(&ImageReaders::read, this, std::cref(running)));
+    }
+    for (size_t i = 0; i < readers.size(); i++)
+    {
+      readers[i].join();
+    }
+
+    printf("%s: %d readers took %llu images, %.1f us mean and %.1f us max "
+           "after publishing\n",
+           name.c_str(), IMAGE_READERS, (unsigned long long)images.load(),
+           images ? totalDelayNs / 1000.0 / images : 0.0,
+           maxDelayNs / 1000.0);
+    if (wrong || torn)
+    {
+      std::cout << name << ": " << wrong << " images not the ones published, "
+                << torn << " rewritten while held\n";
+    }
+  }
+};
+
+void
+addReaders(BenchmarkRunner& runner, const std::string& name,
+           uint64_t iterations, bool copy)
+{
+  std::shared_ptr<ImageReaders> readers(new ImageReaders);
+  runner.add(name, iterations,
+             [readers, copy]() -> uint32_t {
+               uint64_t sequence = ++readers->published;
+               if (copy)
+               {
+                 stamp(&readers->source[0], sequence);
+                 readers->handler.writeNewImageWithLock(
+                   &readers->source[0], IMAGE_LEN, IMAGE_WIDTH, IMAGE_HEIGHT);
+               }
+               else
+               {
+                 std::shared_ptr<CameraRGBImage> image =
+                   readers->handler.acquireImage(IMAGE_WIDTH, IMAGE_HEIGHT);
+                 stamp(image->rawData.data(), sequence);
+                 readers->handler.publishImage(image);
+               }
+               return copy ? (uint32_t)IMAGE_LEN : 0;
+             },
+             [readers, name](const std::atomic<bool>& running) {
+               readers->readAll(running, name);
+             });
+}
+
+} // namespace
+
+void
+registerCameraImageBenchmarks(BenchmarkRunner& runner)
+{
+  /* As the decoder publishes: converted into an image acquired from the
+   * handler, no copy */
+  addReaders(runner, "camera_image/publish_720p_8_readers", 5000, false);
+
+  /* The copy into the handler an application writing its own images pays */
+  addReaders(runner, "camera_image/write_copy_720p_8_readers", 1000, true);
+}
+#else
+void
+registerCameraImageBenchmarks(BenchmarkRunner& runner)
+{
+  (void)runner;
+}
+#endif
@@ -0,0 +1,616 @@
+/*! @file benchmark_decode.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief
+ *  H.264 decoding of the camera stream without a camera: decode throughput
+ *  of DJICameraStreamDecoder, frame delivery of DJICameraStream replaying
+ *  a file, three cameras decoding at once, and the decode policy keeping
+ *  up with a slow consumer. The synthetic stream decodes to known pictures, so every frame is
+ *  checked against the RGB conversion of the picture it was made from.
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "osdk_benchmark.hpp"
+
+#ifdef ADVANCED_SENSING
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "dji_camera_decode_pool.hpp"
+#include "dji_camera_stream.hpp"
+#include "dji_camera_stream_decoder.hpp"
+#include "dji_camera_stream_file_source.hpp"
+#include "dji_sim_h264_stream.hpp"
+
+namespace
+{
+
+/* The main camera's resolution */
+const uint32_t DECODE_WIDTH    = 1280;
+const uint32_t DECODE_HEIGHT   = 720;
+const uint32_t DECODE_PICTURES = 30;
+/* What a read of the UDT link typically returns */
+const uint32_t DECODE_CHUNK    = 16 * 1024;
+/* DJICameraStream does not flush its decoder, so the last pictures can stay
+ * in it: one the parser holds until the next access unit starts, one per
+ * thread */
+const uint32_t DECODE_HELD_BACK = 5;
+
+const char* DECODE_STREAM_PATH = "/tmp/osdk-benchmark-decode.h264";
+
+/* Three seconds at 30 fps with a keyframe every ten pictures, for a
+ * consumer taking longer than a frame interval over every frame */
+const uint32_t SLOW_PICTURES     = 90;
+const uint32_t SLOW_KEY_INTERVAL = 10;
+const uint32_t SLOW_CONSUMER_MS  = 50;
+const int      SLOW_MAX_LATENCY_MS = 150;
+const char*    SLOW_STREAM_PATH  = "/tmp/osdk-benchmark-decode-gop.h264";
+
+/* FPV, main and payload camera decoding at once */
+const uint32_t MULTI_STREAMS = 3;
+const uint32_t MULTI_WIDTH[MULTI_STREAMS]  = { 640, 1280, 1280 };
+const uint32_t MULTI_HEIGHT[MULTI_STREAMS] = { 480, 720, 720 };
+const char*    MULTI_NAME[MULTI_STREAMS]   = { "fpv", "main", "payload" };
+const char*    MULTI_PATH[MULTI_STREAMS]   = {
+  "/tmp/osdk-benchmark-decode-fpv.h264", "/tmp/osdk-benchmark-decode-main.h264",
+  "/tmp/osdk-benchmark-decode-payload.h264"
+};
+
+uint64_t
+fnv1a(const uint8_t* data, size_t len)
+{
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < len; i++)
+  {
+    hash = (hash ^ data[i]) * 1099511628211ull;
+  }
+  return hash;
+}
+
+/*! A synthetic stream, as access units and as a file, and the checksum of
+ *  the RGB image every picture has to decode to */
+struct DecodeStream
+{
+  std::string                        path;
+  std::vector<std::vector<uint8_t> > accessUnits;
+  std::vector<uint64_t>              rgbChecksums;
+  bool                               written;
+
+  DecodeStream(uint32_t width, uint32_t height, const char* path,
+               uint32_t keyInterval = 1, uint32_t pictures = DECODE_PICTURES)
+    : path(path)
+    , written(false)
+  {
+    SimH264Stream        stream(width, height, keyInterval);
+    std::vector<uint8_t> yuv;
+    std::vector<uint8_t> rgb(width * height * 3);
+
+    /* The conversion DJICameraStreamDecoder does */
+    SwsContext* sws = sws_getContext(width, height, AV_PIX_FMT_YUV420P, width,
+                                     height, AV_PIX_FMT_RGB24, SWS_BICUBIC,
+                                     NULL, NULL, NULL);
+    AVFrame* frame = av_frame_alloc();
+    frame->format  = AV_PIX_FMT_YUV420P;
+    frame->width   = width;
+    frame->height  = height;
+    if (!sws || av_frame_get_buffer(frame, 32) < 0)
+    {
+      av_frame_free(&frame);
+      sws_freeContext(sws);
+      return;
+    }
+
+    accessUnits.resize(pictures);
+    for (uint32_t i = 0; i < pictures; i++)
+    {
+      stream.makePicture(i, yuv);
+      stream.encodePicture(i, yuv, accessUnits[i]);
+      if (stream.getKeyPicture(i) != i)
+      {
+        /* A P picture shows its IDR picture again */
+        rgbChecksums.push_back(rgbChecksums.back());
+        continue;
+      }
+
+      const uint8_t* plane = &yuv[0];
+      for (int p = 0; p < 3; p++)
+      {
+        uint32_t planeWidth  = p ? width / 2 : width;
+        uint32_t planeHeight = p ? height / 2 : height;
+        for (uint32_t row = 0; row < planeHeight; row++)
+        {
+          memcpy(frame->data[p] + row * frame->linesize[p],
+                 plane + row * planeWidth, planeWidth);
+        }
+        plane += planeWidth * planeHeight;
+      }
+      uint8_t* dst[4]       = { &rgb[0], NULL, NULL, NULL };
+      int      dstStride[4] = { (int)width * 3, 0, 0, 0 };
+      sws_scale(sws, frame->data, frame->linesize, 0, height, dst, dstStride);
+      rgbChecksums.push_back(fnv1a(&rgb[0], rgb.size()));
+    }
+    av_frame_free(&frame);
+    sws_freeContext(sws);
+
+    FILE* file = fopen(path, "wb");
+    if (!file)
+    {
+      return;
+    }
+    written = true;
+    for (uint32_t i = 0; i < pictures; i++)
+    {
+      written = written && fwrite(&accessUnits[i][0], 1, accessUnits[i].size(),
+                                  file) == accessUnits[i].size();
+    }
+    written = (fclose(file) == 0) && written;
+  }
+
+  ~DecodeStream()
+  {
+    remove(path.c_str());
+  }
+
+  bool ready() const
+  {
+    return written && rgbChecksums.size() == accessUnits.size();
+  }
+};
+
+/*! Checks decoded frames against the pictures, which repeat after
+ *  DECODE_PICTURES. Frames come in order, but where only the latest is kept
+ *  some can be skipped. */
+struct FrameCheck
+{
+  const std::vector<uint64_t>* expected;
+  uint64_t                     frames;
+  uint64_t                     skipped;
+  uint64_t                     mismatches;
+  /* Picture the next frame should be */
+  uint64_t                     next;
+  /* Of every frame, to compare runs of a stream not made here */
+  uint64_t                     checksum;
+
+  FrameCheck(const std::vector<uint64_t>* expected)
+    : expected(expected)
+    , frames(0)
+    , skipped(0)
+    , mismatches(0)
+    , next(0)
+    , checksum(0)
+  {
+  }
+
+  void check(const CameraRGBImage& image)
+  {
+    uint64_t hash = fnv1a(image.rawData.data(), image.rawData.size());
+    frames++;
+    checksum = checksum * 31 + hash;
+    if (!expected)
+    {
+      return;
+    }
+
+    for (uint64_t picture = next; picture < next + expected->size(); picture++)
+    {
+      if ((*expected)[picture % expected->size()] == hash)
+      {
+        skipped += picture - next;
+        next = picture + 1;
+        return;
+      }
+    }
+    mismatches++;
+    next++;
+  }
+};
+
+void
+checkDecodedFrame(const CameraRGBImage& image, void* userData)
+{
+  static_cast<FrameCheck*>(userData)->check(image);
+}
+
+/*! Every frame a decoder produces, seen on its conversion thread and read
+ *  after flush() */
+struct DecodeFixture
+{
+  DJICameraStreamDecoder decoder;
+  FrameCheck             check;
+  bool                   ready;
+  bool                   reported;
+
+  DecodeFixture(const std::vector<uint64_t>* expected,
+                DJICameraDecoderConfig       config = DJICameraDecoderConfig())
+    : decoder(keepEveryFrame(config))
+    , check(expected)
+    , reported(false)
+  {
+    decoder.registerFrameCallback(checkDecodedFrame, &check);
+    ready = decoder.init();
+  }
+
+  static DJICameraDecoderConfig keepEveryFrame(DJICameraDecoderConfig config)
+  {
+    config.maxPendingFrames = 0;
+    return config;
+  }
+
+  /*! Decodes the stream once, packets cut to chunk bytes if not 0 */
+  uint32_t decodeAll(const DecodeStream& stream, size_t chunk)
+  {
+    uint32_t bytes = 0;
+    for (size_t i = 0; i < stream.accessUnits.size(); i++)
+    {
+      const std::vector<uint8_t>& packet = stream.accessUnits[i];
+      size_t step = chunk ? chunk : packet.size();
+      for (size_t offset = 0; offset < packet.size(); offset += step)
+      {
+        decoder.decodeBuffer(const_cast<uint8_t*>(&packet[offset]),
+                             std::min(step, packet.size() - offset));
+      }
+      bytes += packet.size();
+    }
+    decoder.flush();
+    return bytes;
+  }
+
+  /*! Prints the first time frames are not as expected */
+  void report(const char* name, uint64_t pictures)
+  {
+    if (!reported &&
+        (check.mismatches || check.skipped || check.frames != pictures))
+    {
+      reported = true;
+      std::cout << name << ": " << check.frames << " of " << pictures
+                << " frames, " << check.mismatches
+                << " differ from their picture, " << check.skipped
+                << " pictures missing\n";
+    }
+  }
+};
+
+void
+decodePacket(void* param, uint8_t* buf, int len)
+{
+  static_cast<DJICameraStreamDecoder*>(param)->decodeBuffer(buf, len);
+}
+
+void
+checkCameraImage(CameraRGBImage image, void* userData)
+{
+  static_cast<FrameCheck*>(userData)->check(image);
+}
+
+void
+addSingleStream(BenchmarkRunner& runner, const std::string& name,
+                std::shared_ptr<DecodeStream> stream, size_t chunk,
+                DJICameraDecoderConfig config)
+{
+  std::shared_ptr<DecodeFixture> fixture(
+    new DecodeFixture(&stream->rgbChecksums, config));
+  std::shared_ptr<uint64_t> passes(new uint64_t(0));
+  runner.add(name, 10, [name, stream, chunk, fixture, passes]() -> uint32_t {
+    if (!fixture->ready)
+    {
+      std::cout << name << ": no decoder\n";
+      return 0;
+    }
+    uint32_t bytes = fixture->decodeAll(*stream, chunk);
+    fixture->report(name.c_str(), ++*passes * DECODE_PICTURES);
+    return bytes;
+  });
+}
+
+/*! One replay of the three files, each into its own decoder, until every
+ *  frame is delivered */
+uint32_t
+decodeStreams(const std::string& name,
+              const std::vector<std::shared_ptr<DecodeStream> >& streams,
+              DJICameraStreamFileSource::ReplayMode mode,
+              const DJICameraDecoderConfig&          config)
+{
+  std::vector<std::shared_ptr<DJICameraStreamFileSource> > sources;
+  std::vector<std::shared_ptr<DecodeFixture> >             fixtures;
+  for (size_t i = 0; i < streams.size(); i++)
+  {
+    sources.push_back(std::shared_ptr<DJICameraStreamFileSource>(
+      new DJICameraStreamFileSource(streams[i]->path, mode)));
+    fixtures.push_back(std::shared_ptr<DecodeFixture>(
+      new DecodeFixture(&streams[i]->rgbChecksums, config)));
+    if (!fixtures[i]->ready || !sources[i]->init())
+    {
+      std::cout << name << ": cannot replay " << streams[i]->path << "\n";
+      return 0;
+    }
+    sources[i]->registerCallback(decodePacket, &fixtures[i]->decoder);
+  }
+
+  std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < sources.size(); i++)
+  {
+    sources[i]->start();
+  }
+  uint32_t bytes  = 0;
+  uint64_t frames = 0;
+  for (size_t i = 0; i < sources.size(); i++)
+  {
+    while (sources[i]->isThreadRunning())
+    {
+      usleep(1000);
+    }
+    fixtures[i]->decoder.flush();
+    sources[i]->stop();
+
+    DJICameraStreamFileSource::ReplayStats stats;
+    sources[i]->getStats(stats);
+    bytes  += (uint32_t)stats.bytes;
+    frames += fixtures[i]->check.frames;
+  }
+  double elapsedMs = std::chrono::duration<double, std::milli>(
+                       std::chrono::steady_clock::now() - begin).count();
+
+  printf("%s: %.1f fps aggregate;", name.c_str(), frames * 1000.0 / elapsedMs);
+  for (size_t i = 0; i < fixtures.size(); i++)
+  {
+    DJICameraDecoderStats stats;
+    fixtures[i]->decoder.getStats(stats);
+    printf(" %s %.1f/%.1f ms", MULTI_NAME[i], stats.meanLatencyMs,
+           stats.maxLatencyMs);
+    fixtures[i]->report(name.c_str(), DECODE_PICTURES);
+  }
+  printf(" latency mean/max\n");
+  return bytes;
+}
+
+void
+addMultiStream(BenchmarkRunner& runner, const std::string& name,
+               std::shared_ptr<std::vector<std::shared_ptr<DecodeStream> > > streams,
+               DJICameraStreamFileSource::ReplayMode mode, bool shared)
+{
+  std::shared_ptr<DJICameraDecodePool> pool;
+  DJICameraDecoderConfig               config;
+  if (shared)
+  {
+    /* As AdvancedSensing::setSharedCameraDecoding() sets it up */
+    pool.reset(new DJICameraDecodePool(0));
+    config.pool = pool.get();
+  }
+  uint64_t iterations =
+    (mode == DJICameraStreamFileSource::REPLAY_RECORDED_TIMING) ? 1 : 5;
+  runner.add(name, iterations, [name, streams, mode, pool, config]() -> uint32_t {
+    return decodeStreams(name, *streams, mode, config);
+  });
+}
+
+void
+slowConsumer(const CameraRGBImage& image, void* userData)
+{
+  (void)image;
+  (void)userData;
+  usleep(SLOW_CONSUMER_MS * 1000);
+}
+
+/*! The stream replayed at 30 fps into a decoder whose every frame takes the
+ *  consumer SLOW_CONSUMER_MS: nothing is dropped before conversion, so only
+ *  the decode policy keeps the latency bounded */
+void
+addSlowConsumer(BenchmarkRunner& runner, const std::string& name,
+                std::shared_ptr<DecodeStream> stream, int maxLatencyMs)
+{
+  runner.add(name, 1, [name, stream, maxLatencyMs]() -> uint32_t {
+    DJICameraDecoderConfig config;
+    config.maxPendingFrames = 0;
+    config.maxLatencyMs     = maxLatencyMs;
+    DJICameraStreamDecoder    decoder(config);
+    DJICameraStreamFileSource source(stream->path);
+    decoder.registerFrameCallback(slowConsumer, NULL);
+    source.registerCallback(decodePacket, &decoder);
+    if (!decoder.init() || !source.init() || !source.start())
+    {
+      std::cout << name << ": cannot replay " << stream->path << "\n";
+      return 0;
+    }
+    while (source.isThreadRunning())
+    {
+      usleep(1000);
+    }
+    decoder.flush();
+    source.stop();
+
+    DJICameraDecoderStats stats;
+    decoder.getStats(stats);
+    printf("%s: %llu packets, %llu decoded, %llu skipped, %llu dropped, "
+           "latency %.1f/%.1f ms mean/max, level %d after %llu changes\n",
+           name.c_str(), (unsigned long long)stats.packets,
+           (unsigned long long)stats.decodedFrames,
+           (unsigned long long)stats.skippedFrames,
+           (unsigned long long)stats.droppedFrames, stats.meanLatencyMs,
+           stats.maxLatencyMs, stats.policyLevel,
+           (unsigned long long)stats.policyChanges);
+    if (maxLatencyMs && stats.maxLatencyMs > 2 * maxLatencyMs)
+    {
+      std::cout << name << ": latency not bounded\n";
+    }
+
+    DJICameraStreamFileSource::ReplayStats replay;
+    source.getStats(replay);
+    return (uint32_t)replay.bytes;
+  });
+}
+
+} // namespace
+
+void
+registerDecodeBenchmarks(BenchmarkRunner& runner, const std::string& h264Path)
+{
+  std::shared_ptr<DecodeStream> stream(
+    new DecodeStream(DECODE_WIDTH, DECODE_HEIGHT, DECODE_STREAM_PATH));
+  if (!stream->ready())
+  {
+    std::cout << "decode: cannot prepare the synthetic stream\n";
+    return;
+  }
+
+  /* A packet per call, as LiveView delivers, and the pictures the codec
+   * holds back flushed: the time of 30 pictures from packet to RGB */
+  DJICameraDecoderConfig frameThreads;
+  frameThreads.threadCount = 4;
+  frameThreads.threadType  = DJICameraDecoderConfig::THREAD_FRAME |
+                            DJICameraDecoderConfig::THREAD_SLICE;
+  addSingleStream(runner, "decode/h264_720p_access_units", stream, 0,
+                  frameThreads);
+
+  /* One codec thread, the default: what frame threading gains above */
+  DJICameraDecoderConfig oneThread;
+  addSingleStream(runner, "decode/h264_720p_one_thread", stream, 0, oneThread);
+
+  /* Access units cut as the camera link reads them, which the parser has
+   * to put together again */
+  addSingleStream(runner, "decode/h264_720p_16KB_chunks", stream, DECODE_CHUNK,
+                  frameThreads);
+
+  /* DJICameraStream as an application uses it, the file in place of the
+   * camera at 30 fps: the callback has to see every picture in order */
+  runner.add("decode/camera_stream_replay_30fps", 1, [stream]() -> uint32_t {
+    DJICameraStreamFileSource source(DECODE_STREAM_PATH);
+    DJICameraStream           cameraStream(&source, MAIN_CAMERA);
+    FrameCheck                check(&stream->rgbChecksums);
+    if (!cameraStream.startCameraStream(checkCameraImage, &check))
+    {
+      std::cout << "decode/camera_stream_replay_30fps: no stream\n";
+      return 0;
+    }
+    while (source.isThreadRunning())
+    {
+      usleep(1000);
+    }
+    /* The callback thread takes the last frames after the replay */
+    usleep(200000);
+    cameraStream.stopCameraStream();
+
+    DJICameraStreamFileSource::ReplayStats stats;
+    source.getStats(stats);
+    printf("decode/camera_stream_replay_30fps: %u of %u pictures delivered, "
+           "%u skipped, %u wrong\n",
+           (unsigned)check.frames, DECODE_PICTURES, (unsigned)check.skipped,
+           (unsigned)check.mismatches);
+    if (check.mismatches || check.skipped ||
+        check.frames + DECODE_HELD_BACK < DECODE_PICTURES)
+    {
+      std::cout << "decode/camera_stream_replay_30fps: frames lost or wrong\n";
+    }
+    return (uint32_t)stats.bytes;
+  });
+
+  /* Three cameras at once, each decoder with its own threads or all on
+   * one shared pool: as fast as they go for the aggregate frame rate, at
+   * 30 fps for the latency from packet to RGB of each */
+  std::shared_ptr<std::vector<std::shared_ptr<DecodeStream> > > streams(
+    new std::vector<std::shared_ptr<DecodeStream> >);
+  for (uint32_t i = 0; i < MULTI_STREAMS; i++)
+  {
+    streams->push_back(std::shared_ptr<DecodeStream>(
+      new DecodeStream(MULTI_WIDTH[i], MULTI_HEIGHT[i], MULTI_PATH[i])));
+    if (!streams->back()->ready())
+    {
+      std::cout << "decode: cannot prepare " << MULTI_PATH[i] << "\n";
+      return;
+    }
+  }
+  addMultiStream(runner, "decode/3_streams_own_threads", streams,
+                 DJICameraStreamFileSource::REPLAY_AS_FAST_AS_POSSIBLE, false);
+  addMultiStream(runner, "decode/3_streams_shared_pool", streams,
+                 DJICameraStreamFileSource::REPLAY_AS_FAST_AS_POSSIBLE, true);
+  addMultiStream(runner, "decode/3_streams_own_threads_30fps", streams,
+                 DJICameraStreamFileSource::REPLAY_RECORDED_TIMING, false);
+  addMultiStream(runner, "decode/3_streams_shared_pool_30fps", streams,
+                 DJICameraStreamFileSource::REPLAY_RECORDED_TIMING, true);
+
+  /* A consumer slower than the camera: with the policy off every frame
+   * waits for it and the latency grows for as long as the stream lasts */
+  std::shared_ptr<DecodeStream> gopStream(
+    new DecodeStream(DECODE_WIDTH, DECODE_HEIGHT, SLOW_STREAM_PATH,
+                     SLOW_KEY_INTERVAL, SLOW_PICTURES));
+  if (!gopStream->ready())
+  {
+    std::cout << "decode: cannot prepare " << SLOW_STREAM_PATH << "\n";
+    return;
+  }
+  addSlowConsumer(runner, "decode/slow_consumer_policy_off", gopStream, 0);
+  addSlowConsumer(runner, "decode/slow_consumer_policy_on", gopStream,
+                  SLOW_MAX_LATENCY_MS);
+
+  if (h264Path.empty())
+  {
+    return;
+  }
+
+  /* A real recording: only the throughput, and a checksum to tell whether
+   * another build decodes it the same */
+  std::shared_ptr<DJICameraStreamFileSource> fileSource(
+    new DJICameraStreamFileSource(
+      h264Path, DJICameraStreamFileSource::REPLAY_AS_FAST_AS_POSSIBLE));
+  std::shared_ptr<bool> printed(new bool(false));
+  runner.add("decode/h264_file", 3, [fileSource, printed, h264Path]() -> uint32_t {
+    DecodeFixture fixture(NULL);
+    fileSource->registerCallback(decodePacket, &fixture.decoder);
+    if (!fixture.ready || !fileSource->init() || !fileSource->start())
+    {
+      std::cout << "decode/h264_file: cannot replay " << h264Path << "\n";
+      return 0;
+    }
+    while (fileSource->isThreadRunning())
+    {
+      usleep(1000);
+    }
+    fixture.decoder.flush();
+    fileSource->stop();
+    fileSource->registerCallback(NULL, NULL);
+
+    DJICameraStreamFileSource::ReplayStats stats;
+    fileSource->getStats(stats);
+    if (!*printed)
+    {
+      *printed = true;
+      printf("decode/h264_file: %u packets, %u frames, checksum %016llx\n",
+             (unsigned)stats.packets, (unsigned)fixture.check.frames,
+             (unsigned long long)fixture.check.checksum);
+    }
+    return (uint32_t)stats.bytes;
+  });
+}
+#else
+void
+registerDecodeBenchmarks(BenchmarkRunner& runner, const std::string& h264Path)
+{
+  (void)runner;
+  (void)h264Path;
+}
+#endif
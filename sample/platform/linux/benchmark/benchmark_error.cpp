@@ -0,0 +1,64 @@
+/*! @file benchmark_error.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief
+ *  Error code to message translation, as done when logging failed commands.
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "dji_error.hpp"
+#include "osdk_benchmark.hpp"
+
+using namespace DJI::OSDK;
+
+void
+registerErrorBenchmarks(BenchmarkRunner& runner)
+{
+  runner.add("error/get_msg_camera", 1000000, []() -> uint32_t {
+    volatile const char* msg =
+      ErrorCode::getErrorCodeMsg(ErrorCode::CameraCommonErr::SDCardFull)
+        .errorMsg;
+    (void)msg;
+    return 0;
+  });
+
+  /* Largest table, and a code near its end */
+  runner.add("error/get_msg_waypoint_v2", 1000000, []() -> uint32_t {
+    volatile const char* msg =
+      ErrorCode::getErrorCodeMsg(
+        ErrorCode::WaypointV2MissionErr::ACTUATOR_FLIGHT_YAW_INVALID_YAW_ANGLE)
+        .errorMsg;
+    (void)msg;
+    return 0;
+  });
+
+  runner.add("error/get_msg_unknown", 1000000, []() -> uint32_t {
+    volatile const char* msg =
+      ErrorCode::getErrorCodeMsg(ErrorCode::getErrorCode(
+                                   ErrorCode::FCModule, 0, 0x1234))
+        .solutionMsg;
+    (void)msg;
+    return 0;
+  });
+}
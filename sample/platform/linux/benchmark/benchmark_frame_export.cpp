@@ -0,0 +1,372 @@
+/*! @file benchmark_frame_export.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief
+ *  Camera and stereo images exported through a shared memory ring to reader
+ *  processes: what publishing costs the exporter, and per frame latency and
+ *  CPU in readers keeping up and in one far behind.
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "osdk_benchmark.hpp"
+
+#ifdef ADVANCED_SENSING
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "dji_frame_export.hpp"
+
+using namespace DJI::OSDK;
+
+namespace
+{
+
+const char*    EXPORT_RING         = "/osdk-benchmark-frames";
+const uint32_t EXPORT_SLOTS        = 8;
+const int      CAMERA_WIDTH        = 1280;
+const int      CAMERA_HEIGHT       = 720;
+const uint32_t CAMERA_LEN          = CAMERA_WIDTH * CAMERA_HEIGHT * 3;
+const uint32_t STEREO_WIDTH        = 640;
+const uint32_t STEREO_HEIGHT       = 480;
+const uint32_t STEREO_LEN          = STEREO_WIDTH * STEREO_HEIGHT;
+/* Three seconds in ticks of 1/60 s: the camera at 30 fps, every second
+ * tick, and the front stereo pair at 20 Hz, every third */
+const uint32_t EXPORT_TICKS        = 180;
+const uint32_t EXPORT_TICK_US      = 1000000 / 60;
+/* A reader taking this long over each frame, far behind the stream */
+const int      SLOW_READER_MS      = 100;
+
+uint64_t
+monotonicUs()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+uint64_t
+cpuUs(int who)
+{
+  struct rusage usage;
+  getrusage(who, &usage);
+  return (uint64_t)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000 +
+         usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+/*! What a reader process sends back when the ring closes */
+typedef struct ReaderResult
+{
+  uint64_t frames;
+  uint64_t lost;
+  /* Overwritten while the reader was at it */
+  uint64_t overwritten;
+  /* Not the frame its info says, though still valid after reading */
+  uint64_t wrong;
+  double   meanUs;
+  double   p99Us;
+  double   maxUs;
+  double   cpuUs;
+  /* Of the bytes read, so the reading is not optimised away */
+  uint64_t sum;
+} ReaderResult;
+
+/*! Every frame starts with the index of its source image */
+struct ExportSource
+{
+  CameraRGBImage       camera;
+  std::vector<uint8_t> stereo[2];
+
+  ExportSource()
+  {
+    camera.width  = CAMERA_WIDTH;
+    camera.height = CAMERA_HEIGHT;
+    camera.rawData.resize(CAMERA_LEN);
+    for (size_t i = 0; i < camera.rawData.size(); i++)
+    {
+      camera.rawData[i] = (uint8_t)(i * 7);
+    }
+    for (int side = 0; side < 2; side++)
+    {
+      stereo[side].resize(STEREO_LEN);
+      for (size_t i = 0; i < stereo[side].size(); i++)
+      {
+        stereo[side][i] = (uint8_t)(i / STEREO_WIDTH + side * 50);
+      }
+    }
+  }
+};
+
+/*! The reader process: takes frames until the exporter closes the ring,
+ *  reading each one in place as a detector would look at every cache line
+ *  of it */
+void
+readFrames(bool slow, int readyFd, int resultFd)
+{
+  ReaderResult result;
+  memset(&result, 0, sizeof(result));
+
+  FrameExportReader reader;
+  bool              opened = reader.open(EXPORT_RING);
+  char              ready  = opened ? 1 : 0;
+  if (write(readyFd, &ready, 1) != 1 || !opened)
+  {
+    _exit(1);
+  }
+
+  std::vector<uint64_t> latencies;
+  latencies.reserve(4 * EXPORT_TICKS);
+  uint64_t                    number = 0;
+  uint64_t                    sum    = 0;
+  FrameExportReader::FrameType frame;
+  while (reader.waitForFrame(number, frame, 2000, slow))
+  {
+    latencies.push_back(monotonicUs() - frame.info.timeUs);
+
+    uint32_t stamp;
+    memcpy(&stamp, frame.data, sizeof(stamp));
+    for (uint32_t i = 0; i < frame.info.length; i += 64)
+    {
+      sum += frame.data[i];
+    }
+    if (!reader.isValid(frame))
+    {
+      result.overwritten++;
+    }
+    else if (stamp != frame.info.sourceIndex)
+    {
+      result.wrong++;
+    }
+
+    if (slow)
+    {
+      usleep(SLOW_READER_MS * 1000);
+    }
+  }
+
+  result.frames = latencies.size();
+  result.lost   = reader.getLostFrames();
+  result.cpuUs  = (double)cpuUs(RUSAGE_SELF);
+  result.sum    = sum;
+  if (!latencies.empty())
+  {
+    std::sort(latencies.begin(), latencies.end());
+    uint64_t total = 0;
+    for (size_t i = 0; i < latencies.size(); i++)
+    {
+      total += latencies[i];
+    }
+    result.meanUs = (double)total / latencies.size();
+    result.p99Us  = (double)latencies[latencies.size() * 99 / 100];
+    result.maxUs  = (double)latencies.back();
+  }
+  bool sent = write(resultFd, &result, sizeof(result)) == sizeof(result);
+  _exit(sent ? 0 : 1);
+}
+
+/*! Three seconds of camera and stereo images published at their rates into
+ *  a ring read by fastReaders processes keeping up and slowReaders ones
+ *  that always take the latest frame */
+uint32_t
+exportAcrossProcesses(const std::string& name, const ExportSource& source,
+                      int fastReaders, int slowReaders)
+{
+  FrameExporter exporter;
+  if (!exporter.create(EXPORT_RING, EXPORT_SLOTS, CAMERA_LEN))
+  {
+    std::cout << name << ": cannot create " << EXPORT_RING << "\n";
+    return 0;
+  }
+
+  int readyPipe[2], resultPipe[2];
+  if (pipe(readyPipe) != 0 || pipe(resultPipe) != 0)
+  {
+    return 0;
+  }
+  std::vector<pid_t> readers;
+  for (int i = 0; i < fastReaders + slowReaders; i++)
+  {
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+      readFrames(i >= fastReaders, readyPipe[1], resultPipe[1]);
+    }
+    if (pid > 0)
+    {
+      readers.push_back(pid);
+    }
+  }
+  int ready = 0;
+  for (size_t i = 0; i < readers.size(); i++)
+  {
+    char opened = 0;
+    if (read(readyPipe[0], &opened, 1) == 1 && opened)
+    {
+      ready++;
+    }
+  }
+
+  CameraRGBImage            camera = source.camera;
+  std::vector<uint8_t>      stereo[2] = { source.stereo[0], source.stereo[1] };
+  Perception::ImageInfoType info;
+  memset(&info, 0, sizeof(info));
+  info.rawInfo.direction = Perception::RECTIFY_FRONT;
+  info.rawInfo.bpp       = 1;
+  info.rawInfo.width     = STEREO_WIDTH;
+  info.rawInfo.height    = STEREO_HEIGHT;
+
+  uint64_t bytes = 0, frames = 0, publishUs = 0, maxPublishUs = 0;
+  uint64_t cpuStart = cpuUs(RUSAGE_THREAD);
+  uint64_t start    = monotonicUs();
+  for (uint32_t tick = 0; tick < EXPORT_TICKS; tick++)
+  {
+    uint64_t due = start + (uint64_t)tick * EXPORT_TICK_US;
+    uint64_t now = monotonicUs();
+    if (due > now)
+    {
+      usleep((useconds_t)(due - now));
+    }
+
+    uint64_t begin = monotonicUs();
+    if (tick % 2 == 0)
+    {
+      uint32_t index = tick / 2;
+      memcpy(camera.rawData.data(), &index, sizeof(index));
+      exporter.publishCameraImage(camera, MAIN_CAMERA);
+      bytes += CAMERA_LEN;
+      frames++;
+    }
+    if (tick % 3 == 0)
+    {
+      info.rawInfo.index = tick / 3;
+      info.timeStamp     = 50ull * info.rawInfo.index;
+      for (int side = 0; side < 2; side++)
+      {
+        memcpy(stereo[side].data(), &info.rawInfo.index,
+               sizeof(info.rawInfo.index));
+        info.dataType = side ? Perception::RECTIFY_FRONT_RIGHT
+                             : Perception::RECTIFY_FRONT_LEFT;
+        exporter.publishImage(info, stereo[side].data(), STEREO_LEN);
+      }
+      bytes += 2 * STEREO_LEN;
+      frames += 2;
+    }
+    uint64_t took = monotonicUs() - begin;
+    publishUs += took;
+    maxPublishUs = std::max(maxPublishUs, took);
+  }
+  uint64_t cpu = cpuUs(RUSAGE_THREAD) - cpuStart;
+
+  FrameExporter::StatsType stats;
+  exporter.getStats(stats);
+  exporter.close();
+
+  printf("%s: published %llu frames, %.1f us mean and %llu us max per tick, "
+         "%.1f us CPU per frame, %llu wakeups\n",
+         name.c_str(), (unsigned long long)stats.frames,
+         (double)publishUs / EXPORT_TICKS, (unsigned long long)maxPublishUs,
+         frames ? (double)cpu / frames : 0.0,
+         (unsigned long long)stats.wakeups);
+  for (size_t i = 0; i < readers.size(); i++)
+  {
+    ReaderResult result;
+    int          status = 0;
+    bool got = (int)i < ready &&
+               read(resultPipe[0], &result, sizeof(result)) == sizeof(result);
+    waitpid(readers[i], &status, 0);
+    if (!got)
+    {
+      std::cout << name << ": reader " << i << " sent no result\n";
+      continue;
+    }
+    /* Results come in the order readers finish, the slow ones last */
+    printf("%s: reader took %llu frames, lost %llu, %llu overwritten while "
+           "read, latency %.1f/%.1f/%.1f us mean/p99/max, %.1f us CPU per "
+           "frame\n",
+           name.c_str(), (unsigned long long)result.frames,
+           (unsigned long long)result.lost,
+           (unsigned long long)result.overwritten, result.meanUs, result.p99Us,
+           result.maxUs, result.frames ? result.cpuUs / result.frames : 0.0);
+    if (result.wrong)
+    {
+      std::cout << name << ": " << result.wrong
+                << " frames not the ones published\n";
+    }
+  }
+  close(readyPipe[0]);
+  close(readyPipe[1]);
+  close(resultPipe[0]);
+  close(resultPipe[1]);
+  return (uint32_t)bytes;
+}
+
+} // namespace
+
+void
+registerFrameExportBenchmarks(BenchmarkRunner& runner)
+{
+  std::shared_ptr<ExportSource> source(new ExportSource());
+
+  /* What the camera callback pays per 720p image with nobody waiting */
+  std::shared_ptr<FrameExporter> exporter(new FrameExporter());
+  runner.add("export/publish_720p_rgb", 500, [source, exporter]() -> uint32_t {
+    if (!exporter->isOpen() &&
+        !exporter->create(EXPORT_RING, EXPORT_SLOTS, CAMERA_LEN))
+    {
+      std::cout << "export/publish_720p_rgb: cannot create " << EXPORT_RING
+                << "\n";
+      return 0;
+    }
+    exporter->publishCameraImage(source->camera, MAIN_CAMERA);
+    return CAMERA_LEN;
+  });
+
+  runner.add("export/cross_process_2_readers", 1,
+             [source, exporter]() -> uint32_t {
+               exporter->close();
+               return exportAcrossProcesses("export/cross_process_2_readers",
+                                            *source, 2, 0);
+             });
+
+  /* A reader a hundred times slower than the stream: it loses frames, the
+   * exporter and the other readers do not notice */
+  runner.add("export/cross_process_2_readers_1_slow", 1,
+             [source]() -> uint32_t {
+               return exportAcrossProcesses(
+                 "export/cross_process_2_readers_1_slow", *source, 2, 1);
+             });
+}
+#else
+void
+registerFrameExportBenchmarks(BenchmarkRunner& runner)
+{
+  (void)runner;
+}
+#endif
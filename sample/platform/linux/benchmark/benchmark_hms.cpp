@@ -0,0 +1,163 @@
+/*! @file benchmark_hms.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief
+ *  HMS error code lookup and push handling, the latter replayed through the
+ *  simulated flight controller.
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "dji_hms.hpp"
+#include "dji_hms_internal.hpp"
+#include "dji_internal_command.hpp"
+#include "dji_sim_flight_controller.hpp"
+#include "dji_vehicle.hpp"
+#include "osdk_benchmark.hpp"
+#include "osdk_device_id.h"
+
+using namespace DJI::OSDK;
+
+namespace
+{
+
+/* Alarms of one push: %alarmid only, %index, %component_index, unknown */
+const uint32_t pushAlarmIds[] = { 0x1a010040, 0x110b0001, 0x11000020,
+                                  0x12345678 };
+const size_t   pushAlarmCount = sizeof(pushAlarmIds) / sizeof(pushAlarmIds[0]);
+
+/* HMS push payload: msgVersion, globalIndex, msgEnd/msgIndex, error list */
+std::vector<uint8_t>
+hmsPushFrame(uint8_t globalIndex, size_t alarmCount)
+{
+  std::vector<uint8_t> frame(hmsPushHeaderLen + alarmCount * sizeof(ErrList));
+  frame[0] = 0;
+  frame[1] = globalIndex;
+  frame[2] = 0x01;
+  for (size_t i = 0; i < alarmCount; i++)
+  {
+    ErrList err;
+    err.alarmID     = pushAlarmIds[i % pushAlarmCount];
+    err.sensorIndex = (uint8_t)(i + 1);
+    err.reportLevel = 2;
+    memcpy(&frame[hmsPushHeaderLen + i * sizeof(ErrList)], &err,
+           sizeof(ErrList));
+  }
+  return frame;
+}
+
+bool
+pushHMS(SimFlightController* sim, const std::vector<uint8_t>& frame)
+{
+  return sim->push(PROTOCOL_V1, V1ProtocolCMD::HMS::hmsPushData[0],
+                   V1ProtocolCMD::HMS::hmsPushData[1], &frame[0],
+                   (uint32_t)frame.size(), OSDK_COMMAND_HMSSERVICE_ID);
+}
+
+} // namespace
+
+void
+registerHMSBenchmarks(BenchmarkRunner& runner)
+{
+  runner.add("hms/find_err_code", 1000000, []() -> uint32_t {
+    volatile const HMSErrCodeInfo* info = findHMSErrCodeInfo(0x1f0b001b);
+    (void)info;
+    return 0;
+  });
+
+  runner.add("hms/format_alarm_info", 1000000, []() -> uint32_t {
+    const HMSErrCodeInfo* info = findHMSErrCodeInfo(0x11000020);
+    std::string text = formatHMSAlarmInfo(info->groundAlarmInfo,
+                                          info->alarmId, 1, 2);
+    return (uint32_t)text.size();
+  });
+
+  Vehicle*             v   = getSimulatedVehicle();
+  SimFlightController* sim = getSimulatedAcmChannel();
+  if (!v || !sim)
+  {
+    std::cout << "skipping hms: simulated vehicle unavailable\n";
+    return;
+  }
+
+  /* The simulator is not an M300, so Vehicle has no DJIHMS of its own */
+  std::shared_ptr<DJIHMS> hms(new DJIHMS(v));
+  if (!hms->subscribeHMSInf(true))
+  {
+    std::cout << "skipping hms: subscription failed\n";
+    return;
+  }
+  /* Every matched alarm is logged, keep the report readable */
+  DJI::OSDK::Log::instance().disableStatusLogging();
+
+  /* One push from the simulator until getHMSPushPacket() shows it. A handler
+   * blocking the receive thread holds up every following push. Like all
+   * pushes below, the list length is globalIndex % 8. */
+  std::shared_ptr<uint8_t> globalIndex(new uint8_t(pushAlarmCount));
+  runner.add("hms/push_to_packet", 500, [sim, hms, globalIndex]() -> uint32_t {
+    uint8_t              index = (*globalIndex += 8);
+    std::vector<uint8_t> frame = hmsPushFrame(index, pushAlarmCount);
+    pushHMS(sim, frame);
+
+    std::chrono::steady_clock::time_point deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (hms->getHMSPushPacket().hmsPushData.globalIndex != index &&
+           std::chrono::steady_clock::now() < deadline)
+    {
+      std::this_thread::yield();
+    }
+    return (uint32_t)frame.size();
+  });
+
+  /* Queries while pushes of varying length stream in; a torn packet shows up
+   * as a list length not matching its globalIndex. */
+  std::shared_ptr<std::atomic<uint64_t> > torn(new std::atomic<uint64_t>(0));
+  runner.add("hms/get_packet_while_receiving", 100000,
+             [hms, torn]() -> uint32_t {
+               HMSPushPacket packet = hms->getHMSPushPacket();
+               if (packet.hmsPushData.errList.size() !=
+                   packet.hmsPushData.globalIndex % 8)
+               {
+                 (*torn)++;
+               }
+               return (uint32_t)(packet.hmsPushData.errList.size() *
+                                 sizeof(ErrList));
+             },
+             [sim, torn](const std::atomic<bool>& running) {
+               for (uint8_t n = 0; running; n++)
+               {
+                 pushHMS(sim, hmsPushFrame(n, n % 8));
+                 std::this_thread::sleep_for(std::chrono::microseconds(200));
+               }
+               if (*torn)
+               {
+                 std::cout << "hms: " << *torn << " torn packets\n";
+               }
+             });
+}
@@ -0,0 +1,83 @@
+/*! @file benchmark_linker.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief
+ *  Cost of the link statistics: command round trips against the simulated
+ *  flight controller with the instrumentation on and off.
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <iostream>
+#include "dji_legacy_linker.hpp"
+#include "dji_linker_statistics.hpp"
+#include "dji_vehicle.hpp"
+#include "osdk_benchmark.hpp"
+
+using namespace DJI::OSDK;
+
+namespace
+{
+
+uint32_t
+getVersionRoundTrip(Vehicle* v, bool statistics)
+{
+  uint8_t data    = 0;
+  bool    enabled = LinkerStatistics::instance().isEnabled();
+  LinkerStatistics::instance().setEnabled(statistics);
+  v->legacyLinker->sendSync(OpenProtocolCMD::CMDSet::Activation::getVersion,
+                            &data, sizeof(data), 1000, 1);
+  LinkerStatistics::instance().setEnabled(enabled);
+  return sizeof(data);
+}
+
+} // namespace
+
+void
+registerLinkerBenchmarks(BenchmarkRunner& runner)
+{
+  /* Recording only happens while enabled, which the statistics are not by
+   * default */
+  runner.add("stats/record_ack_latency", 1000000, []() -> uint32_t {
+    LinkerStatistics& stats   = LinkerStatistics::instance();
+    bool              enabled = stats.isEnabled();
+    stats.setEnabled(true);
+    stats.onAckDelivered(0xEE, 0xEE, LinkerStatistics::nowUs());
+    stats.setEnabled(enabled);
+    return 0;
+  });
+
+  Vehicle* v = getSimulatedVehicle();
+  if (!v)
+  {
+    std::cout << "skipping linker: simulated vehicle unavailable\n";
+    return;
+  }
+
+  /* Same loopback round trip twice; the difference is the whole cost of the
+   * HAL tap plus the LegacyLinker hooks. */
+  runner.add("linker/get_version_stats_off", 5000,
+             [v]() -> uint32_t { return getVersionRoundTrip(v, false); });
+  runner.add("linker/get_version_stats_on", 5000,
+             [v]() -> uint32_t { return getVersionRoundTrip(v, true); });
+}
@@ -0,0 +1,1307 @@
+/*! @file benchmark_media.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief
+ *  File download reassembly, media listing against a simulated camera and
+ *  H264 liveview dispatch benchmarks.
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "commondatarangehandler.h"
+#include "dji_file_mgr_impl.hpp"
+#include "dji_internal_command.hpp"
+#include "dji_sim_flight_controller.hpp"
+#include "dji_vehicle.hpp"
+#include "downloadbufferqueue.h"
+#include "osdk_benchmark.hpp"
+#include "pwrite_file_buffer.hpp"
+#ifdef ADVANCED_SENSING
+#include "dji_liveview_impl.hpp"
+#endif
+
+using namespace DJI::OSDK;
+
+#ifdef ADVANCED_SENSING
+namespace DJI
+{
+namespace OSDK
+{
+/*! The H264 dispatch LiveViewImpl registers with the linker, called as the
+ *  linker would */
+struct LiveViewBenchmarkHook
+{
+  static E_OsdkStat dispatch(const T_CmdInfo* cmdInfo, const uint8_t* cmdData,
+                             void* handlers)
+  {
+    return LiveViewImpl::RecordStreamHandler(NULL, cmdInfo, cmdData, handlers);
+  }
+};
+} // OSDK
+} // DJI
+#endif
+
+/* Matches what the camera sends per file data pack */
+#define BENCH_BLOCK_LEN     1000
+#define BENCH_WINDOW_BLOCKS 64
+#define BENCH_FILE_BLOCKS   4096
+#define BENCH_H264_FRAME    (32 * 1024)
+#define BENCH_RANGE_PACKS   (1000 * 1000)
+/* Missing ranges the transfer monitor asks for at a time */
+#define BENCH_RANGE_REQUEST 16
+/* A well used SD card, listed in packs of up to BENCH_LIST_PACK_LEN */
+#define BENCH_LIST_FILES    20000
+#define BENCH_LIST_PACK_LEN 1000
+/* The card a simulated camera lists, and what is shot between two listings */
+#define BENCH_CARD_FILES    10000
+#define BENCH_CARD_NEW      10
+/* A 1 MB photo, sent a pack every 100 us over a link 20 ms long each way */
+#define BENCH_FETCH_BLOCKS    1000
+#define BENCH_FETCH_PACK_US   100
+#define BENCH_FETCH_LATENCY   20
+/* A 64 MB video from a server as fast as it gets */
+#define BENCH_VIDEO_BLOCKS    (64 * 1024)
+/* Where the link to it drops when the download is to be resumed */
+#define BENCH_VIDEO_CUT       (36 * 1000 * 1000)
+
+namespace
+{
+
+/* One download session: blocks arrive a window at a time, slightly out of
+ * order, and are drained to the file the way FileMgrImpl does it. */
+typedef struct DownloadFixture
+{
+  DownloadBufferQueue      queue;
+  CommonDataRangeHandler   ranges;
+  PwriteFileBuffer         file;
+  std::string              path;
+  std::vector<uint8_t>     block;
+  std::vector<int>         order;
+  std::vector<DataPointer> views;
+  int                      nextIndex;
+
+  DownloadFixture()
+    : block(BENCH_BLOCK_LEN)
+    , order(BENCH_WINDOW_BLOCKS)
+    , views(BENCH_WINDOW_BLOCKS)
+    , nextIndex(0)
+  {
+    char name[] = "/tmp/osdk-benchmark-XXXXXX";
+    int  fd     = mkstemp(name);
+    if (fd >= 0)
+    {
+      close(fd);
+      path = name;
+    }
+
+    for (size_t i = 0; i < block.size(); i++)
+    {
+      block[i] = (uint8_t)i;
+    }
+
+    /* neighbouring packs swapped, as seen on a lossy link */
+    for (int i = 0; i < BENCH_WINDOW_BLOCKS; i++)
+    {
+      order[i] = i;
+    }
+    std::mt19937 rng(1);
+    for (int i = 0; i + 1 < BENCH_WINDOW_BLOCKS; i += 2)
+    {
+      if (rng() & 1)
+      {
+        std::swap(order[i], order[i + 1]);
+      }
+    }
+  }
+
+  ~DownloadFixture()
+  {
+    queue.Dealloc();
+    file.close(false);
+    if (!path.empty())
+    {
+      unlink(path.c_str());
+    }
+  }
+} DownloadFixture;
+
+/* Arrival orders of a BENCH_RANGE_PACKS transfer */
+std::shared_ptr<std::vector<uint32_t> >
+reorderedArrival(uint32_t window, std::mt19937& rng)
+{
+  std::shared_ptr<std::vector<uint32_t> > seqs(
+    new std::vector<uint32_t>(BENCH_RANGE_PACKS));
+  for (uint32_t i = 0; i < BENCH_RANGE_PACKS; i++)
+  {
+    (*seqs)[i] = i;
+  }
+  for (uint32_t base = 0; base < BENCH_RANGE_PACKS; base += window)
+  {
+    std::vector<uint32_t>::iterator begin = seqs->begin() + base;
+    std::shuffle(begin, begin + std::min(window, BENCH_RANGE_PACKS - base),
+                 rng);
+  }
+  return seqs;
+}
+
+/* Every lost pack comes again once the whole file was sent */
+std::shared_ptr<std::vector<uint32_t> >
+lossyArrival(double lossRate, std::mt19937& rng)
+{
+  std::shared_ptr<std::vector<uint32_t> > seqs(new std::vector<uint32_t>);
+  std::vector<uint32_t>                   lost;
+  std::bernoulli_distribution             loss(lossRate);
+  for (uint32_t i = 0; i < BENCH_RANGE_PACKS; i++)
+  {
+    if (i + 1 < BENCH_RANGE_PACKS && loss(rng))
+    {
+      lost.push_back(i);
+    }
+    else
+    {
+      seqs->push_back(i);
+    }
+  }
+  seqs->insert(seqs->end(), lost.begin(), lost.end());
+  return seqs;
+}
+
+/* Feeds one transfer, asking for the missing ranges every 1024 packs */
+uint32_t
+trackTransfer(CommonDataRangeHandler& ranges,
+              const std::vector<uint32_t>& seqs)
+{
+  Range  gaps[BENCH_RANGE_REQUEST];
+  size_t requested = 0;
+  ranges.DeInit();
+  for (size_t i = 0; i < seqs.size(); i++)
+  {
+    ranges.AddSeqIndex(seqs[i], 0, (uint32_t)(-1));
+    if ((i & 1023) == 0)
+    {
+      requested += ranges.GetNoAckRanges(gaps, BENCH_RANGE_REQUEST);
+    }
+  }
+  if (!ranges.IsAllReceived() ||
+      ranges.GetLastNotReceiveSeq() != BENCH_RANGE_PACKS)
+  {
+    std::cout << "download: range tracker lost track, "
+              << ranges.GetNoAckSeqCount() << " packs missing\n";
+  }
+  return (uint32_t)requested;
+}
+
+/* The media list a camera serves, packs as FileMgrImpl gets them once the
+ * V1 frames are unpacked: whole descriptors per pack, the list header in
+ * the first one and the last one flagged. Files firstIndex to fileCount are
+ * listed, their dates tell the card they are on apart. */
+std::shared_ptr<std::vector<std::vector<uint8_t> > >
+mediaListPacks(uint32_t fileCount, uint32_t firstIndex = 1,
+               uint32_t card = 0)
+{
+  const size_t headerLen =
+    sizeof(dji_general_transfer_msg_ack) - sizeof(uint8_t);
+  const size_t listHeaderLen =
+    sizeof(dji_file_list_download_resp) - sizeof(dji_list_info_descriptor);
+  const size_t descriptorLen =
+    sizeof(dji_list_info_descriptor) - sizeof(dji_file_list_ext_info);
+
+  std::shared_ptr<std::vector<std::vector<uint8_t> > > packs(
+    new std::vector<std::vector<uint8_t> >);
+  uint32_t listed = fileCount >= firstIndex ? fileCount - firstIndex + 1 : 0;
+  for (uint32_t file = firstIndex - 1; file < fileCount || packs->empty();)
+  {
+    std::vector<uint8_t> pack(headerLen);
+    if (packs->empty())
+    {
+      dji_file_list_download_resp list;
+      list.amount = listed;
+      list.len    = listed * descriptorLen + sizeof(list.amount);
+      pack.insert(pack.end(), (uint8_t*)&list,
+                  (uint8_t*)&list + listHeaderLen);
+    }
+    for (; file < fileCount &&
+           pack.size() + descriptorLen <= BENCH_LIST_PACK_LEN;
+         file++)
+    {
+      dji_list_info_descriptor descriptor;
+      memset(&descriptor, 0, sizeof(descriptor));
+      descriptor.create_time.year   = 40 + card % 8;
+      descriptor.create_time.month  = 1 + card % 12;
+      descriptor.create_time.day    = 1 + file / 1000 % 28;
+      descriptor.create_time.second = file % 30;
+      descriptor.index = file + 1;
+      descriptor.size  = 8 * 1024 * 1024;
+      descriptor.type  = (uint8_t)MediaFileType::JPEG;
+      pack.insert(pack.end(), (uint8_t*)&descriptor,
+                  (uint8_t*)&descriptor + descriptorLen);
+    }
+    packs->push_back(pack);
+  }
+
+  for (size_t seq = 0; seq < packs->size(); seq++)
+  {
+    dji_general_transfer_msg_ack* header =
+      (dji_general_transfer_msg_ack*)&(*packs)[seq][0];
+    header->version       = 1;
+    header->header_length = headerLen;
+    header->task_id       = DJI_GENERAL_DOWNLOAD_FILE_TASK_TYPE_LIST;
+    header->func_id       = DJI_GENERAL_DOWNLOAD_FILE_FUNC_TYPE_DATA;
+    header->msg_length    = (*packs)[seq].size();
+    header->msg_flag      = (seq + 1 == packs->size()) ? 0x01 : 0x00;
+    header->session_id    = 0;
+    header->seq           = seq;
+  }
+  return packs;
+}
+
+/* One listing: the request goes to the simulator, which acknowledges it the
+ * way the camera does, then the list packs are handed over in the order the
+ * camera's data would arrive in */
+typedef struct ListSession
+{
+  FileMgrImpl*                                         impl;
+  std::shared_ptr<std::vector<std::vector<uint8_t> > > packs;
+  std::vector<size_t>                                  order;
+  size_t                                               listed;
+  uint32_t                                             bytes;
+} ListSession;
+
+void
+onFileList(E_OsdkStat ret, FilePackagePtr list, void* userData)
+{
+  ((ListSession*)userData)->listed =
+    (ret == OSDK_STAT_OK) ? list->media.size() : 0;
+}
+
+/* The camera side of a media listing: the files from the index requested
+ * on go out a pack every BENCH_FETCH_PACK_US */
+class SimListServer
+{
+public:
+  SimListServer(FileMgrImpl* impl)
+    : impl(impl)
+    , serving(false)
+    , card(0)
+    , files(0)
+    , sentBytes(0)
+  {
+    std::thread(&SimListServer::run, this).detach();
+  }
+
+  /* Requests of other FileMgrImpls go unanswered while not serving */
+  void setServing(bool on)
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    serving = on;
+  }
+
+  void insertCard(uint32_t newCard, uint32_t fileCount)
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    card  = newCard;
+    files = fileCount;
+  }
+
+  void shoot(uint32_t fileCount)
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    files += fileCount;
+  }
+
+  uint32_t getFileCount()
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    return files;
+  }
+
+  /* List bytes put on the link since the last call */
+  uint32_t takeSentBytes()
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    uint32_t bytes = sentBytes;
+    sentBytes      = 0;
+    return bytes;
+  }
+
+  /* A list task message of FileMgrImpl, as received by the simulator */
+  void onMessage(const uint8_t* data, uint32_t length)
+  {
+    const size_t headerLen =
+      sizeof(dji_general_transfer_msg_req) - sizeof(uint8_t);
+    const dji_general_transfer_msg_req* req =
+      (const dji_general_transfer_msg_req*)data;
+    if (length < headerLen ||
+        req->task_id != DJI_GENERAL_DOWNLOAD_FILE_TASK_TYPE_LIST)
+    {
+      return;
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    if (!serving)
+    {
+      return;
+    }
+    if (req->func_id == DJI_GENERAL_DOWNLOAD_FILE_FUNC_TYPE_REQ)
+    {
+      const dji_file_list_download_req* list =
+        (const dji_file_list_download_req*)req->data;
+      packs = mediaListPacks(files, std::max<uint32_t>(list->index.index, 1),
+                             card);
+      next = 0;
+      wakeup.notify_one();
+    }
+    else if (req->func_id == DJI_GENERAL_DOWNLOAD_FILE_FUNC_TYPE_ABORT)
+    {
+      packs.reset();
+    }
+  }
+
+private:
+  void run()
+  {
+    std::unique_lock<std::mutex> guard(lock);
+    for (;;)
+    {
+      wakeup.wait(guard, [this]() { return packs && next < packs->size(); });
+      std::shared_ptr<std::vector<std::vector<uint8_t> > > sending = packs;
+      size_t                                               seq = next++;
+      sentBytes += (uint32_t)(*sending)[seq].size();
+      guard.unlock();
+      std::this_thread::sleep_for(
+        std::chrono::microseconds(BENCH_FETCH_PACK_US));
+      impl->HandlePushPack(
+        (dji_general_transfer_msg_ack*)&(*sending)[seq][0]);
+      guard.lock();
+    }
+  }
+
+  FileMgrImpl*                                         impl;
+  std::mutex                                           lock;
+  std::condition_variable                              wakeup;
+  bool                                                 serving;
+  uint32_t                                             card;
+  uint32_t                                             files;
+  std::shared_ptr<std::vector<std::vector<uint8_t> > > packs;
+  size_t                                               next;
+  uint32_t                                             sentBytes;
+};
+
+/* Listings of the card in SimListServer, finished when FileMgrImpl calls
+ * back; the list is kept to check it is shared when nothing changed */
+typedef struct CardSession
+{
+  FileMgrImpl*            impl;
+  SimListServer*          server;
+  std::mutex              lock;
+  std::condition_variable done;
+  bool                    finished;
+  E_OsdkStat              ret;
+  FilePackagePtr          list;
+  uint32_t                card;
+} CardSession;
+
+void
+onCardList(E_OsdkStat ret, FilePackagePtr list, void* userData)
+{
+  CardSession*                card = (CardSession*)userData;
+  std::lock_guard<std::mutex> guard(card->lock);
+  card->finished = true;
+  card->ret      = ret;
+  card->list     = list;
+  card->done.notify_one();
+}
+
+/* Lists the card and checks every file on it came back in order, and in
+ * the list shared before if unchanged; returns the bytes the camera sent */
+uint32_t
+listCard(CardSession* card, bool unchanged)
+{
+  FilePackagePtr before = card->list;
+  card->server->setServing(true);
+  card->server->takeSentBytes();
+  card->finished = false;
+  ErrorCode::ErrorCodeType ret = card->impl->startReqFileList(onCardList, card);
+
+  std::unique_lock<std::mutex> guard(card->lock);
+  if (ret == ErrorCode::SysCommonErr::Success)
+  {
+    card->done.wait_for(guard, std::chrono::seconds(10),
+                        [card]() { return card->finished; });
+  }
+  uint32_t files = card->server->getFileCount();
+  uint32_t bytes = card->server->takeSentBytes();
+  card->server->setServing(false);
+
+  bool ok = card->finished && card->ret == OSDK_STAT_OK &&
+            card->list->media.size() == files;
+  for (uint32_t i = 0; ok && i < files; i++)
+  {
+    ok = card->list->media[i].fileIndex == (int)(i + 1);
+  }
+  if (!ok)
+  {
+    std::cout << "download: listed "
+              << (card->finished ? card->list->media.size() : 0) << " of "
+              << files << " files\n";
+  }
+  else if (unchanged && before && card->list != before)
+  {
+    std::cout << "download: an unchanged card was listed into a new copy\n";
+  }
+  return bytes;
+}
+
+/* What the simulated camera serves and how */
+typedef struct SimLink
+{
+  uint32_t blocks;
+  uint32_t packIntervalUs;
+  uint32_t latencyMs;
+  double   lossRate;
+} SimLink;
+
+/* Byte at offset of the file the simulated camera serves, the same across
+ * each run of BENCH_FILE_RUN bytes so that packs are filled with memset */
+#define BENCH_FILE_RUN 64
+
+uint8_t
+fileByte(uint64_t offset)
+{
+  return (uint8_t)((offset >> 6) + (offset >> 14) * 7 + (offset >> 22) * 31);
+}
+
+/* The camera side of a file download. The range requested goes out in
+ * packs, one per packIntervalUs, which reach FileMgrImpl latencyMs later
+ * unless the link drops them; packs NACKed go out again before the rest. */
+class SimFileServer
+{
+public:
+  SimFileServer(FileMgrImpl* impl)
+    : impl(impl)
+    , rng(1)
+    , ignoreRange(false)
+    , rangeOffset(0)
+    , rangeLength(0)
+    , packs(0)
+    , cutAfter(0)
+    , cut(false)
+    , sent(0)
+    , resent(0)
+    , sentBytes(0)
+  {
+    link.blocks         = 0;
+    link.packIntervalUs = 0;
+    link.latencyMs      = 0;
+    link.lossRate       = 0;
+    std::thread(&SimFileServer::run, this).detach();
+  }
+
+  void setLink(const SimLink& newLink)
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    clear();
+    link = newLink;
+  }
+
+  /* Sends the whole file whatever range is asked for, as a camera without
+   * ranged downloads would */
+  void setIgnoreRange(bool ignore)
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    ignoreRange = ignore;
+  }
+
+  /* Drops the link for good once bytes more file data went out, as if the
+   * process on the other end was killed */
+  void cutLinkAfter(uint64_t bytes)
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    cutAfter = sentBytes + bytes;
+  }
+
+  void waitLinkCut()
+  {
+    std::unique_lock<std::mutex> guard(lock);
+    linkCut.wait(guard, [this]() { return cut; });
+  }
+
+  /* Brings the link back, sending what was left of the range */
+  void restoreLink()
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    cut      = false;
+    cutAfter = 0;
+    for (uint32_t seq = cutSeq; seq < packs; seq++)
+    {
+      enqueue(seq, false);
+    }
+    wakeup.notify_one();
+  }
+
+  /* Counts packs and file data bytes put on the link since the last call */
+  void takeCounts(uint32_t& sentPacks, uint32_t& resentPacks,
+                  uint64_t& bytes)
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    sentPacks   = sent;
+    resentPacks = resent;
+    bytes       = sentBytes;
+    sent = resent = 0;
+    sentBytes     = 0;
+    cutAfter      = 0;
+  }
+
+  /* A file task message of FileMgrImpl, as received by the simulator */
+  void onMessage(const uint8_t* data, uint32_t length)
+  {
+    const size_t headerLen =
+      sizeof(dji_general_transfer_msg_req) - sizeof(uint8_t);
+    const dji_general_transfer_msg_req* req =
+      (const dji_general_transfer_msg_req*)data;
+    if (length < headerLen ||
+        req->task_id != DJI_GENERAL_DOWNLOAD_FILE_TASK_TYPE_FILE)
+    {
+      return;
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    if (cut)
+    {
+      return;
+    }
+    switch (req->func_id)
+    {
+      case DJI_GENERAL_DOWNLOAD_FILE_FUNC_TYPE_REQ:
+      {
+        /* Size -1 is up to the end of the file */
+        const dji_file_download_req* file =
+          (const dji_file_download_req*)req->data;
+        uint64_t fileLength = (uint64_t)link.blocks * BENCH_BLOCK_LEN;
+        clear(false);
+        rangeOffset = std::min<uint64_t>(file->offset, fileLength);
+        rangeLength = std::min<uint64_t>(file->size, fileLength - rangeOffset);
+        if (ignoreRange)
+        {
+          rangeOffset = 0;
+          rangeLength = fileLength;
+        }
+        packs       = (rangeLength + BENCH_BLOCK_LEN - 1) / BENCH_BLOCK_LEN;
+        queued.assign(packs, false);
+        for (uint32_t seq = 0; seq < packs; seq++)
+        {
+          enqueue(seq, false);
+        }
+        break;
+      }
+      case DJI_GENERAL_DOWNLOAD_FILE_FUNC_TYPE_ACK:
+      {
+        const dji_download_ack* ack = (const dji_download_ack*)req->data;
+        std::vector<uint32_t>   seqs;
+        for (uint32_t i = 0; i < ack->loss_nr; i++)
+        {
+          for (uint32_t n = 0; n < ack->loss_desc[i].cnt; n++)
+          {
+            seqs.push_back(ack->loss_desc[i].seq + n);
+          }
+        }
+        /* Nothing missing below expect_seq: the tail went missing, or past
+         * the end the last pack confirms the transfer is over */
+        for (uint32_t seq = ack->expect_seq;
+             ack->loss_nr == 0 && seq < packs; seq++)
+        {
+          seqs.push_back(seq);
+        }
+        if (ack->loss_nr == 0 && ack->expect_seq >= packs && packs > 0)
+        {
+          seqs.push_back(packs - 1);
+        }
+        for (size_t i = seqs.size(); i-- > 0;)
+        {
+          enqueue(seqs[i], true);
+        }
+        break;
+      }
+      case DJI_GENERAL_DOWNLOAD_FILE_FUNC_TYPE_ABORT:
+        clear(false);
+        break;
+      default:
+        break;
+    }
+    wakeup.notify_one();
+  }
+
+private:
+  typedef std::chrono::steady_clock Clock;
+  typedef struct Delivery
+  {
+    Clock::time_point    due;
+    std::vector<uint8_t> pack;
+  } Delivery;
+
+  /* Called locked */
+  void enqueue(uint32_t seq, bool first)
+  {
+    if (seq >= packs || queued[seq])
+    {
+      return;
+    }
+    queued[seq] = true;
+    if (first)
+    {
+      sendQueue.push_front(seq);
+      resent++;
+    }
+    else
+    {
+      sendQueue.push_back(seq);
+    }
+  }
+
+  /* Called locked; packs already on the link still arrive unless the link
+   * goes */
+  void clear(bool dropLink = true)
+  {
+    sendQueue.clear();
+    if (dropLink)
+    {
+      inFlight.clear();
+    }
+    std::fill(queued.begin(), queued.end(), false);
+  }
+
+  std::vector<uint8_t> pack(uint32_t seq)
+  {
+    const size_t headerLen =
+      sizeof(dji_general_transfer_msg_ack) - sizeof(uint8_t);
+    const size_t respLen =
+      sizeof(dji_file_data_download_resp) - sizeof(uint8_t);
+    std::vector<uint8_t> pack(headerLen);
+    pack.reserve(headerLen + respLen + BENCH_BLOCK_LEN);
+    if (seq == 0)
+    {
+      dji_file_data_download_resp resp;
+      memset(&resp, 0, sizeof(resp));
+      resp.size = rangeLength + respLen;
+      pack.insert(pack.end(), (uint8_t*)&resp, (uint8_t*)&resp + respLen);
+    }
+    uint64_t offset = (uint64_t)seq * BENCH_BLOCK_LEN;
+    uint32_t length =
+      std::min<uint64_t>(BENCH_BLOCK_LEN, rangeLength - offset);
+    offset += rangeOffset;
+    size_t dataStart = pack.size();
+    pack.resize(dataStart + length);
+    for (uint32_t i = 0, run = 0; i < length; i += run)
+    {
+      run = std::min<uint64_t>(BENCH_FILE_RUN - (offset + i) % BENCH_FILE_RUN,
+                               length - i);
+      memset(&pack[dataStart + i], fileByte(offset + i), run);
+    }
+    sentBytes += length;
+
+    dji_general_transfer_msg_ack* header =
+      (dji_general_transfer_msg_ack*)&pack[0];
+    header->version       = 1;
+    header->header_length = headerLen;
+    header->task_id       = DJI_GENERAL_DOWNLOAD_FILE_TASK_TYPE_FILE;
+    header->func_id       = DJI_GENERAL_DOWNLOAD_FILE_FUNC_TYPE_DATA;
+    header->msg_length    = pack.size();
+    header->msg_flag      = (seq + 1 == packs) ? 0x01 : 0x00;
+    header->seq           = seq;
+    return pack;
+  }
+
+  void run()
+  {
+    std::unique_lock<std::mutex> guard(lock);
+    Clock::time_point            nextSend = Clock::now();
+    for (;;)
+    {
+      /* Arrivals first, or a server without pacing has the whole file on
+       * the link before FileMgrImpl sees a pack */
+      Clock::time_point now = Clock::now();
+      if (!inFlight.empty() && now >= inFlight.front().due)
+      {
+        std::vector<uint8_t> arrived;
+        arrived.swap(inFlight.front().pack);
+        inFlight.pop_front();
+        guard.unlock();
+        impl->HandlePushPack((dji_general_transfer_msg_ack*)&arrived[0]);
+        guard.lock();
+        continue;
+      }
+      if (cutAfter != 0 && sentBytes >= cutAfter && !cut)
+      {
+        cut    = true;
+        cutSeq = sendQueue.empty() ? packs : sendQueue.front();
+        clear();
+        linkCut.notify_all();
+      }
+      if (!cut && !sendQueue.empty() && now >= nextSend)
+      {
+        uint32_t seq = sendQueue.front();
+        sendQueue.pop_front();
+        queued[seq] = false;
+        sent++;
+        if (!std::bernoulli_distribution(link.lossRate)(rng))
+        {
+          Delivery delivery = {
+            now + std::chrono::milliseconds(link.latencyMs), pack(seq)
+          };
+          inFlight.push_back(delivery);
+        }
+        nextSend = now + std::chrono::microseconds(link.packIntervalUs);
+        continue;
+      }
+
+      Clock::time_point wake = now + std::chrono::seconds(1);
+      if (!sendQueue.empty())
+      {
+        wake = std::min(wake, nextSend);
+      }
+      if (!inFlight.empty())
+      {
+        wake = std::min(wake, inFlight.front().due);
+      }
+      wakeup.wait_until(guard, wake);
+    }
+  }
+
+  FileMgrImpl*            impl;
+  std::mutex              lock;
+  std::condition_variable wakeup;
+  std::condition_variable linkCut;
+  SimLink                 link;
+  std::mt19937            rng;
+  bool                    ignoreRange;
+  uint64_t                rangeOffset;
+  uint64_t                rangeLength;
+  uint32_t                packs;
+  uint64_t                cutAfter;
+  bool                    cut;
+  uint32_t                cutSeq;
+  std::deque<uint32_t>    sendQueue;
+  std::vector<bool>       queued;
+  std::deque<Delivery>    inFlight;
+  uint32_t                sent;
+  uint32_t                resent;
+  uint64_t                sentBytes;
+};
+
+/* One download, finished when FileMgrImpl calls back */
+typedef struct FetchSession
+{
+  FileMgrImpl*            impl;
+  SimFileServer*          server;
+  std::mutex              lock;
+  std::condition_variable done;
+  bool                    finished;
+  E_OsdkStat              ret;
+} FetchSession;
+
+void
+onFileData(E_OsdkStat ret, void* userData)
+{
+  FetchSession*               fetch = (FetchSession*)userData;
+  std::lock_guard<std::mutex> guard(fetch->lock);
+  fetch->finished = true;
+  fetch->ret      = ret;
+  fetch->done.notify_one();
+}
+
+/* Downloads the file link describes to path, or what is missing of it;
+ * returns its size, 0 if the download failed, and what the camera sent in
+ * fetched */
+uint32_t
+fetchFile(FetchSession* fetch, const SimLink& link, const std::string& path,
+          uint64_t* fetched = NULL)
+{
+  fetch->server->setLink(link);
+  fetch->finished = false;
+  ErrorCode::ErrorCodeType ret =
+    fetch->impl->startReqFileData(1, path, onFileData, fetch);
+
+  std::unique_lock<std::mutex> guard(fetch->lock);
+  if (ret == ErrorCode::SysCommonErr::Success)
+  {
+    fetch->done.wait_for(guard, std::chrono::seconds(60),
+                         [fetch]() { return fetch->finished; });
+  }
+  bool       ok     = fetch->finished && fetch->ret == OSDK_STAT_OK;
+  E_OsdkStat status = fetch->ret;
+  guard.unlock();
+
+  uint32_t sent, resent;
+  uint64_t bytes;
+  fetch->server->takeCounts(sent, resent, bytes);
+  if (fetched)
+  {
+    *fetched = bytes;
+  }
+  if (!ok)
+  {
+    std::cout << "download: fetch to " << path << " failed (" << (int)status
+              << "), " << sent << " packs sent, " << resent
+              << " of them again\n";
+  }
+  return ok ? link.blocks * BENCH_BLOCK_LEN : 0;
+}
+
+/* Downloads the file link describes to path and removes it again */
+uint32_t
+fetchAndRemove(FetchSession* fetch, const SimLink& link,
+               const std::string& path)
+{
+  uint32_t bytes = fetchFile(fetch, link, path);
+  unlink(path.c_str());
+  unlink((path + ".progress").c_str());
+  return bytes;
+}
+
+bool
+copyFile(const std::string& from, const std::string& to)
+{
+  std::ifstream in(from.c_str(), std::ios::binary);
+  std::ofstream out(to.c_str(), std::ios::binary | std::ios::trunc);
+  out << in.rdbuf();
+  return in && out;
+}
+
+/* Counts the bytes of path that differ from what the camera serves */
+uint64_t
+badBytes(const std::string& path, uint64_t length)
+{
+  std::ifstream        in(path.c_str(), std::ios::binary);
+  std::vector<uint8_t> buffer(1024 * 1024);
+  uint64_t             bad = 0;
+  for (uint64_t offset = 0; offset < length; offset += buffer.size())
+  {
+    size_t size = std::min<uint64_t>(buffer.size(), length - offset);
+    if (!in.read((char*)&buffer[0], size))
+    {
+      return length - offset + bad;
+    }
+    for (size_t i = 0; i < size; i++)
+    {
+      bad += buffer[i] != fileByte(offset + i);
+    }
+  }
+  return bad;
+}
+
+/* Data of a download resumed after the process was killed part way */
+typedef struct ResumeStats
+{
+  std::mutex lock;
+  uint64_t   resumes;
+  uint64_t   refetchedBytes;
+  uint64_t   badBytes;
+} ResumeStats;
+
+/* Cuts the link after cutBytes of a download and keeps the file and its
+ * progress as they are then, like a crash would; once the download went
+ * on to the end they are put back and it is resumed from there. Returns
+ * the bytes the resumed download fetched. */
+uint32_t
+fetchResumed(FetchSession* fetch, ResumeStats* stats, const SimLink& link,
+             uint64_t cutBytes, const std::string& path)
+{
+  const std::string progressPath = path + ".progress";
+  const std::string crashPath    = path + ".crash";
+  uint32_t          sent, resent;
+  uint64_t          bytes;
+
+  fetch->server->setLink(link);
+  fetch->server->takeCounts(sent, resent, bytes);
+  fetch->server->cutLinkAfter(cutBytes);
+  fetch->finished = false;
+  if (fetch->impl->startReqFileData(1, path, onFileData, fetch) !=
+      ErrorCode::SysCommonErr::Success)
+  {
+    return 0;
+  }
+  fetch->server->waitLinkCut();
+  copyFile(path, crashPath);
+  bool saved = copyFile(progressPath, progressPath + ".crash");
+  fetch->server->restoreLink();
+  {
+    std::unique_lock<std::mutex> guard(fetch->lock);
+    fetch->done.wait_for(guard, std::chrono::seconds(60),
+                         [fetch]() { return fetch->finished; });
+  }
+  rename(crashPath.c_str(), path.c_str());
+  if (saved)
+  {
+    rename((progressPath + ".crash").c_str(), progressPath.c_str());
+  }
+  fetch->server->takeCounts(sent, resent, bytes);
+
+  uint64_t length = (uint64_t)link.blocks * BENCH_BLOCK_LEN;
+  bool     ok     = fetchFile(fetch, link, path, &bytes) == length;
+  {
+    std::lock_guard<std::mutex> guard(stats->lock);
+    stats->resumes++;
+    stats->refetchedBytes += bytes;
+    stats->badBytes += ok ? badBytes(path, length) : length;
+  }
+  unlink(path.c_str());
+  unlink(progressPath.c_str());
+  return bytes;
+}
+
+/* Resident set of this process in kB, 0 if unknown */
+uint64_t
+residentKB()
+{
+  FILE* status = fopen("/proc/self/status", "r");
+  if (!status)
+  {
+    return 0;
+  }
+  char     line[128];
+  uint64_t kb = 0;
+  while (fgets(line, sizeof(line), status))
+  {
+    if (sscanf(line, "VmRSS: %llu kB", (unsigned long long*)&kb) == 1)
+    {
+      break;
+    }
+  }
+  fclose(status);
+  return kb;
+}
+
+/* Reports how far the resident set grew while a benchmark ran */
+BenchmarkRunner::Background
+residentGrowth(const std::string& name)
+{
+  return [name](const std::atomic<bool>& running) {
+    uint64_t baseKB = residentKB();
+    uint64_t peakKB = baseKB;
+    while (running)
+    {
+      peakKB = std::max(peakKB, residentKB());
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    std::cout << name << ": resident set grew by "
+              << (peakKB - baseKB) / 1024 << " MB at most\n";
+  };
+}
+
+/* Keeps the H264 callback from being optimised away */
+uint64_t h264Checksum = 0;
+
+} // namespace
+
+void
+registerMediaBenchmarks(BenchmarkRunner& runner)
+{
+  std::shared_ptr<DownloadFixture> d(new DownloadFixture);
+  if (d->path.empty() ||
+      !d->file.open(d->path) ||
+      !d->file.setFileSize((uint64_t)BENCH_BLOCK_LEN * BENCH_FILE_BLOCKS))
+  {
+    std::cout << "skipping download: cannot create temporary file\n";
+  }
+  else
+  {
+    d->queue.InitBufferQueue(BENCH_WINDOW_BLOCKS, 0);
+
+    runner.add("download/reassemble_64KB", 20000, [d]() -> uint32_t {
+      int base = d->nextIndex;
+      for (int i = 0; i < BENCH_WINDOW_BLOCKS; i++)
+      {
+        int index = base + d->order[i];
+        d->queue.InsertBlock(&d->block[0], BENCH_BLOCK_LEN, index, false);
+        d->ranges.AddSeqIndex(index, d->queue.GetConfirmSeq(),
+                              BENCH_WINDOW_BLOCKS);
+      }
+
+      d->views.clear();
+      d->queue.DequeueAllBuffer(d->views);
+      for (size_t i = 0; i < d->views.size(); i++)
+      {
+        d->file.write((uint64_t)((base + i) % BENCH_FILE_BLOCKS) *
+                        BENCH_BLOCK_LEN,
+                      (const uint8_t*)d->views[i].data, d->views[i].length);
+      }
+      d->queue.ReleaseBuffer(d->views);
+      Range gaps[BENCH_RANGE_REQUEST];
+      d->ranges.GetNoAckRanges(gaps, BENCH_RANGE_REQUEST);
+
+      d->nextIndex = base + BENCH_WINDOW_BLOCKS;
+      return BENCH_WINDOW_BLOCKS * BENCH_BLOCK_LEN;
+    });
+  }
+
+  Vehicle*             v   = getSimulatedVehicle();
+  SimFlightController* sim = getSimulatedAcmChannel();
+  if (!v || !sim)
+  {
+    std::cout << "skipping download/list: simulated vehicle unavailable\n";
+  }
+  else
+  {
+    /* Its monitor task may outlive a deleted FileMgrImpl, so like the
+     * vehicle it stays until exit, together with the server feeding it */
+    std::shared_ptr<FetchSession> fetch(new FetchSession);
+    fetch->impl = new FileMgrImpl(v->linker, OSDK_COMMAND_DEVICE_TYPE_CAMERA, 0);
+    fetch->server   = new SimFileServer(fetch->impl);
+    fetch->finished = false;
+    fetch->ret      = OSDK_STAT_OK;
+
+    /* The request ACK carries the camera's error code, 0 is success; file
+     * task messages are served by the simulated camera */
+    SimFileServer* server = fetch->server;
+    std::shared_ptr<CardSession> card(new CardSession);
+    card->impl = new FileMgrImpl(v->linker, OSDK_COMMAND_DEVICE_TYPE_CAMERA, 0);
+    card->server   = new SimListServer(card->impl);
+    card->finished = false;
+    card->ret      = OSDK_STAT_OK;
+    card->card     = 0;
+    card->server->insertCard(card->card, BENCH_CARD_FILES);
+
+    SimListServer* listServer = card->server;
+    sim->registerHandler(
+      V1ProtocolCMD::Common::downloadFile[0],
+      V1ProtocolCMD::Common::downloadFile[1],
+      [server, listServer](const T_CmdInfo& req, const uint8_t* data,
+                           std::vector<uint8_t>& ack) -> bool {
+        server->onMessage(data, req.dataLen);
+        listServer->onMessage(data, req.dataLen);
+        ack.assign(1, 0);
+        return true;
+      });
+    /* Every pack out of order is logged */
+    DJI::OSDK::Log::instance().disableStatusLogging();
+
+    std::shared_ptr<ListSession> list(new ListSession);
+    list->impl =
+      new FileMgrImpl(v->linker, OSDK_COMMAND_DEVICE_TYPE_CAMERA, 0);
+    list->packs  = mediaListPacks(BENCH_LIST_FILES);
+    list->listed = 0;
+    list->bytes  = 0;
+    /* neighbouring packs swapped, the flagged last one has to come last */
+    for (size_t seq = 0; seq < list->packs->size(); seq++)
+    {
+      list->order.push_back(seq);
+      list->bytes += (uint32_t)(*list->packs)[seq].size();
+    }
+    for (size_t seq = 0; seq + 2 < list->order.size(); seq += 2)
+    {
+      std::swap(list->order[seq], list->order[seq + 1]);
+    }
+
+    /* The linker now and then retries the request ACK after 500 ms, which
+     * shows in p99 rather than p50 */
+    runner.add("download/list_20k_files", 50, [list]() -> uint32_t {
+      list->listed = 0;
+      list->impl->clearFileListCache();
+      list->impl->startReqFileList(onFileList, list.get());
+      for (size_t i = 0; i < list->order.size(); i++)
+      {
+        list->impl->HandlePushPack((dji_general_transfer_msg_ack*)&(
+          *list->packs)[list->order[i]][0]);
+      }
+      if (list->listed != BENCH_LIST_FILES)
+      {
+        std::cout << "download: listed " << list->listed << " of "
+                  << BENCH_LIST_FILES << " files\n";
+      }
+      return list->bytes;
+    });
+
+    /* A card listed from scratch, listed again with nothing new and with a
+     * few photos shot since, and swapped for another one each time */
+    runner.add("download/list_10k_cold", 20, [card]() -> uint32_t {
+      card->impl->clearFileListCache();
+      return listCard(card.get(), false);
+    });
+    runner.add("download/list_10k_warm", 20, [card]() -> uint32_t {
+      return listCard(card.get(), true);
+    });
+    runner.add("download/list_10k_warm_10_new", 20, [card]() -> uint32_t {
+      card->server->shoot(BENCH_CARD_NEW);
+      return listCard(card.get(), false);
+    });
+    runner.add("download/list_10k_card_swapped", 20, [card]() -> uint32_t {
+      card->server->insertCard(++card->card, BENCH_CARD_FILES);
+      return listCard(card.get(), false);
+    });
+
+    /* A whole download over a lossy link; its time over the ~120 ms the
+     * packs take on a clean one is spent waiting for retransmissions */
+    const double lossRates[] = { 0, 0.01, 0.05, 0.10 };
+    for (size_t i = 0; i < sizeof(lossRates) / sizeof(lossRates[0]); i++)
+    {
+      double             lossRate = lossRates[i];
+      std::ostringstream name;
+      name << "download/fetch_1MB_loss" << (int)(lossRate * 100) << "pct";
+      SimLink link = { BENCH_FETCH_BLOCKS, BENCH_FETCH_PACK_US,
+                       BENCH_FETCH_LATENCY, lossRate };
+      runner.add(name.str(), 5, [fetch, link]() -> uint32_t {
+        return fetchAndRemove(fetch.get(), link, "/tmp/osdk-benchmark-fetch");
+      });
+    }
+
+    /* Write throughput of a long download, to tmpfs and to whatever /tmp is
+     * on; the resident set is not to grow with the file */
+    SimLink video = { BENCH_VIDEO_BLOCKS, 0, 0, 0 };
+    runner.add("download/fetch_64MB_tmpfs", 3,
+               [fetch, video]() -> uint32_t {
+                 return fetchAndRemove(fetch.get(), video,
+                                       "/dev/shm/osdk-benchmark-fetch");
+               },
+               residentGrowth("download/fetch_64MB_tmpfs"));
+    runner.add("download/fetch_64MB_tmp", 3,
+               [fetch, video]() -> uint32_t {
+                 return fetchAndRemove(fetch.get(), video,
+                                       "/tmp/osdk-benchmark-fetch");
+               },
+               residentGrowth("download/fetch_64MB_tmp"));
+
+    /* A download killed part way and resumed: only what was not on disk yet
+     * is to be fetched again, and the file has to come out right */
+    /* Over a link with latency and loss, packs of one range still arrive
+     * after the next was asked for; a camera ignoring the range has the
+     * whole file fetched again */
+    SimLink lossyVideo = { BENCH_VIDEO_BLOCKS, 0, BENCH_FETCH_LATENCY, 0.01 };
+    const struct
+    {
+      const char* name;
+      SimLink     link;
+      bool        ignoreRange;
+    } resumes[] = {
+      { "download/resume_64MB_cut_at_36MB", video, false },
+      { "download/resume_64MB_lossy", lossyVideo, false },
+      { "download/resume_64MB_range_ignored", video, true },
+    };
+    for (size_t i = 0; i < sizeof(resumes) / sizeof(resumes[0]); i++)
+    {
+      std::string                  name = resumes[i].name;
+      SimLink                      link = resumes[i].link;
+      bool                         ignoreRange = resumes[i].ignoreRange;
+      std::shared_ptr<ResumeStats> resume(new ResumeStats);
+      resume->resumes = resume->refetchedBytes = resume->badBytes = 0;
+      runner.add(
+        name, 3,
+        [fetch, resume, link, ignoreRange]() -> uint32_t {
+          fetch->server->setIgnoreRange(ignoreRange);
+          uint32_t bytes =
+            fetchResumed(fetch.get(), resume.get(), link, BENCH_VIDEO_CUT,
+                         "/tmp/osdk-benchmark-resume");
+          fetch->server->setIgnoreRange(false);
+          return bytes;
+        },
+        [name, resume](const std::atomic<bool>& running) {
+          while (running)
+          {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+          }
+          std::lock_guard<std::mutex> guard(resume->lock);
+          uint64_t perResume = resume->resumes
+                                 ? resume->refetchedBytes / resume->resumes
+                                 : 0;
+          std::cout << name << ": " << perResume / 1000
+                    << " kB fetched again of "
+                    << ((uint64_t)BENCH_VIDEO_BLOCKS * BENCH_BLOCK_LEN -
+                        BENCH_VIDEO_CUT) / 1000
+                    << " kB missing, " << resume->badBytes << " bytes wrong\n";
+        });
+    }
+  }
+
+  /* Range tracking alone over a million pack transfer: reordering within a
+   * window, loss with a retransmission pass at the end, and arrival in no
+   * order at all */
+  std::mt19937 rng(1);
+  std::shared_ptr<std::vector<uint32_t> > reordered = reorderedArrival(256, rng);
+  std::shared_ptr<std::vector<uint32_t> > lossy     = lossyArrival(0.02, rng);
+  std::shared_ptr<std::vector<uint32_t> > shuffled =
+    reorderedArrival(BENCH_RANGE_PACKS, rng);
+  std::shared_ptr<CommonDataRangeHandler> tracker(new CommonDataRangeHandler);
+
+  runner.add("download/range_1M_reordered", 5,
+             [tracker, reordered]() -> uint32_t {
+               trackTransfer(*tracker, *reordered);
+               return 0;
+             });
+  runner.add("download/range_1M_lossy", 5, [tracker, lossy]() -> uint32_t {
+    trackTransfer(*tracker, *lossy);
+    return 0;
+  });
+  runner.add("download/range_1M_shuffled", 5,
+             [tracker, shuffled]() -> uint32_t {
+               trackTransfer(*tracker, *shuffled);
+               return 0;
+             });
+
+#ifdef ADVANCED_SENSING
+  typedef std::map<LiveView::LiveViewCameraPosition,
+                   LiveViewImpl::H264CallbackHandler>
+    HandlerMap;
+
+  std::shared_ptr<HandlerMap> handlers(new HandlerMap);
+  (*handlers)[LiveView::OSDK_CAMERA_POSITION_NO_1] = {
+    [](uint8_t* buf, int bufLen, void* userData) {
+      *(uint64_t*)userData += buf[bufLen - 1];
+    },
+    &h264Checksum
+  };
+  (*handlers)[LiveView::OSDK_CAMERA_POSITION_NO_2] = { NULL, NULL };
+  (*handlers)[LiveView::OSDK_CAMERA_POSITION_NO_3] = { NULL, NULL };
+  (*handlers)[LiveView::OSDK_CAMERA_POSITION_FPV]  = { NULL, NULL };
+
+  std::shared_ptr<std::vector<uint8_t> > frame(
+    new std::vector<uint8_t>(BENCH_H264_FRAME, 0x5A));
+
+  runner.add("liveview/h264_dispatch_32KB", 200000,
+             [handlers, frame]() -> uint32_t {
+               T_CmdInfo info;
+               memset(&info, 0, sizeof(info));
+               info.cmdSet  = 0x65;
+               info.cmdId   = 0x55;
+               info.dataLen = (uint32_t)frame->size();
+               LiveViewBenchmarkHook::dispatch(&info, &(*frame)[0],
+                                               handlers.get());
+               return (uint32_t)frame->size();
+             });
+#endif
+}
@@ -0,0 +1,438 @@
+/*! @file benchmark_mop.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief
+ *  MOP pipelines opened and closed from many threads over an in-process
+ *  loopback instead of the link to a payload.
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "dji_mop_client.hpp"
+#include "dji_mop_server.hpp"
+#include "osdk_benchmark.hpp"
+
+using namespace DJI::OSDK;
+using namespace DJI::OSDK::MOP;
+
+namespace
+{
+
+/*! A connection to the simulated payload, which echoes what it gets */
+typedef struct LoopbackPipe
+{
+  std::mutex              mutex;
+  std::condition_variable changed;
+  std::deque<uint8_t>     data;
+  bool                    closed = false;
+} LoopbackPipe;
+
+typedef struct LoopbackChannel
+{
+  mop_trans_t                   trans;
+  std::shared_ptr<LoopbackPipe> pipe;
+  /*! bound channel id, -1 if not bound */
+  int32_t boundId = -1;
+  /*! set by closing, a bind or connect after that fails */
+  bool closed = false;
+} LoopbackChannel;
+
+/*! The payload side: bound channel ids and the connections it made to them
+ *  that are still to be accepted */
+class LoopbackRouter
+{
+public:
+  int32_t bind(LoopbackChannel* channel, uint16_t id)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (channel->closed)
+      return MOP_ERR_CONNECTIONCLOSE;
+    if (listeners.count(id))
+      return MOP_ERR_HASBINDED;
+    listeners[id];
+    channel->boundId = id;
+    changed.notify_all();
+    return MOP_SUCCESS;
+  }
+
+  /*! A connection of our own to the payload */
+  int32_t connect(LoopbackChannel* channel)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (channel->closed)
+      return MOP_ERR_CONNECTIONCLOSE;
+    channel->pipe = std::make_shared<LoopbackPipe>();
+    return MOP_SUCCESS;
+  }
+
+  /*! Unbinds channel and returns its connection, if any */
+  std::shared_ptr<LoopbackPipe> close(LoopbackChannel* channel)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    channel->closed = true;
+    if (channel->boundId >= 0)
+    {
+      listeners.erase(channel->boundId);
+      channel->boundId = -1;
+      changed.notify_all();
+    }
+    return channel->pipe;
+  }
+
+  /*! The payload connects to id once it is bound */
+  void remoteConnect(uint16_t id)
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&] { return listeners.count(id) != 0; });
+    listeners[id].push_back(std::make_shared<LoopbackPipe>());
+    changed.notify_all();
+  }
+
+  int32_t accept(LoopbackChannel* channel, mop_channel_handle_t* out)
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&] {
+      return channel->boundId < 0 || !listeners[channel->boundId].empty();
+    });
+    if (channel->boundId < 0)
+      return MOP_ERR_CONNECTIONCLOSE;
+    std::deque<std::shared_ptr<LoopbackPipe> >& pending =
+      listeners[channel->boundId];
+    LoopbackChannel* accepted = new LoopbackChannel;
+    accepted->trans = channel->trans;
+    accepted->pipe  = pending.front();
+    pending.pop_front();
+    *out = accepted;
+    return MOP_SUCCESS;
+  }
+
+private:
+  std::mutex              mutex;
+  std::condition_variable changed;
+  std::map<uint16_t, std::deque<std::shared_ptr<LoopbackPipe> > > listeners;
+};
+
+LoopbackRouter router;
+
+/*! Channel ids the payload refuses connections to */
+const uint16_t LOOPBACK_REFUSED_ID_BASE = 2000;
+
+int32_t
+loopbackCreate(mop_channel_handle_t* handle, mop_trans_t trans)
+{
+  LoopbackChannel* channel = new LoopbackChannel;
+  channel->trans = trans;
+  *handle = channel;
+  return MOP_SUCCESS;
+}
+
+int32_t
+loopbackDestroy(mop_channel_handle_t handle)
+{
+  delete static_cast<LoopbackChannel*>(handle);
+  return MOP_SUCCESS;
+}
+
+int32_t
+loopbackBind(mop_channel_handle_t handle, uint16_t id)
+{
+  return router.bind(static_cast<LoopbackChannel*>(handle), id);
+}
+
+int32_t
+loopbackConnect(mop_channel_handle_t handle, mop_device_t device, uint8_t slot,
+                uint16_t id)
+{
+  (void)device;
+  (void)slot;
+  if (id >= LOOPBACK_REFUSED_ID_BASE)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return MOP_ERR_CONNECTREJECT;
+  }
+  return router.connect(static_cast<LoopbackChannel*>(handle));
+}
+
+int32_t
+loopbackAccept(mop_channel_handle_t handle, mop_channel_handle_t* out)
+{
+  return router.accept(static_cast<LoopbackChannel*>(handle), out);
+}
+
+int32_t
+loopbackRead(mop_channel_handle_t handle, void* buf, uint32_t length)
+{
+  LoopbackPipe&                pipe = *static_cast<LoopbackChannel*>(handle)->pipe;
+  std::unique_lock<std::mutex> lock(pipe.mutex);
+  pipe.changed.wait(lock, [&] { return pipe.closed || !pipe.data.empty(); });
+  if (pipe.data.empty())
+    return MOP_ERR_CONNECTIONCLOSE;
+  uint32_t n = std::min<uint32_t>(length, pipe.data.size());
+  std::copy(pipe.data.begin(), pipe.data.begin() + n,
+            static_cast<uint8_t*>(buf));
+  pipe.data.erase(pipe.data.begin(), pipe.data.begin() + n);
+  return n;
+}
+
+int32_t
+loopbackWrite(mop_channel_handle_t handle, void* buf, uint32_t length)
+{
+  LoopbackPipe&               pipe = *static_cast<LoopbackChannel*>(handle)->pipe;
+  std::lock_guard<std::mutex> lock(pipe.mutex);
+  if (pipe.closed)
+    return MOP_ERR_CONNECTIONCLOSE;
+  const uint8_t* data = static_cast<const uint8_t*>(buf);
+  pipe.data.insert(pipe.data.end(), data, data + length);
+  pipe.changed.notify_all();
+  return length;
+}
+
+int32_t
+loopbackClose(mop_channel_handle_t handle)
+{
+  std::shared_ptr<LoopbackPipe> pipe =
+    router.close(static_cast<LoopbackChannel*>(handle));
+  if (pipe)
+  {
+    std::lock_guard<std::mutex> lock(pipe->mutex);
+    pipe->closed = true;
+    pipe->changed.notify_all();
+  }
+  return MOP_SUCCESS;
+}
+
+const MopChannelOps loopbackOps = {
+  loopbackCreate, loopbackDestroy, loopbackBind,  loopbackConnect,
+  loopbackAccept, loopbackRead,    loopbackWrite, loopbackClose
+};
+
+const uint32_t MOP_BENCH_THREADS   = 4;
+const uint32_t MOP_BENCH_PIPELINES = 64;
+const uint32_t MOP_BENCH_MESSAGE   = 1024;
+
+/*! Sends a message over p and reads its echo */
+bool
+echo(const MopPipelinePtr& p, uint8_t seed)
+{
+  uint8_t                   out[MOP_BENCH_MESSAGE];
+  uint8_t                   in[MOP_BENCH_MESSAGE];
+  uint32_t                  len  = 0;
+  MopPipeline::DataPackType sent = { out, sizeof(out) };
+  for (uint32_t i = 0; i < sizeof(out); i++)
+    out[i] = (uint8_t)(seed + i);
+  if (p->sendData(sent, &len) != MOP_PASSED || len != sizeof(out))
+    return false;
+
+  uint32_t got = 0;
+  while (got < sizeof(in))
+  {
+    MopPipeline::DataPackType received = { in + got,
+                                                 (uint32_t)(sizeof(in) - got) };
+    if (p->recvData(received, &len) != MOP_PASSED)
+      return false;
+    got += len;
+  }
+  return std::equal(out, out + sizeof(out), in);
+}
+
+/*! Accepts id on server while the payload connects to it */
+MopErrCode
+acceptRemote(MopServer& server, PipelineID id, PipelineType type,
+             MopPipelinePtr& p)
+{
+  std::thread payload([id] { router.remoteConnect(id); });
+  MopErrCode  ret = server.accept(id, type, p);
+  payload.join();
+  return ret;
+}
+
+/*! A connect the payload keeps refusing, given up by disconnecting */
+bool
+abandonedConnect(MopClient& client, PipelineID id)
+{
+  MopPipelinePtr p;
+  MopErrCode     ret = MOP_UNKNOWN_ERR;
+  std::thread    connector([&] { ret = client.connect(id, RELIABLE, p); });
+  while (client.disconnect(id) != MOP_PASSED)
+    std::this_thread::yield();
+  connector.join();
+  return ret != MOP_PASSED && !p;
+}
+
+/*! An accept nobody connects to, given up by closing */
+bool
+abandonedAccept(MopServer& server, PipelineID id)
+{
+  MopPipelinePtr p;
+  MopErrCode     ret = MOP_UNKNOWN_ERR;
+  std::thread    acceptor([&] { ret = server.accept(id, RELIABLE, p); });
+  while (server.close(id) != MOP_PASSED)
+    std::this_thread::yield();
+  acceptor.join();
+  return ret != MOP_PASSED && !p;
+}
+
+} // namespace
+
+void
+registerMopBenchmarks(BenchmarkRunner& runner)
+{
+  if (!getSimulatedVehicle())
+  {
+    std::cout << "skipping mop: simulated vehicle unavailable\n";
+    return;
+  }
+  /* Starting and stopping the MOP task of the linker takes about a second,
+   * keep it running as an M300 vehicle would */
+  static MopServer* taskHolder = new MopServer();
+  (void)taskHolder;
+
+  /* Every thread has a client and server of its own, all of them share the
+   * registry */
+  runner.add("mop/open_close_512_pipelines_4_threads", 20, []() -> uint32_t {
+    setMopChannelOps(&loopbackOps);
+    size_t                   before = MopPipelineRegistry::instance().size();
+    std::atomic<uint32_t>    failed(0);
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < MOP_BENCH_THREADS; t++)
+    {
+      threads.push_back(std::thread([t, &failed] {
+        MopServer server;
+        MopClient client(SLOT_0);
+        for (uint32_t i = 0; i < MOP_BENCH_PIPELINES; i++)
+        {
+          PipelineID     id   = (PipelineID)(2 * (t * MOP_BENCH_PIPELINES + i));
+          PipelineType   type = (i & 1) ? UNRELIABLE : RELIABLE;
+          MopPipelinePtr accepted;
+          MopPipelinePtr connected;
+          if (acceptRemote(server, id, type, accepted) != MOP_PASSED ||
+              accepted->getType() != type || !echo(accepted, i) ||
+              server.close(id) != MOP_PASSED)
+            failed++;
+          if (client.connect(id + 1, type, connected) != MOP_PASSED ||
+              connected->getType() != type || !echo(connected, i) ||
+              client.disconnect(id + 1) != MOP_PASSED)
+            failed++;
+        }
+        if (!abandonedConnect(client, LOOPBACK_REFUSED_ID_BASE + t) ||
+            !abandonedAccept(server, LOOPBACK_REFUSED_ID_BASE + t))
+          failed++;
+        /* Left open for the destructors to close */
+        MopPipelinePtr p;
+        client.connect(1000 + t, RELIABLE, p);
+        acceptRemote(server, 1100 + t, RELIABLE, p);
+      }));
+    }
+    for (size_t t = 0; t < threads.size(); t++)
+      threads[t].join();
+    setMopChannelOps(NULL);
+
+    if (failed || MopPipelineRegistry::instance().size() != before)
+    {
+      std::cout << "mop: " << failed << " pipelines failed, "
+                << MopPipelineRegistry::instance().size() - before
+                << " left registered\n";
+    }
+    return MOP_BENCH_THREADS * MOP_BENCH_PIPELINES * 2 * MOP_BENCH_MESSAGE;
+  });
+
+  /* Two accepts racing for every id, one of them has to be refused */
+  runner.add("mop/contended_accept_64_ids", 20, []() -> uint32_t {
+    setMopChannelOps(&loopbackOps);
+    size_t    before = MopPipelineRegistry::instance().size();
+    uint32_t  failed = 0;
+    MopServer server;
+    for (uint32_t i = 0; i < MOP_BENCH_PIPELINES; i++)
+    {
+      PipelineID     id     = (PipelineID)(1200 + i);
+      MopPipelinePtr p[2];
+      MopErrCode     ret[2] = { MOP_UNKNOWN_ERR, MOP_UNKNOWN_ERR };
+      std::thread    a([&] { ret[0] = server.accept(id, RELIABLE, p[0]); });
+      std::thread    b([&] { ret[1] = server.accept(id, RELIABLE, p[1]); });
+      router.remoteConnect(id);
+      a.join();
+      b.join();
+      if (!((ret[0] == MOP_PASSED && ret[1] == MOP_RESOCCUPIED) ||
+            (ret[0] == MOP_RESOCCUPIED && ret[1] == MOP_PASSED)))
+        failed++;
+      server.close(id);
+    }
+    setMopChannelOps(NULL);
+
+    if (failed || MopPipelineRegistry::instance().size() != before)
+    {
+      std::cout << "mop: " << failed << " contended ids misbehaved, "
+                << MopPipelineRegistry::instance().size() - before
+                << " left registered\n";
+    }
+    return 0;
+  });
+
+  /* Closing a pipeline another thread is blocked reading from, the reader
+   * keeps using it afterwards */
+  runner.add("mop/close_during_recv_64_pipelines", 20, []() -> uint32_t {
+    setMopChannelOps(&loopbackOps);
+    uint32_t  failed = 0;
+    MopServer server;
+    for (uint32_t i = 0; i < MOP_BENCH_PIPELINES; i++)
+    {
+      PipelineID     id = (PipelineID)(1300 + i);
+      MopPipelinePtr p;
+      if (acceptRemote(server, id, RELIABLE, p) != MOP_PASSED)
+      {
+        failed++;
+        continue;
+      }
+      MopErrCode  ret = MOP_PASSED;
+      std::thread reader([&] {
+        uint8_t                   buf[16];
+        uint32_t                  len = 0;
+        MopPipeline::DataPackType pack = { buf, sizeof(buf) };
+        ret = p->recvData(pack, &len);
+        if (ret != MOP_PASSED && p->sendData(pack, &len) == MOP_PASSED)
+          ret = MOP_PASSED;
+      });
+      if (server.close(id) != MOP_PASSED)
+        failed++;
+      reader.join();
+      if (ret == MOP_PASSED)
+        failed++;
+    }
+    setMopChannelOps(NULL);
+
+    if (failed)
+      std::cout << "mop: " << failed << " closed pipelines kept working\n";
+    return 0;
+  });
+}
@@ -0,0 +1,343 @@
+/*! @file benchmark_perception.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief
+ *  Pairing of stereo perception images fed by a synthetic injector that
+ *  reorders and drops single images.
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "osdk_benchmark.hpp"
+
+#ifdef ADVANCED_SENSING
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "dji_perception_image_queue.hpp"
+#include "dji_stereo_pair_sync.hpp"
+
+using namespace DJI::OSDK;
+
+namespace
+{
+
+const uint32_t STEREO_BATCH_FRAMES = 256;
+const uint32_t STEREO_IMAGE_LEN    = 640 * 480;
+
+/*! One image as the injector sends it */
+typedef struct InjectedImage
+{
+  uint32_t frame;
+  bool     left;
+} InjectedImage;
+
+/*! What the pair callback saw of a batch */
+typedef struct PairCheck
+{
+  uint32_t pairs;
+  uint32_t outOfOrder;
+  uint32_t corrupt;
+  int64_t  lastFrame;
+} PairCheck;
+
+void
+onPair(const Perception::StereoPairType& pair, void* userData)
+{
+  PairCheck* check = (PairCheck*)userData;
+  uint32_t   frame = pair.leftInfo.rawInfo.index;
+  check->pairs++;
+  if ((int64_t)frame <= check->lastFrame)
+    check->outOfOrder++;
+  check->lastFrame = frame;
+  /* Every image carries its frame and side in the first and last pixel */
+  if (pair.rightInfo.rawInfo.index != frame ||
+      pair.leftLen != STEREO_IMAGE_LEN || pair.rightLen != STEREO_IMAGE_LEN ||
+      pair.leftImage[0] != (uint8_t)frame ||
+      pair.leftImage[STEREO_IMAGE_LEN - 1] != 'L' ||
+      pair.rightImage[0] != (uint8_t)frame ||
+      pair.rightImage[STEREO_IMAGE_LEN - 1] != 'R')
+    check->corrupt++;
+}
+
+/*! Images of a batch: every 4th frame has its right image first, every 8th
+ *  is interleaved with the next one and every 16th loses one image. The
+ *  last frames are complete so nothing is left waiting. */
+std::vector<InjectedImage>
+injectionOrder(uint32_t firstFrame, uint32_t* complete, uint32_t* halves)
+{
+  std::vector<InjectedImage> order;
+  *complete = 0;
+  *halves   = 0;
+  for (uint32_t i = 0; i < STEREO_BATCH_FRAMES; i++)
+  {
+    uint32_t frame = firstFrame + i;
+    bool     last  = i + 2 >= STEREO_BATCH_FRAMES;
+    if (i % 16 == 5 && !last)
+    {
+      order.push_back({ frame, (i / 16) % 2 == 0 });
+      (*halves)++;
+    }
+    else if (i % 8 == 2 && !last)
+    {
+      order.push_back({ frame, true });
+      order.push_back({ frame + 1, true });
+      order.push_back({ frame, false });
+      order.push_back({ frame + 1, false });
+      (*complete) += 2;
+      i++;
+    }
+    else
+    {
+      bool rightFirst = i % 4 == 3;
+      order.push_back({ frame, !rightFirst });
+      order.push_back({ frame, rightFirst });
+      (*complete)++;
+    }
+  }
+  return order;
+}
+
+const int      FANOUT_DIRECTIONS = 6;
+const uint32_t SLOW_CONSUMER_MS  = 20;
+
+/*! A subscriber of the fan-out, checking every image it gets */
+typedef struct FanoutConsumer
+{
+  uint32_t              sleepMs;
+  std::atomic<uint32_t> corrupt;
+} FanoutConsumer;
+
+void
+onFanoutImage(Perception::ImageInfoType info, uint8_t* image, int len,
+              void* userData)
+{
+  FanoutConsumer* consumer = (FanoutConsumer*)userData;
+  /* The injector rewrites its buffers every tick, an image not copied on
+   * push would carry a later frame */
+  if (len != (int)STEREO_IMAGE_LEN || image[0] != (uint8_t)info.rawInfo.index ||
+      image[STEREO_IMAGE_LEN - 1] != (uint8_t)info.dataType)
+    consumer->corrupt++;
+  if (consumer->sleepMs)
+    std::this_thread::sleep_for(std::chrono::milliseconds(consumer->sleepMs));
+}
+
+/*! Six directions, a fast subscriber on each and a slow one on the front */
+struct Fanout
+{
+  FanoutConsumer fast[FANOUT_DIRECTIONS];
+  FanoutConsumer slow;
+  std::vector<std::shared_ptr<PerceptionImageQueue> > queues;
+  std::vector<FanoutConsumer*>                        consumers;
+  std::vector<uint8_t>                                images;
+  uint32_t                                            frame;
+  uint64_t                                            pushed[FANOUT_DIRECTIONS];
+
+  explicit Fanout(bool queued)
+    : images(2 * FANOUT_DIRECTIONS * STEREO_IMAGE_LEN)
+    , frame(0)
+  {
+    Perception::ImageQueueConfigType config = { 4,
+                                                Perception::QUEUE_DROP_OLDEST };
+    for (int dir = 0; dir < FANOUT_DIRECTIONS; dir++)
+    {
+      fast[dir].sleepMs = 0;
+      fast[dir].corrupt = 0;
+      pushed[dir]       = 0;
+      consumers.push_back(&fast[dir]);
+    }
+    slow.sleepMs = SLOW_CONSUMER_MS;
+    slow.corrupt = 0;
+    consumers.push_back(&slow);
+    if (!queued)
+      return;
+
+    for (size_t i = 0; i < consumers.size(); i++)
+    {
+      int dir = i < FANOUT_DIRECTIONS ? (int)i : Perception::RECTIFY_FRONT;
+      queues.push_back(std::make_shared<PerceptionImageQueue>(
+        (Perception::DirectionType)dir, onFanoutImage, consumers[i], config));
+    }
+  }
+
+  int direction(size_t consumer) const
+  {
+    return consumer < FANOUT_DIRECTIONS ? (int)consumer
+                                        : Perception::RECTIFY_FRONT;
+  }
+
+  /*! One 20 Hz tick of the link: a left and right image of every direction,
+   *  given to the queues or, without them, to the callbacks themselves */
+  void tick()
+  {
+    Perception::ImageInfoType info;
+    memset(&info, 0, sizeof(info));
+    info.rawInfo.width  = 640;
+    info.rawInfo.height = 480;
+    info.rawInfo.bpp    = 1;
+    info.rawInfo.index  = frame;
+    info.timeStamp      = 1000 + 50ull * frame;
+    for (int dir = 0; dir < FANOUT_DIRECTIONS; dir++)
+    {
+      for (int side = 0; side < 2; side++)
+      {
+        uint8_t* image =
+          images.data() + (2 * dir + side) * (size_t)STEREO_IMAGE_LEN;
+        info.rawInfo.direction      = (Perception::DirectionType)dir;
+        info.dataType               = (Perception::CamPositionType)(2 * dir + side);
+        image[0]                    = (uint8_t)frame;
+        image[STEREO_IMAGE_LEN - 1] = (uint8_t)info.dataType;
+        for (size_t i = 0; i < consumers.size(); i++)
+        {
+          if (direction(i) != dir)
+            continue;
+          if (queues.empty())
+            onFanoutImage(info, image, STEREO_IMAGE_LEN, consumers[i]);
+          else
+            queues[i]->push(info, image, STEREO_IMAGE_LEN);
+        }
+        pushed[dir]++;
+      }
+    }
+    frame++;
+  }
+
+  /*! Every image is delivered, dropped or still queued, one may be in a
+   *  callback */
+  bool check()
+  {
+    bool ok = true;
+    for (size_t i = 0; i < queues.size(); i++)
+    {
+      Perception::ImageQueueStatsType stats;
+      queues[i]->getStats(stats);
+      uint64_t accounted = stats.delivered + stats.dropped + stats.depth;
+      uint64_t expected  = pushed[direction(i)];
+      if (stats.maxDepth > stats.capacity || accounted > expected ||
+          accounted + 1 < expected || consumers[i]->corrupt)
+      {
+        std::cout << "perception: subscriber " << i << " " << stats.delivered
+                  << " delivered, " << stats.dropped << " dropped, "
+                  << stats.depth << " queued of " << expected
+                  << ", max depth " << stats.maxDepth << "/"
+                  << stats.capacity << ", " << consumers[i]->corrupt
+                  << " corrupt\n";
+        ok = false;
+      }
+    }
+    return ok;
+  }
+};
+
+} // namespace
+
+void
+registerPerceptionBenchmarks(BenchmarkRunner& runner)
+{
+  /* Link-side cost of a tick: copies into the queues only, the slow
+   * subscriber sheds its oldest images instead of holding up the link */
+  std::shared_ptr<Fanout> queued(new Fanout(true));
+  runner.add("perception/fanout_6dir_slow_consumer", 2000,
+             [queued]() -> uint32_t {
+               queued->tick();
+               if (queued->frame % 500 == 0)
+               {
+                 Perception::ImageQueueStatsType slow;
+                 queued->queues.back()->getStats(slow);
+                 /* It takes an image in the time of dozens of ticks */
+                 if (queued->check() &&
+                     slow.dropped < queued->pushed[Perception::RECTIFY_FRONT] / 2)
+                   std::cout << "perception: slow subscriber dropped only "
+                             << slow.dropped << "\n";
+               }
+               return 2 * FANOUT_DIRECTIONS * STEREO_IMAGE_LEN;
+             });
+
+  /* The same tick with the callbacks on the link thread, as before */
+  std::shared_ptr<Fanout> inlined(new Fanout(false));
+  runner.add("perception/fanout_6dir_inline_baseline", 20,
+             [inlined]() -> uint32_t {
+               inlined->tick();
+               return 2 * FANOUT_DIRECTIONS * STEREO_IMAGE_LEN;
+             });
+
+  std::shared_ptr<StereoPairSync> sync(new StereoPairSync());
+  std::shared_ptr<std::vector<uint8_t> > images(
+    new std::vector<uint8_t>(2 * STEREO_IMAGE_LEN));
+  std::shared_ptr<uint32_t> nextFrame(new uint32_t(0));
+
+  runner.add(
+    "perception/stereo_pairs_reordered_dropped", 20,
+    [sync, images, nextFrame]() -> uint32_t {
+      PairCheck check = { 0, 0, 0, -1 };
+      sync->setCallback(onPair, &check);
+
+      uint32_t complete = 0;
+      uint32_t halves   = 0;
+      std::vector<InjectedImage> order =
+        injectionOrder(*nextFrame, &complete, &halves);
+      uint8_t*                  left  = images->data();
+      uint8_t*                  right = left + STEREO_IMAGE_LEN;
+      Perception::ImageInfoType info;
+      memset(&info, 0, sizeof(info));
+      info.rawInfo.direction = Perception::RECTIFY_FRONT;
+      info.rawInfo.width     = 640;
+      info.rawInfo.height    = 480;
+      info.rawInfo.bpp       = 1;
+      for (size_t i = 0; i < order.size(); i++)
+      {
+        uint8_t* image = order[i].left ? left : right;
+        image[0]                    = (uint8_t)order[i].frame;
+        image[STEREO_IMAGE_LEN - 1] = order[i].left ? 'L' : 'R';
+        info.rawInfo.index          = order[i].frame;
+        info.timeStamp              = 1000 + 50ull * order[i].frame;
+        info.dataType = order[i].left ? Perception::RECTIFY_FRONT_LEFT
+                                      : Perception::RECTIFY_FRONT_RIGHT;
+        sync->push(info, image, STEREO_IMAGE_LEN);
+      }
+      *nextFrame += STEREO_BATCH_FRAMES;
+
+      Perception::StereoPairStatsType stats;
+      sync->getStats(stats);
+      sync->setCallback(NULL, NULL);
+      if (check.pairs != complete || stats.pairs != complete ||
+          stats.unmatched != halves || check.outOfOrder || check.corrupt)
+      {
+        std::cout << "perception: " << check.pairs << "/" << complete
+                  << " pairs, " << stats.unmatched << "/" << halves
+                  << " unmatched, " << check.outOfOrder << " out of order, "
+                  << check.corrupt << " corrupt\n";
+      }
+      return complete * 2 * STEREO_IMAGE_LEN;
+    });
+}
+#else
+void
+registerPerceptionBenchmarks(BenchmarkRunner& runner)
+{
+  (void)runner;
+}
+#endif
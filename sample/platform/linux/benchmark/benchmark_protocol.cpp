@@ -0,0 +1,235 @@
+/*! @file benchmark_protocol.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief
+ *  Frame pack/parse/unpack, CRC and AES benchmarks on the linker protocol
+ *  ops.
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include "osdk_benchmark.hpp"
+#include "osdk_protocol.h"
+
+/* Exported by libdji-linker.a without a public header */
+extern "C" {
+uint16_t OsdkCrc_ibmCrc16Calc(const uint8_t* pMsg, uint32_t nLen);
+uint32_t OsdkCrc_crc32Calc(const uint8_t* pMsg, uint32_t nLen);
+}
+
+#define BENCH_PAYLOAD_LEN   100
+#define BENCH_FRAME_BUF_LEN (OSDK_PACKAGE_MAX_LEN * 2)
+#define BENCH_PARSE_BUF_LEN (OSDK_PACKAGE_MAX_LEN * 4)
+
+namespace
+{
+
+/* A packed frame plus everything needed to parse/unpack it again */
+typedef struct ProtocolFixture
+{
+  T_ProtocolOps        ops;
+  void*                ext;
+  T_CmdInfo            info;
+  uint8_t              payload[BENCH_PAYLOAD_LEN];
+  uint8_t              frame[BENCH_FRAME_BUF_LEN];
+  uint32_t             frameLen;
+  uint8_t              scratch[BENCH_FRAME_BUF_LEN];
+  uint8_t              unpacked[BENCH_FRAME_BUF_LEN];
+  std::vector<uint8_t> parseBuf;
+  T_CmdParse           parse;
+
+  ProtocolFixture()
+    : ext(NULL)
+    , frameLen(0)
+    , parseBuf(BENCH_PARSE_BUF_LEN)
+  {
+    parse.parseBuff  = &parseBuf[0];
+    parse.parseIndex = 0;
+  }
+
+  ~ProtocolFixture()
+  {
+    if (ext)
+    {
+      ops.Deinit(ext);
+    }
+  }
+} ProtocolFixture;
+
+std::shared_ptr<ProtocolFixture>
+makeFixture(E_ProtocolType type, uint8_t encType)
+{
+  std::shared_ptr<ProtocolFixture> f(new ProtocolFixture);
+  if (OsdkProtocol_getProtocolOps(type, &f->ops) != OSDK_STAT_OK ||
+      f->ops.Init(&f->ext) != OSDK_STAT_OK)
+  {
+    return std::shared_ptr<ProtocolFixture>();
+  }
+
+  for (int i = 0; i < BENCH_PAYLOAD_LEN; i++)
+  {
+    f->payload[i] = (uint8_t)(i * 7 + 3);
+  }
+
+  memset(&f->info, 0, sizeof(f->info));
+  f->info.packetType = OSDK_COMMAND_PACKET_TYPE_REQUEST;
+  f->info.needAck    = OSDK_COMMAND_NEED_ACK_FINISH_ACK;
+  f->info.encType    = encType;
+  f->info.sender     = 0xCA;
+  f->info.receiver   = 0x03;
+  f->info.cmdSet     = 0x01;
+  f->info.cmdId      = 0x02;
+  f->info.seqNum     = 1;
+  f->info.dataLen    = BENCH_PAYLOAD_LEN;
+  f->info.protoType  = type;
+
+  if (f->ops.Pack(f->ext, f->frame, &f->frameLen, &f->info, f->payload) !=
+      OSDK_STAT_OK)
+  {
+    return std::shared_ptr<ProtocolFixture>();
+  }
+  return f;
+}
+
+void
+addProtocol(BenchmarkRunner& runner, const std::string& prefix,
+            E_ProtocolType type, uint8_t encType)
+{
+  std::shared_ptr<ProtocolFixture> f = makeFixture(type, encType);
+  if (!f)
+  {
+    std::cout << "skipping " << prefix << ": protocol init failed\n";
+    return;
+  }
+
+  /* Requests needing an ACK would hold a session each and run out of them,
+   * so the pack loop sends fire-and-forget frames. */
+  runner.add(prefix + "/pack_100B", 200000, [f]() -> uint32_t {
+    T_CmdInfo info = f->info;
+    uint32_t  len  = 0;
+    info.needAck   = OSDK_COMMAND_NEED_ACK_NO_NEED;
+    info.seqNum    = ++f->info.seqNum;
+    f->ops.Pack(f->ext, f->scratch, &len, &info, f->payload);
+    return len;
+  });
+
+  runner.add(prefix + "/parse_100B", 200000, [f]() -> uint32_t {
+    uint8_t* frame = NULL;
+    uint32_t len   = 0;
+    for (uint32_t i = 0; i < f->frameLen; i++)
+    {
+      f->ops.Parse(&f->parse, f->frame[i], &frame, &len);
+    }
+    return f->frameLen;
+  });
+
+  /* Unpack may decrypt in place, so every call starts from a fresh copy */
+  runner.add(prefix + "/unpack_100B", 200000, [f]() -> uint32_t {
+    T_CmdInfo info;
+    memcpy(f->scratch, f->frame, f->frameLen);
+    f->ops.Unpack(f->ext, f->scratch, &info, f->unpacked);
+    return f->frameLen;
+  });
+}
+
+} // namespace
+
+void
+registerProtocolBenchmarks(BenchmarkRunner& runner,
+                           const std::string& capturePath)
+{
+  addProtocol(runner, "sdk", PROTOCOL_SDK, OSDK_COMMAND_ENCRYPT_NO_ENC);
+  addProtocol(runner, "v1", PROTOCOL_V1, OSDK_COMMAND_ENCRYPT_NO_ENC);
+
+  /* AES256 on the SDK protocol, as used once an app key is set */
+  T_ProtocolOps sdkOps;
+  if (OsdkProtocol_getProtocolOps(PROTOCOL_SDK, &sdkOps) == OSDK_STAT_OK)
+  {
+    sdkOps.SetKey(
+      "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef");
+    addProtocol(runner, "sdk_aes", PROTOCOL_SDK, OSDK_COMMAND_ENCRYPT_AES128);
+  }
+
+  std::shared_ptr<std::vector<uint8_t> > crcData(
+    new std::vector<uint8_t>(OSDK_PACKAGE_MAX_LEN));
+  for (size_t i = 0; i < crcData->size(); i++)
+  {
+    (*crcData)[i] = (uint8_t)(i * 13 + 1);
+  }
+  runner.add("crc/crc16_header", 1000000, [crcData]() -> uint32_t {
+    volatile uint16_t crc = OsdkCrc_ibmCrc16Calc(&(*crcData)[0], 10);
+    (void)crc;
+    return 10;
+  });
+  runner.add("crc/crc32_1KB", 200000, [crcData]() -> uint32_t {
+    volatile uint32_t crc =
+      OsdkCrc_crc32Calc(&(*crcData)[0], (uint32_t)crcData->size());
+    (void)crc;
+    return (uint32_t)crcData->size();
+  });
+
+  if (capturePath.empty())
+  {
+    return;
+  }
+
+  /* Recorded UART stream, fed through both parsers like the linker does */
+  std::ifstream file(capturePath.c_str(), std::ios::binary);
+  std::shared_ptr<std::vector<uint8_t> > capture(new std::vector<uint8_t>(
+    (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>()));
+  std::shared_ptr<ProtocolFixture> sdk =
+    makeFixture(PROTOCOL_SDK, OSDK_COMMAND_ENCRYPT_NO_ENC);
+  std::shared_ptr<ProtocolFixture> v1 =
+    makeFixture(PROTOCOL_V1, OSDK_COMMAND_ENCRYPT_NO_ENC);
+  if (capture->empty() || !sdk || !v1)
+  {
+    std::cout << "skipping capture replay: cannot read " << capturePath
+              << "\n";
+    return;
+  }
+
+  runner.add("capture/parse_unpack", 100, [capture, sdk, v1]() -> uint32_t {
+    uint8_t*  frame = NULL;
+    uint32_t  len   = 0;
+    T_CmdInfo info;
+    for (size_t i = 0; i < capture->size(); i++)
+    {
+      if (sdk->ops.Parse(&sdk->parse, (*capture)[i], &frame, &len) ==
+          OSDK_STAT_OK)
+      {
+        sdk->ops.Unpack(sdk->ext, frame, &info, sdk->unpacked);
+      }
+      if (v1->ops.Parse(&v1->parse, (*capture)[i], &frame, &len) ==
+          OSDK_STAT_OK)
+      {
+        v1->ops.Unpack(v1->ext, frame, &info, v1->unpacked);
+      }
+    }
+    return (uint32_t)capture->size();
+  });
+}
@@ -0,0 +1,400 @@
+/*! @file benchmark_recorder.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief
+ *  Recording of a synthetic LiveView H.264 stream and VGA stereo images:
+ *  cost on the receiving thread, sustained compress and write throughput,
+ *  and drops with a buffer too small for the burst.
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "osdk_benchmark.hpp"
+
+#ifdef ADVANCED_SENSING
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "dji_stream_recorder.hpp"
+
+using namespace DJI::OSDK;
+
+namespace
+{
+
+const uint32_t RECORD_IMAGE_WIDTH  = 640;
+const uint32_t RECORD_IMAGE_HEIGHT = 480;
+const uint32_t RECORD_IMAGE_LEN    = RECORD_IMAGE_WIDTH * RECORD_IMAGE_HEIGHT;
+const uint32_t RECORD_IMAGES       = 8;
+/* One second of the streams: a 30 fps 8 Mbit/s video with a key frame a
+ * second and the front stereo pair at 20 Hz */
+const uint32_t RECORD_PACKETS      = 30;
+const uint32_t RECORD_PACKET_LEN   = 28 * 1024;
+const uint32_t RECORD_KEY_LEN      = 160 * 1024;
+const uint32_t RECORD_PAIRS        = 20;
+
+const char* RECORD_PATH = "/tmp/osdk-benchmark-record";
+
+/*! What a stereo camera sees: lit surfaces with some texture and sensor
+ *  noise. H.264 payloads are incompressible and free of start codes, as
+ *  emulation prevention leaves them. */
+struct RecordSource
+{
+  std::vector<uint8_t> images[RECORD_IMAGES];
+  std::vector<uint8_t> packets[RECORD_PACKETS];
+
+  RecordSource()
+  {
+    uint32_t seed = 777;
+    for (uint32_t f = 0; f < RECORD_IMAGES; f++)
+    {
+      images[f].resize(RECORD_IMAGE_LEN);
+      for (uint32_t v = 0; v < RECORD_IMAGE_HEIGHT; v++)
+      {
+        for (uint32_t u = 0; u < RECORD_IMAGE_WIDTH; u++)
+        {
+          seed      = seed * 1103515245 + 12345;
+          int  base = v < 200 ? 180 + v / 10 : 60 + (v - 200) / 4;
+          bool box  = u > 200 + 8 * f && u < 340 + 8 * f && v > 160 && v < 320;
+          int  tex  = box ? ((u / 6 + v / 6) % 2) * 30 + 40 : base;
+          int  px   = tex + (int)((seed >> 16) % 5) - 2;
+          images[f][v * RECORD_IMAGE_WIDTH + u] = (uint8_t)(px < 0 ? 0 : px);
+        }
+      }
+    }
+
+    for (uint32_t p = 0; p < RECORD_PACKETS; p++)
+    {
+      bool                 key = p == 0;
+      std::vector<uint8_t>& packet = packets[p];
+      packet.resize(key ? RECORD_KEY_LEN : RECORD_PACKET_LEN);
+      for (size_t i = 0; i < packet.size(); i++)
+      {
+        seed      = seed * 1103515245 + 12345;
+        packet[i] = (uint8_t)(1 + (seed >> 16) % 255);
+      }
+      /* SPS, PPS and an IDR slice, or a P slice */
+      const uint8_t sps[] = { 0, 0, 0, 1, 0x67 };
+      const uint8_t pps[] = { 0, 0, 0, 1, 0x68 };
+      const uint8_t idr[] = { 0, 0, 0, 1, 0x65 };
+      const uint8_t p1[]  = { 0, 0, 0, 1, 0x41 };
+      if (key)
+      {
+        memcpy(&packet[0], sps, sizeof(sps));
+        memcpy(&packet[32], pps, sizeof(pps));
+        memcpy(&packet[48], idr, sizeof(idr));
+      }
+      else
+      {
+        memcpy(&packet[0], p1, sizeof(p1));
+      }
+    }
+  }
+
+  Perception::ImageInfoType info(uint32_t frame, bool left) const
+  {
+    Perception::ImageInfoType info;
+    memset(&info, 0, sizeof(info));
+    info.rawInfo.index     = frame;
+    info.rawInfo.direction = Perception::RECTIFY_FRONT;
+    info.rawInfo.bpp       = 1;
+    info.rawInfo.width     = RECORD_IMAGE_WIDTH;
+    info.rawInfo.height    = RECORD_IMAGE_HEIGHT;
+    info.dataType  = left ? Perception::RECTIFY_FRONT_LEFT
+                          : Perception::RECTIFY_FRONT_RIGHT;
+    info.timeStamp = 1000 + 50ull * frame;
+    return info;
+  }
+
+  const std::vector<uint8_t>& image(uint32_t frame, bool left) const
+  {
+    return images[(2 * frame + (left ? 0 : 1)) % RECORD_IMAGES];
+  }
+};
+
+typedef struct BurstResult
+{
+  uint64_t rawBytes;
+  uint64_t maxCallNs;
+} BurstResult;
+
+/*! A second of both streams in the order they come, as fast as possible */
+BurstResult
+recordSecond(StreamRecorder& recorder, const RecordSource& source)
+{
+  BurstResult result = { 0, 0 };
+  for (uint32_t i = 0; i < RECORD_PACKETS + RECORD_PAIRS; i++)
+  {
+    std::chrono::steady_clock::time_point begin =
+      std::chrono::steady_clock::now();
+    if (i % 5 < 3)
+    {
+      const std::vector<uint8_t>& packet =
+        source.packets[(i / 5 * 3 + i % 5) % RECORD_PACKETS];
+      recorder.recordH264(packet.data(), (uint32_t)packet.size());
+      result.rawBytes += packet.size();
+    }
+    else
+    {
+      uint32_t frame = i / 5 * 2 + i % 5 - 3;
+      for (int side = 0; side < 2; side++)
+      {
+        recorder.recordImage(source.info(frame, side == 0),
+                             source.image(frame, side == 0).data(),
+                             RECORD_IMAGE_LEN);
+      }
+      result.rawBytes += 2 * RECORD_IMAGE_LEN;
+    }
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - begin)
+                    .count();
+    if (ns > result.maxCallNs)
+      result.maxCallNs = ns;
+  }
+  return result;
+}
+
+/*! Reads the recording back: every frame decodes to its source image,
+ *  the key frame is flagged and seeking finds it */
+bool
+checkRecording(const RecordSource& source)
+{
+  std::vector<StreamRecorder::IndexRecordType> records;
+  if (!StreamRecorder::readIndex(RECORD_PATH, records) ||
+      records.size() != RECORD_PACKETS + 2 * RECORD_PAIRS)
+  {
+    std::cout << "record: index has " << records.size() << " records\n";
+    return false;
+  }
+
+  FILE* frames = fopen((std::string(RECORD_PATH) + ".frames").c_str(), "rb");
+  if (!frames)
+    return false;
+  std::vector<uint8_t> payload;
+  std::vector<uint8_t> image(RECORD_IMAGE_LEN);
+  uint32_t             bad  = 0;
+  uint32_t             keys = 0;
+  for (size_t i = 0; i < records.size(); i++)
+  {
+    const StreamRecorder::IndexRecordType& record = records[i];
+    if (record.stream == StreamRecorder::STREAM_H264)
+    {
+      bool key = (record.flags & StreamRecorder::INDEX_FLAG_KEYFRAME) != 0;
+      keys += key;
+      if (key != (record.sequence == 0))
+        bad++;
+      continue;
+    }
+
+    StreamRecorder::FrameHeaderType header;
+    fseek(frames, (long)record.offset, SEEK_SET);
+    if (fread(&header, sizeof(header), 1, frames) != 1)
+    {
+      bad++;
+      continue;
+    }
+    payload.resize(header.payloadLen);
+    bool left = header.dataType == Perception::RECTIFY_FRONT_LEFT;
+    if (fread(payload.data(), 1, payload.size(), frames) != payload.size() ||
+        !StreamRecorder::decodeFrame(header, payload.data(), image.data()) ||
+        image != source.image(header.index, left))
+      bad++;
+  }
+  fclose(frames);
+
+  size_t seek = StreamRecorder::seekIndex(records, records[0].timeUs,
+                                          StreamRecorder::STREAM_H264);
+  if (bad || keys != 1 || seek >= records.size() || records[seek].sequence)
+  {
+    std::cout << "record: " << bad << " bad records, " << keys
+              << " key frames\n";
+    return false;
+  }
+  return true;
+}
+
+void
+removeRecording()
+{
+  remove((std::string(RECORD_PATH) + ".h264").c_str());
+  remove((std::string(RECORD_PATH) + ".frames").c_str());
+  remove((std::string(RECORD_PATH) + ".index").c_str());
+}
+
+/*! Callbacks into a ring large enough for all of them, so every call
+ *  copies and none drops while the writing task drains behind. The last
+ *  one closes the recorder and reports drops, should a longer run
+ *  overflow it. */
+struct CallbackFixture
+{
+  static const uint32_t RING_SIZE = 64 * 1024 * 1024;
+
+  std::unique_ptr<StreamRecorder> recorder;
+  std::string                     name;
+  uint32_t                        calls;
+  uint32_t                        next;
+
+  CallbackFixture(const std::string& name, uint32_t calls)
+    : name(name)
+    , calls(calls)
+    , next(0)
+  {
+  }
+
+  ~CallbackFixture()
+  {
+    if (recorder)
+    {
+      recorder->close();
+      removeRecording();
+    }
+  }
+
+  StreamRecorder* open()
+  {
+    if (!recorder)
+    {
+      recorder.reset(new StreamRecorder(RING_SIZE));
+      if (!recorder->open(RECORD_PATH))
+        std::cout << "record: cannot open " << RECORD_PATH << "\n";
+    }
+    return recorder.get();
+  }
+
+  void closeAfterLast()
+  {
+    if (++next % calls)
+      return;
+    StreamRecorder::StatsType stats;
+    recorder->close();
+    recorder->getStats(stats);
+    if (stats.droppedFrames || stats.droppedPackets)
+      std::cout << "record: " << name << " dropped "
+                << stats.droppedFrames + stats.droppedPackets << " of "
+                << calls << "\n";
+    recorder.reset();
+    removeRecording();
+  }
+};
+
+} // namespace
+
+void
+registerRecorderBenchmarks(BenchmarkRunner& runner)
+{
+  std::shared_ptr<RecordSource> source(new RecordSource());
+
+  /* What a receive callback pays to hand its data over */
+  std::shared_ptr<CallbackFixture> packets(
+    new CallbackFixture("callback_h264_packet", 1000));
+  runner.add("record/callback_h264_packet", 1000,
+             [source, packets]() -> uint32_t {
+               const std::vector<uint8_t>& packet =
+                 source->packets[packets->next % RECORD_PACKETS];
+               packets->open()->recordH264(packet.data(),
+                                           (uint32_t)packet.size());
+               packets->closeAfterLast();
+               return (uint32_t)packet.size();
+             });
+
+  std::shared_ptr<CallbackFixture> images(
+    new CallbackFixture("callback_vga_image", 200));
+  runner.add("record/callback_vga_image", 200, [source, images]() -> uint32_t {
+    uint32_t frame = images->next;
+    images->open()->recordImage(source->info(frame, true),
+                                source->image(frame, true).data(),
+                                RECORD_IMAGE_LEN);
+    images->closeAfterLast();
+    return RECORD_IMAGE_LEN;
+  });
+
+  /* A second of both streams recorded and written out, compression
+   * included; the first one is read back */
+  std::shared_ptr<bool> checked(new bool(false));
+  runner.add("record/sustained_1s_stereo_h264", 5,
+             [source, checked]() -> uint32_t {
+               StreamRecorder recorder(64 * 1024 * 1024);
+               if (!recorder.open(RECORD_PATH))
+               {
+                 std::cout << "record: cannot open " << RECORD_PATH << "\n";
+                 return 0;
+               }
+               BurstResult burst = recordSecond(recorder, *source);
+               recorder.close();
+
+               StreamRecorder::StatsType stats;
+               recorder.getStats(stats);
+               if (stats.droppedFrames || stats.droppedPackets ||
+                   stats.writeErrors)
+                 std::cout << "record: " << stats.droppedFrames << " frames, "
+                           << stats.droppedPackets << " packets dropped, "
+                           << stats.writeErrors << " write errors\n";
+               if (!*checked)
+               {
+                 *checked = true;
+                 if (checkRecording(*source))
+                   printf("record: frames compressed to %.1f%%, lossless\n",
+                          100.0 * stats.frameFileBytes / stats.frameRawBytes);
+               }
+               removeRecording();
+               return (uint32_t)burst.rawBytes;
+             });
+
+  /* The same second into a buffer smaller than it, as when the disk
+   * stalls: images are dropped and the callbacks still return at once */
+  std::shared_ptr<bool> reported(new bool(false));
+  runner.add("record/disk_pressure_2MB_buffer", 5,
+             [source, reported]() -> uint32_t {
+               StreamRecorder recorder(2 * 1024 * 1024);
+               if (!recorder.open(RECORD_PATH))
+                 return 0;
+               BurstResult burst = recordSecond(recorder, *source);
+               recorder.close();
+
+               StreamRecorder::StatsType stats;
+               recorder.getStats(stats);
+               if (stats.droppedFrames == 0)
+                 std::cout << "record: nothing dropped from a 2MB buffer\n";
+               if (!*reported)
+               {
+                 *reported = true;
+                 printf("record: %llu of %u images and %llu of %u packets "
+                        "dropped, slowest callback %.1f us\n",
+                        (unsigned long long)stats.droppedFrames,
+                        2 * RECORD_PAIRS,
+                        (unsigned long long)stats.droppedPackets,
+                        RECORD_PACKETS, burst.maxCallNs / 1000.0);
+               }
+               removeRecording();
+               return (uint32_t)burst.rawBytes;
+             });
+}
+#else
+void
+registerRecorderBenchmarks(BenchmarkRunner& runner)
+{
+}
+#endif
@@ -0,0 +1,435 @@
+/*! @file benchmark_stereo.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief
+ *  Point cloud unprojection of the stereo depth perception sample against
+ *  the per-pixel loop it replaced, on a set of synthetic disparity maps,
+ *  and its stages pipelined across frames against running them in series.
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "osdk_benchmark.hpp"
+#include <math.h>
+#include <stdio.h>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "frame_pipeline.hpp"
+#include "point_cloud_generator.hpp"
+
+using namespace M210_STEREO;
+
+namespace
+{
+
+const int    STEREO_WIDTH  = 640;
+const int    STEREO_HEIGHT = 480;
+const int    STEREO_FRAMES = 8;
+/* num_disp of the sample, also the border left out */
+const int    STEREO_BORDER = 64;
+/* Front stereo camera of m300_front_stereo_param.yaml, rounded */
+const double PRINCIPAL_X   = 320.2;
+const double PRINCIPAL_Y   = 238.7;
+const double FOCAL         = 436.5;
+const double BASELINE_X_FX = 52.4;
+
+/*! Disparity maps in 1/16 pixel as StereoBM gives them and the rectified
+ *  left images: a ground plane, boxes moving closer, holes StereoBM leaves
+ *  as -16 and a sky too far away */
+struct StereoSet
+{
+  std::vector<int16_t> disparity[STEREO_FRAMES];
+  std::vector<uint8_t> intensity[STEREO_FRAMES];
+
+  StereoSet()
+  {
+    uint32_t seed = 12345;
+    for (int f = 0; f < STEREO_FRAMES; f++)
+    {
+      disparity[f].resize(STEREO_WIDTH * STEREO_HEIGHT);
+      intensity[f].resize(STEREO_WIDTH * STEREO_HEIGHT);
+      for (int v = 0; v < STEREO_HEIGHT; v++)
+      {
+        for (int u = 0; u < STEREO_WIDTH; u++)
+        {
+          seed         = seed * 1103515245 + 12345;
+          int  ground  = v > 200 ? (v - 200) * 16 / 3 : 0;
+          bool box     = u > 200 + 10 * f && u < 330 + 10 * f && v > 150 &&
+                     v < 300;
+          int  d       = box ? 24 * 16 + f * 16 : ground;
+          d           += (int)((seed >> 16) % 16) - 8;
+          if ((seed >> 8) % 50 == 0)
+            d = -16;
+          disparity[f][v * STEREO_WIDTH + u] = (int16_t)d;
+          intensity[f][v * STEREO_WIDTH + u] = (uint8_t)(u * 3 + v * 7 + f);
+        }
+      }
+    }
+  }
+};
+
+/*! The loop StereoFrame::unprojectPtCloud ran before, without OpenCV */
+void
+unprojectReference(const int16_t* disparity, const uint8_t* intensity,
+                   std::vector<PointXYZI>& points)
+{
+  const int trunc_img_width_end  = STEREO_WIDTH - STEREO_BORDER;
+  const int trunc_img_height_end = STEREO_HEIGHT - STEREO_BORDER;
+
+  points.assign(STEREO_WIDTH * STEREO_HEIGHT, PointXYZI());
+  for (int v = STEREO_BORDER; v < trunc_img_height_end; ++v)
+  {
+    for (int u = STEREO_BORDER; u < trunc_img_width_end; ++u)
+    {
+      PointXYZI& point = points[v * STEREO_WIDTH + u];
+      float disparity_px =
+        (float)(disparity[v * STEREO_WIDTH + u] * 0.0625);
+      if (disparity_px >= 6)
+      {
+        point.z = BASELINE_X_FX / disparity_px;
+        point.x = (u - PRINCIPAL_X) * point.z / FOCAL;
+        point.y = (v - PRINCIPAL_Y) * point.z / FOCAL;
+      }
+      point.intensity = intensity[v * STEREO_WIDTH + u];
+    }
+  }
+}
+
+/*! Same points up to float rounding, same intensities and the same points
+ *  left at 0 */
+bool
+sameCloud(const std::vector<PointXYZI>& expected,
+          const std::vector<PointXYZI>& actual)
+{
+  uint32_t mismatches = 0;
+  for (size_t i = 0; i < expected.size(); i++)
+  {
+    const PointXYZI& e = expected[i];
+    const PointXYZI& a = actual[i];
+    float tolerance    = 1e-5f * (fabsf(e.z) + 1e-3f);
+    if (fabsf(e.x - a.x) > tolerance || fabsf(e.y - a.y) > tolerance ||
+        fabsf(e.z - a.z) > tolerance || e.intensity != a.intensity ||
+        ((e.z == 0) != (a.z == 0)))
+    {
+      if (mismatches++ < 3)
+        std::cout << "stereo: point " << i % STEREO_WIDTH << ","
+                  << i / STEREO_WIDTH << " is " << a.x << " " << a.y << " "
+                  << a.z << " " << a.intensity << ", expected " << e.x << " "
+                  << e.y << " " << e.z << " " << e.intensity << "\n";
+    }
+  }
+  return mismatches == 0;
+}
+
+PointCloudGenerator::CameraModel
+stereoCameraModel()
+{
+  PointCloudGenerator::CameraModel model;
+  model.principal_x   = PRINCIPAL_X;
+  model.principal_y   = PRINCIPAL_Y;
+  model.fx            = FOCAL;
+  model.fy            = FOCAL;
+  model.baseline_x_fx = BASELINE_X_FX;
+  return model;
+}
+
+void
+addUnprojectBenchmark(BenchmarkRunner&                  runner,
+                      const std::shared_ptr<StereoSet>& set, int threads)
+{
+  std::shared_ptr<PointCloudGenerator> generator(new PointCloudGenerator(
+    STEREO_WIDTH, STEREO_HEIGHT, STEREO_BORDER, threads));
+  generator->setCameraModel(stereoCameraModel());
+
+  /* Every frame is checked once against the reference */
+  std::shared_ptr<std::vector<PointXYZI> > expected(
+    new std::vector<PointXYZI>());
+  std::shared_ptr<int> frame(new int(0));
+
+  runner.add(
+    "stereo/unproject_" + std::to_string(threads) + "threads", 200,
+    [set, generator, expected, frame, threads]() -> uint32_t {
+      int f = *frame % STEREO_FRAMES;
+      generator->unproject(set->disparity[f].data(), STEREO_WIDTH,
+                           set->intensity[f].data(), STEREO_WIDTH);
+      if (*frame < STEREO_FRAMES)
+      {
+        unprojectReference(set->disparity[f].data(), set->intensity[f].data(),
+                           *expected);
+        if (!sameCloud(*expected, generator->getPoints()))
+          std::cout << "stereo: frame " << f << " with " << threads
+                    << " threads differs from the reference\n";
+      }
+      (*frame)++;
+      return STEREO_WIDTH * STEREO_HEIGHT * sizeof(int16_t);
+    });
+}
+
+/* A recorded sequence at the rate of the sample's subscription doubled, so
+ * the stages together take longer than the gap between two frames but each
+ * of them alone does not. Every stage but unprojection is a sleep of about
+ * what it takes on a TX2 core, so the stages only compete for the cores
+ * where they would. */
+const int SEQUENCE_FRAMES   = 24;
+const int FRAME_INTERVAL_MS = 25;
+
+struct ModelledStage
+{
+  const char* name;
+  int         ms;
+};
+
+const ModelledStage MODELLED_STAGES[] = {
+  { "rectify", 4 }, { "disparity", 18 }, { "filter", 12 }, { "display", 6 }
+};
+
+struct SequenceFrame
+{
+  typedef std::chrono::steady_clock Clock;
+
+  int                 index;
+  Clock::time_point   arrived;
+  PointCloudGenerator generator;
+
+  explicit SequenceFrame(const PointCloudGenerator::CameraModel& model)
+    : index(0)
+    , generator(STEREO_WIDTH, STEREO_HEIGHT, STEREO_BORDER, 1)
+  {
+    generator.setCameraModel(model);
+  }
+};
+
+struct SequenceResult
+{
+  int    shown;
+  double mean_latency_ms;
+  double max_latency_ms;
+};
+
+void
+modelledStage(int index)
+{
+  std::this_thread::sleep_for(
+    std::chrono::milliseconds(MODELLED_STAGES[index].ms));
+}
+
+void
+unprojectStage(const StereoSet& set, SequenceFrame& frame)
+{
+  int f = frame.index % STEREO_FRAMES;
+  frame.generator.unproject(set.disparity[f].data(), STEREO_WIDTH,
+                            set.intensity[f].data(), STEREO_WIDTH);
+}
+
+/*! Hands the frames of the sequence to submit at the camera's rate */
+template <typename Submit>
+void
+playSequence(Submit submit)
+{
+  SequenceFrame::Clock::time_point next = SequenceFrame::Clock::now();
+  for (int i = 0; i < SEQUENCE_FRAMES; i++)
+  {
+    std::this_thread::sleep_until(next);
+    submit(i);
+    next += std::chrono::milliseconds(FRAME_INTERVAL_MS);
+  }
+}
+
+/*! What the sample did: the reading thread leaves the newest images in one
+ *  slot and a single processing thread runs every stage on them */
+SequenceResult
+runSerial(const StereoSet& set)
+{
+  SequenceFrame           frame(stereoCameraModel());
+  std::mutex              mutex;
+  std::condition_variable cv;
+  int                     latest = -1;
+  SequenceFrame::Clock::time_point latest_arrived;
+  bool                    busy = false;
+  bool                    quit = false;
+
+  SequenceResult result = { 0, 0, 0 };
+  std::thread processing([&]() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+      cv.wait(lock, [&]() { return quit || latest >= 0; });
+      if (latest < 0)
+        return;
+      frame.index   = latest;
+      frame.arrived = latest_arrived;
+      latest        = -1;
+      busy          = true;
+      lock.unlock();
+
+      modelledStage(0);
+      modelledStage(1);
+      modelledStage(2);
+      unprojectStage(set, frame);
+      modelledStage(3);
+      double ms = std::chrono::duration<double, std::milli>(
+                    SequenceFrame::Clock::now() - frame.arrived)
+                    .count();
+
+      lock.lock();
+      busy = false;
+      result.shown++;
+      result.mean_latency_ms += ms;
+      result.max_latency_ms = std::max(result.max_latency_ms, ms);
+      cv.notify_all();
+    }
+  });
+
+  playSequence([&](int i) {
+    std::lock_guard<std::mutex> lock(mutex);
+    latest         = i;
+    latest_arrived = SequenceFrame::Clock::now();
+    cv.notify_all();
+  });
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&]() { return !busy && latest < 0; });
+    quit = true;
+    cv.notify_all();
+  }
+  processing.join();
+
+  if (result.shown)
+    result.mean_latency_ms /= result.shown;
+  return result;
+}
+
+typedef FramePipeline<SequenceFrame> SequencePipeline;
+
+SequenceResult
+runPipelined(const StereoSet& set, SequencePipeline::Policy policy,
+             bool print_stages)
+{
+  std::vector<SequencePipeline::FramePtr> frames;
+  for (int i = 0; i < 6; i++)
+    frames.push_back(std::make_shared<SequenceFrame>(stereoCameraModel()));
+
+  SequencePipeline pipeline(frames, policy);
+  pipeline.addStage("rectify", [](SequenceFrame&) { modelledStage(0); });
+  pipeline.addStage("disparity", [](SequenceFrame&) { modelledStage(1); });
+  pipeline.addStage("filter", [](SequenceFrame&) { modelledStage(2); });
+  pipeline.addStage("unproject",
+                    [&set](SequenceFrame& frame) { unprojectStage(set, frame); });
+  pipeline.addStage("display", [](SequenceFrame&) { modelledStage(3); });
+  pipeline.start();
+
+  playSequence([&](int i) {
+    SequenceFrame* frame = pipeline.acquire();
+    if (!frame)
+      return;
+    frame->index = i;
+    pipeline.submit(frame);
+  });
+
+  /* Every submitted frame ends up shown or dropped */
+  SequencePipeline::Stats stats;
+  while (true)
+  {
+    stats            = pipeline.getStats();
+    uint64_t dropped = 0;
+    for (size_t i = 0; i < stats.stages.size(); i++)
+      dropped += stats.stages[i].dropped;
+    if (stats.completed + dropped >= stats.submitted)
+      break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  pipeline.stop();
+
+  if (print_stages)
+  {
+    for (size_t i = 0; i < stats.stages.size(); i++)
+      printf("stereo:   %-9s %6.2f ms mean %6.2f ms max, %llu dropped before\n",
+             stats.stages[i].name.c_str(), stats.stages[i].mean_ms,
+             stats.stages[i].max_ms,
+             (unsigned long long)stats.stages[i].dropped);
+  }
+
+  SequenceResult result = { (int)stats.completed, stats.mean_latency_ms,
+                            stats.max_latency_ms };
+  return result;
+}
+
+/*! One operation plays the whole sequence, the bytes are the image pairs
+ *  shown. The first one also prints how many and how late. */
+void
+addSequenceBenchmark(BenchmarkRunner&                  runner,
+                     const std::shared_ptr<StereoSet>& set,
+                     const std::string& name, int mode)
+{
+  std::shared_ptr<bool> printed(new bool(false));
+  runner.add("stereo/sequence_" + name, 5, [set, name, mode, printed]() -> uint32_t {
+    bool           print = !*printed;
+    SequenceResult result =
+      mode < 0 ? runSerial(*set)
+               : runPipelined(*set, (SequencePipeline::Policy)mode, print);
+    if (print)
+    {
+      printf("stereo: %s shows %d of %d frames, %.1f ms mean latency, "
+             "%.1f ms max\n",
+             name.c_str(), result.shown, SEQUENCE_FRAMES,
+             result.mean_latency_ms, result.max_latency_ms);
+      *printed = true;
+    }
+    if (result.shown == 0)
+      std::cout << "stereo: " << name << " showed no frame\n";
+    return result.shown * STEREO_WIDTH * STEREO_HEIGHT * 2;
+  });
+}
+
+} // namespace
+
+void
+registerStereoBenchmarks(BenchmarkRunner& runner)
+{
+  std::shared_ptr<StereoSet> set(new StereoSet());
+
+  std::shared_ptr<std::vector<PointXYZI> > points(
+    new std::vector<PointXYZI>());
+  std::shared_ptr<int> frame(new int(0));
+  runner.add("stereo/unproject_reference", 200, [set, points, frame]() -> uint32_t {
+    int f = (*frame)++ % STEREO_FRAMES;
+    unprojectReference(set->disparity[f].data(), set->intensity[f].data(),
+                       *points);
+    return STEREO_WIDTH * STEREO_HEIGHT * sizeof(int16_t);
+  });
+
+  addUnprojectBenchmark(runner, set, 1);
+  addUnprojectBenchmark(runner, set, 4);
+
+  addSequenceBenchmark(runner, set, "serial", -1);
+  addSequenceBenchmark(runner, set, "pipelined_latest",
+                       SequencePipeline::LATEST_FRAME_WINS);
+  addSequenceBenchmark(runner, set, "pipelined_keep_all",
+                       SequencePipeline::KEEP_ALL_FRAMES);
+}
@@ -0,0 +1,364 @@
+/*! @file benchmark_stream_replay.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief
+ *  Replay of recorded H.264 through DJICameraStreamFileSource, directly and
+ *  into LiveView: finding the access units of an elementary stream, replay
+ *  as fast as possible and at recorded timing. Every delivered packet is
+ *  checked against the one written.
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "osdk_benchmark.hpp"
+
+#ifdef ADVANCED_SENSING
+#include <stdio.h>
+#include <unistd.h>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "dji_camera_stream_file_source.hpp"
+#include "dji_sim_h264_stream.hpp"
+#include "dji_stream_recorder.hpp"
+#include "dji_vehicle.hpp"
+#include "dji_liveview.hpp"
+
+using namespace DJI::OSDK;
+
+namespace
+{
+
+const uint32_t REPLAY_WIDTH    = 320;
+const uint32_t REPLAY_HEIGHT   = 240;
+const uint32_t REPLAY_PICTURES = 60;
+/* The recording: one second at 30 fps */
+const uint32_t REPLAY_RECORDED_PACKETS = 30;
+const uint32_t REPLAY_PERIOD_US        = 33333;
+
+const char* REPLAY_STREAM_PATH    = "/tmp/osdk-benchmark-replay.h264";
+const char* REPLAY_RECORDING_PATH = "/tmp/osdk-benchmark-replay-rec";
+
+uint64_t
+fnv1a(const uint8_t* data, size_t len)
+{
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < len; i++)
+  {
+    hash = (hash ^ data[i]) * 1099511628211ull;
+  }
+  return hash;
+}
+
+/*! The synthetic stream as an elementary stream file, and the checksum of
+ *  every access unit in it */
+struct ReplayStream
+{
+  std::vector<std::vector<uint8_t> > accessUnits;
+  std::vector<uint64_t>              checksums;
+  uint64_t                           bytes;
+  bool                               written;
+
+  ReplayStream()
+    : bytes(0)
+    , written(false)
+  {
+    SimH264Stream        stream(REPLAY_WIDTH, REPLAY_HEIGHT);
+    std::vector<uint8_t> yuv;
+    accessUnits.resize(REPLAY_PICTURES);
+    for (uint32_t i = 0; i < REPLAY_PICTURES; i++)
+    {
+      stream.makePicture(i, yuv);
+      stream.encodePicture(i, yuv, accessUnits[i]);
+      checksums.push_back(fnv1a(&accessUnits[i][0], accessUnits[i].size()));
+      bytes += accessUnits[i].size();
+    }
+
+    FILE* file = fopen(REPLAY_STREAM_PATH, "wb");
+    if (!file)
+    {
+      return;
+    }
+    written = true;
+    for (uint32_t i = 0; i < REPLAY_PICTURES; i++)
+    {
+      written = written && fwrite(&accessUnits[i][0], 1, accessUnits[i].size(),
+                                  file) == accessUnits[i].size();
+    }
+    written = (fclose(file) == 0) && written;
+  }
+
+  ~ReplayStream()
+  {
+    remove(REPLAY_STREAM_PATH);
+  }
+};
+
+/*! Compares the delivered packets with the written ones, in order */
+struct PacketCheck
+{
+  const std::vector<uint64_t>* expected;
+  uint64_t                     packets;
+  uint64_t                     bytes;
+  uint64_t                     mismatches;
+
+  PacketCheck(const std::vector<uint64_t>& expected)
+    : expected(&expected)
+    , packets(0)
+    , bytes(0)
+    , mismatches(0)
+  {
+  }
+
+  void check(const uint8_t* buf, int len)
+  {
+    if (packets >= expected->size() ||
+        fnv1a(buf, len) != (*expected)[packets])
+    {
+      mismatches++;
+    }
+    packets++;
+    bytes += len;
+  }
+
+  bool passed() const
+  {
+    return mismatches == 0 && packets == expected->size();
+  }
+};
+
+void
+checkSourcePacket(void* param, uint8_t* buf, int len)
+{
+  static_cast<PacketCheck*>(param)->check(buf, len);
+}
+
+void
+checkLiveViewPacket(uint8_t* buf, int bufLen, void* userData)
+{
+  static_cast<PacketCheck*>(userData)->check(buf, bufLen);
+}
+
+void
+waitForReplay(DJICameraStreamSource& source)
+{
+  while (source.isThreadRunning())
+  {
+    usleep(1000);
+  }
+}
+
+/*! The first access units recorded by StreamRecorder with the pace of a
+ *  camera, on first use */
+struct ReplayRecording
+{
+  std::vector<uint64_t> checksums;
+  bool                  recorded;
+  bool                  printed;
+
+  ReplayRecording()
+    : recorded(false)
+    , printed(false)
+  {
+  }
+
+  ~ReplayRecording()
+  {
+    remove((std::string(REPLAY_RECORDING_PATH) + ".h264").c_str());
+    remove((std::string(REPLAY_RECORDING_PATH) + ".frames").c_str());
+    remove((std::string(REPLAY_RECORDING_PATH) + ".index").c_str());
+  }
+
+  bool record(const ReplayStream& stream)
+  {
+    recorded = true;
+    StreamRecorder recorder;
+    if (!recorder.open(REPLAY_RECORDING_PATH))
+    {
+      return false;
+    }
+
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point begin = Clock::now();
+    for (uint32_t i = 0; i < REPLAY_RECORDED_PACKETS; i++)
+    {
+      Clock::time_point due =
+        begin + std::chrono::microseconds((uint64_t)i * REPLAY_PERIOD_US);
+      while (Clock::now() < due)
+      {
+        usleep(500);
+      }
+      const std::vector<uint8_t>& packet = stream.accessUnits[i];
+      if (!recorder.recordH264(&packet[0], packet.size()))
+      {
+        return false;
+      }
+      checksums.push_back(stream.checksums[i]);
+    }
+    recorder.close();
+
+    StreamRecorder::StatsType stats;
+    recorder.getStats(stats);
+    return stats.droppedPackets == 0 && stats.writeErrors == 0;
+  }
+};
+
+} // namespace
+
+void
+registerStreamReplayBenchmarks(BenchmarkRunner& runner)
+{
+  std::shared_ptr<ReplayStream> stream(new ReplayStream);
+  if (!stream->written)
+  {
+    std::cout << "replay: cannot write " << REPLAY_STREAM_PATH << "\n";
+    return;
+  }
+
+  /* Finding the access units: a read of the whole file */
+  runner.add("replay/es_scan_60_qvga", 20, [stream]() -> uint32_t {
+    DJICameraStreamFileSource source(
+      REPLAY_STREAM_PATH, DJICameraStreamFileSource::REPLAY_AS_FAST_AS_POSSIBLE);
+    if (!source.init() || source.getPacketCount() != REPLAY_PICTURES)
+    {
+      std::cout << "replay/es_scan_60_qvga: " << source.getPacketCount()
+                << " access units found, " << REPLAY_PICTURES << " written\n";
+    }
+    return (uint32_t)stream->bytes;
+  });
+
+  std::shared_ptr<DJICameraStreamFileSource> fastSource(
+    new DJICameraStreamFileSource(
+      REPLAY_STREAM_PATH, DJICameraStreamFileSource::REPLAY_AS_FAST_AS_POSSIBLE));
+  runner.add("replay/es_as_fast_as_possible", 20,
+             [stream, fastSource]() -> uint32_t {
+               PacketCheck check(stream->checksums);
+               fastSource->registerCallback(checkSourcePacket, &check);
+               if (!fastSource->init() || !fastSource->start())
+               {
+                 std::cout << "replay/es_as_fast_as_possible: no replay\n";
+                 return 0;
+               }
+               waitForReplay(*fastSource);
+               fastSource->cleanup();
+               fastSource->registerCallback(NULL, NULL);
+               if (!check.passed())
+               {
+                 std::cout << "replay/es_as_fast_as_possible: "
+                           << check.packets << " packets, "
+                           << check.mismatches << " not as written\n";
+               }
+               return (uint32_t)check.bytes;
+             });
+
+  /* A recording played at its pace: every packet has to come on time, as
+   * the callback is fast */
+  std::shared_ptr<ReplayRecording> recording(new ReplayRecording);
+  runner.add(
+    "replay/recording_timed_1s", 2, [stream, recording]() -> uint32_t {
+      if (!recording->recorded && !recording->record(*stream))
+      {
+        std::cout << "replay/recording_timed_1s: recording failed\n";
+      }
+
+      std::vector<StreamRecorder::IndexRecordType> records;
+      StreamRecorder::readIndex(REPLAY_RECORDING_PATH, records);
+      uint64_t recordedUs =
+        records.empty() ? 0 : records.back().timeUs - records.front().timeUs;
+
+      DJICameraStreamFileSource source(REPLAY_RECORDING_PATH);
+      PacketCheck               check(recording->checksums);
+      source.registerCallback(checkSourcePacket, &check);
+      std::chrono::steady_clock::time_point begin =
+        std::chrono::steady_clock::now();
+      if (!source.init() || !source.start())
+      {
+        std::cout << "replay/recording_timed_1s: no replay\n";
+        return 0;
+      }
+      waitForReplay(source);
+      uint64_t replayUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::steady_clock::now() - begin)
+                            .count();
+
+      DJICameraStreamFileSource::ReplayStats stats;
+      source.getStats(stats);
+      if (!check.passed())
+      {
+        std::cout << "replay/recording_timed_1s: " << check.packets
+                  << " packets, " << check.mismatches << " not as recorded\n";
+      }
+      if (!recording->printed)
+      {
+        recording->printed = true;
+        printf("replay/recording_timed_1s: %u packets in %.1f ms, recorded in "
+               "%.1f ms, %u late, at most %.2f ms\n",
+               (unsigned)stats.packets, replayUs / 1000.0, recordedUs / 1000.0,
+               (unsigned)stats.latePackets, stats.maxLateUs / 1000.0);
+      }
+      return (uint32_t)stats.bytes;
+    });
+
+  /* The same replay delivered through LiveView's H.264 callback */
+  Vehicle* vehicle = getSimulatedVehicle();
+  if (!vehicle)
+  {
+    std::cout << "replay/liveview: simulator unavailable\n";
+  }
+  else
+  {
+    std::shared_ptr<LiveView> liveView(new LiveView(vehicle));
+    std::shared_ptr<DJICameraStreamFileSource> liveViewSource(
+      new DJICameraStreamFileSource(
+        REPLAY_STREAM_PATH, DJICameraStreamFileSource::REPLAY_AS_FAST_AS_POSSIBLE));
+    runner.add("replay/liveview_as_fast_as_possible", 20,
+               [stream, liveView, liveViewSource]() -> uint32_t {
+                 PacketCheck check(stream->checksums);
+                 if (liveView->startH264Stream(
+                       LiveView::OSDK_CAMERA_POSITION_NO_1, liveViewSource.get(),
+                       checkLiveViewPacket, &check) != LiveView::OSDK_LIVEVIEW_PASS)
+                 {
+                   std::cout << "replay/liveview_as_fast_as_possible: no replay\n";
+                   return 0;
+                 }
+                 waitForReplay(*liveViewSource);
+                 liveView->stopH264Stream(LiveView::OSDK_CAMERA_POSITION_NO_1);
+                 if (!check.passed())
+                 {
+                   std::cout << "replay/liveview_as_fast_as_possible: "
+                             << check.packets << " packets, "
+                             << check.mismatches << " not as written\n";
+                 }
+                 return (uint32_t)check.bytes;
+               });
+  }
+
+}
+#else
+void
+registerStreamReplayBenchmarks(BenchmarkRunner& runner)
+{
+  (void)runner;
+}
+#endif
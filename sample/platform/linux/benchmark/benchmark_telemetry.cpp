@@ -0,0 +1,326 @@
+/*! @file benchmark_telemetry.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief
+ *  Data broadcast unpack and subscription decode benchmarks, run against a
+ *  Vehicle connected to the in-process simulated flight controller.
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "dji_linker.hpp"
+#include "dji_sim_flight_controller.hpp"
+#include "dji_vehicle.hpp"
+#include "osdk_benchmark.hpp"
+
+using namespace DJI::OSDK;
+using namespace DJI::OSDK::Telemetry;
+
+namespace
+{
+
+/* Broadcast fields in DataBroadcast::unpackData order */
+typedef struct BroadcastField
+{
+  uint16_t flag;
+  size_t   size;
+} BroadcastField;
+
+const BroadcastField broadcastFields[] = {
+  { DataBroadcast::HAS_TIME, sizeof(TimeStamp) + sizeof(SyncStamp) },
+  { DataBroadcast::HAS_Q, sizeof(Quaternion) },
+  { DataBroadcast::HAS_A, sizeof(Vector3f) },
+  { DataBroadcast::HAS_V, sizeof(Vector3f) + sizeof(VelocityInfo) },
+  { DataBroadcast::HAS_W, sizeof(Vector3f) },
+  { DataBroadcast::HAS_POS, sizeof(GlobalPosition) + sizeof(Telemetry::RelativePosition) },
+  { DataBroadcast::A3_HAS_GPS, sizeof(GPSInfo) },
+  { DataBroadcast::A3_HAS_RTK, sizeof(RTK) },
+  { DataBroadcast::A3_HAS_MAG, sizeof(Mag) },
+  { DataBroadcast::A3_HAS_RC, sizeof(RC) },
+  { DataBroadcast::A3_HAS_GIMBAL, sizeof(Telemetry::Gimbal) },
+  { DataBroadcast::A3_HAS_STATUS, sizeof(Status) },
+  { DataBroadcast::A3_HAS_BATTERY, sizeof(Battery) },
+  { DataBroadcast::A3_HAS_DEVICE, sizeof(SDKInfo) },
+  { DataBroadcast::A3_HAS_COMPASS, sizeof(Compass) },
+};
+
+/* Largest passFlag whose payload still fits the receive container */
+uint16_t
+broadcastFlagThatFits(size_t* payloadLen)
+{
+  uint16_t flag = 0;
+  size_t   len  = sizeof(uint16_t);
+  for (size_t i = 0; i < sizeof(broadcastFields) / sizeof(broadcastFields[0]);
+       i++)
+  {
+    if (len + broadcastFields[i].size > MAX_INCOMING_DATA_SIZE)
+    {
+      continue;
+    }
+    flag |= broadcastFields[i].flag;
+    len += broadcastFields[i].size;
+  }
+  *payloadLen = len;
+  return flag;
+}
+
+/* Data broadcast as recorded with the default rates (setFreqDefaults): the
+ * 50Hz topics in every frame, status at 10Hz, battery/device/compass at 1Hz */
+std::shared_ptr<std::vector<RecvContainer> >
+recordedBroadcast()
+{
+  std::shared_ptr<std::vector<RecvContainer> > frames(
+    new std::vector<RecvContainer>(50));
+  for (size_t n = 0; n < frames->size(); n++)
+  {
+    uint16_t flag = DataBroadcast::HAS_TIME | DataBroadcast::HAS_Q |
+                    DataBroadcast::HAS_A | DataBroadcast::HAS_V |
+                    DataBroadcast::HAS_W | DataBroadcast::HAS_POS |
+                    DataBroadcast::A3_HAS_RC | DataBroadcast::A3_HAS_GIMBAL;
+    if (n % 5 == 0)
+    {
+      flag |= DataBroadcast::A3_HAS_STATUS;
+    }
+    if (n == 0)
+    {
+      flag |= DataBroadcast::A3_HAS_BATTERY | DataBroadcast::A3_HAS_DEVICE |
+              DataBroadcast::A3_HAS_COMPASS;
+    }
+
+    size_t len = sizeof(uint16_t);
+    for (size_t i = 0;
+         i < sizeof(broadcastFields) / sizeof(broadcastFields[0]); i++)
+    {
+      if ((flag & broadcastFields[i].flag) &&
+          len + broadcastFields[i].size > MAX_INCOMING_DATA_SIZE)
+      {
+        flag &= ~broadcastFields[i].flag;
+      }
+      else if (flag & broadcastFields[i].flag)
+      {
+        len += broadcastFields[i].size;
+      }
+    }
+
+    RecvContainer& frame = (*frames)[n];
+    memset(&frame, 0, sizeof(frame));
+    frame.recvInfo.cmd_set = OpenProtocolCMD::CMDSet::broadcast;
+    frame.recvInfo.cmd_id  = OpenProtocolCMD::CMDSet::Broadcast::broadcast[1];
+    frame.recvInfo.len     = len;
+    memcpy(frame.recvData.raw_ack_array, &flag, sizeof(flag));
+    for (size_t i = sizeof(flag); i < len; i++)
+    {
+      frame.recvData.raw_ack_array[i] = (uint8_t)(n + i);
+    }
+  }
+  return frames;
+}
+
+SimFlightController* simulator    = NULL;
+SimFlightController* acmSimulator = NULL;
+Linker*              linker       = NULL;
+Vehicle*             vehicle      = NULL;
+
+} // namespace
+
+Vehicle*
+getSimulatedVehicle()
+{
+  if (vehicle)
+  {
+    return vehicle;
+  }
+
+  /* Pushes from the simulator would race with the decode loops below, so
+   * keep them to a trickle. */
+  SimFlightController::Config config;
+  config.transport           = SimFlightController::TRANSPORT_UDP;
+  config.broadcastFreq       = 0;
+  config.maxSubscriptionFreq = 1;
+
+  simulator = new SimFlightController(config);
+  if (!simulator->start())
+  {
+    return NULL;
+  }
+
+  linker = new Linker();
+  if (!linker->init() ||
+      !linker->addUartChannel(simulator->getDevicePath().c_str(), 921600,
+                              FC_UART_CHANNEL_ID))
+  {
+    return NULL;
+  }
+
+  /* Activation runs the version handshake and creates the modules */
+  vehicle = new Vehicle(linker);
+  Vehicle::ActivateData activateData;
+  char                  appKey[] =
+    "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef";
+  activateData.ID      = 1;
+  activateData.encKey  = appKey;
+  activateData.version = vehicle->getFwVersion();
+  if (ACK::getError(vehicle->activate(&activateData, 1)) ||
+      !vehicle->broadcast || !vehicle->subscribe)
+  {
+    delete vehicle;
+    vehicle = NULL;
+  }
+  return vehicle;
+}
+
+SimFlightController*
+getSimulatedAcmChannel()
+{
+  if (acmSimulator)
+  {
+    return acmSimulator;
+  }
+  if (!getSimulatedVehicle())
+  {
+    return NULL;
+  }
+
+  SimFlightController::Config config;
+  config.transport     = SimFlightController::TRANSPORT_UDP;
+  config.broadcastFreq = 0;
+
+  SimFlightController* sim = new SimFlightController(config);
+  if (!sim->start() ||
+      !linker->addUartChannel(sim->getDevicePath().c_str(), 921600,
+                              USB_ACM_CHANNEL_ID))
+  {
+    delete sim;
+    return NULL;
+  }
+  acmSimulator = sim;
+  return acmSimulator;
+}
+
+void
+registerTelemetryBenchmarks(BenchmarkRunner& runner)
+{
+  Vehicle* v = getSimulatedVehicle();
+  if (!v)
+  {
+    std::cout << "skipping telemetry: simulated vehicle unavailable\n";
+    return;
+  }
+
+  /* Data broadcast */
+  size_t   broadcastLen  = 0;
+  uint16_t broadcastFlag = broadcastFlagThatFits(&broadcastLen);
+
+  std::shared_ptr<RecvContainer> broadcast(new RecvContainer);
+  memset(broadcast.get(), 0, sizeof(RecvContainer));
+  broadcast->recvInfo.cmd_set = OpenProtocolCMD::CMDSet::broadcast;
+  broadcast->recvInfo.cmd_id  = OpenProtocolCMD::CMDSet::Broadcast::broadcast[1];
+  broadcast->recvInfo.len     = broadcastLen;
+  memcpy(broadcast->recvData.raw_ack_array, &broadcastFlag,
+         sizeof(broadcastFlag));
+
+  runner.add("broadcast/unpack", 200000,
+             [v, broadcast, broadcastLen]() -> uint32_t {
+               broadcast->recvData.raw_ack_array[2]++;
+               v->broadcast->unpackHandler.callback(
+                 v, *broadcast, v->broadcast->unpackHandler.userData);
+               return broadcastLen;
+             });
+
+  runner.add("broadcast/get_quaternion", 1000000, [v]() -> uint32_t {
+    volatile float q0 = v->broadcast->getQuaternion().q0;
+    (void)q0;
+    return sizeof(Quaternion);
+  });
+
+  /* Replay with the passFlag changing from frame to frame */
+  std::shared_ptr<std::vector<RecvContainer> > frames = recordedBroadcast();
+  std::shared_ptr<size_t> next(new size_t(0));
+  runner.add("broadcast/replay_decode", 200000,
+             [v, frames, next]() -> uint32_t {
+               RecvContainer& frame = (*frames)[(*next)++ % frames->size()];
+               v->broadcast->unpackHandler.callback(
+                 v, frame, v->broadcast->unpackHandler.userData);
+               return frame.recvInfo.len;
+             });
+
+  /* Reader latency while another thread decodes as fast as it can */
+  runner.add("broadcast/get_quaternion_while_decoding", 1000000,
+             [v]() -> uint32_t {
+               volatile float q0 = v->broadcast->getQuaternion().q0;
+               (void)q0;
+               return sizeof(Quaternion);
+             },
+             [v, frames](const std::atomic<bool>& running) {
+               for (size_t n = 0; running; n++)
+               {
+                 v->broadcast->unpackHandler.callback(
+                   v, (*frames)[n % frames->size()],
+                   v->broadcast->unpackHandler.userData);
+               }
+             });
+
+  /* Subscription, one package with a typical flight-control topic set */
+  TopicName topics[] = { TOPIC_QUATERNION, TOPIC_VELOCITY,
+                         TOPIC_GPS_FUSED,  TOPIC_ANGULAR_RATE_FUSIONED,
+                         TOPIC_STATUS_FLIGHT, TOPIC_HEIGHT_FUSION };
+  int  topicCount = sizeof(topics) / sizeof(topics[0]);
+  if (!v->subscribe->initPackageFromTopicList(0, topicCount, topics, false,
+                                              50) ||
+      ACK::getError(v->subscribe->startPackage(0, 1)))
+  {
+    std::cout << "skipping subscription: cannot start package\n";
+    return;
+  }
+
+  uint32_t packageLen = 1;
+  for (int i = 0; i < topicCount; i++)
+  {
+    packageLen += TopicDataBase[topics[i]].size;
+  }
+
+  std::shared_ptr<RecvContainer> package(new RecvContainer);
+  memset(package.get(), 0, sizeof(RecvContainer));
+  package->recvInfo.cmd_set = OpenProtocolCMD::CMDSet::broadcast;
+  package->recvInfo.cmd_id  = OpenProtocolCMD::CMDSet::Broadcast::subscribe[1];
+  package->recvInfo.len     = packageLen;
+  package->recvData.raw_ack_array[0] = 0;
+
+  runner.add("subscription/decode_6topics", 200000,
+             [v, package, packageLen]() -> uint32_t {
+               package->recvData.raw_ack_array[1]++;
+               DataSubscription::decodeCallback(
+                 v, *package, v->subscribe->subscriptionDataDecodeHandler.userData);
+               return packageLen;
+             });
+
+  runner.add("subscription/get_quaternion", 1000000, [v]() -> uint32_t {
+    volatile float q0 = v->subscribe->getValue<TOPIC_QUATERNION>().q0;
+    (void)q0;
+    return sizeof(Quaternion);
+  });
+}
@@ -0,0 +1,231 @@
+/*! @file benchmark_time_sync.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief
+ *  NMEA and PPS ingestion of HardwareSync, fed with a synthetic one second
+ *  burst as the flight controller sends it around every PPS pulse.
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "dji_hardware_sync.hpp"
+#include "dji_vehicle.hpp"
+#include "osdk_benchmark.hpp"
+
+using namespace DJI::OSDK;
+
+namespace
+{
+
+/* Sentences as the FC sends them: no CR/LF, GNGSA ends in the system ID */
+const struct
+{
+  const uint8_t* cmd;
+  const char*    sentence;
+} syncBurst[] = {
+  { OpenProtocolCMD::CMDSet::HardwareSync::ppsNMEAGPSGSA,
+    "$GNGSA,A,3,10,12,14,20,25,31,32,,,,,,1.2,0.7,1.0,1*3B" },
+  { OpenProtocolCMD::CMDSet::HardwareSync::ppsNMEAGPSGSA,
+    "$GNGSA,A,3,65,66,72,81,,,,,,,,,1.2,0.7,1.0,2*35" },
+  { OpenProtocolCMD::CMDSet::HardwareSync::ppsNMEAGPSGSA,
+    "$GNGSA,A,3,03,05,13,15,,,,,,,,,1.2,0.7,1.0,3*34" },
+  { OpenProtocolCMD::CMDSet::HardwareSync::ppsNMEAGPSGSA,
+    "$GNGSA,A,3,201,203,206,209,,,,,,,,,1.2,0.7,1.0,4*0C" },
+  { OpenProtocolCMD::CMDSet::HardwareSync::ppsNMEAGPSRMC,
+    "$GNRMC,083559.00,A,2232.4562,N,11356.7890,E,0.004,77.52,191026,,,A*57" },
+  { OpenProtocolCMD::CMDSet::HardwareSync::ppsNMEARTKGSA,
+    "$GPGSA,A,3,10,12,14,20,25,31,32,,,,,,1.2,0.7,1.0*36" },
+  { OpenProtocolCMD::CMDSet::HardwareSync::ppsNMEARTKRMC,
+    "$GPRMC,083559.00,A,2232.4562,N,11356.7890,E,0.004,77.52,191026,,,A*49" },
+  { OpenProtocolCMD::CMDSet::HardwareSync::ppsUTCTime,
+    "UTC: 2026-10-19 08:36:00" },
+};
+const size_t syncBurstCount = sizeof(syncBurst) / sizeof(syncBurst[0]);
+
+/* Kind each burst entry ends up in */
+const HardwareSync::NMEAKind syncBurstKind[] = {
+  HardwareSync::NMEA_GNGSA_GPS,    HardwareSync::NMEA_GNGSA_GLONASS,
+  HardwareSync::NMEA_GNGSA_GALILEO, HardwareSync::NMEA_GNGSA_BEIDOU,
+  HardwareSync::NMEA_GNRMC,        HardwareSync::NMEA_GPGSA,
+  HardwareSync::NMEA_GPRMC,        HardwareSync::NMEA_UTC,
+};
+
+RecvContainer
+nmeaFrame(const uint8_t* cmd, const char* sentence)
+{
+  RecvContainer frame;
+  size_t        length = strlen(sentence);
+  memset(&frame, 0, sizeof(frame));
+  frame.recvInfo.cmd_set = cmd[0];
+  frame.recvInfo.cmd_id  = cmd[1];
+  frame.recvInfo.len     = length + OpenProtocol::PackageMin + 4;
+  memcpy(frame.recvData.raw_ack_array, sentence, length);
+  return frame;
+}
+
+RecvContainer
+fcTimeFrame(uint32_t fcTimestampUs)
+{
+  RecvContainer frame;
+  memset(&frame, 0, sizeof(frame));
+  frame.recvInfo.cmd_set = OpenProtocolCMD::CMDSet::HardwareSync::ppsUTCFCTimeRef[0];
+  frame.recvInfo.cmd_id  = OpenProtocolCMD::CMDSet::HardwareSync::ppsUTCFCTimeRef[1];
+  frame.recvInfo.len = sizeof(ACK::FCTimeInUTC) + OpenProtocol::PackageMin + 4;
+  frame.recvData.fcTimeInUTC.fc_timestamp_us = fcTimestampUs;
+  frame.recvData.fcTimeInUTC.utc_yymmdd      = 261019;
+  frame.recvData.fcTimeInUTC.utc_hhmmss      = 83600;
+  return frame;
+}
+
+/* Every burst sentence has to come back byte for byte */
+int
+checkLatest(HardwareSync* sync)
+{
+  int mismatches = 0;
+  for (size_t i = 0; i < syncBurstCount; i++)
+  {
+    HardwareSync::NMEASentence latest;
+    if (!sync->getLatestNMEA(syncBurstKind[i], latest) ||
+        latest.length != strlen(syncBurst[i].sentence) ||
+        strcmp(latest.sentence, syncBurst[i].sentence) != 0)
+    {
+      std::cout << "timesync: wrong sentence for kind " << syncBurstKind[i]
+                << "\n";
+      mismatches++;
+    }
+  }
+
+  HardwareSync::GNGSAPackage gngsa;
+  if (!sync->getGNGSAMsg(gngsa) ||
+      gngsa.Satellite[HardwareSync::BEIDOU].sentence != syncBurst[3].sentence)
+  {
+    std::cout << "timesync: getGNGSAMsg() lost the BEIDOU sentence\n";
+    mismatches++;
+  }
+
+  HardwareSync::PPSOffset offset;
+  if (!sync->getPPSOffset(offset) ||
+      offset.offsetNs != (int64_t)offset.hostEdgeNs -
+                           (int64_t)offset.fcTimeInUTC.fc_timestamp_us * 1000)
+  {
+    std::cout << "timesync: no PPS offset\n";
+    mismatches++;
+  }
+  return mismatches;
+}
+
+} // namespace
+
+void
+registerTimeSyncBenchmarks(BenchmarkRunner& runner)
+{
+  Vehicle* v = getSimulatedVehicle();
+  if (!v || !v->hardSync)
+  {
+    std::cout << "skipping timesync: simulated vehicle unavailable\n";
+    return;
+  }
+  HardwareSync* sync = v->hardSync;
+
+  /* One PPS second: the NMEA burst plus the FC time push */
+  std::shared_ptr<std::vector<RecvContainer> > burst(
+    new std::vector<RecvContainer>);
+  for (size_t i = 0; i < syncBurstCount; i++)
+  {
+    burst->push_back(nmeaFrame(syncBurst[i].cmd, syncBurst[i].sentence));
+  }
+  burst->push_back(fcTimeFrame(1000000));
+
+  for (size_t i = 0; i < burst->size(); i++)
+  {
+    sync->writeData((*burst)[i].recvInfo.cmd_id, &(*burst)[i]);
+  }
+  if (checkLatest(sync) == 0)
+  {
+    std::cout << "timesync: synthetic feed read back correctly\n";
+  }
+
+  /* p99 against p50 is the jitter the receive thread adds per sentence */
+  std::shared_ptr<size_t> next(new size_t(0));
+  runner.add("timesync/write_sentence", 500000,
+             [sync, burst, next]() -> uint32_t {
+               RecvContainer& frame = (*burst)[(*next)++ % burst->size()];
+               if (frame.recvInfo.cmd_id ==
+                   OpenProtocolCMD::CMDSet::HardwareSync::ppsUTCFCTimeRef[1])
+               {
+                 frame.recvData.fcTimeInUTC.fc_timestamp_us += 1000000;
+               }
+               sync->writeData(frame.recvInfo.cmd_id, &frame);
+               return frame.recvInfo.len;
+             });
+
+  runner.add("timesync/get_latest_gnrmc", 1000000, [sync]() -> uint32_t {
+    HardwareSync::NMEASentence latest;
+    sync->getLatestNMEA(HardwareSync::NMEA_GNRMC, latest);
+    return latest.length;
+  });
+
+  runner.add("timesync/get_pps_offset", 1000000, [sync]() -> uint32_t {
+    HardwareSync::PPSOffset offset;
+    sync->getPPSOffset(offset);
+    return sizeof(offset);
+  });
+
+  /* Readers against a writer flipping between two GNRMC sentences of
+   * different length; anything else read back is torn */
+  std::shared_ptr<std::vector<RecvContainer> > rmc(
+    new std::vector<RecvContainer>);
+  const char* rmcA = syncBurst[4].sentence;
+  const char* rmcB =
+    "$GNRMC,083600.00,A,2232.4563,N,11356.7891,E,0.010,77.60,191026,,,A,V*2A";
+  rmc->push_back(nmeaFrame(syncBurst[4].cmd, rmcA));
+  rmc->push_back(nmeaFrame(syncBurst[4].cmd, rmcB));
+
+  std::shared_ptr<std::atomic<uint64_t> > torn(new std::atomic<uint64_t>(0));
+  runner.add("timesync/get_latest_gnrmc_while_writing", 1000000,
+             [sync, rmcA, rmcB, torn]() -> uint32_t {
+               HardwareSync::NMEASentence latest;
+               sync->getLatestNMEA(HardwareSync::NMEA_GNRMC, latest);
+               if (strcmp(latest.sentence, rmcA) != 0 &&
+                   strcmp(latest.sentence, rmcB) != 0)
+               {
+                 (*torn)++;
+               }
+               return latest.length;
+             },
+             [sync, rmc, torn](const std::atomic<bool>& running) {
+               for (size_t n = 0; running; n++)
+               {
+                 RecvContainer& frame = (*rmc)[n % rmc->size()];
+                 sync->writeData(frame.recvInfo.cmd_id, &frame);
+               }
+               if (*torn)
+               {
+                 std::cout << "timesync: " << *torn << " torn sentences\n";
+               }
+             });
+}
@@ -0,0 +1,187 @@
+/*! @file benchmark_waypoint_v2.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief
+ *  Waypoint v2 mission and action upload against a simulated flight
+ *  controller taking a while to acknowledge each chunk, for a range of upload
+ *  windows.
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <math.h>
+#include <string.h>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <vector>
+#include "dji_internal_command.hpp"
+#include "dji_sim_flight_controller.hpp"
+#include "dji_vehicle.hpp"
+#include "dji_waypoint_v2.hpp"
+#include "osdk_benchmark.hpp"
+
+using namespace DJI::OSDK;
+
+namespace
+{
+
+/* Round trip of one chunk over a real link is in the tens of ms */
+const uint32_t chunkAckDelayMs = 10;
+const uint16_t surveyWaypoints = 1000;
+const uint16_t surveyActions   = 200;
+
+/* Lawnmower survey of 20 m legs, 5 m apart */
+std::vector<WaypointV2>
+surveyMission(uint16_t count)
+{
+  std::vector<WaypointV2> mission;
+  const float64_t         refLatitude  = 22.5 * M_PI / 180;
+  const float64_t         refLongitude = 113.9 * M_PI / 180;
+  for (uint16_t i = 0; i < count; i++)
+  {
+    float64_t  x = ((i / 2) % 2 == i % 2) ? 0 : 20;
+    float64_t  y = (i / 2) * 5.0;
+    WaypointV2 waypoint;
+    memset(&waypoint, 0, sizeof(waypoint));
+    waypoint.latitude  = y / EARTH_RADIUS + refLatitude;
+    waypoint.longitude = x / (EARTH_RADIUS * cos(refLatitude)) + refLongitude;
+    waypoint.relativeHeight  = 30;
+    waypoint.waypointType    = DJIWaypointV2FlightPathModeGoToPointInAStraightLineAndStop;
+    waypoint.headingMode     = DJIWaypointV2HeadingModeAuto;
+    waypoint.dampingDistance = 40;
+    waypoint.turnMode        = DJIWaypointV2TurnModeClockwise;
+    waypoint.maxFlightSpeed  = 9;
+    waypoint.autoFlightSpeed = 2;
+    mission.push_back(waypoint);
+  }
+  return mission;
+}
+
+/* A photo at every reached waypoint */
+std::vector<DJIWaypointV2Action>
+surveyActionList(uint16_t count)
+{
+  std::vector<DJIWaypointV2Action> actions;
+  for (uint16_t i = 0; i < count; i++)
+  {
+    DJIWaypointV2SampleReachPointTriggerParam reachPoint;
+    reachPoint.waypointIndex = i;
+    reachPoint.terminateNum  = 0;
+    DJIWaypointV2Trigger trigger(DJIWaypointV2ActionTriggerTypeSampleReachPoint,
+                                 &reachPoint);
+    DJIWaypointV2CameraActuatorParam camera(
+      DJIWaypointV2ActionActuatorCameraOperationTypeTakePhoto, NULL);
+    DJIWaypointV2Actuator actuator(DJIWaypointV2ActionActuatorTypeCamera, 0,
+                                   &camera);
+    actions.push_back(DJIWaypointV2Action(i, trigger, actuator));
+  }
+  return actions;
+}
+
+void
+checkUpload(WaypointV2MissionOperator* op, ErrorCode::ErrorCodeType ret,
+            const char* what)
+{
+  const WaypointV2MissionOperator::UploadProgress& progress =
+    op->getLastUploadProgress();
+  if (ret != ErrorCode::SysCommonErr::Success ||
+      progress.itemsAcked != progress.itemsTotal)
+  {
+    std::cout << "waypointv2: " << what << " upload failed, 0x" << std::hex
+              << ret << std::dec << ", " << progress.itemsAcked << "/"
+              << progress.itemsTotal << " acknowledged\n";
+  }
+}
+
+} // namespace
+
+void
+registerWaypointV2Benchmarks(BenchmarkRunner& runner)
+{
+  Vehicle*             v   = getSimulatedVehicle();
+  SimFlightController* sim = getSimulatedAcmChannel();
+  if (!v || !sim)
+  {
+    std::cout << "skipping waypointv2: simulated vehicle unavailable\n";
+    return;
+  }
+
+  /* Both upload ACKs start with a uint32_t result, 0 is success */
+  SimFlightController::ScriptedResponse ack;
+  ack.ackData.assign(sizeof(UploadMissionRawAck), 0);
+  sim->setResponse(V1ProtocolCMD::waypointV2::waypointInitV2[0],
+                   V1ProtocolCMD::waypointV2::waypointInitV2[1], ack);
+  ack.delayMs = chunkAckDelayMs;
+  sim->setResponse(V1ProtocolCMD::waypointV2::waypointUploadV2[0],
+                   V1ProtocolCMD::waypointV2::waypointUploadV2[1], ack);
+  sim->setResponse(V1ProtocolCMD::waypointV2::waypointUploadActionV2[0],
+                   V1ProtocolCMD::waypointV2::waypointUploadActionV2[1], ack);
+
+  std::shared_ptr<WaypointV2MissionOperator> op(
+    new WaypointV2MissionOperator(v));
+  WayPointV2InitSettings settings;
+  settings.missionID                 = 1;
+  settings.repeatTimes               = 1;
+  settings.finishedAction            = DJIWaypointV2MissionFinishedGoHome;
+  settings.maxFlightSpeed            = 10;
+  settings.autoFlightSpeed           = 2;
+  settings.exitMissionOnRCSignalLost = 1;
+  settings.gotoFirstWaypointMode =
+    DJIWaypointV2MissionGotoFirstWaypointModePointToPoint;
+  settings.mission      = surveyMission(surveyWaypoints);
+  settings.missTotalLen = settings.mission.size();
+  if (op->init(&settings, 1) != ErrorCode::SysCommonErr::Success)
+  {
+    std::cout << "skipping waypointv2: mission init failed\n";
+    return;
+  }
+
+  std::shared_ptr<std::vector<DJIWaypointV2Action> > actions(
+    new std::vector<DJIWaypointV2Action>(surveyActionList(surveyActions)));
+
+  /* One operation is a whole upload; its time over the ACK delay is the
+   * number of round trips the window could not hide */
+  const uint8_t windows[] = { 1, 2, 4, 8, 16 };
+  for (size_t i = 0; i < sizeof(windows) / sizeof(windows[0]); i++)
+  {
+    uint8_t            window = windows[i];
+    std::ostringstream mission;
+    mission << "waypointv2/upload_" << surveyWaypoints << "wp_window"
+            << (int)window;
+    runner.add(mission.str(), 5, [op, window]() -> uint32_t {
+      op->setUploadWindow(window);
+      checkUpload(op.get(), op->uploadMission(10), "mission");
+      return op->getLastUploadProgress().bytesAcked;
+    });
+
+    std::ostringstream action;
+    action << "waypointv2/upload_" << surveyActions << "actions_window"
+           << (int)window;
+    runner.add(action.str(), 5, [op, actions, window]() -> uint32_t {
+      op->setUploadWindow(window);
+      checkUpload(op.get(), op->uploadAction(*actions, 10), "action");
+      return op->getLastUploadProgress().bytesAcked;
+    });
+  }
+}
@@ -0,0 +1,241 @@
+/*! @file benchmark/main.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief
+ *  Hardware-free microbenchmarks for the OSDK hot paths. Results are printed
+ *  as a table and optionally written as JSON so runs on different commits
+ *  can be diffed.
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <stdlib.h>
+#include <fstream>
+#include <iostream>
+#include "dji_linker_statistics.hpp"
+#include "dji_platform.hpp"
+#include "osdk_benchmark.hpp"
+#include "osdkhal_linux.h"
+#include "osdkosal_linux.h"
+
+using namespace DJI::OSDK;
+
+/* Logging from inside the measured loops would dominate the numbers */
+static E_OsdkStat
+silentConsole(const uint8_t* data, uint16_t dataLen)
+{
+  return OSDK_STAT_OK;
+}
+
+static void
+usage(const char* name)
+{
+  std::cout
+    << "Usage: " << name << " [options]\n"
+    << "  --filter <text>      only run benchmarks whose name contains <text>\n"
+    << "  --iterations <n>     override every benchmark's iteration count\n"
+    << "  --json <file>        also write the results as JSON\n"
+    << "  --label <text>       label stored in the JSON, e.g. a commit id\n"
+    << "  --capture <file>     raw UART capture to replay through the parsers\n"
+    << "  --h264 <file>        H.264 stream or recording to decode instead of\n"
+    << "                       the synthetic one\n"
+    << "  --link-stats <file>  write the linker statistics snapshot as JSON\n";
+}
+
+int
+main(int argc, char** argv)
+{
+  static T_OsdkLoggerConsole printConsole = {
+    .consoleLevel = OSDK_LOGGER_CONSOLE_LOG_LEVEL_ERROR,
+    .func         = silentConsole,
+  };
+
+  static T_OsdkHalUartHandler halUartHandler = {
+    .UartInit      = OsdkLinux_UartInit,
+    .UartWriteData = OsdkLinux_UartSendData,
+    .UartReadData  = OsdkLinux_UartReadData,
+    .UartClose     = OsdkLinux_UartClose,
+  };
+
+  static T_OsdkOsalHandler osalHandler = {
+    .TaskCreate         = OsdkLinux_TaskCreate,
+    .TaskDestroy        = OsdkLinux_TaskDestroy,
+    .TaskSleepMs        = OsdkLinux_TaskSleepMs,
+    .MutexCreate        = OsdkLinux_MutexCreate,
+    .MutexDestroy       = OsdkLinux_MutexDestroy,
+    .MutexLock          = OsdkLinux_MutexLock,
+    .MutexUnlock        = OsdkLinux_MutexUnlock,
+    .SemaphoreCreate    = OsdkLinux_SemaphoreCreate,
+    .SemaphoreDestroy   = OsdkLinux_SemaphoreDestroy,
+    .SemaphoreWait      = OsdkLinux_SemaphoreWait,
+    .SemaphoreTimedWait = OsdkLinux_SemaphoreTimedWait,
+    .SemaphorePost      = OsdkLinux_SemaphorePost,
+    .GetTimeMs          = OsdkLinux_GetTimeMs,
+#ifdef OS_DEBUG
+    .GetTimeUs = OsdkLinux_GetTimeUs,
+#endif
+    .Malloc = OsdkLinux_Malloc,
+    .Free   = OsdkLinux_Free,
+  };
+
+  if (DJI_REG_LOGGER_CONSOLE(&printConsole) != true ||
+      DJI_REG_UART_HANDLER(&halUartHandler) != true ||
+      DJI_REG_OSAL_HANDLER(&osalHandler) != true)
+  {
+    std::cout << "Platform handler register fail\n";
+    return -1;
+  }
+
+  std::string filter;
+  std::string jsonPath;
+  std::string label;
+  std::string capturePath;
+  std::string h264Path;
+  std::string linkStatsPath;
+  uint64_t    iterations = 0;
+
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg  = argv[i];
+    const char* next = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+    if (arg == "-h" || arg == "--help")
+    {
+      usage(argv[0]);
+      return 0;
+    }
+    if (!next)
+    {
+      usage(argv[0]);
+      return -1;
+    }
+    i++;
+
+    if (arg == "--filter")
+      filter = next;
+    else if (arg == "--iterations")
+      iterations = strtoull(next, NULL, 0);
+    else if (arg == "--json")
+      jsonPath = next;
+    else if (arg == "--label")
+      label = next;
+    else if (arg == "--capture")
+      capturePath = next;
+    else if (arg == "--h264")
+      h264Path = next;
+    else if (arg == "--link-stats")
+      linkStatsPath = next;
+    else
+    {
+      usage(argv[0]);
+      return -1;
+    }
+  }
+
+  /* The link statistics are opt-in, only collected when they are written */
+  LinkerStatistics::instance().setEnabled(!linkStatsPath.empty());
+
+  BenchmarkRunner runner;
+  registerProtocolBenchmarks(runner, capturePath);
+  registerMediaBenchmarks(runner);
+  registerErrorBenchmarks(runner);
+  if (filter.empty() || filter.find("broadcast") != std::string::npos ||
+      filter.find("subscription") != std::string::npos)
+  {
+    registerTelemetryBenchmarks(runner);
+  }
+  if (filter.empty() || filter.find("linker") != std::string::npos ||
+      filter.find("stats") != std::string::npos)
+  {
+    registerLinkerBenchmarks(runner);
+  }
+  if (filter.empty() || filter.find("hms") != std::string::npos)
+  {
+    registerHMSBenchmarks(runner);
+  }
+  if (filter.empty() || filter.find("timesync") != std::string::npos)
+  {
+    registerTimeSyncBenchmarks(runner);
+  }
+  if (filter.empty() || filter.find("waypointv2") != std::string::npos)
+  {
+    registerWaypointV2Benchmarks(runner);
+  }
+  if (filter.empty() || filter.find("mop") != std::string::npos)
+  {
+    registerMopBenchmarks(runner);
+  }
+  registerPerceptionBenchmarks(runner);
+  if (filter.empty() || filter.find("stereo") != std::string::npos)
+  {
+    registerStereoBenchmarks(runner);
+  }
+  if (filter.empty() || filter.find("record") != std::string::npos)
+  {
+    registerRecorderBenchmarks(runner);
+  }
+  if (filter.empty() || filter.find("replay") != std::string::npos)
+  {
+    registerStreamReplayBenchmarks(runner);
+  }
+  if (filter.empty() || filter.find("camera_image") != std::string::npos)
+  {
+    registerCameraImageBenchmarks(runner);
+  }
+  if (filter.empty() || filter.find("decode") != std::string::npos)
+  {
+    registerDecodeBenchmarks(runner, h264Path);
+  }
+  if (filter.empty() || filter.find("export") != std::string::npos)
+  {
+    registerFrameExportBenchmarks(runner);
+  }
+
+  runner.run(filter, iterations);
+  runner.printText(std::cout);
+
+  if (!jsonPath.empty())
+  {
+    std::ofstream json(jsonPath.c_str());
+    if (!json)
+    {
+      std::cout << "Cannot write " << jsonPath << "\n";
+      return -1;
+    }
+    runner.printJson(json, label);
+  }
+
+  if (!linkStatsPath.empty())
+  {
+    std::ofstream json(linkStatsPath.c_str());
+    if (!json)
+    {
+      std::cout << "Cannot write " << linkStatsPath << "\n";
+      return -1;
+    }
+    json << LinkerStatistics::toJson(
+              LinkerStatistics::instance().getSnapshot())
+         << "\n";
+  }
+  return 0;
+}
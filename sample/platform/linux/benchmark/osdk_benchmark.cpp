@@ -0,0 +1,236 @@
+/*! @file osdk_benchmark.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief
+ *  Minimal harness for the OSDK hot path microbenchmarks.
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "osdk_benchmark.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <thread>
+
+/* Allocation counting: glibc lets the executable interpose malloc & co.
+ * operator new ends up here as well. Sanitizers bring their own malloc,
+ * which this would bypass. */
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define OSDK_BENCHMARK_COUNT_ALLOCATIONS 0
+#elif defined(__GLIBC__)
+#define OSDK_BENCHMARK_COUNT_ALLOCATIONS 1
+#else
+#define OSDK_BENCHMARK_COUNT_ALLOCATIONS 0
+#endif
+
+#if OSDK_BENCHMARK_COUNT_ALLOCATIONS
+static std::atomic<int64_t> heapAllocations(0);
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+
+void*
+malloc(size_t size)
+{
+  heapAllocations.fetch_add(1, std::memory_order_relaxed);
+  return __libc_malloc(size);
+}
+
+void*
+calloc(size_t n, size_t size)
+{
+  heapAllocations.fetch_add(1, std::memory_order_relaxed);
+  return __libc_calloc(n, size);
+}
+
+void*
+realloc(void* ptr, size_t size)
+{
+  if (!ptr)
+  {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+  }
+  return __libc_realloc(ptr, size);
+}
+}
+#endif
+
+BenchmarkRunner::BenchmarkRunner()
+{
+}
+
+void
+BenchmarkRunner::add(const std::string& name, uint64_t iterations,
+                     Operation op, Background background)
+{
+  Entry entry;
+  entry.name       = name;
+  entry.iterations = iterations;
+  entry.op         = op;
+  entry.background = background;
+  entries.push_back(entry);
+}
+
+int64_t
+BenchmarkRunner::allocationCount()
+{
+#if OSDK_BENCHMARK_COUNT_ALLOCATIONS
+  return heapAllocations.load(std::memory_order_relaxed);
+#else
+  return -1;
+#endif
+}
+
+void
+BenchmarkRunner::run(const std::string& filter, uint64_t iterations)
+{
+  for (size_t i = 0; i < entries.size(); i++)
+  {
+    if (!filter.empty() && entries[i].name.find(filter) == std::string::npos)
+    {
+      continue;
+    }
+
+    std::atomic<bool> running(true);
+    std::thread       background;
+    if (entries[i].background)
+    {
+      background = std::thread(entries[i].background, std::cref(running));
+    }
+    results.push_back(
+      measure(entries[i], iterations ? iterations : entries[i].iterations));
+    if (background.joinable())
+    {
+      running = false;
+      background.join();
+    }
+  }
+}
+
+BenchmarkRunner::Result
+BenchmarkRunner::measure(const Entry& entry, uint64_t iterations)
+{
+  typedef std::chrono::steady_clock Clock;
+
+  /* warm caches and any lazily created state */
+  for (uint64_t i = 0; i < iterations / 10 + 1; i++)
+  {
+    entry.op();
+  }
+
+  std::vector<uint64_t> samples(iterations);
+  uint64_t              bytes = 0;
+
+  int64_t           allocBefore = allocationCount();
+  Clock::time_point begin       = Clock::now();
+  Clock::time_point last        = begin;
+  for (uint64_t i = 0; i < iterations; i++)
+  {
+    bytes += entry.op();
+    Clock::time_point now = Clock::now();
+    samples[i] =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count();
+    last = now;
+  }
+  int64_t allocAfter = allocationCount();
+
+  Result result;
+  result.name       = entry.name;
+  result.iterations = iterations;
+  result.totalNs =
+    std::chrono::duration_cast<std::chrono::nanoseconds>(last - begin).count();
+  result.bytes = bytes;
+
+  double seconds     = result.totalNs / 1e9;
+  result.opsPerSec   = seconds > 0 ? iterations / seconds : 0;
+  result.bytesPerSec = seconds > 0 ? bytes / seconds : 0;
+  result.allocsPerOp =
+    (allocBefore < 0) ? -1.0
+                      : (double)(allocAfter - allocBefore) / iterations;
+
+  std::sort(samples.begin(), samples.end());
+  result.p50Ns = iterations ? samples[iterations / 2] : 0;
+  result.p99Ns = iterations ? samples[(iterations * 99) / 100] : 0;
+  result.maxNs = iterations ? samples[iterations - 1] : 0;
+  return result;
+}
+
+const std::vector<BenchmarkRunner::Result>&
+BenchmarkRunner::getResults() const
+{
+  return results;
+}
+
+void
+BenchmarkRunner::printText(std::ostream& out) const
+{
+  out << std::left << std::setw(36) << "benchmark" << std::right
+      << std::setw(12) << "ops/s" << std::setw(12) << "MB/s"
+      << std::setw(10) << "p50 ns" << std::setw(10) << "p99 ns"
+      << std::setw(12) << "allocs/op" << "\n";
+
+  for (size_t i = 0; i < results.size(); i++)
+  {
+    const Result& r = results[i];
+    out << std::left << std::setw(36) << r.name << std::right << std::fixed
+        << std::setprecision(0) << std::setw(12) << r.opsPerSec
+        << std::setprecision(2) << std::setw(12) << r.bytesPerSec / 1e6
+        << std::setw(10) << r.p50Ns << std::setw(10) << r.p99Ns
+        << std::setw(12);
+    if (r.allocsPerOp < 0)
+    {
+      out << "n/a";
+    }
+    else
+    {
+      out << r.allocsPerOp;
+    }
+    out << "\n";
+  }
+}
+
+void
+BenchmarkRunner::printJson(std::ostream& out, const std::string& label) const
+{
+  out << "{\n  \"label\": \"" << label << "\",\n  \"results\": [\n";
+  for (size_t i = 0; i < results.size(); i++)
+  {
+    const Result& r = results[i];
+    out << std::fixed << std::setprecision(3) << "    {\"name\": \"" << r.name
+        << "\", \"iterations\": " << r.iterations
+        << ", \"total_ns\": " << r.totalNs << ", \"bytes\": " << r.bytes
+        << ", \"ops_per_sec\": " << r.opsPerSec
+        << ", \"bytes_per_sec\": " << r.bytesPerSec
+        << ", \"p50_ns\": " << r.p50Ns << ", \"p99_ns\": " << r.p99Ns
+        << ", \"max_ns\": " << r.maxNs
+        << ", \"allocs_per_op\": " << r.allocsPerOp << "}"
+        << ((i + 1 < results.size()) ? ",\n" : "\n");
+  }
+  out << "  ]\n}\n";
+}
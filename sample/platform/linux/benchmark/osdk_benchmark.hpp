@@ -0,0 +1,143 @@
+/*! @file osdk_benchmark.hpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief
+ *  Minimal harness for the OSDK hot path microbenchmarks.
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef ONBOARDSDK_OSDK_BENCHMARK_H
+#define ONBOARDSDK_OSDK_BENCHMARK_H
+
+#include <stdint.h>
+#include <atomic>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*! @brief Runs registered operations and reports throughput, latency
+ *  percentiles and heap allocations per operation.
+ *
+ *  Every operation is timed individually, so results include roughly one
+ *  steady_clock read (~20-30 ns) of overhead per call.
+ */
+class BenchmarkRunner
+{
+public:
+  /*! One call of the hot path; returns the number of payload bytes it
+   *  processed (0 if throughput in bytes is meaningless). */
+  typedef std::function<uint32_t()> Operation;
+
+  /*! Load running on its own thread while an operation is measured; it has
+   *  to return once the flag turns false. */
+  typedef std::function<void(const std::atomic<bool>& running)> Background;
+
+  typedef struct Result
+  {
+    std::string name;
+    uint64_t    iterations;
+    uint64_t    totalNs;
+    uint64_t    bytes;
+    double      opsPerSec;
+    double      bytesPerSec;
+    uint64_t    p50Ns;
+    uint64_t    p99Ns;
+    uint64_t    maxNs;
+    /*! negative when allocation counting is not available */
+    double      allocsPerOp;
+  } Result;
+
+public:
+  BenchmarkRunner();
+
+  void add(const std::string& name, uint64_t iterations, Operation op,
+           Background background = Background());
+
+  /*! @param filter substring a benchmark name has to contain, empty runs all
+   *  @param iterations overrides every benchmark's iteration count if != 0 */
+  void run(const std::string& filter, uint64_t iterations);
+
+  const std::vector<Result>& getResults() const;
+
+  void printText(std::ostream& out) const;
+  void printJson(std::ostream& out, const std::string& label) const;
+
+  /*! @return heap allocations performed by this process so far, or -1 */
+  static int64_t allocationCount();
+
+private:
+  typedef struct Entry
+  {
+    std::string name;
+    uint64_t    iterations;
+    Operation   op;
+    Background  background;
+  } Entry;
+
+  Result measure(const Entry& entry, uint64_t iterations);
+
+  std::vector<Entry>  entries;
+  std::vector<Result> results;
+};
+
+namespace DJI
+{
+namespace OSDK
+{
+class Vehicle;
+} // OSDK
+} // DJI
+class SimFlightController;
+
+/*! @return a Vehicle talking to the in-process simulated flight controller,
+ *  created on first use; NULL if it could not be brought up */
+DJI::OSDK::Vehicle* getSimulatedVehicle();
+
+/*! @return the simulator answering V1 commands (HMS, waypoint v2, ...),
+ *  which go over the USB ACM channel of getSimulatedVehicle(); NULL if it
+ *  could not be brought up */
+SimFlightController* getSimulatedAcmChannel();
+
+void registerProtocolBenchmarks(BenchmarkRunner& runner,
+                                const std::string& capturePath);
+void registerTelemetryBenchmarks(BenchmarkRunner& runner);
+void registerMediaBenchmarks(BenchmarkRunner& runner);
+void registerLinkerBenchmarks(BenchmarkRunner& runner);
+void registerErrorBenchmarks(BenchmarkRunner& runner);
+void registerHMSBenchmarks(BenchmarkRunner& runner);
+void registerTimeSyncBenchmarks(BenchmarkRunner& runner);
+void registerWaypointV2Benchmarks(BenchmarkRunner& runner);
+void registerMopBenchmarks(BenchmarkRunner& runner);
+void registerPerceptionBenchmarks(BenchmarkRunner& runner);
+void registerStereoBenchmarks(BenchmarkRunner& runner);
+void registerRecorderBenchmarks(BenchmarkRunner& runner);
+void registerStreamReplayBenchmarks(BenchmarkRunner& runner);
+void registerCameraImageBenchmarks(BenchmarkRunner& runner);
+/*! @param h264Path stream to decode besides the synthetic one, may be empty */
+void registerDecodeBenchmarks(BenchmarkRunner& runner,
+                              const std::string& h264Path);
+void registerFrameExportBenchmarks(BenchmarkRunner& runner);
+
+#endif // ONBOARDSDK_OSDK_BENCHMARK_H
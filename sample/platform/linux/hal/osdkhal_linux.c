@@ -26,6 +26,13 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "osdkhal_linux.h"
+#include <stdlib.h>
+
+/* Private constants ---------------------------------------------------------*/
+#define OSDK_LINUX_UDP_PORT_PREFIX "udp://"
+
+/* Private functions declaration ---------------------------------------------*/
+static E_OsdkStat OsdkLinux_UdpInit(const char *addr, T_HalObj *obj);
 
 /* Exported functions definition ---------------------------------------------*/
 
@@ -61,10 +68,13 @@ E_OsdkStat OsdkLinux_UartSendData(const T_HalObj *obj, const uint8_t *pBuf,
  */
 E_OsdkStat OsdkLinux_UartReadData(const T_HalObj *obj, uint8_t *pBuf,
                                   uint32_t *bufLen) {
+  int32_t realLen;
+
   if ((obj == NULL) || (obj->uartObject.fd == -1)) {
     return OSDK_STAT_ERR;
   }
-  *bufLen = read(obj->uartObject.fd, pBuf, 1024);
+  realLen = read(obj->uartObject.fd, pBuf, 1024);
+  *bufLen = (realLen > 0) ? realLen : 0;
 
   return OSDK_STAT_OK;
 }
@@ -85,6 +95,8 @@ E_OsdkStat OsdkLinux_UartClose(T_HalObj *obj) {
 
 /**
  * @brief Uart interface init function.
+ * @note A port given as "udp://<ip>:<port>" opens a local UDP channel instead
+ * of a tty, e.g. to reach the simulated flight controller without hardware.
  * @param port: uart interface port.
  * @param baudrate:  uart interface baudrate.
  * @param obj: pointer to the hal object, which is used to store uart interface parameters.
@@ -105,6 +117,11 @@ E_OsdkStat OsdkLinux_UartInit(const char *port, const int baudrate,
     return OSDK_STAT_ERR_PARAM;
   }
 
+  if (strncmp(port, OSDK_LINUX_UDP_PORT_PREFIX,
+              strlen(OSDK_LINUX_UDP_PORT_PREFIX)) == 0) {
+    return OsdkLinux_UdpInit(port + strlen(OSDK_LINUX_UDP_PORT_PREFIX), obj);
+  }
+
   obj->uartObject.fd = open(port, O_RDWR | O_NOCTTY | O_NDELAY);
   if (obj->uartObject.fd == -1) {
     OsdkStat = OSDK_STAT_ERR;
@@ -161,6 +178,50 @@ E_OsdkStat OsdkLinux_UartInit(const char *port, const int baudrate,
   return OsdkStat;
 }
 
+/* Private functions definition-----------------------------------------------*/
+
+/**
+ * @brief UDP channel init function, the socket is used in place of a uart fd.
+ * @param addr: "<ip>:<port>" of the peer, e.g. a simulated flight controller.
+ * @param obj: pointer to the hal object, which is used to store the socket fd.
+ * @return an enum that represents a status of OSDK
+ */
+static E_OsdkStat OsdkLinux_UdpInit(const char *addr, T_HalObj *obj) {
+  struct sockaddr_in peer;
+  char ip[32] = {0};
+  const char *sep = strrchr(addr, ':');
+  int flags;
+
+  if ((sep == NULL) || (sep - addr >= (int)sizeof(ip))) {
+    return OSDK_STAT_ERR_PARAM;
+  }
+  memcpy(ip, addr, sep - addr);
+
+  memset(&peer, 0, sizeof(peer));
+  peer.sin_family = AF_INET;
+  peer.sin_port = htons((uint16_t)atoi(sep + 1));
+  if (inet_pton(AF_INET, ip, &peer.sin_addr) != 1) {
+    return OSDK_STAT_ERR_PARAM;
+  }
+
+  obj->uartObject.fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (obj->uartObject.fd == -1) {
+    return OSDK_STAT_ERR;
+  }
+
+  /* connected datagram socket, so read/write behave like on the tty */
+  if (connect(obj->uartObject.fd, (struct sockaddr *)&peer, sizeof(peer)) != 0) {
+    close(obj->uartObject.fd);
+    obj->uartObject.fd = -1;
+    return OSDK_STAT_ERR;
+  }
+
+  flags = fcntl(obj->uartObject.fd, F_GETFL, 0);
+  fcntl(obj->uartObject.fd, F_SETFL, flags | O_NONBLOCK);
+
+  return OSDK_STAT_OK;
+}
+
 #ifdef ADVANCED_SENSING
 
 /**
@@ -292,9 +292,9 @@ static void* MopClientTask(void *arg)
   }
 
   /*! connect pipeline */
-  MopPipeline *OP_Pipeline = NULL;
+  MopPipelinePtr OP_Pipeline;
   if ((mopClient->connect(TEST_OP_PIPELINE_ID, RELIABLE, OP_Pipeline)
-      != MOP_PASSED) || (OP_Pipeline == NULL)) {
+      != MOP_PASSED) || !OP_Pipeline) {
     DERROR("MOP Pipeline connect failed");
     return NULL;
   } else {
@@ -302,7 +302,7 @@ static void* MopClientTask(void *arg)
   }
 
   /*! OSDK upload file to PSDK */
-  OPDownloadFileTask(OP_Pipeline);
+  OPDownloadFileTask(OP_Pipeline.get());
 
   /*! Disconnect pipeline */
   if (mopClient->disconnect(TEST_OP_PIPELINE_ID) != MOP_PASSED) {
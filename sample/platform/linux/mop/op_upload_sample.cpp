@@ -224,9 +224,9 @@ static void* MopClientTask(void *arg)
   }
 
   /*! connect pipeline */
-  MopPipeline *OP_Pipeline = NULL;
+  MopPipelinePtr OP_Pipeline;
   if ((mopClient->connect(TEST_OP_PIPELINE_ID, RELIABLE, OP_Pipeline)
-      != MOP_PASSED) || (OP_Pipeline == NULL)) {
+      != MOP_PASSED) || !OP_Pipeline) {
     DERROR("MOP Pipeline connect failed");
     return NULL;
   } else {
@@ -234,7 +234,7 @@ static void* MopClientTask(void *arg)
   }
 
   /*! OSDK upload file to PSDK */
-  OPUploadFileTask(OP_Pipeline);
+  OPUploadFileTask(OP_Pipeline.get());
 
   /*! Disconnect pipeline */
   if (mopClient->disconnect(TEST_OP_PIPELINE_ID) != MOP_PASSED) {
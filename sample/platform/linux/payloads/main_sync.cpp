@@ -187,14 +187,14 @@ static void printMediaFileMsg(MediaFile file) {
   }
 }
 
-FilePackage cur_file_list;
-void fileListReqCB(E_OsdkStat ret_code, const FilePackage file_list, void* udata) {
+FilePackagePtr cur_file_list;
+void fileListReqCB(E_OsdkStat ret_code, FilePackagePtr file_list, void* udata) {
   DSTATUS("\033[1;32;40m##[%s] : ret = %d \033[0m", udata, ret_code);
   if (ret_code == OSDK_STAT_OK) {
     cur_file_list = file_list;
-    DSTATUS("file_list.type = %d", file_list.type);
-    DSTATUS("file_list.media.size() = %d", file_list.media.size());
-    for (auto &file : file_list.media) {
+    DSTATUS("file_list.type = %d", file_list->type);
+    DSTATUS("file_list.media.size() = %d", file_list->media.size());
+    for (auto &file : file_list->media) {
       printMediaFileMsg(file);
     }
   }
@@ -408,9 +408,12 @@ int main(int argc, char **argv) {
         break;
       }
       case 'p': {
-
-        DSTATUS("Download file number : %d", cur_file_list.media.size());
-        for (uint32_t i = 0; i < cur_file_list.media.size(); i++) {
+        if (!cur_file_list) {
+          DERROR("No file list yet, download it first");
+          break;
+        }
+        DSTATUS("Download file number : %d", cur_file_list->media.size());
+        for (uint32_t i = 0; i < cur_file_list->media.size(); i++) {
           fileDataDownloadFinished = false;
           DSTATUS("回放模式......");
           vehicle->cameraManager->setModeSync(PAYLOAD_INDEX_0,
@@ -424,11 +427,11 @@ int main(int argc, char **argv) {
 
           DSTATUS("Try to download file list  .......");
           char pathBuffer[100] = {0};
-          sprintf(pathBuffer, "./DJI0%03d", cur_file_list.media[i].fileIndex - 99900);
+          sprintf(pathBuffer, "./DJI0%03d", cur_file_list->media[i].fileIndex - 99900);
           std::string localPath(pathBuffer);
 
-          DSTATUS("cur_file_list.media[i].fileIndex = %d, localPath = %s", cur_file_list.media[i].fileIndex, localPath.c_str());
-          ret = vehicle->cameraManager->startReqFileData(cur_file_list.media[i].fileIndex, localPath, fileDataReqCB, (void *) (localPath.c_str()));
+          DSTATUS("cur_file_list->media[i].fileIndex = %d, localPath = %s", cur_file_list->media[i].fileIndex, localPath.c_str());
+          ret = vehicle->cameraManager->startReqFileData(cur_file_list->media[i].fileIndex, localPath, fileDataReqCB, (void *) (localPath.c_str()));
           ErrorCode::printErrorCodeMsg(ret);
           while (fileDataDownloadFinished == false) {
             OsdkOsal_TaskSleepMs(1000);
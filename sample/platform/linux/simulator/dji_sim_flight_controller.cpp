@@ -0,0 +1,981 @@
+/*! @file dji_sim_flight_controller.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief
+ *  Simulated flight controller endpoint for hardware-free testing.
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "dji_sim_flight_controller.hpp"
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include "dji_command.hpp"
+#include "dji_error.hpp"
+#include "dji_log.hpp"
+#include "dji_telemetry.hpp"
+#include "dji_vehicle.hpp"
+
+using namespace DJI::OSDK;
+
+#define SIM_PARSE_BUFFER_LEN  (OSDK_PACKAGE_MAX_LEN * 4)
+#define SIM_FRAME_BUFFER_LEN  (OSDK_PACKAGE_MAX_LEN * 2)
+#define SIM_TX_TICK_MS        1
+
+SimFlightController::Config::Config()
+  : transport(TRANSPORT_PTY)
+  , udpPort(0)
+  , hwVersion("PM420")
+  , fwVersion("03.03.10.10")
+  , serialNumber("SIMFC0000000001")
+  , appId(0)
+  , ackDelayMs(0)
+  , ackJitterMs(0)
+  , ackLossRate(0.0)
+  , seed(0)
+  , broadcastFreq(0)
+  , broadcastFlag(0x0003)
+  , maxSubscriptionFreq(0)
+{
+}
+
+SimFlightController::ScriptedResponse::ScriptedResponse()
+  : delayMs(0)
+  , lossRate(0.0)
+  , silent(false)
+{
+}
+
+SimFlightController::SimFlightController(const Config& config)
+  : config(config)
+  , fd(-1)
+  , ptySlaveFd(-1)
+  , sdkExt(NULL)
+  , v1Ext(NULL)
+  , running(false)
+  , activated(false)
+  , pushSeq(0)
+  , rng(config.seed)
+  , hasUdpPeer(false)
+{
+  memset(&sdkOps, 0, sizeof(sdkOps));
+  memset(&v1Ops, 0, sizeof(v1Ops));
+  memset(&stats, 0, sizeof(stats));
+  memset(&udpPeer, 0, sizeof(udpPeer));
+  for (int i = 0; i < MAX_PACKAGE; i++)
+  {
+    packages[i].valid    = false;
+    packages[i].freq     = 0;
+    packages[i].config   = 0;
+    packages[i].dataSize = 0;
+  }
+}
+
+SimFlightController::~SimFlightController()
+{
+  stop();
+}
+
+bool
+SimFlightController::start()
+{
+  if (running)
+  {
+    return true;
+  }
+
+  if (OsdkProtocol_getProtocolOps(PROTOCOL_SDK, &sdkOps) != OSDK_STAT_OK ||
+      OsdkProtocol_getProtocolOps(PROTOCOL_V1, &v1Ops) != OSDK_STAT_OK)
+  {
+    DERROR("Simulator: protocol ops unavailable");
+    return false;
+  }
+  if (sdkOps.Init(&sdkExt) != OSDK_STAT_OK ||
+      v1Ops.Init(&v1Ext) != OSDK_STAT_OK)
+  {
+    DERROR("Simulator: protocol init failed");
+    return false;
+  }
+
+  bool opened = (config.transport == TRANSPORT_UDP) ? openUdp() : openPty();
+  if (!opened)
+  {
+    return false;
+  }
+
+  nextBroadcast = std::chrono::steady_clock::now();
+  running       = true;
+  rxThread      = std::thread(&SimFlightController::rxTask, this);
+  txThread      = std::thread(&SimFlightController::txTask, this);
+
+  DSTATUS("Simulator: flight controller %s-%s listening on %s",
+          config.hwVersion.c_str(), config.fwVersion.c_str(),
+          devicePath.c_str());
+  return true;
+}
+
+void
+SimFlightController::stop()
+{
+  if (!running)
+  {
+    return;
+  }
+
+  running = false;
+  txCond.notify_all();
+  if (rxThread.joinable())
+  {
+    rxThread.join();
+  }
+  if (txThread.joinable())
+  {
+    txThread.join();
+  }
+
+  closeTransport();
+
+  if (sdkExt)
+  {
+    sdkOps.Deinit(sdkExt);
+    sdkExt = NULL;
+  }
+  if (v1Ext)
+  {
+    v1Ops.Deinit(v1Ext);
+    v1Ext = NULL;
+  }
+}
+
+const std::string&
+SimFlightController::getDevicePath() const
+{
+  return devicePath;
+}
+
+void
+SimFlightController::setResponse(uint8_t cmdSet, uint8_t cmdId,
+                                 const ScriptedResponse& response)
+{
+  std::lock_guard<std::mutex> guard(lock);
+  responses[cmdKey(cmdSet, cmdId)] = response;
+}
+
+void
+SimFlightController::registerHandler(uint8_t cmdSet, uint8_t cmdId,
+                                     Handler handler)
+{
+  std::lock_guard<std::mutex> guard(lock);
+  handlers[cmdKey(cmdSet, cmdId)] = handler;
+}
+
+bool
+SimFlightController::loadScript(const std::string& path)
+{
+  std::ifstream file(path.c_str());
+  if (!file.is_open())
+  {
+    DERROR("Simulator: cannot open script %s", path.c_str());
+    return false;
+  }
+
+  std::string line;
+  int         lineNum = 0;
+  while (std::getline(file, line))
+  {
+    lineNum++;
+    size_t comment = line.find('#');
+    if (comment != std::string::npos)
+    {
+      line.erase(comment);
+    }
+
+    std::istringstream tokens(line);
+    std::string        setStr, idStr;
+    if (!(tokens >> setStr))
+    {
+      continue;
+    }
+    if (!(tokens >> idStr))
+    {
+      DERROR("Simulator: %s:%d missing cmdId", path.c_str(), lineNum);
+      return false;
+    }
+
+    uint8_t cmdSet = (uint8_t)strtoul(setStr.c_str(), NULL, 0);
+    uint8_t cmdId  = (uint8_t)strtoul(idStr.c_str(), NULL, 0);
+
+    ScriptedResponse response;
+    std::string      token;
+    while (tokens >> token)
+    {
+      if (token == "silent")
+      {
+        response.silent = true;
+      }
+      else if (token.compare(0, 6, "delay=") == 0)
+      {
+        response.delayMs = (uint32_t)strtoul(token.c_str() + 6, NULL, 0);
+      }
+      else if (token.compare(0, 5, "loss=") == 0)
+      {
+        response.lossRate = strtod(token.c_str() + 5, NULL);
+      }
+      else if (token.compare(0, 4, "ack=") == 0)
+      {
+        std::string hex = token.substr(4);
+        if (hex.compare(0, 2, "0x") == 0 || hex.compare(0, 2, "0X") == 0)
+        {
+          hex.erase(0, 2);
+        }
+        for (size_t i = 0; i + 1 < hex.size(); i += 2)
+        {
+          response.ackData.push_back(
+            (uint8_t)strtoul(hex.substr(i, 2).c_str(), NULL, 16));
+        }
+      }
+      else
+      {
+        DERROR("Simulator: %s:%d unknown token %s", path.c_str(), lineNum,
+               token.c_str());
+        return false;
+      }
+    }
+
+    setResponse(cmdSet, cmdId, response);
+  }
+  return true;
+}
+
+bool
+SimFlightController::push(E_ProtocolType protoType, uint8_t cmdSet,
+                          uint8_t cmdId, const uint8_t* data, uint32_t len,
+                          uint8_t receiver)
+{
+  T_CmdInfo info;
+  memset(&info, 0, sizeof(info));
+  info.packetType = OSDK_COMMAND_PACKET_TYPE_REQUEST;
+  info.needAck    = OSDK_COMMAND_NEED_ACK_NO_NEED;
+  info.encType    = 0;
+  info.sender     = 0;
+  info.receiver   = receiver;
+  info.cmdSet     = cmdSet;
+  info.cmdId      = cmdId;
+  info.sessionId  = 0;
+  info.dataLen    = len;
+  info.protoType  = protoType;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    info.seqNum = pushSeq++;
+  }
+
+  return sendFrame(protoType, &info, data);
+}
+
+SimFlightController::Stats
+SimFlightController::getStats() const
+{
+  std::lock_guard<std::mutex> guard(lock);
+  return stats;
+}
+
+bool
+SimFlightController::isActivated() const
+{
+  return activated;
+}
+
+bool
+SimFlightController::openPty()
+{
+  fd = posix_openpt(O_RDWR | O_NOCTTY);
+  if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0)
+  {
+    DERROR("Simulator: cannot allocate pty");
+    closeTransport();
+    return false;
+  }
+
+  const char* slaveName = ptsname(fd);
+  if (!slaveName)
+  {
+    closeTransport();
+    return false;
+  }
+  devicePath = slaveName;
+
+  /* Keep our own handle on the slave in raw mode so the master does not see
+   * EIO while the host is (re)opening it. */
+  ptySlaveFd = open(slaveName, O_RDWR | O_NOCTTY);
+  if (ptySlaveFd >= 0)
+  {
+    struct termios options;
+    if (tcgetattr(ptySlaveFd, &options) == 0)
+    {
+      cfmakeraw(&options);
+      tcsetattr(ptySlaveFd, TCSANOW, &options);
+    }
+  }
+
+  if (!config.ptyLink.empty())
+  {
+    unlink(config.ptyLink.c_str());
+    if (symlink(slaveName, config.ptyLink.c_str()) == 0)
+    {
+      devicePath = config.ptyLink;
+    }
+    else
+    {
+      DERROR("Simulator: cannot link %s to %s", config.ptyLink.c_str(),
+             slaveName);
+    }
+  }
+
+  return true;
+}
+
+bool
+SimFlightController::openUdp()
+{
+  fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0)
+  {
+    DERROR("Simulator: cannot create udp socket");
+    return false;
+  }
+
+  struct sockaddr_in local;
+  memset(&local, 0, sizeof(local));
+  local.sin_family      = AF_INET;
+  local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  local.sin_port        = htons(config.udpPort);
+  if (bind(fd, (struct sockaddr*)&local, sizeof(local)) != 0)
+  {
+    DERROR("Simulator: cannot bind udp port %d", config.udpPort);
+    closeTransport();
+    return false;
+  }
+
+  socklen_t localLen = sizeof(local);
+  getsockname(fd, (struct sockaddr*)&local, &localLen);
+
+  std::ostringstream path;
+  path << "udp://127.0.0.1:" << ntohs(local.sin_port);
+  devicePath = path.str();
+  return true;
+}
+
+void
+SimFlightController::closeTransport()
+{
+  if (fd >= 0)
+  {
+    close(fd);
+    fd = -1;
+  }
+  if (ptySlaveFd >= 0)
+  {
+    close(ptySlaveFd);
+    ptySlaveFd = -1;
+  }
+  if (config.transport == TRANSPORT_PTY && !config.ptyLink.empty())
+  {
+    unlink(config.ptyLink.c_str());
+  }
+}
+
+void
+SimFlightController::rxTask()
+{
+  std::vector<uint8_t> sdkBuffer(SIM_PARSE_BUFFER_LEN);
+  std::vector<uint8_t> v1Buffer(SIM_PARSE_BUFFER_LEN);
+  T_CmdParse           sdkParse = { &sdkBuffer[0], 0 };
+  T_CmdParse           v1Parse  = { &v1Buffer[0], 0 };
+  uint8_t              buf[OSDK_PACKAGE_MAX_LEN];
+
+  while (running)
+  {
+    struct pollfd pfd;
+    pfd.fd      = fd;
+    pfd.events  = POLLIN;
+    pfd.revents = 0;
+    if (poll(&pfd, 1, 20) <= 0 || !(pfd.revents & POLLIN))
+    {
+      continue;
+    }
+
+    ssize_t len;
+    if (config.transport == TRANSPORT_UDP)
+    {
+      struct sockaddr_in peer;
+      socklen_t          peerLen = sizeof(peer);
+      len = recvfrom(fd, buf, sizeof(buf), 0, (struct sockaddr*)&peer,
+                     &peerLen);
+      if (len > 0)
+      {
+        std::lock_guard<std::mutex> guard(writeLock);
+        udpPeer    = peer;
+        hasUdpPeer = true;
+      }
+    }
+    else
+    {
+      len = read(fd, buf, sizeof(buf));
+    }
+    if (len <= 0)
+    {
+      continue;
+    }
+
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      stats.bytesReceived += len;
+    }
+
+    for (ssize_t i = 0; i < len; i++)
+    {
+      uint8_t* frame    = NULL;
+      uint32_t frameLen = 0;
+      if (sdkOps.Parse(&sdkParse, buf[i], &frame, &frameLen) == OSDK_STAT_OK)
+      {
+        onFrame(PROTOCOL_SDK, frame);
+      }
+      if (v1Ops.Parse(&v1Parse, buf[i], &frame, &frameLen) == OSDK_STAT_OK)
+      {
+        onFrame(PROTOCOL_V1, frame);
+      }
+    }
+  }
+}
+
+void
+SimFlightController::txTask()
+{
+  while (running)
+  {
+    std::vector<PendingAck> due;
+    std::chrono::steady_clock::time_point now;
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      txCond.wait_for(guard, std::chrono::milliseconds(SIM_TX_TICK_MS));
+      now = std::chrono::steady_clock::now();
+      for (std::vector<PendingAck>::iterator it = pendingAcks.begin();
+           it != pendingAcks.end();)
+      {
+        if (it->due <= now)
+        {
+          due.push_back(*it);
+          it = pendingAcks.erase(it);
+        }
+        else
+        {
+          ++it;
+        }
+      }
+    }
+
+    for (size_t i = 0; i < due.size(); i++)
+    {
+      sendFrame(due[i].info.protoType, &due[i].info,
+                due[i].data.empty() ? NULL : &due[i].data[0]);
+    }
+
+    pushPeriodic(now);
+  }
+}
+
+void
+SimFlightController::onFrame(E_ProtocolType type, uint8_t* frame)
+{
+  T_CmdInfo info;
+  uint8_t   data[SIM_FRAME_BUFFER_LEN];
+  memset(&info, 0, sizeof(info));
+
+  void*           ext    = (type == PROTOCOL_SDK) ? sdkExt : v1Ext;
+  T_ProtocolOps&  ops    = (type == PROTOCOL_SDK) ? sdkOps : v1Ops;
+  if (ops.Unpack(ext, frame, &info, data) != OSDK_STAT_OK)
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    stats.badFrames++;
+    return;
+  }
+  info.protoType = type;
+
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    stats.framesReceived++;
+  }
+
+  if (info.packetType == OSDK_COMMAND_PACKET_TYPE_ACK)
+  {
+    return;
+  }
+
+  /* The SDK protocol length counts the cmdSet/cmdId bytes that Unpack has
+   * already stripped from the payload. */
+  if (type == PROTOCOL_SDK)
+  {
+    info.dataLen = (info.dataLen >= 2) ? info.dataLen - 2 : 0;
+  }
+
+  /* SDK session 0 and V1 needAck 0 are fire-and-forget */
+  bool needAck = (type == PROTOCOL_SDK) ? (info.sessionId != 0)
+                                        : (info.needAck != 0);
+
+  std::vector<uint8_t> ack;
+  uint32_t             delayMs  = config.ackDelayMs;
+  double               lossRate = config.ackLossRate;
+  bool                 reply    = false;
+
+  Handler          handler;
+  ScriptedResponse scripted;
+  bool             hasScript = false;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    std::map<uint16_t, Handler>::iterator h =
+      handlers.find(cmdKey(info.cmdSet, info.cmdId));
+    if (h != handlers.end())
+    {
+      handler = h->second;
+    }
+    std::map<uint16_t, ScriptedResponse>::iterator r =
+      responses.find(cmdKey(info.cmdSet, info.cmdId));
+    if (r != responses.end())
+    {
+      scripted  = r->second;
+      hasScript = true;
+    }
+  }
+
+  if (handler)
+  {
+    reply = handler(info, data, ack);
+  }
+  else if (hasScript)
+  {
+    reply = !scripted.silent;
+    delayMs += scripted.delayMs;
+    lossRate = std::max(lossRate, scripted.lossRate);
+    if (scripted.ackData.empty())
+    {
+      defaultResponse(info, data, ack);
+    }
+    else
+    {
+      ack = scripted.ackData;
+    }
+  }
+  else
+  {
+    reply = defaultResponse(info, data, ack);
+  }
+
+  if (reply && needAck)
+  {
+    sendAck(info, ack, delayMs, lossRate);
+  }
+}
+
+bool
+SimFlightController::defaultResponse(const T_CmdInfo& req,
+                                     const uint8_t* data,
+                                     std::vector<uint8_t>& ack)
+{
+  const uint8_t* getVersion = OpenProtocolCMD::CMDSet::Activation::getVersion;
+  const uint8_t* activate   = OpenProtocolCMD::CMDSet::Activation::activate;
+  const uint8_t* heartBeat  = OpenProtocolCMD::CMDSet::Activation::heatBeatCmd;
+
+  if (req.cmdSet == getVersion[0] && req.cmdId == getVersion[1])
+  {
+    /* ack(2) + serial number + '\0' + "SDK-v1.0 BETA <hw>-<fw>" + '\0' */
+    std::string name = "SDK-v1.0 BETA " + config.hwVersion + "-" +
+                       config.fwVersion;
+    std::string serial = config.serialNumber.substr(0, 15);
+    ack.assign(2, 0);
+    ack.insert(ack.end(), serial.begin(), serial.end());
+    ack.push_back(0);
+    ack.insert(ack.end(), name.begin(), name.end());
+    ack.resize(ack.size() + 32, 0);
+    return true;
+  }
+
+  if (req.cmdSet == activate[0] && req.cmdId == activate[1])
+  {
+    uint32_t appId = 0;
+    if (req.dataLen >= sizeof(appId))
+    {
+      memcpy(&appId, data, sizeof(appId));
+    }
+
+    uint16_t result = ErrorCode::ActivationACK::SUCCESS;
+    if (config.appId != 0 && appId != config.appId)
+    {
+      result = ErrorCode::ActivationACK::NEW_DEVICE_ERROR;
+    }
+    else
+    {
+      activated = true;
+      if (!config.appKey.empty())
+      {
+        sdkOps.SetKey(config.appKey.c_str());
+      }
+    }
+    ack.resize(sizeof(result));
+    memcpy(&ack[0], &result, sizeof(result));
+    return true;
+  }
+
+  if (req.cmdSet == heartBeat[0] && req.cmdId == heartBeat[1])
+  {
+    ack.assign(data, data + req.dataLen);
+    return true;
+  }
+
+  if (req.cmdSet == OpenProtocolCMD::CMDSet::subscribe)
+  {
+    handleSubscription(req, data, ack);
+    return true;
+  }
+
+  ack.assign(2, 0);
+  return true;
+}
+
+void
+SimFlightController::handleSubscription(const T_CmdInfo& req,
+                                        const uint8_t* data,
+                                        std::vector<uint8_t>& ack)
+{
+  const uint8_t* addPackage    = OpenProtocolCMD::CMDSet::Subscribe::addPackage;
+  const uint8_t* reset         = OpenProtocolCMD::CMDSet::Subscribe::reset;
+  const uint8_t* removePackage =
+    OpenProtocolCMD::CMDSet::Subscribe::removePackage;
+
+  ack.assign(1, 0);
+
+  std::lock_guard<std::mutex> guard(lock);
+  if (req.cmdId == addPackage[1])
+  {
+    SubscriptionPackage::PackageInfo info;
+    if (req.dataLen < sizeof(info))
+    {
+      ack[0] = 1;
+      return;
+    }
+    memcpy(&info, data, sizeof(info));
+    if (info.packageID >= MAX_PACKAGE ||
+        req.dataLen < sizeof(info) + info.numberOfTopics * sizeof(uint32_t))
+    {
+      ack[0] = 1;
+      return;
+    }
+
+    Package& pkg = packages[info.packageID];
+    pkg.valid    = true;
+    pkg.freq     = info.freq;
+    pkg.config   = info.config;
+    pkg.dataSize = (info.config == 1) ? 8 : 0;
+    pkg.uids.resize(info.numberOfTopics);
+    if (!pkg.uids.empty())
+    {
+      memcpy(&pkg.uids[0], data + sizeof(info),
+             info.numberOfTopics * sizeof(uint32_t));
+    }
+    for (size_t i = 0; i < pkg.uids.size(); i++)
+    {
+      pkg.dataSize += topicSize(pkg.uids[i]);
+    }
+    if (config.maxSubscriptionFreq && pkg.freq > config.maxSubscriptionFreq)
+    {
+      pkg.freq = config.maxSubscriptionFreq;
+    }
+    pkg.next = std::chrono::steady_clock::now();
+  }
+  else if (req.cmdId == removePackage[1])
+  {
+    if (req.dataLen >= 1 && data[0] < MAX_PACKAGE)
+    {
+      packages[data[0]].valid = false;
+    }
+  }
+  else if (req.cmdId == reset[1])
+  {
+    for (int i = 0; i < MAX_PACKAGE; i++)
+    {
+      packages[i].valid = false;
+    }
+  }
+}
+
+void
+SimFlightController::sendAck(const T_CmdInfo& req,
+                             const std::vector<uint8_t>& data,
+                             uint32_t delayMs, double lossRate)
+{
+  std::lock_guard<std::mutex> guard(lock);
+
+  if (lossRate > 0.0 &&
+      std::uniform_real_distribution<double>(0.0, 1.0)(rng) < lossRate)
+  {
+    stats.acksDropped++;
+    return;
+  }
+  if (config.ackJitterMs)
+  {
+    delayMs += std::uniform_int_distribution<uint32_t>(
+      0, config.ackJitterMs)(rng);
+  }
+
+  PendingAck pending;
+  pending.info            = req;
+  pending.info.packetType = OSDK_COMMAND_PACKET_TYPE_ACK;
+  pending.info.needAck    = OSDK_COMMAND_NEED_ACK_NO_NEED;
+  pending.info.sender     = req.receiver;
+  pending.info.receiver   = req.sender;
+  pending.info.dataLen    = data.size();
+  pending.data            = data;
+  pending.due =
+    std::chrono::steady_clock::now() + std::chrono::milliseconds(delayMs);
+
+  pendingAcks.push_back(pending);
+  if (delayMs == 0)
+  {
+    txCond.notify_one();
+  }
+}
+
+bool
+SimFlightController::sendFrame(E_ProtocolType type, T_CmdInfo* info,
+                               const uint8_t* data)
+{
+  uint8_t  frame[SIM_FRAME_BUFFER_LEN];
+  uint32_t len = 0;
+
+  void*          ext = (type == PROTOCOL_SDK) ? sdkExt : v1Ext;
+  T_ProtocolOps& ops = (type == PROTOCOL_SDK) ? sdkOps : v1Ops;
+  if (ops.Pack(ext, frame, &len, info, data) != OSDK_STAT_OK)
+  {
+    DERROR("Simulator: pack failed for 0x%02X 0x%02X", info->cmdSet,
+           info->cmdId);
+    return false;
+  }
+
+  if (type == PROTOCOL_SDK && info->packetType == OSDK_COMMAND_PACKET_TYPE_ACK)
+  {
+    patchSdkSession(frame, len, info->sessionId);
+  }
+
+  if (!writeRaw(frame, len))
+  {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> guard(lock);
+  stats.framesSent++;
+  stats.bytesSent += len;
+  return true;
+}
+
+bool
+SimFlightController::writeRaw(const uint8_t* buf, uint32_t len)
+{
+  std::lock_guard<std::mutex> guard(writeLock);
+  ssize_t written;
+
+  if (config.transport == TRANSPORT_UDP)
+  {
+    if (!hasUdpPeer)
+    {
+      return false;
+    }
+    written = sendto(fd, buf, len, 0, (struct sockaddr*)&udpPeer,
+                     sizeof(udpPeer));
+  }
+  else
+  {
+    written = write(fd, buf, len);
+  }
+  return written == (ssize_t)len;
+}
+
+void
+SimFlightController::pushPeriodic(std::chrono::steady_clock::time_point now)
+{
+  uint8_t payload[OSDK_PACKAGE_MAX_LEN];
+
+  if (config.broadcastFreq && now >= nextBroadcast)
+  {
+    nextBroadcast = now + std::chrono::microseconds(1000000 /
+                                                    config.broadcastFreq);
+
+    /* passFlag followed by each enabled field, in DataBroadcast::unpackData
+     * order; field contents stay zero except for the time stamp. */
+    static const struct
+    {
+      uint16_t flag;
+      size_t   size;
+    } fields[] = {
+      { 0x0001, sizeof(Telemetry::TimeStamp) + sizeof(Telemetry::SyncStamp) },
+      { 0x0002, sizeof(Telemetry::Quaternion) },
+      { 0x0004, sizeof(Telemetry::Vector3f) },
+      { 0x0008, sizeof(Telemetry::Vector3f) + sizeof(Telemetry::VelocityInfo) },
+      { 0x0010, sizeof(Telemetry::Vector3f) },
+      { 0x0020, sizeof(Telemetry::GlobalPosition) +
+                  sizeof(Telemetry::RelativePosition) },
+      { 0x0040, sizeof(Telemetry::GPSInfo) },
+      { 0x0080, sizeof(Telemetry::RTK) },
+      { 0x0100, sizeof(Telemetry::Mag) },
+      { 0x0200, sizeof(Telemetry::RC) },
+      { 0x0400, sizeof(Telemetry::Gimbal) },
+      { 0x0800, sizeof(Telemetry::Status) },
+      { 0x1000, sizeof(Telemetry::Battery) },
+      { 0x2000, sizeof(Telemetry::SDKInfo) },
+      { 0x4000, sizeof(Telemetry::Compass) },
+    };
+
+    uint32_t len = sizeof(uint16_t);
+    memset(payload, 0, sizeof(payload));
+    memcpy(payload, &config.broadcastFlag, sizeof(uint16_t));
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++)
+    {
+      if ((config.broadcastFlag & fields[i].flag) &&
+          len + fields[i].size <= sizeof(payload))
+      {
+        if (fields[i].flag == 0x0001)
+        {
+          Telemetry::TimeStamp ts;
+          uint64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                          now.time_since_epoch()).count();
+          ts.time_ms = (uint32_t)ms;
+          ts.time_ns = (uint32_t)((ms % 1000) * 1000000);
+          memcpy(payload + len, &ts, sizeof(ts));
+        }
+        len += fields[i].size;
+      }
+    }
+
+    if (push(PROTOCOL_SDK, OpenProtocolCMD::CMDSet::Broadcast::broadcast[0],
+             OpenProtocolCMD::CMDSet::Broadcast::broadcast[1], payload, len))
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      stats.pushesSent++;
+    }
+  }
+
+  for (int i = 0; i < MAX_PACKAGE; i++)
+  {
+    uint32_t len = 0;
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      Package& pkg = packages[i];
+      if (!pkg.valid || pkg.freq == 0 || now < pkg.next)
+      {
+        continue;
+      }
+      pkg.next = now + std::chrono::microseconds(1000000 / pkg.freq);
+      if (pkg.dataSize + 1 > sizeof(payload))
+      {
+        continue;
+      }
+
+      memset(payload, 0, pkg.dataSize + 1);
+      payload[0] = (uint8_t)i;
+      if (pkg.config == 1)
+      {
+        uint32_t ms = (uint32_t)std::chrono::duration_cast<
+                        std::chrono::milliseconds>(now.time_since_epoch())
+                        .count();
+        memcpy(payload + 1, &ms, sizeof(ms));
+      }
+      len = pkg.dataSize + 1;
+    }
+
+    if (push(PROTOCOL_SDK, OpenProtocolCMD::CMDSet::Broadcast::subscribe[0],
+             OpenProtocolCMD::CMDSet::Broadcast::subscribe[1], payload, len))
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      stats.pushesSent++;
+    }
+  }
+}
+
+/* The SDK packer allocates its own session for every new sequence number,
+ * but an ack has to echo the session of the request it answers. Rewrite the
+ * session bits and refresh both CRCs (CRC16 over the 10 header bytes, CRC32
+ * over everything before the tail, both seeded with 0x3AA3). */
+void
+SimFlightController::patchSdkSession(uint8_t* frame, uint32_t len,
+                                     uint8_t sessionId)
+{
+  const uint32_t headerLen = 10;
+  if (len < headerLen + sizeof(uint16_t) + sizeof(uint32_t))
+  {
+    return;
+  }
+
+  frame[3] = (uint8_t)((frame[3] & 0xE0) | (sessionId & 0x1F));
+
+  uint16_t crc16 = 0x3AA3;
+  for (uint32_t i = 0; i < headerLen; i++)
+  {
+    crc16 ^= frame[i];
+    for (int bit = 0; bit < 8; bit++)
+    {
+      crc16 = (crc16 & 1) ? (uint16_t)((crc16 >> 1) ^ 0xA001) : crc16 >> 1;
+    }
+  }
+  memcpy(frame + headerLen, &crc16, sizeof(crc16));
+
+  uint32_t crc32 = 0x3AA3;
+  for (uint32_t i = 0; i < len - sizeof(uint32_t); i++)
+  {
+    crc32 ^= frame[i];
+    for (int bit = 0; bit < 8; bit++)
+    {
+      crc32 = (crc32 & 1) ? (crc32 >> 1) ^ 0xEDB88320 : crc32 >> 1;
+    }
+  }
+  memcpy(frame + len - sizeof(uint32_t), &crc32, sizeof(crc32));
+}
+
+uint32_t
+SimFlightController::topicSize(uint32_t uid)
+{
+  for (int i = 0; i < Telemetry::TOTAL_TOPIC_NUMBER; i++)
+  {
+    if (Telemetry::TopicDataBase[i].uid == uid)
+    {
+      return Telemetry::TopicDataBase[i].size;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,244 @@
+/*! @file dji_sim_flight_controller.hpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief
+ *  Simulated flight controller endpoint for hardware-free testing.
+ *  It speaks the SDK (0xAA) and V1 (0x55) protocols over a pty or a local
+ *  UDP socket, so an unmodified Linker/Vehicle can talk to it exactly as it
+ *  talks to a real aircraft over UART.
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef ONBOARDSDK_SIM_FLIGHT_CONTROLLER_H
+#define ONBOARDSDK_SIM_FLIGHT_CONTROLLER_H
+
+#include <netinet/in.h>
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "osdk_protocol.h"
+
+/*! @brief In-process (or standalone, see simulator/main.cpp) flight
+ *  controller used to exercise the linker, subscription, missions and file
+ *  transfer without an aircraft.
+ *
+ *  Usage:
+ *  @code
+ *  SimFlightController sim(config);
+ *  sim.start();
+ *  setup.addFCUartChannel(sim.getDevicePath().c_str(), 921600);
+ *  @endcode
+ *
+ *  The device path is a pty slave ("/dev/pts/N") in PTY mode and
+ *  "udp://127.0.0.1:<port>" in UDP mode; both are accepted by
+ *  OsdkLinux_UartInit.
+ */
+class SimFlightController
+{
+public:
+  typedef enum
+  {
+    TRANSPORT_PTY = 0,
+    TRANSPORT_UDP = 1,
+  } Transport;
+
+  typedef struct Config
+  {
+    Transport   transport;
+    /*! PTY mode: optional symlink created to the pty slave */
+    std::string ptyLink;
+    /*! UDP mode: local port to bind, 0 picks a free one */
+    uint16_t    udpPort;
+
+    /*! Identity reported by the version query */
+    std::string hwVersion;
+    std::string fwVersion;
+    std::string serialNumber;
+
+    /*! Activation: appId 0 accepts any id, appKey enables encrypted frames */
+    uint32_t    appId;
+    std::string appKey;
+
+    /*! ACK latency/loss injection */
+    uint32_t    ackDelayMs;
+    uint32_t    ackJitterMs;
+    double      ackLossRate;
+    uint32_t    seed;
+
+    /*! Data broadcast (0x02, 0x00) push rate, 0 disables it */
+    uint16_t    broadcastFreq;
+    uint16_t    broadcastFlag;
+
+    /*! Upper bound for subscription package rates, 0 keeps the requested
+     *  rates */
+    uint16_t    maxSubscriptionFreq;
+
+    Config();
+  } Config;
+
+  /*! @brief Canned reply for one cmdSet/cmdId, see loadScript() */
+  typedef struct ScriptedResponse
+  {
+    std::vector<uint8_t> ackData;
+    uint32_t             delayMs;
+    double               lossRate;
+    bool                 silent;
+
+    ScriptedResponse();
+  } ScriptedResponse;
+
+  /*! @brief Custom request handler.
+   *  Fill ack with the reply payload and return true to send it,
+   *  return false to leave the request unanswered.
+   */
+  typedef std::function<bool(const T_CmdInfo& req, const uint8_t* data,
+                             std::vector<uint8_t>& ack)>
+    Handler;
+
+  typedef struct Stats
+  {
+    uint64_t framesReceived;
+    uint64_t framesSent;
+    uint64_t bytesReceived;
+    uint64_t bytesSent;
+    uint64_t acksDropped;
+    uint64_t pushesSent;
+    uint64_t badFrames;
+  } Stats;
+
+public:
+  SimFlightController(const Config& config = Config());
+  ~SimFlightController();
+
+  bool start();
+  void stop();
+
+  /*! @return path to hand to Linker::addUartChannel() */
+  const std::string& getDevicePath() const;
+
+  void setResponse(uint8_t cmdSet, uint8_t cmdId,
+                   const ScriptedResponse& response);
+  void registerHandler(uint8_t cmdSet, uint8_t cmdId, Handler handler);
+
+  /*! @brief Load scripted responses, one per line:
+   *  "<cmdSet> <cmdId> [delay=<ms>] [loss=<0..1>] [silent] [ack=<hex>]"
+   *  '#' starts a comment; numbers accept 0x prefixes and the ack payload
+   *  is a run of hex bytes, e.g. "ack=0000".
+   */
+  bool loadScript(const std::string& path);
+
+  /*! @brief Send an unsolicited request/push frame to the host */
+  bool push(E_ProtocolType protoType, uint8_t cmdSet, uint8_t cmdId,
+            const uint8_t* data, uint32_t len, uint8_t receiver = 0);
+
+  Stats getStats() const;
+  bool  isActivated() const;
+
+private:
+  typedef struct PendingAck
+  {
+    std::chrono::steady_clock::time_point due;
+    T_CmdInfo                             info;
+    std::vector<uint8_t>                  data;
+  } PendingAck;
+
+  typedef struct Package
+  {
+    bool                  valid;
+    uint16_t              freq;
+    uint8_t               config;
+    std::vector<uint32_t> uids;
+    uint32_t              dataSize;
+    std::chrono::steady_clock::time_point next;
+  } Package;
+
+  static const int MAX_PACKAGE = 5;
+
+  bool openPty();
+  bool openUdp();
+  void closeTransport();
+
+  void rxTask();
+  void txTask();
+  void onFrame(E_ProtocolType type, uint8_t* frame);
+  bool defaultResponse(const T_CmdInfo& req, const uint8_t* data,
+                       std::vector<uint8_t>& ack);
+  void handleSubscription(const T_CmdInfo& req, const uint8_t* data,
+                          std::vector<uint8_t>& ack);
+  void sendAck(const T_CmdInfo& req, const std::vector<uint8_t>& data,
+               uint32_t delayMs, double lossRate);
+  bool sendFrame(E_ProtocolType type, T_CmdInfo* info, const uint8_t* data);
+  bool writeRaw(const uint8_t* buf, uint32_t len);
+  void pushPeriodic(std::chrono::steady_clock::time_point now);
+  static void patchSdkSession(uint8_t* frame, uint32_t len,
+                              uint8_t sessionId);
+  static uint32_t topicSize(uint32_t uid);
+
+  static uint16_t cmdKey(uint8_t cmdSet, uint8_t cmdId)
+  {
+    return (uint16_t)((cmdSet << 8) | cmdId);
+  }
+
+private:
+  Config      config;
+  std::string devicePath;
+  int         fd;
+  int         ptySlaveFd;
+
+  T_ProtocolOps sdkOps;
+  T_ProtocolOps v1Ops;
+  void*         sdkExt;
+  void*         v1Ext;
+
+  std::thread       rxThread;
+  std::thread       txThread;
+  std::atomic<bool> running;
+  std::atomic<bool> activated;
+
+  mutable std::mutex      lock;
+  std::mutex              writeLock;
+  std::condition_variable txCond;
+  std::vector<PendingAck> pendingAcks;
+  std::map<uint16_t, ScriptedResponse> responses;
+  std::map<uint16_t, Handler>          handlers;
+  Package     packages[MAX_PACKAGE];
+  std::chrono::steady_clock::time_point nextBroadcast;
+  uint16_t    pushSeq;
+  std::mt19937 rng;
+  Stats       stats;
+
+  /*! UDP mode: last peer the host talked from */
+  struct sockaddr_in udpPeer;
+  bool               hasUdpPeer;
+};
+
+#endif // ONBOARDSDK_SIM_FLIGHT_CONTROLLER_H
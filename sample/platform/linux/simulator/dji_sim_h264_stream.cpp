@@ -0,0 +1,340 @@
+/*! @file dji_sim_h264_stream.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief
+ *  Synthetic H.264 camera stream for hardware-free testing.
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "dji_sim_h264_stream.hpp"
+#include <stddef.h>
+
+namespace
+{
+
+const uint8_t NAL_AUD = 0x09;
+const uint8_t NAL_SPS = 0x67;
+const uint8_t NAL_PPS = 0x68;
+const uint8_t NAL_IDR = 0x65;
+/* Non-IDR slice, as a reference picture and not */
+const uint8_t NAL_P_REF     = 0x41;
+const uint8_t NAL_P_NON_REF = 0x01;
+
+const uint32_t MB_TYPE_I_PCM = 25;
+
+/* Writes the syntax elements of an RBSP, most significant bit first */
+class BitWriter
+{
+public:
+  BitWriter(std::vector<uint8_t>& out)
+    : out(out)
+    , bits(0)
+  {
+  }
+
+  void u(int count, uint32_t value)
+  {
+    for (int i = count - 1; i >= 0; --i)
+    {
+      if (bits % 8 == 0)
+      {
+        out.push_back(0);
+      }
+      if ((value >> i) & 1)
+      {
+        out.back() |= 0x80 >> (bits % 8);
+      }
+      bits++;
+    }
+  }
+
+  /* Exp-Golomb */
+  void ue(uint32_t value)
+  {
+    uint64_t code = (uint64_t)value + 1;
+    int      len  = 0;
+    while ((code >> len) > 1)
+    {
+      len++;
+    }
+    u(len, 0);
+    u(len + 1, (uint32_t)code);
+  }
+
+  void se(int32_t value)
+  {
+    ue(value > 0 ? 2 * value - 1 : -2 * value);
+  }
+
+  void alignZero()
+  {
+    while (bits % 8 != 0)
+    {
+      u(1, 0);
+    }
+  }
+
+  /* Only when aligned */
+  void bytes(const uint8_t* data, uint32_t len)
+  {
+    out.insert(out.end(), data, data + len);
+    bits += len * 8;
+  }
+
+  void trailingBits()
+  {
+    u(1, 1);
+    alignZero();
+  }
+
+private:
+  std::vector<uint8_t>& out;
+  uint64_t              bits;
+};
+
+} // namespace
+
+SimH264Stream::SimH264Stream(uint32_t width, uint32_t height,
+                             uint32_t keyInterval)
+  : width(width / 16 * 16)
+  , height(height / 16 * 16)
+  , keyInterval(keyInterval ? keyInterval : 1)
+{
+}
+
+uint32_t
+SimH264Stream::getWidth() const
+{
+  return width;
+}
+
+uint32_t
+SimH264Stream::getHeight() const
+{
+  return height;
+}
+
+uint32_t
+SimH264Stream::getPictureSize() const
+{
+  return width * height * 3 / 2;
+}
+
+void
+SimH264Stream::makePicture(uint32_t index, std::vector<uint8_t>& yuv) const
+{
+  yuv.resize(getPictureSize());
+  uint8_t* y  = &yuv[0];
+  uint8_t* cb = y + width * height;
+  uint8_t* cr = cb + width * height / 4;
+
+  for (uint32_t row = 0; row < height; ++row)
+  {
+    for (uint32_t col = 0; col < width; ++col)
+    {
+      y[row * width + col] = (uint8_t)(col + row / 2 + index * 3);
+    }
+  }
+  for (uint32_t row = 0; row < height / 2; ++row)
+  {
+    for (uint32_t col = 0; col < width / 2; ++col)
+    {
+      cb[row * width / 2 + col] = (uint8_t)(128 + ((col + index) & 0x3F));
+      cr[row * width / 2 + col] = (uint8_t)(128 - ((row + index) & 0x3F));
+    }
+  }
+}
+
+uint32_t
+SimH264Stream::getKeyPicture(uint32_t index) const
+{
+  return index - index % keyInterval;
+}
+
+void
+SimH264Stream::encodePicture(uint32_t index, const std::vector<uint8_t>& yuv,
+                             std::vector<uint8_t>& accessUnit) const
+{
+  if (index % keyInterval)
+  {
+    encodeSkippedPicture(index, accessUnit);
+    return;
+  }
+
+  accessUnit.clear();
+  std::vector<uint8_t> rbsp;
+
+  {
+    BitWriter aud(rbsp);
+    aud.u(3, 0); // primary_pic_type: I
+    aud.trailingBits();
+    appendNal(NAL_AUD, rbsp, accessUnit);
+  }
+
+  rbsp.clear();
+  {
+    BitWriter sps(rbsp);
+    sps.u(8, 66); // profile_idc: baseline
+    sps.u(8, 0);  // constraint_set flags
+    sps.u(8, 40); // level_idc
+    sps.ue(0);    // seq_parameter_set_id
+    sps.ue(0);    // log2_max_frame_num_minus4
+    sps.ue(2);    // pic_order_cnt_type: output in decoding order
+    sps.ue(1);    // max_num_ref_frames
+    sps.u(1, 0);  // gaps_in_frame_num_value_allowed_flag
+    sps.ue(width / 16 - 1);
+    sps.ue(height / 16 - 1);
+    sps.u(1, 1); // frame_mbs_only_flag
+    sps.u(1, 1); // direct_8x8_inference_flag
+    sps.u(1, 0); // frame_cropping_flag
+    sps.u(1, 0); // vui_parameters_present_flag
+    sps.trailingBits();
+    appendNal(NAL_SPS, rbsp, accessUnit);
+  }
+
+  rbsp.clear();
+  {
+    BitWriter pps(rbsp);
+    pps.ue(0);   // pic_parameter_set_id
+    pps.ue(0);   // seq_parameter_set_id
+    pps.u(1, 0); // entropy_coding_mode_flag: CAVLC
+    pps.u(1, 0); // bottom_field_pic_order_in_frame_present_flag
+    pps.ue(0);   // num_slice_groups_minus1
+    pps.ue(0);   // num_ref_idx_l0_default_active_minus1
+    pps.ue(0);   // num_ref_idx_l1_default_active_minus1
+    pps.u(1, 0); // weighted_pred_flag
+    pps.u(2, 0); // weighted_bipred_idc
+    pps.se(0);   // pic_init_qp_minus26
+    pps.se(0);   // pic_init_qs_minus26
+    pps.se(0);   // chroma_qp_index_offset
+    pps.u(1, 1); // deblocking_filter_control_present_flag
+    pps.u(1, 0); // constrained_intra_pred_flag
+    pps.u(1, 0); // redundant_pic_cnt_present_flag
+    pps.trailingBits();
+    appendNal(NAL_PPS, rbsp, accessUnit);
+  }
+
+  rbsp.clear();
+  rbsp.reserve(getPictureSize() + width * height / 256 * 2 + 16);
+  {
+    BitWriter slice(rbsp);
+    slice.ue(0);                // first_mb_in_slice
+    slice.ue(7);                // slice_type: I, all slices
+    slice.ue(0);                // pic_parameter_set_id
+    slice.u(4, 0);              // frame_num
+    slice.ue(index & 0xFFFF);   // idr_pic_id, differs from the previous IDR
+    slice.u(1, 0);              // no_output_of_prior_pics_flag
+    slice.u(1, 0);              // long_term_reference_flag
+    slice.se(0);                // slice_qp_delta
+    slice.ue(1);                // disable_deblocking_filter_idc
+
+    const uint8_t* y  = &yuv[0];
+    const uint8_t* cb = y + width * height;
+    const uint8_t* cr = cb + width * height / 4;
+    for (uint32_t mbY = 0; mbY < height / 16; ++mbY)
+    {
+      for (uint32_t mbX = 0; mbX < width / 16; ++mbX)
+      {
+        slice.ue(MB_TYPE_I_PCM);
+        slice.alignZero();
+        for (uint32_t row = 0; row < 16; ++row)
+        {
+          slice.bytes(y + (mbY * 16 + row) * width + mbX * 16, 16);
+        }
+        for (uint32_t row = 0; row < 8; ++row)
+        {
+          slice.bytes(cb + (mbY * 8 + row) * width / 2 + mbX * 8, 8);
+        }
+        for (uint32_t row = 0; row < 8; ++row)
+        {
+          slice.bytes(cr + (mbY * 8 + row) * width / 2 + mbX * 8, 8);
+        }
+      }
+    }
+    slice.trailingBits();
+    appendNal(NAL_IDR, rbsp, accessUnit);
+  }
+}
+
+void
+SimH264Stream::encodeSkippedPicture(uint32_t                index,
+                                    std::vector<uint8_t>& accessUnit) const
+{
+  accessUnit.clear();
+  std::vector<uint8_t> rbsp;
+
+  {
+    BitWriter aud(rbsp);
+    aud.u(3, 1); // primary_pic_type: I, P
+    aud.trailingBits();
+    appendNal(NAL_AUD, rbsp, accessUnit);
+  }
+
+  /* Odd pictures after the IDR are not references; pic_order_cnt_type 2
+   * allows no two of them in a row */
+  uint32_t offset    = index % keyInterval;
+  bool     reference = offset % 2 == 0;
+
+  rbsp.clear();
+  {
+    BitWriter slice(rbsp);
+    slice.ue(0);                         // first_mb_in_slice
+    slice.ue(5);                         // slice_type: P, all slices
+    slice.ue(0);                         // pic_parameter_set_id
+    slice.u(4, ((offset + 1) / 2) & 15); // frame_num: references before it
+    slice.u(1, 0); // num_ref_idx_active_override_flag
+    slice.u(1, 0); // ref_pic_list_modification_flag_l0
+    if (reference)
+    {
+      slice.u(1, 0); // adaptive_ref_pic_marking_mode_flag: sliding window
+    }
+    slice.se(0); // slice_qp_delta
+    slice.ue(1); // disable_deblocking_filter_idc
+    slice.ue(width / 16 * height / 16); // mb_skip_run: the whole picture
+    slice.trailingBits();
+    appendNal(reference ? NAL_P_REF : NAL_P_NON_REF, rbsp, accessUnit);
+  }
+}
+
+void
+SimH264Stream::appendNal(uint8_t header, const std::vector<uint8_t>& rbsp,
+                         std::vector<uint8_t>& out)
+{
+  static const uint8_t startCode[] = { 0, 0, 0, 1 };
+  out.insert(out.end(), startCode, startCode + sizeof(startCode));
+  out.push_back(header);
+
+  /* Emulation prevention: no 0x000000 to 0x000003 inside a NAL unit */
+  int zeros = 0;
+  for (size_t i = 0; i < rbsp.size(); ++i)
+  {
+    if (zeros >= 2 && rbsp[i] <= 3)
+    {
+      out.push_back(3);
+      zeros = 0;
+    }
+    out.push_back(rbsp[i]);
+    zeros = (rbsp[i] == 0) ? zeros + 1 : 0;
+  }
+}
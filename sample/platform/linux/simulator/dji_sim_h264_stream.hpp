@@ -0,0 +1,90 @@
+/*! @file dji_sim_h264_stream.hpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief
+ *  Synthetic H.264 camera stream for hardware-free testing of the camera
+ *  stream and LiveView pipelines. The pictures are coded as uncompressed
+ *  (I_PCM) macroblocks, so a decoder has to reproduce them exactly.
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef ONBOARDSDK_SIM_H264_STREAM_H
+#define ONBOARDSDK_SIM_H264_STREAM_H
+
+#include <stdint.h>
+#include <vector>
+
+/*! @brief Baseline profile H.264 stream of IDR pictures of I_PCM
+ *  macroblocks, every keyInterval-th picture, and P pictures between them
+ *  of which every macroblock is skipped.
+ *
+ *  Usage:
+ *  @code
+ *  SimH264Stream stream(640, 480);
+ *  stream.makePicture(n, yuv);
+ *  stream.encodePicture(n, yuv, accessUnit);
+ *  @endcode
+ *
+ *  Every access unit starts with an access unit delimiter and an IDR one
+ *  carries the SPS and PPS, so decoding can start at any of them. A P
+ *  picture shows its IDR picture again; every other one is not a
+ *  reference, so skipping it does not affect the others.
+ */
+class SimH264Stream
+{
+public:
+  /*! Width and height are rounded down to whole macroblocks */
+  SimH264Stream(uint32_t width, uint32_t height, uint32_t keyInterval = 1);
+
+  uint32_t getWidth() const;
+  uint32_t getHeight() const;
+
+  /*! Planar 4:2:0, the luma plane followed by Cb and Cr */
+  uint32_t getPictureSize() const;
+
+  /*! A moving pattern, different in every picture */
+  void makePicture(uint32_t index, std::vector<uint8_t>& yuv) const;
+
+  /*! The IDR picture whose content picture index shows */
+  uint32_t getKeyPicture(uint32_t index) const;
+
+  /*! Replaces accessUnit with picture index, which yuv is the content of;
+   *  yuv is not used for a P picture */
+  void encodePicture(uint32_t index, const std::vector<uint8_t>& yuv,
+                     std::vector<uint8_t>& accessUnit) const;
+
+private:
+  /*! Appends rbsp as a NAL unit with a start code */
+  static void appendNal(uint8_t header, const std::vector<uint8_t>& rbsp,
+                        std::vector<uint8_t>& out);
+
+  void encodeSkippedPicture(uint32_t index,
+                            std::vector<uint8_t>& accessUnit) const;
+
+  uint32_t width;
+  uint32_t height;
+  uint32_t keyInterval;
+};
+
+#endif // ONBOARDSDK_SIM_H264_STREAM_H
@@ -0,0 +1,188 @@
+/*! @file simulator/main.cpp
+ *  @version 4.0
+ *  @date Oct 2026
+ *
+ *  @brief
+ *  Standalone simulated flight controller. Point any sample at the printed
+ *  device path (UserConfig.txt "device:") to run it without an aircraft.
+ *
+ *  @Copyright (c) 2026 DJI
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <iostream>
+#include "dji_platform.hpp"
+#include "dji_sim_flight_controller.hpp"
+#include "osdkosal_linux.h"
+
+static volatile sig_atomic_t quit = 0;
+
+static void
+onSignal(int)
+{
+  quit = 1;
+}
+
+static void
+usage(const char* name)
+{
+  std::cout
+    << "Usage: " << name << " [options]\n"
+    << "  --pty <link>         create the pty and symlink it to <link>\n"
+    << "  --udp <port>         listen on 127.0.0.1:<port> instead of a pty\n"
+    << "  --hw <name>          hardware version, e.g. PM420, PM430\n"
+    << "  --fw <a.b.c.d>       firmware version\n"
+    << "  --app-id <id>        only accept this app id on activation\n"
+    << "  --app-key <key>      app key, enables encrypted frames\n"
+    << "  --ack-delay <ms>     fixed ACK latency\n"
+    << "  --ack-jitter <ms>    random extra ACK latency\n"
+    << "  --ack-loss <0..1>    ACK drop probability\n"
+    << "  --seed <n>           random seed for jitter/loss\n"
+    << "  --broadcast-hz <n>   data broadcast rate, 0 disables it\n"
+    << "  --broadcast-flag <n> data broadcast passFlag\n"
+    << "  --max-sub-hz <n>     cap subscription package rates\n"
+    << "  --script <file>      scripted responses, see loadScript()\n";
+}
+
+int
+main(int argc, char** argv)
+{
+  static T_OsdkOsalHandler osalHandler = {
+    .TaskCreate         = OsdkLinux_TaskCreate,
+    .TaskDestroy        = OsdkLinux_TaskDestroy,
+    .TaskSleepMs        = OsdkLinux_TaskSleepMs,
+    .MutexCreate        = OsdkLinux_MutexCreate,
+    .MutexDestroy       = OsdkLinux_MutexDestroy,
+    .MutexLock          = OsdkLinux_MutexLock,
+    .MutexUnlock        = OsdkLinux_MutexUnlock,
+    .SemaphoreCreate    = OsdkLinux_SemaphoreCreate,
+    .SemaphoreDestroy   = OsdkLinux_SemaphoreDestroy,
+    .SemaphoreWait      = OsdkLinux_SemaphoreWait,
+    .SemaphoreTimedWait = OsdkLinux_SemaphoreTimedWait,
+    .SemaphorePost      = OsdkLinux_SemaphorePost,
+    .GetTimeMs          = OsdkLinux_GetTimeMs,
+#ifdef OS_DEBUG
+    .GetTimeUs = OsdkLinux_GetTimeUs,
+#endif
+    .Malloc = OsdkLinux_Malloc,
+    .Free   = OsdkLinux_Free,
+  };
+
+  if (DJI_REG_OSAL_HANDLER(&osalHandler) != true)
+  {
+    std::cout << "Osal handler register fail\n";
+    return -1;
+  }
+
+  SimFlightController::Config config;
+  std::string                 script;
+
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg  = argv[i];
+    const char* next = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+    if (arg == "-h" || arg == "--help")
+    {
+      usage(argv[0]);
+      return 0;
+    }
+    if (!next)
+    {
+      usage(argv[0]);
+      return -1;
+    }
+    i++;
+
+    if (arg == "--pty")
+    {
+      config.transport = SimFlightController::TRANSPORT_PTY;
+      config.ptyLink   = next;
+    }
+    else if (arg == "--udp")
+    {
+      config.transport = SimFlightController::TRANSPORT_UDP;
+      config.udpPort   = (uint16_t)strtoul(next, NULL, 0);
+    }
+    else if (arg == "--hw")
+      config.hwVersion = next;
+    else if (arg == "--fw")
+      config.fwVersion = next;
+    else if (arg == "--app-id")
+      config.appId = (uint32_t)strtoul(next, NULL, 0);
+    else if (arg == "--app-key")
+      config.appKey = next;
+    else if (arg == "--ack-delay")
+      config.ackDelayMs = (uint32_t)strtoul(next, NULL, 0);
+    else if (arg == "--ack-jitter")
+      config.ackJitterMs = (uint32_t)strtoul(next, NULL, 0);
+    else if (arg == "--ack-loss")
+      config.ackLossRate = strtod(next, NULL);
+    else if (arg == "--seed")
+      config.seed = (uint32_t)strtoul(next, NULL, 0);
+    else if (arg == "--broadcast-hz")
+      config.broadcastFreq = (uint16_t)strtoul(next, NULL, 0);
+    else if (arg == "--broadcast-flag")
+      config.broadcastFlag = (uint16_t)strtoul(next, NULL, 0);
+    else if (arg == "--max-sub-hz")
+      config.maxSubscriptionFreq = (uint16_t)strtoul(next, NULL, 0);
+    else if (arg == "--script")
+      script = next;
+    else
+    {
+      usage(argv[0]);
+      return -1;
+    }
+  }
+
+  SimFlightController sim(config);
+  if (!script.empty() && !sim.loadScript(script))
+  {
+    return -1;
+  }
+  if (!sim.start())
+  {
+    std::cout << "Failed to start the simulator\n";
+    return -1;
+  }
+  std::cout << "device: " << sim.getDevicePath() << std::endl;
+
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+  while (!quit)
+  {
+    sleep(1);
+    SimFlightController::Stats stats = sim.getStats();
+    std::cout << "rx " << stats.framesReceived << " frames/"
+              << stats.bytesReceived << " B, tx " << stats.framesSent
+              << " frames/" << stats.bytesSent << " B, pushes "
+              << stats.pushesSent << ", dropped acks " << stats.acksDropped
+              << ", bad frames " << stats.badFrames
+              << (sim.isActivated() ? ", activated" : "") << std::endl;
+  }
+
+  sim.stop();
+  return 0;
+}